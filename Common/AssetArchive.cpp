@@ -0,0 +1,371 @@
+#include "AssetArchive.h"
+#include "HashUtil.h"
+#include "LzCompression.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    inline uint64 AlignUp(uint64 value, uint64 alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // 压缩后至少小1/16才值得解压的开销
+    inline bool WorthCompressing(std::size_t compressedSize, std::size_t size)
+    {
+        return compressedSize > 0 && compressedSize < size - size / 16;
+    }
+
+    bool EntryLess(const AssetArchiveEntry& a, const AssetArchiveEntry& b)
+    {
+        return a.nameHash < b.nameHash;
+    }
+}
+
+std::string NormalizeAssetName(const std::string& name)
+{
+    std::string result = name;
+    std::replace(result.begin(), result.end(), '\\', '/');
+    return result;
+}
+
+std::uint64_t HashAssetName(const std::string& name)
+{
+    std::string normalized = NormalizeAssetName(name);
+    return Hasher64::Hash(normalized.data(), normalized.size());
+}
+
+void AssetArchiveWriter::Add(const std::string& name, std::vector<char> data, bool compress)
+{
+    std::string normalized = NormalizeAssetName(name);
+    for (auto& entry : m_entries)
+    {
+        if (entry.name == normalized)
+        {
+            entry.data = std::move(data);
+            entry.compress = compress;
+            return;
+        }
+    }
+    m_entries.push_back({ normalized, std::move(data), compress });
+}
+
+bool AssetArchiveWriter::Write(std::ostream& out, const AssetArchiveWriteOptions& options)const
+{
+    if (options.chunkSize == 0 || options.dataAlignment == 0)
+        return false;
+
+    // 目录按名字的哈希排序，运行时二分查找
+    std::vector<const Entry*> sorted;
+    for (auto& entry : m_entries)
+        sorted.push_back(&entry);
+    std::sort(sorted.begin(), sorted.end(), [](const Entry* a, const Entry* b)
+    {
+        uint64 hashA = Hasher64::Hash(a->name.data(), a->name.size());
+        uint64 hashB = Hasher64::Hash(b->name.data(), b->name.size());
+        return hashA != hashB ? hashA < hashB : a->name < b->name;
+    });
+
+    std::vector<AssetArchiveEntry> entries;
+    std::string names;
+    struct ChunkSource
+    {
+        const char* data;
+        std::size_t size;
+        bool compress;
+    };
+    std::vector<ChunkSource> sources;
+    for (const Entry* entry : sorted)
+    {
+        AssetArchiveEntry header = {};
+        header.nameHash = Hasher64::Hash(entry->name.data(), entry->name.size());
+        header.size = entry->data.size();
+        header.firstChunk = (uint32)sources.size();
+        header.nameOffset = (uint32)names.size();
+        header.nameLength = (uint32)entry->name.size();
+        names += entry->name;
+        for (std::size_t offset = 0; offset < entry->data.size(); offset += options.chunkSize)
+        {
+            const std::size_t size = (std::min)((std::size_t)options.chunkSize, entry->data.size() - offset);
+            sources.push_back({ entry->data.data() + offset, size, options.compress && entry->compress });
+            ++header.chunkCount;
+        }
+        entries.push_back(header);
+    }
+
+    // chunk之间互不依赖，多个线程同时压缩
+    std::vector<std::vector<char>> compressed(sources.size());
+    std::atomic<std::size_t> nextChunk(0);
+    auto compressChunks = [&]()
+    {
+        std::vector<char> buffer(LzCompressBound(options.chunkSize));
+        for (;;)
+        {
+            const std::size_t index = nextChunk++;
+            if (index >= sources.size())
+                return;
+            const ChunkSource& source = sources[index];
+            if (!source.compress)
+                continue;
+            const std::size_t size = LzCompress(source.data, source.size, buffer.data(), buffer.size());
+            if (WorthCompressing(size, source.size))
+                compressed[index].assign(buffer.begin(), buffer.begin() + size);
+        }
+    };
+    uint32 threadCount = options.threadCount != 0 ? options.threadCount : std::thread::hardware_concurrency();
+    threadCount = (std::max)((uint32)1, (std::min)(threadCount, (uint32)sources.size()));
+    std::vector<std::thread> threads;
+    for (uint32 i = 1; i < threadCount; ++i)
+        threads.emplace_back(compressChunks);
+    compressChunks();
+    for (auto& thread : threads)
+        thread.join();
+
+    // 每个entry的数据从对齐的位置开始，chunk在entry内紧密排列
+    std::vector<AssetArchiveChunk> chunks(sources.size());
+    uint64 offset = sizeof(AssetArchiveHeader) + sizeof(AssetArchiveEntry) * entries.size() +
+        sizeof(AssetArchiveChunk) * chunks.size() + names.size();
+    for (auto& entry : entries)
+    {
+        offset = AlignUp(offset, options.dataAlignment);
+        for (uint32 i = 0; i < entry.chunkCount; ++i)
+        {
+            const uint32 index = entry.firstChunk + i;
+            chunks[index].offset = offset;
+            chunks[index].storedSize = (uint32)(compressed[index].empty() ? sources[index].size : compressed[index].size());
+            offset += chunks[index].storedSize;
+        }
+    }
+
+    AssetArchiveHeader header = {};
+    header.magic = AssetArchive::Magic;
+    header.version = AssetArchive::Version;
+    header.entryCount = (uint32)entries.size();
+    header.chunkCount = (uint32)chunks.size();
+    header.chunkSize = options.chunkSize;
+    header.dataAlignment = options.dataAlignment;
+    header.namesSize = (uint32)names.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), sizeof(AssetArchiveEntry) * entries.size());
+    out.write(reinterpret_cast<const char*>(chunks.data()), sizeof(AssetArchiveChunk) * chunks.size());
+    out.write(names.data(), names.size());
+
+    uint64 position = sizeof(AssetArchiveHeader) + sizeof(AssetArchiveEntry) * entries.size() +
+        sizeof(AssetArchiveChunk) * chunks.size() + names.size();
+    const std::vector<char> padding(options.dataAlignment, 0);
+    for (std::size_t i = 0; i < chunks.size(); ++i)
+    {
+        out.write(padding.data(), (std::streamsize)(chunks[i].offset - position));
+        if (compressed[i].empty())
+            out.write(sources[i].data, sources[i].size);
+        else
+            out.write(compressed[i].data(), compressed[i].size());
+        position = chunks[i].offset + chunks[i].storedSize;
+    }
+    // 文件大小也对齐，无缓冲读取最后一个entry时不会越过文件末尾
+    out.write(padding.data(), (std::streamsize)(AlignUp(position, options.dataAlignment) - position));
+    return (bool)out;
+}
+
+bool AssetArchive::Open(const std::string& path)
+{
+    Close();
+    if (m_file.Open(path) && Attach((const char*)m_file.GetData(), m_file.GetSize()))
+        return true;
+    Close();
+    return false;
+}
+
+#ifdef _WIN32
+bool AssetArchive::Open(const std::wstring& path)
+{
+    Close();
+    if (m_file.Open(path) && Attach((const char*)m_file.GetData(), m_file.GetSize()))
+        return true;
+    Close();
+    return false;
+}
+#endif
+
+void AssetArchive::Close()
+{
+    m_file.Close();
+    m_data = nullptr;
+    m_size = 0;
+    m_header = {};
+    m_entries = nullptr;
+    m_chunks = nullptr;
+    m_names = nullptr;
+}
+
+bool AssetArchive::Attach(const char* data, std::size_t size)
+{
+    AssetArchiveHeader header;
+    if (size < sizeof(header))
+        return false;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != Magic || header.version != Version || header.chunkSize == 0)
+        return false;
+
+    const uint64 entriesOffset = sizeof(header);
+    const uint64 chunksOffset = entriesOffset + sizeof(AssetArchiveEntry) * (uint64)header.entryCount;
+    const uint64 namesOffset = chunksOffset + sizeof(AssetArchiveChunk) * (uint64)header.chunkCount;
+    if (namesOffset + header.namesSize > size)
+        return false;
+
+    // 文件映射的起始地址按页对齐，Header、Entry、Chunk的大小都是8的倍数，可以直接使用
+    const AssetArchiveEntry* entries = reinterpret_cast<const AssetArchiveEntry*>(data + entriesOffset);
+    const AssetArchiveChunk* chunks = reinterpret_cast<const AssetArchiveChunk*>(data + chunksOffset);
+    for (uint32 i = 0; i < header.entryCount; ++i)
+    {
+        const AssetArchiveEntry& entry = entries[i];
+        if (i > 0 && EntryLess(entry, entries[i - 1]))
+            return false;
+        if ((uint64)entry.nameOffset + entry.nameLength > header.namesSize)
+            return false;
+        if ((uint64)entry.firstChunk + entry.chunkCount > header.chunkCount ||
+            entry.chunkCount != (entry.size + header.chunkSize - 1) / header.chunkSize)
+            return false;
+
+        for (uint32 j = 0; j < entry.chunkCount; ++j)
+        {
+            const AssetArchiveChunk& chunk = chunks[entry.firstChunk + j];
+            const uint64 dataSize = (std::min)((uint64)header.chunkSize, entry.size - (uint64)j * header.chunkSize);
+            if (chunk.storedSize == 0 || chunk.storedSize > dataSize || chunk.offset > size || chunk.storedSize > size - chunk.offset)
+                return false;
+        }
+    }
+
+    m_data = data;
+    m_size = size;
+    m_header = header;
+    m_entries = entries;
+    m_chunks = chunks;
+    m_names = data + namesOffset;
+    return true;
+}
+
+const AssetArchiveEntry* AssetArchive::Find(const std::string& name)const
+{
+    if (m_entries == nullptr)
+        return nullptr;
+
+    const std::string normalized = NormalizeAssetName(name);
+    AssetArchiveEntry value = {};
+    value.nameHash = Hasher64::Hash(normalized.data(), normalized.size());
+    const AssetArchiveEntry* end = m_entries + m_header.entryCount;
+    for (auto it = std::lower_bound(m_entries, end, value, EntryLess); it != end && it->nameHash == value.nameHash; ++it)
+    {
+        if (it->nameLength == normalized.size() && memcmp(m_names + it->nameOffset, normalized.data(), normalized.size()) == 0)
+            return it;
+    }
+    return nullptr;
+}
+
+std::string AssetArchive::GetName(const AssetArchiveEntry& entry)const
+{
+    return std::string(m_names + entry.nameOffset, entry.nameLength);
+}
+
+std::size_t AssetArchive::GetChunkDataSize(const AssetArchiveEntry& entry, uint32 index)const
+{
+    return (std::size_t)(std::min)((uint64)m_header.chunkSize, entry.size - (uint64)index * m_header.chunkSize);
+}
+
+const void* AssetArchive::GetStoredChunk(const AssetArchiveEntry& entry, uint32 index)const
+{
+    const AssetArchiveChunk& chunk = GetChunk(entry, index);
+    return chunk.storedSize == GetChunkDataSize(entry, index) ? m_data + chunk.offset : nullptr;
+}
+
+const void* AssetArchive::GetStoredData(const AssetArchiveEntry& entry)const
+{
+    if (entry.chunkCount == 0)
+        return m_data;
+
+    // 没有压缩时chunk在文件中也是连续的
+    const uint64 firstOffset = GetChunk(entry, 0).offset;
+    for (uint32 i = 0; i < entry.chunkCount; ++i)
+    {
+        if (GetStoredChunk(entry, i) == nullptr || GetChunk(entry, i).offset != firstOffset + (uint64)i * m_header.chunkSize)
+            return nullptr;
+    }
+    return m_data + firstOffset;
+}
+
+bool AssetArchive::ReadChunk(const AssetArchiveEntry& entry, uint32 index, void* dest)const
+{
+    const AssetArchiveChunk& chunk = GetChunk(entry, index);
+    const std::size_t dataSize = GetChunkDataSize(entry, index);
+    if (chunk.storedSize == dataSize)
+    {
+        memcpy(dest, m_data + chunk.offset, dataSize);
+        return true;
+    }
+    return LzDecompress(m_data + chunk.offset, chunk.storedSize, dest, dataSize);
+}
+
+bool AssetArchive::Read(const AssetArchiveEntry& entry, void* dest)const
+{
+    char* bytes = static_cast<char*>(dest);
+    for (uint32 i = 0; i < entry.chunkCount; ++i)
+    {
+        if (!ReadChunk(entry, i, bytes + (std::size_t)i * m_header.chunkSize))
+            return false;
+    }
+    return true;
+}
+
+AssetStream::AssetStream(const AssetArchive& archive, const AssetArchiveEntry& entry) :
+    m_archive(archive),
+    m_entry(entry)
+{
+}
+
+bool AssetStream::Read(uint64 offset, void* dest, std::size_t size)
+{
+    if (offset > m_entry.size || size > m_entry.size - offset)
+        return false;
+
+    const uint64 chunkSize = m_archive.GetChunkSize();
+    char* bytes = static_cast<char*>(dest);
+    while (size > 0)
+    {
+        const uint32 index = (uint32)(offset / chunkSize);
+        const std::size_t chunkOffset = (std::size_t)(offset % chunkSize);
+        const std::size_t dataSize = m_archive.GetChunkDataSize(m_entry, index);
+        const std::size_t count = (std::min)(size, dataSize - chunkOffset);
+
+        if (const void* stored = m_archive.GetStoredChunk(m_entry, index))
+            memcpy(bytes, static_cast<const char*>(stored) + chunkOffset, count);
+        else if (count == dataSize && index != m_chunkIndex)
+        {
+            // 完整的chunk直接解压到目标地址
+            if (!m_archive.ReadChunk(m_entry, index, bytes))
+                return false;
+        }
+        else
+        {
+            if (index != m_chunkIndex)
+            {
+                m_chunkData.resize(m_archive.GetChunkSize());
+                m_chunkIndex = NoChunk;
+                if (!m_archive.ReadChunk(m_entry, index, m_chunkData.data()))
+                    return false;
+                m_chunkIndex = index;
+            }
+            memcpy(bytes, m_chunkData.data() + chunkOffset, count);
+        }
+
+        bytes += count;
+        offset += count;
+        size -= count;
+    }
+    return true;
+}
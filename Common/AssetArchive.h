@@ -0,0 +1,158 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 把多个资源文件（dds、cso等）打包到一个文件中，运行时只打开并映射这一个文件，不依赖图形API（见Util/AssetPack）。
+// 文件格式：Header，按名字哈希排序的Entry数组，Chunk数组，名字字符串，然后是各个entry的数据。
+// 每个entry的数据按chunkSize切成chunk，每个chunk单独用LzCompression压缩，压缩后没有明显变小的chunk原样保存。
+// chunk之间互不依赖，可以只解压需要的部分，也可以在多个线程中同时解压；entry的数据起始位置按dataAlignment对齐，
+// 没有压缩的entry可以直接使用映射的数据，也可以用无缓冲的I/O读取
+struct AssetArchiveHeader
+{
+    std::uint32_t magic;            // AssetArchive::Magic
+    std::uint32_t version;
+    std::uint32_t entryCount;
+    std::uint32_t chunkCount;
+    std::uint32_t chunkSize;        // 除了每个entry的最后一个chunk，解压后都是这么大
+    std::uint32_t dataAlignment;
+    std::uint32_t namesSize;        // 名字字符串的总字节数
+    std::uint32_t reserved;
+};
+
+struct AssetArchiveEntry
+{
+    std::uint64_t nameHash;         // HashAssetName
+    std::uint64_t size;             // 解压后的字节数
+    std::uint32_t firstChunk;
+    std::uint32_t chunkCount;
+    std::uint32_t nameOffset;       // 在名字字符串中的位置，用来区分哈希相同的名字
+    std::uint32_t nameLength;
+};
+
+struct AssetArchiveChunk
+{
+    std::uint64_t offset;           // 在文件中的位置
+    std::uint32_t storedSize;       // 在文件中的字节数，与解压后的大小相同时没有压缩
+    std::uint32_t reserved;
+};
+
+// 名字统一用'/'分隔，例如"Textures/brick.dds"和"Textures\\brick.dds"是同一个entry；区分大小写，与其他平台上的文件名一致
+std::string NormalizeAssetName(const std::string& name);
+std::uint64_t HashAssetName(const std::string& name);
+
+struct AssetArchiveWriteOptions
+{
+    std::uint32_t chunkSize = 64 * 1024;
+    std::uint32_t dataAlignment = 4096;     // 扇区大小的整数倍，entry可以用无缓冲的I/O直接读取
+    bool compress = true;
+    std::uint32_t threadCount = 0;          // 压缩chunk的线程数，0为硬件线程数
+};
+
+class AssetArchiveWriter
+{
+public:
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    // compress为false时这个entry不压缩，例如已经压缩过的数据；同一个名字再次添加时覆盖之前的
+    void Add(const std::string& name, std::vector<char> data, bool compress = true);
+    bool Write(std::ostream& out, const AssetArchiveWriteOptions& options = AssetArchiveWriteOptions())const;
+
+    std::size_t EntryCount()const { return m_entries.size(); }
+
+private:
+    struct Entry
+    {
+        std::string name;
+        std::vector<char> data;
+        bool compress;
+    };
+
+    std::vector<Entry> m_entries;
+};
+
+class AssetArchive
+{
+public:
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    static const uint32 Magic = 0x4b415041;     // "APAK"
+    static const uint32 Version = 1;
+
+    AssetArchive() = default;
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    // 把文件映射到内存中，只检查目录，不读取数据。文件不存在或格式错误时返回false
+    bool Open(const std::string& path);
+#ifdef _WIN32
+    bool Open(const std::wstring& path);
+#endif
+    void Close();
+    bool IsOpen()const { return m_entries != nullptr; }
+
+    // 没有找到时返回nullptr，entry在archive关闭前有效
+    const AssetArchiveEntry* Find(const std::string& name)const;
+    std::string GetName(const AssetArchiveEntry& entry)const;
+
+    const AssetArchiveEntry* GetEntries()const { return m_entries; }
+    std::size_t EntryCount()const { return m_header.entryCount; }
+    const AssetArchiveChunk& GetChunk(const AssetArchiveEntry& entry, uint32 index)const { return m_chunks[entry.firstChunk + index]; }
+    uint32 GetChunkSize()const { return m_header.chunkSize; }
+    // 第index个chunk解压后的字节数
+    std::size_t GetChunkDataSize(const AssetArchiveEntry& entry, uint32 index)const;
+    // 没有压缩的chunk返回映射中的数据；压缩的chunk返回nullptr
+    const void* GetStoredChunk(const AssetArchiveEntry& entry, uint32 index)const;
+    // 所有chunk都没有压缩时返回映射中的数据，可以直接使用；否则返回nullptr
+    const void* GetStoredData(const AssetArchiveEntry& entry)const;
+
+    // 把第index个chunk解压到dest，dest至少为GetChunkDataSize的大小。数据损坏时返回false。
+    // 只读取映射的数据，多个线程可以同时调用
+    bool ReadChunk(const AssetArchiveEntry& entry, uint32 index, void* dest)const;
+    // 解压整个entry，dest至少为entry.size字节
+    bool Read(const AssetArchiveEntry& entry, void* dest)const;
+
+private:
+    // 检查data中的Header、Entry和Chunk数组，成功后各个指针指向data内部
+    bool Attach(const char* data, std::size_t size);
+
+    MappedFile m_file;
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+    AssetArchiveHeader m_header = {};
+    const AssetArchiveEntry* m_entries = nullptr;
+    const AssetArchiveChunk* m_chunks = nullptr;
+    const char* m_names = nullptr;
+};
+
+// 按位置读取一个entry中的任意一段数据，只解压覆盖到的chunk。
+// 完整覆盖一个chunk的读取直接解压到目标地址（例如staging buffer），只读取一部分的chunk先解压到内部的buffer中，
+// 之后读取同一个chunk的其他部分时不再重复解压。每个线程使用自己的AssetStream
+class AssetStream
+{
+public:
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    AssetStream(const AssetArchive& archive, const AssetArchiveEntry& entry);
+    AssetStream(const AssetStream&) = delete;
+    AssetStream& operator=(const AssetStream&) = delete;
+
+    uint64 GetSize()const { return m_entry.size; }
+    // 超出entry的范围或者数据损坏时返回false
+    bool Read(uint64 offset, void* dest, std::size_t size);
+
+private:
+    static const uint32 NoChunk = 0xffffffff;
+
+    const AssetArchive& m_archive;
+    const AssetArchiveEntry& m_entry;
+    std::vector<char> m_chunkData;
+    uint32 m_chunkIndex = NoChunk;          // m_chunkData中是第几个chunk
+};
@@ -0,0 +1,1615 @@
+#include "BlockCompression.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define BC_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#define BC_X86 0
+#endif
+
+// MSVC可以直接使用AVX2的intrinsic，GCC、Clang需要给函数标记target
+#if defined(__GNUC__) || defined(__clang__)
+#define BC_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define BC_TARGET_AVX2
+#endif
+
+namespace
+{
+    using uint8 = std::uint8_t;
+    using uint16 = std::uint16_t;
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    // 块中的16个像素按通道分开存放，SIMD一次处理4个或8个像素
+    struct alignas(32) BlockPixels
+    {
+        float channels[4][16];      // r、g、b、a
+    };
+
+    // 最多16项（BC7的4位下标）
+    struct Palette
+    {
+        float colors[16][4];
+        uint32 count = 0;
+    };
+
+    void LoadBlock(const uint8 rgba[64], BlockPixels& pixels)
+    {
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            for (uint32 c = 0; c < 4; ++c)
+                pixels.channels[c][i] = (float)rgba[i * 4 + c];
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // 在调色板中为每个像素找[firstChannel, firstChannel + channelCount)通道上平方误差最小的一项。
+    // 误差相同时取下标小的，三个实现的每个像素的误差按相同的顺序累加，结果完全一致
+
+    void FindNearestScalar(const BlockPixels& pixels, const Palette& palette, uint32 firstChannel, uint32 channelCount,
+        uint8 indices[16], float errors[16])
+    {
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            float best = FLT_MAX;
+            uint32 bestIndex = 0;
+            for (uint32 p = 0; p < palette.count; ++p)
+            {
+                float error = 0.0f;
+                for (uint32 c = firstChannel; c < firstChannel + channelCount; ++c)
+                {
+                    const float d = pixels.channels[c][i] - palette.colors[p][c];
+                    error = error + d * d;
+                }
+                if (error < best)
+                {
+                    best = error;
+                    bestIndex = p;
+                }
+            }
+            indices[i] = (uint8)bestIndex;
+            errors[i] = best;
+        }
+    }
+
+#if BC_X86
+    void FindNearestSse2(const BlockPixels& pixels, const Palette& palette, uint32 firstChannel, uint32 channelCount,
+        uint8 indices[16], float errors[16])
+    {
+        const uint32 lastChannel = firstChannel + channelCount;
+        for (uint32 group = 0; group < 16; group += 4)
+        {
+            __m128 channels[4];
+            for (uint32 c = firstChannel; c < lastChannel; ++c)
+                channels[c] = _mm_load_ps(&pixels.channels[c][group]);
+
+            __m128 best = _mm_set1_ps(FLT_MAX);
+            __m128 bestIndex = _mm_setzero_ps();
+            for (uint32 p = 0; p < palette.count; ++p)
+            {
+                __m128 error = _mm_setzero_ps();
+                for (uint32 c = firstChannel; c < lastChannel; ++c)
+                {
+                    const __m128 d = _mm_sub_ps(channels[c], _mm_set1_ps(palette.colors[p][c]));
+                    error = _mm_add_ps(error, _mm_mul_ps(d, d));
+                }
+                // SSE2没有blendv，用and/andnot选择
+                const __m128 less = _mm_cmplt_ps(error, best);
+                best = _mm_or_ps(_mm_and_ps(less, error), _mm_andnot_ps(less, best));
+                bestIndex = _mm_or_ps(_mm_and_ps(less, _mm_set1_ps((float)p)), _mm_andnot_ps(less, bestIndex));
+            }
+
+            _mm_storeu_ps(errors + group, best);
+            alignas(16) std::int32_t bestIndices[4];
+            _mm_store_si128((__m128i*)bestIndices, _mm_cvttps_epi32(bestIndex));
+            for (uint32 i = 0; i < 4; ++i)
+                indices[group + i] = (uint8)bestIndices[i];
+        }
+    }
+
+    BC_TARGET_AVX2 void FindNearestAvx2(const BlockPixels& pixels, const Palette& palette, uint32 firstChannel, uint32 channelCount,
+        uint8 indices[16], float errors[16])
+    {
+        const uint32 lastChannel = firstChannel + channelCount;
+        for (uint32 group = 0; group < 16; group += 8)
+        {
+            __m256 channels[4];
+            for (uint32 c = firstChannel; c < lastChannel; ++c)
+                channels[c] = _mm256_load_ps(&pixels.channels[c][group]);
+
+            __m256 best = _mm256_set1_ps(FLT_MAX);
+            __m256 bestIndex = _mm256_setzero_ps();
+            for (uint32 p = 0; p < palette.count; ++p)
+            {
+                __m256 error = _mm256_setzero_ps();
+                for (uint32 c = firstChannel; c < lastChannel; ++c)
+                {
+                    const __m256 d = _mm256_sub_ps(channels[c], _mm256_set1_ps(palette.colors[p][c]));
+                    error = _mm256_add_ps(error, _mm256_mul_ps(d, d));
+                }
+                const __m256 less = _mm256_cmp_ps(error, best, _CMP_LT_OQ);
+                best = _mm256_blendv_ps(best, error, less);
+                bestIndex = _mm256_blendv_ps(bestIndex, _mm256_set1_ps((float)p), less);
+            }
+
+            _mm256_storeu_ps(errors + group, best);
+            alignas(32) std::int32_t bestIndices[8];
+            _mm256_store_si256((__m256i*)bestIndices, _mm256_cvttps_epi32(bestIndex));
+            for (uint32 i = 0; i < 8; ++i)
+                indices[group + i] = (uint8)bestIndices[i];
+        }
+    }
+#endif
+
+    // 返回16个像素的误差之和
+    float FindNearest(SimdLevel level, const BlockPixels& pixels, const Palette& palette, uint32 firstChannel, uint32 channelCount,
+        uint8 indices[16])
+    {
+        float errors[16];
+#if BC_X86
+        if (level == SimdLevel::Avx2)
+            FindNearestAvx2(pixels, palette, firstChannel, channelCount, indices, errors);
+        else if (level == SimdLevel::Sse2)
+            FindNearestSse2(pixels, palette, firstChannel, channelCount, indices, errors);
+        else
+#endif
+            FindNearestScalar(pixels, palette, firstChannel, channelCount, indices, errors);
+
+        float total = 0.0f;
+        for (uint32 i = 0; i < 16; ++i)
+            total += errors[i];
+        return total;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // 端点的初始值：像素在主成分方向上投影的两端
+
+    uint32 PopCount16(uint32 mask)
+    {
+        uint32 count = 0;
+        for (; mask != 0; mask &= mask - 1)
+            ++count;
+        return count;
+    }
+
+    // pixelMask中的像素在前channelCount个通道上的主成分方向（power iteration），所有像素相同时返回false
+    bool ComputeEndpoints(const BlockPixels& pixels, uint32 channelCount, uint32 pixelMask, float e0[4], float e1[4])
+    {
+        const float count = (float)PopCount16(pixelMask);
+        float mean[4] = {};
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            if (pixelMask & (1u << i))
+            {
+                for (uint32 c = 0; c < channelCount; ++c)
+                    mean[c] += pixels.channels[c][i];
+            }
+        }
+        for (uint32 c = 0; c < channelCount; ++c)
+            mean[c] /= count;
+
+        float covariance[4][4] = {};
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            if (!(pixelMask & (1u << i)))
+                continue;
+            float d[4];
+            for (uint32 c = 0; c < channelCount; ++c)
+                d[c] = pixels.channels[c][i] - mean[c];
+            for (uint32 a = 0; a < channelCount; ++a)
+            {
+                for (uint32 b = 0; b < channelCount; ++b)
+                    covariance[a][b] += d[a] * d[b];
+            }
+        }
+
+        // 从方差最大的通道所在的列开始迭代
+        uint32 start = 0;
+        for (uint32 c = 1; c < channelCount; ++c)
+        {
+            if (covariance[c][c] > covariance[start][start])
+                start = c;
+        }
+        float axis[4] = {};
+        for (uint32 c = 0; c < channelCount; ++c)
+            axis[c] = covariance[c][start];
+        for (uint32 iteration = 0; iteration < 8; ++iteration)
+        {
+            float next[4] = {};
+            float largest = 0.0f;
+            for (uint32 a = 0; a < channelCount; ++a)
+            {
+                for (uint32 b = 0; b < channelCount; ++b)
+                    next[a] += covariance[a][b] * axis[b];
+                largest = (std::max)(largest, std::fabs(next[a]));
+            }
+            if (largest < 1e-6f)
+                break;
+            for (uint32 c = 0; c < channelCount; ++c)
+                axis[c] = next[c] / largest;
+        }
+
+        float length = 0.0f;
+        for (uint32 c = 0; c < channelCount; ++c)
+            length += axis[c] * axis[c];
+        if (length < 1e-12f)
+        {
+            for (uint32 c = 0; c < channelCount; ++c)
+                e0[c] = e1[c] = mean[c];
+            return false;
+        }
+        length = std::sqrt(length);
+        for (uint32 c = 0; c < channelCount; ++c)
+            axis[c] /= length;
+
+        float minProjection = FLT_MAX;
+        float maxProjection = -FLT_MAX;
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            if (!(pixelMask & (1u << i)))
+                continue;
+            float projection = 0.0f;
+            for (uint32 c = 0; c < channelCount; ++c)
+                projection += (pixels.channels[c][i] - mean[c]) * axis[c];
+            minProjection = (std::min)(minProjection, projection);
+            maxProjection = (std::max)(maxProjection, projection);
+        }
+        for (uint32 c = 0; c < channelCount; ++c)
+        {
+            e0[c] = (std::min)((std::max)(mean[c] + minProjection * axis[c], 0.0f), 255.0f);
+            e1[c] = (std::min)((std::max)(mean[c] + maxProjection * axis[c], 0.0f), 255.0f);
+        }
+        return true;
+    }
+
+    // 固定每个像素的下标（weights为下标对应的从e0到e1的比例），用最小二乘求端点。方程退化时返回false
+    bool RefineEndpoints(const BlockPixels& pixels, uint32 channelCount, uint32 pixelMask, const uint8 indices[16], const float* weights,
+        float e0[4], float e1[4])
+    {
+        float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+        float ax[4] = {}, bx[4] = {};
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            if (!(pixelMask & (1u << i)))
+                continue;
+            const float b = weights[indices[i]];
+            const float a = 1.0f - b;
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            for (uint32 c = 0; c < channelCount; ++c)
+            {
+                ax[c] += a * pixels.channels[c][i];
+                bx[c] += b * pixels.channels[c][i];
+            }
+        }
+        const float determinant = aa * bb - ab * ab;
+        if (std::fabs(determinant) < 1e-6f)
+            return false;
+        for (uint32 c = 0; c < channelCount; ++c)
+        {
+            e0[c] = (std::min)((std::max)((bb * ax[c] - ab * bx[c]) / determinant, 0.0f), 255.0f);
+            e1[c] = (std::min)((std::max)((aa * bx[c] - ab * ax[c]) / determinant, 0.0f), 255.0f);
+        }
+        return true;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // BC1的颜色部分，BC3中也使用
+
+    uint16 PackRgb565(const float color[3])
+    {
+        const uint32 r = (uint32)(std::min)((std::max)((int)(color[0] * 31.0f / 255.0f + 0.5f), 0), 31);
+        const uint32 g = (uint32)(std::min)((std::max)((int)(color[1] * 63.0f / 255.0f + 0.5f), 0), 63);
+        const uint32 b = (uint32)(std::min)((std::max)((int)(color[2] * 31.0f / 255.0f + 0.5f), 0), 31);
+        return (uint16)((r << 11) | (g << 5) | b);
+    }
+
+    void UnpackRgb565(uint16 value, uint32 rgb[3])
+    {
+        const uint32 r = value >> 11;
+        const uint32 g = (value >> 5) & 0x3f;
+        const uint32 b = value & 0x1f;
+        rgb[0] = (r << 3) | (r >> 2);
+        rgb[1] = (g << 2) | (g >> 4);
+        rgb[2] = (b << 3) | (b >> 2);
+    }
+
+    // c0 > c1或者alwaysFourColor（BC3）时为4色，否则为3色，第4项是透明黑色
+    void ColorPalette(uint16 c0, uint16 c1, bool alwaysFourColor, uint32 colors[4][4])
+    {
+        UnpackRgb565(c0, colors[0]);
+        UnpackRgb565(c1, colors[1]);
+        colors[0][3] = colors[1][3] = 255;
+        if (alwaysFourColor || c0 > c1)
+        {
+            for (uint32 c = 0; c < 3; ++c)
+            {
+                colors[2][c] = (2 * colors[0][c] + colors[1][c]) / 3;
+                colors[3][c] = (colors[0][c] + 2 * colors[1][c]) / 3;
+            }
+            colors[2][3] = colors[3][3] = 255;
+        }
+        else
+        {
+            for (uint32 c = 0; c < 3; ++c)
+            {
+                colors[2][c] = (colors[0][c] + colors[1][c]) / 2;
+                colors[3][c] = 0;
+            }
+            colors[2][3] = 255;
+            colors[3][3] = 0;
+        }
+    }
+
+    // transparentMask中的像素固定使用下标3，不计入误差
+    float EvaluateColorBlock(SimdLevel level, const BlockPixels& pixels, uint16 c0, uint16 c1, bool alwaysFourColor,
+        uint32 transparentMask, uint8 indices[16])
+    {
+        uint32 colors[4][4];
+        ColorPalette(c0, c1, alwaysFourColor, colors);
+        Palette palette;
+        palette.count = (alwaysFourColor || c0 > c1) ? 4 : 3;
+        for (uint32 p = 0; p < palette.count; ++p)
+        {
+            for (uint32 c = 0; c < 4; ++c)
+                palette.colors[p][c] = (float)colors[p][c];
+        }
+
+        if (transparentMask == 0)
+            return FindNearest(level, pixels, palette, 0, 3, indices);
+
+        // 透明像素的颜色换成第0项，误差为0，之后再改成下标3
+        BlockPixels masked = pixels;
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            if (transparentMask & (1u << i))
+            {
+                for (uint32 c = 0; c < 3; ++c)
+                    masked.channels[c][i] = palette.colors[0][c];
+            }
+        }
+        const float error = FindNearest(level, masked, palette, 0, 3, indices);
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            if (transparentMask & (1u << i))
+                indices[i] = 3;
+        }
+        return error;
+    }
+
+    void WriteColorBlock(uint16 c0, uint16 c1, const uint8 indices[16], uint8* block)
+    {
+        uint32 bits = 0;
+        for (uint32 i = 0; i < 16; ++i)
+            bits |= (uint32)indices[i] << (i * 2);
+        block[0] = (uint8)c0;
+        block[1] = (uint8)(c0 >> 8);
+        block[2] = (uint8)c1;
+        block[3] = (uint8)(c1 >> 8);
+        for (uint32 i = 0; i < 4; ++i)
+            block[4 + i] = (uint8)(bits >> (i * 8));
+    }
+
+    // allowTransparent为BC1中有alpha小于128的像素时使用3色模式，alwaysFourColor为BC3的颜色部分
+    void EncodeColorBlock(SimdLevel level, const BlockPixels& pixels, bool allowTransparent, bool alwaysFourColor,
+        uint32 refineIterations, uint8* block)
+    {
+        uint32 transparentMask = 0;
+        if (allowTransparent)
+        {
+            for (uint32 i = 0; i < 16; ++i)
+            {
+                if (pixels.channels[3][i] < 128.0f)
+                    transparentMask |= 1u << i;
+            }
+        }
+        const uint32 opaqueMask = 0xffff & ~transparentMask;
+        uint8 indices[16];
+        if (opaqueMask == 0)
+        {
+            // c0 == c1时为3色模式，全部使用透明的下标3
+            std::fill(indices, indices + 16, (uint8)3);
+            WriteColorBlock(0, 0, indices, block);
+            return;
+        }
+
+        // 4色模式要求c0 > c1，3色模式要求c0 <= c1
+        const bool fourColor = transparentMask == 0;
+        auto order = [fourColor](uint16& c0, uint16& c1)
+        {
+            if (fourColor ? c0 < c1 : c0 > c1)
+                std::swap(c0, c1);
+        };
+
+        float e0[4], e1[4];
+        ComputeEndpoints(pixels, 3, opaqueMask, e0, e1);
+        uint16 c0 = PackRgb565(e1);
+        uint16 c1 = PackRgb565(e0);
+        order(c0, c1);
+        float bestError = EvaluateColorBlock(level, pixels, c0, c1, alwaysFourColor, transparentMask, indices);
+
+        // 下标对应的从c0到c1的比例
+        static const float FourColorWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+        static const float ThreeColorWeights[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+        for (uint32 iteration = 0; iteration < refineIterations && bestError > 0.0f; ++iteration)
+        {
+            const bool isFourColor = alwaysFourColor || c0 > c1;
+            if (!RefineEndpoints(pixels, 3, opaqueMask, indices, isFourColor ? FourColorWeights : ThreeColorWeights, e0, e1))
+                break;
+            uint16 refined0 = PackRgb565(e0);
+            uint16 refined1 = PackRgb565(e1);
+            order(refined0, refined1);
+            uint8 refinedIndices[16];
+            const float error = EvaluateColorBlock(level, pixels, refined0, refined1, alwaysFourColor, transparentMask, refinedIndices);
+            if (error >= bestError)
+                break;
+            bestError = error;
+            c0 = refined0;
+            c1 = refined1;
+            std::copy(refinedIndices, refinedIndices + 16, indices);
+        }
+        WriteColorBlock(c0, c1, indices, block);
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // 解码时把下标展开为调色板中的值。像素打包为uint32（R在最低字节），
+    // AVX2用permutevar8x32一次查8个像素，标量逐个像素查表，结果相同
+
+    // 16个2位下标
+    void ExpandIndices2Scalar(const uint32 palette[8], uint32 bits, uint32 pixels[16])
+    {
+        for (uint32 i = 0; i < 16; ++i)
+            pixels[i] = palette[(bits >> (i * 2)) & 3];
+    }
+
+    // 16个3位下标，palette中只有channelMask所在的字节不为0，只替换pixels中的这个通道
+    void ExpandIndices3Scalar(const uint32 palette[8], uint64 bits, uint32 channelMask, uint32 pixels[16])
+    {
+        for (uint32 i = 0; i < 16; ++i)
+            pixels[i] = (pixels[i] & ~channelMask) | palette[(bits >> (i * 3)) & 7];
+    }
+
+#if BC_X86
+    BC_TARGET_AVX2 void ExpandIndices2Avx2(const uint32 palette[8], uint32 bits, uint32 pixels[16])
+    {
+        const __m256i table = _mm256_loadu_si256((const __m256i*)palette);
+        const __m256i shifts = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+        const __m256i mask = _mm256_set1_epi32(3);
+        for (uint32 half = 0; half < 2; ++half)
+        {
+            const __m256i indices = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int)(bits >> (half * 16))), shifts), mask);
+            _mm256_storeu_si256((__m256i*)(pixels + half * 8), _mm256_permutevar8x32_epi32(table, indices));
+        }
+    }
+
+    BC_TARGET_AVX2 void ExpandIndices3Avx2(const uint32 palette[8], uint64 bits, uint32 channelMask, uint32 pixels[16])
+    {
+        const __m256i table = _mm256_loadu_si256((const __m256i*)palette);
+        const __m256i shifts = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+        const __m256i mask = _mm256_set1_epi32(7);
+        const __m256i keep = _mm256_set1_epi32((int)~channelMask);
+        for (uint32 half = 0; half < 2; ++half)
+        {
+            const int packed = (int)((bits >> (half * 24)) & 0xffffff);
+            const __m256i indices = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(packed), shifts), mask);
+            const __m256i current = _mm256_loadu_si256((const __m256i*)(pixels + half * 8));
+            const __m256i values = _mm256_or_si256(_mm256_and_si256(current, keep), _mm256_permutevar8x32_epi32(table, indices));
+            _mm256_storeu_si256((__m256i*)(pixels + half * 8), values);
+        }
+    }
+#endif
+
+    void ExpandIndices2(SimdLevel level, const uint32 palette[8], uint32 bits, uint32 pixels[16])
+    {
+#if BC_X86
+        if (level == SimdLevel::Avx2)
+            return ExpandIndices2Avx2(palette, bits, pixels);
+#endif
+        (void)level;
+        ExpandIndices2Scalar(palette, bits, pixels);
+    }
+
+    void ExpandIndices3(SimdLevel level, const uint32 palette[8], uint64 bits, uint32 channelMask, uint32 pixels[16])
+    {
+#if BC_X86
+        if (level == SimdLevel::Avx2)
+            return ExpandIndices3Avx2(palette, bits, channelMask, pixels);
+#endif
+        (void)level;
+        ExpandIndices3Scalar(palette, bits, channelMask, pixels);
+    }
+
+    void DecodeColorBlock(SimdLevel level, const uint8* block, bool alwaysFourColor, uint32 pixels[16])
+    {
+        const uint16 c0 = (uint16)(block[0] | (block[1] << 8));
+        const uint16 c1 = (uint16)(block[2] | (block[3] << 8));
+        const uint32 bits = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32)block[7] << 24);
+        uint32 colors[4][4];
+        ColorPalette(c0, c1, alwaysFourColor, colors);
+        uint32 palette[8] = {};
+        for (uint32 p = 0; p < 4; ++p)
+            palette[p] = colors[p][0] | (colors[p][1] << 8) | (colors[p][2] << 16) | (colors[p][3] << 24);
+        ExpandIndices2(level, palette, bits, pixels);
+    }
+
+    // BC2每个像素4位的alpha
+    void DecodeExplicitAlphaBlock(const uint8* block, uint32 pixels[16])
+    {
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            const uint32 alpha = (block[i / 2] >> ((i & 1) * 4)) & 0xf;
+            pixels[i] = (pixels[i] & 0x00ffffff) | ((alpha * 17) << 24);
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // BC4的单通道块，BC3的alpha、BC5的两个通道都使用
+
+    // a0 > a1时6个插值，否则4个插值加0和255
+    void SingleChannelPalette(uint32 a0, uint32 a1, uint32 values[8])
+    {
+        values[0] = a0;
+        values[1] = a1;
+        if (a0 > a1)
+        {
+            for (uint32 i = 2; i < 8; ++i)
+                values[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+        }
+        else
+        {
+            for (uint32 i = 2; i < 6; ++i)
+                values[i] = ((6 - i) * a0 + (i - 1) * a1) / 5;
+            values[6] = 0;
+            values[7] = 255;
+        }
+    }
+
+    float EvaluateSingleChannelBlock(SimdLevel level, const BlockPixels& pixels, uint32 channel, uint32 a0, uint32 a1, uint8 indices[16])
+    {
+        uint32 values[8];
+        SingleChannelPalette(a0, a1, values);
+        Palette palette;
+        palette.count = 8;
+        for (uint32 p = 0; p < 8; ++p)
+            palette.colors[p][channel] = (float)values[p];
+        return FindNearest(level, pixels, palette, channel, 1, indices);
+    }
+
+    void EncodeSingleChannelBlock(SimdLevel level, const BlockPixels& pixels, uint32 channel, uint8* block)
+    {
+        const float* values = pixels.channels[channel];
+        uint32 minValue = 255, maxValue = 0;
+        uint32 innerMin = 255, innerMax = 0;       // 不算0和255
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            const uint32 value = (uint32)values[i];
+            minValue = (std::min)(minValue, value);
+            maxValue = (std::max)(maxValue, value);
+            if (value != 0 && value != 255)
+            {
+                innerMin = (std::min)(innerMin, value);
+                innerMax = (std::max)(innerMax, value);
+            }
+        }
+
+        // 6个插值覆盖整个范围，4个插值加上精确的0和255适合同时有极值和中间值的块
+        uint8 indices[16];
+        uint32 a0 = maxValue, a1 = minValue;
+        float bestError = EvaluateSingleChannelBlock(level, pixels, channel, a0, a1, indices);
+        if (bestError > 0.0f && (minValue == 0 || maxValue == 255))
+        {
+            if (innerMin > innerMax)
+                innerMin = innerMax = 0;
+            uint8 innerIndices[16];
+            const float error = EvaluateSingleChannelBlock(level, pixels, channel, innerMin, innerMax, innerIndices);
+            if (error < bestError)
+            {
+                a0 = innerMin;
+                a1 = innerMax;
+                std::copy(innerIndices, innerIndices + 16, indices);
+            }
+        }
+
+        uint64 bits = 0;
+        for (uint32 i = 0; i < 16; ++i)
+            bits |= (uint64)indices[i] << (i * 3);
+        block[0] = (uint8)a0;
+        block[1] = (uint8)a1;
+        for (uint32 i = 0; i < 6; ++i)
+            block[2 + i] = (uint8)(bits >> (i * 8));
+    }
+
+    uint64 SingleChannelIndexBits(const uint8* block)
+    {
+        uint64 bits = 0;
+        for (uint32 i = 0; i < 6; ++i)
+            bits |= (uint64)block[2 + i] << (i * 8);
+        return bits;
+    }
+
+    void DecodeSingleChannelBlock(SimdLevel level, const uint8* block, uint32 channel, uint32 pixels[16])
+    {
+        uint32 values[8];
+        SingleChannelPalette(block[0], block[1], values);
+        uint32 palette[8];
+        for (uint32 p = 0; p < 8; ++p)
+            palette[p] = values[p] << (channel * 8);
+        ExpandIndices3(level, palette, SingleChannelIndexBits(block), 0xffu << (channel * 8), pixels);
+    }
+
+    // SNORM的BC4块，端点为有符号数，-128与-127相同。与D3D相同按浮点数插值
+    void DecodeSignedChannelBlock(const uint8* block, uint32 channel, float rgba[64])
+    {
+        const int a0 = (std::max)((int)(std::int8_t)block[0], -127);
+        const int a1 = (std::max)((int)(std::int8_t)block[1], -127);
+        float values[8];
+        values[0] = (float)a0 / 127.0f;
+        values[1] = (float)a1 / 127.0f;
+        if (a0 > a1)
+        {
+            for (int i = 2; i < 8; ++i)
+                values[i] = (float)((8 - i) * a0 + (i - 1) * a1) / (7.0f * 127.0f);
+        }
+        else
+        {
+            for (int i = 2; i < 6; ++i)
+                values[i] = (float)((6 - i) * a0 + (i - 1) * a1) / (5.0f * 127.0f);
+            values[6] = -1.0f;
+            values[7] = 1.0f;
+        }
+        const uint64 bits = SingleChannelIndexBits(block);
+        for (uint32 i = 0; i < 16; ++i)
+            rgba[i * 4 + channel] = values[(bits >> (i * 3)) & 7];
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // BC7
+
+    const uint32 Bc7Weights2[4] = { 0, 21, 43, 64 };
+    const uint32 Bc7Weights3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+    const uint32 Bc7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    const uint32* Bc7Weights(uint32 indexBits)
+    {
+        return indexBits == 2 ? Bc7Weights2 : (indexBits == 3 ? Bc7Weights3 : Bc7Weights4);
+    }
+
+    uint32 Bc7Interpolate(uint32 e0, uint32 e1, uint32 weight)
+    {
+        return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+    }
+
+    struct Bc7ModeInfo
+    {
+        uint32 subsetCount;
+        uint32 partitionBits;
+        uint32 rotationBits;
+        uint32 indexSelectionBits;
+        uint32 colorBits;
+        uint32 alphaBits;
+        uint32 endpointPBits;       // 每个端点一个p-bit
+        uint32 sharedPBits;         // 每个subset的两个端点共用一个p-bit
+        uint32 indexBits;
+        uint32 secondaryIndexBits;
+    };
+
+    const Bc7ModeInfo Bc7Modes[8] =
+    {
+        { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+        { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+        { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+        { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+        { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+        { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+        { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+        { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+    };
+
+    // 两个subset的分区，第i位为第i个像素所属的subset
+    const uint16 Bc7Partitions2[64] =
+    {
+        0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80, 0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+        0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce, 0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+        0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a, 0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+        0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c, 0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22,
+    };
+
+    // 三个subset的分区，每个像素2位
+    const uint32 Bc7Partitions3[64] =
+    {
+        0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8, 0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+        0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090, 0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+        0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0, 0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+        0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400, 0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+        0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424, 0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+        0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0, 0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+        0xaa444444, 0x54a854a8, 0x95809580, 0x96969600, 0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+        0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000, 0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254,
+    };
+
+    // 第二个subset的anchor像素（两个subset时）
+    const uint8 Bc7Anchors2[64] =
+    {
+        15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+        15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+        15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+         6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15,
+    };
+
+    // 三个subset时第二、第三个subset的anchor像素
+    const uint8 Bc7Anchors3a[64] =
+    {
+         3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+         3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+         8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+         3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3,
+    };
+
+    const uint8 Bc7Anchors3b[64] =
+    {
+        15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+        15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+        15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+        15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8,
+    };
+
+    class BitReader
+    {
+    public:
+        explicit BitReader(const uint8* data) : m_data(data) {}
+
+        uint32 Read(uint32 count)
+        {
+            uint32 value = 0;
+            for (uint32 i = 0; i < count; ++i, ++m_position)
+                value |= (uint32)((m_data[m_position >> 3] >> (m_position & 7)) & 1) << i;
+            return value;
+        }
+
+    private:
+        const uint8* m_data;
+        uint32 m_position = 0;
+    };
+
+    class BitWriter
+    {
+    public:
+        // data需要先清零
+        explicit BitWriter(uint8* data) : m_data(data) {}
+
+        void Write(uint32 value, uint32 count)
+        {
+            for (uint32 i = 0; i < count; ++i, ++m_position)
+                m_data[m_position >> 3] |= (uint8)(((value >> i) & 1) << (m_position & 7));
+        }
+
+    private:
+        uint8* m_data;
+        uint32 m_position = 0;
+    };
+
+    uint32 Bc7Subset(const Bc7ModeInfo& mode, uint32 partition, uint32 pixel)
+    {
+        if (mode.subsetCount == 2)
+            return (Bc7Partitions2[partition] >> pixel) & 1;
+        if (mode.subsetCount == 3)
+            return (Bc7Partitions3[partition] >> (pixel * 2)) & 3;
+        return 0;
+    }
+
+    bool IsBc7Anchor(const Bc7ModeInfo& mode, uint32 partition, uint32 pixel)
+    {
+        if (pixel == 0)
+            return true;
+        if (mode.subsetCount == 2)
+            return pixel == Bc7Anchors2[partition];
+        if (mode.subsetCount == 3)
+            return pixel == Bc7Anchors3a[partition] || pixel == Bc7Anchors3b[partition];
+        return false;
+    }
+
+    // 端点（含p-bit）共bits位，高位复制到低位扩展为8位
+    uint32 ExpandBits(uint32 value, uint32 bits)
+    {
+        value <<= 8 - bits;
+        return value | (value >> bits);
+    }
+
+    void DecodeBc7Block(const uint8* block, uint8 rgba[64])
+    {
+        uint32 modeIndex = 0;
+        while (modeIndex < 8 && !(block[0] & (1u << modeIndex)))
+            ++modeIndex;
+        if (modeIndex == 8)
+        {
+            // 保留的模式解码为透明黑色
+            std::fill(rgba, rgba + 64, (uint8)0);
+            return;
+        }
+
+        const Bc7ModeInfo& mode = Bc7Modes[modeIndex];
+        BitReader reader(block);
+        reader.Read(modeIndex + 1);
+        const uint32 partition = reader.Read(mode.partitionBits);
+        const uint32 rotation = reader.Read(mode.rotationBits);
+        const uint32 indexSelection = reader.Read(mode.indexSelectionBits);
+
+        // endpoints[subset * 2 + 端点][通道]，先依次读取所有端点的R，然后G、B、A
+        uint32 endpoints[6][4] = {};
+        const uint32 endpointCount = mode.subsetCount * 2;
+        for (uint32 c = 0; c < 3; ++c)
+        {
+            for (uint32 e = 0; e < endpointCount; ++e)
+                endpoints[e][c] = reader.Read(mode.colorBits);
+        }
+        for (uint32 e = 0; e < endpointCount && mode.alphaBits > 0; ++e)
+            endpoints[e][3] = reader.Read(mode.alphaBits);
+
+        uint32 pBits[6] = {};
+        const bool hasPBit = mode.endpointPBits > 0 || mode.sharedPBits > 0;
+        if (mode.endpointPBits > 0)
+        {
+            for (uint32 e = 0; e < endpointCount; ++e)
+                pBits[e] = reader.Read(1);
+        }
+        else if (mode.sharedPBits > 0)
+        {
+            for (uint32 s = 0; s < mode.subsetCount; ++s)
+                pBits[s * 2] = pBits[s * 2 + 1] = reader.Read(1);
+        }
+
+        for (uint32 e = 0; e < endpointCount; ++e)
+        {
+            for (uint32 c = 0; c < 4; ++c)
+            {
+                const uint32 bits = c < 3 ? mode.colorBits : mode.alphaBits;
+                if (bits == 0)
+                {
+                    endpoints[e][c] = 255;
+                    continue;
+                }
+                uint32 value = endpoints[e][c];
+                if (hasPBit)
+                    value = (value << 1) | pBits[e];
+                endpoints[e][c] = ExpandBits(value, bits + (hasPBit ? 1 : 0));
+            }
+        }
+
+        // anchor像素的下标最高位固定为0，少存一位
+        uint32 indices[16], secondaryIndices[16] = {};
+        for (uint32 i = 0; i < 16; ++i)
+            indices[i] = reader.Read(mode.indexBits - (IsBc7Anchor(mode, partition, i) ? 1 : 0));
+        for (uint32 i = 0; i < 16 && mode.secondaryIndexBits > 0; ++i)
+            secondaryIndices[i] = reader.Read(mode.secondaryIndexBits - (i == 0 ? 1 : 0));
+
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            const uint32 subset = Bc7Subset(mode, partition, i);
+            const uint32* e0 = endpoints[subset * 2];
+            const uint32* e1 = endpoints[subset * 2 + 1];
+            uint32 colorWeight = Bc7Weights(mode.indexBits)[indices[i]];
+            uint32 alphaWeight = colorWeight;
+            if (mode.secondaryIndexBits > 0)
+            {
+                // mode 4、5的颜色和alpha使用两组下标，indexSelection为1时交换
+                alphaWeight = Bc7Weights(mode.secondaryIndexBits)[secondaryIndices[i]];
+                if (indexSelection)
+                {
+                    colorWeight = Bc7Weights(mode.secondaryIndexBits)[secondaryIndices[i]];
+                    alphaWeight = Bc7Weights(mode.indexBits)[indices[i]];
+                }
+            }
+
+            uint8* pixel = rgba + i * 4;
+            for (uint32 c = 0; c < 3; ++c)
+                pixel[c] = (uint8)Bc7Interpolate(e0[c], e1[c], colorWeight);
+            pixel[3] = (uint8)Bc7Interpolate(e0[3], e1[3], alphaWeight);
+            if (rotation > 0)
+                std::swap(pixel[3], pixel[rotation - 1]);
+        }
+    }
+
+    // mode 6的端点：RGBA各7位，加上每个端点一个p-bit
+    struct Bc7Mode6Endpoints
+    {
+        uint32 values[2][4];        // 7位
+        uint32 pBits[2];
+    };
+
+    float EvaluateBc7Mode6(SimdLevel level, const BlockPixels& pixels, const Bc7Mode6Endpoints& endpoints, uint8 indices[16])
+    {
+        uint32 e[2][4];
+        for (uint32 i = 0; i < 2; ++i)
+        {
+            for (uint32 c = 0; c < 4; ++c)
+                e[i][c] = (endpoints.values[i][c] << 1) | endpoints.pBits[i];
+        }
+        Palette palette;
+        palette.count = 16;
+        for (uint32 p = 0; p < 16; ++p)
+        {
+            for (uint32 c = 0; c < 4; ++c)
+                palette.colors[p][c] = (float)Bc7Interpolate(e[0][c], e[1][c], Bc7Weights4[p]);
+        }
+        return FindNearest(level, pixels, palette, 0, 4, indices);
+    }
+
+    // 对4种p-bit组合分别量化端点，返回误差最小的
+    float QuantizeBc7Mode6(SimdLevel level, const BlockPixels& pixels, const float e0[4], const float e1[4],
+        Bc7Mode6Endpoints& best, uint8 bestIndices[16])
+    {
+        float bestError = FLT_MAX;
+        for (uint32 combination = 0; combination < 4; ++combination)
+        {
+            Bc7Mode6Endpoints endpoints;
+            endpoints.pBits[0] = combination & 1;
+            endpoints.pBits[1] = combination >> 1;
+            for (uint32 c = 0; c < 4; ++c)
+            {
+                const float values[2] = { e0[c], e1[c] };
+                for (uint32 i = 0; i < 2; ++i)
+                {
+                    const int q = (int)std::floor((values[i] - (float)endpoints.pBits[i]) * 0.5f + 0.5f);
+                    endpoints.values[i][c] = (uint32)(std::min)((std::max)(q, 0), 127);
+                }
+            }
+            uint8 indices[16];
+            const float error = EvaluateBc7Mode6(level, pixels, endpoints, indices);
+            if (error < bestError)
+            {
+                bestError = error;
+                best = endpoints;
+                std::copy(indices, indices + 16, bestIndices);
+            }
+        }
+        return bestError;
+    }
+
+    void EncodeBc7Mode6(SimdLevel level, const BlockPixels& pixels, uint32 refineIterations, uint8* block)
+    {
+        float e0[4], e1[4];
+        ComputeEndpoints(pixels, 4, 0xffff, e0, e1);
+        Bc7Mode6Endpoints endpoints;
+        uint8 indices[16];
+        float bestError = QuantizeBc7Mode6(level, pixels, e0, e1, endpoints, indices);
+
+        float weights[16];
+        for (uint32 i = 0; i < 16; ++i)
+            weights[i] = (float)Bc7Weights4[i] / 64.0f;
+        for (uint32 iteration = 0; iteration < refineIterations && bestError > 0.0f; ++iteration)
+        {
+            if (!RefineEndpoints(pixels, 4, 0xffff, indices, weights, e0, e1))
+                break;
+            Bc7Mode6Endpoints refined;
+            uint8 refinedIndices[16];
+            const float error = QuantizeBc7Mode6(level, pixels, e0, e1, refined, refinedIndices);
+            if (error >= bestError)
+                break;
+            bestError = error;
+            endpoints = refined;
+            std::copy(refinedIndices, refinedIndices + 16, indices);
+        }
+
+        // 第0个像素是anchor，下标的最高位必须为0，否则交换两个端点
+        if (indices[0] & 8)
+        {
+            std::swap(endpoints.values[0], endpoints.values[1]);
+            std::swap(endpoints.pBits[0], endpoints.pBits[1]);
+            for (uint32 i = 0; i < 16; ++i)
+                indices[i] = (uint8)(15 - indices[i]);
+        }
+
+        std::memset(block, 0, 16);
+        BitWriter writer(block);
+        writer.Write(1 << 6, 7);
+        for (uint32 c = 0; c < 4; ++c)
+        {
+            writer.Write(endpoints.values[0][c], 7);
+            writer.Write(endpoints.values[1][c], 7);
+        }
+        writer.Write(endpoints.pBits[0], 1);
+        writer.Write(endpoints.pBits[1], 1);
+        writer.Write(indices[0], 3);
+        for (uint32 i = 1; i < 16; ++i)
+            writer.Write(indices[i], 4);
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // BC6H，只有RGB，每个通道解码为半精度浮点数
+
+    // 端点和分区号的字段，端点为w、x（第一个区域）和y、z（第二个区域）
+    enum Bc6Field : uint8
+    {
+        End, RW, RX, RY, RZ, GW, GX, GY, GZ, BW, BX, BY, BZ, D,
+    };
+
+    // 依次读取字段的第low到第high位，high < low时从高位往低位读
+    struct Bc6Segment
+    {
+        uint8 field;
+        uint8 high;
+        uint8 low;
+    };
+
+    struct Bc6ModeInfo
+    {
+        uint32 code;                // 2位或5位的模式号
+        uint32 regionCount;
+        bool transformed;           // x、y、z保存的是与w的差
+        uint32 endpointBits;
+        uint32 deltaBits[3];
+        Bc6Segment segments[25];
+    };
+
+    const Bc6ModeInfo Bc6Modes[14] =
+    {
+        { 0x00, 2, true, 10, { 5, 5, 5 }, { { GY, 4, 4 }, { BY, 4, 4 }, { BZ, 4, 4 }, { RW, 9, 0 }, { GW, 9, 0 }, { BW, 9, 0 }, { RX, 4, 0 },
+            { GZ, 4, 4 }, { GY, 3, 0 }, { GX, 4, 0 }, { BZ, 0, 0 }, { GZ, 3, 0 }, { BX, 4, 0 }, { BZ, 1, 1 }, { BY, 3, 0 }, { RY, 4, 0 },
+            { BZ, 2, 2 }, { RZ, 4, 0 }, { BZ, 3, 3 }, { D, 4, 0 } } },
+        { 0x01, 2, true, 7, { 6, 6, 6 }, { { GY, 5, 5 }, { GZ, 4, 4 }, { GZ, 5, 5 }, { RW, 6, 0 }, { BZ, 0, 0 }, { BZ, 1, 1 }, { BY, 4, 4 },
+            { GW, 6, 0 }, { BY, 5, 5 }, { BZ, 2, 2 }, { GY, 4, 4 }, { BW, 6, 0 }, { BZ, 3, 3 }, { BZ, 5, 5 }, { BZ, 4, 4 }, { RX, 5, 0 },
+            { GY, 3, 0 }, { GX, 5, 0 }, { GZ, 3, 0 }, { BX, 5, 0 }, { BY, 3, 0 }, { RY, 5, 0 }, { RZ, 5, 0 }, { D, 4, 0 } } },
+        { 0x02, 2, true, 11, { 5, 4, 4 }, { { RW, 9, 0 }, { GW, 9, 0 }, { BW, 9, 0 }, { RX, 4, 0 }, { RW, 10, 10 }, { GY, 3, 0 }, { GX, 3, 0 },
+            { GW, 10, 10 }, { BZ, 0, 0 }, { GZ, 3, 0 }, { BX, 3, 0 }, { BW, 10, 10 }, { BZ, 1, 1 }, { BY, 3, 0 }, { RY, 4, 0 }, { BZ, 2, 2 },
+            { RZ, 4, 0 }, { BZ, 3, 3 }, { D, 4, 0 } } },
+        { 0x06, 2, true, 11, { 4, 5, 4 }, { { RW, 9, 0 }, { GW, 9, 0 }, { BW, 9, 0 }, { RX, 3, 0 }, { RW, 10, 10 }, { GZ, 4, 4 }, { GY, 3, 0 },
+            { GX, 4, 0 }, { GW, 10, 10 }, { GZ, 3, 0 }, { BX, 3, 0 }, { BW, 10, 10 }, { BZ, 1, 1 }, { BY, 3, 0 }, { RY, 3, 0 }, { BZ, 0, 0 },
+            { BZ, 2, 2 }, { RZ, 3, 0 }, { GY, 4, 4 }, { BZ, 3, 3 }, { D, 4, 0 } } },
+        { 0x0a, 2, true, 11, { 4, 4, 5 }, { { RW, 9, 0 }, { GW, 9, 0 }, { BW, 9, 0 }, { RX, 3, 0 }, { RW, 10, 10 }, { BY, 4, 4 }, { GY, 3, 0 },
+            { GX, 3, 0 }, { GW, 10, 10 }, { BZ, 0, 0 }, { GZ, 3, 0 }, { BX, 4, 0 }, { BW, 10, 10 }, { BY, 3, 0 }, { RY, 3, 0 }, { BZ, 1, 1 },
+            { BZ, 2, 2 }, { RZ, 3, 0 }, { BZ, 4, 4 }, { BZ, 3, 3 }, { D, 4, 0 } } },
+        { 0x0e, 2, true, 9, { 5, 5, 5 }, { { RW, 8, 0 }, { BY, 4, 4 }, { GW, 8, 0 }, { GY, 4, 4 }, { BW, 8, 0 }, { BZ, 4, 4 }, { RX, 4, 0 },
+            { GZ, 4, 4 }, { GY, 3, 0 }, { GX, 4, 0 }, { BZ, 0, 0 }, { GZ, 3, 0 }, { BX, 4, 0 }, { BZ, 1, 1 }, { BY, 3, 0 }, { RY, 4, 0 },
+            { BZ, 2, 2 }, { RZ, 4, 0 }, { BZ, 3, 3 }, { D, 4, 0 } } },
+        { 0x12, 2, true, 8, { 6, 5, 5 }, { { RW, 7, 0 }, { GZ, 4, 4 }, { BY, 4, 4 }, { GW, 7, 0 }, { BZ, 2, 2 }, { GY, 4, 4 }, { BW, 7, 0 },
+            { BZ, 3, 3 }, { BZ, 4, 4 }, { RX, 5, 0 }, { GY, 3, 0 }, { GX, 4, 0 }, { BZ, 0, 0 }, { GZ, 3, 0 }, { BX, 4, 0 }, { BZ, 1, 1 },
+            { BY, 3, 0 }, { RY, 5, 0 }, { RZ, 5, 0 }, { D, 4, 0 } } },
+        { 0x16, 2, true, 8, { 5, 6, 5 }, { { RW, 7, 0 }, { BZ, 0, 0 }, { BY, 4, 4 }, { GW, 7, 0 }, { GY, 5, 5 }, { GY, 4, 4 }, { BW, 7, 0 },
+            { GZ, 5, 5 }, { BZ, 4, 4 }, { RX, 4, 0 }, { GZ, 4, 4 }, { GY, 3, 0 }, { GX, 5, 0 }, { GZ, 3, 0 }, { BX, 4, 0 }, { BZ, 1, 1 },
+            { BY, 3, 0 }, { RY, 4, 0 }, { BZ, 2, 2 }, { RZ, 4, 0 }, { BZ, 3, 3 }, { D, 4, 0 } } },
+        { 0x1a, 2, true, 8, { 5, 5, 6 }, { { RW, 7, 0 }, { BZ, 1, 1 }, { BY, 4, 4 }, { GW, 7, 0 }, { BY, 5, 5 }, { GY, 4, 4 }, { BW, 7, 0 },
+            { BZ, 5, 5 }, { BZ, 4, 4 }, { RX, 4, 0 }, { GZ, 4, 4 }, { GY, 3, 0 }, { GX, 4, 0 }, { BZ, 0, 0 }, { GZ, 3, 0 }, { BX, 5, 0 },
+            { BY, 3, 0 }, { RY, 4, 0 }, { BZ, 2, 2 }, { RZ, 4, 0 }, { BZ, 3, 3 }, { D, 4, 0 } } },
+        { 0x1e, 2, false, 6, { 6, 6, 6 }, { { RW, 5, 0 }, { GZ, 4, 4 }, { BZ, 0, 0 }, { BZ, 1, 1 }, { BY, 4, 4 }, { GW, 5, 0 }, { GY, 5, 5 },
+            { BY, 5, 5 }, { BZ, 2, 2 }, { GY, 4, 4 }, { BW, 5, 0 }, { GZ, 5, 5 }, { BZ, 3, 3 }, { BZ, 5, 5 }, { BZ, 4, 4 }, { RX, 5, 0 },
+            { GY, 3, 0 }, { GX, 5, 0 }, { GZ, 3, 0 }, { BX, 5, 0 }, { BY, 3, 0 }, { RY, 5, 0 }, { RZ, 5, 0 }, { D, 4, 0 } } },
+        { 0x03, 1, false, 10, { 10, 10, 10 }, { { RW, 9, 0 }, { GW, 9, 0 }, { BW, 9, 0 }, { RX, 9, 0 }, { GX, 9, 0 }, { BX, 9, 0 } } },
+        { 0x07, 1, true, 11, { 9, 9, 9 }, { { RW, 9, 0 }, { GW, 9, 0 }, { BW, 9, 0 }, { RX, 8, 0 }, { RW, 10, 10 }, { GX, 8, 0 }, { GW, 10, 10 },
+            { BX, 8, 0 }, { BW, 10, 10 } } },
+        { 0x0b, 1, true, 12, { 8, 8, 8 }, { { RW, 9, 0 }, { GW, 9, 0 }, { BW, 9, 0 }, { RX, 7, 0 }, { RW, 10, 11 }, { GX, 7, 0 }, { GW, 10, 11 },
+            { BX, 7, 0 }, { BW, 10, 11 } } },
+        { 0x0f, 1, true, 16, { 4, 4, 4 }, { { RW, 9, 0 }, { GW, 9, 0 }, { BW, 9, 0 }, { RX, 3, 0 }, { RW, 10, 15 }, { GX, 3, 0 }, { GW, 10, 15 },
+            { BX, 3, 0 }, { BW, 10, 15 } } },
+    };
+
+    int SignExtend(int value, uint32 bits)
+    {
+        const int signBit = 1 << (bits - 1);
+        return (value & signBit) ? value | ~((signBit << 1) - 1) : value;
+    }
+
+    // 把endpointBits位的端点扩展到16位（有符号时为15位加符号）
+    int Bc6Unquantize(int value, uint32 bits, bool isSigned)
+    {
+        if (!isSigned)
+        {
+            if (bits >= 15 || value == 0)
+                return value;
+            if (value == (1 << bits) - 1)
+                return 0xffff;
+            return ((value << 16) + 0x8000) >> bits;
+        }
+
+        if (bits >= 16 || value == 0)
+            return value;
+        const bool negative = value < 0;
+        const int magnitude = negative ? -value : value;
+        const int result = magnitude >= (1 << (bits - 1)) - 1 ? 0x7fff : ((magnitude << 15) + 0x4000) >> (bits - 1);
+        return negative ? -result : result;
+    }
+
+    // 插值后的值缩放到半精度浮点数的范围（乘以31/64或31/32），得到它的位
+    uint16 Bc6FinishUnquantize(int value, bool isSigned)
+    {
+        if (!isSigned)
+            return (uint16)((value * 31) >> 6);
+        return value < 0 ? (uint16)(((-value * 31) >> 5) | 0x8000) : (uint16)((value * 31) >> 5);
+    }
+
+    void DecodeBc6hBlock(const uint8* block, bool isSigned, uint16 rgba[64])
+    {
+        const uint32 modeCode = (block[0] & 3) < 2 ? (block[0] & 3) : (block[0] & 0x1f);
+        const Bc6ModeInfo* mode = nullptr;
+        for (const Bc6ModeInfo& candidate : Bc6Modes)
+        {
+            if (candidate.code == modeCode)
+                mode = &candidate;
+        }
+        if (mode == nullptr)
+        {
+            // 保留的模式解码为0
+            for (uint32 i = 0; i < 16; ++i)
+            {
+                rgba[i * 4] = rgba[i * 4 + 1] = rgba[i * 4 + 2] = 0;
+                rgba[i * 4 + 3] = 0x3c00;
+            }
+            return;
+        }
+
+        BitReader reader(block);
+        reader.Read(modeCode < 2 ? 2 : 5);
+        int fields[14] = {};
+        for (const Bc6Segment& segment : mode->segments)
+        {
+            if (segment.field == End)
+                break;
+            int& value = fields[segment.field];
+            if (segment.high >= segment.low)
+            {
+                for (uint32 bit = segment.low; bit <= segment.high; ++bit)
+                    value |= (int)reader.Read(1) << bit;
+            }
+            else
+            {
+                for (uint32 bit = segment.low + 1; bit-- > segment.high;)
+                    value |= (int)reader.Read(1) << bit;
+            }
+        }
+
+        // endpoints[端点][通道]，端点依次为w、x、y、z
+        const uint32 endpointCount = mode->regionCount * 2;
+        const uint32 bits = mode->endpointBits;
+        int endpoints[4][3];
+        for (uint32 e = 0; e < 4; ++e)
+        {
+            for (uint32 c = 0; c < 3; ++c)
+                endpoints[e][c] = fields[RW + c * 4 + e];
+        }
+        for (uint32 c = 0; c < 3; ++c)
+        {
+            if (isSigned)
+                endpoints[0][c] = SignExtend(endpoints[0][c], bits);
+            for (uint32 e = 1; e < endpointCount; ++e)
+            {
+                if (isSigned || mode->transformed)
+                    endpoints[e][c] = SignExtend(endpoints[e][c], mode->transformed ? mode->deltaBits[c] : bits);
+                if (mode->transformed)
+                {
+                    endpoints[e][c] = (endpoints[0][c] + endpoints[e][c]) & ((1 << bits) - 1);
+                    if (isSigned)
+                        endpoints[e][c] = SignExtend(endpoints[e][c], bits);
+                }
+            }
+            for (uint32 e = 0; e < endpointCount; ++e)
+                endpoints[e][c] = Bc6Unquantize(endpoints[e][c], bits, isSigned);
+        }
+
+        // 两个区域时使用BC7两个subset的前32个分区，下标3位；一个区域时下标4位。anchor像素的下标少一位
+        const uint32 partition = (uint32)fields[D];
+        const uint32 indexBits = mode->regionCount == 2 ? 3 : 4;
+        const uint32* weights = Bc7Weights(indexBits);
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            const uint32 region = mode->regionCount == 2 ? (Bc7Partitions2[partition] >> i) & 1 : 0;
+            const bool anchor = i == 0 || (mode->regionCount == 2 && i == Bc7Anchors2[partition]);
+            const int weight = (int)weights[reader.Read(anchor ? indexBits - 1 : indexBits)];
+            for (uint32 c = 0; c < 3; ++c)
+            {
+                const int e0 = endpoints[region * 2][c];
+                const int e1 = endpoints[region * 2 + 1][c];
+                rgba[i * 4 + c] = Bc6FinishUnquantize(((64 - weight) * e0 + weight * e1 + 32) >> 6, isSigned);
+            }
+            rgba[i * 4 + 3] = 0x3c00;
+        }
+    }
+
+    // ---------------------------------------------------------------------------------------------
+
+    SimdLevel EffectiveSimdLevel(SimdLevel requested)
+    {
+        return (std::min)(requested, DetectSimdLevel());
+    }
+
+    void CompressBlockWithLevel(BlockFormat format, const uint8 rgba[64], uint8* block, const BlockCompressOptions& options, SimdLevel level)
+    {
+        BlockPixels pixels;
+        LoadBlock(rgba, pixels);
+        switch (format)
+        {
+        case BlockFormat::BC1:
+            EncodeColorBlock(level, pixels, options.bc1Alpha, false, options.refineIterations, block);
+            break;
+        case BlockFormat::BC3:
+            EncodeSingleChannelBlock(level, pixels, 3, block);
+            EncodeColorBlock(level, pixels, false, true, options.refineIterations, block + 8);
+            break;
+        case BlockFormat::BC4:
+            EncodeSingleChannelBlock(level, pixels, 0, block);
+            break;
+        case BlockFormat::BC5:
+            EncodeSingleChannelBlock(level, pixels, 0, block);
+            EncodeSingleChannelBlock(level, pixels, 1, block + 8);
+            break;
+        case BlockFormat::BC7:
+            EncodeBc7Mode6(level, pixels, options.refineIterations, block);
+            break;
+        default:
+            assert(CanCompress(format));
+            break;
+        }
+    }
+
+    uint8 UnitFloatToUnorm8(float value)
+    {
+        return (uint8)((std::min)((std::max)(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+
+    // BC4S、BC5S解码为[-1, 1]的浮点数，没有的通道G、B为0，A为1
+    void DecodeSignedBlock(BlockFormat format, const uint8* block, float rgba[64])
+    {
+        for (uint32 i = 0; i < 16; ++i)
+        {
+            rgba[i * 4 + 1] = rgba[i * 4 + 2] = 0.0f;
+            rgba[i * 4 + 3] = 1.0f;
+        }
+        DecodeSignedChannelBlock(block, 0, rgba);
+        if (format == BlockFormat::BC5Signed)
+            DecodeSignedChannelBlock(block + 8, 1, rgba);
+    }
+
+    // 解码为RGBA8，BC6H截断到[0, 1]，SNORM从[-1, 1]映射到[0, 255]
+    void DecodeBlock(SimdLevel level, BlockFormat format, const uint8* block, uint8 rgba[64])
+    {
+        uint32 pixels[16];
+        switch (format)
+        {
+        case BlockFormat::BC1:
+            DecodeColorBlock(level, block, false, pixels);
+            break;
+        case BlockFormat::BC2:
+            DecodeColorBlock(level, block + 8, true, pixels);
+            DecodeExplicitAlphaBlock(block, pixels);
+            break;
+        case BlockFormat::BC3:
+            DecodeColorBlock(level, block + 8, true, pixels);
+            DecodeSingleChannelBlock(level, block, 3, pixels);
+            break;
+        case BlockFormat::BC4:
+        case BlockFormat::BC5:
+            // 没有的通道与D3D相同，G、B为0，A为1
+            std::fill(pixels, pixels + 16, 0xff000000u);
+            DecodeSingleChannelBlock(level, block, 0, pixels);
+            if (format == BlockFormat::BC5)
+                DecodeSingleChannelBlock(level, block + 8, 1, pixels);
+            break;
+        case BlockFormat::BC7:
+            DecodeBc7Block(block, rgba);
+            return;
+        case BlockFormat::BC4Signed:
+        case BlockFormat::BC5Signed:
+        {
+            float values[64];
+            DecodeSignedBlock(format, block, values);
+            for (uint32 i = 0; i < 64; ++i)
+                rgba[i] = UnitFloatToUnorm8(values[i] * 0.5f + 0.5f);
+            return;
+        }
+        case BlockFormat::BC6HUnsigned:
+        case BlockFormat::BC6HSigned:
+        {
+            uint16 values[64];
+            DecodeBc6hBlock(block, format == BlockFormat::BC6HSigned, values);
+            for (uint32 i = 0; i < 64; ++i)
+                rgba[i] = UnitFloatToUnorm8(HalfToFloat(values[i]));
+            return;
+        }
+        }
+        std::memcpy(rgba, pixels, sizeof(pixels));
+    }
+
+    // 0~255的UNORM对应的半精度浮点数
+    struct UnormToHalfTable
+    {
+        uint16 values[256];
+
+        UnormToHalfTable()
+        {
+            for (uint32 i = 0; i < 256; ++i)
+                values[i] = FloatToHalf((float)i / 255.0f);
+        }
+    };
+
+    void DecodeBlockHalf(SimdLevel level, BlockFormat format, const uint8* block, uint16 rgba[64])
+    {
+        static const UnormToHalfTable unormToHalf;
+        switch (format)
+        {
+        case BlockFormat::BC6HUnsigned:
+        case BlockFormat::BC6HSigned:
+            DecodeBc6hBlock(block, format == BlockFormat::BC6HSigned, rgba);
+            break;
+        case BlockFormat::BC4Signed:
+        case BlockFormat::BC5Signed:
+        {
+            float values[64];
+            DecodeSignedBlock(format, block, values);
+            for (uint32 i = 0; i < 64; ++i)
+                rgba[i] = FloatToHalf(values[i]);
+            break;
+        }
+        default:
+        {
+            uint8 values[64];
+            DecodeBlock(level, format, block, values);
+            for (uint32 i = 0; i < 64; ++i)
+                rgba[i] = unormToHalf.values[values[i]];
+            break;
+        }
+        }
+    }
+
+    // 每行由一个线程处理，行数少于线程数时只启动需要的线程
+    template<typename Function>
+    void ParallelForRows(uint32 rowCount, uint32 threadCount, const Function& function)
+    {
+        if (threadCount == 0)
+            threadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+        threadCount = (std::min)(threadCount, rowCount);
+        if (threadCount <= 1)
+        {
+            for (uint32 row = 0; row < rowCount; ++row)
+                function(row);
+            return;
+        }
+
+        std::atomic<uint32> nextRow(0);
+        auto worker = [&]()
+        {
+            for (uint32 row = nextRow++; row < rowCount; row = nextRow++)
+                function(row);
+        };
+        std::vector<std::thread> threads;
+        for (uint32 i = 1; i < threadCount; ++i)
+            threads.emplace_back(worker);
+        worker();
+        for (auto& thread : threads)
+            thread.join();
+    }
+}
+
+SimdLevel DetectSimdLevel()
+{
+#if BC_X86
+    static const SimdLevel level = []()
+    {
+#if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+        __cpuid(info, 1);
+        const bool sse2 = (info[3] & (1 << 26)) != 0;
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        bool avx2 = false;
+        // 操作系统需要保存YMM寄存器
+        if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6)
+        {
+            __cpuidex(info, 7, 0);
+            avx2 = (info[1] & (1 << 5)) != 0;
+        }
+        return avx2 ? SimdLevel::Avx2 : (sse2 ? SimdLevel::Sse2 : SimdLevel::Scalar);
+#else
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return SimdLevel::Avx2;
+        return __builtin_cpu_supports("sse2") ? SimdLevel::Sse2 : SimdLevel::Scalar;
+#endif
+    }();
+    return level;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const char* SimdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::Sse2: return "sse2";
+    case SimdLevel::Avx2: return "avx2";
+    default: return "scalar";
+    }
+}
+
+const char* BlockFormatName(BlockFormat format)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1: return "BC1";
+    case BlockFormat::BC2: return "BC2";
+    case BlockFormat::BC3: return "BC3";
+    case BlockFormat::BC4: return "BC4";
+    case BlockFormat::BC4Signed: return "BC4S";
+    case BlockFormat::BC5: return "BC5";
+    case BlockFormat::BC5Signed: return "BC5S";
+    case BlockFormat::BC6HUnsigned: return "BC6HU";
+    case BlockFormat::BC6HSigned: return "BC6HS";
+    default: return "BC7";
+    }
+}
+
+bool CanCompress(BlockFormat format)
+{
+    switch (format)
+    {
+    case BlockFormat::BC1:
+    case BlockFormat::BC3:
+    case BlockFormat::BC4:
+    case BlockFormat::BC5:
+    case BlockFormat::BC7:
+        return true;
+    default:
+        return false;
+    }
+}
+
+std::size_t BlockSize(BlockFormat format)
+{
+    return (format == BlockFormat::BC1 || format == BlockFormat::BC4 || format == BlockFormat::BC4Signed) ? 8 : 16;
+}
+
+void CompressBlock(BlockFormat format, const std::uint8_t rgba[64], std::uint8_t* block, const BlockCompressOptions& options)
+{
+    CompressBlockWithLevel(format, rgba, block, options, EffectiveSimdLevel(options.simdLevel));
+}
+
+void DecompressBlock(BlockFormat format, const std::uint8_t* block, std::uint8_t rgba[64])
+{
+    DecodeBlock(DetectSimdLevel(), format, block, rgba);
+}
+
+void DecompressBlockHalf(BlockFormat format, const std::uint8_t* block, std::uint16_t rgba[64])
+{
+    DecodeBlockHalf(DetectSimdLevel(), format, block, rgba);
+}
+
+void CompressImage(BlockFormat format, const std::uint8_t* rgba, std::uint32_t width, std::uint32_t height, std::size_t rowPitch,
+    std::uint8_t* blocks, const BlockCompressOptions& options)
+{
+    const uint32 blocksWide = (width + 3) / 4;
+    const uint32 blocksHigh = (height + 3) / 4;
+    const std::size_t blockSize = BlockSize(format);
+    const SimdLevel level = EffectiveSimdLevel(options.simdLevel);
+    ParallelForRows(blocksHigh, options.threadCount, [&](uint32 blockY)
+    {
+        uint8 pixels[64];
+        for (uint32 blockX = 0; blockX < blocksWide; ++blockX)
+        {
+            for (uint32 y = 0; y < 4; ++y)
+            {
+                const uint32 sourceY = (std::min)(blockY * 4 + y, height - 1);
+                for (uint32 x = 0; x < 4; ++x)
+                {
+                    const uint32 sourceX = (std::min)(blockX * 4 + x, width - 1);
+                    std::memcpy(pixels + (y * 4 + x) * 4, rgba + sourceY * rowPitch + sourceX * 4, 4);
+                }
+            }
+            CompressBlockWithLevel(format, pixels, blocks + ((std::size_t)blockY * blocksWide + blockX) * blockSize, options, level);
+        }
+    });
+}
+
+namespace
+{
+    // Pixel为输出的一个通道的类型
+    template<typename Pixel, typename Decode>
+    void DecompressRows(BlockFormat format, const uint8* blocks, uint32 width, uint32 height, uint8* output, std::size_t rowPitch,
+        uint32 threadCount, const Decode& decode)
+    {
+        const uint32 blocksWide = (width + 3) / 4;
+        const uint32 blocksHigh = (height + 3) / 4;
+        const std::size_t blockSize = BlockSize(format);
+        const std::size_t pixelSize = sizeof(Pixel) * 4;
+        ParallelForRows(blocksHigh, threadCount, [&](uint32 blockY)
+        {
+            Pixel pixels[64];
+            for (uint32 blockX = 0; blockX < blocksWide; ++blockX)
+            {
+                decode(blocks + ((std::size_t)blockY * blocksWide + blockX) * blockSize, pixels);
+                const uint32 columns = (std::min)(4u, width - blockX * 4);
+                for (uint32 y = 0; y < 4 && blockY * 4 + y < height; ++y)
+                    std::memcpy(output + (blockY * 4 + y) * rowPitch + blockX * 4 * pixelSize, pixels + y * 16, columns * pixelSize);
+            }
+        });
+    }
+}
+
+void DecompressImage(BlockFormat format, const std::uint8_t* blocks, std::uint32_t width, std::uint32_t height,
+    std::uint8_t* rgba, std::size_t rowPitch, std::uint32_t threadCount, SimdLevel simdLevel)
+{
+    const SimdLevel level = EffectiveSimdLevel(simdLevel);
+    DecompressRows<uint8>(format, blocks, width, height, rgba, rowPitch, threadCount, [&](const uint8* block, uint8* pixels)
+    {
+        DecodeBlock(level, format, block, pixels);
+    });
+}
+
+void DecompressImageHalf(BlockFormat format, const std::uint8_t* blocks, std::uint32_t width, std::uint32_t height,
+    std::uint16_t* rgba, std::size_t rowPitch, std::uint32_t threadCount, SimdLevel simdLevel)
+{
+    const SimdLevel level = EffectiveSimdLevel(simdLevel);
+    DecompressRows<uint16>(format, blocks, width, height, (uint8*)rgba, rowPitch, threadCount, [&](const uint8* block, uint16* pixels)
+    {
+        DecodeBlockHalf(level, format, block, pixels);
+    });
+}
+
+float HalfToFloat(std::uint16_t value)
+{
+    const uint32 sign = (uint32)(value & 0x8000) << 16;
+    const uint32 exponent = (value >> 10) & 0x1f;
+    const uint32 mantissa = value & 0x3ff;
+    uint32 bits;
+    if (exponent == 0x1f)
+        bits = sign | 0x7f800000 | (mantissa << 13);
+    else if (exponent != 0)
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    else
+    {
+        // 非规格化数为mantissa * 2^-24
+        const float magnitude = (float)mantissa * (1.0f / 16777216.0f);
+        return sign ? -magnitude : magnitude;
+    }
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+std::uint16_t FloatToHalf(float value)
+{
+    uint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint32 sign = (bits >> 16) & 0x8000;
+    const uint32 magnitude = bits & 0x7fffffff;
+    if (magnitude >= 0x7f800000)
+        return (std::uint16_t)(sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0));
+    // 65520及以上舍入后为无穷大
+    if (magnitude >= 0x477ff000)
+        return (std::uint16_t)(sign | 0x7c00);
+
+    uint32 result, remainder, halfway;
+    if (magnitude < 0x38800000)
+    {
+        // 小于2^-14时为非规格化数，小于2^-25时为0
+        if (magnitude < 0x33000000)
+            return (std::uint16_t)sign;
+        const uint32 shift = 126 - (magnitude >> 23);
+        const uint32 mantissa = (magnitude & 0x7fffff) | 0x800000;
+        result = mantissa >> shift;
+        remainder = mantissa & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+    }
+    else
+    {
+        // 指数的偏移从127改为15
+        result = (magnitude - 0x38000000) >> 13;
+        remainder = magnitude & 0x1fff;
+        halfway = 0x1000;
+    }
+    if (remainder > halfway || (remainder == halfway && (result & 1)))
+        ++result;
+    return (std::uint16_t)(sign | result);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// CPU上的BC（block compression）编码和解码，不依赖任何图形API，输入输出都是RGBA8。
+// 每4x4个像素为一个块，BC1、BC4每块8字节，BC3、BC5、BC7每块16字节。
+// 编码时最耗时的是为16个像素在调色板中找误差最小的一项，这部分有标量、SSE2、AVX2三个实现，
+// 默认使用CPU支持的最高级别，整张图按块行分给多个线程。
+// BC7只使用mode 6（一个subset，RGBA端点各7位加p-bit，4位下标），速度和BC3接近，颜色和alpha的质量都好于BC1、BC3。
+// 解码支持BC1~BC7的所有格式，用来计算编码的误差、在CI中比较texture、生成缩略图，以及在不支持BC格式的设备上展开为RGBA。
+// BC1~BC5把下标展开为颜色的部分有AVX2实现，BC6H、BC7逐个块解码，整张图同样按块行分给多个线程。
+// 解码与D3D的规则相同（BC1、BC4的插值向下取整），BC6H解码为半精度浮点数，输出RGBA8时截断到[0, 1]。
+
+enum class BlockFormat
+{
+    BC1,        // RGB，alpha小于128的像素可以编码为透明
+    BC3,        // RGB + 独立的alpha
+    BC4,        // 只有R
+    BC5,        // R、G，一般用于法线
+    BC7,        // RGBA
+    // 以下格式只能解码
+    BC2,        // RGB + 4位的alpha
+    BC4Signed,  // [-1, 1]的R，输出RGBA8时映射到[0, 255]
+    BC5Signed,
+    BC6HUnsigned,   // 半精度浮点数的RGB
+    BC6HSigned,
+};
+
+enum class SimdLevel
+{
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+// CPU和操作系统都支持的最高级别
+SimdLevel DetectSimdLevel();
+const char* SimdLevelName(SimdLevel level);
+
+const char* BlockFormatName(BlockFormat format);
+bool CanCompress(BlockFormat format);
+// 每块的字节数
+std::size_t BlockSize(BlockFormat format);
+
+struct BlockCompressOptions
+{
+    SimdLevel simdLevel = DetectSimdLevel();    // 超过CPU支持的级别时自动降低
+    std::uint32_t threadCount = 0;              // 0为std::thread::hardware_concurrency
+    bool bc1Alpha = true;                       // BC1中有alpha小于128的像素时使用3色 + 透明的模式
+    std::uint32_t refineIterations = 1;         // 根据选出的下标用最小二乘重新计算端点的次数
+};
+
+// 压缩一个块，rgba为按行排列的16个像素，format必须满足CanCompress
+void CompressBlock(BlockFormat format, const std::uint8_t rgba[64], std::uint8_t* block, const BlockCompressOptions& options);
+void DecompressBlock(BlockFormat format, const std::uint8_t* block, std::uint8_t rgba[64]);
+// 解码为半精度浮点数，RGBA8的格式按UNORM转换（sRGB需要调用者转换），BC6H、SNORM保留原来的范围
+void DecompressBlockHalf(BlockFormat format, const std::uint8_t* block, std::uint16_t rgba[64]);
+
+// 宽高不是4的倍数时，边缘的块重复最后一行、一列补齐。blocks按块行排列，每行(width + 3) / 4块
+void CompressImage(BlockFormat format, const std::uint8_t* rgba, std::uint32_t width, std::uint32_t height, std::size_t rowPitch,
+    std::uint8_t* blocks, const BlockCompressOptions& options);
+// threadCount为0时使用std::thread::hardware_concurrency，simdLevel用于比较不同实现的速度和结果
+void DecompressImage(BlockFormat format, const std::uint8_t* blocks, std::uint32_t width, std::uint32_t height,
+    std::uint8_t* rgba, std::size_t rowPitch, std::uint32_t threadCount = 0, SimdLevel simdLevel = DetectSimdLevel());
+// rowPitch为输出每行的字节数，每个像素8字节
+void DecompressImageHalf(BlockFormat format, const std::uint8_t* blocks, std::uint32_t width, std::uint32_t height,
+    std::uint16_t* rgba, std::size_t rowPitch, std::uint32_t threadCount = 0, SimdLevel simdLevel = DetectSimdLevel());
+
+// 半精度浮点数和float的转换，float转换时按round to nearest even，超出范围为无穷大
+float HalfToFloat(std::uint16_t value);
+std::uint16_t FloatToHalf(float value);
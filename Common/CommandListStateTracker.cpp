@@ -0,0 +1,53 @@
+#include "CommandListStateTracker.h"
+
+CommandListStateTracker::CommandListStateTracker() :
+    m_tracker(D3D12_RESOURCE_STATE_GENERIC_READ | D3D12_RESOURCE_STATE_DEPTH_READ)
+{
+}
+
+void CommandListStateTracker::Reset()
+{
+    m_tracker.Reset();
+}
+
+void CommandListStateTracker::SetInitialState(ID3D12Resource* resource, D3D12_RESOURCE_STATES state)
+{
+    m_tracker.SetInitialState(resource, state);
+}
+
+void CommandListStateTracker::Transition(ID3D12Resource* resource, D3D12_RESOURCE_STATES after)
+{
+    m_tracker.Transition(resource, after);
+}
+
+void CommandListStateTracker::FlushBarriers(ID3D12GraphicsCommandList* commandList)
+{
+    m_tracker.FlushBarriers(m_barriers);
+    RecordBarriers(commandList);
+}
+
+bool CommandListStateTracker::ResolvePendingBarriers(D3D12ResourceStateRegistry& registry)
+{
+    m_tracker.ResolvePendingBarriers(registry, m_barriers);
+    return !m_barriers.empty();
+}
+
+void CommandListStateTracker::RecordResolvedBarriers(ID3D12GraphicsCommandList* preambleList)
+{
+    RecordBarriers(preambleList);
+    m_barriers.clear();
+}
+
+void CommandListStateTracker::RecordBarriers(ID3D12GraphicsCommandList* commandList)
+{
+    if (m_barriers.empty())
+        return;
+
+    m_d3dBarriers.clear();
+    for (auto& barrier : m_barriers)
+    {
+        m_d3dBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(barrier.resource,
+            (D3D12_RESOURCE_STATES)barrier.before, (D3D12_RESOURCE_STATES)barrier.after));
+    }
+    commandList->ResourceBarrier((UINT)m_d3dBarriers.size(), m_d3dBarriers.data());
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "d3d12Util.h"
+#include "ResourceStateTracker.h"
+#include <vector>
+
+using D3D12ResourceStateRegistry = ResourceStateRegistry<ID3D12Resource*>;
+
+// ResourceStateTracker的D3D12版本，积累的barrier用一次ResourceBarrier调用记录到command list中
+class CommandListStateTracker
+{
+public:
+    using Stats = ResourceStateTracker<ID3D12Resource*>::Stats;
+
+    CommandListStateTracker();
+
+    // command list Reset后调用
+    void Reset();
+    void SetInitialState(ID3D12Resource* resource, D3D12_RESOURCE_STATES state);
+    void Transition(ID3D12Resource* resource, D3D12_RESOURCE_STATES after);
+    void FlushBarriers(ID3D12GraphicsCommandList* commandList);
+
+    // 提交前调用，生成初始状态未知的resource需要的barrier，返回是否有这样的barrier，没有时不需要preamble command list
+    bool ResolvePendingBarriers(D3D12ResourceStateRegistry& registry);
+    // 把ResolvePendingBarriers生成的barrier记录到preambleList中，preambleList要在主command list之前执行
+    void RecordResolvedBarriers(ID3D12GraphicsCommandList* preambleList);
+
+    const Stats& GetStats()const { return m_tracker.GetStats(); }
+
+private:
+    void RecordBarriers(ID3D12GraphicsCommandList* commandList);
+
+    ResourceStateTracker<ID3D12Resource*> m_tracker;
+    std::vector<ResourceStateTracker<ID3D12Resource*>::Barrier> m_barriers;
+    std::vector<D3D12_RESOURCE_BARRIER> m_d3dBarriers;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "MpscQueue.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// 延迟释放GPU可能还在使用的对象（ComPtr<ID3D12Resource>、upload buffer、文件映射等）。
+// Retire时带上一个fence值，对象的所有权转移到队列中，直到GPU完成的fence值不小于它时才在ReleaseCompleted中批量析构，
+// 不需要FlushCommandQueue等待GPU。
+// Retire可以在任意线程调用，ReleaseCompleted只能在一个线程（通常是渲染线程）调用。
+class DeferredReleaseQueue
+{
+public:
+    using uint64 = std::uint64_t;
+
+    DeferredReleaseQueue() = default;
+    DeferredReleaseQueue(const DeferredReleaseQueue& rhs) = delete;
+    DeferredReleaseQueue& operator=(const DeferredReleaseQueue& rhs) = delete;
+
+    // handle的析构函数负责释放，例如ComPtr会调用Release
+    template<typename T>
+    void Retire(T&& handle, uint64 fenceValue)
+    {
+        Entry entry;
+        entry.fenceValue = fenceValue;
+        entry.item = std::make_unique<Item<typename std::decay<T>::type>>(std::forward<T>(handle));
+        m_incoming.Push(std::move(entry));
+    }
+
+    // 释放所有fenceValue <= completedFenceValue的对象，返回释放的个数
+    size_t ReleaseCompleted(uint64 completedFenceValue)
+    {
+        // 先把其他线程提交的对象取出来，按fence值排成小顶堆
+        Entry entry;
+        while (m_incoming.Pop(entry))
+        {
+            m_pending.push_back(std::move(entry));
+            std::push_heap(m_pending.begin(), m_pending.end(), CompareFence);
+        }
+
+        size_t releaseCount = 0;
+        while (!m_pending.empty() && m_pending.front().fenceValue <= completedFenceValue)
+        {
+            std::pop_heap(m_pending.begin(), m_pending.end(), CompareFence);
+            m_pending.pop_back();
+            ++releaseCount;
+        }
+        return releaseCount;
+    }
+
+    // 已经取出但还未释放的对象数量，不包含还在MPSC队列中的
+    size_t PendingCount()const { return m_pending.size(); }
+
+private:
+    struct ItemBase
+    {
+        virtual ~ItemBase() = default;
+    };
+
+    template<typename T>
+    struct Item : ItemBase
+    {
+        explicit Item(T&& value) : handle(std::move(value)) {}
+        explicit Item(const T& value) : handle(value) {}
+        T handle;
+    };
+
+    struct Entry
+    {
+        uint64 fenceValue = 0;
+        std::unique_ptr<ItemBase> item;
+    };
+
+    static bool CompareFence(const Entry& a, const Entry& b)
+    {
+        return a.fenceValue > b.fenceValue;
+    }
+
+    MpscQueue<Entry> m_incoming;
+    std::vector<Entry> m_pending;
+};
@@ -0,0 +1,169 @@
+#include "DescriptorAllocator.h"
+
+DescriptorAllocator::DescriptorAllocator(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT descriptorsPerPage) :
+    m_device(device),
+    m_type(type),
+    m_descriptorsPerPage(descriptorsPerPage)
+{
+    m_descriptorSize = m_device->GetDescriptorHandleIncrementSize(type);
+}
+
+DescriptorHandle DescriptorAllocator::Allocate(UINT count)
+{
+    DescriptorHandle handle;
+    UINT index = FreeListIndexAllocator::InvalidIndex;
+    UINT pageIndex = 0;
+    for (; pageIndex < (UINT)m_pages.size(); ++pageIndex)
+    {
+        index = m_pages[pageIndex]->allocator.Allocate(count);
+        if (index != FreeListIndexAllocator::InvalidIndex)
+            break;
+    }
+
+    if (index == FreeListIndexAllocator::InvalidIndex)
+    {
+        // 已有的page都放不下，新建一个
+        UINT capacity = count > m_descriptorsPerPage ? count : m_descriptorsPerPage;
+        auto page = std::make_unique<Page>(capacity);
+
+        D3D12_DESCRIPTOR_HEAP_DESC heapDesc;
+        heapDesc.NumDescriptors = capacity;
+        heapDesc.Type = m_type;
+        heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+        heapDesc.NodeMask = 0;
+        ThrowIfFailed(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&page->heap)));
+        page->start = page->heap->GetCPUDescriptorHandleForHeapStart();
+
+        index = page->allocator.Allocate(count);
+        pageIndex = (UINT)m_pages.size();
+        m_pages.push_back(std::move(page));
+    }
+
+    handle.cpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_pages[pageIndex]->start, index, m_descriptorSize);
+    handle.count = count;
+    handle.pageIndex = pageIndex;
+    handle.index = index;
+    return handle;
+}
+
+void DescriptorAllocator::Free(DescriptorHandle& handle)
+{
+    if (!handle.IsValid())
+        return;
+
+    m_pages[handle.pageIndex]->allocator.Free(handle.index, handle.count);
+    handle = DescriptorHandle();
+}
+
+DescriptorRing::DescriptorRing(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity, UINT staticCapacity) :
+    m_device(device),
+    m_type(type),
+    m_staticCapacity(staticCapacity),
+    m_allocator(capacity)
+{
+    m_descriptorSize = m_device->GetDescriptorHandleIncrementSize(type);
+
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc;
+    heapDesc.NumDescriptors = staticCapacity + capacity;
+    heapDesc.Type = type;
+    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    heapDesc.NodeMask = 0;
+    ThrowIfFailed(m_device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_heap)));
+}
+
+DescriptorTable DescriptorRing::GetStaticTable()const
+{
+    DescriptorTable table;
+    table.cpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_heap->GetCPUDescriptorHandleForHeapStart());
+    table.gpuHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_heap->GetGPUDescriptorHandleForHeapStart());
+    table.count = m_staticCapacity;
+    table.descriptorSize = m_descriptorSize;
+    return table;
+}
+
+DescriptorTable DescriptorRing::Allocate(UINT count)
+{
+    UINT index = m_allocator.Allocate(count);
+    if (index == RingIndexAllocator::InvalidIndex)
+        ThrowIfFailed(E_OUTOFMEMORY);
+    index += m_staticCapacity;
+
+    DescriptorTable table;
+    table.cpuHandle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_heap->GetCPUDescriptorHandleForHeapStart(), index, m_descriptorSize);
+    table.gpuHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_heap->GetGPUDescriptorHandleForHeapStart(), index, m_descriptorSize);
+    table.count = count;
+    table.descriptorSize = m_descriptorSize;
+    return table;
+}
+
+DescriptorTable DescriptorRing::Copy(const DescriptorHandle* sources, UINT sourceCount)
+{
+    if (sourceCount == 0)
+        return DescriptorTable();
+
+    m_sourceStarts.clear();
+    m_sourceSizes.clear();
+    UINT count = 0;
+    for (UINT i = 0; i < sourceCount; ++i)
+    {
+        m_sourceStarts.push_back(sources[i].cpuHandle);
+        m_sourceSizes.push_back(sources[i].count);
+        count += sources[i].count;
+    }
+
+    DescriptorTable table = Allocate(count);
+    D3D12_CPU_DESCRIPTOR_HANDLE destStart = table.cpuHandle;
+    m_device->CopyDescriptors(1, &destStart, &count, sourceCount, m_sourceStarts.data(), m_sourceSizes.data(), m_type);
+    return table;
+}
+
+void DescriptorRing::RetireSubmitted(UINT64 fenceValue)
+{
+    m_allocator.RetireSubmitted(fenceValue);
+}
+
+void DescriptorRing::ReleaseCompleted(UINT64 completedFenceValue)
+{
+    m_allocator.ReleaseCompleted(completedFenceValue);
+}
+
+BindlessDescriptorTable::BindlessDescriptorTable(ID3D12Device* device, DescriptorRing* ring) :
+    m_device(device),
+    m_type(ring->GetType()),
+    m_table(ring->GetStaticTable()),
+    m_slots(m_table.count),
+    m_sources(m_table.count)
+{
+}
+
+UINT BindlessDescriptorTable::Add(const DescriptorHandle& source)
+{
+    UINT slot = m_slots.Add();
+    if (slot == BindlessSlotTable::InvalidIndex)
+        ThrowIfFailed(E_OUTOFMEMORY);
+
+    m_sources[slot] = source.cpuHandle;
+    m_device->CopyDescriptorsSimple(1, CD3DX12_CPU_DESCRIPTOR_HANDLE(m_table.cpuHandle, slot, m_table.descriptorSize), source.cpuHandle, m_type);
+    return slot;
+}
+
+void BindlessDescriptorTable::Remove(UINT slot)
+{
+    m_slots.Remove(slot);
+}
+
+void BindlessDescriptorTable::Update(UINT slot)
+{
+    m_device->CopyDescriptorsSimple(1, CD3DX12_CPU_DESCRIPTOR_HANDLE(m_table.cpuHandle, slot, m_table.descriptorSize), m_sources[slot], m_type);
+}
+
+std::vector<BindlessSlotTable::Move> BindlessDescriptorTable::Compact()
+{
+    std::vector<BindlessSlotTable::Move> moves = m_slots.Compact();
+    for (auto& move : moves)
+    {
+        m_sources[move.to] = m_sources[move.from];
+        m_device->CopyDescriptorsSimple(1, CD3DX12_CPU_DESCRIPTOR_HANDLE(m_table.cpuHandle, move.to, m_table.descriptorSize), m_sources[move.to], m_type);
+    }
+    return moves;
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include "d3d12Util.h"
+#include "IndexAllocator.h"
+#include <memory>
+#include <vector>
+
+// 在非shader visible的heap中分配的一段连续descriptor，Free时原样传回
+struct DescriptorHandle
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE cpuHandle = {};
+    UINT count = 0;
+    UINT pageIndex = FreeListIndexAllocator::InvalidIndex;
+    UINT index = 0;                     // 在page中的下标
+
+    bool IsValid()const { return pageIndex != FreeListIndexAllocator::InvalidIndex; }
+};
+
+// 在shader visible的heap中分配的一段连续descriptor，可以直接作为descriptor table绑定
+struct DescriptorTable
+{
+    CD3DX12_CPU_DESCRIPTOR_HANDLE cpuHandle;
+    CD3DX12_GPU_DESCRIPTOR_HANDLE gpuHandle;
+    UINT count = 0;
+    UINT descriptorSize = 0;
+
+    // table中第i个descriptor，可以作为只包含一个descriptor的table单独绑定
+    CD3DX12_GPU_DESCRIPTOR_HANDLE GpuHandle(UINT i)const { return CD3DX12_GPU_DESCRIPTOR_HANDLE(gpuHandle, i, descriptorSize); }
+};
+
+// 创建CBV/SRV/UAV等descriptor用的CPU heap（不是shader visible），由空闲链表管理，可以随时分配和释放。
+// 一个page用完后再创建新的page，不需要重建heap。绘制前通过DescriptorRing把需要的descriptor拷贝到shader visible heap中。
+class DescriptorAllocator
+{
+public:
+    DescriptorAllocator(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT descriptorsPerPage = 256);
+    DescriptorAllocator(const DescriptorAllocator& rhs) = delete;
+    DescriptorAllocator& operator=(const DescriptorAllocator& rhs) = delete;
+
+    DescriptorHandle Allocate(UINT count = 1);
+    // descriptor拷贝到shader visible heap后即可释放，不需要等GPU
+    void Free(DescriptorHandle& handle);
+
+    UINT GetDescriptorSize()const { return m_descriptorSize; }
+    UINT GetPageCount()const { return (UINT)m_pages.size(); }
+
+private:
+    struct Page
+    {
+        explicit Page(UINT capacity) : allocator(capacity) {}
+
+        ComPtr<ID3D12DescriptorHeap> heap;
+        D3D12_CPU_DESCRIPTOR_HANDLE start = {};
+        FreeListIndexAllocator allocator;
+    };
+
+    ID3D12Device* m_device;
+    D3D12_DESCRIPTOR_HEAP_TYPE m_type;
+    UINT m_descriptorsPerPage;
+    UINT m_descriptorSize;
+    std::vector<std::unique_ptr<Page>> m_pages;
+};
+
+// shader visible的descriptor heap，按环形缓冲区使用。
+// 每帧把绘制需要的descriptor table拷贝进来，在该帧的fence完成后回收。
+// heap开头可以保留staticCapacity个不参与循环的descriptor，用于bindless table等常驻的数据。
+class DescriptorRing
+{
+public:
+    DescriptorRing(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, UINT capacity, UINT staticCapacity = 0);
+    DescriptorRing(const DescriptorRing& rhs) = delete;
+    DescriptorRing& operator=(const DescriptorRing& rhs) = delete;
+
+    ID3D12DescriptorHeap* GetHeap()const { return m_heap.Get(); }
+    D3D12_DESCRIPTOR_HEAP_TYPE GetType()const { return m_type; }
+    // 保留的常驻部分
+    DescriptorTable GetStaticTable()const;
+
+    // 分配count个连续的descriptor，空间不足时抛出异常
+    DescriptorTable Allocate(UINT count);
+    // 把一组descriptor依次拷贝到新分配的一段table中，只调用一次CopyDescriptors
+    DescriptorTable Copy(const DescriptorHandle* sources, UINT sourceCount);
+
+    // 本帧的command list提交后调用，传入之后Signal的fence值
+    void RetireSubmitted(UINT64 fenceValue);
+    void ReleaseCompleted(UINT64 completedFenceValue);
+
+    UINT GetUsedCount()const { return m_allocator.UsedCount(); }
+
+private:
+    ID3D12Device* m_device;
+    D3D12_DESCRIPTOR_HEAP_TYPE m_type;
+    UINT m_descriptorSize;
+    UINT m_staticCapacity;
+    ComPtr<ID3D12DescriptorHeap> m_heap;
+    RingIndexAllocator m_allocator;
+
+    // Copy时使用，避免每次都重新分配
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_sourceStarts;
+    std::vector<UINT> m_sourceSizes;
+};
+
+// bindless的descriptor数组，位于DescriptorRing保留的常驻部分中，shader用槽位下标访问。
+// 添加时把CPU heap中的descriptor拷贝到空闲槽位，源descriptor要保留到Remove之后，Compact时需要从它重新拷贝。
+// Remove和Compact会改写GPU可能还在使用的槽位，要在引用它们的command list完成后调用。
+class BindlessDescriptorTable
+{
+public:
+    BindlessDescriptorTable(ID3D12Device* device, DescriptorRing* ring);
+    BindlessDescriptorTable(const BindlessDescriptorTable& rhs) = delete;
+    BindlessDescriptorTable& operator=(const BindlessDescriptorTable& rhs) = delete;
+
+    // 返回槽位下标，已满时抛出异常
+    UINT Add(const DescriptorHandle& source);
+    void Remove(UINT slot);
+    // 源descriptor被改写后（例如texture加载完成后从占位texture换成真正的texture）重新拷贝到槽位中，
+    // 调用者需要保证GPU没有在读取这个槽位
+    void Update(UINT slot);
+    // 消除空位，返回所有移动过的槽位，调用者据此更新材质等数据中保存的下标
+    std::vector<BindlessSlotTable::Move> Compact();
+
+    // 作为unbounded descriptor table绑定的起始位置
+    CD3DX12_GPU_DESCRIPTOR_HANDLE GetGpuHandle()const { return m_table.gpuHandle; }
+    UINT Count()const { return m_slots.Count(); }
+    UINT LiveCount()const { return m_slots.LiveCount(); }
+
+private:
+    ID3D12Device* m_device;
+    D3D12_DESCRIPTOR_HEAP_TYPE m_type;
+    DescriptorTable m_table;
+    BindlessSlotTable m_slots;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> m_sources;     // 每个槽位对应的源descriptor
+};
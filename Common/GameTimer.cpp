@@ -83,7 +83,7 @@ void GameTimer::Start()
 
 	if(m_isStopped)
 	{
-		m_pausedTime += (startTime - m_stopTime);	//ۼͣʱ
+		m_pausedTime += (startTime - m_stopTime);	//累计暂停的时间
 
 		m_previousTime = startTime;
 		m_stopTime = 0;
@@ -98,12 +98,12 @@ void GameTimer::Stop()
 		__int64 currTime;
 		QueryPerformanceCounter((LARGE_INTEGER*)&currTime);
 
-		m_stopTime = currTime;//¼ͣʼʱ
+		m_stopTime = currTime;//记录暂停开始的时间
 		m_isStopped = true;
 	}
 }
 
-//ÿ֡ãһ֡ǰ֡ѵʱ
+//每帧调用，计算上一帧到当前帧所花费的时间
 void GameTimer::Tick()
 {
 	if (m_isStopped)
@@ -10,23 +10,23 @@ public:
 	float DeltaTime()const;			// return m_deltaTime
 	float SecondsPerCount()const;	// return m_secondsPerCount
 
-	void Reset();	// ʼ
+	void Reset();	// 初始化、重置
 	void Start();	// Call when unpaused.
 	void Stop();	// Call when paused.
 	void Tick();	// Call every frame.
 
 private:
-	double m_secondsPerCount;	// /count
-	double m_deltaTime;			// һ֡ǰ֡ѵʱ䣬λsecond
+	double m_secondsPerCount;	// 秒/count
+	double m_deltaTime;			// 上一帧到当前帧花费的时间，单位second
 
-	// бĵλΪcount
-	__int64 m_baseTime;			// ʱʼʱʱ
-	__int64 m_pausedTime;		// ۼͣʱ
-	__int64 m_stopTime;			// ʱͣʼʱ
-	__int64 m_previousTime;		// һ֡Ŀʼʱ
-	__int64 m_currentTime;		// ǰ֡Ŀʼʱ
+	// 下列变量的单位为：count
+	__int64 m_baseTime;			// 计时器初始化时的时间
+	__int64 m_pausedTime;		// 累计暂停的时间
+	__int64 m_stopTime;			// 计时器暂停开始时间
+	__int64 m_previousTime;		// 上一帧的开始时间
+	__int64 m_currentTime;		// 当前帧的开始时间
 
-	bool m_isStopped;			// Ƿͣ
+	bool m_isStopped;			// 是否暂停
 };
 
 #endif
\ No newline at end of file
@@ -61,7 +61,7 @@ GeometryManager::MeshData GeometryManager::CreateCube(float length)
     uint16 indices[36];
     float halfLength = 0.5f * length;
 
-    // 
+    // 正面
     vertices[0] = Vertex(-halfLength, -halfLength, -halfLength, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f);
     vertices[1] = Vertex(-halfLength, +halfLength, -halfLength, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f);
     vertices[2] = Vertex(+halfLength, +halfLength, -halfLength, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f);
@@ -69,7 +69,7 @@ GeometryManager::MeshData GeometryManager::CreateCube(float length)
     indices[0] = 0; indices[1] = 1; indices[2] = 2;
     indices[3] = 0; indices[4] = 2; indices[5] = 3;
 
-    // 
+    // 背面
     vertices[4] = Vertex(-halfLength, -halfLength, +halfLength, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
     vertices[5] = Vertex(+halfLength, -halfLength, +halfLength, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
     vertices[6] = Vertex(+halfLength, +halfLength, +halfLength, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
@@ -77,7 +77,7 @@ GeometryManager::MeshData GeometryManager::CreateCube(float length)
     indices[6] = 4; indices[7] = 5; indices[8] = 6;
     indices[9] = 4; indices[10] = 6; indices[11] = 7;
 
-    // 
+    // 上面
     vertices[8] = Vertex(-halfLength, +halfLength, -halfLength, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f);
     vertices[9] = Vertex(-halfLength, +halfLength, +halfLength, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f);
     vertices[10] = Vertex(+halfLength, +halfLength, +halfLength, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f);
@@ -85,7 +85,7 @@ GeometryManager::MeshData GeometryManager::CreateCube(float length)
     indices[12] = 8; indices[13] = 9; indices[14] = 10;
     indices[15] = 8; indices[16] = 10; indices[17] = 11;
 
-    // 
+    // 下面
     vertices[12] = Vertex(-halfLength, -halfLength, -halfLength, 0.0f, -1.0f, 0.0f, 1.0f, 1.0f);
     vertices[13] = Vertex(+halfLength, -halfLength, -halfLength, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f);
     vertices[14] = Vertex(+halfLength, -halfLength, +halfLength, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f);
@@ -93,7 +93,7 @@ GeometryManager::MeshData GeometryManager::CreateCube(float length)
     indices[18] = 12; indices[19] = 13; indices[20] = 14;
     indices[21] = 12; indices[22] = 14; indices[23] = 15;
 
-    // 
+    // 左面
     vertices[16] = Vertex(-halfLength, -halfLength, +halfLength, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
     vertices[17] = Vertex(-halfLength, +halfLength, +halfLength, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
     vertices[18] = Vertex(-halfLength, +halfLength, -halfLength, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
@@ -101,7 +101,7 @@ GeometryManager::MeshData GeometryManager::CreateCube(float length)
     indices[24] = 16; indices[25] = 17; indices[26] = 18;
     indices[27] = 16; indices[28] = 18; indices[29] = 19;
 
-    // 
+    // 右面
     vertices[20] = Vertex(+halfLength, -halfLength, -halfLength, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
     vertices[21] = Vertex(+halfLength, +halfLength, -halfLength, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
     vertices[22] = Vertex(+halfLength, +halfLength, +halfLength, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
@@ -122,12 +122,12 @@ GeometryManager::MeshData GeometryManager::CreatePyramid(float width, float heig
     uint16 indices[18];
     float halfWidth = 0.5f * width;
 
-    // 
-    XMFLOAT3 top(0.0f, height, 0.0f);                   //
-    XMFLOAT3 leftFront(-halfWidth, 0.0f, -halfWidth);   //ǰ
-    XMFLOAT3 leftBack(-halfWidth, 0.0f, +halfWidth);    //
-    XMFLOAT3 rightFront(+halfWidth, 0.0f, -halfWidth);  //ǰ
-    XMFLOAT3 rightBack(+halfWidth, 0.0f, +halfWidth);   //Һ
+    // 五个顶点的坐标
+    XMFLOAT3 top(0.0f, height, 0.0f);                   //顶点
+    XMFLOAT3 leftFront(-halfWidth, 0.0f, -halfWidth);   //左前
+    XMFLOAT3 leftBack(-halfWidth, 0.0f, +halfWidth);    //左后
+    XMFLOAT3 rightFront(+halfWidth, 0.0f, -halfWidth);  //右前
+    XMFLOAT3 rightBack(+halfWidth, 0.0f, +halfWidth);   //右后
 
     XMFLOAT2 topUV(0.5f, 0.0f);
     XMFLOAT2 leftUV(0.0f, 1.0f);
@@ -136,7 +136,7 @@ GeometryManager::MeshData GeometryManager::CreatePyramid(float width, float heig
     XMFLOAT3 normalFloat3;
     XMVECTOR normalVector;
 
-    // 
+    // 正面三角形
     normalVector = MathUtil::ComputeNormal(XMLoadFloat3(&top), XMLoadFloat3(&rightFront), XMLoadFloat3(&leftFront));
     XMStoreFloat3(&normalFloat3, normalVector);
     vertices[0] = Vertex(top, normalFloat3, topUV);
@@ -144,7 +144,7 @@ GeometryManager::MeshData GeometryManager::CreatePyramid(float width, float heig
     vertices[2] = Vertex(leftFront, normalFloat3, leftUV);
     indices[0] = 0; indices[1] = 1; indices[2] = 2;
 
-    // 
+    // 背面三角形
     normalVector = MathUtil::ComputeNormal(XMLoadFloat3(&top), XMLoadFloat3(&leftBack), XMLoadFloat3(&rightBack));
     XMStoreFloat3(&normalFloat3, normalVector);
     vertices[3] = Vertex(top, normalFloat3, topUV);
@@ -152,7 +152,7 @@ GeometryManager::MeshData GeometryManager::CreatePyramid(float width, float heig
     vertices[5] = Vertex(rightBack, normalFloat3, leftUV);
     indices[3] = 3; indices[4] = 4; indices[5] = 5;
 
-    // 
+    // 左面三角形
     normalVector = MathUtil::ComputeNormal(XMLoadFloat3(&top), XMLoadFloat3(&leftFront), XMLoadFloat3(&leftBack));
     XMStoreFloat3(&normalFloat3, normalVector);
     vertices[6] = Vertex(top, normalFloat3, topUV);
@@ -160,7 +160,7 @@ GeometryManager::MeshData GeometryManager::CreatePyramid(float width, float heig
     vertices[8] = Vertex(leftBack, normalFloat3, leftUV);
     indices[6] = 6; indices[7] = 7; indices[8] = 8;
 
-    // 
+    // 右面三角形
     normalVector = MathUtil::ComputeNormal(XMLoadFloat3(&top), XMLoadFloat3(&rightBack), XMLoadFloat3(&rightFront));
     XMStoreFloat3(&normalFloat3, normalVector);
     vertices[9] = Vertex(top, normalFloat3, topUV);
@@ -168,7 +168,7 @@ GeometryManager::MeshData GeometryManager::CreatePyramid(float width, float heig
     vertices[11] = Vertex(rightFront, normalFloat3, leftUV);
     indices[9] = 9; indices[10] = 10; indices[11] = 11;
 
-    // 
+    // 下面两个三角形
     normalFloat3 = XMFLOAT3(0.0f, -1.0f, 0.0f);
     vertices[12] = Vertex(leftFront, normalFloat3, { 1.0f, 1.0f });
     vertices[13] = Vertex(rightFront, normalFloat3, { 0.0f, 1.0f });
@@ -187,15 +187,15 @@ GeometryManager::MeshData GeometryManager::CreateSphere(float radius, uint16 sta
 {
     MeshData meshData;
 
-    Vertex topVertex(0.0f, radius, 0.0f, 0.0f, +1.0f, 0.0f, 0.0f, 0.0f);       // 
-    Vertex bottomVertex(0.0f, -radius, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f);   // ϼ
+    Vertex topVertex(0.0f, radius, 0.0f, 0.0f, +1.0f, 0.0f, 0.0f, 0.0f);       // 北极点
+    Vertex bottomVertex(0.0f, -radius, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f);   // 南极点
 
     meshData.vertices.push_back(topVertex);
 
     float radianOfPerStack = XM_PI / stackCount;
     float radianOfPerSlice = XM_2PI / sliceCount;
 
-    // һȦȦ£
+    // 一圈圈自上向下，创建顶点
     for (uint16 i = 1; i <= stackCount - 1; ++i)
     {
         float stackRadian = radianOfPerStack * i;
@@ -220,7 +220,7 @@ GeometryManager::MeshData GeometryManager::CreateSphere(float radius, uint16 sta
 
     meshData.vertices.push_back(bottomVertex);
 
-    // һstackÿιtopVertex
+    // 最上面一层stack，每个三角形共用topVertex
     for (uint16 i = 1; i <= sliceCount; ++i)
     {
         meshData.indices.push_back(0);
@@ -229,7 +229,7 @@ GeometryManager::MeshData GeometryManager::CreateSphere(float radius, uint16 sta
     }
 
     uint16 baseIndex = 1;
-    uint16 vertexCountPerRing = sliceCount + 1;   // ÿγϵĶ
+    uint16 vertexCountPerRing = sliceCount + 1;   // 每根纬线上的顶点数量
     for (uint16 i = 0; i < stackCount - 2; ++i)
     {
         for (uint16 j = 0; j < sliceCount; ++j)
@@ -244,7 +244,7 @@ GeometryManager::MeshData GeometryManager::CreateSphere(float radius, uint16 sta
         }
     }
 
-    // һstackÿιbottomVertex
+    // 最下面一层stack，每个三角形共用bottomVertex
     uint16 bottomVertexIndex = (uint16)meshData.vertices.size() - 1;
     baseIndex = bottomVertexIndex - vertexCountPerRing;
     for (uint16 i = 0; i < sliceCount; ++i)
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// 64位FNV-1a哈希，结果只取决于输入的字节，不同次运行、不同机器上都一致，可以作为写入文件的key。
+// 结构体要逐个成员Add，直接Add整个结构体会把padding中的随机值也算进去。
+class Hasher64
+{
+public:
+    using uint64 = std::uint64_t;
+
+    static const uint64 OffsetBasis = 14695981039346656037ull;
+    static const uint64 Prime = 1099511628211ull;
+
+    explicit Hasher64(uint64 seed = OffsetBasis) : m_hash(seed) {}
+
+    Hasher64& Add(const void* data, std::size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            m_hash ^= bytes[i];
+            m_hash *= Prime;
+        }
+        return *this;
+    }
+
+    // 整数、枚举、浮点数等，按值的字节计算
+    template<typename T>
+    Hasher64& AddValue(const T& value)
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "AddValue只能用于标量类型");
+        return Add(&value, sizeof(T));
+    }
+
+    // 字符串连同长度一起计算，避免"ab"+"c"与"a"+"bc"相同
+    Hasher64& AddString(const char* str)
+    {
+        std::size_t length = str ? std::strlen(str) : 0;
+        AddValue((uint64)length);
+        return Add(str, length);
+    }
+
+    Hasher64& AddString(const std::string& str)
+    {
+        AddValue((uint64)str.size());
+        return Add(str.data(), str.size());
+    }
+
+    uint64 Result()const { return m_hash; }
+
+    static uint64 Hash(const void* data, std::size_t size) { return Hasher64().Add(data, size).Result(); }
+
+private:
+    uint64 m_hash;
+};
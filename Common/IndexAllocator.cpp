@@ -0,0 +1,219 @@
+#include "IndexAllocator.h"
+#include <algorithm>
+#include <functional>
+
+FreeListIndexAllocator::FreeListIndexAllocator(uint32 capacity) :
+    m_capacity(capacity),
+    m_freeCount(capacity)
+{
+    if (capacity > 0)
+        m_freeRanges.push_back({ 0, capacity });
+}
+
+FreeListIndexAllocator::uint32 FreeListIndexAllocator::Allocate(uint32 count)
+{
+    if (count == 0)
+        return InvalidIndex;
+
+    // first fit，从区间头部切出需要的部分
+    for (auto it = m_freeRanges.begin(); it != m_freeRanges.end(); ++it)
+    {
+        if (it->count < count)
+            continue;
+
+        uint32 start = it->start;
+        it->start += count;
+        it->count -= count;
+        if (it->count == 0)
+            m_freeRanges.erase(it);
+        m_freeCount -= count;
+        return start;
+    }
+    return InvalidIndex;
+}
+
+void FreeListIndexAllocator::Free(uint32 start, uint32 count)
+{
+    if (count == 0 || start >= m_capacity || count > m_capacity - start)
+        return;
+
+    // 找到第一个在start之后的空闲区间，插入到它前面，再和前后相邻的区间合并
+    auto next = std::lower_bound(m_freeRanges.begin(), m_freeRanges.end(), start,
+        [](const Range& range, uint32 value) { return range.start < value; });
+
+    bool mergePrev = next != m_freeRanges.begin() && (next - 1)->start + (next - 1)->count == start;
+    bool mergeNext = next != m_freeRanges.end() && start + count == next->start;
+
+    if (mergePrev && mergeNext)
+    {
+        (next - 1)->count += count + next->count;
+        m_freeRanges.erase(next);
+    }
+    else if (mergePrev)
+        (next - 1)->count += count;
+    else if (mergeNext)
+    {
+        next->start = start;
+        next->count += count;
+    }
+    else
+        m_freeRanges.insert(next, { start, count });
+
+    m_freeCount += count;
+}
+
+FreeListIndexAllocator::uint32 FreeListIndexAllocator::LargestFreeRange()const
+{
+    uint32 largest = 0;
+    for (auto& range : m_freeRanges)
+        largest = std::max(largest, range.count);
+    return largest;
+}
+
+bool FreeListIndexAllocator::Validate()const
+{
+    uint32 freeCount = 0;
+    for (size_t i = 0; i < m_freeRanges.size(); ++i)
+    {
+        const Range& range = m_freeRanges[i];
+        if (range.count == 0 || range.start + range.count > m_capacity)
+            return false;
+        // 相邻的区间应该已经合并
+        if (i > 0 && m_freeRanges[i - 1].start + m_freeRanges[i - 1].count >= range.start)
+            return false;
+        freeCount += range.count;
+    }
+    return freeCount == m_freeCount;
+}
+
+RingIndexAllocator::RingIndexAllocator(uint32 capacity) :
+    m_capacity(capacity)
+{
+}
+
+RingIndexAllocator::uint32 RingIndexAllocator::Allocate(uint32 count)
+{
+    if (count == 0 || count > m_capacity)
+        return InvalidIndex;
+
+    // 尾部放不下时跳过剩余部分，跳过的空间和这次分配一起回收
+    uint32 start = m_head;
+    uint32 padding = 0;
+    if (count > m_capacity - start)
+    {
+        padding = m_capacity - start;
+        start = 0;
+    }
+
+    // 已使用的部分总是从m_head往前连续的一段，剩余的部分从m_head开始连续
+    if (padding + count > m_capacity - m_usedCount)
+        return InvalidIndex;
+
+    m_head = start + count == m_capacity ? 0 : start + count;
+    m_usedCount += padding + count;
+    m_pendingCount += padding + count;
+    return start;
+}
+
+void RingIndexAllocator::RetireSubmitted(uint64 fenceValue)
+{
+    if (m_pendingCount == 0)
+        return;
+
+    Frame frame;
+    frame.fenceValue = fenceValue;
+    frame.count = m_pendingCount;
+    m_frames.push_back(frame);
+    m_pendingCount = 0;
+}
+
+void RingIndexAllocator::ReleaseCompleted(uint64 completedFenceValue)
+{
+    while (!m_frames.empty() && m_frames.front().fenceValue <= completedFenceValue)
+    {
+        m_usedCount -= m_frames.front().count;
+        m_frames.pop_front();
+    }
+
+    // 全部回收后从头开始，减少尾部跳过的空间
+    if (m_usedCount == 0)
+        m_head = 0;
+}
+
+BindlessSlotTable::BindlessSlotTable(uint32 capacity) :
+    m_live(capacity, false)
+{
+}
+
+BindlessSlotTable::uint32 BindlessSlotTable::Add()
+{
+    // 去掉末尾收缩后过期的空位
+    while (!m_freeSlots.empty() && (m_freeSlots.front() >= m_count || m_live[m_freeSlots.front()]))
+    {
+        std::pop_heap(m_freeSlots.begin(), m_freeSlots.end(), std::greater<uint32>());
+        m_freeSlots.pop_back();
+    }
+
+    uint32 slot;
+    if (!m_freeSlots.empty())
+    {
+        std::pop_heap(m_freeSlots.begin(), m_freeSlots.end(), std::greater<uint32>());
+        slot = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else if (m_count < Capacity())
+        slot = m_count++;
+    else
+        return InvalidIndex;
+
+    m_live[slot] = true;
+    ++m_liveCount;
+    return slot;
+}
+
+void BindlessSlotTable::Remove(uint32 slot)
+{
+    if (!IsLive(slot))
+        return;
+
+    m_live[slot] = false;
+    --m_liveCount;
+
+    if (slot + 1 == m_count)
+    {
+        // 删除的是最后一个，连同前面的空位一起收缩
+        while (m_count > 0 && !m_live[m_count - 1])
+            --m_count;
+    }
+    else
+    {
+        m_freeSlots.push_back(slot);
+        std::push_heap(m_freeSlots.begin(), m_freeSlots.end(), std::greater<uint32>());
+    }
+}
+
+std::vector<BindlessSlotTable::Move> BindlessSlotTable::Compact()
+{
+    std::vector<Move> moves;
+    uint32 hole = 0;
+    while (true)
+    {
+        while (m_count > 0 && !m_live[m_count - 1])
+            --m_count;
+        while (hole < m_count && m_live[hole])
+            ++hole;
+        if (hole >= m_count)
+            break;
+
+        // 把最后一个元素移动到最前面的空位
+        Move move;
+        move.from = m_count - 1;
+        move.to = hole;
+        m_live[move.to] = true;
+        m_live[move.from] = false;
+        moves.push_back(move);
+    }
+
+    m_freeSlots.clear();
+    return moves;
+}
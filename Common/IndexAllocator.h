@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// 只管理[0, capacity)范围内下标的分配器，不依赖任何图形API。
+// DescriptorAllocator和DescriptorRing用它们在descriptor heap中分配位置，也可以用假的heap在CPU上测试。
+
+// 用空闲区间链表管理的分配器，可以任意顺序释放，相邻的空闲区间会合并
+class FreeListIndexAllocator
+{
+public:
+    using uint32 = std::uint32_t;
+
+    static const uint32 InvalidIndex = 0xffffffff;
+
+    explicit FreeListIndexAllocator(uint32 capacity);
+
+    // 分配count个连续的下标，返回第一个下标，空间不足时返回InvalidIndex
+    uint32 Allocate(uint32 count);
+    void Free(uint32 start, uint32 count);
+
+    uint32 Capacity()const { return m_capacity; }
+    uint32 FreeCount()const { return m_freeCount; }
+    uint32 LargestFreeRange()const;
+    uint32 FreeRangeCount()const { return (uint32)m_freeRanges.size(); }
+
+    // 检查空闲区间是否有序、不重叠且已经合并，用于测试
+    bool Validate()const;
+
+private:
+    struct Range
+    {
+        uint32 start = 0;
+        uint32 count = 0;
+    };
+
+    uint32 m_capacity;
+    uint32 m_freeCount;
+    std::vector<Range> m_freeRanges;    // 按start从小到大排列
+};
+
+// 环形分配器，按分配顺序整体回收，用于每帧都会重新写入的shader visible descriptor
+// 一帧中分配的下标在RetireSubmitted时记上fence值，fence完成后由ReleaseCompleted一起回收
+class RingIndexAllocator
+{
+public:
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    static const uint32 InvalidIndex = 0xffffffff;
+
+    explicit RingIndexAllocator(uint32 capacity);
+
+    // 分配count个连续的下标，尾部剩余空间不够时从0开始，空间不足时返回InvalidIndex
+    uint32 Allocate(uint32 count);
+
+    // 上一次RetireSubmitted之后分配的下标在fenceValue完成后才能复用
+    void RetireSubmitted(uint64 fenceValue);
+    void ReleaseCompleted(uint64 completedFenceValue);
+
+    uint32 Capacity()const { return m_capacity; }
+    uint32 UsedCount()const { return m_usedCount; }
+
+private:
+    struct Frame
+    {
+        uint64 fenceValue = 0;
+        uint32 count = 0;               // 包含跳过的尾部空间
+    };
+
+    uint32 m_capacity;
+    uint32 m_head = 0;                  // 下一次分配的位置
+    uint32 m_usedCount = 0;             // 包含还未Retire的部分
+    uint32 m_pendingCount = 0;          // 还未Retire的部分
+    std::deque<Frame> m_frames;
+};
+
+// bindless数组中的槽位，shader通过槽位下标访问。
+// 删除后留下的空位优先被新添加的元素复用，Compact把末尾的元素移动到前面的空位中，使[0, Count())中没有空位
+class BindlessSlotTable
+{
+public:
+    using uint32 = std::uint32_t;
+
+    static const uint32 InvalidIndex = 0xffffffff;
+
+    // Compact时一个元素从from移动到to，调用者据此移动数据并更新对它的引用
+    struct Move
+    {
+        uint32 from = 0;
+        uint32 to = 0;
+    };
+
+    explicit BindlessSlotTable(uint32 capacity);
+
+    // 返回下标最小的空闲槽位，已满时返回InvalidIndex
+    uint32 Add();
+    void Remove(uint32 slot);
+    std::vector<Move> Compact();
+
+    uint32 Capacity()const { return (uint32)m_live.size(); }
+    // 最后一个使用中的槽位+1，即shader中需要访问的数组长度
+    uint32 Count()const { return m_count; }
+    uint32 LiveCount()const { return m_liveCount; }
+    bool IsLive(uint32 slot)const { return slot < m_count && m_live[slot]; }
+
+private:
+    std::vector<bool> m_live;
+    std::vector<uint32> m_freeSlots;    // [0, m_count)中的空位，小顶堆，可能包含已经不小于m_count的过期下标
+    uint32 m_count = 0;
+    uint32 m_liveCount = 0;
+};
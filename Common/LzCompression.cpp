@@ -0,0 +1,211 @@
+#include "LzCompression.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    using uint8 = std::uint8_t;
+    using uint32 = std::uint32_t;
+
+    const std::size_t MinMatch = 4;
+    const std::size_t MaxDistance = 65535;
+    const std::size_t LastLiterals = 5;         // 最后5个字节总是literal
+    const std::size_t MatchSearchLimit = 12;    // 距离结尾不足12字节时不再开始新的match
+    const int HashLog = 14;
+
+    inline uint32 Read32(const uint8* p)
+    {
+        uint32 value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint32 HashOf(uint32 value)
+    {
+        return (value * 2654435761u) >> (32 - HashLog);
+    }
+
+    // 长度超过15的部分按255一个字节写出
+    inline uint8* WriteLength(uint8* op, std::size_t length)
+    {
+        for (; length >= 255; length -= 255)
+            *op++ = 255;
+        *op++ = (uint8)length;
+        return op;
+    }
+
+    inline bool ReadLength(const uint8*& ip, const uint8* iend, std::size_t& length)
+    {
+        uint8 value;
+        do
+        {
+            if (ip >= iend)
+                return false;
+            value = *ip++;
+            length += value;
+        } while (value == 255);
+        return true;
+    }
+
+    // literal的长度和match的长度、距离写成一个sequence，dest放不下时返回nullptr
+    uint8* WriteSequence(uint8* op, uint8* oend, const uint8* literals, std::size_t literalLength, std::size_t distance, std::size_t matchLength)
+    {
+        const std::size_t worstSize = 1 + literalLength / 255 + 1 + literalLength + 2 + matchLength / 255 + 1;
+        if ((std::size_t)(oend - op) < worstSize)
+            return nullptr;
+
+        uint8* token = op++;
+        *token = (uint8)((literalLength >= 15 ? 15 : literalLength) << 4);
+        if (literalLength >= 15)
+            op = WriteLength(op, literalLength - 15);
+        if (literalLength > 0)
+            memcpy(op, literals, literalLength);
+        op += literalLength;
+        if (matchLength == 0)
+            return op;
+
+        *op++ = (uint8)(distance & 0xff);
+        *op++ = (uint8)(distance >> 8);
+        const std::size_t code = matchLength - MinMatch;
+        *token |= (uint8)(code >= 15 ? 15 : code);
+        if (code >= 15)
+            op = WriteLength(op, code - 15);
+        return op;
+    }
+}
+
+std::size_t LzCompressBound(std::size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+std::size_t LzCompress(const void* source, std::size_t sourceSize, void* dest, std::size_t destCapacity)
+{
+    const uint8* src = static_cast<const uint8*>(source);
+    const uint8* iend = src + sourceSize;
+    const uint8* ip = src;
+    const uint8* anchor = src;
+    uint8* op = static_cast<uint8*>(dest);
+    uint8* oend = op + destCapacity;
+
+    if (sourceSize > MatchSearchLimit)
+    {
+        // 表中保存每个哈希值最近出现的位置，匹配前再比较实际的字节，所以初始值0不会产生错误的match
+        std::vector<uint32> table((std::size_t)1 << HashLog, 0);
+        const uint8* searchEnd = iend - MatchSearchLimit;
+        const uint8* matchEnd = iend - LastLiterals;
+        std::size_t misses = 0;
+        while (ip < searchEnd)
+        {
+            const uint32 value = Read32(ip);
+            const uint32 hash = HashOf(value);
+            const uint8* ref = src + table[hash];
+            table[hash] = (uint32)(ip - src);
+            if (ref >= ip || (std::size_t)(ip - ref) > MaxDistance || Read32(ref) != value)
+            {
+                // 连续找不到match时逐渐加大步长，不可压缩的数据也能很快跳过
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+
+            // 向前扩展到上一个match的结尾，向后扩展到最后5个字节之前
+            while (ip > anchor && ref > src && ip[-1] == ref[-1])
+            {
+                --ip;
+                --ref;
+            }
+            std::size_t length = MinMatch;
+            while (ip + length < matchEnd && ip[length] == ref[length])
+                ++length;
+
+            op = WriteSequence(op, oend, anchor, (std::size_t)(ip - anchor), (std::size_t)(ip - ref), length);
+            if (op == nullptr)
+                return 0;
+            ip += length;
+            anchor = ip;
+
+            // match中间的位置也记录一个，下一个match更容易命中
+            if (ip < searchEnd)
+                table[HashOf(Read32(ip - 2))] = (uint32)(ip - 2 - src);
+        }
+    }
+
+    op = WriteSequence(op, oend, anchor, (std::size_t)(iend - anchor), 0, 0);
+    return op == nullptr ? 0 : (std::size_t)(op - static_cast<uint8*>(dest));
+}
+
+bool LzDecompress(const void* source, std::size_t sourceSize, void* dest, std::size_t destSize)
+{
+    const uint8* ip = static_cast<const uint8*>(source);
+    const uint8* iend = ip + sourceSize;
+    uint8* const ostart = static_cast<uint8*>(dest);
+    uint8* op = ostart;
+    uint8* const oend = op + destSize;
+
+    for (;;)
+    {
+        if (ip >= iend)
+            return false;
+        const uint8 token = *ip++;
+
+        std::size_t literalLength = token >> 4;
+        if (literalLength == 15 && !ReadLength(ip, iend, literalLength))
+            return false;
+        if (literalLength > (std::size_t)(iend - ip) || literalLength > (std::size_t)(oend - op))
+            return false;
+
+        // 两边都有余量时每次拷贝16字节，多写的部分会被之后的数据覆盖
+        if ((std::size_t)(iend - ip) >= literalLength + 16 && (std::size_t)(oend - op) >= literalLength + 16)
+        {
+            for (std::size_t i = 0; i < literalLength; i += 16)
+                memcpy(op + i, ip + i, 16);
+        }
+        else
+            memcpy(op, ip, literalLength);
+        op += literalLength;
+        ip += literalLength;
+
+        // 最后一个sequence没有match
+        if (ip == iend)
+            return op == oend;
+
+        if (iend - ip < 2)
+            return false;
+        const std::size_t distance = (std::size_t)ip[0] | ((std::size_t)ip[1] << 8);
+        ip += 2;
+        if (distance == 0 || distance > (std::size_t)(op - ostart))
+            return false;
+
+        std::size_t matchLength = token & 15;
+        if (matchLength == 15 && !ReadLength(ip, iend, matchLength))
+            return false;
+        matchLength += MinMatch;
+        if (matchLength > (std::size_t)(oend - op))
+            return false;
+
+        // 每次拷贝8字节时源数据必须已经写好：距离小于8的短模式先逐字节展开到不小于8的整数倍周期，之后再整块拷贝
+        const uint8* match = op - distance;
+        if ((std::size_t)(oend - op) >= matchLength + 16)
+        {
+            std::size_t period = distance;
+            std::size_t i = 0;
+            if (distance < 8)
+            {
+                while (period < 8)
+                    period += distance;
+                for (; i < period && i < matchLength; ++i)
+                    op[i] = match[i];
+            }
+            for (; i < matchLength; i += 8)
+                memcpy(op + i, op + i - period, 8);
+        }
+        else
+        {
+            for (std::size_t i = 0; i < matchLength; ++i)
+                op[i] = match[i];
+        }
+        op += matchLength;
+    }
+}
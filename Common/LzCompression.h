@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+
+// 字节流的LZ压缩，不依赖图形API，用于AssetArchive中的chunk。
+// 数据格式与LZ4的block格式相同：每个sequence由token（高4位为literal长度，低4位为match长度减4）、literal、
+// 2字节的match距离组成，长度为15时后面跟若干字节继续累加，最后一个sequence只有literal。
+// 压缩使用单个哈希表的贪心匹配，速度优先；解压不分配内存，在输出还有余量时按8/16字节整块拷贝，对损坏的数据只返回false不会越界
+
+// 最坏情况（完全不可压缩）下压缩结果的大小
+std::size_t LzCompressBound(std::size_t size);
+
+// 返回压缩后的字节数，dest放不下时返回0
+std::size_t LzCompress(const void* source, std::size_t sourceSize, void* dest, std::size_t destCapacity);
+
+// destSize必须是原始数据的准确大小，数据损坏或者解压后的大小不一致时返回false
+bool LzDecompress(const void* source, std::size_t sourceSize, void* dest, std::size_t destSize);
@@ -0,0 +1,129 @@
+#include "MappedFile.h"
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        std::swap(m_open, other.m_open);
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+namespace
+{
+    // 映射整个文件，file在返回前关闭
+    bool MapFile(HANDLE file, void*& data, std::size_t& size)
+    {
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+
+        bool succeeded = false;
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(file, &fileSize) && (unsigned long long)fileSize.QuadPart <= (std::size_t)-1)
+        {
+            size = (std::size_t)fileSize.QuadPart;
+            data = nullptr;
+            // 空文件不能创建file mapping
+            if (size == 0)
+                succeeded = true;
+            else if (HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr))
+            {
+                // view会保持mapping有效，mapping的句柄可以直接关闭
+                data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                succeeded = data != nullptr;
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+        return succeeded;
+    }
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    m_open = MapFile(file, m_data, m_size);
+    if (!m_open)
+        Close();
+    return m_open;
+}
+
+bool MappedFile::Open(const std::wstring& path)
+{
+    Close();
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    m_open = MapFile(file, m_data, m_size);
+    if (!m_open)
+        Close();
+    return m_open;
+}
+
+void MappedFile::Close()
+{
+    if (m_open && m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    m_open = false;
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+        return false;
+
+    struct stat status;
+    if (fstat(descriptor, &status) == 0)
+    {
+        m_size = (std::size_t)status.st_size;
+        if (m_size == 0)
+            m_open = true;
+        else
+        {
+            void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            m_open = data != MAP_FAILED;
+            m_data = m_open ? data : nullptr;
+        }
+    }
+    // 映射建立后关闭文件不影响映射
+    close(descriptor);
+    if (!m_open)
+        Close();
+    return m_open;
+}
+
+void MappedFile::Close()
+{
+    if (m_open && m_data != nullptr)
+        munmap(m_data, m_size);
+    m_open = false;
+    m_data = nullptr;
+    m_size = 0;
+}
+
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// 把整个文件只读地映射到内存中，直接使用文件的内容而不复制。
+// Windows上使用CreateFileMapping，其他平台使用mmap，映射建立后不再需要文件句柄
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile() { Close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // 打开失败时返回false，之前映射的文件会先关闭
+    bool Open(const std::string& path);
+#ifdef _WIN32
+    bool Open(const std::wstring& path);
+#endif
+    void Close();
+
+    bool IsOpen()const { return m_open; }
+    // 空文件的data为nullptr
+    const void* GetData()const { return m_data; }
+    std::size_t GetSize()const { return m_size; }
+
+private:
+    bool m_open = false;
+    void* m_data = nullptr;
+    std::size_t m_size = 0;
+};
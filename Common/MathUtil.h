@@ -7,7 +7,7 @@ using namespace DirectX;
 class MathUtil
 {
 public:
-    // λ
+    // 单位矩阵
     static XMFLOAT4X4 Identity4x4()
     {
         static XMFLOAT4X4 I(
@@ -19,7 +19,7 @@ public:
         return I;
     }
 
-    // 㵥εķ
+    // 计算单个三角形的法线
     static XMVECTOR ComputeNormal(FXMVECTOR p0, FXMVECTOR p1, FXMVECTOR p2)
     {
         XMVECTOR u = p1 - p0;
@@ -27,20 +27,20 @@ public:
         return XMVector3Normalize(XMVector3Cross(u, v));
     }
 
-    // Mתþ
+    // 计算M矩阵的逆矩阵的转置矩阵
     static XMMATRIX InverseTranspose(CXMMATRIX M)
     {
         XMMATRIX A = M;
-        // ƽƲ
+        // 忽略平移操作
         A.r[3] = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
         XMVECTOR det = XMMatrixDeterminant(A);
         return XMMatrixTranspose(XMMatrixInverse(&det, A));
     }
 
-    // תRžS㷨߱任
+    // 根据旋转矩阵R和缩放矩阵S计算法线变换矩阵
     static XMMATRIX ComputeNormalMatrix(CXMMATRIX R, CXMMATRIX S)
     {
-        // ž
+        // 计算缩放矩阵的逆矩阵
         XMMATRIX InverseS = S;
         InverseS.r[0] = XMVectorSet(1.0f / XMVectorGetX(InverseS.r[0]), 0.0f, 0.0f, 0.0f);
         InverseS.r[1] = XMVectorSet(0.0f, 1.0f / XMVectorGetY(InverseS.r[1]), 0.0f, 0.0f);
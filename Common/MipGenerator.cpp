@@ -0,0 +1,421 @@
+#include "MipGenerator.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define MIP_X86 1
+#include <immintrin.h>
+#else
+#define MIP_X86 0
+#endif
+
+// MSVC可以直接使用AVX2的intrinsic，GCC、Clang需要给函数标记target
+#if defined(__GNUC__) || defined(__clang__)
+#define MIP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define MIP_TARGET_AVX2
+#endif
+
+namespace
+{
+    using uint8 = std::uint8_t;
+    using uint32 = std::uint32_t;
+    using int64 = std::int64_t;
+
+    const double Pi = 3.14159265358979323846;
+
+    // 线性空间的RGBA，每个通道一个float
+    struct FloatImage
+    {
+        uint32 width = 0;
+        uint32 height = 0;
+        std::vector<float> pixels;
+
+        float* Row(uint32 y) { return pixels.data() + (std::size_t)y * width * 4; }
+        const float* Row(uint32 y)const { return pixels.data() + (std::size_t)y * width * 4; }
+    };
+
+    // 一个方向上每个目标像素的源像素下标（已经按clamp或wrap处理）和归一化的权重，
+    // 第i个目标像素的tap为[offsets[i], offsets[i + 1])
+    struct FilterTaps
+    {
+        std::vector<uint32> offsets;
+        std::vector<uint32> indices;
+        std::vector<float> weights;
+    };
+
+    template<typename Function>
+    void ParallelForRows(uint32 rowCount, uint32 threadCount, const Function& function)
+    {
+        if (threadCount == 0)
+            threadCount = (std::max)(std::thread::hardware_concurrency(), 1u);
+        threadCount = (std::min)(threadCount, rowCount);
+        if (threadCount <= 1)
+        {
+            for (uint32 row = 0; row < rowCount; ++row)
+                function(row);
+            return;
+        }
+
+        std::atomic<uint32> nextRow(0);
+        auto worker = [&]()
+        {
+            for (uint32 row = nextRow++; row < rowCount; row = nextRow++)
+                function(row);
+        };
+        std::vector<std::thread> threads;
+        for (uint32 i = 1; i < threadCount; ++i)
+            threads.emplace_back(worker);
+        worker();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // 滤波器
+
+    uint32 AddressTexel(int64 index, uint32 size, bool wrap)
+    {
+        if (wrap)
+        {
+            index %= (int64)size;
+            return (uint32)(index < 0 ? index + size : index);
+        }
+        return (uint32)(std::min)((std::max)(index, (int64)0), (int64)size - 1);
+    }
+
+    // 第一类修正贝塞尔函数I0的级数展开
+    double BesselI0(double x)
+    {
+        double sum = 1.0, term = 1.0;
+        const double quarterSquare = x * x * 0.25;
+        for (int k = 1; k < 64; ++k)
+        {
+            term *= quarterSquare / ((double)k * k);
+            sum += term;
+            if (term < sum * 1e-12)
+                break;
+        }
+        return sum;
+    }
+
+    double KaiserSinc(double x, double width, double alpha)
+    {
+        if (std::abs(x) >= width)
+            return 0.0;
+        const double sinc = x == 0.0 ? 1.0 : std::sin(Pi * x) / (Pi * x);
+        const double t = x / width;
+        return sinc * BesselI0(alpha * std::sqrt(1.0 - t * t)) / BesselI0(alpha);
+    }
+
+    void AddTap(FilterTaps& taps, uint32 first, uint32 index, double weight)
+    {
+        // clamp、wrap之后多个位置可能落在同一个像素上，合并为一个tap
+        for (std::size_t i = first; i < taps.indices.size(); ++i)
+        {
+            if (taps.indices[i] == index)
+            {
+                taps.weights[i] += (float)weight;
+                return;
+            }
+        }
+        taps.indices.push_back(index);
+        taps.weights.push_back((float)weight);
+    }
+
+    FilterTaps BuildTaps(uint32 sourceSize, uint32 targetSize, const MipGenerateOptions& options)
+    {
+        FilterTaps taps;
+        const double scale = (double)sourceSize / targetSize;
+        taps.offsets.reserve(targetSize + 1);
+        for (uint32 x = 0; x < targetSize; ++x)
+        {
+            const uint32 first = (uint32)taps.indices.size();
+            taps.offsets.push_back(first);
+            if (options.filter == MipFilter::Box)
+            {
+                // 目标像素覆盖源像素的区间[x * scale, (x + 1) * scale)，奇数边长时边上的像素只覆盖一部分
+                const double low = x * scale, high = (x + 1) * scale;
+                for (int64 i = (int64)std::floor(low); (double)i < high; ++i)
+                {
+                    const double weight = (std::min)(high, (double)(i + 1)) - (std::max)(low, (double)i);
+                    if (weight > 0.0)
+                        AddTap(taps, first, AddressTexel(i, sourceSize, options.wrap), weight);
+                }
+            }
+            else
+            {
+                // 按目标像素的间距拉伸，缩小时半径覆盖width * scale个源像素
+                const double stretch = (std::max)(scale, 1.0);
+                const double center = (x + 0.5) * scale;
+                const double radius = options.kaiserWidth * stretch;
+                for (int64 i = (int64)std::floor(center - radius); (double)i < center + radius; ++i)
+                {
+                    const double weight = KaiserSinc((i + 0.5 - center) / stretch, options.kaiserWidth, options.kaiserAlpha);
+                    if (weight != 0.0)
+                        AddTap(taps, first, AddressTexel(i, sourceSize, options.wrap), weight);
+                }
+            }
+
+            double sum = 0.0;
+            for (std::size_t i = first; i < taps.weights.size(); ++i)
+                sum += taps.weights[i];
+            for (std::size_t i = first; i < taps.weights.size(); ++i)
+                taps.weights[i] = (float)(taps.weights[i] / sum);
+        }
+        taps.offsets.push_back((uint32)taps.indices.size());
+        return taps;
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // 横向：每个目标像素为源行中若干像素的加权和，4个通道正好是一个SSE寄存器。
+    // 各实现的每个通道都按tap的顺序先乘再加，结果完全一致
+
+    void FilterRowScalar(const float* source, float* target, uint32 targetWidth, const FilterTaps& taps)
+    {
+        for (uint32 x = 0; x < targetWidth; ++x)
+        {
+            float sum[4] = {};
+            for (uint32 t = taps.offsets[x]; t < taps.offsets[x + 1]; ++t)
+            {
+                const float* texel = source + (std::size_t)taps.indices[t] * 4;
+                const float weight = taps.weights[t];
+                for (uint32 c = 0; c < 4; ++c)
+                    sum[c] = sum[c] + texel[c] * weight;
+            }
+            std::memcpy(target + (std::size_t)x * 4, sum, sizeof(sum));
+        }
+    }
+
+#if MIP_X86
+    void FilterRowSse2(const float* source, float* target, uint32 targetWidth, const FilterTaps& taps)
+    {
+        for (uint32 x = 0; x < targetWidth; ++x)
+        {
+            __m128 sum = _mm_setzero_ps();
+            for (uint32 t = taps.offsets[x]; t < taps.offsets[x + 1]; ++t)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(source + (std::size_t)taps.indices[t] * 4), _mm_set1_ps(taps.weights[t])));
+            _mm_storeu_ps(target + (std::size_t)x * 4, sum);
+        }
+    }
+#endif
+
+    // 纵向：目标行为若干源行的加权和，整行连续，SSE2一次4个、AVX2一次8个float
+
+    void BlendRowsScalar(const float* const* rows, const float* weights, uint32 rowCount, float* target, std::size_t count, std::size_t first = 0)
+    {
+        for (std::size_t i = first; i < count; ++i)
+        {
+            float sum = 0.0f;
+            for (uint32 r = 0; r < rowCount; ++r)
+                sum = sum + rows[r][i] * weights[r];
+            target[i] = sum;
+        }
+    }
+
+#if MIP_X86
+    void BlendRowsSse2(const float* const* rows, const float* weights, uint32 rowCount, float* target, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 sum = _mm_setzero_ps();
+            for (uint32 r = 0; r < rowCount; ++r)
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[r] + i), _mm_set1_ps(weights[r])));
+            _mm_storeu_ps(target + i, sum);
+        }
+        BlendRowsScalar(rows, weights, rowCount, target, count, i);
+    }
+
+    MIP_TARGET_AVX2 void BlendRowsAvx2(const float* const* rows, const float* weights, uint32 rowCount, float* target, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 sum = _mm256_setzero_ps();
+            for (uint32 r = 0; r < rowCount; ++r)
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(rows[r] + i), _mm256_set1_ps(weights[r])));
+            _mm256_storeu_ps(target + i, sum);
+        }
+        BlendRowsScalar(rows, weights, rowCount, target, count, i);
+        _mm256_zeroupper();
+    }
+#endif
+
+    void FilterRow(SimdLevel level, const float* source, float* target, uint32 targetWidth, const FilterTaps& taps)
+    {
+#if MIP_X86
+        if (level >= SimdLevel::Sse2)
+            return FilterRowSse2(source, target, targetWidth, taps);
+#endif
+        (void)level;
+        FilterRowScalar(source, target, targetWidth, taps);
+    }
+
+    void BlendRows(SimdLevel level, const float* const* rows, const float* weights, uint32 rowCount, float* target, std::size_t count)
+    {
+#if MIP_X86
+        if (level == SimdLevel::Avx2)
+            return BlendRowsAvx2(rows, weights, rowCount, target, count);
+        if (level == SimdLevel::Sse2)
+            return BlendRowsSse2(rows, weights, rowCount, target, count);
+#endif
+        (void)level;
+        BlendRowsScalar(rows, weights, rowCount, target, count);
+    }
+
+    // 缩小一级，大小不变的方向直接跳过
+    void Downsample(const FloatImage& source, FloatImage& target, const MipGenerateOptions& options, SimdLevel level)
+    {
+        FloatImage horizontal;
+        const FloatImage* rows = &source;
+        if (target.width != source.width)
+        {
+            const FilterTaps taps = BuildTaps(source.width, target.width, options);
+            horizontal.width = target.width;
+            horizontal.height = source.height;
+            horizontal.pixels.resize((std::size_t)horizontal.width * horizontal.height * 4);
+            ParallelForRows(source.height, options.threadCount, [&](uint32 y)
+            {
+                FilterRow(level, source.Row(y), horizontal.Row(y), target.width, taps);
+            });
+            rows = &horizontal;
+        }
+
+        target.pixels.resize((std::size_t)target.width * target.height * 4);
+        if (target.height == source.height)
+        {
+            std::memcpy(target.pixels.data(), rows->pixels.data(), target.pixels.size() * sizeof(float));
+            return;
+        }
+
+        const FilterTaps taps = BuildTaps(source.height, target.height, options);
+        ParallelForRows(target.height, options.threadCount, [&](uint32 y)
+        {
+            const uint32 first = taps.offsets[y], count = taps.offsets[y + 1] - first;
+            std::vector<const float*> sourceRows(count);
+            for (uint32 t = 0; t < count; ++t)
+                sourceRows[t] = rows->Row(taps.indices[first + t]);
+            BlendRows(level, sourceRows.data(), taps.weights.data() + first, count, target.Row(y), (std::size_t)target.width * 4);
+        });
+    }
+
+    // ---------------------------------------------------------------------------------------------
+    // 8位和float的转换
+
+    float SrgbToLinear(float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    struct ColorTables
+    {
+        float toLinear[256];
+        // 第i项为sRGB编码(i - 0.5) / 255对应的线性值，线性值转换为8位时二分查找，按sRGB空间四舍五入
+        float thresholds[256];
+    };
+
+    const ColorTables& GetColorTables()
+    {
+        static const ColorTables tables = []()
+        {
+            ColorTables result;
+            for (uint32 i = 0; i < 256; ++i)
+            {
+                result.toLinear[i] = SrgbToLinear(i / 255.0f);
+                result.thresholds[i] = i == 0 ? -FLT_MAX : SrgbToLinear((i - 0.5f) / 255.0f);
+            }
+            return result;
+        }();
+        return tables;
+    }
+
+    uint8 LinearToSrgb8(const ColorTables& tables, float value)
+    {
+        uint32 low = 0;
+        for (uint32 step = 128; step > 0; step >>= 1)
+        {
+            if (low + step <= 255 && tables.thresholds[low + step] <= value)
+                low += step;
+        }
+        return (uint8)low;
+    }
+
+    uint8 UnitToUnorm8(float value)
+    {
+        return (uint8)((std::min)((std::max)(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+
+    void ToFloatImage(const RgbaImage& source, bool srgb, uint32 threadCount, FloatImage& target)
+    {
+        const ColorTables& tables = GetColorTables();
+        target.width = source.width;
+        target.height = source.height;
+        target.pixels.resize((std::size_t)source.width * source.height * 4);
+        ParallelForRows(source.height, threadCount, [&](uint32 y)
+        {
+            const uint8* input = source.pixels.data() + y * source.RowPitch();
+            float* output = target.Row(y);
+            for (std::size_t i = 0; i < source.RowPitch(); ++i)
+                output[i] = srgb && (i & 3) != 3 ? tables.toLinear[input[i]] : input[i] / 255.0f;
+        });
+    }
+
+    void ToRgbaImage(const FloatImage& source, bool srgb, uint32 threadCount, RgbaImage& target)
+    {
+        const ColorTables& tables = GetColorTables();
+        target.width = source.width;
+        target.height = source.height;
+        target.pixels.resize(target.RowPitch() * target.height);
+        ParallelForRows(source.height, threadCount, [&](uint32 y)
+        {
+            const float* input = source.Row(y);
+            uint8* output = target.pixels.data() + y * target.RowPitch();
+            for (std::size_t i = 0; i < target.RowPitch(); ++i)
+                output[i] = srgb && (i & 3) != 3 ? LinearToSrgb8(tables, input[i]) : UnitToUnorm8(input[i]);
+        });
+    }
+}
+
+const char* MipFilterName(MipFilter filter)
+{
+    return filter == MipFilter::Box ? "box" : "kaiser";
+}
+
+std::uint32_t CountMipLevels(std::uint32_t width, std::uint32_t height)
+{
+    std::uint32_t levels = 1;
+    for (std::uint32_t size = (std::max)(width, height); size > 1; size >>= 1)
+        ++levels;
+    return levels;
+}
+
+bool GenerateMips(const RgbaImage& source, const MipGenerateOptions& options, std::vector<RgbaImage>& mips, std::uint32_t maxLevels)
+{
+    if (source.width == 0 || source.height == 0 || source.pixels.size() != source.RowPitch() * source.height)
+        return false;
+
+    std::uint32_t levelCount = CountMipLevels(source.width, source.height);
+    if (maxLevels > 0)
+        levelCount = (std::min)(levelCount, maxLevels);
+    const SimdLevel level = (std::min)(options.simdLevel, DetectSimdLevel());
+
+    mips.resize(levelCount);
+    mips[0] = source;
+    FloatImage current, next;
+    if (levelCount > 1)
+        ToFloatImage(source, options.srgb, options.threadCount, current);
+    for (std::uint32_t mip = 1; mip < levelCount; ++mip)
+    {
+        next.width = (std::max)(current.width >> 1, 1u);
+        next.height = (std::max)(current.height >> 1, 1u);
+        Downsample(current, next, options, level);
+        ToRgbaImage(next, options.srgb, options.threadCount, mips[mip]);
+        std::swap(current, next);
+    }
+    return true;
+}
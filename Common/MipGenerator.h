@@ -0,0 +1,38 @@
+#pragma once
+
+#include "BlockCompression.h"
+#include "TextureFile.h"
+#include <cstdint>
+#include <vector>
+
+// 在CPU上为RGBA8的图片生成完整的mip链，不依赖图形API。
+// 每一级由上一级按可分离的滤波器缩小得到，先横向再纵向，中间结果保存为float，避免每级都量化到8位。
+// 宽高不是2的幂时每级为(max(width >> 1, 1), max(height >> 1, 1))，与D3D相同，滤波器的权重按实际的缩放比例计算，
+// 奇数边长不会丢掉最后一行、一列。
+// sRGB的颜色先转换到线性空间再滤波，alpha始终按线性值处理。
+// 横向每个像素的4个通道用一个SSE寄存器累加，纵向按行用SSE2或AVX2累加，每个pass按行分给多个线程。
+
+enum class MipFilter
+{
+    Box,        // 每个源像素按被目标像素覆盖的面积加权，2倍缩小时为2x2平均
+    Kaiser,     // Kaiser窗的sinc，比box锐利，细节在多级之后仍然清楚，但可能有轻微的振铃
+};
+
+struct MipGenerateOptions
+{
+    MipFilter filter = MipFilter::Kaiser;
+    bool srgb = false;                          // RGB按sRGB编码，在线性空间滤波
+    bool wrap = false;                          // 边缘按repeat取样（平铺的texture），否则按clamp
+    float kaiserWidth = 3.0f;                   // 以目标像素为单位的半径
+    float kaiserAlpha = 4.0f;                   // 越大窗口越窄，振铃越小
+    SimdLevel simdLevel = DetectSimdLevel();    // 超过CPU支持的级别时自动降低
+    std::uint32_t threadCount = 0;              // 0为std::thread::hardware_concurrency
+};
+
+const char* MipFilterName(MipFilter filter);
+
+// 到1x1为止的级数
+std::uint32_t CountMipLevels(std::uint32_t width, std::uint32_t height);
+
+// mips[0]为source，之后依次为每一级，直到1x1。maxLevels为0时生成完整的mip链。source为空时返回false
+bool GenerateMips(const RgbaImage& source, const MipGenerateOptions& options, std::vector<RgbaImage>& mips, std::uint32_t maxLevels = 0);
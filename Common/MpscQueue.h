@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+// 无锁的多生产者单消费者队列（Vyukov的链表实现）
+// Push可以在任意线程调用，Pop只能在同一个消费者线程调用。
+// 生产者交换完m_head但还没链接next时，Pop会暂时返回false，下次再取即可。
+template<typename T>
+class MpscQueue
+{
+public:
+    MpscQueue()
+    {
+        Node* stub = new Node();
+        m_head.store(stub, std::memory_order_relaxed);
+        m_tail = stub;
+    }
+
+    MpscQueue(const MpscQueue& rhs) = delete;
+    MpscQueue& operator=(const MpscQueue& rhs) = delete;
+
+    ~MpscQueue()
+    {
+        T value;
+        while (Pop(value)) {}
+        delete m_tail;
+    }
+
+    void Push(T value)
+    {
+        Node* node = new Node();
+        node->value = std::move(value);
+        // 先把自己设为新的head，再把前一个节点指向自己
+        Node* prev = m_head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    bool Pop(T& value)
+    {
+        Node* tail = m_tail;
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+            return false;
+
+        // next成为新的stub节点，它的value已经被取走
+        value = std::move(next->value);
+        m_tail = next;
+        delete tail;
+        return true;
+    }
+
+private:
+    struct Node
+    {
+        std::atomic<Node*> next{ nullptr };
+        T value{};
+    };
+
+    std::atomic<Node*> m_head;      // 生产者写入端
+    Node* m_tail;                   // 消费者读取端，总是指向一个已经取走数据的节点
+};
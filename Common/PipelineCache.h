@@ -0,0 +1,234 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 以64位哈希为key的pipeline缓存，不依赖图形API，TPipeline可以是ComPtr<ID3D12PipelineState>，也可以是测试用的整数等。
+// 同一个哈希只编译一次，之后的Request直接丢弃；没有命中的在后台线程中编译。
+// Get时如果还没有线程开始编译，就在调用的线程中编译，不用等待队列前面的任务。
+template<typename TPipeline>
+class PipelineCache
+{
+public:
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+    using CompileFunction = std::function<TPipeline()>;
+
+    struct Stats
+    {
+        uint64 requestCount = 0;        // Request调用次数
+        uint64 duplicateCount = 0;      // 已经请求过而丢弃的Request
+        uint64 compileCount = 0;        // 实际编译的次数
+        uint64 failedCount = 0;         // 编译时抛出异常的次数
+    };
+
+    // threadCount为0时在Request中直接编译
+    explicit PipelineCache(uint32 threadCount)
+    {
+        for (uint32 i = 0; i < threadCount; ++i)
+            m_threads.emplace_back([this]() { WorkerThread(); });
+    }
+
+    PipelineCache(const PipelineCache& rhs) = delete;
+    PipelineCache& operator=(const PipelineCache& rhs) = delete;
+
+    // 还没开始编译的任务直接丢弃，等待正在编译的完成
+    ~PipelineCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_exit = true;
+        }
+        m_jobCondition.notify_all();
+        for (auto& thread : m_threads)
+            thread.join();
+    }
+
+    // 返回true表示是新的请求，false表示之前已经请求过（可能还在编译）
+    bool Request(uint64 hash, CompileFunction compile)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_stats.requestCount;
+            if (m_entries.find(hash) != m_entries.end())
+            {
+                ++m_stats.duplicateCount;
+                return false;
+            }
+
+            Entry& entry = m_entries[hash];
+            entry.compile = std::move(compile);
+            ++m_pendingCount;
+            if (!m_threads.empty())
+            {
+                m_jobs.push_back(hash);
+                m_jobCondition.notify_one();
+                return true;
+            }
+        }
+
+        Compile(hash);
+        return true;
+    }
+
+    bool Contains(uint64 hash)const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.find(hash) != m_entries.end();
+    }
+
+    // 已经编译成功时返回true，不会等待
+    bool TryGet(uint64 hash, TPipeline& pipeline)const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(hash);
+        if (it == m_entries.end() || it->second.state != EntryState::Ready)
+            return false;
+        pipeline = it->second.pipeline;
+        return true;
+    }
+
+    // 等待编译完成，编译失败时重新抛出编译时的异常
+    TPipeline Get(uint64 hash)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(hash);
+        if (it == m_entries.end())
+            throw std::out_of_range("PipelineCache::Get: pipeline没有Request过");
+
+        Entry& entry = it->second;
+        if (entry.state == EntryState::Queued)
+        {
+            lock.unlock();
+            Compile(hash);
+            lock.lock();
+        }
+        m_doneCondition.wait(lock, [&entry]() { return entry.state == EntryState::Ready || entry.state == EntryState::Failed; });
+
+        if (entry.state == EntryState::Failed)
+            std::rethrow_exception(entry.exception);
+        return entry.pipeline;
+    }
+
+    // 等待所有请求编译完成
+    void WaitIdle()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCondition.wait(lock, [this]() { return m_pendingCount == 0; });
+    }
+
+    // 遍历编译成功的pipeline，例如把它们存入pipeline library
+    void ForEachReady(const std::function<void(uint64 hash, const TPipeline& pipeline)>& func)const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& e : m_entries)
+        {
+            if (e.second.state == EntryState::Ready)
+                func(e.first, e.second.pipeline);
+        }
+    }
+
+    Stats GetStats()const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+private:
+    enum class EntryState
+    {
+        Queued,         // 等待编译
+        Compiling,
+        Ready,
+        Failed,
+    };
+
+    struct Entry
+    {
+        EntryState state = EntryState::Queued;
+        CompileFunction compile;
+        TPipeline pipeline{};
+        std::exception_ptr exception;
+    };
+
+    // 编译hash对应的pipeline，已经有其他线程开始编译时直接返回
+    void Compile(uint64 hash)
+    {
+        CompileFunction compile;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Entry& entry = m_entries[hash];
+            if (entry.state != EntryState::Queued)
+                return;
+            entry.state = EntryState::Compiling;
+            compile = std::move(entry.compile);
+            entry.compile = nullptr;
+        }
+
+        TPipeline pipeline{};
+        std::exception_ptr exception;
+        try
+        {
+            pipeline = compile();
+        }
+        catch (...)
+        {
+            exception = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            Entry& entry = m_entries[hash];
+            ++m_stats.compileCount;
+            if (exception)
+            {
+                ++m_stats.failedCount;
+                entry.exception = exception;
+                entry.state = EntryState::Failed;
+            }
+            else
+            {
+                entry.pipeline = std::move(pipeline);
+                entry.state = EntryState::Ready;
+            }
+            --m_pendingCount;
+        }
+        m_doneCondition.notify_all();
+    }
+
+    void WorkerThread()
+    {
+        while (true)
+        {
+            uint64 hash;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_jobCondition.wait(lock, [this]() { return m_exit || !m_jobs.empty(); });
+                if (m_exit)
+                    return;
+                hash = m_jobs.front();
+                m_jobs.pop_front();
+            }
+            Compile(hash);
+        }
+    }
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobCondition;     // 有新的任务或需要退出
+    std::condition_variable m_doneCondition;    // 有pipeline编译完成
+    std::unordered_map<uint64, Entry> m_entries;
+    std::deque<uint64> m_jobs;                  // 等待后台线程编译的哈希，可能已经被Get在调用线程中编译
+    std::vector<std::thread> m_threads;
+    uint32 m_pendingCount = 0;                  // 还没有编译完成的请求
+    bool m_exit = false;
+    Stats m_stats;
+};
@@ -0,0 +1,214 @@
+#include "PipelineStateCache.h"
+#include <fstream>
+
+namespace
+{
+    // pipeline library中PSO的名字
+    std::wstring PipelineName(UINT64 hash)
+    {
+        wchar_t name[17];
+        swprintf_s(name, L"%016llx", hash);
+        return name;
+    }
+
+    void AddBlendDesc(Hasher64& hasher, const D3D12_BLEND_DESC& blend)
+    {
+        hasher.AddValue(blend.AlphaToCoverageEnable).AddValue(blend.IndependentBlendEnable);
+        // 没有开启IndependentBlendEnable时只使用RenderTarget[0]
+        UINT count = blend.IndependentBlendEnable ? 8 : 1;
+        for (UINT i = 0; i < count; ++i)
+        {
+            const D3D12_RENDER_TARGET_BLEND_DESC& rt = blend.RenderTarget[i];
+            hasher.AddValue(rt.BlendEnable).AddValue(rt.LogicOpEnable);
+            if (rt.BlendEnable)
+            {
+                hasher.AddValue(rt.SrcBlend).AddValue(rt.DestBlend).AddValue(rt.BlendOp);
+                hasher.AddValue(rt.SrcBlendAlpha).AddValue(rt.DestBlendAlpha).AddValue(rt.BlendOpAlpha);
+            }
+            if (rt.LogicOpEnable)
+                hasher.AddValue(rt.LogicOp);
+            hasher.AddValue(rt.RenderTargetWriteMask);
+        }
+    }
+
+    void AddRasterizerDesc(Hasher64& hasher, const D3D12_RASTERIZER_DESC& rasterizer)
+    {
+        hasher.AddValue(rasterizer.FillMode).AddValue(rasterizer.CullMode).AddValue(rasterizer.FrontCounterClockwise);
+        hasher.AddValue(rasterizer.DepthBias).AddValue(rasterizer.DepthBiasClamp).AddValue(rasterizer.SlopeScaledDepthBias);
+        hasher.AddValue(rasterizer.DepthClipEnable).AddValue(rasterizer.MultisampleEnable).AddValue(rasterizer.AntialiasedLineEnable);
+        hasher.AddValue(rasterizer.ForcedSampleCount).AddValue(rasterizer.ConservativeRaster);
+    }
+
+    void AddStencilOpDesc(Hasher64& hasher, const D3D12_DEPTH_STENCILOP_DESC& op)
+    {
+        hasher.AddValue(op.StencilFailOp).AddValue(op.StencilDepthFailOp).AddValue(op.StencilPassOp).AddValue(op.StencilFunc);
+    }
+
+    void AddDepthStencilDesc(Hasher64& hasher, const D3D12_DEPTH_STENCIL_DESC& depthStencil)
+    {
+        hasher.AddValue(depthStencil.DepthEnable);
+        if (depthStencil.DepthEnable)
+            hasher.AddValue(depthStencil.DepthWriteMask).AddValue(depthStencil.DepthFunc);
+        hasher.AddValue(depthStencil.StencilEnable);
+        if (depthStencil.StencilEnable)
+        {
+            hasher.AddValue(depthStencil.StencilReadMask).AddValue(depthStencil.StencilWriteMask);
+            AddStencilOpDesc(hasher, depthStencil.FrontFace);
+            AddStencilOpDesc(hasher, depthStencil.BackFace);
+        }
+    }
+}
+
+UINT64 HashShaderBytecode(const D3D12_SHADER_BYTECODE& bytecode)
+{
+    if (bytecode.pShaderBytecode == nullptr || bytecode.BytecodeLength == 0)
+        return 0;
+
+    // DXBC容器：4字节"DXBC"之后是16字节的校验和
+    Hasher64 hasher;
+    hasher.AddValue((UINT64)bytecode.BytecodeLength);
+    const char* data = static_cast<const char*>(bytecode.pShaderBytecode);
+    if (bytecode.BytecodeLength >= 20 && memcmp(data, "DXBC", 4) == 0)
+        hasher.Add(data + 4, 16);
+    else
+        hasher.Add(data, bytecode.BytecodeLength);
+    return hasher.Result();
+}
+
+UINT64 HashGraphicsPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, UINT64 rootSignatureHash)
+{
+    Hasher64 hasher;
+    hasher.AddValue(rootSignatureHash);
+
+    hasher.AddValue(HashShaderBytecode(desc.VS));
+    hasher.AddValue(HashShaderBytecode(desc.PS));
+    hasher.AddValue(HashShaderBytecode(desc.DS));
+    hasher.AddValue(HashShaderBytecode(desc.HS));
+    hasher.AddValue(HashShaderBytecode(desc.GS));
+
+    const D3D12_STREAM_OUTPUT_DESC& streamOutput = desc.StreamOutput;
+    hasher.AddValue(streamOutput.NumEntries);
+    for (UINT i = 0; i < streamOutput.NumEntries; ++i)
+    {
+        const D3D12_SO_DECLARATION_ENTRY& entry = streamOutput.pSODeclaration[i];
+        hasher.AddValue(entry.Stream).AddString(entry.SemanticName).AddValue(entry.SemanticIndex);
+        hasher.AddValue(entry.StartComponent).AddValue(entry.ComponentCount).AddValue(entry.OutputSlot);
+    }
+    hasher.AddValue(streamOutput.NumStrides);
+    for (UINT i = 0; i < streamOutput.NumStrides; ++i)
+        hasher.AddValue(streamOutput.pBufferStrides[i]);
+    if (streamOutput.NumEntries > 0)
+        hasher.AddValue(streamOutput.RasterizedStream);
+
+    AddBlendDesc(hasher, desc.BlendState);
+    hasher.AddValue(desc.SampleMask);
+    AddRasterizerDesc(hasher, desc.RasterizerState);
+    AddDepthStencilDesc(hasher, desc.DepthStencilState);
+
+    hasher.AddValue(desc.InputLayout.NumElements);
+    for (UINT i = 0; i < desc.InputLayout.NumElements; ++i)
+    {
+        const D3D12_INPUT_ELEMENT_DESC& element = desc.InputLayout.pInputElementDescs[i];
+        hasher.AddString(element.SemanticName).AddValue(element.SemanticIndex).AddValue(element.Format);
+        hasher.AddValue(element.InputSlot).AddValue(element.AlignedByteOffset);
+        hasher.AddValue(element.InputSlotClass).AddValue(element.InstanceDataStepRate);
+    }
+
+    hasher.AddValue(desc.IBStripCutValue).AddValue(desc.PrimitiveTopologyType);
+    hasher.AddValue(desc.NumRenderTargets);
+    for (UINT i = 0; i < desc.NumRenderTargets && i < 8; ++i)
+        hasher.AddValue(desc.RTVFormats[i]);
+    hasher.AddValue(desc.DSVFormat);
+    hasher.AddValue(desc.SampleDesc.Count).AddValue(desc.SampleDesc.Quality);
+    hasher.AddValue(desc.NodeMask).AddValue(desc.Flags);
+    return hasher.Result();
+}
+
+PipelineStateCache::PipelineStateCache(ID3D12Device* device, const std::wstring& libraryPath, UINT threadCount) :
+    m_device(device),
+    m_libraryPath(libraryPath),
+    m_cache(threadCount)
+{
+    ComPtr<ID3D12Device1> device1;
+    if (FAILED(device->QueryInterface(IID_PPV_ARGS(&device1))))
+        return;
+
+    std::ifstream fin(libraryPath, std::ios::binary);
+    if (fin)
+    {
+        fin.seekg(0, std::ios_base::end);
+        m_libraryData.resize((size_t)fin.tellg());
+        fin.seekg(0, std::ios_base::beg);
+        fin.read(m_libraryData.data(), m_libraryData.size());
+        if (!fin)
+            m_libraryData.clear();
+    }
+
+    // 驱动更新或换了显卡后文件中的数据不能使用，返回D3D12_ERROR_DRIVER_VERSION_MISMATCH等错误
+    if (m_libraryData.empty() ||
+        FAILED(device1->CreatePipelineLibrary(m_libraryData.data(), m_libraryData.size(), IID_PPV_ARGS(&m_library))))
+    {
+        m_libraryData.clear();
+        m_library = nullptr;
+        if (FAILED(device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&m_library))))
+            m_library = nullptr;
+        // 旧的文件需要被覆盖
+        m_dirty = m_library != nullptr;
+    }
+}
+
+UINT64 PipelineStateCache::Request(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, UINT64 rootSignatureHash)
+{
+    UINT64 hash = HashGraphicsPipelineDesc(desc, rootSignatureHash);
+    m_cache.Request(hash, [this, desc, hash]() { return CreatePipelineState(desc, hash); });
+    return hash;
+}
+
+ComPtr<ID3D12PipelineState> PipelineStateCache::CreatePipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, UINT64 hash)
+{
+    ComPtr<ID3D12PipelineState> pipelineState;
+    std::wstring name = PipelineName(hash);
+
+    // 同一个名字只会在一个线程中读取或存入，不需要额外的同步
+    if (m_library && SUCCEEDED(m_library->LoadGraphicsPipeline(name.c_str(), &desc, IID_PPV_ARGS(&pipelineState))))
+    {
+        ++m_loadedCount;
+        return pipelineState;
+    }
+
+    ThrowIfFailed(m_device->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pipelineState)));
+    ++m_createdCount;
+
+    if (m_library && SUCCEEDED(m_library->StorePipeline(name.c_str(), pipelineState.Get())))
+        m_dirty = true;
+    return pipelineState;
+}
+
+void PipelineStateCache::Save()
+{
+    if (!m_library)
+        return;
+
+    m_cache.WaitIdle();
+    if (!m_dirty)
+        return;
+
+    std::vector<char> data(m_library->GetSerializedSize());
+    ThrowIfFailed(m_library->Serialize(data.data(), data.size()));
+
+    std::ofstream fout(m_libraryPath, std::ios::binary | std::ios::trunc);
+    fout.write(data.data(), data.size());
+    m_dirty = false;
+}
+
+PipelineStateCache::Stats PipelineStateCache::GetStats()const
+{
+    auto cacheStats = m_cache.GetStats();
+
+    Stats stats;
+    stats.requestCount = cacheStats.requestCount;
+    stats.duplicateCount = cacheStats.duplicateCount;
+    stats.loadedCount = m_loadedCount;
+    stats.createdCount = m_createdCount;
+    return stats;
+}
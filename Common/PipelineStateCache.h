@@ -0,0 +1,55 @@
+#pragma once
+
+#include "d3d12Util.h"
+#include "HashUtil.h"
+#include "PipelineCache.h"
+#include <atomic>
+
+// shader bytecode的哈希，DXBC容器直接使用其中记录的校验和，不用读取整个bytecode
+UINT64 HashShaderBytecode(const D3D12_SHADER_BYTECODE& bytecode);
+
+// 标准化后的PSO描述的哈希：指针换成所指内容的哈希，不起作用的字段（例如没有开启blend时的blend参数）不参与计算。
+// pRootSignature只是指针，由rootSignatureHash代替，一般为序列化后root signature的哈希
+UINT64 HashGraphicsPipelineDesc(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, UINT64 rootSignatureHash);
+
+// PSO缓存：相同的PSO描述只创建一次，在后台线程中创建，并通过ID3D12PipelineLibrary保存到文件中，下次启动时直接读取。
+// 不支持ID3D12PipelineLibrary时（没有ID3D12Device1）只在内存中缓存
+class PipelineStateCache
+{
+public:
+    struct Stats
+    {
+        UINT64 requestCount = 0;
+        UINT64 duplicateCount = 0;      // 已经请求过的PSO
+        UINT64 loadedCount = 0;         // 从pipeline library中读取的PSO
+        UINT64 createdCount = 0;        // 重新创建的PSO
+    };
+
+    // libraryPath中的文件不存在或者与当前的驱动、显卡不匹配时，从空的library开始
+    PipelineStateCache(ID3D12Device* device, const std::wstring& libraryPath, UINT threadCount = 2);
+
+    // 返回PSO的哈希，之后用它获取PSO。desc引用的shader、input layout等数据在PSO创建完成之前必须保持有效
+    UINT64 Request(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, UINT64 rootSignatureHash);
+    // 等待PSO创建完成
+    ComPtr<ID3D12PipelineState> Get(UINT64 hash) { return m_cache.Get(hash); }
+    bool TryGet(UINT64 hash, ComPtr<ID3D12PipelineState>& pipelineState)const { return m_cache.TryGet(hash, pipelineState); }
+
+    // 有新创建的PSO时把pipeline library写入文件
+    void Save();
+
+    Stats GetStats()const;
+
+private:
+    ComPtr<ID3D12PipelineState> CreatePipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc, UINT64 hash);
+
+    ComPtr<ID3D12Device> m_device;
+    ComPtr<ID3D12PipelineLibrary> m_library;
+    std::vector<char> m_libraryData;            // library使用期间必须保持有效
+    std::wstring m_libraryPath;
+    std::atomic<bool> m_dirty{ false };         // 有新的PSO存入了library
+    std::atomic<UINT64> m_loadedCount{ 0 };
+    std::atomic<UINT64> m_createdCount{ 0 };
+
+    // 放在最后，析构时先等待后台线程结束，再释放library
+    PipelineCache<ComPtr<ID3D12PipelineState>> m_cache;
+};
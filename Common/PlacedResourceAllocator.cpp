@@ -0,0 +1,213 @@
+#include "PlacedResourceAllocator.h"
+#include <algorithm>
+
+namespace
+{
+    D3D12_HEAP_FLAGS GetHeapFlags(PlacedResourceAllocator::HeapClass heapClass)
+    {
+        switch (heapClass)
+        {
+        case PlacedResourceAllocator::HeapClass::Buffer:
+            return D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS;
+        case PlacedResourceAllocator::HeapClass::Texture:
+            return D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES;
+        default:
+            return D3D12_HEAP_FLAG_ALLOW_ONLY_RT_DS_TEXTURES;
+        }
+    }
+
+    // TLSF的分配粒度，texture page使用small resource对齐，RT/DS只能64KB对齐
+    UINT64 GetGranularity(PlacedResourceAllocator::HeapClass heapClass)
+    {
+        switch (heapClass)
+        {
+        case PlacedResourceAllocator::HeapClass::Buffer:
+            return 256;
+        case PlacedResourceAllocator::HeapClass::Texture:
+            return D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+        default:
+            return D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        }
+    }
+}
+
+PlacedResourceAllocator::PlacedResourceAllocator(ID3D12Device* device, D3D12_HEAP_TYPE heapType, UINT64 pageSize) :
+    m_device(device),
+    m_heapType(heapType),
+    m_pageSize(pageSize)
+{
+    // heap的大小必须是64KB的整数倍
+    m_pageSize = (pageSize + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1) & ~(UINT64)(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1);
+}
+
+UINT PlacedResourceAllocator::CreatePage(HeapClass heapClass, UINT64 size)
+{
+    auto& pages = m_pages[(int)heapClass];
+
+    // 超过page大小的resource单独使用一个page
+    size = std::max(size, m_pageSize);
+    size = (size + D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1) & ~(UINT64)(D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT - 1);
+
+    Page page;
+    CD3DX12_HEAP_DESC heapDesc(size, m_heapType, D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT, GetHeapFlags(heapClass));
+    ThrowIfFailed(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&page.heap)));
+
+    if (heapClass == HeapClass::Buffer)
+    {
+        D3D12_RESOURCE_STATES state = D3D12_RESOURCE_STATE_COMMON;
+        if (m_heapType == D3D12_HEAP_TYPE_UPLOAD)
+            state = D3D12_RESOURCE_STATE_GENERIC_READ;
+        else if (m_heapType == D3D12_HEAP_TYPE_READBACK)
+            state = D3D12_RESOURCE_STATE_COPY_DEST;
+
+        ThrowIfFailed(m_device->CreatePlacedResource(
+            page.heap.Get(),
+            0,
+            &CD3DX12_RESOURCE_DESC::Buffer(size),
+            state,
+            nullptr,
+            IID_PPV_ARGS(&page.buffer)));
+    }
+    page.allocator = std::make_unique<TlsfAllocator>(size, GetGranularity(heapClass));
+
+    // 优先复用ReleaseEmptyPages空出来的位置，保证已有的pageIndex不变
+    for (UINT i = 0; i < (UINT)pages.size(); ++i)
+    {
+        if (pages[i].heap == nullptr)
+        {
+            pages[i] = std::move(page);
+            return i;
+        }
+    }
+    pages.push_back(std::move(page));
+    return (UINT)pages.size() - 1;
+}
+
+UINT PlacedResourceAllocator::AllocateFromPages(HeapClass heapClass, UINT64 size, UINT64 alignment, TlsfAllocator::Allocation& allocation)
+{
+    auto& pages = m_pages[(int)heapClass];
+    for (UINT i = 0; i < (UINT)pages.size(); ++i)
+    {
+        if (pages[i].heap != nullptr && pages[i].allocator->Allocate(size, alignment, allocation))
+            return i;
+    }
+
+    UINT pageIndex = CreatePage(heapClass, size + alignment);
+    if (!pages[pageIndex].allocator->Allocate(size, alignment, allocation))
+        ThrowIfFailed(E_OUTOFMEMORY);
+    return pageIndex;
+}
+
+BufferAllocation PlacedResourceAllocator::AllocateBuffer(UINT64 size, UINT64 alignment)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    BufferAllocation bufferAllocation;
+    bufferAllocation.pageIndex = AllocateFromPages(HeapClass::Buffer, size, alignment, bufferAllocation.allocation);
+    bufferAllocation.resource = m_pages[(int)HeapClass::Buffer][bufferAllocation.pageIndex].buffer.Get();
+    bufferAllocation.offset = bufferAllocation.allocation.offset;
+    bufferAllocation.size = size;
+    return bufferAllocation;
+}
+
+void PlacedResourceAllocator::FreeBuffer(const BufferAllocation& allocation)
+{
+    if (!allocation.allocation.IsValid())
+        return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pages[(int)HeapClass::Buffer][allocation.pageIndex].allocator->Free(allocation.allocation);
+}
+
+ComPtr<ID3D12Resource> PlacedResourceAllocator::CreateTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState,
+    const D3D12_CLEAR_VALUE* clearValue)
+{
+    HeapClass heapClass = HeapClass::Texture;
+    if (desc.Flags & (D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET | D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL))
+        heapClass = HeapClass::RenderTarget;
+
+    // 先尝试4KB对齐，驱动不支持时GetResourceAllocationInfo会返回64KB对齐
+    D3D12_RESOURCE_DESC placedDesc = desc;
+    D3D12_RESOURCE_ALLOCATION_INFO info = {};
+    if (heapClass == HeapClass::Texture && desc.SampleDesc.Count <= 1)
+    {
+        placedDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+        info = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+    }
+    if (info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+    {
+        placedDesc.Alignment = 0;
+        info = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    TextureRecord record;
+    record.heapClass = heapClass;
+    record.pageIndex = AllocateFromPages(heapClass, info.SizeInBytes, info.Alignment, record.allocation);
+
+    ComPtr<ID3D12Resource> texture;
+    HRESULT hr = m_device->CreatePlacedResource(
+        m_pages[(int)heapClass][record.pageIndex].heap.Get(),
+        record.allocation.offset,
+        &placedDesc,
+        initialState,
+        clearValue,
+        IID_PPV_ARGS(&texture));
+    if (FAILED(hr))
+    {
+        m_pages[(int)heapClass][record.pageIndex].allocator->Free(record.allocation);
+        ThrowIfFailed(hr);
+    }
+
+    m_textures[texture.Get()] = record;
+    return texture;
+}
+
+void PlacedResourceAllocator::FreeTexture(ID3D12Resource* texture)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_textures.find(texture);
+    if (it == m_textures.end())
+        return;
+
+    const TextureRecord& record = it->second;
+    m_pages[(int)record.heapClass][record.pageIndex].allocator->Free(record.allocation);
+    m_textures.erase(it);
+}
+
+void PlacedResourceAllocator::ReleaseEmptyPages()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& pages : m_pages)
+    {
+        for (auto& page : pages)
+        {
+            if (page.heap != nullptr && page.allocator->IsEmpty())
+                page = Page();
+        }
+    }
+}
+
+PlacedResourceAllocator::Stats PlacedResourceAllocator::GetStats(HeapClass heapClass)const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats stats;
+    for (auto& page : m_pages[(int)heapClass])
+    {
+        if (page.heap == nullptr)
+            continue;
+
+        TlsfAllocator::Stats pageStats = page.allocator->GetStats();
+        ++stats.pageCount;
+        if (pageStats.usedSize * 2 < pageStats.totalSize)
+            ++stats.sparsePageCount;
+        stats.wastedAlignment += pageStats.usedSize - pageStats.requestedSize;
+
+        stats.total.totalSize += pageStats.totalSize;
+        stats.total.usedSize += pageStats.usedSize;
+        stats.total.requestedSize += pageStats.requestedSize;
+        stats.total.freeSize += pageStats.freeSize;
+        stats.total.largestFreeBlock = std::max(stats.total.largestFreeBlock, pageStats.largestFreeBlock);
+        stats.total.allocationCount += pageStats.allocationCount;
+        stats.total.freeBlockCount += pageStats.freeBlockCount;
+    }
+    return stats;
+}
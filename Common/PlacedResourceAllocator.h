@@ -0,0 +1,119 @@
+#pragma once
+#include "d3d12Util.h"
+#include "TlsfAllocator.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// 从PlacedResourceAllocator的buffer page中分配出的一段空间
+struct BufferAllocation
+{
+    ID3D12Resource* resource = nullptr;     // 整个page对应的buffer
+    UINT64 offset = 0;                      // 在resource中的偏移
+    UINT64 size = 0;
+    UINT pageIndex = 0;
+    TlsfAllocator::Allocation allocation;
+
+    D3D12_GPU_VIRTUAL_ADDRESS GpuAddress()const
+    {
+        return resource->GetGPUVirtualAddress() + offset;
+    }
+};
+
+// 预先创建大块的ID3D12Heap（page），再用TLSF在其中划分placed resource，
+// 避免每个buffer/texture都调用CreateCommittedResource产生一个隐式heap。
+// - buffer：每个page上只创建一个覆盖整个page的placed buffer，各个buffer只是其中的一段，
+//   这样不会受到placed resource 64KB对齐的限制。page buffer始终处于COMMON状态，依靠隐式promotion/decay使用，
+//   所以同一个command list中拷贝后不能直接读取。
+// - texture：每个texture是一个placed resource，能使用4KB的small resource对齐时就使用4KB对齐。
+// 所有public函数都可以在多个线程中同时调用，例如渲染线程分配buffer的同时后台线程创建texture。
+class PlacedResourceAllocator
+{
+public:
+    // resource heap tier 1的硬件上，buffer、普通texture、RT/DS texture不能放在同一个heap中
+    enum class HeapClass
+    {
+        Buffer = 0,
+        Texture,
+        RenderTarget,
+        Count
+    };
+
+    struct Stats
+    {
+        UINT pageCount = 0;
+        UINT sparsePageCount = 0;           // 使用率低于一半的page，整理碎片时优先搬空
+        UINT64 wastedAlignment = 0;         // 因对齐和粒度取整而浪费的空间
+        TlsfAllocator::Stats total;         // 所有page汇总，largestFreeBlock取各page中的最大值
+    };
+
+    PlacedResourceAllocator(ID3D12Device* device, D3D12_HEAP_TYPE heapType = D3D12_HEAP_TYPE_DEFAULT, UINT64 pageSize = 64 * 1024 * 1024);
+    PlacedResourceAllocator(const PlacedResourceAllocator& rhs) = delete;
+    PlacedResourceAllocator& operator=(const PlacedResourceAllocator& rhs) = delete;
+
+    // 数据通过UploadManager::UploadBuffer上传，不在这里创建upload buffer
+    BufferAllocation AllocateBuffer(UINT64 size, UINT64 alignment = 256);
+    void FreeBuffer(const BufferAllocation& allocation);
+
+    // 根据desc的flag自动选择Texture或RenderTarget类的page
+    ComPtr<ID3D12Resource> CreateTexture(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState,
+        const D3D12_CLEAR_VALUE* clearValue = nullptr);
+    // 调用者需要保证GPU已经不再使用该texture
+    void FreeTexture(ID3D12Resource* texture);
+
+    // 释放完全空闲的page
+    void ReleaseEmptyPages();
+
+    Stats GetStats(HeapClass heapClass)const;
+
+private:
+    struct Page
+    {
+        ComPtr<ID3D12Heap> heap;
+        ComPtr<ID3D12Resource> buffer;      // 只有buffer page有
+        std::unique_ptr<TlsfAllocator> allocator;
+    };
+
+    struct TextureRecord
+    {
+        HeapClass heapClass = HeapClass::Texture;
+        UINT pageIndex = 0;
+        TlsfAllocator::Allocation allocation;
+    };
+
+    UINT AllocateFromPages(HeapClass heapClass, UINT64 size, UINT64 alignment, TlsfAllocator::Allocation& allocation);
+    UINT CreatePage(HeapClass heapClass, UINT64 size);
+
+    ID3D12Device* m_device;
+    D3D12_HEAP_TYPE m_heapType;
+    UINT64 m_pageSize;
+
+    std::vector<Page> m_pages[(int)HeapClass::Count];
+    std::unordered_map<ID3D12Resource*, TextureRecord> m_textures;
+    mutable std::mutex m_mutex;             // 保护m_pages和m_textures
+};
+
+// 析构时把texture还给allocator。交给DeferredReleaseQueue后，GPU完成对应的fence时才释放
+class PlacedTextureRelease
+{
+public:
+    PlacedTextureRelease(PlacedResourceAllocator* allocator, ComPtr<ID3D12Resource> texture) :
+        m_allocator(allocator),
+        m_texture(std::move(texture))
+    {
+    }
+    PlacedTextureRelease(PlacedTextureRelease&& rhs) = default;
+    PlacedTextureRelease(const PlacedTextureRelease& rhs) = delete;
+    PlacedTextureRelease& operator=(const PlacedTextureRelease& rhs) = delete;
+
+    ~PlacedTextureRelease()
+    {
+        if (m_allocator != nullptr && m_texture != nullptr)
+            m_allocator->FreeTexture(m_texture.Get());
+    }
+
+private:
+    PlacedResourceAllocator* m_allocator;
+    ComPtr<ID3D12Resource> m_texture;
+};
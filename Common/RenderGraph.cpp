@@ -0,0 +1,353 @@
+#include "RenderGraph.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+namespace
+{
+    inline std::uint64_t AlignUp(std::uint64_t value, std::uint64_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+RenderGraph::ResourceHandle RenderGraph::CreateTransient(const std::string& name, uint64 size, uint64 alignment)
+{
+    ResourceNode resource;
+    resource.name = name;
+    resource.size = size;
+    resource.alignment = alignment;
+    m_resources.push_back(resource);
+    return (ResourceHandle)m_resources.size() - 1;
+}
+
+RenderGraph::ResourceHandle RenderGraph::ImportResource(const std::string& name, State initialState, State finalState)
+{
+    ResourceNode resource;
+    resource.name = name;
+    resource.imported = true;
+    resource.initialState = initialState;
+    resource.finalState = finalState;
+    m_resources.push_back(resource);
+    return (ResourceHandle)m_resources.size() - 1;
+}
+
+RenderGraph::uint32 RenderGraph::AddPass(const std::string& name, std::function<void()> execute)
+{
+    PassNode pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    m_passes.push_back(std::move(pass));
+    return (uint32)m_passes.size() - 1;
+}
+
+void RenderGraph::Read(uint32 pass, ResourceHandle resource, State state)
+{
+    m_passes[pass].reads.push_back({ resource, state });
+}
+
+void RenderGraph::Write(uint32 pass, ResourceHandle resource, State state)
+{
+    m_passes[pass].writes.push_back({ resource, state });
+    // 写外部resource的结果会在渲染图之外使用
+    if (m_resources[resource].imported)
+        m_passes[pass].hasSideEffect = true;
+}
+
+void RenderGraph::SetSideEffect(uint32 pass)
+{
+    m_passes[pass].hasSideEffect = true;
+}
+
+void RenderGraph::Compile()
+{
+    m_compiledPasses.clear();
+    m_finalBarriers.clear();
+    m_stats = Stats();
+    m_stats.passCount = (uint32)m_passes.size();
+
+    BuildDependencies();
+    CullPasses();
+
+    std::vector<uint32> order;
+    SortPasses(order);
+    for (uint32 passIndex : order)
+    {
+        CompiledPass compiledPass;
+        compiledPass.passIndex = passIndex;
+        m_compiledPasses.push_back(std::move(compiledPass));
+    }
+
+    AllocateTransients();
+    BuildBarriers();
+}
+
+void RenderGraph::BuildDependencies()
+{
+    // 按声明的顺序确定读写的先后：读依赖之前最后一次写，写依赖之前的读和写
+    std::vector<uint32> lastWriter(m_resources.size(), (uint32)InvalidIndex);
+    std::vector<std::vector<uint32>> readersSinceWrite(m_resources.size());
+
+    for (auto& pass : m_passes)
+    {
+        pass.culled = false;
+        pass.producers.clear();
+        pass.successors.clear();
+        pass.dependencyCount = 0;
+    }
+
+    auto addEdge = [this](uint32 from, uint32 to)
+    {
+        if (from == to)
+            return;
+        auto& successors = m_passes[from].successors;
+        if (std::find(successors.begin(), successors.end(), to) == successors.end())
+        {
+            successors.push_back(to);
+            ++m_passes[to].dependencyCount;
+        }
+    };
+
+    for (uint32 i = 0; i < (uint32)m_passes.size(); ++i)
+    {
+        PassNode& pass = m_passes[i];
+        for (auto& read : pass.reads)
+        {
+            uint32 writer = lastWriter[read.resource];
+            if (writer != InvalidIndex && writer != i)
+            {
+                addEdge(writer, i);
+                pass.producers.push_back(writer);
+            }
+        }
+        for (auto& write : pass.writes)
+        {
+            for (uint32 reader : readersSinceWrite[write.resource])
+                addEdge(reader, i);
+            if (lastWriter[write.resource] != InvalidIndex)
+                addEdge(lastWriter[write.resource], i);
+        }
+
+        for (auto& read : pass.reads)
+            readersSinceWrite[read.resource].push_back(i);
+        for (auto& write : pass.writes)
+        {
+            lastWriter[write.resource] = i;
+            readersSinceWrite[write.resource].clear();
+        }
+    }
+}
+
+void RenderGraph::CullPasses()
+{
+    // 从有副作用的pass开始，沿着读取关系向前标记需要的pass
+    std::vector<bool> needed(m_passes.size(), false);
+    std::vector<uint32> stack;
+    for (uint32 i = 0; i < (uint32)m_passes.size(); ++i)
+    {
+        if (m_passes[i].hasSideEffect)
+        {
+            needed[i] = true;
+            stack.push_back(i);
+        }
+    }
+
+    while (!stack.empty())
+    {
+        uint32 passIndex = stack.back();
+        stack.pop_back();
+        for (uint32 producer : m_passes[passIndex].producers)
+        {
+            if (!needed[producer])
+            {
+                needed[producer] = true;
+                stack.push_back(producer);
+            }
+        }
+    }
+
+    for (uint32 i = 0; i < (uint32)m_passes.size(); ++i)
+    {
+        m_passes[i].culled = !needed[i];
+        if (m_passes[i].culled)
+            ++m_stats.culledPassCount;
+    }
+}
+
+void RenderGraph::SortPasses(std::vector<uint32>& order)
+{
+    // Kahn算法，只考虑没有被剔除的pass，没有依赖关系的pass按声明的顺序
+    std::vector<uint32> dependencyCount(m_passes.size(), 0);
+    for (uint32 i = 0; i < (uint32)m_passes.size(); ++i)
+    {
+        if (m_passes[i].culled)
+            continue;
+        for (uint32 successor : m_passes[i].successors)
+            ++dependencyCount[successor];
+    }
+
+    std::priority_queue<uint32, std::vector<uint32>, std::greater<uint32>> ready;
+    for (uint32 i = 0; i < (uint32)m_passes.size(); ++i)
+    {
+        if (!m_passes[i].culled && dependencyCount[i] == 0)
+            ready.push(i);
+    }
+
+    order.clear();
+    while (!ready.empty())
+    {
+        uint32 passIndex = ready.top();
+        ready.pop();
+        order.push_back(passIndex);
+        for (uint32 successor : m_passes[passIndex].successors)
+        {
+            if (!m_passes[successor].culled && --dependencyCount[successor] == 0)
+                ready.push(successor);
+        }
+    }
+}
+
+void RenderGraph::AllocateTransients()
+{
+    for (auto& resource : m_resources)
+    {
+        resource.firstUse = InvalidIndex;
+        resource.lastUse = InvalidIndex;
+        resource.offset = InvalidOffset;
+        if (!resource.imported)
+            resource.initialState = 0;
+    }
+
+    // 生命周期为第一次和最后一次使用它的pass在编译后的顺序
+    for (uint32 i = 0; i < (uint32)m_compiledPasses.size(); ++i)
+    {
+        const PassNode& pass = m_passes[m_compiledPasses[i].passIndex];
+        auto use = [this, i](const Access& access)
+        {
+            ResourceNode& resource = m_resources[access.resource];
+            if (resource.firstUse == InvalidIndex)
+            {
+                resource.firstUse = i;
+                if (!resource.imported)
+                    resource.initialState = access.state;
+            }
+            resource.lastUse = i;
+        };
+        for (auto& read : pass.reads)
+            use(read);
+        for (auto& write : pass.writes)
+            use(write);
+    }
+
+    std::vector<ResourceHandle> transients;
+    for (ResourceHandle i = 0; i < (ResourceHandle)m_resources.size(); ++i)
+    {
+        const ResourceNode& resource = m_resources[i];
+        if (!resource.imported && resource.firstUse != InvalidIndex)
+        {
+            transients.push_back(i);
+            m_stats.memoryWithoutAliasing += AlignUp(resource.size, resource.alignment);
+        }
+    }
+    m_stats.transientCount = (uint32)transients.size();
+
+    // 从大到小依次放置，每个resource放在与它生命周期重叠的resource之间最低的空隙中
+    std::sort(transients.begin(), transients.end(), [this](ResourceHandle a, ResourceHandle b)
+    {
+        if (m_resources[a].size != m_resources[b].size)
+            return m_resources[a].size > m_resources[b].size;
+        return m_resources[a].firstUse < m_resources[b].firstUse;
+    });
+
+    std::vector<ResourceHandle> placed;
+    std::vector<std::pair<uint64, uint64>> occupied;
+    for (ResourceHandle handle : transients)
+    {
+        ResourceNode& resource = m_resources[handle];
+
+        occupied.clear();
+        for (ResourceHandle other : placed)
+        {
+            const ResourceNode& o = m_resources[other];
+            if (o.firstUse <= resource.lastUse && resource.firstUse <= o.lastUse)
+                occupied.push_back({ o.offset, o.offset + o.size });
+        }
+        std::sort(occupied.begin(), occupied.end());
+
+        uint64 offset = 0;
+        for (auto& range : occupied)
+        {
+            if (AlignUp(offset, resource.alignment) + resource.size <= range.first)
+                break;
+            offset = std::max(offset, range.second);
+        }
+        resource.offset = AlignUp(offset, resource.alignment);
+        m_stats.memoryWithAliasing = std::max(m_stats.memoryWithAliasing, resource.offset + resource.size);
+        placed.push_back(handle);
+    }
+
+    // 开始使用时，如果内存之前被别的resource用过，需要aliasing barrier
+    for (ResourceHandle handle : transients)
+    {
+        const ResourceNode& resource = m_resources[handle];
+        for (ResourceHandle other : transients)
+        {
+            const ResourceNode& o = m_resources[other];
+            if (other != handle && o.lastUse < resource.firstUse &&
+                o.offset < resource.offset + resource.size && resource.offset < o.offset + o.size)
+            {
+                m_compiledPasses[resource.firstUse].aliasingBarriers.push_back(handle);
+                ++m_stats.aliasingBarrierCount;
+                break;
+            }
+        }
+    }
+}
+
+void RenderGraph::BuildBarriers()
+{
+    ResourceStateTracker<ResourceHandle> tracker;
+    std::vector<Barrier> barriers;
+
+    // 先设置每个resource的起始状态，临时resource以第一次使用的状态创建
+    for (ResourceHandle i = 0; i < (ResourceHandle)m_resources.size(); ++i)
+    {
+        if (m_resources[i].firstUse != InvalidIndex)
+            tracker.Transition(i, m_resources[i].initialState);
+    }
+    tracker.FlushBarriers(barriers);
+
+    for (auto& compiledPass : m_compiledPasses)
+    {
+        const PassNode& pass = m_passes[compiledPass.passIndex];
+        for (auto& read : pass.reads)
+            tracker.Transition(read.resource, read.state);
+        for (auto& write : pass.writes)
+            tracker.Transition(write.resource, write.state);
+        tracker.FlushBarriers(compiledPass.barriers);
+        m_stats.barrierCount += (uint32)compiledPass.barriers.size();
+    }
+
+    for (ResourceHandle i = 0; i < (ResourceHandle)m_resources.size(); ++i)
+    {
+        const ResourceNode& resource = m_resources[i];
+        if (resource.imported && resource.firstUse != InvalidIndex && resource.finalState != KeepState)
+            tracker.Transition(i, resource.finalState);
+    }
+    tracker.FlushBarriers(m_finalBarriers);
+    m_stats.barrierCount += (uint32)m_finalBarriers.size();
+}
+
+void RenderGraph::Execute(const std::function<void(const std::vector<ResourceHandle>& aliasingBarriers, const std::vector<Barrier>& barriers)>& recordBarriers)const
+{
+    static const std::vector<ResourceHandle> noAliasing;
+
+    for (auto& compiledPass : m_compiledPasses)
+    {
+        recordBarriers(compiledPass.aliasingBarriers, compiledPass.barriers);
+        const PassNode& pass = m_passes[compiledPass.passIndex];
+        if (pass.execute)
+            pass.execute();
+    }
+    recordBarriers(noAliasing, m_finalBarriers);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "ResourceStateTracker.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// 渲染图：每个pass声明读写哪些resource，Compile时
+// 1. 剔除输出没有被使用的pass（写外部resource或标记了SetSideEffect的pass一定保留）
+// 2. 按依赖关系拓扑排序
+// 3. 计算每个pass之前需要的barrier（复用ResourceStateTracker）
+// 4. 根据生命周期给临时resource分配heap中的偏移，生命周期不重叠的resource共用同一段内存
+// Compile只在CPU上计算，不依赖图形API，resource的大小由调用者提供（例如来自GetResourceAllocationInfo）。
+class RenderGraph
+{
+public:
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+    using State = std::uint32_t;                // 与D3D12_RESOURCE_STATES的值一致
+    using ResourceHandle = std::uint32_t;
+    using Barrier = ResourceStateTracker<ResourceHandle>::Barrier;
+
+    static const uint32 InvalidIndex = 0xffffffff;
+    static const uint64 InvalidOffset = ~0ull;
+    // ImportResource的finalState，保持最后一个pass的状态。不能用0，0是D3D12_RESOURCE_STATE_PRESENT/COMMON
+    static const State KeepState = ~0u;
+
+    struct CompiledPass
+    {
+        uint32 passIndex = 0;
+        std::vector<ResourceHandle> aliasingBarriers;   // 在这个pass中开始使用、与之前的resource共用内存的临时resource
+        std::vector<Barrier> barriers;                  // 在这个pass之前需要的状态转换
+    };
+
+    struct Stats
+    {
+        uint32 passCount = 0;
+        uint32 culledPassCount = 0;
+        uint32 transientCount = 0;                      // 被使用的临时resource数量
+        uint32 barrierCount = 0;
+        uint32 aliasingBarrierCount = 0;
+        uint64 memoryWithoutAliasing = 0;               // 每个临时resource单独分配需要的内存
+        uint64 memoryWithAliasing = 0;                  // 共用内存后heap的大小
+
+        uint64 MemorySaved()const { return memoryWithoutAliasing - memoryWithAliasing; }
+    };
+
+    // 临时resource，只在这一帧的pass之间使用，内存由渲染图分配
+    ResourceHandle CreateTransient(const std::string& name, uint64 size, uint64 alignment = 65536);
+    // 外部resource（例如back buffer），不参与内存分配，finalState为KeepState时保持最后一个pass的状态
+    ResourceHandle ImportResource(const std::string& name, State initialState, State finalState = KeepState);
+
+    uint32 AddPass(const std::string& name, std::function<void()> execute = nullptr);
+    // 同一个pass对同一个resource先处理读再处理写，读写状态不同时以写的状态为准
+    void Read(uint32 pass, ResourceHandle resource, State state);
+    void Write(uint32 pass, ResourceHandle resource, State state);
+    // 没有输出被使用也不会剔除，例如写GPU查询结果的pass
+    void SetSideEffect(uint32 pass);
+
+    void Compile();
+
+    // 按编译后的顺序执行，每个pass执行前先调用recordBarriers记录barrier，最后一次调用记录转换到finalState的barrier
+    void Execute(const std::function<void(const std::vector<ResourceHandle>& aliasingBarriers, const std::vector<Barrier>& barriers)>& recordBarriers)const;
+
+    const std::vector<CompiledPass>& GetCompiledPasses()const { return m_compiledPasses; }
+    const std::vector<Barrier>& GetFinalBarriers()const { return m_finalBarriers; }
+    bool IsPassCulled(uint32 pass)const { return m_passes[pass].culled; }
+    // 临时resource在heap中的偏移，没有被使用时返回InvalidOffset
+    uint64 GetTransientOffset(ResourceHandle resource)const { return m_resources[resource].offset; }
+    // 临时resource第一次被使用时的状态，创建placed resource时作为初始状态
+    State GetTransientInitialState(ResourceHandle resource)const { return m_resources[resource].initialState; }
+    uint64 GetTransientHeapSize()const { return m_stats.memoryWithAliasing; }
+    const std::string& GetResourceName(ResourceHandle resource)const { return m_resources[resource].name; }
+    const std::string& GetPassName(uint32 pass)const { return m_passes[pass].name; }
+    const Stats& GetStats()const { return m_stats; }
+
+private:
+    struct Access
+    {
+        ResourceHandle resource;
+        State state;
+    };
+
+    struct ResourceNode
+    {
+        std::string name;
+        bool imported = false;
+        uint64 size = 0;
+        uint64 alignment = 0;
+        State initialState = 0;
+        State finalState = KeepState;
+
+        // Compile的结果，firstUse和lastUse为编译后pass的顺序
+        uint32 firstUse = InvalidIndex;
+        uint32 lastUse = InvalidIndex;
+        uint64 offset = InvalidOffset;
+    };
+
+    struct PassNode
+    {
+        std::string name;
+        std::function<void()> execute;
+        std::vector<Access> reads;
+        std::vector<Access> writes;
+        bool hasSideEffect = false;
+
+        // Compile的结果
+        bool culled = false;
+        std::vector<uint32> producers;      // 写入这个pass读取的resource的pass
+        std::vector<uint32> successors;     // 必须在这个pass之后执行的pass
+        uint32 dependencyCount = 0;
+    };
+
+    void BuildDependencies();
+    void CullPasses();
+    void SortPasses(std::vector<uint32>& order);
+    void AllocateTransients();
+    void BuildBarriers();
+
+    std::vector<ResourceNode> m_resources;
+    std::vector<PassNode> m_passes;
+
+    std::vector<CompiledPass> m_compiledPasses;
+    std::vector<Barrier> m_finalBarriers;
+    Stats m_stats;
+};
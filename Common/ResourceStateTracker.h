@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 自动记录resource状态并生成barrier，TResource可以是ID3D12Resource*，也可以是测试用的整数等假的handle。
+// 状态用32位的标志位表示，与D3D12_RESOURCE_STATES的值一致，但这里不依赖D3D12的头文件。
+// 只跟踪整个resource的状态，不区分subresource。
+
+// 所有command list共用的resource状态，即已提交的command list执行完后各resource所处的状态
+template<typename TResource>
+class ResourceStateRegistry
+{
+public:
+    using State = std::uint32_t;
+
+    void Register(TResource resource, State state) { m_states[resource] = state; }
+    void Unregister(TResource resource) { m_states.erase(resource); }
+    void SetState(TResource resource, State state) { m_states[resource] = state; }
+
+    bool GetState(TResource resource, State& state)const
+    {
+        auto it = m_states.find(resource);
+        if (it == m_states.end())
+            return false;
+        state = it->second;
+        return true;
+    }
+
+private:
+    std::unordered_map<TResource, State> m_states;
+};
+
+// 记录一个command list中每个resource的状态。
+// Transition请求的目标状态与当前状态相同或已包含在当前的只读状态中时直接丢弃；
+// 同一个resource在两次FlushBarriers之间的多次请求合并为一个barrier，合并后前后状态相同则整个丢弃。
+// 第一次在这个command list中使用的resource，其初始状态要等到提交时（其他command list都已记录完）才能确定，
+// 这部分barrier由ResolvePendingBarriers生成，记录在主command list之前执行的command list中。
+template<typename TResource>
+class ResourceStateTracker
+{
+public:
+    using State = std::uint32_t;
+
+    struct Barrier
+    {
+        TResource resource;
+        State before;
+        State after;
+    };
+
+    struct Stats
+    {
+        std::uint64_t requestCount = 0;     // Transition调用次数
+        std::uint64_t droppedCount = 0;     // 冗余而丢弃的请求
+        std::uint64_t mergedCount = 0;      // 与未提交的barrier合并的请求
+        std::uint64_t barrierCount = 0;     // 最终生成的barrier数量（包含提交时补上的）
+        std::uint64_t batchCount = 0;       // 生成的barrier批次，即ResourceBarrier的调用次数
+    };
+
+    // readOnlyStates为只读状态的标志位集合，例如D3D12_RESOURCE_STATE_GENERIC_READ
+    explicit ResourceStateTracker(State readOnlyStates = 0) : m_readOnlyStates(readOnlyStates) {}
+
+    // 开始记录新的command list
+    void Reset()
+    {
+        m_states.clear();
+        m_pendingBarriers.clear();
+        m_pendingIndices.clear();
+        m_unresolved.clear();
+    }
+
+    // 已知resource在这个command list开始执行时的状态，例如只有这一个command list使用它时，
+    // 之后的barrier直接记录在command list中，不需要提交时再补。要在这个resource第一次Transition之前调用
+    void SetInitialState(TResource resource, State state)
+    {
+        m_states[resource] = state;
+    }
+
+    void Transition(TResource resource, State after)
+    {
+        ++m_stats.requestCount;
+
+        auto it = m_states.find(resource);
+        if (it == m_states.end())
+        {
+            // 初始状态未知，提交时再处理
+            m_states[resource] = after;
+            m_unresolved.push_back({ resource, after, after });
+            return;
+        }
+
+        State current = it->second;
+        if (IsRedundant(current, after))
+        {
+            ++m_stats.droppedCount;
+            return;
+        }
+        it->second = after;
+
+        auto pending = m_pendingIndices.find(resource);
+        if (pending != m_pendingIndices.end())
+        {
+            // 还没有记录到command list中，直接修改原来的barrier
+            ++m_stats.mergedCount;
+            m_pendingBarriers[pending->second].after = after;
+            return;
+        }
+
+        m_pendingIndices[resource] = m_pendingBarriers.size();
+        m_pendingBarriers.push_back({ resource, current, after });
+    }
+
+    // 取出目前积累的barrier，调用者用一次ResourceBarrier记录它们
+    void FlushBarriers(std::vector<Barrier>& barriers)
+    {
+        barriers.clear();
+        for (auto& barrier : m_pendingBarriers)
+        {
+            // 合并后前后状态相同的barrier不需要了
+            if (barrier.before != barrier.after)
+                barriers.push_back(barrier);
+        }
+        m_pendingBarriers.clear();
+        m_pendingIndices.clear();
+
+        if (!barriers.empty())
+        {
+            m_stats.barrierCount += barriers.size();
+            ++m_stats.batchCount;
+        }
+    }
+
+    // 提交前调用，根据registry中的状态生成初始状态未知的resource需要的barrier，
+    // 然后把这个command list结束时各resource的状态写回registry。不在registry中的resource认为已经处于需要的状态
+    void ResolvePendingBarriers(ResourceStateRegistry<TResource>& registry, std::vector<Barrier>& barriers)
+    {
+        barriers.clear();
+        for (auto& unresolved : m_unresolved)
+        {
+            State before;
+            // 这里必须完全一致，之后记录的barrier都以unresolved.after为起始状态
+            if (registry.GetState(unresolved.resource, before) && before != unresolved.after)
+                barriers.push_back({ unresolved.resource, before, unresolved.after });
+        }
+        m_unresolved.clear();
+
+        for (auto& e : m_states)
+            registry.SetState(e.first, e.second);
+
+        if (!barriers.empty())
+        {
+            m_stats.barrierCount += barriers.size();
+            ++m_stats.batchCount;
+        }
+    }
+
+    // resource在这个command list中当前的状态，还没有使用过时返回false
+    bool GetState(TResource resource, State& state)const
+    {
+        auto it = m_states.find(resource);
+        if (it == m_states.end())
+            return false;
+        state = it->second;
+        return true;
+    }
+
+    const Stats& GetStats()const { return m_stats; }
+
+private:
+    bool IsRedundant(State current, State after)const
+    {
+        if (current == after)
+            return true;
+        // 当前是只读状态的组合，并且已经包含了需要的状态
+        return after != 0 && (current & ~m_readOnlyStates) == 0 && (current & after) == after;
+    }
+
+    State m_readOnlyStates;
+    std::unordered_map<TResource, State> m_states;                  // 这个command list中各resource的当前状态
+    std::vector<Barrier> m_pendingBarriers;                         // 还没有Flush的barrier
+    std::unordered_map<TResource, std::size_t> m_pendingIndices;    // resource在m_pendingBarriers中的位置
+    std::vector<Barrier> m_unresolved;                              // 初始状态未知的resource及第一次需要的状态
+    Stats m_stats;
+};
@@ -0,0 +1,180 @@
+#include "ShaderArchive.h"
+#include "HashUtil.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace
+{
+    const std::size_t BlobAlignment = 16;
+
+    bool EntryLess(const ShaderArchiveEntry& a, const ShaderArchiveEntry& b)
+    {
+        return a.key != b.key ? a.key < b.key : a.stage < b.stage;
+    }
+}
+
+void ShaderArchiveWriter::Add(uint64 key, ShaderStage stage, const void* data, std::size_t size)
+{
+    const char* bytes = static_cast<const char*>(data);
+    uint64 hash = Hasher64::Hash(data, size);
+
+    uint32 blobIndex = 0xffffffff;
+    auto& candidates = m_blobsByHash[hash];
+    for (uint32 index : candidates)
+    {
+        const std::vector<char>& blob = m_blobs[index];
+        if (blob.size() == size && std::equal(blob.begin(), blob.end(), bytes))
+        {
+            blobIndex = index;
+            break;
+        }
+    }
+    if (blobIndex == 0xffffffff)
+    {
+        blobIndex = (uint32)m_blobs.size();
+        m_blobs.emplace_back(bytes, bytes + size);
+        candidates.push_back(blobIndex);
+    }
+
+    // 同一个(key, stage)再次添加时覆盖之前的
+    for (auto& entry : m_entries)
+    {
+        if (entry.key == key && entry.stage == (uint32)stage)
+        {
+            entry.blobIndex = blobIndex;
+            return;
+        }
+    }
+    m_entries.push_back({ key, (uint32)stage, blobIndex });
+}
+
+bool ShaderArchiveWriter::Write(std::ostream& out)const
+{
+    ShaderArchiveHeader header = {};
+    header.magic = ShaderArchive::Magic;
+    header.version = ShaderArchive::Version;
+    header.entryCount = (uint32)m_entries.size();
+
+    // 每个blob对齐到BlobAlignment，依次放在Entry数组之后
+    std::vector<uint64> blobOffsets(m_blobs.size());
+    uint64 offset = sizeof(ShaderArchiveHeader) + sizeof(ShaderArchiveEntry) * m_entries.size();
+    for (std::size_t i = 0; i < m_blobs.size(); ++i)
+    {
+        offset = (offset + BlobAlignment - 1) & ~(uint64)(BlobAlignment - 1);
+        blobOffsets[i] = offset;
+        offset += m_blobs[i].size();
+    }
+
+    std::vector<ShaderArchiveEntry> entries;
+    for (auto& entry : m_entries)
+    {
+        const std::vector<char>& blob = m_blobs[entry.blobIndex];
+        entries.push_back({ entry.key, entry.stage, (uint32)blob.size(), blobOffsets[entry.blobIndex] });
+    }
+    std::sort(entries.begin(), entries.end(), EntryLess);
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), sizeof(ShaderArchiveEntry) * entries.size());
+
+    uint64 position = sizeof(ShaderArchiveHeader) + sizeof(ShaderArchiveEntry) * entries.size();
+    const char padding[BlobAlignment] = {};
+    for (std::size_t i = 0; i < m_blobs.size(); ++i)
+    {
+        out.write(padding, (std::streamsize)(blobOffsets[i] - position));
+        out.write(m_blobs[i].data(), m_blobs[i].size());
+        position = blobOffsets[i] + m_blobs[i].size();
+    }
+    return (bool)out;
+}
+
+std::uint64_t HashShaderName(const std::string& name)
+{
+    return Hasher64::Hash(name.data(), name.size());
+}
+
+bool ShaderArchive::Load(std::istream& in)
+{
+    Close();
+    m_buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    if (Attach(m_buffer.data(), m_buffer.size()))
+        return true;
+    Close();
+    return false;
+}
+
+bool ShaderArchive::Open(const std::string& path)
+{
+    Close();
+    if (m_file.Open(path) && Attach((const char*)m_file.GetData(), m_file.GetSize()))
+        return true;
+    Close();
+    return false;
+}
+
+#ifdef _WIN32
+bool ShaderArchive::Open(const std::wstring& path)
+{
+    Close();
+    if (m_file.Open(path) && Attach((const char*)m_file.GetData(), m_file.GetSize()))
+        return true;
+    Close();
+    return false;
+}
+#endif
+
+void ShaderArchive::Close()
+{
+    m_file.Close();
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_data = nullptr;
+    m_size = 0;
+    m_entries = nullptr;
+    m_entryCount = 0;
+}
+
+bool ShaderArchive::Attach(const char* data, std::size_t size)
+{
+    ShaderArchiveHeader header;
+    if (size < sizeof(header))
+        return false;
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != Magic || header.version != Version)
+        return false;
+
+    std::size_t entriesSize = sizeof(ShaderArchiveEntry) * (std::size_t)header.entryCount;
+    if (size - sizeof(header) < entriesSize)
+        return false;
+
+    // 文件映射的起始地址按页对齐，vector的数据按new的对齐，Entry数组紧跟在16字节的Header之后，可以直接使用
+    const ShaderArchiveEntry* entries = reinterpret_cast<const ShaderArchiveEntry*>(data + sizeof(header));
+    for (uint32 i = 0; i < header.entryCount; ++i)
+    {
+        const ShaderArchiveEntry& entry = entries[i];
+        bool sorted = i == 0 || EntryLess(entries[i - 1], entry);
+        if (!sorted || entry.offset > size || entry.size > size - entry.offset)
+            return false;
+    }
+
+    m_data = data;
+    m_size = size;
+    m_entries = entries;
+    m_entryCount = header.entryCount;
+    return true;
+}
+
+bool ShaderArchive::Find(uint64 key, ShaderStage stage, Bytecode& bytecode)const
+{
+    ShaderArchiveEntry value = {};
+    value.key = key;
+    value.stage = (uint32)stage;
+    const ShaderArchiveEntry* end = m_entries + m_entryCount;
+    const ShaderArchiveEntry* it = std::lower_bound(m_entries, end, value, EntryLess);
+    if (it == end || it->key != key || it->stage != (uint32)stage)
+        return false;
+
+    bytecode.data = m_data + it->offset;
+    bytecode.size = it->size;
+    return true;
+}
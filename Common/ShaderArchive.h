@@ -0,0 +1,114 @@
+#pragma once
+
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 把多个编译好的shader打包到一个文件中，每个shader以(key, stage)为索引，key一般为宏定义的哈希（见ShaderPermutation.h）。
+// 文件格式：Header，按(key, stage)排序的Entry数组，然后是各个bytecode。不依赖图形API。
+enum class ShaderStage : std::uint32_t
+{
+    Vertex,
+    Pixel,
+    Geometry,
+    Hull,
+    Domain,
+    Compute,
+};
+
+// 按名字打包的shader（例如shaders_vs.cso）以名字的哈希为key
+std::uint64_t HashShaderName(const std::string& name);
+
+struct ShaderArchiveHeader
+{
+    std::uint32_t magic;            // ShaderArchive::Magic
+    std::uint32_t version;
+    std::uint32_t entryCount;
+    std::uint32_t reserved;
+};
+
+struct ShaderArchiveEntry
+{
+    std::uint64_t key;
+    std::uint32_t stage;
+    std::uint32_t size;             // bytecode的字节数
+    std::uint64_t offset;           // bytecode在文件中的位置
+};
+
+class ShaderArchiveWriter
+{
+public:
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    // 内容完全相同的bytecode只保存一份，例如不受光源数量影响的vertex shader
+    void Add(uint64 key, ShaderStage stage, const void* data, std::size_t size);
+    bool Write(std::ostream& out)const;
+
+    std::size_t EntryCount()const { return m_entries.size(); }
+    std::size_t BlobCount()const { return m_blobs.size(); }
+
+private:
+    struct Entry
+    {
+        uint64 key;
+        uint32 stage;
+        uint32 blobIndex;
+    };
+
+    std::vector<Entry> m_entries;
+    std::vector<std::vector<char>> m_blobs;
+    std::unordered_map<uint64, std::vector<uint32>> m_blobsByHash;     // 内容的哈希 -> m_blobs中的下标
+};
+
+class ShaderArchive
+{
+public:
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    static const uint32 Magic = 0x4b415053;     // "SPAK"
+    static const uint32 Version = 1;
+
+    struct Bytecode
+    {
+        const void* data = nullptr;
+        std::size_t size = 0;
+    };
+
+    ShaderArchive() = default;
+    ShaderArchive(const ShaderArchive&) = delete;
+    ShaderArchive& operator=(const ShaderArchive&) = delete;
+
+    // 读取整个文件，格式错误时返回false
+    bool Load(std::istream& in);
+    // 把文件映射到内存中，Entry数组和bytecode都直接使用映射的数据，不复制。文件不存在或格式错误时返回false
+    bool Open(const std::string& path);
+#ifdef _WIN32
+    bool Open(const std::wstring& path);
+#endif
+    // 释放数据，之前Find得到的bytecode失效。映射的文件关闭后才能重新写入
+    void Close();
+
+    // 没有找到时返回false，bytecode指向archive内部的数据，archive销毁后失效
+    bool Find(uint64 key, ShaderStage stage, Bytecode& bytecode)const;
+    bool Contains(uint64 key, ShaderStage stage)const { Bytecode bytecode; return Find(key, stage, bytecode); }
+
+    std::size_t EntryCount()const { return m_entryCount; }
+
+private:
+    // 检查data中的Header和Entry数组，成功后m_entries指向data内部
+    bool Attach(const char* data, std::size_t size);
+
+    MappedFile m_file;
+    std::vector<char> m_buffer;                     // Load读取的数据，Open时为空
+    const char* m_data = nullptr;
+    std::size_t m_size = 0;
+    const ShaderArchiveEntry* m_entries = nullptr;
+    uint32 m_entryCount = 0;
+};
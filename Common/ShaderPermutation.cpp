@@ -0,0 +1,75 @@
+#include "ShaderPermutation.h"
+#include "HashUtil.h"
+#include <algorithm>
+#include <tuple>
+#include <utility>
+
+std::uint64_t HashShaderDefines(std::vector<ShaderDefine> defines)
+{
+    std::sort(defines.begin(), defines.end(), [](const ShaderDefine& a, const ShaderDefine& b) { return a.name < b.name; });
+
+    Hasher64 hasher;
+    for (auto& define : defines)
+        hasher.AddString(define.name).AddString(define.value);
+    return hasher.Result();
+}
+
+const char* const ShaderDebugFlags = "/Od /Zi";
+const char* const ShaderReleaseFlags = "/O3";
+
+std::uint64_t HashShaderPermutation(std::vector<ShaderDefine> defines, const std::string& target, const std::string& flags)
+{
+    Hasher64 hasher;
+    hasher.AddValue(HashShaderDefines(std::move(defines))).AddString(target).AddString(flags);
+    return hasher.Result();
+}
+
+LightPermutationSet::LightPermutationSet(const std::vector<uint32>& directLevels, const std::vector<uint32>& pointLevels,
+    const std::vector<uint32>& spotLevels, uint32 maxLightCount)
+{
+    for (uint32 directCount : directLevels)
+    {
+        for (uint32 pointCount : pointLevels)
+        {
+            for (uint32 spotCount : spotLevels)
+            {
+                LightCounts counts;
+                counts.directCount = directCount;
+                counts.pointCount = pointCount;
+                counts.spotCount = spotCount;
+                if (counts.Total() <= maxLightCount &&
+                    std::find(m_permutations.begin(), m_permutations.end(), counts) == m_permutations.end())
+                    m_permutations.push_back(counts);
+            }
+        }
+    }
+
+    // 总数相同时按平行光、点光源、聚光灯的数量排序，使选择的结果是确定的
+    std::sort(m_permutations.begin(), m_permutations.end(), [](const LightCounts& a, const LightCounts& b)
+    {
+        return std::make_tuple(a.Total(), a.directCount, a.pointCount, a.spotCount) <
+            std::make_tuple(b.Total(), b.directCount, b.pointCount, b.spotCount);
+    });
+}
+
+bool LightPermutationSet::SelectCovering(const LightCounts& active, LightCounts& selected)const
+{
+    for (auto& counts : m_permutations)
+    {
+        if (counts.Covers(active))
+        {
+            selected = counts;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<ShaderDefine> LightPermutationSet::GetDefines(const LightCounts& counts, const std::vector<ShaderDefine>& baseDefines)
+{
+    std::vector<ShaderDefine> defines = baseDefines;
+    defines.push_back({ "NUM_DIRECT_LIGHTS", std::to_string(counts.directCount) });
+    defines.push_back({ "NUM_POINT_LIGHTS", std::to_string(counts.pointCount) });
+    defines.push_back({ "NUM_SPOT_LIGHTS", std::to_string(counts.spotCount) });
+    return defines;
+}
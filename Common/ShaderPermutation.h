@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// shader的宏定义，编译时作为/D name=value
+struct ShaderDefine
+{
+    std::string name;
+    std::string value;
+};
+
+// 宏定义按名字排序后计算哈希，与定义的顺序无关
+std::uint64_t HashShaderDefines(std::vector<ShaderDefine> defines);
+
+// 离线编译时传给fxc的选项（见Util/ShaderBuilder），调试版本和优化版本
+extern const char* const ShaderDebugFlags;
+extern const char* const ShaderReleaseFlags;
+
+// 宏定义、target和编译选项一起计算哈希，作为ShaderArchive的key，不同选项编译的bytecode不会混用
+std::uint64_t HashShaderPermutation(std::vector<ShaderDefine> defines, const std::string& target, const std::string& flags);
+
+// 每种光源的数量，对应shader中的NUM_DIRECT_LIGHTS、NUM_POINT_LIGHTS、NUM_SPOT_LIGHTS。
+// 常量缓冲中的光源依次为平行光、点光源、聚光灯，每种光源的起始位置取决于所用的permutation
+struct LightCounts
+{
+    std::uint32_t directCount = 0;
+    std::uint32_t pointCount = 0;
+    std::uint32_t spotCount = 0;
+
+    std::uint32_t Total()const { return directCount + pointCount + spotCount; }
+    // 每种光源的数量都不少于other
+    bool Covers(const LightCounts& other)const
+    {
+        return directCount >= other.directCount && pointCount >= other.pointCount && spotCount >= other.spotCount;
+    }
+    bool operator==(const LightCounts& other)const
+    {
+        return directCount == other.directCount && pointCount == other.pointCount && spotCount == other.spotCount;
+    }
+
+    std::uint32_t PointLightStart()const { return directCount; }
+    std::uint32_t SpotLightStart()const { return directCount + pointCount; }
+};
+
+// 光源数量的所有组合，每种光源只取给定的几个数量，例如{0, 1, 2, 4}，总数超过maxLightCount的组合不使用。
+// 运行时选择能覆盖当前光源的组合中总数最少的，多出的光源强度为0
+class LightPermutationSet
+{
+public:
+    using uint32 = std::uint32_t;
+
+    LightPermutationSet(const std::vector<uint32>& directLevels, const std::vector<uint32>& pointLevels,
+        const std::vector<uint32>& spotLevels, uint32 maxLightCount);
+
+    // 按光源总数从少到多排列
+    const std::vector<LightCounts>& GetPermutations()const { return m_permutations; }
+
+    // 没有能覆盖active的组合时返回false
+    bool SelectCovering(const LightCounts& active, LightCounts& selected)const;
+
+    // baseDefines加上光源数量的宏定义
+    static std::vector<ShaderDefine> GetDefines(const LightCounts& counts, const std::vector<ShaderDefine>& baseDefines);
+
+private:
+    std::vector<LightCounts> m_permutations;
+};
@@ -0,0 +1,776 @@
+#include "ShaderReflection.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <tuple>
+
+namespace
+{
+    using uint8 = std::uint8_t;
+    using uint16 = std::uint16_t;
+    using uint32 = std::uint32_t;
+
+    const uint32 RdefChunk = MakeFourCC('R', 'D', 'E', 'F');
+    const uint32 RD11Magic = MakeFourCC('R', 'D', '1', '1');
+    const uint32 RD11Magic51 = 0x25441313;      // 5.1的shader中RD11的位置是这个值
+    const uint32 MaxTypeDepth = 32;             // 防止损坏的数据中struct互相引用导致死循环
+    const uint32 MaxTypeReads = 1 << 20;        // 嵌套的struct可能层层引用成员很多的类型，限制读取类型的总次数
+
+    // 带边界检查地读取一个chunk，偏移都相对于chunk内容的开头
+    class ChunkReader
+    {
+    public:
+        explicit ChunkReader(const DxbcChunk& chunk) : m_data(chunk.data), m_size(chunk.size) {}
+
+        uint32 GetSize()const { return m_size; }
+
+        // 每读取一个类型调用一次，超过MaxTypeReads后返回false
+        bool CountTypeRead()const
+        {
+            return ++m_typeReads <= MaxTypeReads;
+        }
+
+        bool Contains(uint32 offset, uint32 size)const
+        {
+            return offset <= m_size && size <= m_size - offset;
+        }
+
+        bool ReadUint32(uint32 offset, uint32& value)const
+        {
+            if (!Contains(offset, 4))
+                return false;
+            std::memcpy(&value, m_data + offset, 4);
+            return true;
+        }
+
+        bool ReadUint16(uint32 offset, uint16& value)const
+        {
+            if (!Contains(offset, 2))
+                return false;
+            std::memcpy(&value, m_data + offset, 2);
+            return true;
+        }
+
+        bool ReadUint8(uint32 offset, uint8& value)const
+        {
+            if (!Contains(offset, 1))
+                return false;
+            value = m_data[offset];
+            return true;
+        }
+
+        // 字符串必须在chunk内以0结尾，直接返回指向chunk的指针
+        bool ReadString(uint32 offset, const char*& value)const
+        {
+            if (offset >= m_size || std::memchr(m_data + offset, 0, m_size - offset) == nullptr)
+                return false;
+            value = (const char*)(m_data + offset);
+            return true;
+        }
+
+    private:
+        const uint8* m_data;
+        uint32 m_size;
+        mutable uint32 m_typeReads = 0;
+    };
+
+    // RDEF中各种描述的大小，5.0之前的shader没有RD11部分，使用旧的大小
+    struct RdefLayout
+    {
+        uint32 constantBufferSize = 24;
+        uint32 bindingSize = 32;
+        uint32 variableSize = 24;
+        uint32 typeSize = 16;
+        uint32 memberSize = 12;
+    };
+
+    struct TypeDesc
+    {
+        ShaderVariableClass variableClass;
+        uint16 type;
+        uint16 rows;
+        uint16 columns;
+        uint16 elements;
+        uint16 memberCount;
+        uint32 memberOffset;
+        const char* name;
+    };
+
+    bool ReadType(const ChunkReader& reader, const RdefLayout& layout, uint32 offset, TypeDesc& desc)
+    {
+        uint16 variableClass;
+        if (!reader.CountTypeRead() || !reader.Contains(offset, layout.typeSize) || !reader.ReadUint16(offset, variableClass) ||
+            !reader.ReadUint16(offset + 2, desc.type) || !reader.ReadUint16(offset + 4, desc.rows) ||
+            !reader.ReadUint16(offset + 6, desc.columns) || !reader.ReadUint16(offset + 8, desc.elements) ||
+            !reader.ReadUint16(offset + 10, desc.memberCount) || !reader.ReadUint32(offset + 12, desc.memberOffset))
+            return false;
+        desc.variableClass = (ShaderVariableClass)variableClass;
+
+        // 5.0的类型描述最后是类型名的偏移
+        desc.name = "";
+        uint32 nameOffset = 0;
+        if (layout.typeSize >= 36 && (!reader.ReadUint32(offset + 32, nameOffset) || (nameOffset != 0 && !reader.ReadString(nameOffset, desc.name))))
+            return false;
+        return true;
+    }
+
+    uint32 AlignUp16(uint32 size)
+    {
+        return (size + 15) & ~15u;
+    }
+
+    // 按cbuffer的打包规则计算一个元素的大小：矩阵除最后一行（列）外每行（列）占16字节，struct到最后一个成员的末尾
+    bool GetElementSize(const ChunkReader& reader, const RdefLayout& layout, const TypeDesc& desc, uint32 depth, uint32& size);
+
+    bool GetTypeSize(const ChunkReader& reader, const RdefLayout& layout, const TypeDesc& desc, uint32 depth, uint32& size, uint32& stride)
+    {
+        uint32 elementSize;
+        if (!GetElementSize(reader, layout, desc, depth, elementSize))
+            return false;
+        stride = AlignUp16(elementSize);
+        size = desc.elements > 1 ? (desc.elements - 1) * stride + elementSize : elementSize;
+        return true;
+    }
+
+    bool GetElementSize(const ChunkReader& reader, const RdefLayout& layout, const TypeDesc& desc, uint32 depth, uint32& size)
+    {
+        const uint16 DoubleType = 39;
+        uint32 componentSize = desc.type == DoubleType ? 8 : 4;
+        size = 0;
+        switch (desc.variableClass)
+        {
+        case ShaderVariableClass::Scalar:
+        case ShaderVariableClass::Vector:
+            size = desc.columns * componentSize;
+            return true;
+        case ShaderVariableClass::MatrixRows:
+            size = desc.rows == 0 ? 0 : (desc.rows - 1) * 16 + desc.columns * componentSize;
+            return true;
+        case ShaderVariableClass::MatrixColumns:
+            size = desc.columns == 0 ? 0 : (desc.columns - 1) * 16 + desc.rows * componentSize;
+            return true;
+        case ShaderVariableClass::Struct:
+            if (depth >= MaxTypeDepth)
+                return false;
+            for (uint32 i = 0; i < desc.memberCount; ++i)
+            {
+                uint32 memberOffset = desc.memberOffset + i * layout.memberSize;
+                uint32 typeOffset, offset;
+                TypeDesc memberType;
+                uint32 memberSize, memberStride;
+                if (!reader.ReadUint32(memberOffset + 4, typeOffset) || !reader.ReadUint32(memberOffset + 8, offset) ||
+                    !ReadType(reader, layout, typeOffset, memberType) ||
+                    !GetTypeSize(reader, layout, memberType, depth + 1, memberSize, memberStride))
+                    return false;
+                size = std::max(size, offset + memberSize);
+            }
+            return true;
+        default:
+            return true;
+        }
+    }
+
+    // 依次加入struct的成员，每个成员之后紧跟它自己的成员
+    bool AddMembers(const ChunkReader& reader, const RdefLayout& layout, const TypeDesc& desc, uint32 parent, uint32 baseOffset,
+        uint32 depth, std::vector<ShaderVariable>& variables)
+    {
+        if (depth >= MaxTypeDepth)
+            return false;
+        for (uint32 i = 0; i < desc.memberCount; ++i)
+        {
+            uint32 memberOffset = desc.memberOffset + i * layout.memberSize;
+            uint32 nameOffset, typeOffset, offset;
+            ShaderVariable member = {};
+            TypeDesc memberType;
+            if (!reader.ReadUint32(memberOffset, nameOffset) || !reader.ReadUint32(memberOffset + 4, typeOffset) ||
+                !reader.ReadUint32(memberOffset + 8, offset) || !reader.ReadString(nameOffset, member.name) ||
+                !ReadType(reader, layout, typeOffset, memberType) ||
+                !GetTypeSize(reader, layout, memberType, depth + 1, member.size, member.stride))
+                return false;
+
+            member.typeName = memberType.name;
+            member.parent = parent;
+            member.offset = baseOffset + offset;
+            member.variableClass = memberType.variableClass;
+            member.type = memberType.type;
+            member.rows = memberType.rows;
+            member.columns = memberType.columns;
+            member.elements = memberType.elements;
+            member.memberCount = memberType.memberCount;
+            variables.push_back(member);
+
+            if (memberType.variableClass == ShaderVariableClass::Struct &&
+                !AddMembers(reader, layout, memberType, (uint32)variables.size() - 1, member.offset, depth + 1, variables))
+                return false;
+        }
+        return true;
+    }
+
+    bool ReadResourceDefinition(const DxbcChunk& chunk, ShaderReflection& reflection, std::string& error)
+    {
+        ChunkReader reader(chunk);
+        uint32 constantBufferCount, constantBufferOffset, bindingCount, bindingOffset, flags, creatorOffset;
+        uint8 minorVersion, majorVersion;
+        uint16 programType;
+        if (!reader.ReadUint32(0, constantBufferCount) || !reader.ReadUint32(4, constantBufferOffset) ||
+            !reader.ReadUint32(8, bindingCount) || !reader.ReadUint32(12, bindingOffset) ||
+            !reader.ReadUint8(16, minorVersion) || !reader.ReadUint8(17, majorVersion) || !reader.ReadUint16(18, programType) ||
+            !reader.ReadUint32(20, flags) || !reader.ReadUint32(24, creatorOffset) || !reader.ReadString(creatorOffset, reflection.creator))
+        {
+            error = "RDEF: truncated header";
+            return false;
+        }
+
+        RdefLayout layout;
+        if (majorVersion >= 5)
+        {
+            uint32 magic;
+            if (!reader.ReadUint32(28, magic) || (magic != RD11Magic && magic != RD11Magic51) ||
+                !reader.ReadUint32(36, layout.constantBufferSize) || !reader.ReadUint32(40, layout.bindingSize) ||
+                !reader.ReadUint32(44, layout.variableSize) || !reader.ReadUint32(48, layout.typeSize) ||
+                !reader.ReadUint32(52, layout.memberSize) ||
+                layout.constantBufferSize < 24 || layout.bindingSize < 32 || layout.variableSize < 24 || layout.typeSize < 16 || layout.memberSize < 12)
+            {
+                error = "RDEF: invalid RD11 header";
+                return false;
+            }
+        }
+
+        if (reflection.programType == ShaderProgramType::Unknown)
+        {
+            switch (programType)
+            {
+            case 0xffff: reflection.programType = ShaderProgramType::Pixel; break;
+            case 0xfffe: reflection.programType = ShaderProgramType::Vertex; break;
+            case 0x4753: reflection.programType = ShaderProgramType::Geometry; break;
+            case 0x4853: reflection.programType = ShaderProgramType::Hull; break;
+            case 0x4453: reflection.programType = ShaderProgramType::Domain; break;
+            case 0x4353: reflection.programType = ShaderProgramType::Compute; break;
+            }
+            reflection.majorVersion = majorVersion;
+            reflection.minorVersion = minorVersion;
+        }
+
+        // 数量必须是chunk中放得下的，避免损坏的数据导致分配过多内存
+        if (bindingCount > reader.GetSize() / layout.bindingSize || constantBufferCount > reader.GetSize() / layout.constantBufferSize)
+        {
+            error = "RDEF: invalid count";
+            return false;
+        }
+
+        reflection.resources.resize(bindingCount);
+        for (uint32 i = 0; i < bindingCount; ++i)
+        {
+            uint32 offset = bindingOffset + i * layout.bindingSize;
+            ShaderResourceBinding& binding = reflection.resources[i];
+            uint32 nameOffset, type;
+            // 5.1的描述多了space和id
+            binding.space = 0;
+            if (!reader.Contains(offset, layout.bindingSize) || !reader.ReadUint32(offset, nameOffset) ||
+                !reader.ReadString(nameOffset, binding.name) || !reader.ReadUint32(offset + 4, type) ||
+                !reader.ReadUint32(offset + 8, binding.returnType) || !reader.ReadUint32(offset + 12, binding.dimension) ||
+                !reader.ReadUint32(offset + 16, binding.sampleCount) || !reader.ReadUint32(offset + 20, binding.bindPoint) ||
+                !reader.ReadUint32(offset + 24, binding.bindCount) || !reader.ReadUint32(offset + 28, binding.flags) ||
+                (layout.bindingSize >= 40 && !reader.ReadUint32(offset + 32, binding.space)))
+            {
+                error = "RDEF: invalid resource binding " + std::to_string(i);
+                return false;
+            }
+            binding.type = (ShaderInputType)type;
+        }
+
+        reflection.constantBuffers.resize(constantBufferCount);
+        for (uint32 i = 0; i < constantBufferCount; ++i)
+        {
+            uint32 offset = constantBufferOffset + i * layout.constantBufferSize;
+            ShaderConstantBuffer& constantBuffer = reflection.constantBuffers[i];
+            uint32 nameOffset, variableCount, variableOffset;
+            if (!reader.Contains(offset, layout.constantBufferSize) || !reader.ReadUint32(offset, nameOffset) ||
+                !reader.ReadString(nameOffset, constantBuffer.name) || !reader.ReadUint32(offset + 4, variableCount) ||
+                !reader.ReadUint32(offset + 8, variableOffset) || !reader.ReadUint32(offset + 12, constantBuffer.size) ||
+                !reader.ReadUint32(offset + 16, constantBuffer.flags) || !reader.ReadUint32(offset + 20, constantBuffer.type))
+            {
+                error = "RDEF: invalid constant buffer " + std::to_string(i);
+                return false;
+            }
+
+            for (uint32 j = 0; j < variableCount; ++j)
+            {
+                uint32 descOffset = variableOffset + j * layout.variableSize;
+                ShaderVariable variable = {};
+                uint32 typeOffset;
+                TypeDesc type;
+                uint32 elementSize;
+                if (!reader.Contains(descOffset, layout.variableSize) || !reader.ReadUint32(descOffset, nameOffset) ||
+                    !reader.ReadString(nameOffset, variable.name) || !reader.ReadUint32(descOffset + 4, variable.offset) ||
+                    !reader.ReadUint32(descOffset + 8, variable.size) || !reader.ReadUint32(descOffset + 12, variable.flags) ||
+                    !reader.ReadUint32(descOffset + 16, typeOffset) || !ReadType(reader, layout, typeOffset, type) ||
+                    !GetTypeSize(reader, layout, type, 0, elementSize, variable.stride))
+                {
+                    error = std::string("RDEF: invalid variable ") + std::to_string(j) + " in " + constantBuffer.name;
+                    return false;
+                }
+
+                variable.typeName = type.name;
+                variable.parent = ShaderVariable::NoParent;
+                variable.variableClass = type.variableClass;
+                variable.type = type.type;
+                variable.rows = type.rows;
+                variable.columns = type.columns;
+                variable.elements = type.elements;
+                variable.memberCount = type.memberCount;
+                constantBuffer.variables.push_back(variable);
+
+                if (type.variableClass == ShaderVariableClass::Struct &&
+                    !AddMembers(reader, layout, type, (uint32)constantBuffer.variables.size() - 1, variable.offset, 0, constantBuffer.variables))
+                {
+                    error = std::string("RDEF: invalid struct ") + variable.name + " in " + constantBuffer.name;
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // ISGN/OSGN每项24字节，ISG1/OSG1每项32字节，多了stream和minPrecision
+    bool ReadSignature(const DxbcChunk& chunk, bool extended, std::vector<ShaderSignatureElement>& elements, std::string& error)
+    {
+        ChunkReader reader(chunk);
+        uint32 count, elementOffset;
+        if (!reader.ReadUint32(0, count) || !reader.ReadUint32(4, elementOffset))
+        {
+            error = "signature: truncated header";
+            return false;
+        }
+
+        uint32 elementSize = extended ? 32 : 24;
+        if (count > reader.GetSize() / elementSize)
+        {
+            error = "signature: invalid count";
+            return false;
+        }
+        elements.resize(count);
+        for (uint32 i = 0; i < count; ++i)
+        {
+            uint32 offset = elementOffset + i * elementSize;
+            ShaderSignatureElement& element = elements[i];
+            element.stream = 0;
+            element.minPrecision = 0;
+            if (extended)
+            {
+                if (!reader.ReadUint32(offset, element.stream) || !reader.ReadUint32(offset + 28, element.minPrecision))
+                {
+                    error = "signature: invalid element " + std::to_string(i);
+                    return false;
+                }
+                offset += 4;
+            }
+
+            uint32 nameOffset;
+            if (!reader.ReadUint32(offset, nameOffset) || !reader.ReadString(nameOffset, element.semanticName) ||
+                !reader.ReadUint32(offset + 4, element.semanticIndex) || !reader.ReadUint32(offset + 8, element.systemValue) ||
+                !reader.ReadUint32(offset + 12, element.componentType) || !reader.ReadUint32(offset + 16, element.registerIndex) ||
+                !reader.ReadUint8(offset + 20, element.mask) || !reader.ReadUint8(offset + 21, element.readWriteMask))
+            {
+                error = "signature: invalid element " + std::to_string(i);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ReadSignature(const DxbcContainer& container, uint32 fourCC, uint32 extendedFourCC,
+        std::vector<ShaderSignatureElement>& elements, std::string& error)
+    {
+        if (const DxbcChunk* chunk = container.FindChunk(extendedFourCC))
+            return ReadSignature(*chunk, true, elements, error);
+        if (const DxbcChunk* chunk = container.FindChunk(fourCC))
+            return ReadSignature(*chunk, false, elements, error);
+        return true;
+    }
+
+    uint32 GetRegisterClass(ShaderInputType type)
+    {
+        switch (type)
+        {
+        case ShaderInputType::ConstantBuffer:
+            return 0;
+        case ShaderInputType::TextureBuffer:
+        case ShaderInputType::Texture:
+        case ShaderInputType::Structured:
+        case ShaderInputType::ByteAddress:
+            return 1;
+        case ShaderInputType::Sampler:
+            return 3;
+        default:
+            return 2;
+        }
+    }
+}
+
+bool DxbcContainer::Parse(const void* data, std::size_t size, std::string& error)
+{
+    m_data = (const uint8*)data;
+    m_size = 0;
+    m_chunks.clear();
+
+    uint32 magic, totalSize, chunkCount;
+    if (size < HeaderSize)
+    {
+        error = "container: too small";
+        return false;
+    }
+    std::memcpy(&magic, m_data, 4);
+    std::memcpy(&totalSize, m_data + 24, 4);
+    std::memcpy(&chunkCount, m_data + 28, 4);
+    if (magic != Magic)
+    {
+        error = "container: not a DXBC container";
+        return false;
+    }
+    if (totalSize > size || totalSize < HeaderSize || chunkCount > (totalSize - HeaderSize) / 4)
+    {
+        error = "container: invalid size";
+        return false;
+    }
+
+    m_size = totalSize;
+    m_chunks.resize(chunkCount);
+    for (uint32 i = 0; i < chunkCount; ++i)
+    {
+        uint32 offset;
+        std::memcpy(&offset, m_data + HeaderSize + i * 4, 4);
+        if (offset > m_size || m_size - offset < 8)
+        {
+            error = "container: chunk " + std::to_string(i) + " out of range";
+            return false;
+        }
+
+        DxbcChunk& chunk = m_chunks[i];
+        std::memcpy(&chunk.fourCC, m_data + offset, 4);
+        std::memcpy(&chunk.size, m_data + offset + 4, 4);
+        chunk.data = m_data + offset + 8;
+        if (chunk.size > m_size - offset - 8)
+        {
+            error = "container: chunk " + std::to_string(i) + " out of range";
+            return false;
+        }
+    }
+    return true;
+}
+
+namespace
+{
+    // MD5的一次变换，block为16个小端序的uint32
+    void Md5Transform(uint32 state[4], const uint32 block[16])
+    {
+        static const uint32 K[64] =
+        {
+            0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+            0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be, 0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+            0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+            0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+            0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c, 0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+            0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+            0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+            0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1, 0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+        };
+        static const uint32 Shift[16] = { 7, 12, 17, 22, 5, 9, 14, 20, 4, 11, 16, 23, 6, 10, 15, 21 };
+
+        uint32 a = state[0], b = state[1], c = state[2], d = state[3];
+        for (uint32 i = 0; i < 64; ++i)
+        {
+            uint32 round = i / 16;
+            uint32 f, g;
+            if (round == 0)
+            {
+                f = (b & c) | (~b & d);
+                g = i;
+            }
+            else if (round == 1)
+            {
+                f = (d & b) | (~d & c);
+                g = (5 * i + 1) % 16;
+            }
+            else if (round == 2)
+            {
+                f = b ^ c ^ d;
+                g = (3 * i + 5) % 16;
+            }
+            else
+            {
+                f = c ^ (b | ~d);
+                g = (7 * i) % 16;
+            }
+            uint32 shift = Shift[round * 4 + i % 4];
+            uint32 sum = a + f + K[i] + block[g];
+            a = d;
+            d = c;
+            c = b;
+            b += (sum << shift) | (sum >> (32 - shift));
+        }
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+    }
+
+    void ToBlock(const uint8* bytes, uint32 block[16])
+    {
+        for (uint32 i = 0; i < 16; ++i)
+            block[i] = (uint32)bytes[i * 4] | ((uint32)bytes[i * 4 + 1] << 8) | ((uint32)bytes[i * 4 + 2] << 16) | ((uint32)bytes[i * 4 + 3] << 24);
+    }
+}
+
+void ComputeDxbcChecksum(const void* data, std::size_t size, std::uint8_t checksum[DxbcContainer::ChecksumSize])
+{
+    const uint8* bytes = (const uint8*)data + 20;
+    uint32 length = (uint32)(size - 20);
+    uint32 bitCount = length * 8;
+    // 与标准MD5不同：长度放在最后一个block的第一个uint32，最后一个uint32为(bitCount >> 2) | 1
+    uint32 lastWord = (bitCount >> 2) | 1;
+
+    uint32 state[4] = { 0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476 };
+    uint32 block[16];
+    uint32 fullBlocks = length / 64;
+    for (uint32 i = 0; i < fullBlocks; ++i)
+    {
+        ToBlock(bytes + i * 64, block);
+        Md5Transform(state, block);
+    }
+
+    uint8 tail[64] = {};
+    uint32 remaining = length % 64;
+    const uint8* rest = bytes + fullBlocks * 64;
+    if (remaining >= 56)
+    {
+        // 剩余的数据放不下长度，先补0x80处理一个block，长度单独在下一个block中
+        std::memcpy(tail, rest, remaining);
+        tail[remaining] = 0x80;
+        ToBlock(tail, block);
+        Md5Transform(state, block);
+
+        std::memset(block, 0, sizeof(block));
+        block[0] = bitCount;
+        block[15] = lastWord;
+        Md5Transform(state, block);
+    }
+    else
+    {
+        std::memcpy(tail + 4, rest, remaining);
+        tail[4 + remaining] = 0x80;
+        ToBlock(tail, block);
+        block[0] = bitCount;
+        block[15] = lastWord;
+        Md5Transform(state, block);
+    }
+
+    for (uint32 i = 0; i < 4; ++i)
+    {
+        for (uint32 j = 0; j < 4; ++j)
+            checksum[i * 4 + j] = (uint8)(state[i] >> (j * 8));
+    }
+}
+
+void StripDxbcContainer(const DxbcContainer& container, std::vector<std::uint8_t>& stripped)
+{
+    const uint8* data = container.GetData();
+    if (container.IsDxil())
+    {
+        stripped.assign(data, data + container.GetSize());
+        return;
+    }
+
+    const uint32 removedChunks[] = { MakeFourCC('S', 'D', 'B', 'G'), MakeFourCC('S', 'P', 'D', 'B'), MakeFourCC('S', 'T', 'A', 'T') };
+    std::vector<const DxbcChunk*> kept;
+    for (auto& chunk : container.GetChunks())
+    {
+        if (std::find(std::begin(removedChunks), std::end(removedChunks), chunk.fourCC) == std::end(removedChunks))
+            kept.push_back(&chunk);
+    }
+
+    // 头部不变，偏移表变短，之后依次是保留的chunk（每个chunk的大小都是4的倍数，不需要额外对齐）
+    uint32 chunkCount = (uint32)kept.size();
+    uint32 totalSize = DxbcContainer::HeaderSize + chunkCount * 4;
+    for (const DxbcChunk* chunk : kept)
+        totalSize += 8 + ((chunk->size + 3) & ~3u);
+
+    stripped.assign(totalSize, 0);
+    std::memcpy(stripped.data(), data, DxbcContainer::HeaderSize);
+    std::memcpy(stripped.data() + 24, &totalSize, 4);
+    std::memcpy(stripped.data() + 28, &chunkCount, 4);
+
+    uint32 offset = DxbcContainer::HeaderSize + chunkCount * 4;
+    for (uint32 i = 0; i < chunkCount; ++i)
+    {
+        std::memcpy(stripped.data() + DxbcContainer::HeaderSize + i * 4, &offset, 4);
+        std::memcpy(stripped.data() + offset, kept[i]->data - 8, 8 + kept[i]->size);
+        offset += 8 + ((kept[i]->size + 3) & ~3u);
+    }
+
+    ComputeDxbcChecksum(stripped.data(), stripped.size(), stripped.data() + 4);
+}
+
+const DxbcChunk* DxbcContainer::FindChunk(uint32 fourCC)const
+{
+    for (auto& chunk : m_chunks)
+    {
+        if (chunk.fourCC == fourCC)
+            return &chunk;
+    }
+    return nullptr;
+}
+
+const ShaderVariable* ShaderConstantBuffer::FindVariable(const std::string& path)const
+{
+    uint32 parent = ShaderVariable::NoParent;
+    const ShaderVariable* found = nullptr;
+    std::size_t start = 0;
+    while (start <= path.size())
+    {
+        std::size_t end = std::min(path.find('.', start), path.size());
+        std::string name = path.substr(start, end - start);
+        found = nullptr;
+        for (std::size_t i = 0; i < variables.size(); ++i)
+        {
+            if (variables[i].parent == parent && name == variables[i].name)
+            {
+                found = &variables[i];
+                parent = (uint32)i;
+                break;
+            }
+        }
+        if (found == nullptr)
+            return nullptr;
+        start = end + 1;
+    }
+    return found;
+}
+
+const ShaderConstantBuffer* ShaderReflection::FindConstantBuffer(const std::string& name)const
+{
+    for (auto& constantBuffer : constantBuffers)
+    {
+        if (name == constantBuffer.name)
+            return &constantBuffer;
+    }
+    return nullptr;
+}
+
+const ShaderResourceBinding* ShaderReflection::FindResource(const std::string& name)const
+{
+    for (auto& resource : resources)
+    {
+        if (name == resource.name)
+            return &resource;
+    }
+    return nullptr;
+}
+
+bool ReflectShader(const DxbcContainer& container, ShaderReflection& reflection, std::string& error)
+{
+    reflection = ShaderReflection();
+
+    // SHDR/SHEX以及DXIL的第一个uint32都是版本：低4位minor，4~7位major，高16位是shader的类型
+    const uint32 programChunks[] = { MakeFourCC('S', 'H', 'E', 'X'), MakeFourCC('S', 'H', 'D', 'R'), MakeFourCC('D', 'X', 'I', 'L') };
+    for (uint32 fourCC : programChunks)
+    {
+        const DxbcChunk* chunk = container.FindChunk(fourCC);
+        uint32 version;
+        if (chunk != nullptr && ChunkReader(*chunk).ReadUint32(0, version))
+        {
+            uint32 programType = version >> 16;
+            if (programType <= (uint32)ShaderProgramType::Compute)
+                reflection.programType = (ShaderProgramType)programType;
+            reflection.majorVersion = (version >> 4) & 0xf;
+            reflection.minorVersion = version & 0xf;
+            break;
+        }
+    }
+
+    if (const DxbcChunk* chunk = container.FindChunk(RdefChunk))
+    {
+        if (!ReadResourceDefinition(*chunk, reflection, error))
+            return false;
+        reflection.hasResourceDefinition = true;
+    }
+
+    return ReadSignature(container, MakeFourCC('I', 'S', 'G', 'N'), MakeFourCC('I', 'S', 'G', '1'), reflection.inputs, error) &&
+        ReadSignature(container, MakeFourCC('O', 'S', 'G', 'N'), MakeFourCC('O', 'S', 'G', '1'), reflection.outputs, error);
+}
+
+bool ValidateLayout(const ShaderConstantBuffer& constantBuffer, const std::string& path,
+    const std::vector<CpuField>& fields, std::uint32_t cpuSize, std::vector<std::string>& errors)
+{
+    std::size_t errorCount = errors.size();
+    std::string prefix = std::string(constantBuffer.name) + ".";
+    uint32 parent = ShaderVariable::NoParent;
+    uint32 baseOffset = 0;
+    uint32 expectedSize = constantBuffer.size;
+    if (!path.empty())
+    {
+        const ShaderVariable* variable = constantBuffer.FindVariable(path);
+        if (variable == nullptr || variable->variableClass != ShaderVariableClass::Struct)
+        {
+            errors.push_back(prefix + path + ": not a struct in the shader");
+            return false;
+        }
+        prefix += path + ".";
+        parent = (uint32)(variable - constantBuffer.variables.data());
+        baseOffset = variable->offset;
+        expectedSize = variable->stride;
+    }
+
+    for (auto& variable : constantBuffer.variables)
+    {
+        if (variable.parent != parent)
+            continue;
+
+        auto field = std::find_if(fields.begin(), fields.end(), [&variable](const CpuField& f) { return std::strcmp(f.name, variable.name) == 0; });
+        uint32 offset = variable.offset - baseOffset;
+        if (field == fields.end())
+            errors.push_back(prefix + variable.name + ": missing in the C++ struct");
+        else if (field->offset != offset || field->size != variable.size)
+        {
+            errors.push_back(prefix + variable.name + ": C++ offset " + std::to_string(field->offset) + " size " + std::to_string(field->size) +
+                ", shader offset " + std::to_string(offset) + " size " + std::to_string(variable.size));
+        }
+    }
+
+    if (AlignUp16(cpuSize) != expectedSize)
+        errors.push_back(prefix + "size: C++ " + std::to_string(cpuSize) + ", shader " + std::to_string(expectedSize));
+    return errors.size() == errorCount;
+}
+
+bool BuildBindingTable(const std::vector<const ShaderReflection*>& stages, std::vector<ShaderBinding>& bindings, std::string& error)
+{
+    bindings.clear();
+    for (const ShaderReflection* stage : stages)
+    {
+        uint32 stageBit = stage->programType == ShaderProgramType::Unknown ? 0 : 1u << (uint32)stage->programType;
+        for (auto& resource : stage->resources)
+        {
+            auto same = std::find_if(bindings.begin(), bindings.end(), [&resource](const ShaderBinding& b)
+            {
+                return GetRegisterClass(b.type) == GetRegisterClass(resource.type) && b.space == resource.space && b.bindPoint == resource.bindPoint;
+            });
+            if (same == bindings.end())
+            {
+                bindings.push_back({ resource.name, resource.type, resource.bindPoint, resource.bindCount, resource.space, stageBit });
+                continue;
+            }
+            if (std::strcmp(same->name, resource.name) != 0 || same->type != resource.type || same->bindCount != resource.bindCount)
+            {
+                error = std::string("register conflict: ") + same->name + " and " + resource.name;
+                return false;
+            }
+            same->stageMask |= stageBit;
+        }
+    }
+
+    std::sort(bindings.begin(), bindings.end(), [](const ShaderBinding& a, const ShaderBinding& b)
+    {
+        return std::make_tuple(GetRegisterClass(a.type), a.space, a.bindPoint) < std::make_tuple(GetRegisterClass(b.type), b.space, b.bindPoint);
+    });
+    return true;
+}
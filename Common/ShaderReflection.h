@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 直接解析编译好的shader（.cso文件或D3DCompile的结果），不依赖d3dcompiler和Windows的头文件，
+// 离线工具在任意平台上都能使用。解析时不复制数据，结果中的名字和chunk都指向传入的bytecode，
+// bytecode必须在使用结果期间一直有效。
+
+constexpr std::uint32_t MakeFourCC(char a, char b, char c, char d)
+{
+    return (std::uint32_t)(std::uint8_t)a | ((std::uint32_t)(std::uint8_t)b << 8) |
+        ((std::uint32_t)(std::uint8_t)c << 16) | ((std::uint32_t)(std::uint8_t)d << 24);
+}
+
+struct DxbcChunk
+{
+    std::uint32_t fourCC;
+    const std::uint8_t* data;       // chunk的内容，不包括fourCC和大小
+    std::uint32_t size;
+};
+
+// fxc生成的DXBC和dxc生成的DXIL使用相同的容器格式：头部、chunk的偏移表，然后是各个chunk
+class DxbcContainer
+{
+public:
+    using uint8 = std::uint8_t;
+    using uint32 = std::uint32_t;
+
+    static const uint32 Magic = MakeFourCC('D', 'X', 'B', 'C');
+    static const uint32 HeaderSize = 32;
+    static const uint32 ChecksumSize = 16;
+
+    // 检查头部和每个chunk都在数据范围内，失败时error说明原因
+    bool Parse(const void* data, std::size_t size, std::string& error);
+
+    const std::vector<DxbcChunk>& GetChunks()const { return m_chunks; }
+    // 没有时返回nullptr
+    const DxbcChunk* FindChunk(uint32 fourCC)const;
+
+    // dxc编译的shader包含DXIL chunk，其中没有RDEF
+    bool IsDxil()const { return FindChunk(MakeFourCC('D', 'X', 'I', 'L')) != nullptr; }
+
+    const uint8* GetData()const { return m_data; }
+    uint32 GetSize()const { return m_size; }
+    const uint8* GetChecksum()const { return m_data + 4; }
+
+private:
+    const uint8* m_data = nullptr;
+    uint32 m_size = 0;
+    std::vector<DxbcChunk> m_chunks;
+};
+
+// 容器的校验和：从版本号（第20字节）开始到结尾计算的MD5，但填充方式与标准MD5不同。
+// 修改容器后必须重新计算，否则创建shader时D3D会认为数据损坏
+void ComputeDxbcChecksum(const void* data, std::size_t size, std::uint8_t checksum[DxbcContainer::ChecksumSize]);
+
+// 去掉调试信息（SDBG、SPDB）和编译统计（STAT）后重新组织容器并更新校验和，RDEF和输入输出签名保留，
+// 运行时仍然可以用ReflectShader检查布局。DXIL由验证器签名，不能在这里修改，原样复制（可以用dxc的-Qstrip_debug去掉）
+void StripDxbcContainer(const DxbcContainer& container, std::vector<std::uint8_t>& stripped);
+
+// 与D3D_SHADER_INPUT_TYPE的值相同
+enum class ShaderInputType : std::uint32_t
+{
+    ConstantBuffer = 0,
+    TextureBuffer = 1,
+    Texture = 2,
+    Sampler = 3,
+    RWTyped = 4,
+    Structured = 5,
+    RWStructured = 6,
+    ByteAddress = 7,
+    RWByteAddress = 8,
+    AppendStructured = 9,
+    ConsumeStructured = 10,
+    RWStructuredWithCounter = 11,
+};
+
+// 与D3D11_SHADER_VERSION_TYPE的值相同
+enum class ShaderProgramType : std::uint32_t
+{
+    Pixel = 0,
+    Vertex = 1,
+    Geometry = 2,
+    Hull = 3,
+    Domain = 4,
+    Compute = 5,
+    Unknown = 0xffffffff,
+};
+
+// 与D3D_SHADER_VARIABLE_CLASS的值相同
+enum class ShaderVariableClass : std::uint16_t
+{
+    Scalar = 0,
+    Vector = 1,
+    MatrixRows = 2,
+    MatrixColumns = 3,
+    Object = 4,
+    Struct = 5,
+};
+
+// cbuffer中的变量。struct类型的变量之后依次是它的成员（递归展开），成员的parent为struct变量的下标，
+// offset为数组第0个元素中的成员相对于cbuffer开头的偏移
+struct ShaderVariable
+{
+    static const std::uint32_t NoParent = 0xffffffff;
+
+    const char* name;
+    const char* typeName;               // 例如float4x4、Light，旧版本的RDEF中没有，为""
+    std::uint32_t parent;
+    std::uint32_t offset;
+    std::uint32_t size;                 // 整个变量（包括所有数组元素）占用的字节数
+    std::uint32_t flags;                // D3D_SHADER_VARIABLE_FLAGS，例如是否被shader使用
+    ShaderVariableClass variableClass;
+    std::uint16_t type;                 // D3D_SHADER_VARIABLE_TYPE，例如float为3
+    std::uint16_t rows;
+    std::uint16_t columns;
+    std::uint16_t elements;             // 不是数组时为0
+    std::uint16_t memberCount;
+    std::uint32_t stride;               // 数组中相邻元素的间隔，按16字节对齐
+};
+
+struct ShaderConstantBuffer
+{
+    const char* name;
+    std::uint32_t size;                 // 按16字节对齐
+    std::uint32_t flags;
+    std::uint32_t type;                 // D3D_CBUFFER_TYPE，0为cbuffer，1为tbuffer
+    std::vector<ShaderVariable> variables;
+
+    // path为变量名，成员用.连接，例如lights.strength，没有时返回nullptr
+    const ShaderVariable* FindVariable(const std::string& path)const;
+};
+
+struct ShaderResourceBinding
+{
+    const char* name;
+    ShaderInputType type;
+    std::uint32_t returnType;           // D3D_RESOURCE_RETURN_TYPE
+    std::uint32_t dimension;            // D3D_SRV_DIMENSION
+    std::uint32_t sampleCount;
+    std::uint32_t bindPoint;
+    std::uint32_t bindCount;            // 无界数组为0
+    std::uint32_t flags;
+    std::uint32_t space;                // 5.1之前的shader为0
+};
+
+// ISGN/OSGN/ISG1/OSG1中的一项
+struct ShaderSignatureElement
+{
+    const char* semanticName;
+    std::uint32_t semanticIndex;
+    std::uint32_t systemValue;          // D3D_NAME，例如SV_POSITION为1
+    std::uint32_t componentType;        // D3D_REGISTER_COMPONENT_TYPE
+    std::uint32_t registerIndex;
+    std::uint8_t mask;
+    std::uint8_t readWriteMask;
+    std::uint32_t stream;
+    std::uint32_t minPrecision;
+};
+
+struct ShaderReflection
+{
+    ShaderProgramType programType = ShaderProgramType::Unknown;
+    std::uint32_t majorVersion = 0;
+    std::uint32_t minorVersion = 0;
+    const char* creator = "";
+    bool hasResourceDefinition = false;     // DXIL中没有RDEF，只有输入输出签名
+    std::vector<ShaderConstantBuffer> constantBuffers;
+    std::vector<ShaderResourceBinding> resources;
+    std::vector<ShaderSignatureElement> inputs;
+    std::vector<ShaderSignatureElement> outputs;
+
+    // 没有时返回nullptr
+    const ShaderConstantBuffer* FindConstantBuffer(const std::string& name)const;
+    const ShaderResourceBinding* FindResource(const std::string& name)const;
+};
+
+// 读取RDEF和输入输出签名，数据损坏时返回false并在error中说明
+bool ReflectShader(const DxbcContainer& container, ShaderReflection& reflection, std::string& error);
+
+// C++结构体中的一个成员，一般用offsetof和sizeof得到
+struct CpuField
+{
+    const char* name;
+    std::uint32_t offset;
+    std::uint32_t size;
+};
+
+// 例如CPU_FIELD(PassConstant, viewMatrix)
+#define CPU_FIELD(Type, member) CpuField{ #member, (std::uint32_t)offsetof(Type, member), (std::uint32_t)sizeof(((Type*)nullptr)->member) }
+
+// 检查C++结构体的布局与shader中的cbuffer（path为空时）或struct变量（path为变量名时，offset相对于struct的开头）一致：
+// shader中的每个变量都要有同名、同offset、同size的field，cpuSize按16字节对齐后等于cbuffer的大小或struct数组的stride。
+// C++中多出的field不检查，不一致的地方逐条追加到errors中
+bool ValidateLayout(const ShaderConstantBuffer& constantBuffer, const std::string& path,
+    const std::vector<CpuField>& fields, std::uint32_t cpuSize, std::vector<std::string>& errors);
+
+// root signature中的一个绑定，由所有stage的资源合并而来
+struct ShaderBinding
+{
+    const char* name;
+    ShaderInputType type;
+    std::uint32_t bindPoint;
+    std::uint32_t bindCount;
+    std::uint32_t space;
+    std::uint32_t stageMask;            // 1 << ShaderProgramType，使用这个资源的所有stage
+};
+
+// 合并多个stage的资源，同一个register在不同stage中名字或类型不同时返回false。
+// 结果按cbv、srv、uav、sampler的顺序，同类中按space、register排序，对应root signature中descriptor range的顺序
+bool BuildBindingTable(const std::vector<const ShaderReflection*>& stages, std::vector<ShaderBinding>& bindings, std::string& error);
@@ -0,0 +1,482 @@
+#include "TextureFile.h"
+#include "../DirectXTK/DDS.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+using namespace DirectX;
+
+namespace
+{
+    using uint8 = std::uint8_t;
+    using uint32 = std::uint32_t;
+
+    bool ReadFile(const std::string& path, std::vector<uint8>& data)
+    {
+        std::ifstream fin(path, std::ios::binary);
+        if (!fin)
+            return false;
+        data.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+        return true;
+    }
+
+    bool HasExtension(const std::string& path, const char* extension)
+    {
+        const std::size_t length = std::strlen(extension);
+        if (path.size() < length)
+            return false;
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            const char c = path[path.size() - length + i];
+            if ((c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c) != extension[i])
+                return false;
+        }
+        return true;
+    }
+
+    uint32 ReadUint16(const uint8* data)
+    {
+        return data[0] | (data[1] << 8);
+    }
+
+    // 块压缩格式每块的字节数，其他格式返回0
+    uint32 BytesPerBlock(DXGI_FORMAT format)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            return 8;
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
+    uint32 BytesPerPixel(DXGI_FORMAT format)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R8_UNORM:
+            return 1;
+        case DXGI_FORMAT_R8G8_UNORM:
+            return 2;
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return 4;
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            return 8;
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:
+            return 16;
+        default:
+            return 0;
+        }
+    }
+
+    // 旧的文件头能表示的格式，其他格式需要DX10头
+    const DDS_PIXELFORMAT* LegacyPixelFormat(DXGI_FORMAT format)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_UNORM: return &DDSPF_DXT1;
+        case DXGI_FORMAT_BC2_UNORM: return &DDSPF_DXT3;
+        case DXGI_FORMAT_BC3_UNORM: return &DDSPF_DXT5;
+        case DXGI_FORMAT_BC4_UNORM: return &DDSPF_BC4_UNORM;
+        case DXGI_FORMAT_BC5_UNORM: return &DDSPF_BC5_UNORM;
+        case DXGI_FORMAT_R8G8B8A8_UNORM: return &DDSPF_A8B8G8R8;
+        case DXGI_FORMAT_B8G8R8A8_UNORM: return &DDSPF_A8R8G8B8;
+        default: return nullptr;
+        }
+    }
+
+    // TGA的像素为BGR(A)，bits为8时是灰度
+    void ReadTgaPixel(const uint8* source, uint32 bits, uint8* rgba)
+    {
+        if (bits == 8)
+        {
+            rgba[0] = rgba[1] = rgba[2] = source[0];
+            rgba[3] = 255;
+            return;
+        }
+        rgba[0] = source[2];
+        rgba[1] = source[1];
+        rgba[2] = source[0];
+        rgba[3] = bits == 32 ? source[3] : 255;
+    }
+
+    // 只读取第一级mip，只支持32位的RGBA、BGRA
+    bool LoadDdsRgba(const std::vector<uint8>& file, RgbaImage& image)
+    {
+        if (file.size() < sizeof(uint32) + sizeof(DDS_HEADER))
+            return false;
+        uint32 magic;
+        DDS_HEADER header;
+        std::memcpy(&magic, file.data(), sizeof(magic));
+        std::memcpy(&header, file.data() + sizeof(magic), sizeof(header));
+        if (magic != DDS_MAGIC || header.size != sizeof(DDS_HEADER) || header.ddspf.size != sizeof(DDS_PIXELFORMAT))
+            return false;
+
+        std::size_t offset = sizeof(magic) + sizeof(header);
+        bool swapRedBlue;
+        if ((header.ddspf.flags & DDS_FOURCC) && header.ddspf.fourCC == DDSPF_DX10.fourCC)
+        {
+            DDS_HEADER_DXT10 extension;
+            if (file.size() < offset + sizeof(extension))
+                return false;
+            std::memcpy(&extension, file.data() + offset, sizeof(extension));
+            offset += sizeof(extension);
+            if (extension.dxgiFormat == DXGI_FORMAT_R8G8B8A8_UNORM || extension.dxgiFormat == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB)
+                swapRedBlue = false;
+            else if (extension.dxgiFormat == DXGI_FORMAT_B8G8R8A8_UNORM || extension.dxgiFormat == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB)
+                swapRedBlue = true;
+            else
+                return false;
+        }
+        else if ((header.ddspf.flags & DDS_RGB) && header.ddspf.RGBBitCount == 32 && header.ddspf.GBitMask == 0x0000ff00)
+        {
+            if (header.ddspf.RBitMask == 0x000000ff && header.ddspf.BBitMask == 0x00ff0000)
+                swapRedBlue = false;
+            else if (header.ddspf.RBitMask == 0x00ff0000 && header.ddspf.BBitMask == 0x000000ff)
+                swapRedBlue = true;
+            else
+                return false;
+        }
+        else
+            return false;
+
+        const bool hasAlpha = (header.ddspf.flags & DDS_ALPHAPIXELS) != 0 || (header.ddspf.flags & DDS_FOURCC) != 0;
+        const std::size_t size = (std::size_t)header.width * header.height * 4;
+        if (header.width == 0 || header.height == 0 || file.size() - offset < size)
+            return false;
+
+        image.width = header.width;
+        image.height = header.height;
+        image.pixels.assign(file.begin() + offset, file.begin() + offset + size);
+        for (std::size_t i = 0; i < size; i += 4)
+        {
+            if (swapRedBlue)
+                std::swap(image.pixels[i], image.pixels[i + 2]);
+            if (!hasAlpha)
+                image.pixels[i + 3] = 255;
+        }
+        return true;
+    }
+
+    // 旧的文件头中能读取的格式，与LegacyPixelFormat相反
+    DXGI_FORMAT FormatFromLegacyHeader(const DDS_PIXELFORMAT& pixelFormat)
+    {
+        if (pixelFormat.flags & DDS_FOURCC)
+        {
+            static const DXGI_FORMAT Formats[] = { DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC2_UNORM, DXGI_FORMAT_BC3_UNORM,
+                DXGI_FORMAT_BC4_UNORM, DXGI_FORMAT_BC4_UNORM, DXGI_FORMAT_BC5_UNORM, DXGI_FORMAT_BC5_UNORM };
+            const uint32 fourCCs[] = { DDSPF_DXT1.fourCC, DDSPF_DXT3.fourCC, DDSPF_DXT5.fourCC,
+                DDSPF_BC4_UNORM.fourCC, MAKEFOURCC('A', 'T', 'I', '1'), DDSPF_BC5_UNORM.fourCC, MAKEFOURCC('A', 'T', 'I', '2') };
+            for (std::size_t i = 0; i < sizeof(Formats) / sizeof(Formats[0]); ++i)
+            {
+                if (pixelFormat.fourCC == fourCCs[i])
+                    return Formats[i];
+            }
+            return DXGI_FORMAT_UNKNOWN;
+        }
+        if ((pixelFormat.flags & DDS_RGB) && pixelFormat.RGBBitCount == 32 && pixelFormat.GBitMask == 0x0000ff00 && pixelFormat.ABitMask == 0xff000000)
+        {
+            if (pixelFormat.RBitMask == 0x000000ff && pixelFormat.BBitMask == 0x00ff0000)
+                return DXGI_FORMAT_R8G8B8A8_UNORM;
+            if (pixelFormat.RBitMask == 0x00ff0000 && pixelFormat.BBitMask == 0x000000ff)
+                return DXGI_FORMAT_B8G8R8A8_UNORM;
+        }
+        return DXGI_FORMAT_UNKNOWN;
+    }
+}
+
+bool LoadTga(const std::string& path, RgbaImage& image)
+{
+    std::vector<uint8> file;
+    if (!ReadFile(path, file) || file.size() < 18)
+        return false;
+
+    const uint32 idLength = file[0];
+    const uint32 colorMapType = file[1];
+    const uint32 imageType = file[2];
+    const uint32 width = ReadUint16(&file[12]);
+    const uint32 height = ReadUint16(&file[14]);
+    const uint32 bits = file[16];
+    const uint32 descriptor = file[17];
+    // 2、3为未压缩的真彩色、灰度，10、11为RLE压缩的，不支持调色板
+    const bool rle = imageType == 10 || imageType == 11;
+    const bool gray = imageType == 3 || imageType == 11;
+    if (colorMapType != 0 || (imageType != 2 && imageType != 3 && !rle) || width == 0 || height == 0)
+        return false;
+    if (gray ? bits != 8 : (bits != 24 && bits != 32))
+        return false;
+
+    const uint32 pixelSize = bits / 8;
+    const std::size_t pixelCount = (std::size_t)width * height;
+    std::size_t position = 18 + idLength;
+    std::vector<uint8> pixels(pixelCount * 4);
+    if (!rle)
+    {
+        if (file.size() < position || file.size() - position < pixelCount * pixelSize)
+            return false;
+        for (std::size_t i = 0; i < pixelCount; ++i)
+            ReadTgaPixel(&file[position + i * pixelSize], bits, &pixels[i * 4]);
+    }
+    else
+    {
+        // 每个包的第一个字节最高位为1时，后面的一个像素重复(低7位 + 1)次，否则后面有(低7位 + 1)个像素
+        for (std::size_t i = 0; i < pixelCount;)
+        {
+            if (position >= file.size())
+                return false;
+            const uint32 packet = file[position++];
+            const std::size_t count = (std::min)((std::size_t)(packet & 0x7f) + 1, pixelCount - i);
+            if (packet & 0x80)
+            {
+                if (file.size() - position < pixelSize)
+                    return false;
+                uint8 rgba[4];
+                ReadTgaPixel(&file[position], bits, rgba);
+                position += pixelSize;
+                for (std::size_t j = 0; j < count; ++j, ++i)
+                    std::memcpy(&pixels[i * 4], rgba, 4);
+            }
+            else
+            {
+                if (file.size() - position < count * pixelSize)
+                    return false;
+                for (std::size_t j = 0; j < count; ++j, ++i, position += pixelSize)
+                    ReadTgaPixel(&file[position], bits, &pixels[i * 4]);
+            }
+        }
+    }
+
+    // descriptor的第5位为0时第一行在底部，第4位为1时每行从右往左
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(pixelCount * 4);
+    const bool bottomUp = (descriptor & 0x20) == 0;
+    const bool rightToLeft = (descriptor & 0x10) != 0;
+    for (uint32 y = 0; y < height; ++y)
+    {
+        const uint32 sourceY = bottomUp ? height - 1 - y : y;
+        for (uint32 x = 0; x < width; ++x)
+        {
+            const uint32 sourceX = rightToLeft ? width - 1 - x : x;
+            std::memcpy(&image.pixels[((std::size_t)y * width + x) * 4], &pixels[((std::size_t)sourceY * width + sourceX) * 4], 4);
+        }
+    }
+    return true;
+}
+
+bool SaveTga(const std::string& path, const RgbaImage& image)
+{
+    if (image.width == 0 || image.width > 0xffff || image.height == 0 || image.height > 0xffff)
+        return false;
+    std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+    if (!fout)
+        return false;
+
+    // 未压缩的32位真彩色，第一行在顶部
+    uint8 header[18] = {};
+    header[2] = 2;
+    header[12] = (uint8)image.width;
+    header[13] = (uint8)(image.width >> 8);
+    header[14] = (uint8)image.height;
+    header[15] = (uint8)(image.height >> 8);
+    header[16] = 32;
+    header[17] = 0x28;
+    fout.write((const char*)header, sizeof(header));
+
+    std::vector<uint8> bgra(image.pixels);
+    for (std::size_t i = 0; i < bgra.size(); i += 4)
+        std::swap(bgra[i], bgra[i + 2]);
+    fout.write((const char*)bgra.data(), bgra.size());
+    return (bool)fout;
+}
+
+bool LoadRgbaImage(const std::string& path, RgbaImage& image)
+{
+    if (HasExtension(path, ".tga"))
+        return LoadTga(path, image);
+    if (HasExtension(path, ".dds"))
+    {
+        std::vector<uint8> file;
+        return ReadFile(path, file) && LoadDdsRgba(file, image);
+    }
+    return false;
+}
+
+bool GetDdsSurfaceLayout(DXGI_FORMAT format, std::uint32_t width, std::uint32_t height, std::size_t& rowPitch, std::uint32_t& rowCount)
+{
+    if (const uint32 blockBytes = BytesPerBlock(format))
+    {
+        rowPitch = (std::size_t)(std::max)((width + 3) / 4, 1u) * blockBytes;
+        rowCount = (std::max)((height + 3) / 4, 1u);
+        return true;
+    }
+    if (const uint32 pixelBytes = BytesPerPixel(format))
+    {
+        rowPitch = (std::size_t)width * pixelBytes;
+        rowCount = height;
+        return true;
+    }
+    return false;
+}
+
+std::size_t GetDdsImageSize(DXGI_FORMAT format, std::uint32_t width, std::uint32_t height, std::uint32_t mipCount, std::uint32_t arraySize)
+{
+    std::size_t size = 0;
+    for (uint32 mip = 0; mip < mipCount; ++mip)
+    {
+        std::size_t rowPitch;
+        uint32 rowCount;
+        if (!GetDdsSurfaceLayout(format, (std::max)(width >> mip, 1u), (std::max)(height >> mip, 1u), rowPitch, rowCount))
+            return 0;
+        size += rowPitch * rowCount;
+    }
+    return size * arraySize;
+}
+
+bool SaveDds(const std::string& path, const DdsImage& image)
+{
+    std::size_t rowPitch;
+    uint32 rowCount;
+    if (image.width == 0 || image.height == 0 || image.mipCount == 0 || image.arraySize == 0 ||
+        !GetDdsSurfaceLayout(image.format, image.width, image.height, rowPitch, rowCount) ||
+        image.data.size() != GetDdsImageSize(image.format, image.width, image.height, image.mipCount, image.arraySize))
+        return false;
+
+    const bool compressed = BytesPerBlock(image.format) != 0;
+    const DDS_PIXELFORMAT* legacyFormat = image.arraySize == 1 ? LegacyPixelFormat(image.format) : nullptr;
+
+    DDS_HEADER header = {};
+    header.size = sizeof(DDS_HEADER);
+    header.flags = DDS_HEADER_FLAGS_TEXTURE | (compressed ? DDS_HEADER_FLAGS_LINEARSIZE : DDS_HEADER_FLAGS_PITCH);
+    header.height = image.height;
+    header.width = image.width;
+    header.pitchOrLinearSize = (uint32)(compressed ? rowPitch * rowCount : rowPitch);
+    header.mipMapCount = image.mipCount;
+    header.ddspf = legacyFormat != nullptr ? *legacyFormat : DDSPF_DX10;
+    header.caps = DDS_SURFACE_FLAGS_TEXTURE;
+    if (image.mipCount > 1)
+    {
+        header.flags |= DDS_HEADER_FLAGS_MIPMAP;
+        header.caps |= DDS_SURFACE_FLAGS_MIPMAP;
+    }
+
+    std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+    if (!fout)
+        return false;
+    fout.write((const char*)&DDS_MAGIC, sizeof(DDS_MAGIC));
+    fout.write((const char*)&header, sizeof(header));
+    if (legacyFormat == nullptr)
+    {
+        DDS_HEADER_DXT10 extension = {};
+        extension.dxgiFormat = image.format;
+        extension.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+        extension.arraySize = image.arraySize;
+        fout.write((const char*)&extension, sizeof(extension));
+    }
+    fout.write((const char*)image.data.data(), image.data.size());
+    return (bool)fout;
+}
+
+bool LoadDds(const std::string& path, DdsImage& image)
+{
+    std::vector<uint8> file;
+    if (!ReadFile(path, file) || file.size() < sizeof(uint32) + sizeof(DDS_HEADER))
+        return false;
+    uint32 magic;
+    DDS_HEADER header;
+    std::memcpy(&magic, file.data(), sizeof(magic));
+    std::memcpy(&header, file.data() + sizeof(magic), sizeof(header));
+    if (magic != DDS_MAGIC || header.size != sizeof(DDS_HEADER) || header.ddspf.size != sizeof(DDS_PIXELFORMAT) ||
+        (header.flags & DDS_HEADER_FLAGS_VOLUME) || (header.caps2 & (DDS_CUBEMAP | DDS_FLAGS_VOLUME)))
+        return false;
+
+    std::size_t offset = sizeof(magic) + sizeof(header);
+    DXGI_FORMAT format;
+    uint32 arraySize = 1;
+    if ((header.ddspf.flags & DDS_FOURCC) && header.ddspf.fourCC == DDSPF_DX10.fourCC)
+    {
+        DDS_HEADER_DXT10 extension;
+        if (file.size() < offset + sizeof(extension))
+            return false;
+        std::memcpy(&extension, file.data() + offset, sizeof(extension));
+        offset += sizeof(extension);
+        if (extension.resourceDimension != DDS_DIMENSION_TEXTURE2D || (extension.miscFlag & DDS_RESOURCE_MISC_TEXTURECUBE))
+            return false;
+        format = extension.dxgiFormat;
+        arraySize = extension.arraySize;
+    }
+    else
+        format = FormatFromLegacyHeader(header.ddspf);
+
+    const uint32 mipCount = (std::max)(header.mipMapCount, 1u);
+    std::size_t rowPitch;
+    uint32 rowCount;
+    if (header.width == 0 || header.height == 0 || arraySize == 0 || mipCount > 32 ||
+        !GetDdsSurfaceLayout(format, header.width, header.height, rowPitch, rowCount))
+        return false;
+    const std::size_t size = GetDdsImageSize(format, header.width, header.height, mipCount, arraySize);
+    if (file.size() - offset < size)
+        return false;
+
+    image.format = format;
+    image.width = header.width;
+    image.height = header.height;
+    image.mipCount = mipCount;
+    image.arraySize = arraySize;
+    image.data.assign(file.begin() + offset, file.begin() + offset + size);
+    return true;
+}
+
+ImageDifference CompareImages(const RgbaImage& a, const RgbaImage& b, std::uint32_t channelMask)
+{
+    assert(a.width == b.width && a.height == b.height && a.pixels.size() == b.pixels.size());
+    double sums[4] = {};
+    for (std::size_t i = 0; i < a.pixels.size(); i += 4)
+    {
+        for (uint32 c = 0; c < 4; ++c)
+        {
+            const double d = (double)a.pixels[i + c] - (double)b.pixels[i + c];
+            sums[c] += d * d;
+        }
+    }
+
+    ImageDifference difference;
+    const double pixelCount = (double)(std::max)(a.pixels.size() / 4, (std::size_t)1);
+    double total = 0.0;
+    uint32 channelCount = 0;
+    for (uint32 c = 0; c < 4; ++c)
+    {
+        difference.rmse[c] = std::sqrt(sums[c] / pixelCount);
+        if (channelMask & (1u << c))
+        {
+            total += sums[c];
+            ++channelCount;
+        }
+    }
+    const double mse = channelCount == 0 ? 0.0 : total / (pixelCount * channelCount);
+    difference.rmseAll = std::sqrt(mse);
+    difference.psnr = mse == 0.0 ? std::numeric_limits<double>::infinity() : 10.0 * std::log10(255.0 * 255.0 / mse);
+    return difference;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <dxgiformat.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 离线工具读写texture文件，不依赖图形API：
+// - TGA（8、24、32位，可以RLE压缩）读写为RGBA8
+// - DDS用DirectXTK/DDS.h中的结构写入，BC1~BC5和RGBA8使用旧的FourCC、像素格式头，其他格式（BC7、sRGB、texture数组）加DX10头
+
+struct RgbaImage
+{
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::vector<std::uint8_t> pixels;       // 按行排列，每行width * 4字节
+
+    std::size_t RowPitch()const { return (std::size_t)width * 4; }
+};
+
+bool LoadTga(const std::string& path, RgbaImage& image);
+bool SaveTga(const std::string& path, const RgbaImage& image);
+// 按扩展名读取.tga，或者未压缩的R8G8B8A8、B8G8R8A8格式的.dds的第一级mip
+bool LoadRgbaImage(const std::string& path, RgbaImage& image);
+
+// 一个DDS文件的内容，data中依次为每个array slice的各级mip，与DDSTextureLoader读取的顺序相同
+struct DdsImage
+{
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::uint32_t mipCount = 1;
+    std::uint32_t arraySize = 1;
+    std::vector<std::uint8_t> data;
+};
+
+// 一级mip每行的字节数和行数，块压缩格式按4x4的块行计算。只支持SaveDds能写的格式，其他格式返回false
+bool GetDdsSurfaceLayout(DXGI_FORMAT format, std::uint32_t width, std::uint32_t height, std::size_t& rowPitch, std::uint32_t& rowCount);
+// 所有subresource的总字节数，不支持的格式返回0
+std::size_t GetDdsImageSize(DXGI_FORMAT format, std::uint32_t width, std::uint32_t height, std::uint32_t mipCount, std::uint32_t arraySize);
+// data的大小必须等于GetDdsImageSize
+bool SaveDds(const std::string& path, const DdsImage& image);
+// 读取2D texture或texture数组的所有subresource，格式必须是GetDdsSurfaceLayout支持的，不支持cube map和volume texture
+bool LoadDds(const std::string& path, DdsImage& image);
+
+struct ImageDifference
+{
+    double rmse[4] = {};            // 每个通道
+    double rmseAll = 0.0;           // channelMask中所有通道
+    double psnr = 0.0;              // 完全相同时为无穷大
+};
+
+// 两张图的大小必须相同。channelMask的第i位表示比较第i个通道，例如BC4只比较R
+ImageDifference CompareImages(const RgbaImage& a, const RgbaImage& b, std::uint32_t channelMask = 0xf);
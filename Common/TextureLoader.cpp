@@ -0,0 +1,415 @@
+#include "TextureLoader.h"
+#include "AssetArchive.h"
+#include "PlacedResourceAllocator.h"
+#include "../DirectXTK/DDSTextureCatalog.h"
+#include <algorithm>
+#include <cassert>
+
+TextureLoader::TextureLoader(ID3D12Device* device, PlacedResourceAllocator* allocator, UINT threadCount, UINT64 stagingPageSize) :
+    m_device(device),
+    m_allocator(allocator),
+    m_uploadManager(device, stagingPageSize)
+{
+    // copy queue可以和direct queue并行执行，上传不占用渲染的时间
+    D3D12_COMMAND_QUEUE_DESC queueDesc = {};
+    queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+    ThrowIfFailed(m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_copyQueue)));
+
+    ComPtr<ID3D12CommandAllocator> commandAllocator;
+    ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&commandAllocator)));
+    ThrowIfFailed(m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, commandAllocator.Get(), nullptr, IID_PPV_ARGS(&m_commandList)));
+    ThrowIfFailed(m_commandList->Close());
+    m_freeCommandAllocators.push_back(commandAllocator);
+
+    ThrowIfFailed(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
+    m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (m_fenceEvent == nullptr)
+        ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
+
+    if (threadCount == 0)
+        threadCount = 1;
+    for (UINT i = 0; i < threadCount; ++i)
+        m_threads.emplace_back([this]() { WorkerThread(); });
+}
+
+TextureLoader::~TextureLoader()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_exit = true;
+        for (Job& job : m_jobs)
+            job.texture->loadState = TextureLoadState::Unloaded;
+        m_jobs.clear();
+        m_mipJobs.clear();
+    }
+    m_jobCondition.notify_all();
+    for (auto& thread : m_threads)
+        thread.join();
+
+    // staging page和command allocator要等copy queue执行完才能释放
+    WaitForFence(m_fenceValue);
+    CloseHandle(m_fenceEvent);
+}
+
+void TextureLoader::Request(Texture* texture, bool streaming)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        texture->loadState = TextureLoadState::Queued;
+        texture->topMip = 0;
+        Job job;
+        job.texture = texture;
+        job.streaming = streaming;
+        m_jobs.push_back(job);
+        ++m_busyCount;
+    }
+    m_jobCondition.notify_one();
+}
+
+void TextureLoader::Request(Texture* texture, const D3D12_RESOURCE_DESC& desc, bool streaming)
+{
+    // 在加锁之前创建，resource在数据到达前不会被GPU使用
+    texture->resource = CreateTextureResource(desc);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        texture->loadState = TextureLoadState::Queued;
+        texture->topMip = 0;
+        Job job;
+        job.texture = texture;
+        job.streaming = streaming;
+        job.isCreated = true;
+        m_jobs.push_back(job);
+        ++m_busyCount;
+    }
+    m_jobCondition.notify_one();
+}
+
+void TextureLoader::RequestMips(Texture* texture, UINT firstMip)
+{
+    {
+        // 只是改变分辨率，排在新texture的加载之后
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Job job;
+        job.texture = texture;
+        job.isResize = true;
+        job.firstMip = firstMip;
+        m_mipJobs.push_back(job);
+        ++m_busyCount;
+    }
+    m_jobCondition.notify_one();
+}
+
+bool TextureLoader::IsBusy()const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_busyCount > 0;
+}
+
+void TextureLoader::WorkerThread()
+{
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobCondition.wait(lock, [this]() { return m_exit || !m_jobs.empty() || !m_mipJobs.empty(); });
+            if (m_exit)
+                return;
+            // 先让所有texture都能显示，再逐级提高分辨率
+            std::deque<Job>& jobs = m_jobs.empty() ? m_mipJobs : m_jobs;
+            job = jobs.front();
+            jobs.pop_front();
+        }
+
+        // 读取文件和拷贝到staging buffer都在这里完成，多个线程同时进行，总时间取决于磁盘带宽
+        Texture* texture = job.texture;
+        uint64_t copiedBytes = 0;
+        size_t firstMip = job.firstMip;
+        HRESULT hr = S_OK;
+        ComPtr<ID3D12Resource> resizedTexture;
+        if (texture->archiveEntry != nullptr)
+            hr = LoadFromArchive(job, resizedTexture, firstMip, copiedBytes);
+        else if (job.isResize)
+            hr = DirectX::CreateDDSTextureFromFile12(m_device, texture->fileName.c_str(), m_allocator, &m_uploadManager, resizedTexture,
+                MaxSizeOfMip(texture->resource->GetDesc(), texture->topMip, job.firstMip), nullptr, &copiedBytes);
+        else if (job.isMipUpload)
+            hr = DirectX::UploadDDSTextureMips12(texture->fileName.c_str(), &m_uploadManager, texture->resource.Get(), firstMip, 1, &copiedBytes);
+        else if (job.isCreated)
+        {
+            const D3D12_RESOURCE_DESC desc = texture->resource->GetDesc();
+            firstMip = job.streaming ? FirstStreamingMip(desc) : 0;
+            hr = DirectX::UploadDDSTextureMips12(texture->fileName.c_str(), &m_uploadManager, texture->resource.Get(), firstMip,
+                desc.MipLevels - firstMip, &copiedBytes);
+        }
+        else if (job.streaming)
+            hr = DirectX::CreateStreamingDDSTextureFromFile12(m_device, texture->fileName.c_str(), m_allocator, &m_uploadManager,
+                StreamingMipTailSize, texture->resource, firstMip, &copiedBytes);
+        else
+            hr = DirectX::CreateDDSTextureFromFile12(m_device, texture->fileName.c_str(), m_allocator, &m_uploadManager, texture->resource,
+                0, nullptr, &copiedBytes);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (SUCCEEDED(hr))
+        {
+#if defined(DEBUG) || defined(_DEBUG)
+            std::wstring message = texture->fileName + L": mip " + std::to_wstring(firstMip) + L", " + std::to_wstring(copiedBytes) +
+                L" bytes copied to the staging buffer\n";
+            OutputDebugStringW(message.c_str());
+#endif
+            if (!job.isMipUpload && !job.isResize)
+                texture->loadState = TextureLoadState::Staged;
+            StagedUpload upload;
+            upload.texture = texture;
+            upload.streaming = job.streaming;
+            upload.isResize = job.isResize;
+            upload.firstMip = (UINT)firstMip;
+            upload.resource = std::move(resizedTexture);
+            m_stagedUploads.push_back(std::move(upload));
+        }
+        else
+        {
+            // 高层mip读取或者重新创建失败时texture保持在已经上传的mip
+            std::wstring message = L"TextureLoader: failed to load " + texture->fileName + L", hr = " + std::to_wstring(hr) + L"\n";
+            OutputDebugStringW(message.c_str());
+            if (job.isResize)
+            {
+                // 仍然交给Update返回，调用者由此知道texture没有改变
+                StagedUpload upload;
+                upload.texture = texture;
+                upload.isResize = true;
+                upload.firstMip = texture->topMip;
+                m_stagedUploads.push_back(std::move(upload));
+            }
+            else
+            {
+                if (!job.isMipUpload)
+                    texture->loadState = TextureLoadState::Failed;
+                --m_busyCount;
+            }
+        }
+    }
+}
+
+std::vector<Texture*> TextureLoader::Update(std::vector<ComPtr<ID3D12Resource>>* replacedResources)
+{
+    // 先取出准备好的数据再Flush，它们的copy一定已经在m_uploadManager中
+    std::vector<StagedUpload> stagedUploads;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stagedUploads.swap(m_stagedUploads);
+    }
+
+    if (!stagedUploads.empty())
+    {
+        Batch batch;
+        if (!m_freeCommandAllocators.empty())
+        {
+            batch.commandAllocator = m_freeCommandAllocators.back();
+            m_freeCommandAllocators.pop_back();
+        }
+        else
+            ThrowIfFailed(m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&batch.commandAllocator)));
+
+        // 这段时间内所有准备好的数据合并在一个command list中提交
+        ThrowIfFailed(batch.commandAllocator->Reset());
+        ThrowIfFailed(m_commandList->Reset(batch.commandAllocator.Get(), nullptr));
+        m_uploadManager.Flush(m_commandList.Get());
+        ThrowIfFailed(m_commandList->Close());
+        ID3D12CommandList* commandLists[] = { m_commandList.Get() };
+        m_copyQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
+
+        ++m_fenceValue;
+        ThrowIfFailed(m_copyQueue->Signal(m_fence.Get(), m_fenceValue));
+        m_uploadManager.RetireSubmitted(m_fenceValue);
+
+        for (auto& upload : stagedUploads)
+        {
+            if (upload.texture->loadState == TextureLoadState::Staged)
+                upload.texture->loadState = TextureLoadState::Uploading;
+        }
+        batch.fenceValue = m_fenceValue;
+        batch.uploads.swap(stagedUploads);
+        m_submittedBatches.push_back(std::move(batch));
+    }
+
+    // 只检查fence，不等待GPU
+    const UINT64 completedFenceValue = m_fence->GetCompletedValue();
+    m_uploadManager.ReleaseCompleted(completedFenceValue);
+
+    std::vector<Texture*> changedTextures;
+    std::vector<Job> mipJobs;
+    size_t finishedCount = 0;
+    while (!m_submittedBatches.empty() && m_submittedBatches.front().fenceValue <= completedFenceValue)
+    {
+        Batch& batch = m_submittedBatches.front();
+        for (auto& upload : batch.uploads)
+        {
+            Texture* texture = upload.texture;
+            if (upload.isResize)
+            {
+                // GPU可能还在使用原来的resource，交给调用者延迟释放
+                if (upload.resource != nullptr)
+                {
+                    assert(replacedResources != nullptr);
+                    replacedResources->push_back(std::move(texture->resource));
+                    texture->resource = std::move(upload.resource);
+                    texture->topMip = upload.firstMip;
+                }
+                texture->residentMip = 0;
+                changedTextures.push_back(texture);
+                ++finishedCount;
+                continue;
+            }
+
+            texture->residentMip = upload.firstMip;
+            texture->loadState = TextureLoadState::Resident;
+            changedTextures.push_back(texture);
+
+            // streaming的texture继续读取上一级mip
+            if (upload.streaming && upload.firstMip > 0)
+            {
+                Job job;
+                job.texture = texture;
+                job.streaming = true;
+                job.isMipUpload = true;
+                job.firstMip = upload.firstMip - 1;
+                mipJobs.push_back(job);
+            }
+            else
+                ++finishedCount;
+        }
+        m_freeCommandAllocators.push_back(batch.commandAllocator);
+        m_submittedBatches.pop_front();
+    }
+
+    if (!changedTextures.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_busyCount -= finishedCount;
+            m_mipJobs.insert(m_mipJobs.end(), mipJobs.begin(), mipJobs.end());
+        }
+        if (!mipJobs.empty())
+            m_jobCondition.notify_all();
+    }
+    return changedTextures;
+}
+
+void TextureLoader::WaitForFence(UINT64 fenceValue)
+{
+    // 在析构函数中调用，不抛出异常
+    if (m_fence->GetCompletedValue() < fenceValue && SUCCEEDED(m_fence->SetEventOnCompletion(fenceValue, m_fenceEvent)))
+        WaitForSingleObject(m_fenceEvent, INFINITE);
+}
+
+ComPtr<ID3D12Resource> TextureLoader::CreateTextureResource(const D3D12_RESOURCE_DESC& desc)
+{
+    ComPtr<ID3D12Resource> resource;
+    if (m_allocator != nullptr)
+        resource = m_allocator->CreateTexture(desc, D3D12_RESOURCE_STATE_COMMON);
+    else
+        ThrowIfFailed(m_device->CreateCommittedResource(&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT), D3D12_HEAP_FLAG_NONE,
+            &desc, D3D12_RESOURCE_STATE_COMMON, nullptr, IID_PPV_ARGS(&resource)));
+    return resource;
+}
+
+HRESULT TextureLoader::LoadFromArchive(const Job& job, ComPtr<ID3D12Resource>& resizedTexture, size_t& firstMip, uint64_t& copiedBytes)
+{
+    // 每次都重新解析dds头部，只需要解压第一个chunk
+    Texture* texture = job.texture;
+    AssetStream stream(*texture->archive, *texture->archiveEntry);
+    uint8_t header[DirectX::DDS_CATALOG_HEADER_SIZE];
+    const size_t headerSize = (size_t)(std::min)(stream.GetSize(), (uint64_t)sizeof(header));
+    if (!stream.Read(0, header, headerSize))
+        return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+    DirectX::DDSCatalogEntry file;
+    std::vector<DirectX::DDSCatalogSubresource> subresources;
+    HRESULT hr = DirectX::GetDDSTextureLayout(header, headerSize, stream.GetSize(), file, subresources);
+    if (FAILED(hr))
+        return hr;
+    if (file.desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D)
+        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+    try
+    {
+        // topMip为resource的mip 0在文件中的级数，上传resource中[uploadMip, uploadMip + mipCount)这几级mip
+        ID3D12Resource* resource = nullptr;
+        UINT topMip = 0;
+        UINT uploadMip = 0;
+        UINT mipCount = 0;
+        if (job.isMipUpload || job.isCreated)
+        {
+            resource = texture->resource.Get();
+            topMip = texture->topMip;
+            const D3D12_RESOURCE_DESC desc = resource->GetDesc();
+            if (desc.Format != file.desc.Format || desc.DepthOrArraySize != file.desc.DepthOrArraySize ||
+                desc.MipLevels + topMip != file.desc.MipLevels)
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+            uploadMip = job.isMipUpload ? job.firstMip : (job.streaming ? FirstStreamingMip(desc) : 0);
+            mipCount = job.isMipUpload ? 1 : desc.MipLevels - uploadMip;
+            if (job.isCreated)
+                firstMip = uploadMip;
+        }
+        else
+        {
+            // 新建texture，或者为residency manager重新创建只包含文件中firstMip及之后mip的texture
+            topMip = job.isResize ? job.firstMip : 0;
+            if (topMip >= file.desc.MipLevels)
+                return E_INVALIDARG;
+            D3D12_RESOURCE_DESC desc = file.desc;
+            desc.Width = (std::max)(desc.Width >> topMip, (UINT64)1);
+            desc.Height = (std::max)(desc.Height >> topMip, 1u);
+            desc.MipLevels = (UINT16)(desc.MipLevels - topMip);
+            ComPtr<ID3D12Resource>& target = job.isResize ? resizedTexture : texture->resource;
+            target = CreateTextureResource(desc);
+            resource = target.Get();
+            uploadMip = job.streaming ? FirstStreamingMip(desc) : 0;
+            mipCount = desc.MipLevels - uploadMip;
+            if (!job.isResize)
+                firstMip = uploadMip;
+        }
+
+        // dds中按slice排列，每个slice的这几级mip在文件和resource中都是连续的subresource。
+        // 所有slice一次上传，某个slice读取失败时不会留下其他slice的copy（resize时resizedTexture会在返回后释放）
+        const UINT fileMipCount = file.desc.MipLevels;
+        UINT64 copied = 0;
+        const bool uploaded = m_uploadManager.UploadTexture(resource, uploadMip, mipCount, file.desc.DepthOrArraySize,
+            [&](UINT index, UINT64 offset, void* dest, UINT64 size)
+        {
+            const UINT slice = index / mipCount;
+            const DirectX::DDSCatalogSubresource& subresource = subresources[slice * fileMipCount + topMip + uploadMip + index % mipCount];
+            return stream.Read(subresource.offset + offset, dest, (size_t)size);
+        }, D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COMMON, &copied);
+        if (!uploaded)
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+        copiedBytes += copied;
+    }
+    catch (const DxException& e)
+    {
+        return e.ErrorCode;
+    }
+    return S_OK;
+}
+
+UINT TextureLoader::FirstStreamingMip(const D3D12_RESOURCE_DESC& desc)
+{
+    UINT mip = 0;
+    while (mip + 1u < desc.MipLevels && (std::max)(desc.Width >> mip, (UINT64)(desc.Height >> mip)) > StreamingMipTailSize)
+        ++mip;
+    return mip;
+}
+
+size_t TextureLoader::MaxSizeOfMip(const D3D12_RESOURCE_DESC& desc, UINT topMip, UINT mip)
+{
+    UINT64 size = (std::max)(desc.Width, (UINT64)desc.Height);
+    if (desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D)
+        size = (std::max)(size, (UINT64)desc.DepthOrArraySize);
+    if (mip >= topMip)
+        return (size_t)(std::max)(size >> (mip - topMip), (UINT64)1);
+
+    // 比topMip更精细的mip在文件中的边长在[size << n, ((size + 1) << n) - 1]之间，取上界，
+    // 再上一级mip一定比它大，会被跳过
+    return (size_t)(((size + 1) << (topMip - mip)) - 1);
+}
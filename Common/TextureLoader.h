@@ -0,0 +1,114 @@
+#pragma once
+#include "d3d12Util.h"
+#include "UploadManager.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class PlacedResourceAllocator;
+
+// 在后台加载dds texture，不阻塞渲染线程：
+// - 工作线程映射文件、解析头部、创建texture，并把每一行直接拷贝到自己的UploadManager的staging buffer中
+// - 渲染线程每帧调用Update，把这段时间内准备好的texture合并成一批，在copy queue上一次提交
+// - copy queue的fence完成后texture变为Resident，由Update返回，调用者此时再把SRV换成真正的texture
+// 加载的进度保存在Texture::loadState中，Resident之前调用者应当使用占位的texture。
+// texture拷贝完成后处于COMMON状态，direct queue第一次读取时会被隐式promote，不需要barrier。
+// streaming模式下先只上传mip tail，texture很快就能以低分辨率显示，之后每次在后台读取上一级mip，
+// 通过Texture::residentMip告诉调用者可以使用的最精细的mip。所有texture的mip tail优先于高层mip读取。
+// RequestMips重新创建只包含部分mip的texture，用于residency manager在预算内降低或者恢复分辨率。
+// 已经由DDSTextureCatalog得到desc时可以在Request中直接创建resource，工作线程不再等待读取头部后才能创建。
+// Texture::archiveEntry不为nullptr时从打包的archive中读取，工作线程把chunk直接解压到staging buffer中，不再打开单独的文件。
+class TextureLoader
+{
+public:
+    // streaming时最先上传的mip tail：宽高都不超过这个值的mip
+    static const size_t StreamingMipTailSize = 64;
+
+    // allocator为nullptr时每个texture使用committed resource
+    TextureLoader(ID3D12Device* device, PlacedResourceAllocator* allocator, UINT threadCount, UINT64 stagingPageSize = 32 * 1024 * 1024);
+    TextureLoader(const TextureLoader& rhs) = delete;
+    TextureLoader& operator=(const TextureLoader& rhs) = delete;
+
+    // 还没开始读取的请求直接丢弃，等待正在读取的和已经提交的copy完成
+    ~TextureLoader();
+
+    // texture->fileName需要已经设置，texture在所有mip上传完成或Failed之前必须一直有效
+    void Request(Texture* texture, bool streaming = false);
+
+    // desc由DDSTextureCatalog只读取文件头得到，resource在调用线程中立即创建，工作线程只读取数据。
+    // 只支持Texture2D（包括数组），desc必须与文件一致，否则上传时失败
+    void Request(Texture* texture, const D3D12_RESOURCE_DESC& desc, bool streaming = false);
+
+    // 重新创建只包含dds文件中firstMip及之后mip的texture，从文件中读取全部数据，原来的resource在此期间仍然可以使用。
+    // texture必须已经Resident并且没有其他请求，完成后（失败时也一样）由Update返回，此时texture->topMip为新resource的第一级mip
+    void RequestMips(Texture* texture, UINT firstMip);
+
+    // 只能在一个线程（通常是渲染线程）中调用，提交准备好的数据，返回本次变为Resident、residentMip变小或者被RequestMips替换的texture。
+    // 被替换的resource放入replacedResources，调用者在GPU不再使用后释放；使用RequestMips时必须传入
+    std::vector<Texture*> Update(std::vector<ComPtr<ID3D12Resource>>* replacedResources = nullptr);
+
+    // 还有没有上传完所有mip且没有Failed的请求
+    bool IsBusy()const;
+
+private:
+    struct Job
+    {
+        Texture* texture = nullptr;
+        bool streaming = false;
+        bool isMipUpload = false;   // 为false时创建texture，为true时读取firstMip这一级mip
+        bool isResize = false;      // 重新创建只包含firstMip及之后mip的texture
+        bool isCreated = false;     // resource已经在Request中创建，只需要上传数据
+        UINT firstMip = 0;
+    };
+
+    // 已经拷贝到staging buffer中的数据，firstMip及之后的mip在copy完成后可以使用
+    struct StagedUpload
+    {
+        Texture* texture = nullptr;
+        bool streaming = false;
+        bool isResize = false;
+        UINT firstMip = 0;
+        ComPtr<ID3D12Resource> resource;    // isResize时新创建的texture，失败时为nullptr
+    };
+
+    struct Batch
+    {
+        UINT64 fenceValue = 0;
+        ComPtr<ID3D12CommandAllocator> commandAllocator;
+        std::vector<StagedUpload> uploads;
+    };
+
+    void WorkerThread();
+    ComPtr<ID3D12Resource> CreateTextureResource(const D3D12_RESOURCE_DESC& desc);
+    // 与WorkerThread中读取单独文件的几种情况相同，数据来自texture->archiveEntry
+    HRESULT LoadFromArchive(const Job& job, ComPtr<ID3D12Resource>& resizedTexture, size_t& firstMip, uint64_t& copiedBytes);
+    // streaming时最先上传的mip，与CreateStreamingDDSTextureFromFile12的选择相同
+    static UINT FirstStreamingMip(const D3D12_RESOURCE_DESC& desc);
+    // dds文件中第mip级的最大边长，由只包含topMip之后mip的desc反推，用作CreateDDSTextureFromFile12的maxsize
+    static size_t MaxSizeOfMip(const D3D12_RESOURCE_DESC& desc, UINT topMip, UINT mip);
+    void WaitForFence(UINT64 fenceValue);
+
+    ID3D12Device* m_device;
+    PlacedResourceAllocator* m_allocator;
+    UploadManager m_uploadManager;
+
+    // 以下只在调用Update的线程中使用
+    ComPtr<ID3D12CommandQueue> m_copyQueue;
+    ComPtr<ID3D12GraphicsCommandList> m_commandList;
+    std::vector<ComPtr<ID3D12CommandAllocator>> m_freeCommandAllocators;
+    ComPtr<ID3D12Fence> m_fence;
+    UINT64 m_fenceValue = 0;
+    HANDLE m_fenceEvent = nullptr;
+    std::deque<Batch> m_submittedBatches;      // 按fence值排列
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_jobCondition;
+    std::deque<Job> m_jobs;                     // 创建texture并上传mip tail（或全部mip）
+    std::deque<Job> m_mipJobs;                  // streaming的高层mip，m_jobs为空时才读取
+    std::vector<StagedUpload> m_stagedUploads;  // 数据已经在staging buffer中，等待Update提交
+    size_t m_busyCount = 0;                     // 还没有上传完所有mip且没有Failed的请求数
+    bool m_exit = false;
+    std::vector<std::thread> m_threads;
+};
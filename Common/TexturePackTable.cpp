@@ -0,0 +1,74 @@
+#include "TexturePackTable.h"
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+const TexturePackEntry* TexturePackTable::Find(const std::string& name)const
+{
+    for (const TexturePackEntry& entry : entries)
+    {
+        if (entry.name == name)
+            return &entry;
+    }
+    return nullptr;
+}
+
+bool LoadTexturePackTable(const std::string& path, TexturePackTable& table)
+{
+    std::ifstream fin(path);
+    if (!fin)
+        return false;
+
+    TexturePackTable loaded;
+    std::string line;
+    while (std::getline(fin, line))
+    {
+        std::istringstream words(line);
+        std::string kind;
+        if (!(words >> kind) || kind[0] == '#')
+            continue;
+        if (kind == "resource")
+        {
+            std::string file;
+            if (!(words >> file))
+                return false;
+            loaded.resources.push_back(file);
+        }
+        else if (kind == "texture")
+        {
+            TexturePackEntry entry;
+            if (!(words >> entry.name >> entry.resource >> entry.slice >> entry.uvScale[0] >> entry.uvScale[1] >> entry.uvOffset[0] >> entry.uvOffset[1]))
+                return false;
+            loaded.entries.push_back(entry);
+        }
+        else
+            return false;
+    }
+    for (const TexturePackEntry& entry : loaded.entries)
+    {
+        if (entry.resource >= loaded.resources.size())
+            return false;
+    }
+    table = std::move(loaded);
+    return true;
+}
+
+bool SaveTexturePackTable(const std::string& path, const TexturePackTable& table)
+{
+    std::ofstream fout(path, std::ios::trunc);
+    if (!fout)
+        return false;
+
+    // 9位有效数字可以精确地还原float
+    fout << std::setprecision(9);
+    fout << "# resource file\n";
+    for (const std::string& file : table.resources)
+        fout << "resource " << file << "\n";
+    fout << "# texture name resource slice uvScale.x uvScale.y uvOffset.x uvOffset.y\n";
+    for (const TexturePackEntry& entry : table.entries)
+    {
+        fout << "texture " << entry.name << " " << entry.resource << " " << entry.slice << " " << entry.uvScale[0] << " " << entry.uvScale[1]
+            << " " << entry.uvOffset[0] << " " << entry.uvOffset[1] << "\n";
+    }
+    return (bool)fout;
+}
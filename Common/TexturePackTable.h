@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Util/TexturePack输出的重映射表，记录每个原始texture打包后所在的resource和位置，不依赖图形API。
+// 打包后的resource统一按Texture2DArray使用：数组中的texture用slice区分，atlas中的texture用UV的缩放和偏移区分，
+// 单独的texture是只有一个slice、UV不变换的数组。shader中的采样坐标为
+//   float3(frac(uv) * uvScale + uvOffset, slice)
+// 文本格式，每行一项，#开头的行为注释：
+//   resource 文件名（相对于表所在的目录）
+//   texture 名字 resource下标 slice uvScale.x uvScale.y uvOffset.x uvOffset.y
+
+struct TexturePackEntry
+{
+    std::string name;
+    std::uint32_t resource = 0;         // TexturePackTable::resources的下标
+    std::uint32_t slice = 0;
+    float uvScale[2] = { 1.0f, 1.0f };
+    float uvOffset[2] = { 0.0f, 0.0f };
+};
+
+struct TexturePackTable
+{
+    std::vector<std::string> resources;
+    std::vector<TexturePackEntry> entries;
+
+    // 没有时返回nullptr
+    const TexturePackEntry* Find(const std::string& name)const;
+};
+
+// 文件不存在、格式错误或者resource下标越界时返回false
+bool LoadTexturePackTable(const std::string& path, TexturePackTable& table);
+bool SaveTexturePackTable(const std::string& path, const TexturePackTable& table);
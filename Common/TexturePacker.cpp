@@ -0,0 +1,361 @@
+#include "TexturePacker.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <tuple>
+
+namespace
+{
+    using uint8 = std::uint8_t;
+    using uint32 = std::uint32_t;
+
+    // 拷贝的最小单位：BC格式为4x4的块，其他格式为一个像素
+    struct BlockLayout
+    {
+        uint32 size = 1;                        // 边长
+        std::size_t bytes = 0;
+        bool compressed = false;
+        BlockFormat format = BlockFormat::BC1;  // compressed时有效
+    };
+
+    bool GetBlockFormat(DXGI_FORMAT format, BlockFormat& blockFormat)
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB: blockFormat = BlockFormat::BC1; return true;
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB: blockFormat = BlockFormat::BC2; return true;
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB: blockFormat = BlockFormat::BC3; return true;
+        case DXGI_FORMAT_BC4_UNORM: blockFormat = BlockFormat::BC4; return true;
+        case DXGI_FORMAT_BC4_SNORM: blockFormat = BlockFormat::BC4Signed; return true;
+        case DXGI_FORMAT_BC5_UNORM: blockFormat = BlockFormat::BC5; return true;
+        case DXGI_FORMAT_BC5_SNORM: blockFormat = BlockFormat::BC5Signed; return true;
+        case DXGI_FORMAT_BC6H_UF16: blockFormat = BlockFormat::BC6HUnsigned; return true;
+        case DXGI_FORMAT_BC6H_SF16: blockFormat = BlockFormat::BC6HSigned; return true;
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB: blockFormat = BlockFormat::BC7; return true;
+        default: return false;
+        }
+    }
+
+    bool GetBlockLayout(DXGI_FORMAT format, BlockLayout& layout)
+    {
+        std::size_t rowPitch;
+        uint32 rowCount;
+        if (!GetDdsSurfaceLayout(format, 4, 4, rowPitch, rowCount))
+            return false;
+        layout.compressed = GetBlockFormat(format, layout.format);
+        layout.size = layout.compressed ? 4 : 1;
+        layout.bytes = layout.compressed ? rowPitch : rowPitch / 4;
+        return true;
+    }
+
+    // 第mip级在一个slice的数据中的偏移
+    std::size_t MipOffset(const DdsImage& image, uint32 mip)
+    {
+        return GetDdsImageSize(image.format, image.width, image.height, mip, 1);
+    }
+
+    int Wrap(int value, int size)
+    {
+        return (value % size + size) % size;
+    }
+
+    int Clamp(int value, int size)
+    {
+        return (std::min)((std::max)(value, 0), size - 1);
+    }
+
+    std::size_t AddResource(TexturePackResult& result, const std::string& file, DdsImage image)
+    {
+        result.table.resources.push_back(file);
+        result.images.push_back(std::move(image));
+        return result.images.size() - 1;
+    }
+
+    struct AtlasCell
+    {
+        std::size_t source = 0;
+        uint32 width = 0;       // 包含两边的gutter
+        uint32 height = 0;
+        uint32 x = 0;
+        uint32 y = 0;
+    };
+
+    // cells已经按高度从大到小排列，逐行从左到右放置，放不下时换行。返回实际使用的宽高，超过maxSize时返回false
+    bool PlaceShelves(std::vector<AtlasCell>& cells, uint32 width, uint32 maxSize, uint32& usedWidth, uint32& usedHeight)
+    {
+        uint32 x = 0, y = 0, rowHeight = 0;
+        usedWidth = 0;
+        for (AtlasCell& cell : cells)
+        {
+            if (x > 0 && x + cell.width > width)
+            {
+                x = 0;
+                y += rowHeight;
+                rowHeight = 0;
+            }
+            cell.x = x;
+            cell.y = y;
+            x += cell.width;
+            rowHeight = (std::max)(rowHeight, cell.height);
+            usedWidth = (std::max)(usedWidth, x);
+        }
+        usedHeight = y + rowHeight;
+        return usedWidth <= maxSize && usedHeight <= maxSize;
+    }
+
+    // 依次尝试以最宽的cell、之后每个2的幂为行宽，取面积最小的，面积相同时取更接近正方形的
+    bool LayoutAtlas(std::vector<AtlasCell>& cells, uint32 maxSize, uint32& atlasWidth, uint32& atlasHeight)
+    {
+        std::stable_sort(cells.begin(), cells.end(), [](const AtlasCell& a, const AtlasCell& b)
+        {
+            return a.height != b.height ? a.height > b.height : a.width > b.width;
+        });
+        uint32 minWidth = 0;
+        for (const AtlasCell& cell : cells)
+            minWidth = (std::max)(minWidth, cell.width);
+
+        std::vector<uint32> widths = { minWidth };
+        for (uint32 width = 1; width <= maxSize; width *= 2)
+        {
+            if (width > minWidth)
+                widths.push_back(width);
+        }
+
+        bool found = false;
+        std::vector<AtlasCell> best;
+        for (uint32 width : widths)
+        {
+            uint32 usedWidth, usedHeight;
+            if (!PlaceShelves(cells, width, maxSize, usedWidth, usedHeight))
+                continue;
+            const std::uint64_t area = (std::uint64_t)usedWidth * usedHeight;
+            const std::uint64_t bestArea = (std::uint64_t)atlasWidth * atlasHeight;
+            if (!found || area < bestArea || (area == bestArea && (std::max)(usedWidth, usedHeight) < (std::max)(atlasWidth, atlasHeight)))
+            {
+                found = true;
+                best = cells;
+                atlasWidth = usedWidth;
+                atlasHeight = usedHeight;
+            }
+        }
+        if (found)
+            cells = best;
+        return found;
+    }
+
+    // 把source的第mip级连同四周gutter宽的边拷贝到atlas的(x, y)处，x、y、gutter和这一级的宽高都是块边长的倍数
+    void CopyWithGutter(const TexturePackSource& source, uint32 mip, const BlockLayout& layout, uint32 gutter,
+        uint8* atlas, std::size_t atlasRowPitch, uint32 x, uint32 y, const BlockCompressOptions& compressOptions)
+    {
+        const int width = (int)(source.image.width >> mip);
+        const int height = (int)(source.image.height >> mip);
+        const int size = (int)layout.size;
+        const std::size_t rowPitch = width / size * layout.bytes;
+        const uint8* pixels = source.image.data.data() + MipOffset(source.image, mip);
+        auto sourceBlock = [&](int blockX, int blockY) { return pixels + blockY * rowPitch + blockX * layout.bytes; };
+
+        const int blockCountX = (width + 2 * (int)gutter) / size;
+        const int blockCountY = (height + 2 * (int)gutter) / size;
+        for (int blockY = 0; blockY < blockCountY; ++blockY)
+        {
+            for (int blockX = 0; blockX < blockCountX; ++blockX)
+            {
+                // 这个块左上角在texture中的坐标，gutter中为负数或者超出宽高
+                const int sx = blockX * size - (int)gutter;
+                const int sy = blockY * size - (int)gutter;
+                uint8* destination = atlas + (y / size + blockY) * atlasRowPitch + (x / size + blockX) * layout.bytes;
+                const bool inside = sx >= 0 && sx < width && sy >= 0 && sy < height;
+                if (inside || source.wrap)
+                    std::memcpy(destination, sourceBlock(Wrap(sx, width) / size, Wrap(sy, height) / size), layout.bytes);
+                else if (!layout.compressed)
+                    std::memcpy(destination, sourceBlock(Clamp(sx, width), Clamp(sy, height)), layout.bytes);
+                else
+                {
+                    // clamp的gutter块：每个像素取最近的边缘像素，解码所在的块后重新编码
+                    uint8 rgba[64], decoded[64];
+                    int decodedX = -1, decodedY = -1;
+                    for (int j = 0; j < 4; ++j)
+                    {
+                        for (int i = 0; i < 4; ++i)
+                        {
+                            const int px = Clamp(sx + i, width), py = Clamp(sy + j, height);
+                            if (px / 4 != decodedX || py / 4 != decodedY)
+                            {
+                                decodedX = px / 4;
+                                decodedY = py / 4;
+                                DecompressBlock(layout.format, sourceBlock(decodedX, decodedY), decoded);
+                            }
+                            std::memcpy(rgba + (j * 4 + i) * 4, decoded + ((py % 4) * 4 + px % 4) * 4, 4);
+                        }
+                    }
+                    CompressBlock(layout.format, rgba, destination, compressOptions);
+                }
+            }
+        }
+    }
+
+    // members至少两个，都是同一格式。宽高不满足对齐的texture不放入atlas，放不下时返回false
+    bool PackAtlas(const std::vector<TexturePackSource>& sources, std::vector<std::size_t> members, const TexturePackOptions& options,
+        TexturePackResult& result, std::vector<bool>& packed)
+    {
+        const DXGI_FORMAT format = sources[members[0]].image.format;
+        BlockLayout layout;
+        GetBlockLayout(format, layout);
+
+        uint32 mipCount = (std::max)(options.atlasMipCount, 1u);
+        for (std::size_t index : members)
+            mipCount = (std::min)(mipCount, sources[index].image.mipCount);
+        // 最小的一级mip中gutter至少为一个块，所以mip 0中的gutter和位置都要对齐到alignment
+        const uint32 alignment = layout.size << (mipCount - 1);
+        members.erase(std::remove_if(members.begin(), members.end(), [&](std::size_t index)
+        {
+            const DdsImage& image = sources[index].image;
+            return image.width % alignment != 0 || image.height % alignment != 0;
+        }), members.end());
+        if (members.size() < 2)
+            return false;
+
+        std::vector<AtlasCell> cells;
+        for (std::size_t index : members)
+        {
+            AtlasCell cell;
+            cell.source = index;
+            cell.width = sources[index].image.width + 2 * alignment;
+            cell.height = sources[index].image.height + 2 * alignment;
+            cells.push_back(cell);
+        }
+        uint32 atlasWidth = 0, atlasHeight = 0;
+        if (!LayoutAtlas(cells, options.maxAtlasSize, atlasWidth, atlasHeight))
+            return false;
+
+        // 没有被cell覆盖的区域为0
+        DdsImage atlas;
+        atlas.format = format;
+        atlas.width = atlasWidth;
+        atlas.height = atlasHeight;
+        atlas.mipCount = mipCount;
+        atlas.data.resize(GetDdsImageSize(format, atlasWidth, atlasHeight, mipCount, 1));
+        for (uint32 mip = 0; mip < mipCount; ++mip)
+        {
+            std::size_t rowPitch;
+            uint32 rowCount;
+            GetDdsSurfaceLayout(format, atlasWidth >> mip, atlasHeight >> mip, rowPitch, rowCount);
+            uint8* level = atlas.data.data() + MipOffset(atlas, mip);
+            for (const AtlasCell& cell : cells)
+                CopyWithGutter(sources[cell.source], mip, layout, alignment >> mip, level, rowPitch, cell.x >> mip, cell.y >> mip, options.compressOptions);
+        }
+
+        const std::size_t resource = AddResource(result, sources[members[0]].name + "_atlas.dds", std::move(atlas));
+        for (const AtlasCell& cell : cells)
+        {
+            const DdsImage& image = sources[cell.source].image;
+            TexturePackEntry& entry = result.table.entries[cell.source];
+            entry.resource = (uint32)resource;
+            entry.uvScale[0] = (float)image.width / atlasWidth;
+            entry.uvScale[1] = (float)image.height / atlasHeight;
+            entry.uvOffset[0] = (float)(cell.x + alignment) / atlasWidth;
+            entry.uvOffset[1] = (float)(cell.y + alignment) / atlasHeight;
+            packed[cell.source] = true;
+        }
+        return true;
+    }
+}
+
+bool PackTextures(const std::vector<TexturePackSource>& sources, const TexturePackOptions& options, TexturePackResult& result, std::string& error)
+{
+    result = TexturePackResult();
+    result.table.entries.resize(sources.size());
+    for (std::size_t i = 0; i < sources.size(); ++i)
+    {
+        const TexturePackSource& source = sources[i];
+        BlockLayout layout;
+        if (source.name.empty() || !GetBlockLayout(source.image.format, layout))
+        {
+            error = "texture " + std::to_string(i) + " (" + source.name + "): unsupported format " + std::to_string((int)source.image.format);
+            return false;
+        }
+        for (std::size_t j = 0; j < i; ++j)
+        {
+            if (sources[j].name == source.name)
+            {
+                error = "duplicate texture name " + source.name;
+                return false;
+            }
+        }
+        result.table.entries[i].name = source.name;
+    }
+    std::vector<bool> packed(sources.size(), false);
+
+    // 格式、宽高、mip数都相同的texture合并为数组，数组按第一个texture出现的顺序排列
+    using ArrayKey = std::tuple<DXGI_FORMAT, uint32, uint32, uint32>;
+    std::map<ArrayKey, std::size_t> groupIndices;
+    std::vector<std::vector<std::size_t>> groups;
+    for (std::size_t i = 0; i < sources.size(); ++i)
+    {
+        const DdsImage& image = sources[i].image;
+        if (image.arraySize != 1)
+            continue;
+        const ArrayKey key(image.format, image.width, image.height, image.mipCount);
+        auto it = groupIndices.find(key);
+        if (it == groupIndices.end())
+        {
+            it = groupIndices.emplace(key, groups.size()).first;
+            groups.emplace_back();
+        }
+        groups[it->second].push_back(i);
+    }
+    for (const auto& group : groups)
+    {
+        if (group.size() < (std::max)(options.minArraySize, 2u))
+            continue;
+        DdsImage array = sources[group[0]].image;
+        array.arraySize = (uint32)group.size();
+        for (std::size_t i = 1; i < group.size(); ++i)
+            array.data.insert(array.data.end(), sources[group[i]].image.data.begin(), sources[group[i]].image.data.end());
+        const std::size_t resource = AddResource(result, sources[group[0]].name + "_array.dds", std::move(array));
+        for (std::size_t slice = 0; slice < group.size(); ++slice)
+        {
+            result.table.entries[group[slice]].resource = (uint32)resource;
+            result.table.entries[group[slice]].slice = (uint32)slice;
+            packed[group[slice]] = true;
+        }
+    }
+
+    // 剩下的texture按格式放入atlas，clamp的gutter需要重新编码，不能编码的BC格式只放wrap的texture
+    if (options.atlas)
+    {
+        std::vector<DXGI_FORMAT> formats;
+        for (std::size_t i = 0; i < sources.size(); ++i)
+        {
+            if (!packed[i] && std::find(formats.begin(), formats.end(), sources[i].image.format) == formats.end())
+                formats.push_back(sources[i].image.format);
+        }
+        for (DXGI_FORMAT format : formats)
+        {
+            BlockLayout layout;
+            GetBlockLayout(format, layout);
+            std::vector<std::size_t> members;
+            for (std::size_t i = 0; i < sources.size(); ++i)
+            {
+                const TexturePackSource& source = sources[i];
+                if (!packed[i] && source.image.format == format && source.image.arraySize == 1 &&
+                    (source.wrap || !layout.compressed || CanCompress(layout.format)))
+                    members.push_back(i);
+            }
+            if (members.size() >= 2)
+                PackAtlas(sources, members, options, result, packed);
+        }
+    }
+
+    // 其他texture单独作为一个resource
+    for (std::size_t i = 0; i < sources.size(); ++i)
+    {
+        if (!packed[i])
+            result.table.entries[i].resource = (uint32)AddResource(result, sources[i].name + ".dds", sources[i].image);
+    }
+    return true;
+}
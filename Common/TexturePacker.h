@@ -0,0 +1,41 @@
+#pragma once
+
+#include "BlockCompression.h"
+#include "TextureFile.h"
+#include "TexturePackTable.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 离线把多个texture合并为更少的resource，不依赖图形API（见Util/TexturePack）：
+// - 格式、宽高、mip数都相同的texture合并为Texture2DArray，按slice拼接，数据原样拷贝
+// - 剩下的同一格式的texture用shelf算法放进一张atlas，每个texture四周留gutter，过滤和降低mip时不会混入相邻texture的颜色
+// - 其他texture（格式只出现一次、宽高不满足atlas的对齐等）单独作为一个resource
+// atlas的第k级mip由每个texture自己的第k级mip拼成，位置和gutter的宽度都是(块的边长 << (atlas的mip数 - 1))的倍数，
+// 每一级中texture的边界都落在4x4块的边界上，所以BC数据可以按块原样拷贝，不会因为重新编码损失质量。
+// gutter按texture的寻址方式填充：wrap时为对边的块，同样原样拷贝；clamp时重复边缘的像素，BC格式需要重新编码这些块
+
+struct TexturePackSource
+{
+    std::string name;
+    DdsImage image;                 // 只合并arraySize为1的texture
+    bool wrap = true;               // 采样时的寻址方式，决定atlas中gutter的内容
+};
+
+struct TexturePackOptions
+{
+    std::uint32_t minArraySize = 2;         // 相同的texture至少有这么多个才合并为数组
+    bool atlas = true;
+    std::uint32_t atlasMipCount = 4;        // atlas最多保留的mip数，每多一级gutter和对齐都加倍
+    std::uint32_t maxAtlasSize = 4096;
+    BlockCompressOptions compressOptions;   // 编码clamp的gutter
+};
+
+struct TexturePackResult
+{
+    std::vector<DdsImage> images;           // 与table.resources一一对应
+    TexturePackTable table;                 // resources为建议的文件名，entries与sources的顺序相同
+};
+
+// sources中的名字不能重复，有不支持的格式时返回false
+bool PackTextures(const std::vector<TexturePackSource>& sources, const TexturePackOptions& options, TexturePackResult& result, std::string& error);
@@ -0,0 +1,195 @@
+#include "TextureResidency.h"
+#include <algorithm>
+#include <cassert>
+
+TextureResidencyManager::TextureResidencyManager(uint64 budget, uint32 idleFrames) :
+    m_budget(budget),
+    m_idleFrames(idleFrames)
+{
+}
+
+TextureResidencyManager::uint32 TextureResidencyManager::Register(const std::vector<uint64>& mipSizes, uint32 residentMip)
+{
+    assert(!mipSizes.empty() && residentMip < mipSizes.size());
+    uint32 id;
+    if (!m_freeIds.empty())
+    {
+        id = m_freeIds.back();
+        m_freeIds.pop_back();
+    }
+    else
+    {
+        id = (uint32)m_textures.size();
+        m_textures.emplace_back();
+    }
+
+    Entry& entry = m_textures[id];
+    entry = Entry();
+    entry.sizeFromMip.resize(mipSizes.size() + 1, 0);
+    for (size_t i = mipSizes.size(); i-- > 0;)
+        entry.sizeFromMip[i] = entry.sizeFromMip[i + 1] + mipSizes[i];
+    entry.residentMip = residentMip;
+    entry.targetMip = residentMip;
+    entry.registered = true;
+    m_residentBytes += SizeOf(entry, residentMip);
+    return id;
+}
+
+void TextureResidencyManager::Unregister(uint32 id)
+{
+    Entry& entry = m_textures[id];
+    assert(entry.registered);
+    m_residentBytes -= SizeOf(entry, entry.targetMip);
+    entry = Entry();
+    m_freeIds.push_back(id);
+    // 本帧已经Touch过的话从m_touched中去掉
+    m_touched.erase(std::remove(m_touched.begin(), m_touched.end(), id), m_touched.end());
+}
+
+void TextureResidencyManager::Touch(uint32 id, uint32 desiredMip)
+{
+    Entry& entry = m_textures[id];
+    assert(entry.registered);
+    desiredMip = (std::min)(desiredMip, GetMipCount(id) - 1);
+
+    ++m_frameStats.touchCount;
+    if (entry.residentMip <= desiredMip)
+        ++m_frameStats.hitCount;
+
+    // 一帧中多次用到时取最精细的要求
+    if (entry.lastUsedFrame != m_frame)
+    {
+        entry.lastUsedFrame = m_frame;
+        entry.desiredMip = desiredMip;
+        m_touched.push_back(id);
+    }
+    else
+        entry.desiredMip = (std::min)(entry.desiredMip, desiredMip);
+}
+
+void TextureResidencyManager::EndFrame(std::vector<Action>& actions)
+{
+    // 分辨率不够的texture先用其他texture腾出的空间提高，只降级至少m_idleFrames帧没有用到的texture
+    const uint64 protectFrame = m_frame >= m_idleFrames ? m_frame + 1 - (std::max)(m_idleFrames, 1u) : 0;
+    for (uint32 id : m_touched)
+    {
+        Entry& entry = m_textures[id];
+        if (entry.pending || entry.desiredMip >= entry.targetMip)
+            continue;
+
+        const uint64 currentBytes = SizeOf(entry, entry.targetMip);
+        Evict(SizeOf(entry, entry.desiredMip) - currentBytes, protectFrame, actions);
+
+        // 腾不出足够的空间时提高到放得下的最精细的mip
+        uint32 mip = entry.desiredMip;
+        while (mip < entry.targetMip && m_residentBytes - currentBytes + SizeOf(entry, mip) > m_budget)
+            ++mip;
+        if (mip == entry.targetMip)
+            continue;
+
+        Action action;
+        action.type = ActionType::Upgrade;
+        action.id = id;
+        action.firstMip = mip;
+        action.bytes = SizeOf(entry, mip) - currentBytes;
+        actions.push_back(action);
+
+        m_residentBytes += action.bytes;
+        entry.targetMip = mip;
+        entry.pending = true;
+        ++m_frameStats.upgradeCount;
+        m_frameStats.uploadedBytes += action.bytes;
+    }
+
+    // 预算变小或者动作失败后仍然超出预算时，先降级本帧没有用到的texture，不够再降级用到的
+    if (m_residentBytes > m_budget)
+        Evict(0, m_frame, actions);
+    if (m_residentBytes > m_budget)
+        Evict(0, NeverUsed, actions);
+
+    m_frameStats.frame = m_frame;
+    m_frameStats.residentBytes = m_residentBytes;
+    m_lastFrameStats = m_frameStats;
+
+    ++m_stats.frameCount;
+    m_stats.touchCount += m_frameStats.touchCount;
+    m_stats.hitCount += m_frameStats.hitCount;
+    m_stats.upgradeCount += m_frameStats.upgradeCount;
+    m_stats.downgradeCount += m_frameStats.downgradeCount;
+    m_stats.uploadedBytes += m_frameStats.uploadedBytes;
+    m_stats.evictedBytes += m_frameStats.evictedBytes;
+    m_stats.peakResidentBytes = (std::max)(m_stats.peakResidentBytes, m_residentBytes);
+
+    m_frameStats = FrameStats();
+    m_touched.clear();
+    ++m_frame;
+}
+
+void TextureResidencyManager::Complete(uint32 id, uint32 residentMip)
+{
+    Entry& entry = m_textures[id];
+    assert(entry.registered && entry.pending && residentMip < GetMipCount(id));
+    // 失败时实际大小和目标不同，之后的EndFrame会重新按预算调整
+    m_residentBytes = m_residentBytes - SizeOf(entry, entry.targetMip) + SizeOf(entry, residentMip);
+    entry.residentMip = residentMip;
+    entry.targetMip = residentMip;
+    entry.pending = false;
+}
+
+void TextureResidencyManager::Evict(uint64 extraBytes, uint64 protectFrame, std::vector<Action>& actions)
+{
+    if (m_residentBytes + extraBytes <= m_budget)
+        return;
+
+    // 可以降级的texture：没有正在执行的动作，不只剩最后一级mip。NeverUsed作为protectFrame时所有texture都可以降级
+    std::vector<uint32> candidates;
+    for (uint32 id = 0; id < (uint32)m_textures.size(); ++id)
+    {
+        const Entry& entry = m_textures[id];
+        if (!entry.registered || entry.pending || entry.targetMip + 1 >= GetMipCount(id))
+            continue;
+        if (protectFrame != NeverUsed && entry.lastUsedFrame != NeverUsed && entry.lastUsedFrame >= protectFrame)
+            continue;
+        candidates.push_back(id);
+    }
+
+    // 从来没用过的最先降级，其次是最久没用到的，同一帧用到的先降级大的
+    std::sort(candidates.begin(), candidates.end(), [this](uint32 a, uint32 b)
+    {
+        const Entry& ea = m_textures[a];
+        const Entry& eb = m_textures[b];
+        const uint64 frameA = ea.lastUsedFrame == NeverUsed ? 0 : ea.lastUsedFrame + 1;
+        const uint64 frameB = eb.lastUsedFrame == NeverUsed ? 0 : eb.lastUsedFrame + 1;
+        if (frameA != frameB)
+            return frameA < frameB;
+        const uint64 sizeA = SizeOf(ea, ea.targetMip);
+        const uint64 sizeB = SizeOf(eb, eb.targetMip);
+        return sizeA != sizeB ? sizeA > sizeB : a < b;
+    });
+
+    for (uint32 id : candidates)
+    {
+        if (m_residentBytes + extraBytes <= m_budget)
+            break;
+
+        // 一次降一级，只降到刚好满足预算
+        Entry& entry = m_textures[id];
+        const uint64 currentBytes = SizeOf(entry, entry.targetMip);
+        uint32 mip = entry.targetMip;
+        while (mip + 1 < GetMipCount(id) && m_residentBytes - currentBytes + SizeOf(entry, mip) + extraBytes > m_budget)
+            ++mip;
+
+        Action action;
+        action.type = ActionType::Downgrade;
+        action.id = id;
+        action.firstMip = mip;
+        action.bytes = currentBytes - SizeOf(entry, mip);
+        actions.push_back(action);
+
+        m_residentBytes -= action.bytes;
+        entry.targetMip = mip;
+        entry.pending = true;
+        ++m_frameStats.downgradeCount;
+        m_frameStats.evictedBytes += action.bytes;
+    }
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// texture的驻留策略，只根据每级mip的大小和最近一次使用的帧做决定，不依赖任何图形API：
+// - 绘制时对用到的texture调用Touch，记录这一帧用到了它以及需要的最精细的mip
+// - 每帧结束时调用EndFrame得到需要执行的动作：用到但分辨率不够的texture提高到需要的mip（Upgrade），
+//   总大小超过预算时把最久没有用到的texture降到更粗的mip（Downgrade），最多降到只剩最后一级mip。
+//   为了提高分辨率而降级其他texture时，只降级至少idleFrames帧没有用到的，避免几个texture轮流把对方挤出去
+// - 动作由调用者执行（例如重新创建只包含部分mip的texture），完成后调用Complete，在此之前这个texture不会产生新的动作
+// 预算按动作完成后的大小计算，执行中的动作已经计入。可以在CPU上用人工构造的访问序列测试，
+// FrameStats和Stats中记录命中率和每帧搬运的字节数。
+class TextureResidencyManager
+{
+public:
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    static const uint32 InvalidId = 0xffffffff;
+
+    enum class ActionType
+    {
+        Upgrade,        // 上传更精细的mip
+        Downgrade,      // 释放最精细的几级mip
+    };
+
+    struct Action
+    {
+        ActionType type = ActionType::Upgrade;
+        uint32 id = InvalidId;
+        uint32 firstMip = 0;            // 执行后驻留的最精细的mip
+        uint64 bytes = 0;               // 需要上传或可以释放的字节数
+    };
+
+    struct FrameStats
+    {
+        uint64 frame = 0;
+        uint32 touchCount = 0;          // 本帧Touch的次数
+        uint32 hitCount = 0;            // 其中已经驻留了需要的mip的次数
+        uint32 upgradeCount = 0;
+        uint32 downgradeCount = 0;
+        uint64 uploadedBytes = 0;       // 本帧的Upgrade需要上传的字节数
+        uint64 evictedBytes = 0;        // 本帧的Downgrade释放的字节数
+        uint64 residentBytes = 0;       // EndFrame之后所有texture的目标大小之和
+
+        float HitRate()const { return touchCount == 0 ? 1.0f : (float)hitCount / (float)touchCount; }
+    };
+
+    // 从创建开始的累计值
+    struct Stats
+    {
+        uint64 frameCount = 0;
+        uint64 touchCount = 0;
+        uint64 hitCount = 0;
+        uint64 upgradeCount = 0;
+        uint64 downgradeCount = 0;
+        uint64 uploadedBytes = 0;
+        uint64 evictedBytes = 0;
+        uint64 peakResidentBytes = 0;
+
+        float HitRate()const { return touchCount == 0 ? 1.0f : (float)hitCount / (float)touchCount; }
+        // 平均每帧上传和释放的字节数之和
+        double BytesMovedPerFrame()const { return frameCount == 0 ? 0.0 : (double)(uploadedBytes + evictedBytes) / (double)frameCount; }
+    };
+
+    explicit TextureResidencyManager(uint64 budget, uint32 idleFrames = 8);
+
+    // mipSizes[i]为第i级mip（包含所有array slice）占用的字节数，residentMip为当前驻留的最精细的mip，返回id
+    uint32 Register(const std::vector<uint64>& mipSizes, uint32 residentMip);
+    // 调用者需要保证这个texture没有正在执行的动作，或者不再关心它的结果
+    void Unregister(uint32 id);
+
+    // 本帧用到了这个texture，desiredMip为需要的最精细的mip
+    void Touch(uint32 id, uint32 desiredMip = 0);
+
+    // 结束当前帧，把需要执行的动作追加到actions中，同一个texture最多一个动作
+    void EndFrame(std::vector<Action>& actions);
+
+    // 动作执行完成，residentMip为实际驻留的最精细的mip，失败时传入原来的mip
+    void Complete(uint32 id, uint32 residentMip);
+
+    // 预算变小时在之后的EndFrame中降级
+    void SetBudget(uint64 budget) { m_budget = budget; }
+    uint64 GetBudget()const { return m_budget; }
+    // 所有texture的目标大小之和，包括执行中的动作
+    uint64 GetResidentBytes()const { return m_residentBytes; }
+
+    uint32 GetResidentMip(uint32 id)const { return m_textures[id].residentMip; }
+    uint32 GetMipCount(uint32 id)const { return (uint32)m_textures[id].sizeFromMip.size() - 1; }
+    bool IsPending(uint32 id)const { return m_textures[id].pending; }
+
+    uint64 GetFrame()const { return m_frame; }
+    const FrameStats& GetLastFrameStats()const { return m_lastFrameStats; }
+    const Stats& GetStats()const { return m_stats; }
+
+private:
+    static const uint64 NeverUsed = ~0ull;
+
+    struct Entry
+    {
+        std::vector<uint64> sizeFromMip;        // sizeFromMip[i]为第i级及之后所有mip的大小，最后一项为0
+        uint32 residentMip = 0;                 // 实际驻留的最精细的mip
+        uint32 targetMip = 0;                   // 动作完成后驻留的最精细的mip，没有动作时等于residentMip
+        uint32 desiredMip = 0;                  // 本帧Touch时需要的最精细的mip
+        uint64 lastUsedFrame = NeverUsed;
+        bool pending = false;
+        bool registered = false;
+    };
+
+    uint64 SizeOf(const Entry& entry, uint32 mip)const { return entry.sizeFromMip[mip]; }
+
+    // 从最久没有用到的texture开始降级，直到总大小加上extraBytes不超过预算，lastUsedFrame不小于protectFrame的texture不动
+    void Evict(uint64 extraBytes, uint64 protectFrame, std::vector<Action>& actions);
+
+    uint64 m_budget;
+    uint32 m_idleFrames;
+    uint64 m_residentBytes = 0;
+    uint64 m_frame = 0;
+    std::vector<Entry> m_textures;              // 下标为id
+    std::vector<uint32> m_freeIds;
+    std::vector<uint32> m_touched;              // 本帧第一次Touch的texture
+    FrameStats m_frameStats;
+    FrameStats m_lastFrameStats;
+    Stats m_stats;
+};
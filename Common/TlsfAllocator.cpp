@@ -0,0 +1,347 @@
+#include "TlsfAllocator.h"
+#include <algorithm>
+#include <cassert>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    using uint32 = TlsfAllocator::uint32;
+    using uint64 = TlsfAllocator::uint64;
+
+    // 最高位1的下标，value不能为0
+    inline uint32 FindLastSet(uint64 value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, value);
+        return (uint32)index;
+#else
+        return 63 - (uint32)__builtin_clzll(value);
+#endif
+    }
+
+    // 最低位1的下标，value不能为0
+    inline uint32 FindFirstSet(uint64 value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return (uint32)index;
+#else
+        return (uint32)__builtin_ctzll(value);
+#endif
+    }
+
+    inline uint64 AlignUp(uint64 value, uint64 alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+TlsfAllocator::TlsfAllocator(uint64 size, uint64 granularity) :
+    m_size(size & ~(granularity - 1)),
+    m_granularity(granularity)
+{
+    assert(granularity > 0 && (granularity & (granularity - 1)) == 0);
+
+    for (uint32 i = 0; i < FirstLevelCount; ++i)
+        for (uint32 j = 0; j < SecondLevelCount; ++j)
+            m_freeLists[i][j] = InvalidIndex;
+
+    // 初始时整段空间是一个空闲block
+    uint32 index = NewBlock();
+    m_blocks[index].offset = 0;
+    m_blocks[index].size = m_size;
+    if (m_size > 0)
+        InsertFreeBlock(index);
+}
+
+void TlsfAllocator::Mapping(uint64 size, uint32& firstLevel, uint32& secondLevel)const
+{
+    uint64 units = size / m_granularity;
+    if (units < SecondLevelCount)
+    {
+        // 小block线性映射到第0级
+        firstLevel = 0;
+        secondLevel = (uint32)units;
+    }
+    else
+    {
+        uint32 msb = FindLastSet(units);
+        firstLevel = msb - SecondLevelLog2 + 1;
+        secondLevel = (uint32)(units >> (msb - SecondLevelLog2)) ^ SecondLevelCount;
+    }
+}
+
+uint32 TlsfAllocator::FindFreeBlock(uint64 size)const
+{
+    // 向上取整到下一个二级区间，保证找到的链表中任意block都足够大
+    uint64 units = size / m_granularity;
+    if (units >= SecondLevelCount)
+    {
+        uint64 round = (1ull << (FindLastSet(units) - SecondLevelLog2)) - 1;
+        units += round;
+    }
+
+    uint32 firstLevel, secondLevel;
+    Mapping(units * m_granularity, firstLevel, secondLevel);
+    if (firstLevel >= FirstLevelCount)
+        return InvalidIndex;
+
+    uint32 secondMap = m_secondLevelBitmap[firstLevel] & (~0u << secondLevel);
+    if (secondMap == 0)
+    {
+        // 当前一级中没有合适的，去更大的一级中找
+        uint64 firstMap = firstLevel + 1 < 64 ? m_firstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+        if (firstMap == 0)
+            return InvalidIndex;
+
+        firstLevel = FindFirstSet(firstMap);
+        secondMap = m_secondLevelBitmap[firstLevel];
+    }
+    secondLevel = FindFirstSet(secondMap);
+
+    return m_freeLists[firstLevel][secondLevel];
+}
+
+void TlsfAllocator::InsertFreeBlock(uint32 index)
+{
+    Block& block = m_blocks[index];
+    uint32 firstLevel, secondLevel;
+    Mapping(block.size, firstLevel, secondLevel);
+
+    uint32 head = m_freeLists[firstLevel][secondLevel];
+    block.isFree = true;
+    block.prevFree = InvalidIndex;
+    block.nextFree = head;
+    if (head != InvalidIndex)
+        m_blocks[head].prevFree = index;
+    m_freeLists[firstLevel][secondLevel] = index;
+
+    m_firstLevelBitmap |= 1ull << firstLevel;
+    m_secondLevelBitmap[firstLevel] |= 1u << secondLevel;
+}
+
+void TlsfAllocator::RemoveFreeBlock(uint32 index)
+{
+    Block& block = m_blocks[index];
+    uint32 firstLevel, secondLevel;
+    Mapping(block.size, firstLevel, secondLevel);
+
+    if (block.prevFree != InvalidIndex)
+        m_blocks[block.prevFree].nextFree = block.nextFree;
+    else
+        m_freeLists[firstLevel][secondLevel] = block.nextFree;
+    if (block.nextFree != InvalidIndex)
+        m_blocks[block.nextFree].prevFree = block.prevFree;
+
+    if (m_freeLists[firstLevel][secondLevel] == InvalidIndex)
+    {
+        m_secondLevelBitmap[firstLevel] &= ~(1u << secondLevel);
+        if (m_secondLevelBitmap[firstLevel] == 0)
+            m_firstLevelBitmap &= ~(1ull << firstLevel);
+    }
+
+    block.isFree = false;
+    block.prevFree = InvalidIndex;
+    block.nextFree = InvalidIndex;
+}
+
+// 从index的block头部切出size大小，返回剩余部分的block（未加入空闲链表），没有剩余时返回InvalidIndex
+uint32 TlsfAllocator::SplitBlock(uint32 index, uint64 size)
+{
+    if (m_blocks[index].size <= size)
+        return InvalidIndex;
+
+    uint32 remainIndex = NewBlock();
+    Block& block = m_blocks[index];
+    Block& remain = m_blocks[remainIndex];
+    remain.offset = block.offset + size;
+    remain.size = block.size - size;
+    remain.prevPhysical = index;
+    remain.nextPhysical = block.nextPhysical;
+    if (block.nextPhysical != InvalidIndex)
+        m_blocks[block.nextPhysical].prevPhysical = remainIndex;
+    block.nextPhysical = remainIndex;
+    block.size = size;
+    return remainIndex;
+}
+
+// 和地址相邻的空闲block合并，返回合并后的block
+uint32 TlsfAllocator::MergeBlock(uint32 index)
+{
+    uint32 prev = m_blocks[index].prevPhysical;
+    if (prev != InvalidIndex && m_blocks[prev].isFree)
+    {
+        RemoveFreeBlock(prev);
+        m_blocks[prev].size += m_blocks[index].size;
+        m_blocks[prev].nextPhysical = m_blocks[index].nextPhysical;
+        if (m_blocks[index].nextPhysical != InvalidIndex)
+            m_blocks[m_blocks[index].nextPhysical].prevPhysical = prev;
+        DeleteBlock(index);
+        index = prev;
+    }
+
+    uint32 next = m_blocks[index].nextPhysical;
+    if (next != InvalidIndex && m_blocks[next].isFree)
+    {
+        RemoveFreeBlock(next);
+        m_blocks[index].size += m_blocks[next].size;
+        m_blocks[index].nextPhysical = m_blocks[next].nextPhysical;
+        if (m_blocks[next].nextPhysical != InvalidIndex)
+            m_blocks[m_blocks[next].nextPhysical].prevPhysical = index;
+        DeleteBlock(next);
+    }
+
+    return index;
+}
+
+uint32 TlsfAllocator::NewBlock()
+{
+    if (!m_unusedBlocks.empty())
+    {
+        uint32 index = m_unusedBlocks.back();
+        m_unusedBlocks.pop_back();
+        m_blocks[index] = Block();
+        return index;
+    }
+    m_blocks.emplace_back();
+    return (uint32)m_blocks.size() - 1;
+}
+
+void TlsfAllocator::DeleteBlock(uint32 index)
+{
+    m_blocks[index].size = 0;
+    m_unusedBlocks.push_back(index);
+}
+
+bool TlsfAllocator::Allocate(uint64 size, uint64 alignment, Allocation& allocation)
+{
+    allocation = Allocation();
+    if (size == 0)
+        return false;
+
+    alignment = std::max(alignment, m_granularity);
+    uint64 blockSize = AlignUp(size, m_granularity);
+
+    // 对齐要求大于粒度时，多申请alignment - granularity保证一定能放下
+    uint64 searchSize = blockSize + alignment - m_granularity;
+    if (searchSize > m_size)
+        return false;
+
+    uint32 index = FindFreeBlock(searchSize);
+    if (index == InvalidIndex)
+        return false;
+    RemoveFreeBlock(index);
+
+    // 头部因对齐空出来的部分重新放回空闲链表，前一个block一定不是空闲的，所以不用合并
+    uint64 padding = AlignUp(m_blocks[index].offset, alignment) - m_blocks[index].offset;
+    if (padding > 0)
+    {
+        uint32 alignedIndex = SplitBlock(index, padding);
+        InsertFreeBlock(index);
+        index = alignedIndex;
+    }
+
+    // 尾部剩余部分放回空闲链表
+    uint32 remainIndex = SplitBlock(index, blockSize);
+    if (remainIndex != InvalidIndex)
+        InsertFreeBlock(MergeBlock(remainIndex));
+
+    m_requestedSize += size;
+    ++m_allocationCount;
+
+    allocation.offset = m_blocks[index].offset;
+    allocation.size = size;
+    allocation.blockIndex = index;
+    return true;
+}
+
+void TlsfAllocator::Free(const Allocation& allocation)
+{
+    if (!allocation.IsValid())
+        return;
+
+    assert(allocation.blockIndex < m_blocks.size());
+    assert(!m_blocks[allocation.blockIndex].isFree);
+    assert(m_blocks[allocation.blockIndex].offset == allocation.offset);
+
+    m_requestedSize -= allocation.size;
+    --m_allocationCount;
+    InsertFreeBlock(MergeBlock(allocation.blockIndex));
+}
+
+TlsfAllocator::Stats TlsfAllocator::GetStats()const
+{
+    Stats stats;
+    stats.totalSize = m_size;
+    stats.requestedSize = m_requestedSize;
+    stats.allocationCount = m_allocationCount;
+
+    for (uint32 i = 0; i < FirstLevelCount; ++i)
+    {
+        for (uint32 j = 0; j < SecondLevelCount; ++j)
+        {
+            for (uint32 index = m_freeLists[i][j]; index != InvalidIndex; index = m_blocks[index].nextFree)
+            {
+                stats.freeSize += m_blocks[index].size;
+                stats.largestFreeBlock = std::max(stats.largestFreeBlock, m_blocks[index].size);
+                ++stats.freeBlockCount;
+            }
+        }
+    }
+    stats.usedSize = m_size - stats.freeSize;
+    return stats;
+}
+
+bool TlsfAllocator::Validate()const
+{
+    // 沿物理链表遍历，block必须首尾相接且不能有两个相邻的空闲block
+    uint64 offset = 0;
+    uint32 freeCount = 0, usedCount = 0;
+    uint32 index = m_size > 0 ? 0 : InvalidIndex;
+    while (index != InvalidIndex && m_blocks[index].prevPhysical != InvalidIndex)
+        index = m_blocks[index].prevPhysical;
+
+    uint32 prev = InvalidIndex;
+    for (; index != InvalidIndex; index = m_blocks[index].nextPhysical)
+    {
+        const Block& block = m_blocks[index];
+        if (block.offset != offset || block.size == 0 || block.prevPhysical != prev)
+            return false;
+        if (block.isFree && prev != InvalidIndex && m_blocks[prev].isFree)
+            return false;
+        block.isFree ? ++freeCount : ++usedCount;
+        offset += block.size;
+        prev = index;
+    }
+    if (offset != m_size || usedCount != m_allocationCount)
+        return false;
+
+    // 空闲链表中的block数量必须和物理链表一致，并且位图要对应
+    uint32 listedCount = 0;
+    for (uint32 i = 0; i < FirstLevelCount; ++i)
+    {
+        bool firstBit = (m_firstLevelBitmap >> i) & 1;
+        if (firstBit != (m_secondLevelBitmap[i] != 0))
+            return false;
+        for (uint32 j = 0; j < SecondLevelCount; ++j)
+        {
+            bool secondBit = (m_secondLevelBitmap[i] >> j) & 1;
+            if (secondBit != (m_freeLists[i][j] != InvalidIndex))
+                return false;
+            for (uint32 k = m_freeLists[i][j]; k != InvalidIndex; k = m_blocks[k].nextFree)
+            {
+                uint32 firstLevel, secondLevel;
+                Mapping(m_blocks[k].size, firstLevel, secondLevel);
+                if (!m_blocks[k].isFree || firstLevel != i || secondLevel != j)
+                    return false;
+                ++listedCount;
+            }
+        }
+    }
+    return listedCount == freeCount;
+}
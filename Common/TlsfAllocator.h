@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// TLSF(Two-Level Segregated Fit)分配器，只管理一段[0, size)的偏移量，不依赖任何图形API。
+// 上层用它在ID3D12Heap中划分placed resource的位置，也可以直接在CPU上做压力测试。
+class TlsfAllocator
+{
+public:
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    static const uint32 InvalidIndex = 0xffffffff;
+
+    // 一次分配的结果，Free时原样传回
+    struct Allocation
+    {
+        uint64 offset = 0;                  // 对齐后的起始偏移
+        uint64 size = 0;                    // 请求的大小
+        uint32 blockIndex = InvalidIndex;   // 内部block的下标
+
+        bool IsValid()const { return blockIndex != InvalidIndex; }
+    };
+
+    struct Stats
+    {
+        uint64 totalSize = 0;               // 管理的总大小
+        uint64 usedSize = 0;                // 已分配block的总大小（包含尾部取整）
+        uint64 requestedSize = 0;           // 用户请求的总大小
+        uint64 freeSize = 0;                // 空闲总大小
+        uint64 largestFreeBlock = 0;        // 最大的空闲block
+        uint32 allocationCount = 0;         // 当前分配的个数
+        uint32 freeBlockCount = 0;          // 空闲block的个数
+
+        // 外部碎片率：0表示所有空闲空间连续，越接近1越碎
+        float Fragmentation()const
+        {
+            return freeSize == 0 ? 0.0f : 1.0f - (float)largestFreeBlock / (float)freeSize;
+        }
+    };
+
+    // granularity为最小分配粒度，必须是2的幂
+    explicit TlsfAllocator(uint64 size, uint64 granularity = 256);
+
+    // alignment必须是2的幂，空间不足时返回false
+    bool Allocate(uint64 size, uint64 alignment, Allocation& allocation);
+    void Free(const Allocation& allocation);
+
+    Stats GetStats()const;
+    uint64 Size()const { return m_size; }
+    bool IsEmpty()const { return m_allocationCount == 0; }
+
+    // 检查内部链表和位图是否一致，用于fuzz测试
+    bool Validate()const;
+
+private:
+    static const uint32 SecondLevelLog2 = 5;
+    static const uint32 SecondLevelCount = 1 << SecondLevelLog2;
+    static const uint32 FirstLevelCount = 64 - SecondLevelLog2 + 1;
+
+    struct Block
+    {
+        uint64 offset = 0;
+        uint64 size = 0;
+        uint32 prevPhysical = InvalidIndex;     // 地址上相邻的block
+        uint32 nextPhysical = InvalidIndex;
+        uint32 prevFree = InvalidIndex;         // 同一个空闲链表中的block
+        uint32 nextFree = InvalidIndex;
+        bool isFree = false;
+    };
+
+    void Mapping(uint64 size, uint32& firstLevel, uint32& secondLevel)const;
+    uint32 FindFreeBlock(uint64 size)const;
+    void InsertFreeBlock(uint32 index);
+    void RemoveFreeBlock(uint32 index);
+    uint32 SplitBlock(uint32 index, uint64 size);
+    uint32 MergeBlock(uint32 index);
+    uint32 NewBlock();
+    void DeleteBlock(uint32 index);
+
+    uint64 m_size;
+    uint64 m_granularity;
+    uint64 m_requestedSize = 0;
+    uint32 m_allocationCount = 0;
+
+    std::vector<Block> m_blocks;
+    std::vector<uint32> m_unusedBlocks;         // m_blocks中可复用的下标
+
+    // 一级位图的每一位表示该级是否存在空闲block，二级位图同理
+    uint64 m_firstLevelBitmap = 0;
+    uint32 m_secondLevelBitmap[FirstLevelCount] = {};
+    uint32 m_freeLists[FirstLevelCount][SecondLevelCount];
+};
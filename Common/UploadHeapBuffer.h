@@ -10,7 +10,7 @@ public:
     {
         m_elementByteSize = sizeof(T);
 
-        // constant bufferÿԪأÿconstant bufferĴС 256byte 
+        // 如果是constant buffer，则每个元素（每个constant buffer）的大小与 256byte 对齐
         if (isConstantBuffer)
             m_elementByteSize = d3d12Util::CalcConstantBufferByteSize(sizeof(T));
 
@@ -40,6 +40,12 @@ public:
         return m_uploadHeapBuffer.Get();
     }
 
+    // 第elementIndex个元素的GPU地址，可以直接绑定为root CBV/SRV
+    D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress(UINT elementIndex)const
+    {
+        return m_uploadHeapBuffer->GetGPUVirtualAddress() + (UINT64)elementIndex * m_elementByteSize;
+    }
+
     void CopyData(int elementIndex, const T& data)
     {
         memcpy(&m_mappedData[elementIndex * m_elementByteSize], &data, sizeof(T));
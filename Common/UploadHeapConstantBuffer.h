@@ -11,7 +11,7 @@ public:
 
     }
 
-    // CBV
+    // 创建CBV
     void CreateConstantBufferView(ID3D12Device* device, const CD3DX12_CPU_DESCRIPTOR_HANDLE& cbvHeapHandle, const UINT index)
     {
         D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc;
@@ -0,0 +1,436 @@
+#include "UploadManager.h"
+#include <algorithm>
+
+namespace
+{
+    inline UINT64 AlignUp(UINT64 value, UINT64 alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    inline UINT GetSubresourceCount(const D3D12_RESOURCE_DESC& desc)
+    {
+        if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
+            return 1;
+        return desc.MipLevels * (desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : desc.DepthOrArraySize);
+    }
+
+    // 源数据与staging buffer的行间距相同时整个slice一次拷贝，否则逐行拷贝每行的有效数据，返回拷贝的字节数
+    UINT64 CopySubresource(BYTE* dest, const D3D12_SUBRESOURCE_FOOTPRINT& footprint, UINT numRows, UINT64 rowSize,
+        const D3D12_SUBRESOURCE_DATA& source)
+    {
+        if (numRows == 0)
+            return 0;
+
+        UINT64 copiedBytes = 0;
+        const UINT64 destSlicePitch = UINT64(footprint.RowPitch) * numRows;
+        for (UINT z = 0; z < footprint.Depth; ++z)
+        {
+            BYTE* destSlice = dest + destSlicePitch * z;
+            const BYTE* sourceSlice = static_cast<const BYTE*>(source.pData) + UINT64(source.SlicePitch) * z;
+            if (UINT64(source.RowPitch) == footprint.RowPitch)
+            {
+                const UINT64 size = UINT64(footprint.RowPitch) * (numRows - 1) + rowSize;
+                memcpy(destSlice, sourceSlice, (size_t)size);
+                copiedBytes += size;
+            }
+            else
+            {
+                for (UINT y = 0; y < numRows; ++y)
+                    memcpy(destSlice + UINT64(footprint.RowPitch) * y, sourceSlice + UINT64(source.RowPitch) * y, (size_t)rowSize);
+                copiedBytes += rowSize * numRows;
+            }
+        }
+        return copiedBytes;
+    }
+}
+
+UploadManager::UploadManager(ID3D12Device* device, UINT64 pageSize) :
+    m_device(device),
+    m_pageSize(pageSize)
+{
+}
+
+UploadManager::Page* UploadManager::AcquirePage(UINT64 size, UINT64 alignment)
+{
+    if (m_currentPage != nullptr && AlignUp(m_currentPage->offset, alignment) + size <= m_currentPage->size)
+        return m_currentPage;
+
+    // 当前page放不下，换一个空闲的page，已经写入的数据留在m_usedPages中等待提交
+    m_currentPage = nullptr;
+    for (auto it = m_freePages.begin(); it != m_freePages.end(); ++it)
+    {
+        if ((*it)->size >= size + alignment)
+        {
+            m_currentPage = *it;
+            m_freePages.erase(it);
+            break;
+        }
+    }
+
+    if (m_currentPage == nullptr)
+    {
+        // 超过page大小的数据单独创建一个足够大的page
+        auto page = std::make_unique<Page>();
+        page->size = AlignUp(std::max(m_pageSize, size + alignment), D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT);
+        ThrowIfFailed(m_device->CreateCommittedResource(
+            &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+            D3D12_HEAP_FLAG_NONE,
+            &CD3DX12_RESOURCE_DESC::Buffer(page->size),
+            D3D12_RESOURCE_STATE_GENERIC_READ,
+            nullptr,
+            IID_PPV_ARGS(&page->buffer)));
+
+        // upload heap上的buffer可以一直保持map状态
+        ThrowIfFailed(page->buffer->Map(0, nullptr, reinterpret_cast<void**>(&page->mappedData)));
+
+        ++m_stats.stagingPageCount;
+        m_stats.stagingBytes += page->size;
+        m_currentPage = page.get();
+        m_pages.push_back(std::move(page));
+    }
+
+    m_usedPages.push_back(m_currentPage);
+    return m_currentPage;
+}
+
+void* UploadManager::AllocateLocked(UINT64 size, UINT64 alignment, Page*& page, UINT64& stagingOffset)
+{
+    page = AcquirePage(size, alignment);
+    stagingOffset = AlignUp(page->offset, alignment);
+    page->offset = stagingOffset + size;
+    return page->mappedData + stagingOffset;
+}
+
+void* UploadManager::Allocate(UINT64 size, UINT64 alignment, ID3D12Resource*& stagingBuffer, UINT64& stagingOffset)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Page* page = nullptr;
+    void* mappedData = AllocateLocked(size, alignment, page, stagingOffset);
+    stagingBuffer = page->buffer.Get();
+    return mappedData;
+}
+
+void UploadManager::AddTransition(ID3D12Resource* resource, UINT subresource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after, bool isBuffer)
+{
+    // 同一个resource不能同时有整体的barrier和单个subresource的barrier，否则同一个subresource会被转换两次。
+    // 两者同时出现时把整体的转换拆成每个subresource各自的转换再合并
+    auto whole = m_pendingTransitions.end();
+    bool hasSingle = false;
+    for (auto it = m_pendingTransitions.begin(); it != m_pendingTransitions.end(); ++it)
+    {
+        if (it->resource != resource)
+            continue;
+        if (it->subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES)
+            whole = it;
+        else
+            hasSingle = true;
+    }
+
+    const bool overlaps = subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES ? hasSingle : whole != m_pendingTransitions.end();
+    if (!overlaps)
+    {
+        MergeTransition(resource, subresource, before, after, isBuffer);
+        return;
+    }
+
+    const UINT subresourceCount = GetSubresourceCount(resource->GetDesc());
+    if (whole != m_pendingTransitions.end())
+    {
+        const PendingTransition transition = *whole;
+        m_pendingTransitions.erase(whole);
+        for (UINT i = 0; i < subresourceCount; ++i)
+            MergeTransition(resource, i, transition.before, transition.after, transition.isBuffer);
+    }
+
+    if (subresource == D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES)
+    {
+        for (UINT i = 0; i < subresourceCount; ++i)
+            MergeTransition(resource, i, before, after, isBuffer);
+    }
+    else
+        MergeTransition(resource, subresource, before, after, isBuffer);
+}
+
+void UploadManager::MergeTransition(ID3D12Resource* resource, UINT subresource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after, bool isBuffer)
+{
+    // 同一个subresource的多次上传只需要一对barrier，保留第一次的before和最后一次的after
+    for (auto& transition : m_pendingTransitions)
+    {
+        if (transition.resource == resource && transition.subresource == subresource)
+        {
+            transition.after = after;
+            return;
+        }
+    }
+
+    PendingTransition transition;
+    transition.resource = resource;
+    transition.subresource = subresource;
+    transition.before = before;
+    transition.after = after;
+    transition.isBuffer = isBuffer;
+    m_pendingTransitions.push_back(transition);
+}
+
+void UploadManager::UploadBuffer(ID3D12Resource* dest, UINT64 destOffset, const void* data, UINT64 size,
+    D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter)
+{
+    PendingCopy copy;
+    Page* page = nullptr;
+    void* mappedData = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        mappedData = AllocateLocked(size, 4, page, copy.sourceOffset);
+        ++page->writerCount;
+    }
+
+    // 拷贝时不持有锁，其他线程可以同时分配和拷贝
+    memcpy(mappedData, data, (size_t)size);
+
+    copy.dest = dest;
+    copy.source = page->buffer.Get();
+    copy.destOffset = destOffset;
+    copy.size = size;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    --page->writerCount;
+    m_pendingCopies.push_back(copy);
+    AddTransition(dest, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, stateBefore, stateAfter, true);
+
+    ++m_stats.uploadCount;
+    m_stats.uploadedBytes += size;
+    m_stats.copiedBytes += size;
+}
+
+void UploadManager::GetTextureLayout(ID3D12Resource* dest, UINT firstSubresource, UINT numSubresources, UINT numSlices, TextureLayout& layout)const
+{
+    // 每个subresource在staging buffer中的排布，RowPitch按256字节对齐。
+    // 每个slice的subresource是连续的，分别计算后按512字节对齐依次排在一起
+    const UINT count = numSubresources * numSlices;
+    layout.subresources.resize(count);
+    layout.footprints.resize(count);
+    layout.numRows.resize(count);
+    layout.rowSizes.resize(count);
+    layout.totalSize = 0;
+    D3D12_RESOURCE_DESC desc = dest->GetDesc();
+    for (UINT slice = 0; slice < numSlices; ++slice)
+    {
+        const UINT first = firstSubresource + slice * desc.MipLevels;
+        const UINT index = slice * numSubresources;
+        UINT64 sliceSize = 0;
+        m_device->GetCopyableFootprints(&desc, first, numSubresources, 0, layout.footprints.data() + index, layout.numRows.data() + index,
+            layout.rowSizes.data() + index, &sliceSize);
+
+        const UINT64 sliceOffset = AlignUp(layout.totalSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+        for (UINT i = 0; i < numSubresources; ++i)
+        {
+            layout.subresources[index + i] = first + i;
+            layout.footprints[index + i].Offset += sliceOffset;
+        }
+        layout.totalSize = sliceOffset + sliceSize;
+    }
+}
+
+BYTE* UploadManager::BeginTextureUpload(const TextureLayout& layout, Page*& page, UINT64& stagingOffset)
+{
+    // 先按footprint预留准确大小的空间，每一行直接拷贝到它最终的对齐位置，不经过中间buffer
+    std::lock_guard<std::mutex> lock(m_mutex);
+    BYTE* mappedData = (BYTE*)AllocateLocked(layout.totalSize, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, page, stagingOffset);
+    ++page->writerCount;
+    return mappedData;
+}
+
+void UploadManager::EndTextureUpload(ID3D12Resource* dest, const TextureLayout& layout, Page* page, UINT64 stagingOffset,
+    bool written, UINT64 copiedBytes, D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    --page->writerCount;
+    if (!written)
+        return;
+
+    const UINT numSubresources = (UINT)layout.footprints.size();
+    for (UINT i = 0; i < numSubresources; ++i)
+    {
+        PendingCopy copy;
+        copy.dest = dest;
+        copy.source = page->buffer.Get();
+        copy.isTexture = true;
+        copy.subresource = layout.subresources[i];
+        copy.footprint = layout.footprints[i];
+        copy.footprint.Offset += stagingOffset;
+        m_pendingCopies.push_back(copy);
+    }
+
+    // 上传了所有subresource时用一个barrier转换整个resource（此时subresource一定是从0开始连续的）
+    if (numSubresources == GetSubresourceCount(dest->GetDesc()) && layout.subresources.front() == 0)
+        AddTransition(dest, D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES, stateBefore, stateAfter, false);
+    else
+    {
+        for (UINT i = 0; i < numSubresources; ++i)
+            AddTransition(dest, layout.subresources[i], stateBefore, stateAfter, false);
+    }
+
+    ++m_stats.uploadCount;
+    m_stats.uploadedBytes += layout.totalSize;
+    m_stats.copiedBytes += copiedBytes;
+}
+
+UINT64 UploadManager::UploadTexture(ID3D12Resource* dest, UINT firstSubresource, UINT numSubresources, const D3D12_SUBRESOURCE_DATA* data,
+    D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter)
+{
+    TextureLayout layout;
+    GetTextureLayout(dest, firstSubresource, numSubresources, 1, layout);
+    Page* page = nullptr;
+    UINT64 stagingOffset = 0;
+    BYTE* mappedData = BeginTextureUpload(layout, page, stagingOffset);
+
+    UINT64 copiedBytes = 0;
+    for (UINT i = 0; i < numSubresources; ++i)
+        copiedBytes += CopySubresource(mappedData + layout.footprints[i].Offset, layout.footprints[i].Footprint, layout.numRows[i],
+            layout.rowSizes[i], data[i]);
+
+    EndTextureUpload(dest, layout, page, stagingOffset, true, copiedBytes, stateBefore, stateAfter);
+    return copiedBytes;
+}
+
+bool UploadManager::UploadTexture(ID3D12Resource* dest, UINT firstSubresource, UINT numSubresources, UINT numSlices, const SubresourceReader& reader,
+    D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter, UINT64* copiedBytes)
+{
+    TextureLayout layout;
+    GetTextureLayout(dest, firstSubresource, numSubresources, numSlices, layout);
+    Page* page = nullptr;
+    UINT64 stagingOffset = 0;
+    BYTE* mappedData = BeginTextureUpload(layout, page, stagingOffset);
+
+    // 行间距相同时整个slice一次读取，否则逐行读取到对齐的位置
+    UINT64 readBytes = 0;
+    bool written = true;
+    const UINT count = (UINT)layout.subresources.size();
+    for (UINT i = 0; i < count && written; ++i)
+    {
+        const D3D12_SUBRESOURCE_FOOTPRINT& footprint = layout.footprints[i].Footprint;
+        const UINT numRows = layout.numRows[i];
+        const UINT64 rowSize = layout.rowSizes[i];
+        BYTE* subresourceData = mappedData + layout.footprints[i].Offset;
+        for (UINT z = 0; z < footprint.Depth && written && numRows > 0; ++z)
+        {
+            BYTE* destSlice = subresourceData + UINT64(footprint.RowPitch) * numRows * z;
+            const UINT64 sourceSlice = rowSize * numRows * z;
+            if (rowSize == footprint.RowPitch)
+                written = reader(i, sourceSlice, destSlice, rowSize * numRows);
+            else
+            {
+                for (UINT y = 0; y < numRows && written; ++y)
+                    written = reader(i, sourceSlice + rowSize * y, destSlice + UINT64(footprint.RowPitch) * y, rowSize);
+            }
+            readBytes += rowSize * numRows;
+        }
+    }
+
+    EndTextureUpload(dest, layout, page, stagingOffset, written, readBytes, stateBefore, stateAfter);
+    if (copiedBytes)
+        *copiedBytes = written ? readBytes : 0;
+    return written;
+}
+
+bool UploadManager::HasPendingUploads()const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_pendingCopies.empty();
+}
+
+UploadManager::Stats UploadManager::GetStats()const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void UploadManager::Flush(ID3D12GraphicsCommandList* commandList)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_pendingCopies.empty())
+        return;
+
+    // 所有目标一次性转换到COPY_DEST
+    std::vector<D3D12_RESOURCE_BARRIER> barriers;
+    barriers.reserve(m_pendingTransitions.size());
+    for (auto& transition : m_pendingTransitions)
+    {
+        if (transition.before != D3D12_RESOURCE_STATE_COPY_DEST && !transition.IsImplicit())
+            barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(transition.resource, transition.before, D3D12_RESOURCE_STATE_COPY_DEST,
+                transition.subresource));
+    }
+    if (!barriers.empty())
+    {
+        commandList->ResourceBarrier((UINT)barriers.size(), barriers.data());
+        ++m_stats.barrierCallCount;
+    }
+
+    for (auto& copy : m_pendingCopies)
+    {
+        if (copy.isTexture)
+        {
+            CD3DX12_TEXTURE_COPY_LOCATION dest(copy.dest, copy.subresource);
+            CD3DX12_TEXTURE_COPY_LOCATION source(copy.source, copy.footprint);
+            commandList->CopyTextureRegion(&dest, 0, 0, 0, &source, nullptr);
+        }
+        else
+            commandList->CopyBufferRegion(copy.dest, copy.destOffset, copy.source, copy.sourceOffset, copy.size);
+    }
+
+    // 再一次性转换到各自的最终状态
+    barriers.clear();
+    for (auto& transition : m_pendingTransitions)
+    {
+        if (transition.after != D3D12_RESOURCE_STATE_COPY_DEST && !transition.IsImplicit())
+            barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(transition.resource, D3D12_RESOURCE_STATE_COPY_DEST, transition.after,
+                transition.subresource));
+    }
+    if (!barriers.empty())
+    {
+        commandList->ResourceBarrier((UINT)barriers.size(), barriers.data());
+        ++m_stats.barrierCallCount;
+    }
+
+    m_pendingCopies.clear();
+    m_pendingTransitions.clear();
+}
+
+void UploadManager::RetireSubmitted(UINT64 fenceValue)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // 还有线程在拷贝，或者copy在Flush之后才加入的page留在m_usedPages中，它们的copy在之后的Flush中记录，等下一次RetireSubmitted时再回收
+    std::vector<Page*> writingPages;
+    for (Page* page : m_usedPages)
+    {
+        ID3D12Resource* buffer = page->buffer.Get();
+        bool hasPendingCopy = std::any_of(m_pendingCopies.begin(), m_pendingCopies.end(),
+            [buffer](const PendingCopy& copy) { return copy.source == buffer; });
+        if (page->writerCount > 0 || hasPendingCopy)
+        {
+            writingPages.push_back(page);
+            continue;
+        }
+        page->fenceValue = fenceValue;
+        m_retiredPages.push_back(page);
+    }
+    m_usedPages.swap(writingPages);
+    m_currentPage = nullptr;
+}
+
+void UploadManager::ReleaseCompleted(UINT64 completedFenceValue)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_retiredPages.begin(); it != m_retiredPages.end();)
+    {
+        if ((*it)->fenceValue <= completedFenceValue)
+        {
+            (*it)->offset = 0;
+            m_freePages.push_back(*it);
+            it = m_retiredPages.erase(it);
+        }
+        else
+            ++it;
+    }
+}
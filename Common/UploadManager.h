@@ -0,0 +1,135 @@
+#pragma once
+#include "d3d12Util.h"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// 把多个上传请求打包到共享的staging buffer（upload heap上的大buffer，称为page）中，
+// Flush时在同一个command list里一次性记录所有copy，barrier也合并成前后各一次ResourceBarrier调用。
+// staging page在记录它们的command list对应的fence完成后回收复用，不需要每个resource都创建一个upload buffer。
+// UploadBuffer、UploadTexture可以在工作线程中调用，数据拷贝到staging buffer时不持有锁，多个线程可以同时拷贝；
+// Flush、RetireSubmitted、ReleaseCompleted由提交command list的线程调用。
+class UploadManager
+{
+public:
+    struct Stats
+    {
+        UINT stagingPageCount = 0;          // 一共创建过的staging page数量
+        UINT64 stagingBytes = 0;            // 所有staging page的总大小
+        UINT64 uploadCount = 0;             // 上传请求的次数
+        UINT64 uploadedBytes = 0;           // 上传的数据量，包括texture行对齐的填充
+        UINT64 copiedBytes = 0;             // CPU拷贝到staging buffer的数据量，不包括填充
+        UINT barrierCallCount = 0;          // 调用ResourceBarrier的次数
+    };
+
+    UploadManager(ID3D12Device* device, UINT64 pageSize = 32 * 1024 * 1024);
+    UploadManager(const UploadManager& rhs) = delete;
+    UploadManager& operator=(const UploadManager& rhs) = delete;
+
+    // 数据立即拷贝到staging buffer中，data在调用后即可释放
+    // stateBefore/stateAfter为dest在copy前后的状态
+    void UploadBuffer(ID3D12Resource* dest, UINT64 destOffset, const void* data, UINT64 size,
+        D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter);
+    // 只上传部分subresource时barrier也只作用于这些subresource，其他subresource可以同时在别的queue上读取（例如streaming时已经上传的mip）。
+    // 返回CPU拷贝到staging buffer的字节数
+    UINT64 UploadTexture(ID3D12Resource* dest, UINT firstSubresource, UINT numSubresources, const D3D12_SUBRESOURCE_DATA* data,
+        D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter);
+
+    // 按需读取源数据：reader(index, offset, dest, size)把第index个上传的subresource中从offset开始的size字节写入dest，
+    // offset按行紧密排列计算（与dds文件中的排布相同）。数据直接写到staging buffer中的最终位置，例如从archive中边解压边写入。
+    // 上传numSlices个array slice中各自从firstSubresource开始的numSubresources个subresource（后面的slice依次加上MipLevels），
+    // index = slice * numSubresources + i。所有slice共用一次staging分配，reader返回false时整个上传都不记录copy，返回false
+    using SubresourceReader = std::function<bool(UINT index, UINT64 offset, void* dest, UINT64 size)>;
+    bool UploadTexture(ID3D12Resource* dest, UINT firstSubresource, UINT numSubresources, UINT numSlices, const SubresourceReader& reader,
+        D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter, UINT64* copiedBytes = nullptr);
+
+    // 预留一段已经映射的staging空间由调用者直接写入，返回写入地址，stagingBuffer和stagingOffset为其在staging buffer中的位置。
+    // 只能在提交command list的线程中调用，需要在下一次RetireSubmitted之前写完
+    void* Allocate(UINT64 size, UINT64 alignment, ID3D12Resource*& stagingBuffer, UINT64& stagingOffset);
+
+    bool HasPendingUploads()const;
+
+    // 在commandList中记录所有等待中的copy
+    void Flush(ID3D12GraphicsCommandList* commandList);
+    // Flush所用的command list提交后调用，传入之后Signal的fence值，此前使用的staging空间在该fence完成后才会复用
+    void RetireSubmitted(UINT64 fenceValue);
+    // 回收fence已完成的staging page
+    void ReleaseCompleted(UINT64 completedFenceValue);
+
+    Stats GetStats()const;
+
+private:
+    struct Page
+    {
+        ComPtr<ID3D12Resource> buffer;
+        BYTE* mappedData = nullptr;
+        UINT64 size = 0;
+        UINT64 offset = 0;                  // 下一次分配的起始位置
+        UINT64 fenceValue = 0;              // 最后一次使用该page的fence值
+        UINT writerCount = 0;               // 正在往page中拷贝数据的线程数，不为0时不能回收
+    };
+
+    struct PendingCopy
+    {
+        ID3D12Resource* dest = nullptr;
+        ID3D12Resource* source = nullptr;
+        UINT64 sourceOffset = 0;
+        UINT64 destOffset = 0;              // 只有buffer使用
+        UINT64 size = 0;                    // 只有buffer使用
+        bool isTexture = false;
+        UINT subresource = 0;
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+    };
+
+    struct PendingTransition
+    {
+        ID3D12Resource* resource = nullptr;
+        UINT subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        D3D12_RESOURCE_STATES before = D3D12_RESOURCE_STATE_COMMON;
+        D3D12_RESOURCE_STATES after = D3D12_RESOURCE_STATE_COMMON;
+        bool isBuffer = false;
+
+        // buffer在COMMON状态下被copy时隐式提升为COPY_DEST，ExecuteCommandLists结束后又衰减回COMMON，不需要barrier
+        bool IsImplicit()const
+        {
+            return isBuffer && before == D3D12_RESOURCE_STATE_COMMON && after == D3D12_RESOURCE_STATE_COMMON;
+        }
+    };
+
+    // 每个subresource在staging buffer中的排布
+    struct TextureLayout
+    {
+        std::vector<UINT> subresources;
+        std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints;
+        std::vector<UINT> numRows;
+        std::vector<UINT64> rowSizes;
+        UINT64 totalSize = 0;
+    };
+
+    Page* AcquirePage(UINT64 size, UINT64 alignment);
+    void GetTextureLayout(ID3D12Resource* dest, UINT firstSubresource, UINT numSubresources, UINT numSlices, TextureLayout& layout)const;
+    // 为texture预留staging空间并增加page的writerCount
+    BYTE* BeginTextureUpload(const TextureLayout& layout, Page*& page, UINT64& stagingOffset);
+    // 数据写完后调用，written为false时不记录copy
+    void EndTextureUpload(ID3D12Resource* dest, const TextureLayout& layout, Page* page, UINT64 stagingOffset,
+        bool written, UINT64 copiedBytes, D3D12_RESOURCE_STATES stateBefore, D3D12_RESOURCE_STATES stateAfter);
+    void* AllocateLocked(UINT64 size, UINT64 alignment, Page*& page, UINT64& stagingOffset);
+    void AddTransition(ID3D12Resource* resource, UINT subresource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after, bool isBuffer);
+    void MergeTransition(ID3D12Resource* resource, UINT subresource, D3D12_RESOURCE_STATES before, D3D12_RESOURCE_STATES after, bool isBuffer);
+
+    ID3D12Device* m_device;
+    UINT64 m_pageSize;
+    mutable std::mutex m_mutex;             // 保护下面所有成员
+
+    std::vector<std::unique_ptr<Page>> m_pages;
+    std::vector<Page*> m_freePages;         // 可以使用的page
+    std::vector<Page*> m_usedPages;         // 已经写入数据但还没提交的page
+    std::vector<Page*> m_retiredPages;      // 等待fence完成的page
+    Page* m_currentPage = nullptr;          // 当前正在写入的page
+
+    std::vector<PendingCopy> m_pendingCopies;
+    std::vector<PendingTransition> m_pendingTransitions;
+
+    Stats m_stats;
+};
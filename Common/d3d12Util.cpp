@@ -16,7 +16,7 @@ DxException::DxException(HRESULT hr, const std::wstring& functionName, const std
 
 std::wstring DxException::ToString()const
 {
-    // HRESULTֵȡ顣_com_errorҪinclude comdef.h
+    // 根据HRESULT值，获取错误详情。_com_error需要include comdef.h
     _com_error err(ErrorCode);
     std::wstring msg = err.ErrorMessage();
     return FunctionName + L" failed in " + Filename + L"; line " + std::to_wstring(LineNumber) + L"; error: " + msg;
@@ -24,21 +24,38 @@ std::wstring DxException::ToString()const
 
 ComPtr<ID3DBlob> d3d12Util::LoadBinary(const std::wstring& filename)
 {
-    std::ifstream fin(filename, std::ios::binary);
+    std::ifstream fin(filename, std::ios::binary | std::ios::ate);
+    if (!fin)
+        ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND));
 
-    fin.seekg(0, std::ios_base::end);
-    std::ifstream::pos_type size = (int)fin.tellg();
+    // tellg的结果不能截断为int，直接读到blob中
+    std::streamoff size = fin.tellg();
     fin.seekg(0, std::ios_base::beg);
 
     ComPtr<ID3DBlob> blob;
-    ThrowIfFailed(D3DCreateBlob(size, &blob));
+    ThrowIfFailed(D3DCreateBlob((SIZE_T)size, &blob));
 
-    fin.read((char*)blob->GetBufferPointer(), size);
-    fin.close();
+    if (!fin.read((char*)blob->GetBufferPointer(), (std::streamsize)size))
+        ThrowIfFailed(HRESULT_FROM_WIN32(ERROR_READ_FAULT));
 
     return blob;
 }
 
+D3D12_SHADER_BYTECODE d3d12Util::LoadShader(const ShaderArchive& archive, const std::wstring& filename, ShaderStage stage, ComPtr<ID3DBlob>& blob)
+{
+    // 打包时以文件名为key，文件名都是ASCII
+    std::string name;
+    for (wchar_t c : filename)
+        name += (char)c;
+
+    ShaderArchive::Bytecode bytecode;
+    if (archive.Find(HashShaderName(name), stage, bytecode))
+        return { bytecode.data, bytecode.size };
+
+    blob = LoadBinary(filename);
+    return { blob->GetBufferPointer(), blob->GetBufferSize() };
+}
+
 ComPtr<ID3D12Resource> d3d12Util::CreateDefaultHeapBuffer(ID3D12Device* device, ID3D12GraphicsCommandList* commandList, const void* data,
     const int size, ComPtr<ID3D12Resource>& uploadBuffer)
 {
@@ -59,22 +76,38 @@ ComPtr<ID3D12Resource> d3d12Util::CreateDefaultHeapBuffer(ID3D12Device* device,
         nullptr,
         IID_PPV_ARGS(&uploadBuffer)));
 
-    // ҪCPU
+    // 设置要传输的CPU数据
     D3D12_SUBRESOURCE_DATA subResourceData = {};
     subResourceData.pData = data;
     subResourceData.RowPitch = size;
     subResourceData.SlicePitch = subResourceData.RowPitch;
 
-    // ǰҪresourcestate
+    // 传输前要更改resource的state
     commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
-    // ȽCPUڴݿupload heapУȻͨID3D12CommandList::CopySubresourceRegionupload heapпdefault buffer
+    // 会先将CPU内存数据拷贝到upload heap中，然后再通过ID3D12CommandList::CopySubresourceRegion从upload heap中拷贝到default buffer中
     UpdateSubresources<1>(commandList, defaultBuffer.Get(), uploadBuffer.Get(), 0, 0, 1, &subResourceData);
     commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(defaultBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ));
 
     return defaultBuffer;
 }
 
-// WinPixGpuCapturer.dllPIXhttps://devblogs.microsoft.com/pix/taking-a-capture/
+ComPtr<ID3DBlob> d3d12Util::CompileShader(const std::wstring& filename, const D3D_SHADER_MACRO* defines,
+    const std::string& entrypoint, const std::string& target, UINT flags)
+{
+    ComPtr<ID3DBlob> byteCode;
+    ComPtr<ID3DBlob> errors;
+    // D3D_COMPILE_STANDARD_FILE_INCLUDE使#include相对于shader文件所在的目录
+    HRESULT hr = D3DCompileFromFile(filename.c_str(), defines, D3D_COMPILE_STANDARD_FILE_INCLUDE,
+        entrypoint.c_str(), target.c_str(), flags, 0, &byteCode, &errors);
+
+    if (errors != nullptr)
+        OutputDebugStringA((char*)errors->GetBufferPointer());
+    ThrowIfFailed(hr);
+
+    return byteCode;
+}
+
+// 加载WinPixGpuCapturer.dll，用于PIX。https://devblogs.microsoft.com/pix/taking-a-capture/
 std::wstring d3d12Util::GetLatestWinPixGpuCapturerPath()
 {
     LPWSTR programFilesPath = nullptr;
@@ -14,9 +14,11 @@
 #include <DirectXColors.h>
 #include <unordered_map>
 #include <array>
+#include <atomic>
 
 #include "MathUtil.h"
 #include "GeometryManager.h"
+#include "ShaderArchive.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -30,6 +32,11 @@ public:
     }
 
     static ComPtr<ID3DBlob> LoadBinary(const std::wstring& filename);
+    // 优先使用archive中以文件名为key的shader（不复制，archive销毁前有效），archive中没有时读取cso文件到blob中
+    static D3D12_SHADER_BYTECODE LoadShader(const ShaderArchive& archive, const std::wstring& filename, ShaderStage stage, ComPtr<ID3DBlob>& blob);
+    // 运行时编译shader，defines以{nullptr, nullptr}结尾，编译错误会输出到调试窗口
+    static ComPtr<ID3DBlob> CompileShader(const std::wstring& filename, const D3D_SHADER_MACRO* defines,
+        const std::string& entrypoint, const std::string& target, UINT flags);
     static ComPtr<ID3D12Resource> CreateDefaultHeapBuffer(ID3D12Device* device, ID3D12GraphicsCommandList* commandList, const void* data,
         const int size, ComPtr<ID3D12Resource>& uploadBuffer);
     static std::wstring GetLatestWinPixGpuCapturerPath();
@@ -50,7 +57,7 @@ public:
 };
 
 #ifndef ThrowIfFailed
-// ֵHRESULT < 0׳쳣
+// 如果返回值HRESULT < 0，抛出异常
 #define ThrowIfFailed(x)                                                    \
 {                                                                           \
     HRESULT hr__ = (x);                                                     \
@@ -58,40 +65,44 @@ public:
 }
 #endif
 
-// DrawIndexedInstancedӦĲ
+// DrawIndexedInstanced对应的参数
 struct Submesh
 {
-	UINT indexCount = 0;			// index
-	UINT startIndexLocation = 0;	// index bufferеʼλ
-	INT baseVertexLocation = 0;		// ƫ
+	UINT indexCount = 0;			// 物体的index数量
+	UINT startIndexLocation = 0;	// 在index buffer中的起始位置
+	INT baseVertexLocation = 0;		// 偏移量
 };
 
 struct Mesh
 {
 	std::string name;
 
-	// ±ϢCPUеڴ顣ʹʱʵǿתstd::vector<Vertex>std::vector<std::uint16_t>std::vector<std::uint32_t>
+	// 顶点和下标信息在CPU中的内存块。使用时，根据实际情况强转成std::vector<Vertex>、std::vector<std::uint16_t>、std::vector<std::uint32_t>等
 	ComPtr<ID3DBlob> vertexBufferCPU = nullptr;
 	ComPtr<ID3DBlob> indexBufferCPU = nullptr;
 
 	ComPtr<ID3D12Resource> vertexBufferGPU = nullptr;
 	ComPtr<ID3D12Resource> indexBufferGPU = nullptr;
 
-	// ͨUpload heapResourcecpuݴdefault heap
+	// 使用PlacedResourceAllocator时多个mesh共用一个buffer，记录在其中的偏移
+	UINT64 vertexBufferOffset = 0;
+	UINT64 indexBufferOffset = 0;
+
+	// 通过Upload heap里的Resource将cpu数据传到default heap中
 	ComPtr<ID3D12Resource> vertexBufferUploader = nullptr;
 	ComPtr<ID3D12Resource> indexBufferUploader = nullptr;
 
-	UINT vertexByteStride = 0;											// vertex bufferÿԪռõֽڴС
-	UINT vertexBufferSize = 0;											// vertex bufferܹռõֽڴС
-	DXGI_FORMAT indexFormat = DXGI_FORMAT_R16_UINT;						// index bufferÿԪصformatDXGI_FORMAT_R16_UINT  DXGI_FORMAT_R32_UINT
-	UINT indexBufferSize = 0;											// index bufferܹռõֽڴС
+	UINT vertexByteStride = 0;											// vertex buffer每个元素占用的字节大小
+	UINT vertexBufferSize = 0;											// vertex buffer总共占用的字节大小
+	DXGI_FORMAT indexFormat = DXGI_FORMAT_R16_UINT;						// index buffer中每个元素的format（DXGI_FORMAT_R16_UINT 或 DXGI_FORMAT_R32_UINT）
+	UINT indexBufferSize = 0;											// index buffer总共占用的字节大小
 
 	std::unordered_map<std::string, Submesh> drawArgs;
 
 	D3D12_VERTEX_BUFFER_VIEW GetVertexBufferView()const
 	{
 		D3D12_VERTEX_BUFFER_VIEW vbv;
-		vbv.BufferLocation = vertexBufferGPU->GetGPUVirtualAddress();
+		vbv.BufferLocation = vertexBufferGPU->GetGPUVirtualAddress() + vertexBufferOffset;
 		vbv.StrideInBytes = vertexByteStride;
 		vbv.SizeInBytes = vertexBufferSize;
 		return vbv;
@@ -100,13 +111,13 @@ struct Mesh
 	D3D12_INDEX_BUFFER_VIEW GetIndexBufferView()const
 	{
 		D3D12_INDEX_BUFFER_VIEW ibv;
-		ibv.BufferLocation = indexBufferGPU->GetGPUVirtualAddress();
+		ibv.BufferLocation = indexBufferGPU->GetGPUVirtualAddress() + indexBufferOffset;
 		ibv.Format = indexFormat;
 		ibv.SizeInBytes = indexBufferSize;
 		return ibv;
 	}
 
-	// upload heap䵽default deap󣬿Խupload heapеResourceͷŵ
+	// 从upload heap传输到default deap后，可以将upload heap中的Resource释放掉
 	void DisposeUploaders()
 	{
 		vertexBufferUploader = nullptr;
@@ -122,11 +133,14 @@ struct Material
     DirectX::XMFLOAT3 fresnelR0 = { 0.01f, 0.01f, 0.01f };
     float roughness = 0.25f;
 
-	// albedo texture±
+	// albedo texture的下标
 	int albedoTextureIndex = -1;
+	// texture打包为Texture2DArray或atlas后（见TexturePackTable.h），在其中的slice和UV区域，xy为缩放，zw为偏移
+	UINT albedoTextureSlice = 0;
+	DirectX::XMFLOAT4 albedoUvTransform = { 1.0f, 1.0f, 0.0f, 0.0f };
 };
 
-// constant buffer
+// 用作constant buffer
 struct MaterialConstant
 {
     DirectX::XMFLOAT4 albedo = { 1.0f, 1.0f, 1.0f, 1.0f };
@@ -134,22 +148,41 @@ struct MaterialConstant
     float roughness = 0.25f;
 };
 
+class AssetArchive;
+struct AssetArchiveEntry;
+
+// 异步加载时texture所处的阶段，见TextureLoader
+enum class TextureLoadState
+{
+	Unloaded = 0,
+	Queued,			// 等待工作线程读取文件
+	Staged,			// 数据已经拷贝到staging buffer中，等待在copy queue上提交
+	Uploading,		// copy已经提交，等待GPU完成
+	Resident,		// 可以在shader中使用
+	Failed,
+};
+
 struct Texture
 {
 	std::string name;
 	std::wstring fileName;
 	Microsoft::WRL::ComPtr<ID3D12Resource> resource = nullptr;
-	Microsoft::WRL::ComPtr<ID3D12Resource> uploader = nullptr;
+	std::atomic<TextureLoadState> loadState{ TextureLoadState::Unloaded };	// 工作线程会修改，在渲染线程中读取
+	std::atomic<UINT> residentMip{ 0 };	// 已经上传到GPU的最精细的mip，streaming时高层mip到达前SRV的ResourceMinLODClamp
+	UINT topMip = 0;	// resource的mip 0是dds文件中的第几级mip，residency manager降级后resource只包含低层mip
+	// 不为nullptr时从打包的archive中读取这个entry，不再打开fileName（见AssetArchive.h），archive在加载期间必须一直打开
+	const AssetArchive* archive = nullptr;
+	const AssetArchiveEntry* archiveEntry = nullptr;
 };
 
 #define MAX_LIGHT_COUNT 16
 
 struct Light
 {
-    DirectX::XMFLOAT3 strength;     // Light color
-    float falloffStart;             // point/spot light only
-    DirectX::XMFLOAT3 direction;    // directional/spot light only
-    float falloffEnd;               // point/spot light only
-    DirectX::XMFLOAT3 Position;     // point/spot light only
-    float spotPower;                // spot light only
+    DirectX::XMFLOAT3 strength = { 0.0f, 0.0f, 0.0f };  // Light color
+    float falloffStart = 0.0f;                          // point/spot light only
+    DirectX::XMFLOAT3 direction = { 0.0f, 0.0f, 0.0f }; // directional/spot light only
+    float falloffEnd = 0.0f;                            // point/spot light only
+    DirectX::XMFLOAT3 position = { 0.0f, 0.0f, 0.0f };  // point/spot light only
+    float spotPower = 0.0f;                             // spot light only
 };
\ No newline at end of file
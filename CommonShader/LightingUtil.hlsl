@@ -18,16 +18,16 @@ struct Light
 	float spotPower;	// spot light only
 };
 
-// ˥
+// 线性衰减
 float CalcAttenuation(float d, float falloffStart, float falloffEnd)
 {
-	// saturate(value) ȼ min(1.0f, max(0.0f, value))
+	// saturate(value) 等价于 min(1.0f, max(0.0f, value))
 	return saturate((falloffEnd - d) / (falloffEnd - falloffStart));
 }
 
 
-// ʹSchlickƷӦķ̣ڷЧӦĹռı
-// R0 = ((n - 1) / (n + 1)) ^ 2nΪ
+// 使用Schlick近似法对应的菲涅尔方程，求由于菲涅尔效应表面所反射的光线所占的比率
+// R0 = ((n - 1) / (n + 1)) ^ 2，n为折射率
 float3 SchlickFresnel(float3 R0, float3 normal, float3 lightVec)
 {
 	float cosIncidentAngle = saturate(dot(normal, lightVec));
@@ -42,12 +42,12 @@ float BlinnPhongNDF(float NdotH, float roughness)
 	float a = (2.0 / r2) - 2.0;
 	a = max(a, 1e-4f);
 
-	float normTerm = (a + 2.0) * (0.5 / PI);	// һ
+	float normTerm = (a + 2.0) * (0.5 / PI);	// 归一化因子
 	float specTerm = pow(NdotH, a);
 	return specTerm * normTerm;
 }
 
-// 㷴䵽Ĺ;淴ܺ͡
+// 计算反射到摄像机的光的总量，它是漫反射和镜面反射的总和。
 float3 BlinnPhong(float3 lightStrength, float3 lightVec, float3 normal, float3 toCamera, Material material)
 {
 	float roughness = material.perceptualRoughness * material.perceptualRoughness;
@@ -59,45 +59,45 @@ float3 BlinnPhong(float3 lightStrength, float3 lightVec, float3 normal, float3 t
 	return (material.albedo.rgb + specAlbedo) * lightStrength;
 }
 
-// ƽй
+// 平行光计算
 float3 ComputeDirectionalLight(Light light, Material material, float3 normal, float3 toCamera)
 {
 	float3 lightVec = -light.direction;
 
-	// LambertҶ
+	// Lambert的余弦定率
 	float ndotl = max(dot(lightVec, normal), 0.0f);
 	float3 lightStrength = light.strength * ndotl;
 
 	return BlinnPhong(lightStrength, lightVec, normal, toCamera, material);
 }
 
-// Դ
+// 点光源计算
 float3 ComputePointLight(Light light, Material material, float3 position, float3 normal, float3 toCamera)
 {
 	float3 lightVec = light.position - position;
-	// 浽Դľ
+	// 表面到点光源的距离
 	float d = length(lightVec);
-	// 볬falloffEndûй
+	// 距离超过falloffEnd，则没有光照
 	if (d > light.falloffEnd)
 		return 0.0f;
-	// һlightVec
+	// 归一化lightVec
 	lightVec /= d;
 	
-	// LambertҶ
+	// Lambert的余弦定率
 	float ndotl = max(dot(lightVec, normal), 0.0f);
 	float3 lightStrength = light.strength * ndotl;
 
-	// ݾǿȵ˥
+	// 根据距离计算光照强度的衰减
 	float att = CalcAttenuation(d, light.falloffStart, light.falloffEnd);
 	lightStrength *= att;
 
 	return BlinnPhong(lightStrength, lightVec, normal, toCamera, material);
 }
 
-// ۹Ƽ
+// 聚光灯计算
 float3 ComputeSpotLight(Light light, Material material, float3 position, float3 normal, float3 toCamera)
 {
-	// ͬԴ
+	// 同点光源计算
 	float3 lightVec = light.position - position;
 	float d = length(lightVec);
 	if (d > light.falloffEnd)
@@ -108,7 +108,7 @@ float3 ComputeSpotLight(Light light, Material material, float3 position, float3
 	float att = CalcAttenuation(d, light.falloffStart, light.falloffEnd);
 	lightStrength *= att;
 
-	// շļнǣǿȵ˥
+	// 根据与光照方向的夹角，计算光照强度的衰减
 	float spotFactor = pow(max(dot(-lightVec, light.direction), 0.0f), light.spotPower);
 	lightStrength *= spotFactor;
 
@@ -0,0 +1,444 @@
+//--------------------------------------------------------------------------------------
+// File: DDSTextureCatalog.cpp
+//
+// Functions for describing DDS textures from their headers alone
+//--------------------------------------------------------------------------------------
+
+#include "DDSTextureCatalog.h"
+
+#include "pch.h"
+#include "DDS.h"
+#include "LoaderHelpers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+using namespace DirectX;
+using namespace DirectX::LoaderHelpers;
+
+namespace
+{
+    //--------------------------------------------------------------------------------------
+    // Same header rules and hardware bounds as CreateTextureFromDDS12
+    HRESULT GetDDSResourceDesc(
+        _In_ const DDS_HEADER* header,
+        _In_opt_ const DDS_HEADER_DXT10* d3d10ext,
+        _Out_ D3D12_RESOURCE_DESC& desc,
+        _Out_ bool& isCubeMap) noexcept
+    {
+        desc = {};
+        isCubeMap = false;
+
+        UINT width = header->width;
+        UINT height = header->height;
+        UINT depth = header->depth;
+
+        D3D12_RESOURCE_DIMENSION resDim = D3D12_RESOURCE_DIMENSION_UNKNOWN;
+        UINT arraySize = 1;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+
+        size_t mipCount = header->mipMapCount;
+        if (0 == mipCount) mipCount = 1;
+
+        if (d3d10ext)
+        {
+            arraySize = d3d10ext->arraySize;
+            if (arraySize == 0)
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+            switch (d3d10ext->dxgiFormat)
+            {
+            case DXGI_FORMAT_AI44:
+            case DXGI_FORMAT_IA44:
+            case DXGI_FORMAT_P8:
+            case DXGI_FORMAT_A8P8:
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            default:
+                if (BitsPerPixel(d3d10ext->dxgiFormat) == 0)
+                    return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            }
+
+            format = d3d10ext->dxgiFormat;
+
+            switch (d3d10ext->resourceDimension)
+            {
+            case D3D11_RESOURCE_DIMENSION_TEXTURE1D:
+                if ((header->flags & DDS_HEIGHT) && height != 1)
+                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                height = depth = 1;
+                resDim = D3D12_RESOURCE_DIMENSION_TEXTURE1D;
+                break;
+
+            case D3D11_RESOURCE_DIMENSION_TEXTURE2D:
+                if (d3d10ext->miscFlag & D3D11_RESOURCE_MISC_TEXTURECUBE)
+                {
+                    arraySize *= 6;
+                    isCubeMap = true;
+                }
+                depth = 1;
+                resDim = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+                break;
+
+            case D3D11_RESOURCE_DIMENSION_TEXTURE3D:
+                if (!(header->flags & DDS_HEADER_FLAGS_VOLUME))
+                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                if (arraySize > 1)
+                    return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+                resDim = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+                break;
+
+            default:
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            }
+        }
+        else
+        {
+            format = GetDXGIFormat(header->ddspf);
+
+            if (format == DXGI_FORMAT_UNKNOWN)
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+            if (header->flags & DDS_HEADER_FLAGS_VOLUME)
+                resDim = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+            else
+            {
+                if (header->caps2 & DDS_CUBEMAP)
+                {
+                    if ((header->caps2 & DDS_CUBEMAP_ALLFACES) != DDS_CUBEMAP_ALLFACES)
+                        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+                    arraySize = 6;
+                    isCubeMap = true;
+                }
+
+                depth = 1;
+                resDim = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+            }
+        }
+
+        // Bound sizes (for security purposes we don't trust DDS file metadata larger than the D3D 11.x hardware requirements)
+        if (mipCount > D3D12_REQ_MIP_LEVELS)
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+        switch (resDim)
+        {
+        case D3D12_RESOURCE_DIMENSION_TEXTURE1D:
+            if ((arraySize > D3D12_REQ_TEXTURE1D_ARRAY_AXIS_DIMENSION) ||
+                (width > D3D12_REQ_TEXTURE1D_U_DIMENSION))
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            break;
+
+        case D3D12_RESOURCE_DIMENSION_TEXTURE2D:
+            if (isCubeMap)
+            {
+                // This is the right bound because we set arraySize to (NumCubes*6) above
+                if ((arraySize > D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION) ||
+                    (width > D3D12_REQ_TEXTURECUBE_DIMENSION) ||
+                    (height > D3D12_REQ_TEXTURECUBE_DIMENSION))
+                    return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            }
+            else if ((arraySize > D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION) ||
+                (width > D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION) ||
+                (height > D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION))
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            break;
+
+        default:
+            if ((arraySize > 1) ||
+                (width > D3D12_REQ_TEXTURE3D_U_V_OR_W_DIMENSION) ||
+                (height > D3D12_REQ_TEXTURE3D_U_V_OR_W_DIMENSION) ||
+                (depth > D3D12_REQ_TEXTURE3D_U_V_OR_W_DIMENSION))
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            break;
+        }
+
+        if (width == 0 || height == 0 || depth == 0)
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+        desc.Dimension = resDim;
+        desc.Width = width;
+        desc.Height = height;
+        desc.DepthOrArraySize = static_cast<UINT16>((resDim == D3D12_RESOURCE_DIMENSION_TEXTURE3D) ? depth : arraySize);
+        desc.MipLevels = static_cast<UINT16>(mipCount);
+        desc.Format = format;
+        desc.SampleDesc.Count = 1;
+        desc.SampleDesc.Quality = 0;
+        desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+        desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+        return S_OK;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Reads at most DDS_CATALOG_HEADER_SIZE bytes from the start of the file
+    HRESULT ReadDDSHeader(
+        _In_z_ const wchar_t* fileName,
+        _Out_writes_bytes_(DDS_CATALOG_HEADER_SIZE) uint8_t* headerData,
+        _Out_ size_t& headerSize,
+        _Out_ uint64_t& fileSize) noexcept
+    {
+        headerSize = 0;
+        fileSize = 0;
+
+    #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+        ScopedHandle hFile(safe_handle(CreateFile2(
+            fileName,
+            GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING,
+            nullptr)));
+    #else
+        ScopedHandle hFile(safe_handle(CreateFileW(
+            fileName,
+            GENERIC_READ, FILE_SHARE_READ,
+            nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+            nullptr)));
+    #endif
+
+        if (!hFile)
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        FILE_STANDARD_INFO fileInfo;
+        if (!GetFileInformationByHandleEx(hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        fileSize = static_cast<uint64_t>(fileInfo.EndOfFile.QuadPart);
+        const DWORD bytesToRead = static_cast<DWORD>((std::min)(fileSize, static_cast<uint64_t>(DDS_CATALOG_HEADER_SIZE)));
+        DWORD bytesRead = 0;
+        if (!ReadFile(hFile.get(), headerData, bytesToRead, &bytesRead, nullptr))
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        if (bytesRead < bytesToRead)
+            return E_FAIL;
+
+        headerSize = bytesRead;
+        return S_OK;
+    }
+}
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+const DDSCatalogEntry* DDSTextureCatalog::Find(const wchar_t* fileName) const noexcept
+{
+    for (const DDSCatalogEntry& entry : entries)
+    {
+        if (entry.fileName == fileName)
+            return &entry;
+    }
+    return nullptr;
+}
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::GetDDSTextureLayout(
+    const uint8_t* headerData,
+    size_t headerSize,
+    uint64_t fileSize,
+    DDSCatalogEntry& entry,
+    std::vector<DDSCatalogSubresource>& subresources)
+{
+    entry.status = E_FAIL;
+    entry.fileSize = fileSize;
+    entry.desc = {};
+    entry.isCubeMap = false;
+    entry.firstSubresource = static_cast<uint32_t>(subresources.size());
+    entry.subresourceCount = 0;
+
+    if (!headerData)
+        return entry.status = E_INVALIDARG;
+
+    // LoadTextureDataFromMemory validates the magic, the header sizes and the presence of the DX10 extension
+    const DDS_HEADER* header = nullptr;
+    const uint8_t* bitData = nullptr;
+    size_t bitSize = 0;
+    HRESULT hr = LoadTextureDataFromMemory(headerData, headerSize, &header, &bitData, &bitSize);
+    if (FAILED(hr))
+        return entry.status = hr;
+
+    const bool hasDXT10Header = (header->ddspf.flags & DDS_FOURCC) && (MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC);
+    const auto d3d10ext = hasDXT10Header ? reinterpret_cast<const DDS_HEADER_DXT10*>(headerData + sizeof(uint32_t) + sizeof(DDS_HEADER)) : nullptr;
+    hr = GetDDSResourceDesc(header, d3d10ext, entry.desc, entry.isCubeMap);
+    if (FAILED(hr))
+        return entry.status = hr;
+
+    const D3D12_RESOURCE_DESC& desc = entry.desc;
+    const size_t arraySize = (desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D) ? 1u : desc.DepthOrArraySize;
+    const size_t depth = (desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D) ? desc.DepthOrArraySize : 1u;
+
+    // Walk the subresources in file order like FillInitData12, without reading them
+    uint64_t offset = static_cast<uint64_t>(bitData - headerData);
+    try
+    {
+        subresources.reserve(subresources.size() + arraySize * desc.MipLevels);
+        for (size_t j = 0; j < arraySize; j++)
+        {
+            size_t w = static_cast<size_t>(desc.Width);
+            size_t h = desc.Height;
+            size_t d = depth;
+            for (size_t i = 0; i < desc.MipLevels; i++)
+            {
+                size_t NumBytes = 0;
+                size_t RowBytes = 0;
+                size_t NumRows = 0;
+                hr = GetSurfaceInfo(w, h, desc.Format, &NumBytes, &RowBytes, &NumRows);
+                if (FAILED(hr))
+                    break;
+
+                if (NumBytes > UINT32_MAX || RowBytes > UINT32_MAX || NumRows > UINT32_MAX)
+                {
+                    hr = HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW);
+                    break;
+                }
+
+                const uint64_t size = static_cast<uint64_t>(NumBytes) * d;
+                if (offset + size > fileSize)
+                {
+                    hr = HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+                    break;
+                }
+
+                DDSCatalogSubresource subresource = {};
+                subresource.offset = offset;
+                subresource.rowPitch = static_cast<uint32_t>(RowBytes);
+                subresource.numRows = static_cast<uint32_t>(NumRows);
+                subresource.slicePitch = static_cast<uint32_t>(NumBytes);
+                subresource.depth = static_cast<uint32_t>(d);
+                subresources.push_back(subresource);
+                offset += size;
+
+                w = w >> 1;
+                h = h >> 1;
+                d = d >> 1;
+                if (w == 0)
+                    w = 1;
+                if (h == 0)
+                    h = 1;
+                if (d == 0)
+                    d = 1;
+            }
+            if (FAILED(hr))
+                break;
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        hr = E_OUTOFMEMORY;
+    }
+
+    if (FAILED(hr))
+    {
+        subresources.resize(entry.firstSubresource);
+        return entry.status = hr;
+    }
+
+    entry.subresourceCount = static_cast<uint32_t>(subresources.size() - entry.firstSubresource);
+    return entry.status = S_OK;
+}
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::BuildDDSTextureCatalog(
+    const std::vector<std::wstring>& fileNames,
+    DDSTextureCatalog& catalog,
+    unsigned int threadCount)
+{
+    catalog = DDSTextureCatalog();
+
+    try
+    {
+        // Every file only costs an open and one small read, so the latency of many files overlaps on the threads
+        const size_t fileCount = fileNames.size();
+        std::vector<std::vector<DDSCatalogSubresource>> fileSubresources(fileCount);
+        catalog.entries.resize(fileCount);
+
+        std::atomic<size_t> nextFile(0);
+        auto scan = [&]()
+        {
+            for (;;)
+            {
+                const size_t index = nextFile++;
+                if (index >= fileCount)
+                    return;
+
+                DDSCatalogEntry& entry = catalog.entries[index];
+                uint8_t headerData[DDS_CATALOG_HEADER_SIZE];
+                size_t headerSize = 0;
+                uint64_t fileSize = 0;
+                const HRESULT hr = ReadDDSHeader(fileNames[index].c_str(), headerData, headerSize, fileSize);
+                if (SUCCEEDED(hr))
+                {
+                    try
+                    {
+                        GetDDSTextureLayout(headerData, headerSize, fileSize, entry, fileSubresources[index]);
+                    }
+                    catch (const std::bad_alloc&)
+                    {
+                        entry.status = E_OUTOFMEMORY;
+                    }
+                }
+                else
+                    entry.status = hr;
+            }
+        };
+
+        if (threadCount == 0)
+            threadCount = std::thread::hardware_concurrency();
+        const size_t workerCount = (std::min)(static_cast<size_t>((std::max)(threadCount, 1u)), fileCount);
+        std::vector<std::thread> workers;
+        for (size_t i = 1; i < workerCount; ++i)
+            workers.emplace_back(scan);
+        scan();
+        for (auto& worker : workers)
+            worker.join();
+
+        // Pack the subresources back to back in file order
+        for (size_t index = 0; index < fileCount; ++index)
+        {
+            DDSCatalogEntry& entry = catalog.entries[index];
+            entry.fileName = fileNames[index];
+            entry.firstSubresource = static_cast<uint32_t>(catalog.subresources.size());
+            catalog.subresources.insert(catalog.subresources.end(), fileSubresources[index].begin(), fileSubresources[index].end());
+        }
+    }
+    catch (const std::bad_alloc&)
+    {
+        catalog = DDSTextureCatalog();
+        return E_OUTOFMEMORY;
+    }
+
+    return S_OK;
+}
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::BuildDDSTextureCatalogFromDirectory(
+    const wchar_t* directory,
+    DDSTextureCatalog& catalog,
+    unsigned int threadCount)
+{
+    catalog = DDSTextureCatalog();
+
+    if (!directory)
+        return E_INVALIDARG;
+
+    std::wstring folder(directory);
+    if (!folder.empty() && folder.back() != L'\\' && folder.back() != L'/')
+        folder += L'\\';
+
+    std::vector<std::wstring> fileNames;
+    WIN32_FIND_DATAW findData = {};
+    HANDLE hFind = FindFirstFileExW((folder + L"*.dds").c_str(), FindExInfoBasic, &findData, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (hFind == INVALID_HANDLE_VALUE)
+    {
+        const DWORD error = GetLastError();
+        return (error == ERROR_FILE_NOT_FOUND) ? S_OK : HRESULT_FROM_WIN32(error);
+    }
+
+    do
+    {
+        if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+            fileNames.push_back(folder + findData.cFileName);
+    } while (FindNextFileW(hFind, &findData));
+    FindClose(hFind);
+
+    std::sort(fileNames.begin(), fileNames.end());
+    return BuildDDSTextureCatalog(fileNames, catalog, threadCount);
+}
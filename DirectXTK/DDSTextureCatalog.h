@@ -0,0 +1,88 @@
+//--------------------------------------------------------------------------------------
+// File: DDSTextureCatalog.h
+//
+// Functions for describing DDS textures from their headers alone
+//
+// CreateDDSTextureFromFile12 reads the whole file before it knows the format, size and
+// mip count. The catalog reads only the magic, DDS_HEADER and DDS_HEADER_DXT10 of every
+// file, validates them with the same rules as the loader, and records the resource desc
+// and the file offset of every subresource (from LoaderHelpers::GetSurfaceInfo), so the
+// renderer can create all resources up front and fill them in the background.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "../Direct3D12Headers/d3d12.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace DirectX
+{
+    // One subresource in the file, in D3D12CalcSubresource order (mip + slice * MipLevels)
+    struct DDSCatalogSubresource
+    {
+        uint64_t offset;        // in bytes from the start of the file
+        uint32_t rowPitch;      // bytes per row, or per row of 4x4 blocks; rows are tightly packed in the file
+        uint32_t numRows;
+        uint32_t slicePitch;    // rowPitch * numRows, one depth slice
+        uint32_t depth;
+    };
+
+    struct DDSCatalogEntry
+    {
+        std::wstring fileName;
+        HRESULT status = E_PENDING;         // the fields below are only valid when this succeeded
+        uint64_t fileSize = 0;
+
+        // What CreateDDSTextureFromFile12 creates without maxsize: no flags, one sample, unknown layout.
+        // DepthOrArraySize counts six faces per cube.
+        D3D12_RESOURCE_DESC desc = {};
+        bool isCubeMap = false;
+
+        uint32_t firstSubresource = 0;      // in DDSTextureCatalog::subresources
+        uint32_t subresourceCount = 0;
+    };
+
+    struct DDSTextureCatalog
+    {
+        std::vector<DDSCatalogEntry> entries;
+        std::vector<DDSCatalogSubresource> subresources;    // all entries, packed back to back
+
+        // Compares the full file name, nullptr if the file was not scanned
+        const DDSCatalogEntry* Find(_In_z_ const wchar_t* fileName) const noexcept;
+
+        const DDSCatalogSubresource* GetSubresources(const DDSCatalogEntry& entry) const noexcept
+        {
+            return subresources.data() + entry.firstSubresource;
+        }
+    };
+
+    // Size of the header block to read from the start of a DDS file: magic, DDS_HEADER and DDS_HEADER_DXT10
+    constexpr size_t DDS_CATALOG_HEADER_SIZE = 4 + 124 + 20;
+
+    // Fills entry (except fileName) and appends its subresources from the first bytes of a DDS file.
+    // headerData may be shorter than DDS_CATALOG_HEADER_SIZE when the file is; fileSize is the size of the whole file
+    // and must cover every subresource, otherwise HRESULT_FROM_WIN32(ERROR_HANDLE_EOF) is returned.
+    HRESULT __cdecl GetDDSTextureLayout(
+        _In_reads_bytes_(headerSize) const uint8_t* headerData,
+        _In_ size_t headerSize,
+        _In_ uint64_t fileSize,
+        _Inout_ DDSCatalogEntry& entry,
+        _Inout_ std::vector<DDSCatalogSubresource>& subresources);
+
+    // Reads only the headers, on threadCount threads (0 for std::thread::hardware_concurrency). Entries keep the order
+    // of fileNames; a file that cannot be opened or fails validation keeps its error in DDSCatalogEntry::status
+    // and has no subresources.
+    HRESULT __cdecl BuildDDSTextureCatalog(
+        _In_ const std::vector<std::wstring>& fileNames,
+        _Out_ DDSTextureCatalog& catalog,
+        _In_ unsigned int threadCount = 0);
+
+    // Every *.dds file directly in directory, sorted by name
+    HRESULT __cdecl BuildDDSTextureCatalogFromDirectory(
+        _In_z_ const wchar_t* directory,
+        _Out_ DDSTextureCatalog& catalog,
+        _In_ unsigned int threadCount = 0);
+}
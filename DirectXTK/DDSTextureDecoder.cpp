@@ -0,0 +1,500 @@
+//--------------------------------------------------------------------------------------
+// File: DDSTextureDecoder.cpp
+//
+// Functions for expanding a DDS texture into RGBA8 or RGBA16F on the CPU, without a device
+//--------------------------------------------------------------------------------------
+
+#include "DDSTextureDecoder.h"
+
+#include "pch.h"
+#include "DDS.h"
+#include "LoaderHelpers.h"
+
+#include "../Common/BlockCompression.h"
+#include "../Common/MappedFile.h"
+
+using namespace DirectX;
+using namespace DirectX::LoaderHelpers;
+
+namespace
+{
+    enum class SourceKind
+    {
+        Block,
+        RGBA8,
+        BGRA8,
+        BGRX8,
+        RGBA16F,
+    };
+
+    //--------------------------------------------------------------------------------------
+    bool GetSourceKind(DXGI_FORMAT format, SourceKind& kind, BlockFormat& blockFormat) noexcept
+    {
+        kind = SourceKind::Block;
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+            blockFormat = BlockFormat::BC1;
+            return true;
+
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+            blockFormat = BlockFormat::BC2;
+            return true;
+
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+            blockFormat = BlockFormat::BC3;
+            return true;
+
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+            blockFormat = BlockFormat::BC4;
+            return true;
+
+        case DXGI_FORMAT_BC4_SNORM:
+            blockFormat = BlockFormat::BC4Signed;
+            return true;
+
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+            blockFormat = BlockFormat::BC5;
+            return true;
+
+        case DXGI_FORMAT_BC5_SNORM:
+            blockFormat = BlockFormat::BC5Signed;
+            return true;
+
+        case DXGI_FORMAT_BC6H_TYPELESS:
+        case DXGI_FORMAT_BC6H_UF16:
+            blockFormat = BlockFormat::BC6HUnsigned;
+            return true;
+
+        case DXGI_FORMAT_BC6H_SF16:
+            blockFormat = BlockFormat::BC6HSigned;
+            return true;
+
+        case DXGI_FORMAT_BC7_TYPELESS:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            blockFormat = BlockFormat::BC7;
+            return true;
+
+        case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            kind = SourceKind::RGBA8;
+            return true;
+
+        case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            kind = SourceKind::BGRA8;
+            return true;
+
+        case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+            kind = SourceKind::BGRX8;
+            return true;
+
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            kind = SourceKind::RGBA16F;
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    // One depth slice of a subresource in the DDS file
+    struct SourceSurface
+    {
+        const uint8_t* bits;
+        size_t rowPitch;
+        size_t slicePitch;
+    };
+
+    //--------------------------------------------------------------------------------------
+    // Byte to half, through the sRGB curve for sRGB sources. Alpha is always linear.
+    void BuildHalfTable(bool srgb, uint16_t table[256]) noexcept
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            const float value = float(i) / 255.0f;
+            if (srgb)
+                table[i] = FloatToHalf(value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f));
+            else
+                table[i] = FloatToHalf(value);
+        }
+    }
+
+    uint8_t HalfToUnorm8(uint16_t value) noexcept
+    {
+        const float f = HalfToFloat(value);
+        // NaN goes to 0 like the hardware conversion
+        if (!(f > 0.0f))
+            return 0;
+        if (f >= 1.0f)
+            return 255;
+        return static_cast<uint8_t>(f * 255.0f + 0.5f);
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Expands one depth slice of one subresource. source has the layout returned by GetSurfaceInfo.
+    void DecodeSlice(
+        SourceKind kind,
+        BlockFormat blockFormat,
+        bool srgb,
+        DDS_DECODE_FORMAT outputFormat,
+        const uint8_t* source,
+        size_t sourceRowBytes,
+        uint32_t width,
+        uint32_t height,
+        uint8_t* output,
+        size_t rowPitch,
+        unsigned int threadCount,
+        std::vector<uint8_t>& scratch)
+    {
+        const bool half = (outputFormat == DDS_DECODE_RGBA16F);
+
+        if (kind == SourceKind::Block)
+        {
+            if (!half)
+            {
+                DecompressImage(blockFormat, source, width, height, output, rowPitch, threadCount);
+                return;
+            }
+
+            if (!srgb)
+            {
+                DecompressImageHalf(blockFormat, source, width, height, reinterpret_cast<uint16_t*>(output), rowPitch, threadCount);
+                return;
+            }
+
+            // sRGB blocks are expanded to bytes first so the curve can be applied with a table
+            scratch.resize(size_t(width) * height * 4);
+            DecompressImage(blockFormat, source, width, height, scratch.data(), size_t(width) * 4, threadCount);
+            source = scratch.data();
+            sourceRowBytes = size_t(width) * 4;
+            kind = SourceKind::RGBA8;
+        }
+
+        if (kind == SourceKind::RGBA16F)
+        {
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                auto sptr = reinterpret_cast<const uint16_t*>(source + y * sourceRowBytes);
+                uint8_t* dptr = output + y * rowPitch;
+                if (half)
+                {
+                    memcpy(dptr, sptr, size_t(width) * 8);
+                    continue;
+                }
+                for (size_t i = 0; i < size_t(width) * 4; ++i)
+                    dptr[i] = HalfToUnorm8(sptr[i]);
+            }
+            return;
+        }
+
+        // 8-bit sources: RGBA8, BGRA8 or BGRX8
+        const bool swizzle = (kind != SourceKind::RGBA8);
+        const bool opaque = (kind == SourceKind::BGRX8);
+
+        uint16_t colorTable[256];
+        uint16_t alphaTable[256];
+        if (half)
+        {
+            BuildHalfTable(srgb, colorTable);
+            BuildHalfTable(false, alphaTable);
+        }
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const uint8_t* sptr = source + y * sourceRowBytes;
+            uint8_t* dptr = output + y * rowPitch;
+            if (!half && !swizzle)
+            {
+                memcpy(dptr, sptr, size_t(width) * 4);
+                continue;
+            }
+
+            auto hptr = reinterpret_cast<uint16_t*>(dptr);
+            for (uint32_t x = 0; x < width; ++x, sptr += 4)
+            {
+                const uint8_t r = swizzle ? sptr[2] : sptr[0];
+                const uint8_t g = sptr[1];
+                const uint8_t b = swizzle ? sptr[0] : sptr[2];
+                const uint8_t a = opaque ? 255 : sptr[3];
+                if (half)
+                {
+                    hptr[x * 4 + 0] = colorTable[r];
+                    hptr[x * 4 + 1] = colorTable[g];
+                    hptr[x * 4 + 2] = colorTable[b];
+                    hptr[x * 4 + 3] = alphaTable[a];
+                }
+                else
+                {
+                    dptr[x * 4 + 0] = r;
+                    dptr[x * 4 + 1] = g;
+                    dptr[x * 4 + 2] = b;
+                    dptr[x * 4 + 3] = a;
+                }
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------------------
+    HRESULT DecodeDDS(
+        _In_ const DDS_HEADER* header,
+        _In_reads_bytes_(bitSize) const uint8_t* bitData,
+        _In_ size_t bitSize,
+        _In_ DDS_DECODE_FORMAT outputFormat,
+        _Out_ DDSDecodedTexture& texture,
+        _In_ unsigned int threadCount)
+    {
+        UINT width = header->width;
+        UINT height = header->height;
+        UINT depth = header->depth;
+
+        D3D12_RESOURCE_DIMENSION resDim = D3D12_RESOURCE_DIMENSION_UNKNOWN;
+        UINT arraySize = 1;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        bool isCubeMap = false;
+
+        size_t mipCount = header->mipMapCount;
+        if (0 == mipCount) mipCount = 1;
+
+        // Same header rules as CreateTextureFromDDS12
+        if ((header->ddspf.flags & DDS_FOURCC) && (MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC))
+        {
+            auto d3d10ext = reinterpret_cast<const DDS_HEADER_DXT10*>((const char*)header + sizeof(DDS_HEADER));
+
+            arraySize = d3d10ext->arraySize;
+            if (arraySize == 0)
+                return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+            format = d3d10ext->dxgiFormat;
+
+            switch (d3d10ext->resourceDimension)
+            {
+            case D3D11_RESOURCE_DIMENSION_TEXTURE1D:
+                if ((header->flags & DDS_HEIGHT) && height != 1)
+                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                height = depth = 1;
+                resDim = D3D12_RESOURCE_DIMENSION_TEXTURE1D;
+                break;
+
+            case D3D11_RESOURCE_DIMENSION_TEXTURE2D:
+                if (d3d10ext->miscFlag & D3D11_RESOURCE_MISC_TEXTURECUBE)
+                {
+                    arraySize *= 6;
+                    isCubeMap = true;
+                }
+                depth = 1;
+                resDim = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+                break;
+
+            case D3D11_RESOURCE_DIMENSION_TEXTURE3D:
+                if (!(header->flags & DDS_HEADER_FLAGS_VOLUME))
+                    return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+                if (arraySize > 1)
+                    return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+                resDim = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+                break;
+
+            default:
+                return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+            }
+        }
+        else
+        {
+            format = GetDXGIFormat(header->ddspf);
+
+            if (header->flags & DDS_HEADER_FLAGS_VOLUME)
+                resDim = D3D12_RESOURCE_DIMENSION_TEXTURE3D;
+            else
+            {
+                if (header->caps2 & DDS_CUBEMAP)
+                {
+                    if ((header->caps2 & DDS_CUBEMAP_ALLFACES) != DDS_CUBEMAP_ALLFACES)
+                        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+                    arraySize = 6;
+                    isCubeMap = true;
+                }
+
+                depth = 1;
+                resDim = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+            }
+        }
+
+        SourceKind kind;
+        BlockFormat blockFormat = BlockFormat::BC1;
+        if (!GetSourceKind(format, kind, blockFormat))
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+        // Bound sizes (for security purposes we don't trust DDS file metadata larger than the D3D 11.x hardware requirements)
+        if (mipCount > D3D12_REQ_MIP_LEVELS ||
+            arraySize > D3D12_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION ||
+            width > D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION ||
+            height > D3D12_REQ_TEXTURE2D_U_OR_V_DIMENSION ||
+            depth > D3D12_REQ_TEXTURE3D_U_V_OR_W_DIMENSION)
+            return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+        if (width == 0 || height == 0 || depth == 0)
+            return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+        const bool srgb = (MakeLinear(format) != format);
+        const size_t pixelSize = (outputFormat == DDS_DECODE_RGBA16F) ? 8u : 4u;
+
+        texture.sourceFormat = format;
+        if (outputFormat == DDS_DECODE_RGBA16F)
+            texture.format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+        else
+            texture.format = srgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+        texture.dimension = resDim;
+        texture.width = width;
+        texture.height = height;
+        texture.depth = depth;
+        texture.mipCount = static_cast<uint32_t>(mipCount);
+        texture.arraySize = arraySize;
+        texture.isCubeMap = isCubeMap;
+        texture.subresources.clear();
+        texture.pixels.clear();
+
+        // First pass walks the source with GetSurfaceInfo to validate it and lay out the output
+        size_t outputSize = 0;
+        const uint8_t* pSrcBits = bitData;
+        const uint8_t* pEndBits = bitData + bitSize;
+        std::vector<SourceSurface> sources;
+        try
+        {
+            texture.subresources.reserve(mipCount * arraySize);
+            sources.reserve(mipCount * arraySize);
+
+            for (size_t j = 0; j < arraySize; j++)
+            {
+                size_t w = width;
+                size_t h = height;
+                size_t d = depth;
+                for (size_t i = 0; i < mipCount; i++)
+                {
+                    size_t NumBytes = 0;
+                    size_t RowBytes = 0;
+                    HRESULT hr = GetSurfaceInfo(w, h, format, &NumBytes, &RowBytes, nullptr);
+                    if (FAILED(hr))
+                        return hr;
+
+                    if (NumBytes > UINT32_MAX || RowBytes > UINT32_MAX)
+                        return HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW);
+
+                    if (pSrcBits + (NumBytes * d) > pEndBits)
+                        return HRESULT_FROM_WIN32(ERROR_HANDLE_EOF);
+
+                    DDSDecodedSubresource subresource = {};
+                    subresource.offset = outputSize;
+                    subresource.rowPitch = w * pixelSize;
+                    subresource.slicePitch = subresource.rowPitch * h;
+                    subresource.width = static_cast<uint32_t>(w);
+                    subresource.height = static_cast<uint32_t>(h);
+                    subresource.depth = static_cast<uint32_t>(d);
+                    texture.subresources.push_back(subresource);
+                    sources.push_back({ pSrcBits, RowBytes, NumBytes });
+
+                    outputSize += subresource.slicePitch * d;
+                    pSrcBits += NumBytes * d;
+
+                    w = w >> 1;
+                    h = h >> 1;
+                    d = d >> 1;
+                    if (w == 0)
+                        w = 1;
+                    if (h == 0)
+                        h = 1;
+                    if (d == 0)
+                        d = 1;
+                }
+            }
+
+            texture.pixels.resize(outputSize);
+
+            std::vector<uint8_t> scratch;
+            for (size_t index = 0; index < texture.subresources.size(); ++index)
+            {
+                const DDSDecodedSubresource& subresource = texture.subresources[index];
+                const SourceSurface& source = sources[index];
+                for (uint32_t slice = 0; slice < subresource.depth; ++slice)
+                {
+                    DecodeSlice(kind, blockFormat, srgb, outputFormat,
+                        source.bits + slice * source.slicePitch, source.rowPitch,
+                        subresource.width, subresource.height,
+                        texture.pixels.data() + subresource.offset + slice * subresource.slicePitch, subresource.rowPitch,
+                        threadCount, scratch);
+                }
+            }
+        }
+        catch (const std::bad_alloc&)
+        {
+            return E_OUTOFMEMORY;
+        }
+
+        return S_OK;
+    }
+}
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::DecodeDDSTextureFromMemory(
+    const uint8_t* ddsData,
+    size_t ddsDataSize,
+    DDS_DECODE_FORMAT outputFormat,
+    DDSDecodedTexture& texture,
+    unsigned int threadCount)
+{
+    texture = DDSDecodedTexture();
+
+    if (!ddsData)
+        return E_INVALIDARG;
+
+    if (outputFormat != DDS_DECODE_RGBA8 && outputFormat != DDS_DECODE_RGBA16F)
+        return E_INVALIDARG;
+
+    const DDS_HEADER* header = nullptr;
+    const uint8_t* bitData = nullptr;
+    size_t bitSize = 0;
+
+    HRESULT hr = LoadTextureDataFromMemory(ddsData, ddsDataSize, &header, &bitData, &bitSize);
+    if (FAILED(hr))
+        return hr;
+
+    hr = DecodeDDS(header, bitData, bitSize, outputFormat, texture, threadCount);
+    if (FAILED(hr))
+        texture = DDSDecodedTexture();
+
+    return hr;
+}
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::DecodeDDSTextureFromFile(
+    const wchar_t* fileName,
+    DDS_DECODE_FORMAT outputFormat,
+    DDSDecodedTexture& texture,
+    unsigned int threadCount)
+{
+    texture = DDSDecodedTexture();
+
+    if (!fileName)
+        return E_INVALIDARG;
+
+    MappedFile ddsFile;
+    if (!ddsFile.Open(std::wstring(fileName)))
+        return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+
+    return DecodeDDSTextureFromMemory(static_cast<const uint8_t*>(ddsFile.GetData()), ddsFile.GetSize(),
+        outputFormat, texture, threadCount);
+}
@@ -0,0 +1,75 @@
+//--------------------------------------------------------------------------------------
+// File: DDSTextureDecoder.h
+//
+// Functions for expanding a DDS texture into RGBA8 or RGBA16F on the CPU, without a device
+//
+// Used to diff textures in CI, generate thumbnails and upload BC textures on devices
+// that lack support for the format. The header is parsed with the same rules as
+// DDSTextureLoader and the source layout comes from LoaderHelpers::GetSurfaceInfo.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include "../Direct3D12Headers/d3d12.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace DirectX
+{
+    enum DDS_DECODE_FORMAT : uint32_t
+    {
+        // DXGI_FORMAT_R8G8B8A8_UNORM, or _SRGB for sRGB sources. SNORM formats are remapped to [0, 255]
+        // and BC6H / RGBA16F are clamped to [0, 1].
+        DDS_DECODE_RGBA8 = 0,
+
+        // DXGI_FORMAT_R16G16B16A16_FLOAT. sRGB sources are converted to linear, BC6H and SNORM keep their range.
+        DDS_DECODE_RGBA16F = 1,
+    };
+
+    struct DDSDecodedSubresource
+    {
+        size_t offset;          // in bytes from the start of DDSDecodedTexture::pixels
+        size_t rowPitch;        // rows are tightly packed
+        size_t slicePitch;      // one depth slice
+        uint32_t width;
+        uint32_t height;
+        uint32_t depth;
+    };
+
+    struct DDSDecodedTexture
+    {
+        DXGI_FORMAT sourceFormat = DXGI_FORMAT_UNKNOWN;
+        DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+        D3D12_RESOURCE_DIMENSION dimension = D3D12_RESOURCE_DIMENSION_UNKNOWN;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t depth = 1;
+        uint32_t mipCount = 0;
+        uint32_t arraySize = 0;         // six per cube
+        bool isCubeMap = false;
+
+        // Indexed by mip + slice * mipCount, the same as D3D12CalcSubresource and the order of the DDS file
+        std::vector<DDSDecodedSubresource> subresources;
+        std::vector<uint8_t> pixels;
+
+        const uint8_t* GetPixels(size_t subresource) const noexcept { return pixels.data() + subresources[subresource].offset; }
+    };
+
+    // BC1-BC7 (including BC6H and the SNORM variants), R8G8B8A8, B8G8R8A8, B8G8R8X8 and R16G16B16A16_FLOAT are supported,
+    // other formats return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED). Block rows are decoded on threadCount threads,
+    // 0 for std::thread::hardware_concurrency.
+    HRESULT __cdecl DecodeDDSTextureFromMemory(
+        _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+        _In_ size_t ddsDataSize,
+        _In_ DDS_DECODE_FORMAT outputFormat,
+        _Out_ DDSDecodedTexture& texture,
+        _In_ unsigned int threadCount = 0);
+
+    // The file is memory-mapped and decoded straight from the mapping
+    HRESULT __cdecl DecodeDDSTextureFromFile(
+        _In_z_ const wchar_t* szFileName,
+        _In_ DDS_DECODE_FORMAT outputFormat,
+        _Out_ DDSDecodedTexture& texture,
+        _In_ unsigned int threadCount = 0);
+}
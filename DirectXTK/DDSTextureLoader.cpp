@@ -22,6 +22,10 @@
 #include "DirectXHelpers.h"
 #include "LoaderHelpers.h"
 
+#include "../Common/PlacedResourceAllocator.h"
+#include "../Common/MappedFile.h"
+#include "../Common/UploadManager.h"
+
 using namespace DirectX;
 using namespace DirectX::LoaderHelpers;
 
@@ -134,8 +138,12 @@ namespace
         _In_ bool forceSRGB,
         _In_ bool isCubeMap,
         _In_reads_opt_(mipCount* arraySize) D3D12_SUBRESOURCE_DATA* initData,
+        _In_opt_ PlacedResourceAllocator* allocator,
+        _In_opt_ UploadManager* uploadManager,
+        _In_ size_t firstUploadMip,
         ComPtr<ID3D12Resource>& texture,
-        ComPtr<ID3D12Resource>& textureUploadHeap)
+        ComPtr<ID3D12Resource>& textureUploadHeap,
+        _Out_opt_ uint64_t* copiedBytes)
     {
         if (device == nullptr)
             return E_POINTER;
@@ -162,20 +170,61 @@ namespace
                 texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
                 texDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
 
-                hr = device->CreateCommittedResource(
-                    &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
-                    D3D12_HEAP_FLAG_NONE,
-                    &texDesc,
-                    D3D12_RESOURCE_STATE_COMMON,
-                    nullptr,
-                    IID_PPV_ARGS(&texture)
-                );
+                if (allocator)
+                {
+                    try
+                    {
+                        texture = allocator->CreateTexture(texDesc, D3D12_RESOURCE_STATE_COMMON);
+                        hr = S_OK;
+                    }
+                    catch (const DxException& e)
+                    {
+                        hr = e.ErrorCode;
+                    }
+                }
+                else
+                {
+                    hr = device->CreateCommittedResource(
+                        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+                        D3D12_HEAP_FLAG_NONE,
+                        &texDesc,
+                        D3D12_RESOURCE_STATE_COMMON,
+                        nullptr,
+                        IID_PPV_ARGS(&texture)
+                    );
+                }
 
                 if (FAILED(hr))
                 {
                     texture = nullptr;
                     return hr;
                 }
+                else if (uploadManager)
+                {
+                    // Rows go straight from initData into the shared staging pages, the copy is recorded by UploadManager::Flush.
+                    // The texture goes back to COMMON so the copy can also be recorded on a copy queue, the first read promotes it
+                    // Only the mips from firstUploadMip on are uploaded when streaming, the rest follow through UploadDDSTextureMips12
+                    try
+                    {
+                        UINT64 copied = 0;
+                        const UINT uploadMipCount = texDesc.MipLevels - (UINT)firstUploadMip;
+                        for (UINT item = 0; item < texDesc.DepthOrArraySize; ++item)
+                        {
+                            const UINT subresource = item * texDesc.MipLevels + (UINT)firstUploadMip;
+                            copied += uploadManager->UploadTexture(texture.Get(), subresource, uploadMipCount, initData + subresource,
+                                D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COMMON);
+                        }
+                        if (copiedBytes)
+                            *copiedBytes = copied;
+                    }
+                    catch (const DxException& e)
+                    {
+                        if (allocator)
+                            allocator->FreeTexture(texture.Get());
+                        texture = nullptr;
+                        return e.ErrorCode;
+                    }
+                }
                 else
                 {
                     const UINT num2DSubresources = texDesc.DepthOrArraySize * texDesc.MipLevels;
@@ -190,6 +239,8 @@ namespace
                         IID_PPV_ARGS(&textureUploadHeap));
                     if (FAILED(hr))
                     {
+                        if (allocator)
+                            allocator->FreeTexture(texture.Get());
                         texture = nullptr;
                         return hr;
                     }
@@ -203,6 +254,14 @@ namespace
 
                         cmdList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(),
                             D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+
+                        if (copiedBytes)
+                        {
+                            UINT64 texelBytes = 0;
+                            for (UINT i = 0; i < num2DSubresources; ++i)
+                                texelBytes += initData[i].SlicePitch;
+                            *copiedBytes = texelBytes;
+                        }
                     }
                 }
             }
@@ -223,8 +282,13 @@ namespace
         _In_ size_t bitSize,
         _In_ size_t maxsize,
         _In_ bool forceSRGB,
+        _In_opt_ PlacedResourceAllocator* allocator,
+        _In_opt_ UploadManager* uploadManager,
+        _In_ size_t mipTailSize,
+        _Out_opt_ size_t* firstUploadedMip,
         ComPtr<ID3D12Resource>& texture,
-        ComPtr<ID3D12Resource>& textureUploadHeap)
+        ComPtr<ID3D12Resource>& textureUploadHeap,
+        _Out_opt_ uint64_t* copiedBytes)
     {
         HRESULT hr = S_OK;
 
@@ -386,6 +450,15 @@ namespace
             twidth, theight, tdepth, skipMip, initData.get()
         );
 
+        // With a mip tail size only the mips no larger than it are uploaded now, the whole chain when there are none
+        size_t firstUploadMip = 0;
+        if (SUCCEEDED(hr) && mipTailSize > 0)
+        {
+            while (firstUploadMip + 1 < mipCount - skipMip &&
+                ((std::max)(twidth >> firstUploadMip, theight >> firstUploadMip) > mipTailSize))
+                ++firstUploadMip;
+        }
+
         if (SUCCEEDED(hr))
         {
             hr = CreateD3DResources12(
@@ -397,8 +470,15 @@ namespace
                 false, // forceSRGB
                 isCubeMap,
                 initData.get(),
+                allocator,
+                uploadManager,
+                firstUploadMip,
                 texture,
-                textureUploadHeap);
+                textureUploadHeap,
+                copiedBytes);
+
+            if (SUCCEEDED(hr) && firstUploadedMip)
+                *firstUploadedMip = firstUploadMip;
         }
 
         return hr;
@@ -459,8 +539,13 @@ HRESULT DirectX::CreateDDSTextureFromMemory12(
         ddsDataSize - offset,
         maxsize,
         false,
+        nullptr,
+        nullptr,
+        0,
+        nullptr,
         texture,
-        textureUploadHeap
+        textureUploadHeap,
+        nullptr
     );
 
     if (SUCCEEDED(hr))
@@ -481,6 +566,20 @@ HRESULT DirectX::CreateDDSTextureFromFile12(ID3D12Device* device,
     ComPtr<ID3D12Resource>& textureUploadHeap,
     size_t maxsize,
     DDS_ALPHA_MODE* alphaMode)
+{
+    return CreateDDSTextureFromFile12(device, cmdList, fileName, nullptr, texture, textureUploadHeap, maxsize, alphaMode);
+}
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::CreateDDSTextureFromFile12(ID3D12Device* device,
+    ID3D12GraphicsCommandList* cmdList,
+    const wchar_t* fileName,
+    PlacedResourceAllocator* allocator,
+    ComPtr<ID3D12Resource>& texture,
+    ComPtr<ID3D12Resource>& textureUploadHeap,
+    size_t maxsize,
+    DDS_ALPHA_MODE* alphaMode)
 {
     if (texture)
         texture = nullptr;
@@ -504,7 +603,7 @@ HRESULT DirectX::CreateDDSTextureFromFile12(ID3D12Device* device,
         return hr;
 
     hr = CreateTextureFromDDS12(device, cmdList, header,
-        bitData, bitSize, maxsize, false, texture, textureUploadHeap);
+        bitData, bitSize, maxsize, false, allocator, nullptr, 0, nullptr, texture, textureUploadHeap, nullptr);
 
     if (SUCCEEDED(hr))
     {
@@ -514,3 +613,173 @@ HRESULT DirectX::CreateDDSTextureFromFile12(ID3D12Device* device,
 
     return hr;
 }
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::CreateDDSTextureFromFile12(ID3D12Device* device,
+    const wchar_t* fileName,
+    PlacedResourceAllocator* allocator,
+    UploadManager* uploadManager,
+    ComPtr<ID3D12Resource>& texture,
+    size_t maxsize,
+    DDS_ALPHA_MODE* alphaMode,
+    uint64_t* copiedBytes)
+{
+    if (texture)
+        texture = nullptr;
+
+    if (alphaMode)
+        *alphaMode = DDS_ALPHA_MODE_UNKNOWN;
+
+    if (copiedBytes)
+        *copiedBytes = 0;
+
+    if (!device || !fileName || !uploadManager)
+        return E_INVALIDARG;
+
+    // The rows are copied out of the mapping before UploadTexture returns, so it can be closed right away
+    MappedFile ddsFile;
+    if (!ddsFile.Open(std::wstring(fileName)))
+        return HRESULT_FROM_WIN32(ERROR_OPEN_FAILED);
+
+    const DDS_HEADER* header = nullptr;
+    const uint8_t* bitData = nullptr;
+    size_t bitSize = 0;
+
+    HRESULT hr = LoadTextureDataFromMemory(static_cast<const uint8_t*>(ddsFile.GetData()), ddsFile.GetSize(),
+        &header, &bitData, &bitSize);
+    if (FAILED(hr))
+        return hr;
+
+    ComPtr<ID3D12Resource> textureUploadHeap;
+    hr = CreateTextureFromDDS12(device, nullptr, header,
+        bitData, bitSize, maxsize, false, allocator, uploadManager, 0, nullptr, texture, textureUploadHeap, copiedBytes);
+
+    if (SUCCEEDED(hr))
+    {
+        if (alphaMode)
+            *alphaMode = GetAlphaMode(header);
+    }
+
+    return hr;
+}
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::CreateStreamingDDSTextureFromFile12(ID3D12Device* device,
+    const wchar_t* fileName,
+    PlacedResourceAllocator* allocator,
+    UploadManager* uploadManager,
+    size_t mipTailSize,
+    ComPtr<ID3D12Resource>& texture,
+    size_t& firstResidentMip,
+    uint64_t* copiedBytes)
+{
+    if (texture)
+        texture = nullptr;
+
+    firstResidentMip = 0;
+
+    if (copiedBytes)
+        *copiedBytes = 0;
+
+    if (!device || !fileName || !uploadManager || !mipTailSize)
+        return E_INVALIDARG;
+
+    MappedFile ddsFile;
+    if (!ddsFile.Open(std::wstring(fileName)))
+        return HRESULT_FROM_WIN32(ERROR_OPEN_FAILED);
+
+    const DDS_HEADER* header = nullptr;
+    const uint8_t* bitData = nullptr;
+    size_t bitSize = 0;
+
+    HRESULT hr = LoadTextureDataFromMemory(static_cast<const uint8_t*>(ddsFile.GetData()), ddsFile.GetSize(),
+        &header, &bitData, &bitSize);
+    if (FAILED(hr))
+        return hr;
+
+    ComPtr<ID3D12Resource> textureUploadHeap;
+    return CreateTextureFromDDS12(device, nullptr, header,
+        bitData, bitSize, 0, false, allocator, uploadManager, mipTailSize, &firstResidentMip, texture, textureUploadHeap, copiedBytes);
+}
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::UploadDDSTextureMips12(const wchar_t* fileName,
+    UploadManager* uploadManager,
+    ID3D12Resource* texture,
+    size_t firstMip,
+    size_t mipCount,
+    uint64_t* copiedBytes)
+{
+    if (copiedBytes)
+        *copiedBytes = 0;
+
+    if (!fileName || !uploadManager || !texture)
+        return E_INVALIDARG;
+
+    const D3D12_RESOURCE_DESC desc = texture->GetDesc();
+    if (desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D)
+        return HRESULT_FROM_WIN32(ERROR_NOT_SUPPORTED);
+
+    if (!mipCount || firstMip + mipCount > desc.MipLevels)
+        return E_INVALIDARG;
+
+    MappedFile ddsFile;
+    if (!ddsFile.Open(std::wstring(fileName)))
+        return HRESULT_FROM_WIN32(ERROR_OPEN_FAILED);
+
+    const DDS_HEADER* header = nullptr;
+    const uint8_t* bitData = nullptr;
+    size_t bitSize = 0;
+
+    HRESULT hr = LoadTextureDataFromMemory(static_cast<const uint8_t*>(ddsFile.GetData()), ddsFile.GetSize(),
+        &header, &bitData, &bitSize);
+    if (FAILED(hr))
+        return hr;
+
+    // The file may have changed since the texture was created
+    const size_t fileMipCount = header->mipMapCount ? header->mipMapCount : 1;
+    if (header->width != desc.Width || header->height != desc.Height || fileMipCount != desc.MipLevels)
+        return HRESULT_FROM_WIN32(ERROR_INVALID_DATA);
+
+    // The resource desc already holds the validated size and format, GetSurfaceInfo only has to locate each subresource
+    std::unique_ptr<D3D12_SUBRESOURCE_DATA[]> initData(
+        new (std::nothrow) D3D12_SUBRESOURCE_DATA[desc.MipLevels * desc.DepthOrArraySize]
+    );
+
+    if (!initData)
+        return E_OUTOFMEMORY;
+
+    size_t skipMip = 0;
+    size_t twidth = 0;
+    size_t theight = 0;
+    size_t tdepth = 0;
+
+    hr = FillInitData12(
+        (size_t)desc.Width, desc.Height, 1, desc.MipLevels, desc.DepthOrArraySize, desc.Format, 0, bitSize, bitData,
+        twidth, theight, tdepth, skipMip, initData.get()
+    );
+    if (FAILED(hr))
+        return hr;
+
+    try
+    {
+        UINT64 copied = 0;
+        for (UINT item = 0; item < desc.DepthOrArraySize; ++item)
+        {
+            const UINT subresource = item * desc.MipLevels + (UINT)firstMip;
+            copied += uploadManager->UploadTexture(texture, subresource, (UINT)mipCount, initData.get() + subresource,
+                D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COMMON);
+        }
+        if (copiedBytes)
+            *copiedBytes = copied;
+    }
+    catch (const DxException& e)
+    {
+        return e.ErrorCode;
+    }
+
+    return S_OK;
+}
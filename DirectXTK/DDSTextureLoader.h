@@ -24,6 +24,9 @@
 #include "../Direct3D12Headers/d3dx12.h"
 #include <wrl.h>
 
+class PlacedResourceAllocator;
+class UploadManager;
+
 namespace DirectX
 {
 #ifndef DDS_ALPHA_MODE_DEFINED
@@ -56,4 +59,56 @@ namespace DirectX
         _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
         _In_ size_t maxsize = 0,
         _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr);
+
+    // Placed version, the texture is created in one of the allocator's heap pages instead of its own committed heap.
+    // Release it through PlacedResourceAllocator::FreeTexture.
+    HRESULT __cdecl CreateDDSTextureFromFile12(
+        _In_ ID3D12Device* device,
+        _In_ ID3D12GraphicsCommandList* cmdList,
+        _In_z_ const wchar_t* szFileName,
+        _In_ PlacedResourceAllocator* allocator,
+        _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+        _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
+        _In_ size_t maxsize = 0,
+        _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr);
+
+    // Staging version, no command list or per-texture upload heap is needed. The placed footprints are computed first,
+    // the exact upload space is reserved from uploadManager and every row is copied once from the mapped file straight
+    // into its aligned location. The copies are recorded by the next UploadManager::Flush, on a direct or copy command list.
+    // The texture is left in D3D12_RESOURCE_STATE_COMMON and is implicitly promoted when a shader first reads it.
+    // Can be called from worker threads.
+    // copiedBytes receives the number of bytes copied by the CPU.
+    HRESULT __cdecl CreateDDSTextureFromFile12(
+        _In_ ID3D12Device* device,
+        _In_z_ const wchar_t* szFileName,
+        _In_opt_ PlacedResourceAllocator* allocator,
+        _In_ UploadManager* uploadManager,
+        _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+        _In_ size_t maxsize = 0,
+        _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr,
+        _Out_opt_ uint64_t* copiedBytes = nullptr);
+
+    // Streaming version of the staging version. The texture is created with its whole mip chain but only the mip tail,
+    // the mips whose width and height are at most mipTailSize, is uploaded. firstResidentMip receives the most detailed
+    // uploaded mip; clamp ResourceMinLODClamp of the SRV to it until the higher mips are streamed in with UploadDDSTextureMips12.
+    HRESULT __cdecl CreateStreamingDDSTextureFromFile12(
+        _In_ ID3D12Device* device,
+        _In_z_ const wchar_t* szFileName,
+        _In_opt_ PlacedResourceAllocator* allocator,
+        _In_ UploadManager* uploadManager,
+        _In_ size_t mipTailSize,
+        _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+        _Out_ size_t& firstResidentMip,
+        _Out_opt_ uint64_t* copiedBytes = nullptr);
+
+    // Reads mips [firstMip, firstMip + mipCount) of every array slice from the DDS file the texture was created from
+    // and copies them into uploadManager's staging pages. Only those subresources are transitioned, so the GPU can keep
+    // sampling the resident mips while they are copied.
+    HRESULT __cdecl UploadDDSTextureMips12(
+        _In_z_ const wchar_t* szFileName,
+        _In_ UploadManager* uploadManager,
+        _In_ ID3D12Resource* texture,
+        _In_ size_t firstMip,
+        _In_ size_t mipCount,
+        _Out_opt_ uint64_t* copiedBytes = nullptr);
 }
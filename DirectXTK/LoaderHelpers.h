@@ -22,267 +22,237 @@ namespace DirectX
     namespace LoaderHelpers
     {
         //--------------------------------------------------------------------------------------
-        // Return the BPP for a particular format
+        // Per-format metadata, indexed by DXGI_FORMAT
+        //
+        // Replaces the per-call switch statements in the helpers below with a single lookup.
+        // Subresource sizes are described as blocks of (1 << blockWidthShift) x (1 << blockHeightShift)
+        // pixels taking bytesPerBlock bytes: 4x4 for BC formats, 2x1 for packed 4:2:2 formats,
+        // 8x1 for R1_UNORM. chromaRows adds the second plane of planar video formats in units of
+        // half the luma rows: 1 for the 4:2:0 layout GetSurfaceInfo has always used, 2 for NV11.
+        // bytesPerBlock is 0 for formats GetSurfaceInfo rejects.
         //--------------------------------------------------------------------------------------
-        inline size_t BitsPerPixel(_In_ DXGI_FORMAT fmt) noexcept
+        enum FORMAT_FLAGS : uint8_t
         {
-            switch (fmt)
-            {
-            case DXGI_FORMAT_R32G32B32A32_TYPELESS:
-            case DXGI_FORMAT_R32G32B32A32_FLOAT:
-            case DXGI_FORMAT_R32G32B32A32_UINT:
-            case DXGI_FORMAT_R32G32B32A32_SINT:
-                return 128;
-
-            case DXGI_FORMAT_R32G32B32_TYPELESS:
-            case DXGI_FORMAT_R32G32B32_FLOAT:
-            case DXGI_FORMAT_R32G32B32_UINT:
-            case DXGI_FORMAT_R32G32B32_SINT:
-                return 96;
-
-            case DXGI_FORMAT_R16G16B16A16_TYPELESS:
-            case DXGI_FORMAT_R16G16B16A16_FLOAT:
-            case DXGI_FORMAT_R16G16B16A16_UNORM:
-            case DXGI_FORMAT_R16G16B16A16_UINT:
-            case DXGI_FORMAT_R16G16B16A16_SNORM:
-            case DXGI_FORMAT_R16G16B16A16_SINT:
-            case DXGI_FORMAT_R32G32_TYPELESS:
-            case DXGI_FORMAT_R32G32_FLOAT:
-            case DXGI_FORMAT_R32G32_UINT:
-            case DXGI_FORMAT_R32G32_SINT:
-            case DXGI_FORMAT_R32G8X24_TYPELESS:
-            case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
-            case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
-            case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
-            case DXGI_FORMAT_Y416:
-            case DXGI_FORMAT_Y210:
-            case DXGI_FORMAT_Y216:
-                return 64;
-
-            case DXGI_FORMAT_R10G10B10A2_TYPELESS:
-            case DXGI_FORMAT_R10G10B10A2_UNORM:
-            case DXGI_FORMAT_R10G10B10A2_UINT:
-            case DXGI_FORMAT_R11G11B10_FLOAT:
-            case DXGI_FORMAT_R8G8B8A8_TYPELESS:
-            case DXGI_FORMAT_R8G8B8A8_UNORM:
-            case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-            case DXGI_FORMAT_R8G8B8A8_UINT:
-            case DXGI_FORMAT_R8G8B8A8_SNORM:
-            case DXGI_FORMAT_R8G8B8A8_SINT:
-            case DXGI_FORMAT_R16G16_TYPELESS:
-            case DXGI_FORMAT_R16G16_FLOAT:
-            case DXGI_FORMAT_R16G16_UNORM:
-            case DXGI_FORMAT_R16G16_UINT:
-            case DXGI_FORMAT_R16G16_SNORM:
-            case DXGI_FORMAT_R16G16_SINT:
-            case DXGI_FORMAT_R32_TYPELESS:
-            case DXGI_FORMAT_D32_FLOAT:
-            case DXGI_FORMAT_R32_FLOAT:
-            case DXGI_FORMAT_R32_UINT:
-            case DXGI_FORMAT_R32_SINT:
-            case DXGI_FORMAT_R24G8_TYPELESS:
-            case DXGI_FORMAT_D24_UNORM_S8_UINT:
-            case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
-            case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
-            case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
-            case DXGI_FORMAT_R8G8_B8G8_UNORM:
-            case DXGI_FORMAT_G8R8_G8B8_UNORM:
-            case DXGI_FORMAT_B8G8R8A8_UNORM:
-            case DXGI_FORMAT_B8G8R8X8_UNORM:
-            case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
-            case DXGI_FORMAT_B8G8R8A8_TYPELESS:
-            case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-            case DXGI_FORMAT_B8G8R8X8_TYPELESS:
-            case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
-            case DXGI_FORMAT_AYUV:
-            case DXGI_FORMAT_Y410:
-            case DXGI_FORMAT_YUY2:
-            #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
-            case DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT:
-            case DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT:
-            case DXGI_FORMAT_R10G10B10_SNORM_A2_UNORM:
-            #endif
-                return 32;
-
-            case DXGI_FORMAT_P010:
-            case DXGI_FORMAT_P016:
-            #if (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
-            case DXGI_FORMAT_V408:
-            #endif
-            #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
-            case DXGI_FORMAT_D16_UNORM_S8_UINT:
-            case DXGI_FORMAT_R16_UNORM_X8_TYPELESS:
-            case DXGI_FORMAT_X16_TYPELESS_G8_UINT:
-            #endif
-                return 24;
-
-            case DXGI_FORMAT_R8G8_TYPELESS:
-            case DXGI_FORMAT_R8G8_UNORM:
-            case DXGI_FORMAT_R8G8_UINT:
-            case DXGI_FORMAT_R8G8_SNORM:
-            case DXGI_FORMAT_R8G8_SINT:
-            case DXGI_FORMAT_R16_TYPELESS:
-            case DXGI_FORMAT_R16_FLOAT:
-            case DXGI_FORMAT_D16_UNORM:
-            case DXGI_FORMAT_R16_UNORM:
-            case DXGI_FORMAT_R16_UINT:
-            case DXGI_FORMAT_R16_SNORM:
-            case DXGI_FORMAT_R16_SINT:
-            case DXGI_FORMAT_B5G6R5_UNORM:
-            case DXGI_FORMAT_B5G5R5A1_UNORM:
-            case DXGI_FORMAT_A8P8:
-            case DXGI_FORMAT_B4G4R4A4_UNORM:
-            #if (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
-            case DXGI_FORMAT_P208:
-            case DXGI_FORMAT_V208:
-            #endif
-                return 16;
-
-            case DXGI_FORMAT_NV12:
-            case DXGI_FORMAT_420_OPAQUE:
-            case DXGI_FORMAT_NV11:
-                return 12;
-
-            case DXGI_FORMAT_R8_TYPELESS:
-            case DXGI_FORMAT_R8_UNORM:
-            case DXGI_FORMAT_R8_UINT:
-            case DXGI_FORMAT_R8_SNORM:
-            case DXGI_FORMAT_R8_SINT:
-            case DXGI_FORMAT_A8_UNORM:
-            case DXGI_FORMAT_BC2_TYPELESS:
-            case DXGI_FORMAT_BC2_UNORM:
-            case DXGI_FORMAT_BC2_UNORM_SRGB:
-            case DXGI_FORMAT_BC3_TYPELESS:
-            case DXGI_FORMAT_BC3_UNORM:
-            case DXGI_FORMAT_BC3_UNORM_SRGB:
-            case DXGI_FORMAT_BC5_TYPELESS:
-            case DXGI_FORMAT_BC5_UNORM:
-            case DXGI_FORMAT_BC5_SNORM:
-            case DXGI_FORMAT_BC6H_TYPELESS:
-            case DXGI_FORMAT_BC6H_UF16:
-            case DXGI_FORMAT_BC6H_SF16:
-            case DXGI_FORMAT_BC7_TYPELESS:
-            case DXGI_FORMAT_BC7_UNORM:
-            case DXGI_FORMAT_BC7_UNORM_SRGB:
-            case DXGI_FORMAT_AI44:
-            case DXGI_FORMAT_IA44:
-            case DXGI_FORMAT_P8:
-            #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
-            case DXGI_FORMAT_R4G4_UNORM:
-            #endif
-                return 8;
-
-            case DXGI_FORMAT_R1_UNORM:
-                return 1;
-
-            case DXGI_FORMAT_BC1_TYPELESS:
-            case DXGI_FORMAT_BC1_UNORM:
-            case DXGI_FORMAT_BC1_UNORM_SRGB:
-            case DXGI_FORMAT_BC4_TYPELESS:
-            case DXGI_FORMAT_BC4_UNORM:
-            case DXGI_FORMAT_BC4_SNORM:
-                return 4;
-
-            case DXGI_FORMAT_UNKNOWN:
-            case DXGI_FORMAT_FORCE_UINT:
-            default:
-                return 0;
-            }
-        }
+            FORMAT_COMPRESSED = 0x1,
+            FORMAT_PACKED = 0x2,
+            FORMAT_PLANAR = 0x4,
+            FORMAT_SRGB = 0x8,
+        };
 
-        //--------------------------------------------------------------------------------------
-        inline DXGI_FORMAT MakeSRGB(_In_ DXGI_FORMAT format) noexcept
+        struct FormatInfo
         {
-            switch (format)
-            {
-            case DXGI_FORMAT_R8G8B8A8_UNORM:
-                return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
-
-            case DXGI_FORMAT_BC1_UNORM:
-                return DXGI_FORMAT_BC1_UNORM_SRGB;
-
-            case DXGI_FORMAT_BC2_UNORM:
-                return DXGI_FORMAT_BC2_UNORM_SRGB;
-
-            case DXGI_FORMAT_BC3_UNORM:
-                return DXGI_FORMAT_BC3_UNORM_SRGB;
+            DXGI_FORMAT format;             // Same as the table index
+            uint8_t bitsPerPixel;           // BitsPerPixel
+            uint8_t bytesPerBlock;
+            uint8_t blockWidthShift;
+            uint8_t blockHeightShift;
+            uint8_t chromaRows;
+            uint8_t planeCount;             // As reported by D3D12_FEATURE_FORMAT_INFO; 0 if unsupported
+            uint8_t flags;                  // FORMAT_FLAGS
+            DXGI_FORMAT srgbCounterpart;    // UNORM <-> UNORM_SRGB pair used by MakeSRGB and MakeLinear
+        };
 
-            case DXGI_FORMAT_B8G8R8A8_UNORM:
-                return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+        constexpr FormatInfo g_FormatTable[] =
+        {
+            // format, bpp, bytes per block, block width/height shift, chroma rows, planes, flags, sRGB counterpart
+            { DXGI_FORMAT_UNKNOWN,                    0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32B32A32_TYPELESS,      128, 16, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32B32A32_FLOAT,         128, 16, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32B32A32_UINT,          128, 16, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32B32A32_SINT,          128, 16, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32B32_TYPELESS,         96, 12, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32B32_FLOAT,            96, 12, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32B32_UINT,             96, 12, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32B32_SINT,             96, 12, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16B16A16_TYPELESS,      64, 8, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16B16A16_FLOAT,         64, 8, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16B16A16_UNORM,         64, 8, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16B16A16_UINT,          64, 8, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16B16A16_SNORM,         64, 8, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16B16A16_SINT,          64, 8, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32_TYPELESS,            64, 8, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32_FLOAT,               64, 8, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32_UINT,                64, 8, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G32_SINT,                64, 8, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32G8X24_TYPELESS,          64, 8, 0, 0, 0, 2, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_D32_FLOAT_S8X24_UINT,       64, 8, 0, 0, 0, 2, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS,   64, 8, 0, 0, 0, 2, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_X32_TYPELESS_G8X24_UINT,    64, 8, 0, 0, 0, 2, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R10G10B10A2_TYPELESS,       32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R10G10B10A2_UNORM,          32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R10G10B10A2_UINT,           32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R11G11B10_FLOAT,            32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8B8A8_TYPELESS,          32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8B8A8_UNORM,             32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB },
+            { DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,        32, 4, 0, 0, 0, 1, FORMAT_SRGB, DXGI_FORMAT_R8G8B8A8_UNORM },
+            { DXGI_FORMAT_R8G8B8A8_UINT,              32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8B8A8_SNORM,             32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8B8A8_SINT,              32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16_TYPELESS,            32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16_FLOAT,               32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16_UNORM,               32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16_UINT,                32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16_SNORM,               32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16G16_SINT,                32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32_TYPELESS,               32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_D32_FLOAT,                  32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32_FLOAT,                  32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32_UINT,                   32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R32_SINT,                   32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R24G8_TYPELESS,             32, 4, 0, 0, 0, 2, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_D24_UNORM_S8_UINT,          32, 4, 0, 0, 0, 2, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R24_UNORM_X8_TYPELESS,      32, 4, 0, 0, 0, 2, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_X24_TYPELESS_G8_UINT,       32, 4, 0, 0, 0, 2, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8_TYPELESS,              16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8_UNORM,                 16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8_UINT,                  16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8_SNORM,                 16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8_SINT,                  16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16_TYPELESS,               16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16_FLOAT,                  16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_D16_UNORM,                  16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16_UNORM,                  16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16_UINT,                   16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16_SNORM,                  16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16_SINT,                   16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8_TYPELESS,                8, 1, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8_UNORM,                   8, 1, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8_UINT,                    8, 1, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8_SNORM,                   8, 1, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8_SINT,                    8, 1, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_A8_UNORM,                   8, 1, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R1_UNORM,                   1, 1, 3, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R9G9B9E5_SHAREDEXP,         32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R8G8_B8G8_UNORM,            32, 4, 1, 0, 0, 1, FORMAT_PACKED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_G8R8_G8B8_UNORM,            32, 4, 1, 0, 0, 1, FORMAT_PACKED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC1_TYPELESS,               4, 8, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC1_UNORM,                  4, 8, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_BC1_UNORM_SRGB },
+            { DXGI_FORMAT_BC1_UNORM_SRGB,             4, 8, 2, 2, 0, 1, FORMAT_COMPRESSED | FORMAT_SRGB, DXGI_FORMAT_BC1_UNORM },
+            { DXGI_FORMAT_BC2_TYPELESS,               8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC2_UNORM,                  8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_BC2_UNORM_SRGB },
+            { DXGI_FORMAT_BC2_UNORM_SRGB,             8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED | FORMAT_SRGB, DXGI_FORMAT_BC2_UNORM },
+            { DXGI_FORMAT_BC3_TYPELESS,               8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC3_UNORM,                  8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_BC3_UNORM_SRGB },
+            { DXGI_FORMAT_BC3_UNORM_SRGB,             8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED | FORMAT_SRGB, DXGI_FORMAT_BC3_UNORM },
+            { DXGI_FORMAT_BC4_TYPELESS,               4, 8, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC4_UNORM,                  4, 8, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC4_SNORM,                  4, 8, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC5_TYPELESS,               8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC5_UNORM,                  8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC5_SNORM,                  8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_B5G6R5_UNORM,               16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_B5G5R5A1_UNORM,             16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_B8G8R8A8_UNORM,             32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_B8G8R8A8_UNORM_SRGB },
+            { DXGI_FORMAT_B8G8R8X8_UNORM,             32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_B8G8R8X8_UNORM_SRGB },
+            { DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM, 32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_B8G8R8A8_TYPELESS,          32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_B8G8R8A8_UNORM_SRGB,        32, 4, 0, 0, 0, 1, FORMAT_SRGB, DXGI_FORMAT_B8G8R8A8_UNORM },
+            { DXGI_FORMAT_B8G8R8X8_TYPELESS,          32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_B8G8R8X8_UNORM_SRGB,        32, 4, 0, 0, 0, 1, FORMAT_SRGB, DXGI_FORMAT_B8G8R8X8_UNORM },
+            { DXGI_FORMAT_BC6H_TYPELESS,              8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC6H_UF16,                  8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC6H_SF16,                  8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC7_TYPELESS,               8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_BC7_UNORM,                  8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED, DXGI_FORMAT_BC7_UNORM_SRGB },
+            { DXGI_FORMAT_BC7_UNORM_SRGB,             8, 16, 2, 2, 0, 1, FORMAT_COMPRESSED | FORMAT_SRGB, DXGI_FORMAT_BC7_UNORM },
+            { DXGI_FORMAT_AYUV,                       32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_Y410,                       32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_Y416,                       64, 8, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_NV12,                       12, 2, 1, 0, 1, 2, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_P010,                       24, 4, 1, 0, 1, 2, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_P016,                       24, 4, 1, 0, 1, 2, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_420_OPAQUE,                 12, 2, 1, 0, 1, 2, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_YUY2,                       32, 4, 1, 0, 0, 1, FORMAT_PACKED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_Y210,                       64, 8, 1, 0, 0, 1, FORMAT_PACKED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_Y216,                       64, 8, 1, 0, 0, 1, FORMAT_PACKED, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_NV11,                       12, 4, 2, 0, 2, 2, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_AI44,                       8, 1, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_IA44,                       8, 1, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_P8,                         8, 1, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_A8P8,                       16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_B4G4R4A4_UNORM,             16, 2, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+        #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
+            { DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT,     32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT,     32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_D16_UNORM_S8_UINT,          24, 4, 1, 0, 1, 2, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R16_UNORM_X8_TYPELESS,      24, 4, 1, 0, 1, 2, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_X16_TYPELESS_G8_UINT,       24, 4, 1, 0, 1, 2, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN },
+        #else
+            { static_cast<DXGI_FORMAT>(116),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { static_cast<DXGI_FORMAT>(117),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { static_cast<DXGI_FORMAT>(118),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { static_cast<DXGI_FORMAT>(119),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { static_cast<DXGI_FORMAT>(120),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+        #endif
+            { static_cast<DXGI_FORMAT>(121),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { static_cast<DXGI_FORMAT>(122),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { static_cast<DXGI_FORMAT>(123),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { static_cast<DXGI_FORMAT>(124),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { static_cast<DXGI_FORMAT>(125),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { static_cast<DXGI_FORMAT>(126),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { static_cast<DXGI_FORMAT>(127),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { static_cast<DXGI_FORMAT>(128),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { static_cast<DXGI_FORMAT>(129),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+        #if (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
+            { DXGI_FORMAT_P208,                       16, 2, 1, 0, 1, 2, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_V208,                       16, 2, 0, 0, 0, 3, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_V408,                       24, 3, 0, 0, 0, 3, FORMAT_PLANAR, DXGI_FORMAT_UNKNOWN },
+        #else
+            { static_cast<DXGI_FORMAT>(130),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { static_cast<DXGI_FORMAT>(131),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+            { static_cast<DXGI_FORMAT>(132),          0, 0, 0, 0, 0, 0, 0, DXGI_FORMAT_UNKNOWN },
+        #endif
+        };
 
-            case DXGI_FORMAT_B8G8R8X8_UNORM:
-                return DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+        constexpr size_t FormatTableSize = sizeof(g_FormatTable) / sizeof(g_FormatTable[0]);
 
-            case DXGI_FORMAT_BC7_UNORM:
-                return DXGI_FORMAT_BC7_UNORM_SRGB;
+    #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
+        constexpr FormatInfo g_XboxFormatTable[] =
+        {
+            { DXGI_FORMAT_R10G10B10_SNORM_A2_UNORM,   32, 4, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+            { DXGI_FORMAT_R4G4_UNORM,                 8, 1, 0, 0, 0, 1, 0, DXGI_FORMAT_UNKNOWN },
+        };
+    #endif
 
-            default:
-                return format;
-            }
+        //--------------------------------------------------------------------------------------
+        // Formats outside the table return the DXGI_FORMAT_UNKNOWN entry
+        //--------------------------------------------------------------------------------------
+        constexpr const FormatInfo& GetFormatInfo(_In_ DXGI_FORMAT fmt) noexcept
+        {
+            return (static_cast<uint32_t>(fmt) < FormatTableSize) ? g_FormatTable[fmt]
+            #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
+                : (fmt == DXGI_FORMAT_R10G10B10_SNORM_A2_UNORM) ? g_XboxFormatTable[0]
+                : (fmt == DXGI_FORMAT_R4G4_UNORM) ? g_XboxFormatTable[1]
+            #endif
+                : g_FormatTable[0];
         }
 
         //--------------------------------------------------------------------------------------
-        inline DXGI_FORMAT MakeLinear(_In_ DXGI_FORMAT format) noexcept
+        // Return the BPP for a particular format
+        //--------------------------------------------------------------------------------------
+        constexpr size_t BitsPerPixel(_In_ DXGI_FORMAT fmt) noexcept
         {
-            switch (format)
-            {
-            case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-                return DXGI_FORMAT_R8G8B8A8_UNORM;
-
-            case DXGI_FORMAT_BC1_UNORM_SRGB:
-                return DXGI_FORMAT_BC1_UNORM;
-
-            case DXGI_FORMAT_BC2_UNORM_SRGB:
-                return DXGI_FORMAT_BC2_UNORM;
-
-            case DXGI_FORMAT_BC3_UNORM_SRGB:
-                return DXGI_FORMAT_BC3_UNORM;
-
-            case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-                return DXGI_FORMAT_B8G8R8A8_UNORM;
-
-            case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
-                return DXGI_FORMAT_B8G8R8X8_UNORM;
+            return GetFormatInfo(fmt).bitsPerPixel;
+        }
 
-            case DXGI_FORMAT_BC7_UNORM_SRGB:
-                return DXGI_FORMAT_BC7_UNORM;
+        //--------------------------------------------------------------------------------------
+        constexpr DXGI_FORMAT MakeSRGB(_In_ DXGI_FORMAT format) noexcept
+        {
+            const FormatInfo& info = GetFormatInfo(format);
+            return (!(info.flags & FORMAT_SRGB) && info.srgbCounterpart != DXGI_FORMAT_UNKNOWN) ? info.srgbCounterpart : format;
+        }
 
-            default:
-                return format;
-            }
+        //--------------------------------------------------------------------------------------
+        constexpr DXGI_FORMAT MakeLinear(_In_ DXGI_FORMAT format) noexcept
+        {
+            const FormatInfo& info = GetFormatInfo(format);
+            return (info.flags & FORMAT_SRGB) ? info.srgbCounterpart : format;
         }
 
         //--------------------------------------------------------------------------------------
-        inline bool IsCompressed(_In_ DXGI_FORMAT fmt) noexcept
+        constexpr bool IsCompressed(_In_ DXGI_FORMAT fmt) noexcept
         {
-            switch (fmt)
-            {
-            case DXGI_FORMAT_BC1_TYPELESS:
-            case DXGI_FORMAT_BC1_UNORM:
-            case DXGI_FORMAT_BC1_UNORM_SRGB:
-            case DXGI_FORMAT_BC2_TYPELESS:
-            case DXGI_FORMAT_BC2_UNORM:
-            case DXGI_FORMAT_BC2_UNORM_SRGB:
-            case DXGI_FORMAT_BC3_TYPELESS:
-            case DXGI_FORMAT_BC3_UNORM:
-            case DXGI_FORMAT_BC3_UNORM_SRGB:
-            case DXGI_FORMAT_BC4_TYPELESS:
-            case DXGI_FORMAT_BC4_UNORM:
-            case DXGI_FORMAT_BC4_SNORM:
-            case DXGI_FORMAT_BC5_TYPELESS:
-            case DXGI_FORMAT_BC5_UNORM:
-            case DXGI_FORMAT_BC5_SNORM:
-            case DXGI_FORMAT_BC6H_TYPELESS:
-            case DXGI_FORMAT_BC6H_UF16:
-            case DXGI_FORMAT_BC6H_SF16:
-            case DXGI_FORMAT_BC7_TYPELESS:
-            case DXGI_FORMAT_BC7_UNORM:
-            case DXGI_FORMAT_BC7_UNORM_SRGB:
-                return true;
-
-            default:
-                return false;
-            }
+            return (GetFormatInfo(fmt).flags & FORMAT_COMPRESSED) != 0;
         }
 
         //--------------------------------------------------------------------------------------
@@ -503,6 +473,34 @@ namespace DirectX
             return S_OK;
         }
 
+        //--------------------------------------------------------------------------------------
+        // Size of one subresource; only meaningful when GetFormatInfo(fmt).bytesPerBlock != 0
+        //--------------------------------------------------------------------------------------
+        struct SurfaceFootprint
+        {
+            uint64_t rowBytes;
+            uint64_t numRows;
+            uint64_t numBytes;
+        };
+
+        constexpr SurfaceFootprint GetSurfaceFootprint(
+            _In_ uint64_t width,
+            _In_ uint64_t height,
+            _In_ DXGI_FORMAT fmt) noexcept
+        {
+            // Rounding up to whole blocks also keeps a non-zero size at least one block, as the
+            // per-class code did. The second plane of planar formats adds chromaRows / 2 of the
+            // luma rows and bytes, rounded up.
+            const FormatInfo& info = GetFormatInfo(fmt);
+            const uint64_t rowBytes = ((width + (1u << info.blockWidthShift) - 1u) >> info.blockWidthShift) * info.bytesPerBlock;
+            const uint64_t numRows = (height + (1u << info.blockHeightShift) - 1u) >> info.blockHeightShift;
+            const uint64_t numBytes = rowBytes * numRows;
+            return SurfaceFootprint{
+                rowBytes,
+                numRows + ((numRows * info.chromaRows + 1u) >> 1),
+                numBytes + ((numBytes * info.chromaRows + 1u) >> 1) };
+        }
+
         //--------------------------------------------------------------------------------------
         // Get surface information for a particular format
         //--------------------------------------------------------------------------------------
@@ -514,157 +512,513 @@ namespace DirectX
             _Out_opt_ size_t* outRowBytes,
             _Out_opt_ size_t* outNumRows) noexcept
         {
-            uint64_t numBytes = 0;
-            uint64_t rowBytes = 0;
-            uint64_t numRows = 0;
-
-            bool bc = false;
-            bool packed = false;
-            bool planar = false;
-            size_t bpe = 0;
-            switch (fmt)
-            {
-            case DXGI_FORMAT_BC1_TYPELESS:
-            case DXGI_FORMAT_BC1_UNORM:
-            case DXGI_FORMAT_BC1_UNORM_SRGB:
-            case DXGI_FORMAT_BC4_TYPELESS:
-            case DXGI_FORMAT_BC4_UNORM:
-            case DXGI_FORMAT_BC4_SNORM:
-                bc = true;
-                bpe = 8;
-                break;
-
-            case DXGI_FORMAT_BC2_TYPELESS:
-            case DXGI_FORMAT_BC2_UNORM:
-            case DXGI_FORMAT_BC2_UNORM_SRGB:
-            case DXGI_FORMAT_BC3_TYPELESS:
-            case DXGI_FORMAT_BC3_UNORM:
-            case DXGI_FORMAT_BC3_UNORM_SRGB:
-            case DXGI_FORMAT_BC5_TYPELESS:
-            case DXGI_FORMAT_BC5_UNORM:
-            case DXGI_FORMAT_BC5_SNORM:
-            case DXGI_FORMAT_BC6H_TYPELESS:
-            case DXGI_FORMAT_BC6H_UF16:
-            case DXGI_FORMAT_BC6H_SF16:
-            case DXGI_FORMAT_BC7_TYPELESS:
-            case DXGI_FORMAT_BC7_UNORM:
-            case DXGI_FORMAT_BC7_UNORM_SRGB:
-                bc = true;
-                bpe = 16;
-                break;
-
-            case DXGI_FORMAT_R8G8_B8G8_UNORM:
-            case DXGI_FORMAT_G8R8_G8B8_UNORM:
-            case DXGI_FORMAT_YUY2:
-                packed = true;
-                bpe = 4;
-                break;
-
-            case DXGI_FORMAT_Y210:
-            case DXGI_FORMAT_Y216:
-                packed = true;
-                bpe = 8;
-                break;
-
-            case DXGI_FORMAT_NV12:
-            case DXGI_FORMAT_420_OPAQUE:
-            #if (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
-            case DXGI_FORMAT_P208:
-            #endif
-                planar = true;
-                bpe = 2;
-                break;
+            if (!GetFormatInfo(fmt).bytesPerBlock)
+                return E_INVALIDARG;
 
-            case DXGI_FORMAT_P010:
-            case DXGI_FORMAT_P016:
-                planar = true;
-                bpe = 4;
-                break;
+            const SurfaceFootprint footprint = GetSurfaceFootprint(width, height, fmt);
+            const uint64_t numBytes = footprint.numBytes;
+            const uint64_t rowBytes = footprint.rowBytes;
+            const uint64_t numRows = footprint.numRows;
 
-            #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
-
-            case DXGI_FORMAT_D16_UNORM_S8_UINT:
-            case DXGI_FORMAT_R16_UNORM_X8_TYPELESS:
-            case DXGI_FORMAT_X16_TYPELESS_G8_UINT:
-                planar = true;
-                bpe = 4;
-                break;
-
-            #endif
+        #if defined(_M_IX86) || defined(_M_ARM) || defined(_M_HYBRID_X86_ARM64)
+            static_assert(sizeof(size_t) == 4, "Not a 32-bit platform!");
+            if (numBytes > UINT32_MAX || rowBytes > UINT32_MAX || numRows > UINT32_MAX)
+                return HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW);
+        #else
+            static_assert(sizeof(size_t) == 8, "Not a 64-bit platform!");
+        #endif
 
-            default:
-                break;
+            if (outNumBytes)
+            {
+                *outNumBytes = static_cast<size_t>(numBytes);
+            }
+            if (outRowBytes)
+            {
+                *outRowBytes = static_cast<size_t>(rowBytes);
+            }
+            if (outNumRows)
+            {
+                *outNumRows = static_cast<size_t>(numRows);
             }
 
-            if (bc)
+            return S_OK;
+        }
+
+        //--------------------------------------------------------------------------------------
+        // The switch statements the format table replaced, kept to check the table at compile time
+        //--------------------------------------------------------------------------------------
+        namespace Reference
+        {
+            constexpr size_t BitsPerPixel(_In_ DXGI_FORMAT fmt) noexcept
             {
-                uint64_t numBlocksWide = 0;
-                if (width > 0)
-                {
-                    numBlocksWide = std::max<uint64_t>(1u, (uint64_t(width) + 3u) / 4u);
-                }
-                uint64_t numBlocksHigh = 0;
-                if (height > 0)
+                switch (fmt)
                 {
-                    numBlocksHigh = std::max<uint64_t>(1u, (uint64_t(height) + 3u) / 4u);
+                case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+                case DXGI_FORMAT_R32G32B32A32_FLOAT:
+                case DXGI_FORMAT_R32G32B32A32_UINT:
+                case DXGI_FORMAT_R32G32B32A32_SINT:
+                    return 128;
+
+                case DXGI_FORMAT_R32G32B32_TYPELESS:
+                case DXGI_FORMAT_R32G32B32_FLOAT:
+                case DXGI_FORMAT_R32G32B32_UINT:
+                case DXGI_FORMAT_R32G32B32_SINT:
+                    return 96;
+
+                case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+                case DXGI_FORMAT_R16G16B16A16_FLOAT:
+                case DXGI_FORMAT_R16G16B16A16_UNORM:
+                case DXGI_FORMAT_R16G16B16A16_UINT:
+                case DXGI_FORMAT_R16G16B16A16_SNORM:
+                case DXGI_FORMAT_R16G16B16A16_SINT:
+                case DXGI_FORMAT_R32G32_TYPELESS:
+                case DXGI_FORMAT_R32G32_FLOAT:
+                case DXGI_FORMAT_R32G32_UINT:
+                case DXGI_FORMAT_R32G32_SINT:
+                case DXGI_FORMAT_R32G8X24_TYPELESS:
+                case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+                case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+                case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+                case DXGI_FORMAT_Y416:
+                case DXGI_FORMAT_Y210:
+                case DXGI_FORMAT_Y216:
+                    return 64;
+
+                case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+                case DXGI_FORMAT_R10G10B10A2_UNORM:
+                case DXGI_FORMAT_R10G10B10A2_UINT:
+                case DXGI_FORMAT_R11G11B10_FLOAT:
+                case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+                case DXGI_FORMAT_R8G8B8A8_UNORM:
+                case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+                case DXGI_FORMAT_R8G8B8A8_UINT:
+                case DXGI_FORMAT_R8G8B8A8_SNORM:
+                case DXGI_FORMAT_R8G8B8A8_SINT:
+                case DXGI_FORMAT_R16G16_TYPELESS:
+                case DXGI_FORMAT_R16G16_FLOAT:
+                case DXGI_FORMAT_R16G16_UNORM:
+                case DXGI_FORMAT_R16G16_UINT:
+                case DXGI_FORMAT_R16G16_SNORM:
+                case DXGI_FORMAT_R16G16_SINT:
+                case DXGI_FORMAT_R32_TYPELESS:
+                case DXGI_FORMAT_D32_FLOAT:
+                case DXGI_FORMAT_R32_FLOAT:
+                case DXGI_FORMAT_R32_UINT:
+                case DXGI_FORMAT_R32_SINT:
+                case DXGI_FORMAT_R24G8_TYPELESS:
+                case DXGI_FORMAT_D24_UNORM_S8_UINT:
+                case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+                case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+                case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+                case DXGI_FORMAT_R8G8_B8G8_UNORM:
+                case DXGI_FORMAT_G8R8_G8B8_UNORM:
+                case DXGI_FORMAT_B8G8R8A8_UNORM:
+                case DXGI_FORMAT_B8G8R8X8_UNORM:
+                case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+                case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+                case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+                case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+                case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+                case DXGI_FORMAT_AYUV:
+                case DXGI_FORMAT_Y410:
+                case DXGI_FORMAT_YUY2:
+                #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
+                case DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT:
+                case DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT:
+                case DXGI_FORMAT_R10G10B10_SNORM_A2_UNORM:
+                #endif
+                    return 32;
+
+                case DXGI_FORMAT_P010:
+                case DXGI_FORMAT_P016:
+                #if (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
+                case DXGI_FORMAT_V408:
+                #endif
+                #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
+                case DXGI_FORMAT_D16_UNORM_S8_UINT:
+                case DXGI_FORMAT_R16_UNORM_X8_TYPELESS:
+                case DXGI_FORMAT_X16_TYPELESS_G8_UINT:
+                #endif
+                    return 24;
+
+                case DXGI_FORMAT_R8G8_TYPELESS:
+                case DXGI_FORMAT_R8G8_UNORM:
+                case DXGI_FORMAT_R8G8_UINT:
+                case DXGI_FORMAT_R8G8_SNORM:
+                case DXGI_FORMAT_R8G8_SINT:
+                case DXGI_FORMAT_R16_TYPELESS:
+                case DXGI_FORMAT_R16_FLOAT:
+                case DXGI_FORMAT_D16_UNORM:
+                case DXGI_FORMAT_R16_UNORM:
+                case DXGI_FORMAT_R16_UINT:
+                case DXGI_FORMAT_R16_SNORM:
+                case DXGI_FORMAT_R16_SINT:
+                case DXGI_FORMAT_B5G6R5_UNORM:
+                case DXGI_FORMAT_B5G5R5A1_UNORM:
+                case DXGI_FORMAT_A8P8:
+                case DXGI_FORMAT_B4G4R4A4_UNORM:
+                #if (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
+                case DXGI_FORMAT_P208:
+                case DXGI_FORMAT_V208:
+                #endif
+                    return 16;
+
+                case DXGI_FORMAT_NV12:
+                case DXGI_FORMAT_420_OPAQUE:
+                case DXGI_FORMAT_NV11:
+                    return 12;
+
+                case DXGI_FORMAT_R8_TYPELESS:
+                case DXGI_FORMAT_R8_UNORM:
+                case DXGI_FORMAT_R8_UINT:
+                case DXGI_FORMAT_R8_SNORM:
+                case DXGI_FORMAT_R8_SINT:
+                case DXGI_FORMAT_A8_UNORM:
+                case DXGI_FORMAT_BC2_TYPELESS:
+                case DXGI_FORMAT_BC2_UNORM:
+                case DXGI_FORMAT_BC2_UNORM_SRGB:
+                case DXGI_FORMAT_BC3_TYPELESS:
+                case DXGI_FORMAT_BC3_UNORM:
+                case DXGI_FORMAT_BC3_UNORM_SRGB:
+                case DXGI_FORMAT_BC5_TYPELESS:
+                case DXGI_FORMAT_BC5_UNORM:
+                case DXGI_FORMAT_BC5_SNORM:
+                case DXGI_FORMAT_BC6H_TYPELESS:
+                case DXGI_FORMAT_BC6H_UF16:
+                case DXGI_FORMAT_BC6H_SF16:
+                case DXGI_FORMAT_BC7_TYPELESS:
+                case DXGI_FORMAT_BC7_UNORM:
+                case DXGI_FORMAT_BC7_UNORM_SRGB:
+                case DXGI_FORMAT_AI44:
+                case DXGI_FORMAT_IA44:
+                case DXGI_FORMAT_P8:
+                #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
+                case DXGI_FORMAT_R4G4_UNORM:
+                #endif
+                    return 8;
+
+                case DXGI_FORMAT_R1_UNORM:
+                    return 1;
+
+                case DXGI_FORMAT_BC1_TYPELESS:
+                case DXGI_FORMAT_BC1_UNORM:
+                case DXGI_FORMAT_BC1_UNORM_SRGB:
+                case DXGI_FORMAT_BC4_TYPELESS:
+                case DXGI_FORMAT_BC4_UNORM:
+                case DXGI_FORMAT_BC4_SNORM:
+                    return 4;
+
+                case DXGI_FORMAT_UNKNOWN:
+                case DXGI_FORMAT_FORCE_UINT:
+                default:
+                    return 0;
                 }
-                rowBytes = numBlocksWide * bpe;
-                numRows = numBlocksHigh;
-                numBytes = rowBytes * numBlocksHigh;
             }
-            else if (packed)
+
+            //--------------------------------------------------------------------------------------
+            constexpr DXGI_FORMAT MakeSRGB(_In_ DXGI_FORMAT format) noexcept
             {
-                rowBytes = ((uint64_t(width) + 1u) >> 1) * bpe;
-                numRows = uint64_t(height);
-                numBytes = rowBytes * height;
+                switch (format)
+                {
+                case DXGI_FORMAT_R8G8B8A8_UNORM:
+                    return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+
+                case DXGI_FORMAT_BC1_UNORM:
+                    return DXGI_FORMAT_BC1_UNORM_SRGB;
+
+                case DXGI_FORMAT_BC2_UNORM:
+                    return DXGI_FORMAT_BC2_UNORM_SRGB;
+
+                case DXGI_FORMAT_BC3_UNORM:
+                    return DXGI_FORMAT_BC3_UNORM_SRGB;
+
+                case DXGI_FORMAT_B8G8R8A8_UNORM:
+                    return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+
+                case DXGI_FORMAT_B8G8R8X8_UNORM:
+                    return DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+
+                case DXGI_FORMAT_BC7_UNORM:
+                    return DXGI_FORMAT_BC7_UNORM_SRGB;
+
+                default:
+                    return format;
+                }
             }
-            else if (fmt == DXGI_FORMAT_NV11)
+
+            //--------------------------------------------------------------------------------------
+            constexpr DXGI_FORMAT MakeLinear(_In_ DXGI_FORMAT format) noexcept
             {
-                rowBytes = ((uint64_t(width) + 3u) >> 2) * 4u;
-                numRows = uint64_t(height) * 2u; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
-                numBytes = rowBytes * numRows;
+                switch (format)
+                {
+                case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+                    return DXGI_FORMAT_R8G8B8A8_UNORM;
+
+                case DXGI_FORMAT_BC1_UNORM_SRGB:
+                    return DXGI_FORMAT_BC1_UNORM;
+
+                case DXGI_FORMAT_BC2_UNORM_SRGB:
+                    return DXGI_FORMAT_BC2_UNORM;
+
+                case DXGI_FORMAT_BC3_UNORM_SRGB:
+                    return DXGI_FORMAT_BC3_UNORM;
+
+                case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+                    return DXGI_FORMAT_B8G8R8A8_UNORM;
+
+                case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+                    return DXGI_FORMAT_B8G8R8X8_UNORM;
+
+                case DXGI_FORMAT_BC7_UNORM_SRGB:
+                    return DXGI_FORMAT_BC7_UNORM;
+
+                default:
+                    return format;
+                }
             }
-            else if (planar)
+
+            //--------------------------------------------------------------------------------------
+            constexpr bool IsCompressed(_In_ DXGI_FORMAT fmt) noexcept
             {
-                rowBytes = ((uint64_t(width) + 1u) >> 1) * bpe;
-                numBytes = (rowBytes * uint64_t(height)) + ((rowBytes * uint64_t(height) + 1u) >> 1);
-                numRows = height + ((uint64_t(height) + 1u) >> 1);
+                switch (fmt)
+                {
+                case DXGI_FORMAT_BC1_TYPELESS:
+                case DXGI_FORMAT_BC1_UNORM:
+                case DXGI_FORMAT_BC1_UNORM_SRGB:
+                case DXGI_FORMAT_BC2_TYPELESS:
+                case DXGI_FORMAT_BC2_UNORM:
+                case DXGI_FORMAT_BC2_UNORM_SRGB:
+                case DXGI_FORMAT_BC3_TYPELESS:
+                case DXGI_FORMAT_BC3_UNORM:
+                case DXGI_FORMAT_BC3_UNORM_SRGB:
+                case DXGI_FORMAT_BC4_TYPELESS:
+                case DXGI_FORMAT_BC4_UNORM:
+                case DXGI_FORMAT_BC4_SNORM:
+                case DXGI_FORMAT_BC5_TYPELESS:
+                case DXGI_FORMAT_BC5_UNORM:
+                case DXGI_FORMAT_BC5_SNORM:
+                case DXGI_FORMAT_BC6H_TYPELESS:
+                case DXGI_FORMAT_BC6H_UF16:
+                case DXGI_FORMAT_BC6H_SF16:
+                case DXGI_FORMAT_BC7_TYPELESS:
+                case DXGI_FORMAT_BC7_UNORM:
+                case DXGI_FORMAT_BC7_UNORM_SRGB:
+                    return true;
+
+                default:
+                    return false;
+                }
             }
-            else
+
+            //--------------------------------------------------------------------------------------
+            constexpr SurfaceFootprint GetSurfaceFootprint(
+                _In_ uint64_t width,
+                _In_ uint64_t height,
+                _In_ DXGI_FORMAT fmt) noexcept
             {
-                const size_t bpp = BitsPerPixel(fmt);
-                if (!bpp)
-                    return E_INVALIDARG;
+                uint64_t numBytes = 0;
+                uint64_t rowBytes = 0;
+                uint64_t numRows = 0;
+
+                bool bc = false;
+                bool packed = false;
+                bool planar = false;
+                size_t bpe = 0;
+                switch (fmt)
+                {
+                case DXGI_FORMAT_BC1_TYPELESS:
+                case DXGI_FORMAT_BC1_UNORM:
+                case DXGI_FORMAT_BC1_UNORM_SRGB:
+                case DXGI_FORMAT_BC4_TYPELESS:
+                case DXGI_FORMAT_BC4_UNORM:
+                case DXGI_FORMAT_BC4_SNORM:
+                    bc = true;
+                    bpe = 8;
+                    break;
+
+                case DXGI_FORMAT_BC2_TYPELESS:
+                case DXGI_FORMAT_BC2_UNORM:
+                case DXGI_FORMAT_BC2_UNORM_SRGB:
+                case DXGI_FORMAT_BC3_TYPELESS:
+                case DXGI_FORMAT_BC3_UNORM:
+                case DXGI_FORMAT_BC3_UNORM_SRGB:
+                case DXGI_FORMAT_BC5_TYPELESS:
+                case DXGI_FORMAT_BC5_UNORM:
+                case DXGI_FORMAT_BC5_SNORM:
+                case DXGI_FORMAT_BC6H_TYPELESS:
+                case DXGI_FORMAT_BC6H_UF16:
+                case DXGI_FORMAT_BC6H_SF16:
+                case DXGI_FORMAT_BC7_TYPELESS:
+                case DXGI_FORMAT_BC7_UNORM:
+                case DXGI_FORMAT_BC7_UNORM_SRGB:
+                    bc = true;
+                    bpe = 16;
+                    break;
+
+                case DXGI_FORMAT_R8G8_B8G8_UNORM:
+                case DXGI_FORMAT_G8R8_G8B8_UNORM:
+                case DXGI_FORMAT_YUY2:
+                    packed = true;
+                    bpe = 4;
+                    break;
+
+                case DXGI_FORMAT_Y210:
+                case DXGI_FORMAT_Y216:
+                    packed = true;
+                    bpe = 8;
+                    break;
+
+                case DXGI_FORMAT_NV12:
+                case DXGI_FORMAT_420_OPAQUE:
+                #if (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
+                case DXGI_FORMAT_P208:
+                #endif
+                    planar = true;
+                    bpe = 2;
+                    break;
+
+                case DXGI_FORMAT_P010:
+                case DXGI_FORMAT_P016:
+                    planar = true;
+                    bpe = 4;
+                    break;
+
+                #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
+
+                case DXGI_FORMAT_D16_UNORM_S8_UINT:
+                case DXGI_FORMAT_R16_UNORM_X8_TYPELESS:
+                case DXGI_FORMAT_X16_TYPELESS_G8_UINT:
+                    planar = true;
+                    bpe = 4;
+                    break;
+
+                #endif
+
+                default:
+                    break;
+                }
+
+                if (bc)
+                {
+                    uint64_t numBlocksWide = 0;
+                    if (width > 0)
+                    {
+                        numBlocksWide = std::max<uint64_t>(1u, (uint64_t(width) + 3u) / 4u);
+                    }
+                    uint64_t numBlocksHigh = 0;
+                    if (height > 0)
+                    {
+                        numBlocksHigh = std::max<uint64_t>(1u, (uint64_t(height) + 3u) / 4u);
+                    }
+                    rowBytes = numBlocksWide * bpe;
+                    numRows = numBlocksHigh;
+                    numBytes = rowBytes * numBlocksHigh;
+                }
+                else if (packed)
+                {
+                    rowBytes = ((uint64_t(width) + 1u) >> 1) * bpe;
+                    numRows = uint64_t(height);
+                    numBytes = rowBytes * height;
+                }
+                else if (fmt == DXGI_FORMAT_NV11)
+                {
+                    rowBytes = ((uint64_t(width) + 3u) >> 2) * 4u;
+                    numRows = uint64_t(height) * 2u; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
+                    numBytes = rowBytes * numRows;
+                }
+                else if (planar)
+                {
+                    rowBytes = ((uint64_t(width) + 1u) >> 1) * bpe;
+                    numBytes = (rowBytes * uint64_t(height)) + ((rowBytes * uint64_t(height) + 1u) >> 1);
+                    numRows = height + ((uint64_t(height) + 1u) >> 1);
+                }
+                else
+                {
+                    const size_t bpp = Reference::BitsPerPixel(fmt);
+                    if (!bpp)
+                        return SurfaceFootprint{};
 
-                rowBytes = (uint64_t(width) * bpp + 7u) / 8u; // round up to nearest byte
-                numRows = uint64_t(height);
-                numBytes = rowBytes * height;
+                    rowBytes = (uint64_t(width) * bpp + 7u) / 8u; // round up to nearest byte
+                    numRows = uint64_t(height);
+                    numBytes = rowBytes * height;
+                }
+
+                return SurfaceFootprint{ rowBytes, numRows, numBytes };
             }
+        }
 
-        #if defined(_M_IX86) || defined(_M_ARM) || defined(_M_HYBRID_X86_ARM64)
-            static_assert(sizeof(size_t) == 4, "Not a 32-bit platform!");
-            if (numBytes > UINT32_MAX || rowBytes > UINT32_MAX || numRows > UINT32_MAX)
-                return HRESULT_FROM_WIN32(ERROR_ARITHMETIC_OVERFLOW);
-        #else
-            static_assert(sizeof(size_t) == 8, "Not a 64-bit platform!");
-        #endif
+        //--------------------------------------------------------------------------------------
+        // Every value the switches handle is below 192 (the Xbox-only formats end at 190)
+        constexpr uint32_t FormatCheckCount = 192;
 
-            if (outNumBytes)
+        constexpr bool CheckFormatTableOrder() noexcept
+        {
+            for (size_t i = 0; i < FormatTableSize; ++i)
             {
-                *outNumBytes = static_cast<size_t>(numBytes);
+                if (g_FormatTable[i].format != static_cast<DXGI_FORMAT>(i))
+                    return false;
             }
-            if (outRowBytes)
+            return true;
+        }
+
+        constexpr bool CheckBitsPerPixel() noexcept
+        {
+            for (uint32_t i = 0; i < FormatCheckCount; ++i)
             {
-                *outRowBytes = static_cast<size_t>(rowBytes);
+                const auto fmt = static_cast<DXGI_FORMAT>(i);
+                if (BitsPerPixel(fmt) != Reference::BitsPerPixel(fmt))
+                    return false;
             }
-            if (outNumRows)
+            return BitsPerPixel(DXGI_FORMAT_FORCE_UINT) == 0;
+        }
+
+        constexpr bool CheckFormatConversions() noexcept
+        {
+            for (uint32_t i = 0; i < FormatCheckCount; ++i)
             {
-                *outNumRows = static_cast<size_t>(numRows);
+                const auto fmt = static_cast<DXGI_FORMAT>(i);
+                if (IsCompressed(fmt) != Reference::IsCompressed(fmt)
+                    || MakeSRGB(fmt) != Reference::MakeSRGB(fmt)
+                    || MakeLinear(fmt) != Reference::MakeLinear(fmt))
+                    return false;
             }
+            return true;
+        }
 
-            return S_OK;
+        constexpr bool CheckSurfaceFootprints(uint32_t first, uint32_t last) noexcept
+        {
+            // Odd sizes, partial blocks and sizes needing more than 32 bits of bytes
+            constexpr uint64_t sizes[][2] = {
+                { 0, 0 }, { 0, 7 }, { 1, 1 }, { 2, 3 }, { 3, 5 }, { 4, 4 }, { 5, 2 },
+                { 255, 257 }, { 4097, 1 }, { 1, 4097 }, { 65535, 65537 } };
+            for (uint32_t i = first; i < last; ++i)
+            {
+                const auto fmt = static_cast<DXGI_FORMAT>(i);
+                if ((GetFormatInfo(fmt).bytesPerBlock == 0) != (Reference::BitsPerPixel(fmt) == 0))
+                    return false;
+                if (GetFormatInfo(fmt).bytesPerBlock == 0)
+                    continue;
+                for (const auto& size : sizes)
+                {
+                    const SurfaceFootprint a = GetSurfaceFootprint(size[0], size[1], fmt);
+                    const SurfaceFootprint b = Reference::GetSurfaceFootprint(size[0], size[1], fmt);
+                    if (a.rowBytes != b.rowBytes || a.numRows != b.numRows || a.numBytes != b.numBytes)
+                        return false;
+                }
+            }
+            return true;
         }
 
+        static_assert(CheckFormatTableOrder(), "g_FormatTable rows must be in DXGI_FORMAT order");
+        static_assert(CheckBitsPerPixel(), "g_FormatTable disagrees with the BitsPerPixel switch");
+        static_assert(CheckFormatConversions(), "g_FormatTable disagrees with the IsCompressed/MakeSRGB/MakeLinear switches");
+        // Split so each evaluation stays well inside the compiler's constexpr step limit
+        static_assert(CheckSurfaceFootprints(0, 64), "g_FormatTable disagrees with the GetSurfaceInfo switch");
+        static_assert(CheckSurfaceFootprints(64, 128), "g_FormatTable disagrees with the GetSurfaceInfo switch");
+        static_assert(CheckSurfaceFootprints(128, FormatCheckCount), "g_FormatTable disagrees with the GetSurfaceInfo switch");
+        static_assert(GetSurfaceFootprint(256, 256, DXGI_FORMAT_BC1_UNORM).numBytes == 32768, "BC1 is 8 bytes per 4x4 block");
+        static_assert(GetSurfaceFootprint(1, 1, DXGI_FORMAT_BC7_UNORM).rowBytes == 16, "Partial blocks round up to a whole block");
+
         //--------------------------------------------------------------------------------------
     #define ISBITMASK( r,g,b,a ) ( ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a )
 
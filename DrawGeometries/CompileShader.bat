@@ -1,2 +1,2 @@
-../Util/Compiler.bat shaders.hlsl
+call ../Util/Compiler.bat shaders.hlsl
 pause
\ No newline at end of file
@@ -5,7 +5,7 @@
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
 
-// 
+// 顶点数据
 struct Vertex
 {
     XMFLOAT3 position;
@@ -27,23 +27,23 @@ struct RenderItem
 {
     RenderItem() = default;
 
-    // ģͱ任󣬼µλãԼתֵ
+    // 模型变换矩阵，即物体在世界坐标下的位置，缩放以及旋转值
     XMFLOAT4X4 modelMatrix = MathUtil::Identity4x4();
-    // ӦObjectConstant±
+    // 对应ObjectConstant的下标
     UINT objectCBIndex = -1;
 
-    // Ӧvertexindex bufferϢ
+    // 对应的vertex和index buffer信息
     Mesh* mesh = nullptr;
 
     D3D12_PRIMITIVE_TOPOLOGY primitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 
-    // ӦmeshеSubmeshֵ
+    // 对应mesh中的Submesh值
     UINT indexCount = 0;
     UINT startIndexLocation = 0;
     int baseVertexLocation = 0;
 };
 
-UINT m_clientWidth = 800, m_clientHeight = 600;     // ڳߴ
+UINT m_clientWidth = 800, m_clientHeight = 600;     // 窗口尺寸
 HWND m_hwnd;
 UINT64 m_fenceValue;
 static const UINT m_swapChainBufferCount = 2;
@@ -51,7 +51,7 @@ HANDLE m_fenceEvent;
 UINT m_rtvDescriptorSize, m_cbvSrvUavDescriptorSize;
 UINT m_currendBackBufferIndex = 0;
 
-DXGI_FORMAT m_backBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;  // ÿԪռ8-bitֵķΧ[0,1]
+DXGI_FORMAT m_backBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;  // 每个元素占用8-bit，值的范围[0,1]
 
 ComPtr<ID3D12Device> m_device;
 ComPtr<ID3D12CommandQueue> m_commandQueue;
@@ -67,8 +67,11 @@ std::vector<std::unique_ptr<RenderItem>> m_renderItems;
 std::unique_ptr<UploadHeapConstantBuffer<ObjectConstant>> m_objectConstantBuffer;
 std::unique_ptr<UploadHeapConstantBuffer<PassConstant>> m_passConstantBuffer;
 ComPtr<ID3D12DescriptorHeap> m_cbvHeap;
-ComPtr<ID3DBlob> m_vsByteCode;
-ComPtr<ID3DBlob> m_psByteCode;
+ShaderArchive m_shaderArchive;              // 打包的shader，映射到内存中
+ComPtr<ID3DBlob> m_vsBlob;                  // archive中没有时从cso读取
+ComPtr<ID3DBlob> m_psBlob;
+D3D12_SHADER_BYTECODE m_vsByteCode = {};
+D3D12_SHADER_BYTECODE m_psByteCode = {};
 ComPtr<ID3D12PipelineState> m_pipelineState;
 
 D3D12_VIEWPORT m_viewport;
@@ -90,7 +93,7 @@ void OnRender();
 void OnDestroy();
 
 
-// Ӧóں
+// 应用程序入口函数
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine, int nCmdShow)
 {
     const wchar_t CLASS_NAME[] = L"Sample Window Class";
@@ -108,8 +111,8 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
         CLASS_NAME,                     // Window class
         L"Draw Geometries",    // Window text
         WS_OVERLAPPEDWINDOW,            // Window style
-        CW_USEDEFAULT, CW_USEDEFAULT,   // ڴС
-        m_clientWidth, m_clientHeight,  // λ
+        CW_USEDEFAULT, CW_USEDEFAULT,   // 窗口大小
+        m_clientWidth, m_clientHeight,  // 窗口位置
         NULL,       // Parent window    
         NULL,       // Menu
         hInstance,  // Instance handle
@@ -118,23 +121,23 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
 
     if (m_hwnd == NULL) return 0;
 
-    ShowWindow(m_hwnd, nCmdShow);         // ʾ
+    ShowWindow(m_hwnd, nCmdShow);         // 显示窗口
 
     try
     {
         InitDirect3D();
         InitAsset();
 
-        // ȡ¼̰ڱ仯ȵȡ
+        // 获取事件，例如鼠标点击，键盘按键，窗口变化等等。
         MSG msg = { };
         while (msg.message != WM_QUIT)      // message loop
         {
-            // PeekMessage  message queueǷmessageеĻ䵽msgУط0ֵ
-            // PM_REMOVE WM_PAINT͵message⣬messageִPeekMessageƳ message queue
+            // PeekMessage 检查 message queue中是否有message，如果有的话将其到msg中，返回非0的值
+            // PM_REMOVE 除了WM_PAINT类型的message外，其他的message会在执行完PeekMessage后被移出 message queue
             if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
             {
                 TranslateMessage(&msg);
-                DispatchMessage(&msg);      // ᴥ WindowProc 
+                DispatchMessage(&msg);      // 会触发 WindowProc 函数
             }
             else
             {
@@ -154,13 +157,13 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
     return 0;
 }
 
-// ¼
+// 事件处理
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
     switch (uMsg)
     {
     case WM_DESTROY:
-        PostQuitMessage(0);     // ֹMessage loop
+        PostQuitMessage(0);     // 中止Message loop
         return 0;
     return 0;
     }
@@ -170,7 +173,7 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 void InitDirect3D()
 {
 #if defined(DEBUG) || defined(_DEBUG) 
-    //  D3D12 debug layer.
+    // 开启 D3D12 debug layer.
     {
         ComPtr<ID3D12Debug> debugController;
         ThrowIfFailed(D3D12GetDebugInterface(IID_PPV_ARGS(&debugController)));
@@ -181,12 +184,12 @@ void InitDirect3D()
     ComPtr<IDXGIFactory4> factory;
     ThrowIfFailed(CreateDXGIFactory1(IID_PPV_ARGS(&factory)));
 
-    // ֹʹalt+enterлȫģʽ
+    // 禁止使用alt+enter切换全屏模式
     ThrowIfFailed(factory->MakeWindowAssociation(m_hwnd, DXGI_MWA_NO_PRINT_SCREEN));
 
     if (FAILED(D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device))))
     {
-        // deviceʧܣFallback  WARP device.
+        // 如果device创建失败，Fallback 到 WARP device.
         ComPtr<IDXGIAdapter> warpAdapter;
         ThrowIfFailed(factory->EnumWarpAdapter(IID_PPV_ARGS(&warpAdapter)));
         ThrowIfFailed(D3D12CreateDevice(warpAdapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device)));
@@ -195,11 +198,11 @@ void InitDirect3D()
     m_rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
     m_cbvSrvUavDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
-    // Command QueueCommand AllocatorCommand ListtypeҪһ
+    // Command Queue，Command Allocator，Command List的type要一致
     D3D12_COMMAND_LIST_TYPE commandListType = D3D12_COMMAND_LIST_TYPE_DIRECT;
     D3D12_COMMAND_QUEUE_DESC queueDesc = {};
-    queueDesc.Type = commandListType;                   // Command List
-    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;    // ĬϵCommand Queue
+    queueDesc.Type = commandListType;                   // Command List的类型
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;    // 默认的Command Queue
     ThrowIfFailed(m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_commandQueue)));
     ThrowIfFailed(m_device->CreateCommandAllocator(commandListType, IID_PPV_ARGS(&m_commandAllocator)));
     ThrowIfFailed(m_device->CreateCommandList(0, commandListType, m_commandAllocator.Get(), nullptr, IID_PPV_ARGS(&m_commandList)));
@@ -217,7 +220,7 @@ void InitDirect3D()
     sd.BufferDesc.Format = m_backBufferFormat;
     sd.BufferDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
     sd.BufferDesc.Scaling = DXGI_MODE_SCALING_UNSPECIFIED;
-    sd.SampleDesc.Count = 1;                                // multisample
+    sd.SampleDesc.Count = 1;                                // 不能设置multisample
     sd.SampleDesc.Quality = 0;
     sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
     sd.BufferCount = m_swapChainBufferCount;
@@ -237,9 +240,9 @@ void InitDirect3D()
     CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHeapHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart());
     for (UINT i = 0; i < m_swapChainBufferCount; i++)
     {
-        ThrowIfFailed(m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_swapChainBuffer[i])));  // ᵼSwap Chainbufferü+1ʹComPtrԶrelease
+        ThrowIfFailed(m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_swapChainBuffer[i])));  // 会导致Swap Chain里的buffer对象引用计数+1，由于使用了ComPtr，会自动调用release
         m_device->CreateRenderTargetView(m_swapChainBuffer[i].Get(), nullptr, rtvHeapHandle);
-        rtvHeapHandle.Offset(1, m_rtvDescriptorSize);       // ƫһrtvС
+        rtvHeapHandle.Offset(1, m_rtvDescriptorSize);       // 偏移一个rtv大小
     }
 }
 
@@ -252,7 +255,7 @@ void InitAsset()
     };
     D3D12_INPUT_LAYOUT_DESC inputLayout = { inputElementDescs, _countof(inputElementDescs) };
 
-    m_commandList->Reset(m_commandAllocator.Get(), nullptr); // ֮ǰclosecommand listҪʹõҪresetſɼ¼command
+    m_commandList->Reset(m_commandAllocator.Get(), nullptr); // 之前close了command list，这里要使用到，需要reset操作才可记录command。
 
     InitMeshes();
     InitRenderItems();
@@ -260,15 +263,17 @@ void InitAsset()
     CreateRootSignature();
 
     // shader compiler
-    m_vsByteCode = d3d12Util::LoadBinary(L"shaders_vs.cso");
-    m_psByteCode = d3d12Util::LoadBinary(L"shaders_ps.cso");
+    // 只打开一次shaders.shaderpack（见Util/PackShaders.bat），没有打包时读取各个cso
+    m_shaderArchive.Open(L"shaders.shaderpack");
+    m_vsByteCode = d3d12Util::LoadShader(m_shaderArchive, L"shaders_vs.cso", ShaderStage::Vertex, m_vsBlob);
+    m_psByteCode = d3d12Util::LoadShader(m_shaderArchive, L"shaders_ps.cso", ShaderStage::Pixel, m_psBlob);
 
     // PSO
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = inputLayout;
     psoDesc.pRootSignature = m_rootSignature.Get();
-    psoDesc.VS = CD3DX12_SHADER_BYTECODE(m_vsByteCode.Get());
-    psoDesc.PS = CD3DX12_SHADER_BYTECODE(m_psByteCode.Get());
+    psoDesc.VS = m_vsByteCode;
+    psoDesc.PS = m_psByteCode;
     psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
     psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
     psoDesc.DepthStencilState.DepthEnable = FALSE;
@@ -280,7 +285,7 @@ void InitAsset()
     psoDesc.SampleDesc.Count = 1;
     ThrowIfFailed(m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState)));
 
-    // ڴС
+    // 窗口大小
     m_viewport.TopLeftX = 0;
     m_viewport.TopLeftY = 0;
     m_viewport.Width = static_cast<float>(m_clientWidth);
@@ -288,7 +293,7 @@ void InitAsset()
     m_viewport.MinDepth = 0.0f;
     m_viewport.MaxDepth = 1.0f;
 
-    // ü
+    // 裁剪区域
     m_scissorRect = { 0, 0, (long)m_clientWidth, (long)m_clientHeight };
 
     ThrowIfFailed(m_commandList->Close());
@@ -303,23 +308,23 @@ void FlushCommandQueue()
 {
     if (m_commandQueue == nullptr) return;
     m_fenceValue++;
-    ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), m_fenceValue));             // һָGPUfenceֵ
+    ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), m_fenceValue));             // 添加一个指令到GPU，用来更新fence值
 
-    if (m_fence->GetCompletedValue() < m_fenceValue)                                // ȡǰfenceֵ
+    if (m_fence->GetCompletedValue() < m_fenceValue)                                // 获取当前的fence值
     {
-        ThrowIfFailed(m_fence->SetEventOnCompletion(m_fenceValue, m_fenceEvent));   // fenceֵm_fenceValueʱᴥm_fenceEvent
-        WaitForSingleObject(m_fenceEvent, INFINITE);                                // ȴm_fenceEventִ
+        ThrowIfFailed(m_fence->SetEventOnCompletion(m_fenceValue, m_fenceEvent));   // 当fence值等于m_fenceValue时，会触发m_fenceEvent
+        WaitForSingleObject(m_fenceEvent, INFINITE);                                // 等待m_fenceEvent被执行
     }
 }
 
 void CreateRootSignature()
 {
-    // һroot signatureһroot parameter
-    // һroot parameterroot constantroot descriptordescriptor table
+    // 一个root signature定义一个root parameter数组
+    // 一个root parameter可以是root constant，root descriptor，descriptor table
     CD3DX12_ROOT_PARAMETER rootParameters[2];
 
-    CD3DX12_DESCRIPTOR_RANGE passCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0); // register(b0)Pass Constant Buffer
-    CD3DX12_DESCRIPTOR_RANGE objectCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 1);   // register(b1)Object Constant Buffer
+    CD3DX12_DESCRIPTOR_RANGE passCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0); // register(b0)，后续绑定Pass Constant Buffer
+    CD3DX12_DESCRIPTOR_RANGE objectCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 1);   // register(b1)，后续绑定Object Constant Buffer
     rootParameters[0].InitAsDescriptorTable(1, &passCbvTable);
     rootParameters[1].InitAsDescriptorTable(1, &objectCbvTable);
 
@@ -330,12 +335,12 @@ void CreateRootSignature()
     ThrowIfFailed(D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error));
     ThrowIfFailed(m_device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&m_rootSignature)));
 
-    // Ϊܣroot signatureҪܵСһ֡澡ٵȥı
+    // 为了性能，root signature要尽可能的小，并且在一帧里面尽量少的去改变它。
 }
 
 void InitMeshes()
 {
-    // ּĶ±Ϣ
+    // 几种几何体的顶点和下标信息
     std::vector<Vertex> vertices;
     std::vector<std::uint16_t> indices;
 
@@ -357,7 +362,7 @@ void InitMeshes()
     const UINT verticesSize = (UINT)vertices.size() * sizeof(Vertex);
     const UINT indicesSize = (UINT)indices.size() * sizeof(std::uint16_t);
 
-    // bufferеλ
+    // 单个几何体在buffer中的位置
     Submesh cubeSubmesh;
     cubeSubmesh.indexCount = (UINT)cubeMeshData.indices.size();
     cubeSubmesh.startIndexLocation = 0;
@@ -373,11 +378,11 @@ void InitMeshes()
     sphereSubmesh.startIndexLocation = pyramidSubmesh.startIndexLocation + (UINT)pyramidMeshData.indices.size();
     sphereSubmesh.baseVertexLocation = pyramidSubmesh.baseVertexLocation + (UINT)pyramidMeshData.vertices.size();
 
-    // mesh
+    // 创建mesh对象
     auto mesh = std::make_unique<Mesh>();
     mesh->name = "baseGeometryMesh";
 
-    // verticesindicesݿmesh
+    // 将vertices和indices数据拷贝到mesh中
     ThrowIfFailed(D3DCreateBlob(verticesSize, &mesh->vertexBufferCPU));
     CopyMemory(mesh->vertexBufferCPU->GetBufferPointer(), vertices.data(), verticesSize);
     ThrowIfFailed(D3DCreateBlob(indicesSize, &mesh->indexBufferCPU));
@@ -445,10 +450,10 @@ void InitRenderItems()
 
 void InitConstantBuffer()
 {
-    // Pass Constant Bufferupdateֵ
+    // 创建Pass Constant Buffer，在update里设置值
     m_passConstantBuffer = std::make_unique<UploadHeapConstantBuffer<PassConstant>>(m_device.Get(), 1);
 
-    // Object Constant Buffer
+    // 创建、设置Object Constant Buffer
     m_objectConstantBuffer = std::make_unique<UploadHeapConstantBuffer<ObjectConstant>>(m_device.Get(), m_renderItems.size());
     for (auto& item : m_renderItems)
     {
@@ -470,7 +475,7 @@ void InitConstantBuffer()
     CD3DX12_CPU_DESCRIPTOR_HANDLE cbvHeapHandle(m_cbvHeap->GetCPUDescriptorHandleForHeapStart());
     m_passConstantBuffer->CreateConstantBufferView(m_device.Get(), cbvHeapHandle, 0);
 
-    // Object Constant BufferӦCBV
+    // Object Constant Buffer对应的CBV
     for (UINT i = 0; i < itemCount; ++i)
     {
         auto handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_cbvHeap->GetCPUDescriptorHandleForHeapStart());
@@ -495,7 +500,7 @@ void OnRender()
 {
     PopulateCommandList();
 
-    // ϴCommand ListGPU
+    // 上传Command List到GPU
     ID3D12CommandList* ppCommandLists[] = { m_commandList.Get() };
     m_commandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
 
@@ -508,19 +513,19 @@ void OnRender()
 
 void PopulateCommandList()
 {
-    // Resetһ֡ʹõCommand Allocator洢ǰ֡Ҫ¼Command
+    // Reset上一帧使用的Command Allocator，用来存储当前帧要记录的Command
     ThrowIfFailed(m_commandAllocator->Reset());
-    // Resetһ֡ʹõCommand List¼¼ǰ֡Command
+    // Reset上一帧使用的Command List，重新记录当前帧的Command
     ThrowIfFailed(m_commandList->Reset(m_commandAllocator.Get(), m_pipelineState.Get()));
 
-    // Command List ResetҪ
+    // Command List Reset后，需要重新设置
     m_commandList->RSSetViewports(1, &m_viewport);
     m_commandList->RSSetScissorRects(1, &m_scissorRect);
 
     m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_swapChainBuffer[m_currendBackBufferIndex].Get(),
         D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
 
-    // ȡǰ
+    // 获取当前
     CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart(), m_currendBackBufferIndex, m_rtvDescriptorSize);
     m_commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
     m_commandList->ClearRenderTargetView(rtvHandle, Colors::Gray, 0, nullptr);
@@ -532,7 +537,7 @@ void PopulateCommandList()
     CD3DX12_GPU_DESCRIPTOR_HANDLE handle(m_cbvHeap->GetGPUDescriptorHandleForHeapStart());
     m_commandList->SetGraphicsRootDescriptorTable(0, handle);
 
-    // 
+    // 绘制
     for (auto& item : m_renderItems)
     {
         m_commandList->IASetVertexBuffers(0, 1, &item->mesh->GetVertexBufferView());
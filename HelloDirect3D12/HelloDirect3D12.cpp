@@ -4,7 +4,7 @@
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
 
-UINT m_clientWidth = 800, m_clientHeight = 600;     // ڳߴ
+UINT m_clientWidth = 800, m_clientHeight = 600;     // 窗口尺寸
 HWND m_hwnd;
 UINT64 m_fenceValue;
 static const UINT m_swapChainBufferCount = 2;
@@ -12,7 +12,7 @@ HANDLE m_fenceEvent;
 UINT m_rtvDescriptorSize;
 UINT m_currendBackBufferIndex = 0;
 
-DXGI_FORMAT m_backBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;  // ÿԪռ8-bitֵķΧ[0,1]
+DXGI_FORMAT m_backBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;  // 每个元素占用8-bit，值的范围[0,1]
 
 ComPtr<ID3D12Device> m_device;
 ComPtr<ID3D12CommandQueue> m_commandQueue;
@@ -24,15 +24,18 @@ ComPtr<ID3D12DescriptorHeap> m_rtvHeap;
 ComPtr<ID3D12Resource> m_swapChainBuffer[m_swapChainBufferCount];
 ComPtr<ID3D12RootSignature> m_rootSignature;
 ComPtr<ID3D12Resource> m_vertexBuffer;
-ComPtr<ID3DBlob> m_vsByteCode;
-ComPtr<ID3DBlob> m_psByteCode;
+ShaderArchive m_shaderArchive;              // 打包的shader，映射到内存中
+ComPtr<ID3DBlob> m_vsBlob;                  // archive中没有时从cso读取
+ComPtr<ID3DBlob> m_psBlob;
+D3D12_SHADER_BYTECODE m_vsByteCode = {};
+D3D12_SHADER_BYTECODE m_psByteCode = {};
 ComPtr<ID3D12PipelineState> m_pipelineState;
 
 D3D12_VERTEX_BUFFER_VIEW m_vertexBufferView;
 D3D12_VIEWPORT m_viewport;
 D3D12_RECT m_scissorRect;
 
-// 
+// 顶点数据
 struct Vertex
 {
     XMFLOAT3 position;
@@ -49,7 +52,7 @@ void OnUpdate();
 void OnRender();
 void OnDestroy();
 
-// Ӧóں
+// 应用程序入口函数
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine, int nCmdShow)
 {
     const wchar_t CLASS_NAME[] = L"Sample Window Class";
@@ -67,8 +70,8 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
         CLASS_NAME,                     // Window class
         L"Learn to Program Windows",    // Window text
         WS_OVERLAPPEDWINDOW,            // Window style
-        CW_USEDEFAULT, CW_USEDEFAULT,   // ڴС
-        m_clientWidth, m_clientHeight,  // λ
+        CW_USEDEFAULT, CW_USEDEFAULT,   // 窗口大小
+        m_clientWidth, m_clientHeight,  // 窗口位置
         NULL,       // Parent window    
         NULL,       // Menu
         hInstance,  // Instance handle
@@ -77,23 +80,23 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
 
     if (m_hwnd == NULL) return 0;
 
-    ShowWindow(m_hwnd, nCmdShow);         // ʾ
+    ShowWindow(m_hwnd, nCmdShow);         // 显示窗口
 
     try
     {
         InitDirect3D();
         InitAsset();
 
-        // ȡ¼̰ڱ仯ȵȡ
+        // 获取事件，例如鼠标点击，键盘按键，窗口变化等等。
         MSG msg = { };
         while (msg.message != WM_QUIT)      // message loop
         {
-            // PeekMessage  message queueǷmessageеĻ䵽msgУط0ֵ
-            // PM_REMOVE WM_PAINT͵message⣬messageִPeekMessageƳ message queue
+            // PeekMessage 检查 message queue中是否有message，如果有的话将其到msg中，返回非0的值
+            // PM_REMOVE 除了WM_PAINT类型的message外，其他的message会在执行完PeekMessage后被移出 message queue
             if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
             {
                 TranslateMessage(&msg);
-                DispatchMessage(&msg);      // ᴥ WindowProc 
+                DispatchMessage(&msg);      // 会触发 WindowProc 函数
             }
             else
             {
@@ -113,13 +116,13 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
     return 0;
 }
 
-// ¼
+// 事件处理
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
     switch (uMsg)
     {
     case WM_DESTROY:
-        PostQuitMessage(0);     // ֹMessage loop
+        PostQuitMessage(0);     // 中止Message loop
         return 0;
     return 0;
     }
@@ -129,7 +132,7 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 void InitDirect3D()
 {
 #if defined(DEBUG) || defined(_DEBUG) 
-    //  D3D12 debug layer.
+    // 开启 D3D12 debug layer.
     {
         ComPtr<ID3D12Debug> debugController;
         ThrowIfFailed(D3D12GetDebugInterface(IID_PPV_ARGS(&debugController)));
@@ -140,22 +143,22 @@ void InitDirect3D()
     ComPtr<IDXGIFactory4> factory;
     ThrowIfFailed(CreateDXGIFactory1(IID_PPV_ARGS(&factory)));
 
-    // ֹʹalt+enterлȫģʽ
+    // 禁止使用alt+enter切换全屏模式
     ThrowIfFailed(factory->MakeWindowAssociation(m_hwnd, DXGI_MWA_NO_PRINT_SCREEN));
 
     if (FAILED(D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device))))
     {
-        // deviceʧܣFallback  WARP device.
+        // 如果device创建失败，Fallback 到 WARP device.
         ComPtr<IDXGIAdapter> warpAdapter;
         ThrowIfFailed(factory->EnumWarpAdapter(IID_PPV_ARGS(&warpAdapter)));
         ThrowIfFailed(D3D12CreateDevice(warpAdapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device)));
     }
 
-    // Command QueueCommand AllocatorCommand ListtypeҪһ
+    // Command Queue，Command Allocator，Command List的type要一致
     D3D12_COMMAND_LIST_TYPE commandListType = D3D12_COMMAND_LIST_TYPE_DIRECT;
     D3D12_COMMAND_QUEUE_DESC queueDesc = {};
-    queueDesc.Type = commandListType;                   // Command List
-    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;    // ĬϵCommand Queue
+    queueDesc.Type = commandListType;                   // Command List的类型
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;    // 默认的Command Queue
     ThrowIfFailed(m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_commandQueue)));
     ThrowIfFailed(m_device->CreateCommandAllocator(commandListType, IID_PPV_ARGS(&m_commandAllocator)));
     ThrowIfFailed(m_device->CreateCommandList(0, commandListType, m_commandAllocator.Get(), nullptr, IID_PPV_ARGS(&m_commandList)));
@@ -173,7 +176,7 @@ void InitDirect3D()
     sd.BufferDesc.Format = m_backBufferFormat;
     sd.BufferDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
     sd.BufferDesc.Scaling = DXGI_MODE_SCALING_UNSPECIFIED;
-    sd.SampleDesc.Count = 1;                                // multisample
+    sd.SampleDesc.Count = 1;                                // 不能设置multisample
     sd.SampleDesc.Quality = 0;
     sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
     sd.BufferCount = m_swapChainBufferCount;
@@ -194,9 +197,9 @@ void InitDirect3D()
     CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHeapHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart());
     for (UINT i = 0; i < m_swapChainBufferCount; i++)
     {
-        ThrowIfFailed(m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_swapChainBuffer[i])));  // ᵼSwap Chainbufferü+1ʹComPtrԶrelease
+        ThrowIfFailed(m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_swapChainBuffer[i])));  // 会导致Swap Chain里的buffer对象引用计数+1，由于使用了ComPtr，会自动调用release
         m_device->CreateRenderTargetView(m_swapChainBuffer[i].Get(), nullptr, rtvHeapHandle);
-        rtvHeapHandle.Offset(1, m_rtvDescriptorSize);       // ƫһrtvС
+        rtvHeapHandle.Offset(1, m_rtvDescriptorSize);       // 偏移一个rtv大小
     }
 }
 
@@ -209,7 +212,7 @@ void InitAsset()
     };
     D3D12_INPUT_LAYOUT_DESC inputLayout = { inputElementDescs, _countof(inputElementDescs) };
 
-    // עⶥ˳ʱͿ
+    // 注意顶点顺序，逆时针了你就看不见了
     Vertex triangleVertices[] =
     {        
         { { 0.0f, 0.5f, 0.0f }, XMFLOAT4(Colors::Red) },
@@ -217,7 +220,7 @@ void InitAsset()
         { { -0.5f, -0.5f, 0.0f }, XMFLOAT4(Colors::Blue) },
     };
 
-    // ȷݲCommandִк󣬿ͷupload heapresourceͨComPtrԶRelease
+    // 确保传输数据操作的Command被执行后，可以释放upload heap的resource，通过ComPtr会自动Release
     ComPtr<ID3D12Resource> vertexUploadBuffer;
 
     const UINT triangleVerticesSize = sizeof(triangleVertices);
@@ -237,18 +240,18 @@ void InitAsset()
         nullptr,
         IID_PPV_ARGS(&vertexUploadBuffer)));
 
-    // ҪCPU
+    // 设置要传输的CPU数据
     D3D12_SUBRESOURCE_DATA subResourceData = {};
     subResourceData.pData = triangleVertices;
     subResourceData.RowPitch = triangleVerticesSize;
     subResourceData.SlicePitch = subResourceData.RowPitch;
 
-    m_commandList->Reset(m_commandAllocator.Get(), nullptr); // ֮ǰclosecommand listҪʹõҪresetſɼ¼command
+    m_commandList->Reset(m_commandAllocator.Get(), nullptr); // 之前close了command list，这里要使用到，需要reset操作才可记录command。
 
-    // ǰҪresourcestate
+    // 传输前要更改resource的state
     m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_vertexBuffer.Get(),
         D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
-    // ȽCPUڴݿupload heapУȻͨID3D12CommandList::CopySubresourceRegionupload heapпdefault buffer
+    // 会先将CPU内存数据拷贝到upload heap中，然后再通过ID3D12CommandList::CopySubresourceRegion从upload heap中拷贝到default buffer中
     UpdateSubresources<1>(m_commandList.Get(), m_vertexBuffer.Get(), vertexUploadBuffer.Get(), 0, 0, 1, &subResourceData);
     m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_vertexBuffer.Get(),
         D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ));
@@ -257,7 +260,7 @@ void InitAsset()
     m_vertexBufferView.SizeInBytes = triangleVerticesSize;
     m_vertexBufferView.StrideInBytes = sizeof(Vertex);
 
-    // һյroot signature
+    // 创建一个空的root signature
     CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
     rootSignatureDesc.Init(0, nullptr, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
     ComPtr<ID3DBlob> signature;
@@ -266,15 +269,17 @@ void InitAsset()
     ThrowIfFailed(m_device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&m_rootSignature)));
 
     // shader compiler
-    m_vsByteCode = d3d12Util::LoadBinary(L"shaders_vs.cso");
-    m_psByteCode = d3d12Util::LoadBinary(L"shaders_ps.cso");
+    // 只打开一次shaders.shaderpack（见Util/PackShaders.bat），没有打包时读取各个cso
+    m_shaderArchive.Open(L"shaders.shaderpack");
+    m_vsByteCode = d3d12Util::LoadShader(m_shaderArchive, L"shaders_vs.cso", ShaderStage::Vertex, m_vsBlob);
+    m_psByteCode = d3d12Util::LoadShader(m_shaderArchive, L"shaders_ps.cso", ShaderStage::Pixel, m_psBlob);
 
     // PSO
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = inputLayout;
     psoDesc.pRootSignature = m_rootSignature.Get();
-    psoDesc.VS = CD3DX12_SHADER_BYTECODE(m_vsByteCode.Get());
-    psoDesc.PS = CD3DX12_SHADER_BYTECODE(m_psByteCode.Get());
+    psoDesc.VS = m_vsByteCode;
+    psoDesc.PS = m_psByteCode;
     psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
     psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
     psoDesc.DepthStencilState.DepthEnable = FALSE;
@@ -286,7 +291,7 @@ void InitAsset()
     psoDesc.SampleDesc.Count = 1;
     ThrowIfFailed(m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState)));
 
-    // ڴС
+    // 窗口大小
     m_viewport.TopLeftX = 0;
     m_viewport.TopLeftY = 0;
     m_viewport.Width = static_cast<float>(m_clientWidth);
@@ -294,7 +299,7 @@ void InitAsset()
     m_viewport.MinDepth = 0.0f;
     m_viewport.MaxDepth = 1.0f;
 
-    // ü
+    // 裁剪区域
     m_scissorRect = { 0, 0, (long)m_clientWidth, (long)m_clientHeight };
 
     ThrowIfFailed(m_commandList->Close());
@@ -306,32 +311,32 @@ void InitAsset()
 void FlushCommandQueue()
 {
     m_fenceValue++;
-    ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), m_fenceValue));             // һָGPUfenceֵ
+    ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), m_fenceValue));             // 添加一个指令到GPU，用来更新fence值
 
-    if (m_fence->GetCompletedValue() < m_fenceValue)                                // ȡǰfenceֵ
+    if (m_fence->GetCompletedValue() < m_fenceValue)                                // 获取当前的fence值
     {
-        ThrowIfFailed(m_fence->SetEventOnCompletion(m_fenceValue, m_fenceEvent));   // fenceֵm_fenceValueʱᴥm_fenceEvent
-        WaitForSingleObject(m_fenceEvent, INFINITE);                                // ȴm_fenceEventִ
+        ThrowIfFailed(m_fence->SetEventOnCompletion(m_fenceValue, m_fenceEvent));   // 当fence值等于m_fenceValue时，会触发m_fenceEvent
+        WaitForSingleObject(m_fenceEvent, INFINITE);                                // 等待m_fenceEvent被执行
     }
 }
 
 void PopulateCommandList()
 {
-    // Resetһ֡ʹõCommand Allocator洢ǰ֡Ҫ¼Command
+    // Reset上一帧使用的Command Allocator，用来存储当前帧要记录的Command
     ThrowIfFailed(m_commandAllocator->Reset());
-    // Resetһ֡ʹõCommand List¼¼ǰ֡Command
+    // Reset上一帧使用的Command List，重新记录当前帧的Command
     ThrowIfFailed(m_commandList->Reset(m_commandAllocator.Get(), m_pipelineState.Get()));
 
     m_commandList->SetGraphicsRootSignature(m_rootSignature.Get());
 
-    // Command List ResetҪ
+    // Command List Reset后，需要重新设置
     m_commandList->RSSetViewports(1, &m_viewport);
     m_commandList->RSSetScissorRects(1, &m_scissorRect);
 
     m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_swapChainBuffer[m_currendBackBufferIndex].Get(),
         D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
 
-    // ȡǰ
+    // 获取当前
     CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart(), m_currendBackBufferIndex, m_rtvDescriptorSize);
     m_commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
     m_commandList->ClearRenderTargetView(rtvHandle, Colors::Gray, 0, nullptr);
@@ -353,7 +358,7 @@ void OnRender()
 {
     PopulateCommandList();
 
-    // ϴCommand ListGPU
+    // 上传Command List到GPU
     ID3D12CommandList* ppCommandLists[] = { m_commandList.Get() };
     m_commandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
 
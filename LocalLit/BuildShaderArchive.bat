@@ -0,0 +1,14 @@
+::离线编译所有光源数量组合的shader并打包为shaders_lights.shaderpack和shaders_root_lights.shaderpack（见LightPermutations.h），修改shader后需要再运行一次
+::ShaderBuilder只重新编译有变化的组合，加上-release参数时同时编译并打包Release版本使用的/O3版本
+::需要先编译Util/ShaderBuilder/ShaderBuilder.sln和Util/LightPermutations/LightPermutations.sln
+::仓库中的shaders_lights.shaderpack只有场景默认的1个平行光、1个点光源、1个聚光灯的Debug版本，其他组合、RootDescriptor布局和Release版本需要运行此脚本生成
+@echo off
+set tools=%~dp0..\Util
+if not exist "%~dp0permutations" mkdir "%~dp0permutations"
+"%tools%\LightPermutations\x64\Release\LightPermutations.exe" -list "%~dp0."
+if errorlevel 1 goto end
+"%tools%\ShaderBuilder\x64\Release\ShaderBuilder.exe" "%~dp0permutations\jobs.txt" %*
+if errorlevel 1 goto end
+"%tools%\LightPermutations\x64\Release\LightPermutations.exe" -pack %* "%~dp0."
+:end
+pause
\ No newline at end of file
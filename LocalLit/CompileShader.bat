@@ -1,2 +0,0 @@
-../Util/Compiler.bat shaders.hlsl
-pause
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../Common/ShaderArchive.h"
+#include "../Common/ShaderPermutation.h"
+#include <cstdint>
+#include <vector>
+
+// LocalLit各光源数量组合的shader由Util/LightPermutations离线编译并打包（见BuildShaderArchive.bat），LocalLit.cpp运行时只读取archive。
+// 两边共用这里的定义，修改后需要重新运行BuildShaderArchive.bat
+namespace LocalLitPermutations
+{
+    const std::uint32_t MaxLightCount = 16;         // 与d3d12Util.h中的MAX_LIGHT_COUNT一致
+
+    // 每种root signature布局一个archive
+    struct Layout
+    {
+        const char* archiveName;                    // 在LocalLit目录下
+        const char* outputPrefix;                   // 离线编译的cso文件名的前缀
+        bool rootDescriptor;                        // 以ROOT_DESCRIPTOR_LAYOUT=1编译
+    };
+
+    const Layout Layouts[] =
+    {
+        { "shaders_lights.shaderpack", "lights", false },
+        { "shaders_root_lights.shaderpack", "root_lights", true },
+    };
+
+    struct Stage
+    {
+        ShaderStage stage;
+        const char* entryPoint;
+        const char* target;
+        const char* suffix;
+    };
+
+    const Stage Stages[] =
+    {
+        { ShaderStage::Vertex, "VSMain", "vs_5_0", "vs" },
+        { ShaderStage::Pixel, "PSMain", "ps_5_0", "ps" },
+    };
+
+    inline LightPermutationSet MakePermutationSet()
+    {
+        return LightPermutationSet({ 0, 1, 2, 4 }, { 0, 1, 2, 4 }, { 0, 1, 2, 4 }, MaxLightCount);
+    }
+
+    inline std::vector<ShaderDefine> GetDefines(const Layout& layout, const LightCounts& counts)
+    {
+        std::vector<ShaderDefine> baseDefines;
+        if (layout.rootDescriptor)
+            baseDefines.push_back({ "ROOT_DESCRIPTOR_LAYOUT", "1" });
+        return LightPermutationSet::GetDefines(counts, baseDefines);
+    }
+}
@@ -1,12 +1,17 @@
 #include <windows.h>
 #include "../Common/d3d12Util.h"
 #include "../Common/UploadHeapConstantBuffer.h"
+#include "../Common/PipelineStateCache.h"
+#include "../Common/ShaderArchive.h"
+#include "../Common/ShaderPermutation.h"
+#include "../Common/ShaderReflection.h"
+#include "LightPermutations.h"
 #include <unordered_map> 
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
 
-// 
+// 顶点数据
 struct Vertex
 {
     XMFLOAT3 position;
@@ -29,31 +34,38 @@ struct PassConstant
     Light lights[MAX_LIGHT_COUNT];
 };
 
+// root signature的布局
+enum class RootSignatureLayout
+{
+    DescriptorTable,    // pass、object、material的CBV都通过descriptor table绑定
+    RootDescriptor,     // pass、object使用root CBV，材质下标使用root constant，材质数据从structured buffer中读取
+};
+
 struct RenderItem
 {
     RenderItem() = default;
 
-    // ģͱ任󣬼µλãԼתֵ
+    // 模型变换矩阵，即物体在世界坐标下的位置，缩放以及旋转值
     XMFLOAT4X4 modelMatrix = MathUtil::Identity4x4();
-    // ӦObjectConstant±
+    // 对应ObjectConstant的下标
     UINT objectCBIndex = -1;
 
-    // Ӧvertexindex bufferϢ
+    // 对应的vertex和index buffer信息
     Mesh* mesh = nullptr;
 
-    // ӦĲ
+    // 对应的材质
     Material* material = nullptr;
 
     D3D12_PRIMITIVE_TOPOLOGY primitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 
-    // ӦmeshеSubmeshֵ
+    // 对应mesh中的Submesh值
     UINT indexCount = 0;
     UINT startIndexLocation = 0;
     int baseVertexLocation = 0;
 };
 
 
-UINT m_clientWidth = 800, m_clientHeight = 600;     // ڳߴ
+UINT m_clientWidth = 800, m_clientHeight = 600;     // 窗口尺寸
 HWND m_hwnd;
 UINT64 m_fenceValue;
 static const UINT m_swapChainBufferCount = 2;
@@ -61,7 +73,7 @@ HANDLE m_fenceEvent;
 UINT m_rtvDescriptorSize, m_cbvSrvUavDescriptorSize;
 UINT m_currendBackBufferIndex = 0;
 
-DXGI_FORMAT m_backBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;  // ÿԪռ8-bitֵķΧ[0,1]
+DXGI_FORMAT m_backBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;  // 每个元素占用8-bit，值的范围[0,1]
 
 ComPtr<ID3D12Device> m_device;
 ComPtr<ID3D12CommandQueue> m_commandQueue;
@@ -77,16 +89,36 @@ std::vector<std::unique_ptr<RenderItem>> m_renderItems;
 std::unique_ptr<UploadHeapConstantBuffer<ObjectConstant>> m_objectConstantBuffer;
 std::unique_ptr<UploadHeapConstantBuffer<PassConstant>> m_passConstantBuffer;
 std::unique_ptr<UploadHeapConstantBuffer<MaterialConstant>> m_materialConstantBuffer;
+std::unique_ptr<UploadHeapBuffer<MaterialConstant>> m_materialStructuredBuffer;  // RootDescriptor布局下所有材质的数据
+RootSignatureLayout m_rootSignatureLayout = RootSignatureLayout::DescriptorTable;
 ComPtr<ID3D12DescriptorHeap> m_cbvHeap;
-ComPtr<ID3DBlob> m_vsByteCode;
-ComPtr<ID3DBlob> m_psByteCode;
+ShaderArchive m_shaderArchive;             // 各光源数量组合离线编译好的shader（见BuildShaderArchive.bat）
+D3D12_SHADER_BYTECODE m_vsByteCode = {};    // 指向m_shaderArchive中的数据，archive中没有时指向m_vsBlob
+D3D12_SHADER_BYTECODE m_psByteCode = {};
+ComPtr<ID3DBlob> m_vsBlob;                  // archive中没有当前组合时运行时编译的shader
+ComPtr<ID3DBlob> m_psBlob;
 ComPtr<ID3D12PipelineState> m_pipelineState;
+std::unique_ptr<PipelineStateCache> m_pipelineStateCache;
+UINT64 m_rootSignatureHash = 0;     // 序列化后root signature的哈希，作为PSO哈希的一部分
 
 D3D12_VIEWPORT m_viewport;
 D3D12_RECT m_scissorRect;
 
 std::unordered_map<std::string, std::unique_ptr<Material>> m_materials;
 
+// 场景中的光源，常量缓冲中按m_lightPermutation的布局依次存放
+std::vector<Light> m_directLights;
+std::vector<Light> m_pointLights;
+std::vector<Light> m_spotLights;
+// 每种光源编译0、1、2、4个的版本，使用能覆盖场景光源的最小组合
+LightPermutationSet m_lightPermutations = LocalLitPermutations::MakePermutationSet();
+LightCounts m_lightPermutation;
+
+// 统计绘制循环中记录command的耗时，用于比较两种root signature布局
+LONGLONG m_drawRecordCounts = 0;
+UINT m_drawRecordDrawCount = 0;
+UINT m_drawRecordFrameCount = 0;
+
 
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam);
 
@@ -96,15 +128,19 @@ void InitMeshes();
 void InitRenderItems();
 void InitMaterials();
 void InitConstantBuffer();
+void InitLights();
+void LoadShaders();
+void CompileShaderPermutation(const std::vector<ShaderDefine>& defines);
+void ValidateShaderLayout(const D3D12_SHADER_BYTECODE& byteCode);
 void FlushCommandQueue();
-void CreateRootSignature();
+void CreateRootSignature(RootSignatureLayout layout);
 void PopulateCommandList();
 void OnUpdate();
 void OnRender();
 void OnDestroy();
 
 
-// Ӧóں
+// 应用程序入口函数
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine, int nCmdShow)
 {
     const wchar_t CLASS_NAME[] = L"Sample Window Class";
@@ -122,8 +158,8 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
         CLASS_NAME,                     // Window class
         L"Local Lit",                   // Window text
         WS_OVERLAPPEDWINDOW,            // Window style
-        CW_USEDEFAULT, CW_USEDEFAULT,   // ڴС
-        m_clientWidth, m_clientHeight,  // λ
+        CW_USEDEFAULT, CW_USEDEFAULT,   // 窗口大小
+        m_clientWidth, m_clientHeight,  // 窗口位置
         NULL,       // Parent window    
         NULL,       // Menu
         hInstance,  // Instance handle
@@ -132,23 +168,23 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
 
     if (m_hwnd == NULL) return 0;
 
-    ShowWindow(m_hwnd, nCmdShow);         // ʾ
+    ShowWindow(m_hwnd, nCmdShow);         // 显示窗口
 
     try
     {
         InitDirect3D();
         InitAsset();
 
-        // ȡ¼̰ڱ仯ȵȡ
+        // 获取事件，例如鼠标点击，键盘按键，窗口变化等等。
         MSG msg = { };
         while (msg.message != WM_QUIT)      // message loop
         {
-            // PeekMessage  message queueǷmessageеĻ䵽msgУط0ֵ
-            // PM_REMOVE WM_PAINT͵message⣬messageִPeekMessageƳ message queue
+            // PeekMessage 检查 message queue中是否有message，如果有的话将其到msg中，返回非0的值
+            // PM_REMOVE 除了WM_PAINT类型的message外，其他的message会在执行完PeekMessage后被移出 message queue
             if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
             {
                 TranslateMessage(&msg);
-                DispatchMessage(&msg);      // ᴥ WindowProc 
+                DispatchMessage(&msg);      // 会触发 WindowProc 函数
             }
             else
             {
@@ -168,13 +204,13 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
     return 0;
 }
 
-// ¼
+// 事件处理
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
     switch (uMsg)
     {
     case WM_DESTROY:
-        PostQuitMessage(0);     // ֹMessage loop
+        PostQuitMessage(0);     // 中止Message loop
         return 0;
         return 0;
     }
@@ -184,7 +220,7 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 void InitDirect3D()
 {
 #if defined(DEBUG) || defined(_DEBUG) 
-    //  D3D12 debug layer.
+    // 开启 D3D12 debug layer.
     {
         ComPtr<ID3D12Debug> debugController;
         ThrowIfFailed(D3D12GetDebugInterface(IID_PPV_ARGS(&debugController)));
@@ -195,12 +231,12 @@ void InitDirect3D()
     ComPtr<IDXGIFactory4> factory;
     ThrowIfFailed(CreateDXGIFactory1(IID_PPV_ARGS(&factory)));
 
-    // ֹʹalt+enterлȫģʽ
+    // 禁止使用alt+enter切换全屏模式
     ThrowIfFailed(factory->MakeWindowAssociation(m_hwnd, DXGI_MWA_NO_PRINT_SCREEN));
 
     if (FAILED(D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device))))
     {
-        // deviceʧܣFallback  WARP device.
+        // 如果device创建失败，Fallback 到 WARP device.
         ComPtr<IDXGIAdapter> warpAdapter;
         ThrowIfFailed(factory->EnumWarpAdapter(IID_PPV_ARGS(&warpAdapter)));
         ThrowIfFailed(D3D12CreateDevice(warpAdapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device)));
@@ -209,11 +245,11 @@ void InitDirect3D()
     m_rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
     m_cbvSrvUavDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
-    // Command QueueCommand AllocatorCommand ListtypeҪһ
+    // Command Queue，Command Allocator，Command List的type要一致
     D3D12_COMMAND_LIST_TYPE commandListType = D3D12_COMMAND_LIST_TYPE_DIRECT;
     D3D12_COMMAND_QUEUE_DESC queueDesc = {};
-    queueDesc.Type = commandListType;                   // Command List
-    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;    // ĬϵCommand Queue
+    queueDesc.Type = commandListType;                   // Command List的类型
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;    // 默认的Command Queue
     ThrowIfFailed(m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_commandQueue)));
     ThrowIfFailed(m_device->CreateCommandAllocator(commandListType, IID_PPV_ARGS(&m_commandAllocator)));
     ThrowIfFailed(m_device->CreateCommandList(0, commandListType, m_commandAllocator.Get(), nullptr, IID_PPV_ARGS(&m_commandList)));
@@ -231,7 +267,7 @@ void InitDirect3D()
     sd.BufferDesc.Format = m_backBufferFormat;
     sd.BufferDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
     sd.BufferDesc.Scaling = DXGI_MODE_SCALING_UNSPECIFIED;
-    sd.SampleDesc.Count = 1;                                // multisample
+    sd.SampleDesc.Count = 1;                                // 不能设置multisample
     sd.SampleDesc.Quality = 0;
     sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
     sd.BufferCount = m_swapChainBufferCount;
@@ -251,39 +287,38 @@ void InitDirect3D()
     CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHeapHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart());
     for (UINT i = 0; i < m_swapChainBufferCount; i++)
     {
-        ThrowIfFailed(m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_swapChainBuffer[i])));  // ᵼSwap Chainbufferü+1ʹComPtrԶrelease
+        ThrowIfFailed(m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_swapChainBuffer[i])));  // 会导致Swap Chain里的buffer对象引用计数+1，由于使用了ComPtr，会自动调用release
         m_device->CreateRenderTargetView(m_swapChainBuffer[i].Get(), nullptr, rtvHeapHandle);
-        rtvHeapHandle.Offset(1, m_rtvDescriptorSize);       // ƫһrtvС
+        rtvHeapHandle.Offset(1, m_rtvDescriptorSize);       // 偏移一个rtv大小
     }
 }
 
 void InitAsset()
 {
-    D3D12_INPUT_ELEMENT_DESC inputElementDescs[] =
+    // static：PSO在后台线程中创建时仍会访问input layout
+    static const D3D12_INPUT_ELEMENT_DESC inputElementDescs[] =
     {
         { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
         { "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, D3D12_APPEND_ALIGNED_ELEMENT, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
     };
     D3D12_INPUT_LAYOUT_DESC inputLayout = { inputElementDescs, _countof(inputElementDescs) };
 
-    m_commandList->Reset(m_commandAllocator.Get(), nullptr); // ֮ǰclosecommand listҪʹõҪresetſɼ¼command
+    m_commandList->Reset(m_commandAllocator.Get(), nullptr); // 之前close了command list，这里要使用到，需要reset操作才可记录command。
 
-    InitMeshes();
-    InitMaterials();
-    InitRenderItems();
-    InitConstantBuffer();
-    CreateRootSignature();
+    // PSO在后台线程中创建，上一次运行保存到pipeline library中的直接读取
+    m_pipelineStateCache = std::make_unique<PipelineStateCache>(m_device.Get(), L"LocalLit.psolib");
 
-    // shader compiler
-    m_vsByteCode = d3d12Util::LoadBinary(L"shaders_vs.cso");
-    m_psByteCode = d3d12Util::LoadBinary(L"shaders_ps.cso");
+    CreateRootSignature(m_rootSignatureLayout);
+
+    InitLights();
+    LoadShaders();
 
     // PSO
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = inputLayout;
     psoDesc.pRootSignature = m_rootSignature.Get();
-    psoDesc.VS = CD3DX12_SHADER_BYTECODE(m_vsByteCode.Get());
-    psoDesc.PS = CD3DX12_SHADER_BYTECODE(m_psByteCode.Get());
+    psoDesc.VS = m_vsByteCode;
+    psoDesc.PS = m_psByteCode;
     psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
     //psoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME;
     psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
@@ -294,9 +329,15 @@ void InitAsset()
     psoDesc.NumRenderTargets = 1;
     psoDesc.RTVFormats[0] = m_backBufferFormat;
     psoDesc.SampleDesc.Count = 1;
-    ThrowIfFailed(m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState)));
+    UINT64 psoHash = m_pipelineStateCache->Request(psoDesc, m_rootSignatureHash);
 
-    // ڴС
+    // PSO创建的同时初始化其他资源
+    InitMeshes();
+    InitMaterials();
+    InitRenderItems();
+    InitConstantBuffer();
+
+    // 窗口大小
     m_viewport.TopLeftX = 0;
     m_viewport.TopLeftY = 0;
     m_viewport.Width = static_cast<float>(m_clientWidth);
@@ -304,7 +345,7 @@ void InitAsset()
     m_viewport.MinDepth = 0.0f;
     m_viewport.MaxDepth = 1.0f;
 
-    // ü
+    // 裁剪区域
     m_scissorRect = { 0, 0, (long)m_clientWidth, (long)m_clientHeight };
 
     ThrowIfFailed(m_commandList->Close());
@@ -313,44 +354,191 @@ void InitAsset()
     FlushCommandQueue();
 
     m_meshes["baseGeometryMesh"]->DisposeUploaders();
+
+    m_pipelineState = m_pipelineStateCache->Get(psoHash);
+}
+
+void InitLights()
+{
+    // 平行光
+    Light directLight;
+    XMStoreFloat3(&directLight.direction, XMVector3Normalize(XMVectorSet(3.0f, -4.0f, -2.0f, 1.0f)));
+    directLight.strength = { 1.0f, 1.0f, 1.0f };
+    m_directLights.push_back(directLight);
+
+    // 点光源
+    Light pointLight;
+    pointLight.strength = { 1.0f, 0.0f, 0.0f };
+    pointLight.falloffStart = 0;
+    pointLight.falloffEnd = 15;
+    pointLight.position = { 3.0f, 1.5f, -1.5f };
+    m_pointLights.push_back(pointLight);
+
+    // 聚光灯
+    Light spotLight;
+    spotLight.strength = { 0.0f, 1.0f, 0.0f };
+    spotLight.falloffStart = 0;
+    spotLight.falloffEnd = 40;
+    spotLight.position = { -3.0f, 2.0f, -5.0f };
+    XMStoreFloat3(&spotLight.direction, XMVector3Normalize(XMVectorSet(1.0f, -1.0f, 1.0f, 1.0f)));
+    spotLight.spotPower = 16;
+    m_spotLights.push_back(spotLight);
+}
+
+void LoadShaders()
+{
+    static_assert(LocalLitPermutations::MaxLightCount == MAX_LIGHT_COUNT, "LightPermutations.h与MAX_LIGHT_COUNT不一致");
+
+    LightCounts activeLights;
+    activeLights.directCount = (UINT)m_directLights.size();
+    activeLights.pointCount = (UINT)m_pointLights.size();
+    activeLights.spotCount = (UINT)m_spotLights.size();
+    if (!m_lightPermutations.SelectCovering(activeLights, m_lightPermutation))
+        ThrowIfFailed(E_INVALIDARG);
+
+    // RootDescriptor布局使用定义了ROOT_DESCRIPTOR_LAYOUT的版本，两种布局各自一个archive
+    const LocalLitPermutations::Layout& layout = LocalLitPermutations::Layouts[m_rootSignatureLayout == RootSignatureLayout::RootDescriptor ? 1 : 0];
+    std::vector<ShaderDefine> defines = LocalLitPermutations::GetDefines(layout, m_lightPermutation);
+#if defined(DEBUG) || defined(_DEBUG)
+    const char* flags = ShaderDebugFlags;
+#else
+    const char* flags = ShaderReleaseFlags;
+#endif
+
+    // archive映射到内存中，bytecode直接指向映射的数据。key包含target和编译选项，Release版本需要以-release运行BuildShaderArchive.bat
+    ShaderArchive::Bytecode vs, ps;
+    bool loaded = m_shaderArchive.Open(std::string(layout.archiveName)) &&
+        m_shaderArchive.Find(HashShaderPermutation(defines, "vs_5_0", flags), ShaderStage::Vertex, vs) &&
+        m_shaderArchive.Find(HashShaderPermutation(defines, "ps_5_0", flags), ShaderStage::Pixel, ps);
+    if (loaded)
+    {
+        m_vsByteCode = { vs.data, vs.size };
+        m_psByteCode = { ps.data, ps.size };
+    }
+    else
+    {
+        // archive不存在或者不是最新的，只编译当前需要的组合，不重新生成archive
+        OutputDebugStringA((std::string(layout.archiveName) + "中没有当前的光源组合，请运行LocalLit/BuildShaderArchive.bat\n").c_str());
+        m_shaderArchive.Close();
+        CompileShaderPermutation(defines);
+    }
+
+#if defined(DEBUG) || defined(_DEBUG)
+    ValidateShaderLayout(m_vsByteCode);
+    ValidateShaderLayout(m_psByteCode);
+#endif
+}
+
+// 从编译出的shader中读取cbuffer的布局，与C++中的结构体比较，不一致时在输出窗口打印并抛出异常。
+// 不同的光源组合和root signature布局用到的cbuffer不同，shader中没有的cbuffer不检查
+void ValidateShaderLayout(const D3D12_SHADER_BYTECODE& byteCode)
+{
+    DxbcContainer container;
+    ShaderReflection reflection;
+    std::string error;
+    if (!container.Parse(byteCode.pShaderBytecode, byteCode.BytecodeLength, error) || !ReflectShader(container, reflection, error))
+    {
+        OutputDebugStringA((error + "\n").c_str());
+        ThrowIfFailed(E_FAIL);
+    }
+
+    std::vector<std::string> errors;
+    if (const ShaderConstantBuffer* passData = reflection.FindConstantBuffer("passData"))
+    {
+        ValidateLayout(*passData, "", { CPU_FIELD(PassConstant, viewMatrix), CPU_FIELD(PassConstant, projectMatrix),
+            CPU_FIELD(PassConstant, cameraPositionInWorld), CPU_FIELD(PassConstant, padding0), CPU_FIELD(PassConstant, ambientLight),
+            CPU_FIELD(PassConstant, lights) }, sizeof(PassConstant), errors);
+        ValidateLayout(*passData, "lights", { CPU_FIELD(Light, strength), CPU_FIELD(Light, falloffStart), CPU_FIELD(Light, direction),
+            CPU_FIELD(Light, falloffEnd), CPU_FIELD(Light, position), CPU_FIELD(Light, spotPower) }, sizeof(Light), errors);
+    }
+    if (const ShaderConstantBuffer* objectData = reflection.FindConstantBuffer("objectData"))
+    {
+        ValidateLayout(*objectData, "", { CPU_FIELD(ObjectConstant, modelMatrix), CPU_FIELD(ObjectConstant, normalMatrix) },
+            sizeof(ObjectConstant), errors);
+    }
+    if (const ShaderConstantBuffer* materialData = reflection.FindConstantBuffer("materialData"))
+    {
+        ValidateLayout(*materialData, "", { CPU_FIELD(MaterialConstant, albedo), CPU_FIELD(MaterialConstant, fresnelR0),
+            CPU_FIELD(MaterialConstant, roughness) }, sizeof(MaterialConstant), errors);
+    }
+
+    for (auto& message : errors)
+        OutputDebugStringA((message + "\n").c_str());
+    if (!errors.empty())
+        ThrowIfFailed(E_FAIL);
+}
+
+void CompileShaderPermutation(const std::vector<ShaderDefine>& defines)
+{
+#if defined(DEBUG) || defined(_DEBUG)
+    UINT compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#else
+    UINT compileFlags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#endif
+
+    std::vector<D3D_SHADER_MACRO> macros;
+    for (auto& define : defines)
+        macros.push_back({ define.name.c_str(), define.value.c_str() });
+    macros.push_back({ nullptr, nullptr });
+
+    m_vsBlob = d3d12Util::CompileShader(L"shaders.hlsl", macros.data(), "VSMain", "vs_5_0", compileFlags);
+    m_psBlob = d3d12Util::CompileShader(L"shaders.hlsl", macros.data(), "PSMain", "ps_5_0", compileFlags);
+    m_vsByteCode = { m_vsBlob->GetBufferPointer(), m_vsBlob->GetBufferSize() };
+    m_psByteCode = { m_psBlob->GetBufferPointer(), m_psBlob->GetBufferSize() };
 }
 
 void FlushCommandQueue()
 {
     if (m_commandQueue == nullptr) return;
     m_fenceValue++;
-    ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), m_fenceValue));             // һָGPUfenceֵ
+    ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), m_fenceValue));             // 添加一个指令到GPU，用来更新fence值
 
-    if (m_fence->GetCompletedValue() < m_fenceValue)                                // ȡǰfenceֵ
+    if (m_fence->GetCompletedValue() < m_fenceValue)                                // 获取当前的fence值
     {
-        ThrowIfFailed(m_fence->SetEventOnCompletion(m_fenceValue, m_fenceEvent));   // fenceֵm_fenceValueʱᴥm_fenceEvent
-        WaitForSingleObject(m_fenceEvent, INFINITE);                                // ȴm_fenceEventִ
+        ThrowIfFailed(m_fence->SetEventOnCompletion(m_fenceValue, m_fenceEvent));   // 当fence值等于m_fenceValue时，会触发m_fenceEvent
+        WaitForSingleObject(m_fenceEvent, INFINITE);                                // 等待m_fenceEvent被执行
     }
 }
 
-void CreateRootSignature()
+void CreateRootSignature(RootSignatureLayout layout)
 {
-    // һroot signatureһroot parameter
-    // һroot parameterroot constantroot descriptordescriptor table
-    CD3DX12_ROOT_PARAMETER rootParameters[3];
-    CD3DX12_DESCRIPTOR_RANGE passCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0);       // register(b0)Pass Constant Buffer
-    CD3DX12_DESCRIPTOR_RANGE objectCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 1);     // register(b1)Object Constant Buffer
-    CD3DX12_DESCRIPTOR_RANGE materialCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 2);   // register(b2)Material Constant Buffer
-    rootParameters[0].InitAsDescriptorTable(1, &passCbvTable);
-    rootParameters[1].InitAsDescriptorTable(1, &objectCbvTable);
-    rootParameters[2].InitAsDescriptorTable(1, &materialCbvTable);
+    // 一个root signature定义一个root parameter数组
+    // 一个root parameter可以是root constant，root descriptor，descriptor table
+    CD3DX12_ROOT_PARAMETER rootParameters[4];
+    UINT parameterCount = 0;
+    CD3DX12_DESCRIPTOR_RANGE passCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0);       // register(b0)，后续绑定Pass Constant Buffer
+    CD3DX12_DESCRIPTOR_RANGE objectCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 1);     // register(b1)，后续绑定Object Constant Buffer
+    CD3DX12_DESCRIPTOR_RANGE materialCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 2);   // register(b2)，后续绑定Material Constant Buffer
+
+    if (layout == RootSignatureLayout::RootDescriptor)
+    {
+        // root descriptor直接使用GPU地址，不经过descriptor heap
+        rootParameters[0].InitAsConstantBufferView(0);      // register(b0)，Pass Constant Buffer的地址
+        rootParameters[1].InitAsConstantBufferView(1);      // register(b1)，每次draw传入Object Constant Buffer中对应元素的地址
+        rootParameters[2].InitAsConstants(1, 2);            // register(b2)，一个32位的材质下标
+        rootParameters[3].InitAsShaderResourceView(0);      // register(t0)，材质的structured buffer
+        parameterCount = 4;
+    }
+    else
+    {
+        rootParameters[0].InitAsDescriptorTable(1, &passCbvTable);
+        rootParameters[1].InitAsDescriptorTable(1, &objectCbvTable);
+        rootParameters[2].InitAsDescriptorTable(1, &materialCbvTable);
+        parameterCount = 3;
+    }
 
     CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
-    rootSignatureDesc.Init(3, rootParameters, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+    rootSignatureDesc.Init(parameterCount, rootParameters, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
     ComPtr<ID3DBlob> signature;
     ComPtr<ID3DBlob> error;
     ThrowIfFailed(D3D12SerializeRootSignature(&rootSignatureDesc, D3D_ROOT_SIGNATURE_VERSION_1, &signature, &error));
     ThrowIfFailed(m_device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&m_rootSignature)));
+    m_rootSignatureHash = Hasher64::Hash(signature->GetBufferPointer(), signature->GetBufferSize());
 }
 
 void InitMeshes()
 {
-    // ּĶ±Ϣ
+    // 几种几何体的顶点和下标信息
     std::vector<Vertex> vertices;
     std::vector<std::uint16_t> indices;
 
@@ -372,7 +560,7 @@ void InitMeshes()
     const UINT verticesSize = (UINT)vertices.size() * sizeof(Vertex);
     const UINT indicesSize = (UINT)indices.size() * sizeof(std::uint16_t);
 
-    // bufferеλ
+    // 单个几何体在buffer中的位置
     Submesh cubeSubmesh;
     cubeSubmesh.indexCount = (UINT)cubeMeshData.indices.size();
     cubeSubmesh.startIndexLocation = 0;
@@ -388,11 +576,11 @@ void InitMeshes()
     sphereSubmesh.startIndexLocation = pyramidSubmesh.startIndexLocation + (UINT)pyramidMeshData.indices.size();
     sphereSubmesh.baseVertexLocation = pyramidSubmesh.baseVertexLocation + (UINT)pyramidMeshData.vertices.size();
 
-    // mesh
+    // 创建mesh对象
     auto mesh = std::make_unique<Mesh>();
     mesh->name = "baseGeometryMesh";
 
-    // verticesindicesݿmesh
+    // 将vertices和indices数据拷贝到mesh中
     ThrowIfFailed(D3DCreateBlob(verticesSize, &mesh->vertexBufferCPU));
     CopyMemory(mesh->vertexBufferCPU->GetBufferPointer(), vertices.data(), verticesSize);
     ThrowIfFailed(D3DCreateBlob(indicesSize, &mesh->indexBufferCPU));
@@ -491,10 +679,10 @@ void InitRenderItems()
 
 void InitConstantBuffer()
 {
-    // Pass Constant Bufferupdateֵ
+    // 创建Pass Constant Buffer，在update里设置值
     m_passConstantBuffer = std::make_unique<UploadHeapConstantBuffer<PassConstant>>(m_device.Get(), 1);
 
-    // Object Constant Buffer
+    // 创建、设置Object Constant Buffer
     m_objectConstantBuffer = std::make_unique<UploadHeapConstantBuffer<ObjectConstant>>(m_device.Get(), (UINT)m_renderItems.size());
     for (auto& item : m_renderItems)
     {
@@ -504,8 +692,12 @@ void InitConstantBuffer()
         m_objectConstantBuffer->CopyData(item->objectCBIndex, objectConstant);
     }
 
-    // Material Constant Buffer
-    m_materialConstantBuffer = std::make_unique<UploadHeapConstantBuffer<MaterialConstant>>(m_device.Get(), (UINT)m_materials.size());
+    // 创建、设置Material Constant Buffer，RootDescriptor布局下改为structured buffer，元素之间不需要256字节对齐
+    bool useRootDescriptor = m_rootSignatureLayout == RootSignatureLayout::RootDescriptor;
+    if (useRootDescriptor)
+        m_materialStructuredBuffer = std::make_unique<UploadHeapBuffer<MaterialConstant>>(m_device.Get(), (UINT)m_materials.size(), false);
+    else
+        m_materialConstantBuffer = std::make_unique<UploadHeapConstantBuffer<MaterialConstant>>(m_device.Get(), (UINT)m_materials.size());
     for (auto& e : m_materials)
     {
         Material* mat = e.second.get();
@@ -513,9 +705,16 @@ void InitConstantBuffer()
         materialConstant.albedo = mat->albedo;
         materialConstant.fresnelR0 = mat->fresnelR0;
         materialConstant.roughness = mat->roughness;
-        m_materialConstantBuffer->CopyData(mat->cbIndex, materialConstant);
+        if (useRootDescriptor)
+            m_materialStructuredBuffer->CopyData(mat->cbIndex, materialConstant);
+        else
+            m_materialConstantBuffer->CopyData(mat->cbIndex, materialConstant);
     }
 
+    // RootDescriptor布局直接绑定GPU地址，不需要CBV
+    if (useRootDescriptor)
+        return;
+
     UINT itemCount = (UINT)m_renderItems.size();
     UINT materialCount = (UINT)m_materials.size();
 
@@ -529,7 +728,7 @@ void InitConstantBuffer()
     CD3DX12_CPU_DESCRIPTOR_HANDLE cbvHeapHandle(m_cbvHeap->GetCPUDescriptorHandleForHeapStart());
     m_passConstantBuffer->CreateConstantBufferView(m_device.Get(), cbvHeapHandle, 0);
 
-    // Object Constant BufferӦCBV
+    // Object Constant Buffer对应的CBV
     for (UINT i = 0; i < itemCount; ++i)
     {
         auto handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_cbvHeap->GetCPUDescriptorHandleForHeapStart());
@@ -537,7 +736,7 @@ void InitConstantBuffer()
         m_objectConstantBuffer->CreateConstantBufferView(m_device.Get(), handle, i);
     }
 
-    // Material Constant BufferӦCBV
+    // Material Constant Buffer对应的CBV
     for (UINT i = 0; i < materialCount; ++i)
     {
         auto handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_cbvHeap->GetCPUDescriptorHandleForHeapStart());
@@ -563,26 +762,16 @@ void OnUpdate()
     XMMATRIX projectMatrix = XMMatrixPerspectiveFovLH(fovAngleY, aspectRatio, nearZ, farZ);
     XMStoreFloat4x4(&passConstants.projectMatrix, XMMatrixTranspose(projectMatrix));
 
-    // ӹ
+    // 设间接光
     passConstants.ambientLight = { 0.3f, 0.3f, 0.3f, 1.0f };
 
-    // ƽй
-    XMStoreFloat3(&passConstants.lights[0].direction, XMVector3Normalize(XMVectorSet(3.0f, -4.0f, -2.0f, 1.0f)));
-    passConstants.lights[0].strength = { 1.0f, 1.0f, 1.0f };
-
-    // Դ
-    passConstants.lights[1].strength = { 1.0f, 0.0f, 0.0f };
-    passConstants.lights[1].falloffStart = 0;
-    passConstants.lights[1].falloffEnd = 15;
-    passConstants.lights[1].Position = { 3.0f, 1.5f, -1.5f };
-
-    // ۹
-    passConstants.lights[2].strength = { 0.0f, 1.0f, 0.0f };
-    passConstants.lights[2].falloffStart = 0;
-    passConstants.lights[2].falloffEnd = 40;
-    passConstants.lights[2].Position = { -3.0f, 2.0f, -5.0f };
-    XMStoreFloat3(&passConstants.lights[2].direction, XMVector3Normalize(XMVectorSet(1.0f, -1.0f, 1.0f, 1.0f)));
-    passConstants.lights[2].spotPower = 16;
+    // 按所用permutation的布局存放光源，permutation中多出的位置保持强度为0
+    for (size_t i = 0; i < m_directLights.size(); ++i)
+        passConstants.lights[i] = m_directLights[i];
+    for (size_t i = 0; i < m_pointLights.size(); ++i)
+        passConstants.lights[m_lightPermutation.PointLightStart() + i] = m_pointLights[i];
+    for (size_t i = 0; i < m_spotLights.size(); ++i)
+        passConstants.lights[m_lightPermutation.SpotLightStart() + i] = m_spotLights[i];
 
     m_passConstantBuffer->CopyData(0, passConstants);
 }
@@ -591,7 +780,7 @@ void OnRender()
 {
     PopulateCommandList();
 
-    // ϴCommand ListGPU
+    // 上传Command List到GPU
     ID3D12CommandList* ppCommandLists[] = { m_commandList.Get() };
     m_commandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
 
@@ -604,48 +793,90 @@ void OnRender()
 
 void PopulateCommandList()
 {
-    // Resetһ֡ʹõCommand Allocator洢ǰ֡Ҫ¼Command
+    // Reset上一帧使用的Command Allocator，用来存储当前帧要记录的Command
     ThrowIfFailed(m_commandAllocator->Reset());
-    // Resetһ֡ʹõCommand List¼¼ǰ֡Command
+    // Reset上一帧使用的Command List，重新记录当前帧的Command
     ThrowIfFailed(m_commandList->Reset(m_commandAllocator.Get(), m_pipelineState.Get()));
 
-    // Command List ResetҪ
+    // Command List Reset后，需要重新设置
     m_commandList->RSSetViewports(1, &m_viewport);
     m_commandList->RSSetScissorRects(1, &m_scissorRect);
 
     m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_swapChainBuffer[m_currendBackBufferIndex].Get(),
         D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
 
-    // ȡǰ
+    // 获取当前
     CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart(), m_currendBackBufferIndex, m_rtvDescriptorSize);
     m_commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
     m_commandList->ClearRenderTargetView(rtvHandle, Colors::White, 0, nullptr);
 
-    ID3D12DescriptorHeap* descriptorHeaps[] = { m_cbvHeap.Get() };
-    m_commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+    bool useRootDescriptor = m_rootSignatureLayout == RootSignatureLayout::RootDescriptor;
     m_commandList->SetGraphicsRootSignature(m_rootSignature.Get());
+    if (useRootDescriptor)
+    {
+        m_commandList->SetGraphicsRootConstantBufferView(0, m_passConstantBuffer->GetGPUVirtualAddress(0));         // pass信息
+        m_commandList->SetGraphicsRootShaderResourceView(3, m_materialStructuredBuffer->GetGPUVirtualAddress(0));   // 所有材质
+    }
+    else
+    {
+        ID3D12DescriptorHeap* descriptorHeaps[] = { m_cbvHeap.Get() };
+        m_commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
+
+        CD3DX12_GPU_DESCRIPTOR_HANDLE handle(m_cbvHeap->GetGPUDescriptorHandleForHeapStart());
+        m_commandList->SetGraphicsRootDescriptorTable(0, handle);   // pass信息
+    }
+
+    // heap中依次是1个pass CBV，每个render item的object CBV，每个材质的CBV
+    UINT materialCbvOffset = 1 + (UINT)m_renderItems.size();
 
-    CD3DX12_GPU_DESCRIPTOR_HANDLE handle(m_cbvHeap->GetGPUDescriptorHandleForHeapStart());
-    m_commandList->SetGraphicsRootDescriptorTable(0, handle);   // passϢ
+    LARGE_INTEGER recordStart, recordEnd;
+    QueryPerformanceCounter(&recordStart);
 
-    // 
+    // 绘制
     for (auto& item : m_renderItems)
     {
         m_commandList->IASetVertexBuffers(0, 1, &item->mesh->GetVertexBufferView());
         m_commandList->IASetIndexBuffer(&item->mesh->GetIndexBufferView());
         m_commandList->IASetPrimitiveTopology(item->primitiveType);
 
-        auto cbvHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_cbvHeap->GetGPUDescriptorHandleForHeapStart());
-        cbvHandle.Offset(item->objectCBIndex + 1, m_cbvSrvUavDescriptorSize);
-        m_commandList->SetGraphicsRootDescriptorTable(1, cbvHandle);
+        if (useRootDescriptor)
+        {
+            m_commandList->SetGraphicsRootConstantBufferView(1, m_objectConstantBuffer->GetGPUVirtualAddress(item->objectCBIndex));
+            m_commandList->SetGraphicsRoot32BitConstant(2, (UINT)item->material->cbIndex, 0);
+        }
+        else
+        {
+            auto cbvHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_cbvHeap->GetGPUDescriptorHandleForHeapStart());
+            cbvHandle.Offset(item->objectCBIndex + 1, m_cbvSrvUavDescriptorSize);
+            m_commandList->SetGraphicsRootDescriptorTable(1, cbvHandle);
 
-        cbvHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_cbvHeap->GetGPUDescriptorHandleForHeapStart());
-        cbvHandle.Offset(item->material->cbIndex + 4, m_cbvSrvUavDescriptorSize);
-        m_commandList->SetGraphicsRootDescriptorTable(2, cbvHandle);
+            cbvHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_cbvHeap->GetGPUDescriptorHandleForHeapStart());
+            cbvHandle.Offset(item->material->cbIndex + materialCbvOffset, m_cbvSrvUavDescriptorSize);
+            m_commandList->SetGraphicsRootDescriptorTable(2, cbvHandle);
+        }
 
         m_commandList->DrawIndexedInstanced(item->indexCount, 1, item->startIndexLocation, item->baseVertexLocation, 0);
     }
 
+    QueryPerformanceCounter(&recordEnd);
+    m_drawRecordCounts += recordEnd.QuadPart - recordStart.QuadPart;
+    m_drawRecordDrawCount += (UINT)m_renderItems.size();
+
+    // 每60帧在标题栏显示一次平均每个draw的记录耗时
+    if (++m_drawRecordFrameCount == 60)
+    {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        double nanosecondsPerDraw = (double)m_drawRecordCounts * 1e9 / (double)frequency.QuadPart / m_drawRecordDrawCount;
+        std::wstring title = useRootDescriptor ? L"Local Lit (RootDescriptor) " : L"Local Lit (DescriptorTable) ";
+        title += std::to_wstring((int)nanosecondsPerDraw) + L" ns/draw";
+        SetWindowText(m_hwnd, title.c_str());
+
+        m_drawRecordCounts = 0;
+        m_drawRecordDrawCount = 0;
+        m_drawRecordFrameCount = 0;
+    }
+
     m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_swapChainBuffer[m_currendBackBufferIndex].Get(),
         D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
 
@@ -655,5 +886,7 @@ void PopulateCommandList()
 void OnDestroy()
 {
     FlushCommandQueue();
+    if (m_pipelineStateCache)
+        m_pipelineStateCache->Save();
     CloseHandle(m_fenceEvent);
 }
\ No newline at end of file
@@ -34,22 +34,38 @@ cbuffer objectData : register(b1)
     float4x4 normalMatrix;
 }
 
+#ifdef ROOT_DESCRIPTOR_LAYOUT
+// 材质数据存放在structured buffer中，每次draw通过root constant传入材质下标
+struct MaterialData
+{
+    float4 albedo;
+    float3 fresnelR0;
+    float roughness;
+};
+StructuredBuffer<MaterialData> materials : register(t0);
+
+cbuffer drawData : register(b2)
+{
+    uint materialIndex;
+}
+#else
 cbuffer materialData : register(b2)
 {
     float4 albedo;
     float3 fresnelR0;
     float roughness;
 };
+#endif
 
 PSInput VSMain(float3 position : POSITION, float3 normal : NORMAL)
 {
     PSInput result;
-    // µλ
+    // 顶点在世界坐标下的位置
     float4 positionInWorld = mul(float4(position, 1.0f), modelMatrix);
     result.positionInWorld = positionInWorld.xyz;
-    // ķµֵ
+    // 顶点的法线在世界坐标下的值
     result.normalInWorld = mul(normal, (float3x3)normalMatrix);
-    // βüռµλ
+    // 顶点在齐次裁剪空间下的位置
     result.position = mul(positionInWorld, mul(viewMatrix, projectMatrix));
 
     return result;
@@ -57,14 +73,19 @@ PSInput VSMain(float3 position : POSITION, float3 normal : NORMAL)
 
 float4 PSMain(PSInput input) : SV_TARGET
 {
-    // һ
+#ifdef ROOT_DESCRIPTOR_LAYOUT
+    float4 albedo = materials[materialIndex].albedo;
+    float3 fresnelR0 = materials[materialIndex].fresnelR0;
+    float roughness = materials[materialIndex].roughness;
+#endif
+    // 归一化法线向量
     input.normalInWorld = normalize(input.normalInWorld);
-    // 浽cameraĵλ
+    // 表面到camera的单位向量
     float3 toCamera = normalize(cameraPositionInWorld - input.positionInWorld);
-    // գģӹ
+    // 环境光照，模拟间接光
     float4 ambient = ambientLight * albedo;
     Material material = { albedo, fresnelR0, roughness };
-    // ֱӹ⣬;淴
+    // 直接光，包含漫反射和镜面反射
     float4 directLight = ComputeLighting(lights, material, input.positionInWorld, input.normalInWorld, toCamera);
     float4 litColor = ambient + directLight;
     litColor.a = albedo.a;
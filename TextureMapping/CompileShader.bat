@@ -1,2 +1,3 @@
-../Util/Compiler.bat shaders.hlsl
+call ../Util/Compiler.bat shaders.hlsl
+call ../Util/Compiler.bat shaders.hlsl BINDLESS _bindless 5_1
 pause
\ No newline at end of file
@@ -0,0 +1,87 @@
+// 由ShaderReflect根据以下shader生成，不要手动修改
+//   shaders_vs.cso
+//   shaders_ps.cso
+#pragma once
+
+#include "../Common/ShaderReflection.h"
+
+namespace TextureMappingShaderLayout
+{
+    // cbuffer passData : register(b0, space0)
+    namespace passData
+    {
+        const unsigned int Register = 0;
+        const unsigned int Space = 0;
+        const unsigned int Size = 928;
+        const unsigned int viewMatrixOffset = 0;
+        const unsigned int viewMatrixSize = 64;
+        const unsigned int projectMatrixOffset = 64;
+        const unsigned int projectMatrixSize = 64;
+        const unsigned int cameraPositionInWorldOffset = 128;
+        const unsigned int cameraPositionInWorldSize = 12;
+        const unsigned int padding0Offset = 140;
+        const unsigned int padding0Size = 4;
+        const unsigned int ambientLightOffset = 144;
+        const unsigned int ambientLightSize = 16;
+        const unsigned int lightsOffset = 160;
+        const unsigned int lightsSize = 768;
+        namespace lights
+        {
+            const unsigned int Stride = 48;
+            const unsigned int strengthOffset = 0;
+            const unsigned int strengthSize = 12;
+            const unsigned int falloffStartOffset = 12;
+            const unsigned int falloffStartSize = 4;
+            const unsigned int directionOffset = 16;
+            const unsigned int directionSize = 12;
+            const unsigned int falloffEndOffset = 28;
+            const unsigned int falloffEndSize = 4;
+            const unsigned int positionOffset = 32;
+            const unsigned int positionSize = 12;
+            const unsigned int spotPowerOffset = 44;
+            const unsigned int spotPowerSize = 4;
+        }
+    }
+
+    // cbuffer objectData : register(b1, space0)
+    namespace objectData
+    {
+        const unsigned int Register = 1;
+        const unsigned int Space = 0;
+        const unsigned int Size = 128;
+        const unsigned int modelMatrixOffset = 0;
+        const unsigned int modelMatrixSize = 64;
+        const unsigned int normalMatrixOffset = 64;
+        const unsigned int normalMatrixSize = 64;
+    }
+
+    // cbuffer materialData : register(b2, space0)
+    namespace materialData
+    {
+        const unsigned int Register = 2;
+        const unsigned int Space = 0;
+        const unsigned int Size = 64;
+        const unsigned int albedoOffset = 0;
+        const unsigned int albedoSize = 16;
+        const unsigned int fresnelR0Offset = 16;
+        const unsigned int fresnelR0Size = 12;
+        const unsigned int roughnessOffset = 28;
+        const unsigned int roughnessSize = 4;
+        const unsigned int albedoUvTransformOffset = 32;
+        const unsigned int albedoUvTransformSize = 16;
+        const unsigned int albedoTextureSliceOffset = 48;
+        const unsigned int albedoTextureSliceSize = 4;
+        const unsigned int paddingOffset = 52;
+        const unsigned int paddingSize = 12;
+    }
+
+    // 所有stage用到的资源，按cbv、srv、uav、sampler的顺序，同类中按space、register排序
+    const ShaderBinding Bindings[] =
+    {
+        { "passData", ShaderInputType::ConstantBuffer, 0, 1, 0, 3 },
+        { "objectData", ShaderInputType::ConstantBuffer, 1, 1, 0, 2 },
+        { "materialData", ShaderInputType::ConstantBuffer, 2, 1, 0, 1 },
+        { "albedoTexture", ShaderInputType::Texture, 0, 1, 0, 1 },
+        { "pointWrapSampler", ShaderInputType::Sampler, 0, 1, 0, 1 },
+    };
+}
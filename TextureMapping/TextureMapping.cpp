@@ -1,11 +1,22 @@
 #include <windows.h>
 #include "../Common/d3d12Util.h"
 #include "../Common/UploadHeapConstantBuffer.h"
+#include "../Common/PlacedResourceAllocator.h"
+#include "../Common/UploadManager.h"
+#include "../Common/TextureLoader.h"
+#include "../Common/TextureResidency.h"
+#include "../Common/DeferredReleaseQueue.h"
+#include "../Common/DescriptorAllocator.h"
+#include "../Common/CommandListStateTracker.h"
+#include "../Common/TexturePackTable.h"
+#include "../Common/AssetArchive.h"
+#include "../DirectXTK/DDSTextureCatalog.h"
+#include "ShaderLayout.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
 
-// 
+// 顶点数据
 struct Vertex
 {
     XMFLOAT3 position;
@@ -29,31 +40,90 @@ struct PassConstant
     Light lights[MAX_LIGHT_COUNT];
 };
 
+// descriptor table模式下的材质常量，在MaterialConstant之后加上albedo texture在打包后的resource中的位置
+struct TextureMaterialConstant
+{
+    XMFLOAT4 albedo = { 1.0f, 1.0f, 1.0f, 1.0f };
+    XMFLOAT3 fresnelR0 = { 0.01f, 0.01f, 0.01f };
+    float roughness = 0.25f;
+    XMFLOAT4 albedoUvTransform = { 1.0f, 1.0f, 0.0f, 0.0f };
+    UINT albedoTextureSlice = 0;
+    UINT padding[3] = {};
+};
+
+// bindless模式下structured buffer中的材质数据，与shader中的MaterialData一致
+struct BindlessMaterialConstant
+{
+    XMFLOAT4 albedo = { 1.0f, 1.0f, 1.0f, 1.0f };
+    XMFLOAT3 fresnelR0 = { 0.01f, 0.01f, 0.01f };
+    float roughness = 0.25f;
+    XMFLOAT4 albedoUvTransform = { 1.0f, 1.0f, 0.0f, 0.0f };
+    UINT albedoTextureIndex = 0;        // bindless texture数组中的下标
+    UINT albedoTextureSlice = 0;
+    UINT padding[2] = {};
+};
+
+// C++中常量缓冲的布局必须与shader一致，ShaderLayout.h由Util/ShaderReflect根据cso生成（见Util/GenerateShaderLayout.bat）
+namespace Layout = TextureMappingShaderLayout;
+#define CHECK_LAYOUT(Type, member, shaderLayout) \
+    static_assert(offsetof(Type, member) == shaderLayout::member##Offset && sizeof(Type::member) == shaderLayout::member##Size, #Type "::" #member " does not match the shader")
+CHECK_LAYOUT(PassConstant, viewMatrix, Layout::passData);
+CHECK_LAYOUT(PassConstant, projectMatrix, Layout::passData);
+CHECK_LAYOUT(PassConstant, cameraPositionInWorld, Layout::passData);
+CHECK_LAYOUT(PassConstant, padding0, Layout::passData);
+CHECK_LAYOUT(PassConstant, ambientLight, Layout::passData);
+CHECK_LAYOUT(PassConstant, lights, Layout::passData);
+CHECK_LAYOUT(Light, strength, Layout::passData::lights);
+CHECK_LAYOUT(Light, falloffStart, Layout::passData::lights);
+CHECK_LAYOUT(Light, direction, Layout::passData::lights);
+CHECK_LAYOUT(Light, falloffEnd, Layout::passData::lights);
+CHECK_LAYOUT(Light, position, Layout::passData::lights);
+CHECK_LAYOUT(Light, spotPower, Layout::passData::lights);
+CHECK_LAYOUT(ObjectConstant, modelMatrix, Layout::objectData);
+CHECK_LAYOUT(ObjectConstant, normalMatrix, Layout::objectData);
+CHECK_LAYOUT(TextureMaterialConstant, albedo, Layout::materialData);
+CHECK_LAYOUT(TextureMaterialConstant, fresnelR0, Layout::materialData);
+CHECK_LAYOUT(TextureMaterialConstant, roughness, Layout::materialData);
+CHECK_LAYOUT(TextureMaterialConstant, albedoUvTransform, Layout::materialData);
+CHECK_LAYOUT(TextureMaterialConstant, albedoTextureSlice, Layout::materialData);
+CHECK_LAYOUT(TextureMaterialConstant, padding, Layout::materialData);
+static_assert(sizeof(PassConstant) == Layout::passData::Size && sizeof(Light) == Layout::passData::lights::Stride, "PassConstant does not match the shader");
+static_assert(sizeof(ObjectConstant) == Layout::objectData::Size, "ObjectConstant does not match the shader");
+static_assert(sizeof(TextureMaterialConstant) == Layout::materialData::Size, "TextureMaterialConstant does not match the shader");
+#undef CHECK_LAYOUT
+
+// root signature的布局
+enum class RootSignatureLayout
+{
+    DescriptorTable,    // 每次draw绑定object、material、texture三个descriptor table
+    Bindless,           // 所有texture在一个unbounded descriptor table中，所有材质在一个structured buffer中，每次draw只设置object CBV和材质下标
+};
+
 struct RenderItem
 {
     RenderItem() = default;
 
-    // ģͱ任󣬼µλãԼתֵ
+    // 模型变换矩阵，即物体在世界坐标下的位置，缩放以及旋转值
     XMFLOAT4X4 modelMatrix = MathUtil::Identity4x4();
-    // ӦObjectConstant±
+    // 对应ObjectConstant的下标
     UINT objectCBIndex = -1;
 
-    // Ӧvertexindex bufferϢ
+    // 对应的vertex和index buffer信息
     Mesh* mesh = nullptr;
 
-    // ӦĲ
+    // 对应的材质
     Material* material = nullptr;
 
     D3D12_PRIMITIVE_TOPOLOGY primitiveType = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 
-    // ӦmeshеSubmeshֵ
+    // 对应mesh中的Submesh值
     UINT indexCount = 0;
     UINT startIndexLocation = 0;
     int baseVertexLocation = 0;
 };
 
 
-UINT m_clientWidth = 800, m_clientHeight = 600;     // ڳߴ
+UINT m_clientWidth = 800, m_clientHeight = 600;     // 窗口尺寸
 HWND m_hwnd;
 UINT64 m_fenceValue;
 static const UINT m_swapChainBufferCount = 2;
@@ -61,24 +131,54 @@ HANDLE m_fenceEvent;
 UINT m_rtvDescriptorSize, m_cbvSrvUavDescriptorSize;
 UINT m_currendBackBufferIndex = 0;
 
-DXGI_FORMAT m_backBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;  // ÿԪռ8-bitֵķΧ[0,1]
+DXGI_FORMAT m_backBufferFormat = DXGI_FORMAT_R8G8B8A8_UNORM;  // 每个元素占用8-bit，值的范围[0,1]
 
 ComPtr<ID3D12Device> m_device;
 ComPtr<ID3D12CommandQueue> m_commandQueue;
 ComPtr<ID3D12CommandAllocator> m_commandAllocator;
 ComPtr<ID3D12GraphicsCommandList> m_commandList;
+ComPtr<ID3D12CommandAllocator> m_preambleCommandAllocator;
+ComPtr<ID3D12GraphicsCommandList> m_preambleCommandList;          // 在m_commandList之前执行，记录初始状态需要的barrier
+D3D12ResourceStateRegistry m_resourceStates;                        // 已提交的command list执行完后各resource的状态
+CommandListStateTracker m_stateTracker;                             // m_commandList中各resource的状态
 ComPtr<ID3D12Fence> m_fence;
 ComPtr<IDXGISwapChain> m_swapChain;
 ComPtr<ID3D12DescriptorHeap> m_rtvHeap;
 ComPtr<ID3D12Resource> m_swapChainBuffer[m_swapChainBufferCount];
 ComPtr<ID3D12RootSignature> m_rootSignature;
+std::unique_ptr<PlacedResourceAllocator> m_resourceAllocator;     // mesh和texture所在的heap，要比它们后释放
+std::unique_ptr<UploadManager> m_uploadManager;                     // 只在初始化时上传mesh和占位texture
+std::unique_ptr<TextureLoader> m_textureLoader;                     // 在后台线程中加载texture
+ComPtr<ID3D12Resource> m_placeholderTexture;                        // texture加载完成之前使用的1x1白色texture
+const char* const m_textureNames[] = { "water", "stone", "grass" }; // 材质用到的texture
+const char* const m_texturePackPath = "../Textures/Packed/TexturePack.txt";  // Util/TexturePack的输出，存在时加载打包后的resource
+const char* const m_assetArchivePath = "../Assets.pak";               // Util/AssetPack的输出，存在时从中读取texture
+AssetArchive m_assetArchive;                                        // 映射到内存中，加载期间一直打开
+TexturePackTable m_texturePack;                                     // 每个texture所在的resource和位置，没有打包时每个texture单独一个resource
+std::vector<Texture*> m_textureResources;                           // 实际加载的resource，下标为Material::albedoTextureIndex
+static const UINT64 m_textureBudget = 64 * 1024 * 1024;             // texture的显存预算，调小后可以看到最久没用的texture被降级
+TextureResidencyManager m_textureResidency(m_textureBudget);        // 根据绘制时的使用情况决定每个texture驻留哪些mip
+std::vector<UINT> m_textureResidencyIds;                            // 下标为Material::albedoTextureIndex，所有mip加载完成之前为InvalidId
+DeferredReleaseQueue m_releaseQueue;                                // 等待GPU用完后再释放的resource
 std::unordered_map<std::string, std::unique_ptr<Mesh>> m_meshes;
 std::unordered_map<std::string, std::unique_ptr<Texture>> m_textures;
 std::vector<std::unique_ptr<RenderItem>> m_renderItems;
 std::unique_ptr<UploadHeapConstantBuffer<ObjectConstant>> m_objectConstantBuffer;
 std::unique_ptr<UploadHeapConstantBuffer<PassConstant>> m_passConstantBuffer;
-std::unique_ptr<UploadHeapConstantBuffer<MaterialConstant>> m_materialConstantBuffer;
-ComPtr<ID3D12DescriptorHeap> m_cbvSrvHeap;
+std::unique_ptr<UploadHeapConstantBuffer<TextureMaterialConstant>> m_materialConstantBuffer;
+std::unique_ptr<DescriptorAllocator> m_descriptorAllocator;         // CBV、SRV创建在CPU heap中
+std::unique_ptr<DescriptorRing> m_descriptorRing;                   // 每帧把绘制需要的descriptor拷贝到shader visible heap中
+DescriptorHandle m_passCbv;
+std::vector<DescriptorHandle> m_objectCbvs;                         // 下标为RenderItem::objectCBIndex
+std::vector<DescriptorHandle> m_materialCbvs;                       // 下标为Material::cbIndex
+std::vector<DescriptorHandle> m_textureSrvs;                        // 下标为Material::albedoTextureIndex
+RootSignatureLayout m_rootSignatureLayout = RootSignatureLayout::DescriptorTable;
+static const UINT m_maxBindlessCount = 1024;                        // bindless texture和材质的最大数量
+std::unique_ptr<BindlessDescriptorTable> m_bindlessTextures;
+std::unique_ptr<BindlessSlotTable> m_bindlessMaterialSlots;
+std::unique_ptr<UploadHeapBuffer<BindlessMaterialConstant>> m_bindlessMaterialBuffer;
+std::vector<UINT> m_textureSlots;                                   // 每个texture在bindless数组中的下标，下标为Material::albedoTextureIndex
+std::vector<UINT> m_materialSlots;                                  // 每个材质在bindless材质buffer中的下标，下标为Material::cbIndex
 ComPtr<ID3D12PipelineState> m_pipelineState;
 
 D3D12_VIEWPORT m_viewport;
@@ -94,18 +194,24 @@ void InitMeshes();
 void InitRenderItems();
 void InitTextures();
 void InitMaterials();
+void SetAlbedoTexture(Material* material, const std::string& textureName);
 std::array<const CD3DX12_STATIC_SAMPLER_DESC, 6> InitStaticSamplers();
 void InitConstantBuffer();
 void InitCbvSrvDescriptor();
+void CreateTextureSrv(ID3D12Resource* texture, D3D12_CPU_DESCRIPTOR_HANDLE handle, float minLod);
+void UpdateTextures();
+UINT RegisterTextureResidency(ID3D12Resource* texture);
+void InitBindlessTables();
+void UpdateBindlessMaterial(const Material* material);
 void FlushCommandQueue();
-void CreateRootSignature();
+void CreateRootSignature(RootSignatureLayout layout);
 void PopulateCommandList();
 void OnUpdate();
 void OnRender();
 void OnDestroy();
 
 
-// Ӧóں
+// 应用程序入口函数
 int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine, int nCmdShow)
 {
     const wchar_t CLASS_NAME[] = L"Sample Window Class";
@@ -123,8 +229,8 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
         CLASS_NAME,                     // Window class
         L"TextureMapping",              // Window text
         WS_OVERLAPPEDWINDOW,            // Window style
-        CW_USEDEFAULT, CW_USEDEFAULT,   // ڴС
-        m_clientWidth, m_clientHeight,  // λ
+        CW_USEDEFAULT, CW_USEDEFAULT,   // 窗口大小
+        m_clientWidth, m_clientHeight,  // 窗口位置
         NULL,       // Parent window    
         NULL,       // Menu
         hInstance,  // Instance handle
@@ -133,23 +239,23 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
 
     if (m_hwnd == NULL) return 0;
 
-    ShowWindow(m_hwnd, nCmdShow);         // ʾ
+    ShowWindow(m_hwnd, nCmdShow);         // 显示窗口
 
     try
     {
         InitDirect3D();
         InitAsset();
 
-        // ȡ¼̰ڱ仯ȵȡ
+        // 获取事件，例如鼠标点击，键盘按键，窗口变化等等。
         MSG msg = { };
         while (msg.message != WM_QUIT)      // message loop
         {
-            // PeekMessage  message queueǷmessageеĻ䵽msgУط0ֵ
-            // PM_REMOVE WM_PAINT͵message⣬messageִPeekMessageƳ message queue
+            // PeekMessage 检查 message queue中是否有message，如果有的话将其到msg中，返回非0的值
+            // PM_REMOVE 除了WM_PAINT类型的message外，其他的message会在执行完PeekMessage后被移出 message queue
             if (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
             {
                 TranslateMessage(&msg);
-                DispatchMessage(&msg);      // ᴥ WindowProc 
+                DispatchMessage(&msg);      // 会触发 WindowProc 函数
             }
             else
             {
@@ -169,13 +275,13 @@ int WINAPI wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PWSTR pCmdLine
     return 0;
 }
 
-// ¼
+// 事件处理
 LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 {
     switch (uMsg)
     {
     case WM_DESTROY:
-        PostQuitMessage(0);     // ֹMessage loop
+        PostQuitMessage(0);     // 中止Message loop
         return 0;
         return 0;
     }
@@ -185,7 +291,7 @@ LRESULT CALLBACK WindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
 void InitDirect3D()
 {
 #if defined(DEBUG) || defined(_DEBUG) 
-    //  D3D12 debug layer.
+    // 开启 D3D12 debug layer.
     {
         ComPtr<ID3D12Debug> debugController;
         ThrowIfFailed(D3D12GetDebugInterface(IID_PPV_ARGS(&debugController)));
@@ -198,12 +304,12 @@ void InitDirect3D()
     ComPtr<IDXGIFactory4> factory;
     ThrowIfFailed(CreateDXGIFactory1(IID_PPV_ARGS(&factory)));
 
-    // ֹʹalt+enterлȫģʽ
+    // 禁止使用alt+enter切换全屏模式
     ThrowIfFailed(factory->MakeWindowAssociation(m_hwnd, DXGI_MWA_NO_PRINT_SCREEN));
 
     if (FAILED(D3D12CreateDevice(nullptr, D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device))))
     {
-        // deviceʧܣFallback  WARP device.
+        // 如果device创建失败，Fallback 到 WARP device.
         ComPtr<IDXGIAdapter> warpAdapter;
         ThrowIfFailed(factory->EnumWarpAdapter(IID_PPV_ARGS(&warpAdapter)));
         ThrowIfFailed(D3D12CreateDevice(warpAdapter.Get(), D3D_FEATURE_LEVEL_11_0, IID_PPV_ARGS(&m_device)));
@@ -212,15 +318,18 @@ void InitDirect3D()
     m_rtvDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
     m_cbvSrvUavDescriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
 
-    // Command QueueCommand AllocatorCommand ListtypeҪһ
+    // Command Queue，Command Allocator，Command List的type要一致
     D3D12_COMMAND_LIST_TYPE commandListType = D3D12_COMMAND_LIST_TYPE_DIRECT;
     D3D12_COMMAND_QUEUE_DESC queueDesc = {};
-    queueDesc.Type = commandListType;                   // Command List
-    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;    // ĬϵCommand Queue
+    queueDesc.Type = commandListType;                   // Command List的类型
+    queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;    // 默认的Command Queue
     ThrowIfFailed(m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_commandQueue)));
     ThrowIfFailed(m_device->CreateCommandAllocator(commandListType, IID_PPV_ARGS(&m_commandAllocator)));
     ThrowIfFailed(m_device->CreateCommandList(0, commandListType, m_commandAllocator.Get(), nullptr, IID_PPV_ARGS(&m_commandList)));
     ThrowIfFailed(m_commandList->Close());
+    ThrowIfFailed(m_device->CreateCommandAllocator(commandListType, IID_PPV_ARGS(&m_preambleCommandAllocator)));
+    ThrowIfFailed(m_device->CreateCommandList(0, commandListType, m_preambleCommandAllocator.Get(), nullptr, IID_PPV_ARGS(&m_preambleCommandList)));
+    ThrowIfFailed(m_preambleCommandList->Close());
 
     ThrowIfFailed(m_device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)));
     m_fenceValue = 0;
@@ -234,7 +343,7 @@ void InitDirect3D()
     sd.BufferDesc.Format = m_backBufferFormat;
     sd.BufferDesc.ScanlineOrdering = DXGI_MODE_SCANLINE_ORDER_UNSPECIFIED;
     sd.BufferDesc.Scaling = DXGI_MODE_SCALING_UNSPECIFIED;
-    sd.SampleDesc.Count = 1;                                // multisample
+    sd.SampleDesc.Count = 1;                                // 不能设置multisample
     sd.SampleDesc.Quality = 0;
     sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
     sd.BufferCount = m_swapChainBufferCount;
@@ -254,9 +363,10 @@ void InitDirect3D()
     CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHeapHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart());
     for (UINT i = 0; i < m_swapChainBufferCount; i++)
     {
-        ThrowIfFailed(m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_swapChainBuffer[i])));  // ᵼSwap Chainbufferü+1ʹComPtrԶrelease
+        ThrowIfFailed(m_swapChain->GetBuffer(i, IID_PPV_ARGS(&m_swapChainBuffer[i])));  // 会导致Swap Chain里的buffer对象引用计数+1，由于使用了ComPtr，会自动调用release
+        m_resourceStates.Register(m_swapChainBuffer[i].Get(), D3D12_RESOURCE_STATE_PRESENT);
         m_device->CreateRenderTargetView(m_swapChainBuffer[i].Get(), nullptr, rtvHeapHandle);
-        rtvHeapHandle.Offset(1, m_rtvDescriptorSize);       // ƫһrtvС
+        rtvHeapHandle.Offset(1, m_rtvDescriptorSize);       // 偏移一个rtv大小
     }
 }
 
@@ -270,7 +380,21 @@ void InitAsset()
     };
     D3D12_INPUT_LAYOUT_DESC inputLayout = { inputElementDescs, _countof(inputElementDescs) };
 
-    m_commandList->Reset(m_commandAllocator.Get(), nullptr); // ֮ǰclosecommand listҪʹõҪresetſɼ¼command
+    m_commandList->Reset(m_commandAllocator.Get(), nullptr); // 之前close了command list，这里要使用到，需要reset操作才可记录command。
+
+    m_resourceAllocator = std::make_unique<PlacedResourceAllocator>(m_device.Get());
+    m_uploadManager = std::make_unique<UploadManager>(m_device.Get());
+    m_descriptorAllocator = std::make_unique<DescriptorAllocator>(m_device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    m_descriptorRing = std::make_unique<DescriptorRing>(m_device.Get(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 4096, m_maxBindlessCount);
+
+    // unbounded descriptor table需要resource binding tier 2
+    if (m_rootSignatureLayout == RootSignatureLayout::Bindless)
+    {
+        D3D12_FEATURE_DATA_D3D12_OPTIONS options = {};
+        ThrowIfFailed(m_device->CheckFeatureSupport(D3D12_FEATURE_D3D12_OPTIONS, &options, sizeof(options)));
+        if (options.ResourceBindingTier < D3D12_RESOURCE_BINDING_TIER_2)
+            m_rootSignatureLayout = RootSignatureLayout::DescriptorTable;
+    }
 
     InitMeshes();
     InitTextures();
@@ -278,18 +402,25 @@ void InitAsset()
     InitRenderItems();
     InitConstantBuffer();
     InitCbvSrvDescriptor();
-    CreateRootSignature();
-
-    // shader compiler
-    ComPtr<ID3DBlob> vsByteCode = d3d12Util::LoadBinary(L"shaders_vs.cso");
-    ComPtr<ID3DBlob> psByteCode = d3d12Util::LoadBinary(L"shaders_ps.cso");
+    if (m_rootSignatureLayout == RootSignatureLayout::Bindless)
+        InitBindlessTables();
+    CreateRootSignature(m_rootSignatureLayout);
+
+    // shader compiler，Bindless布局使用定义了BINDLESS的5.1版本（见CompileShader.bat）
+    bool useBindless = m_rootSignatureLayout == RootSignatureLayout::Bindless;
+    // 只打开一次shaders.shaderpack（见Util/PackShaders.bat），bytecode直接指向映射的文件，创建PSO之后就不再需要
+    ShaderArchive shaderArchive;
+    shaderArchive.Open(L"shaders.shaderpack");
+    ComPtr<ID3DBlob> vsBlob, psBlob;
+    D3D12_SHADER_BYTECODE vsByteCode = d3d12Util::LoadShader(shaderArchive, useBindless ? L"shaders_bindless_vs.cso" : L"shaders_vs.cso", ShaderStage::Vertex, vsBlob);
+    D3D12_SHADER_BYTECODE psByteCode = d3d12Util::LoadShader(shaderArchive, useBindless ? L"shaders_bindless_ps.cso" : L"shaders_ps.cso", ShaderStage::Pixel, psBlob);
 
     // PSO
     D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
     psoDesc.InputLayout = inputLayout;
     psoDesc.pRootSignature = m_rootSignature.Get();
-    psoDesc.VS = CD3DX12_SHADER_BYTECODE(vsByteCode.Get());
-    psoDesc.PS = CD3DX12_SHADER_BYTECODE(psByteCode.Get());
+    psoDesc.VS = vsByteCode;
+    psoDesc.PS = psByteCode;
     psoDesc.RasterizerState = CD3DX12_RASTERIZER_DESC(D3D12_DEFAULT);
     //psoDesc.RasterizerState.FillMode = D3D12_FILL_MODE_WIREFRAME;
     psoDesc.BlendState = CD3DX12_BLEND_DESC(D3D12_DEFAULT);
@@ -302,7 +433,7 @@ void InitAsset()
     psoDesc.SampleDesc.Count = 1;
     ThrowIfFailed(m_device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&m_pipelineState)));
 
-    // ڴС
+    // 窗口大小
     m_viewport.TopLeftX = 0;
     m_viewport.TopLeftY = 0;
     m_viewport.Width = static_cast<float>(m_clientWidth);
@@ -310,48 +441,68 @@ void InitAsset()
     m_viewport.MinDepth = 0.0f;
     m_viewport.MaxDepth = 1.0f;
 
-    // ü
+    // 裁剪区域
     m_scissorRect = { 0, 0, (long)m_clientWidth, (long)m_clientHeight };
 
+    // 所有mesh和texture的上传合并在一起记录
+    m_uploadManager->Flush(m_commandList.Get());
+
     ThrowIfFailed(m_commandList->Close());
     ID3D12CommandList* cmdsLists[] = { m_commandList.Get() };
     m_commandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists);
     FlushCommandQueue();
 
-    m_meshes["baseGeometryMesh"]->DisposeUploaders();
+    // 之后的上传都由m_textureLoader完成，staging page交给release queue，上面提交的command完成后释放
+    m_releaseQueue.Retire(std::move(m_uploadManager), m_fenceValue);
 }
 
 void FlushCommandQueue()
 {
     if (m_commandQueue == nullptr) return;
     m_fenceValue++;
-    ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), m_fenceValue));             // һָGPUfenceֵ
+    ThrowIfFailed(m_commandQueue->Signal(m_fence.Get(), m_fenceValue));             // 添加一个指令到GPU，用来更新fence值
 
-    if (m_fence->GetCompletedValue() < m_fenceValue)                                // ȡǰfenceֵ
+    if (m_fence->GetCompletedValue() < m_fenceValue)                                // 获取当前的fence值
     {
-        ThrowIfFailed(m_fence->SetEventOnCompletion(m_fenceValue, m_fenceEvent));   // fenceֵm_fenceValueʱᴥm_fenceEvent
-        WaitForSingleObject(m_fenceEvent, INFINITE);                                // ȴm_fenceEventִ
+        ThrowIfFailed(m_fence->SetEventOnCompletion(m_fenceValue, m_fenceEvent));   // 当fence值等于m_fenceValue时，会触发m_fenceEvent
+        WaitForSingleObject(m_fenceEvent, INFINITE);                                // 等待m_fenceEvent被执行
     }
 }
 
-void CreateRootSignature()
+void CreateRootSignature(RootSignatureLayout layout)
 {
-    // һroot signatureһroot parameter
-    // һroot parameterroot constantroot descriptordescriptor table
-    CD3DX12_ROOT_PARAMETER rootParameters[4];
-    CD3DX12_DESCRIPTOR_RANGE passCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0);       // register(b0)Pass Constant Buffer
-    CD3DX12_DESCRIPTOR_RANGE objectCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 1);     // register(b1)Object Constant Buffer
-    CD3DX12_DESCRIPTOR_RANGE materialCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 2);   // register(b2)Material Constant Buffer
+    // 一个root signature定义一个root parameter数组
+    // 一个root parameter可以是root constant，root descriptor，descriptor table
+    CD3DX12_ROOT_PARAMETER rootParameters[5];
+    UINT parameterCount = 0;
+    CD3DX12_DESCRIPTOR_RANGE passCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, Layout::passData::Register);           // register(b0)，后续绑定Pass Constant Buffer
+    CD3DX12_DESCRIPTOR_RANGE objectCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, Layout::objectData::Register);       // register(b1)，后续绑定Object Constant Buffer
+    CD3DX12_DESCRIPTOR_RANGE materialCbvTable(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, Layout::materialData::Register);   // register(b2)，后续绑定Material Constant Buffer
     CD3DX12_DESCRIPTOR_RANGE textureSrvTable(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
-    rootParameters[0].InitAsDescriptorTable(1, &passCbvTable);
-    rootParameters[1].InitAsDescriptorTable(1, &objectCbvTable);
-    rootParameters[2].InitAsDescriptorTable(1, &materialCbvTable);
-    rootParameters[3].InitAsDescriptorTable(1, &textureSrvTable, D3D12_SHADER_VISIBILITY_PIXEL);
+    CD3DX12_DESCRIPTOR_RANGE bindlessTextureTable(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, UINT_MAX, 0, 1);    // register(t0, space1)，数量不限的texture数组
+
+    if (layout == RootSignatureLayout::Bindless)
+    {
+        rootParameters[0].InitAsConstantBufferView(0);      // register(b0)，Pass Constant Buffer的地址
+        rootParameters[1].InitAsConstantBufferView(1);      // register(b1)，每次draw传入Object Constant Buffer中对应元素的地址
+        rootParameters[2].InitAsConstants(1, 2);            // register(b2)，材质下标
+        rootParameters[3].InitAsShaderResourceView(0);      // register(t0)，所有材质的structured buffer
+        rootParameters[4].InitAsDescriptorTable(1, &bindlessTextureTable, D3D12_SHADER_VISIBILITY_PIXEL);
+        parameterCount = 5;
+    }
+    else
+    {
+        rootParameters[0].InitAsDescriptorTable(1, &passCbvTable);
+        rootParameters[1].InitAsDescriptorTable(1, &objectCbvTable);
+        rootParameters[2].InitAsDescriptorTable(1, &materialCbvTable);
+        rootParameters[3].InitAsDescriptorTable(1, &textureSrvTable, D3D12_SHADER_VISIBILITY_PIXEL);
+        parameterCount = 4;
+    }
 
     auto staticSamplers = InitStaticSamplers();
 
     CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
-    rootSignatureDesc.Init(4, rootParameters, (UINT)staticSamplers.size(), staticSamplers.data(), D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
+    rootSignatureDesc.Init(parameterCount, rootParameters, (UINT)staticSamplers.size(), staticSamplers.data(), D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
     ComPtr<ID3DBlob> signature;
     ComPtr<ID3DBlob> error;
 
@@ -364,7 +515,7 @@ void CreateRootSignature()
 
 void InitMeshes()
 {
-    // ּĶ±Ϣ
+    // 几种几何体的顶点和下标信息
     std::vector<Vertex> vertices;
     std::vector<std::uint16_t> indices;
 
@@ -386,7 +537,7 @@ void InitMeshes()
     const UINT verticesSize = (UINT)vertices.size() * sizeof(Vertex);
     const UINT indicesSize = (UINT)indices.size() * sizeof(std::uint16_t);
 
-    // bufferеλ
+    // 单个几何体在buffer中的位置
     Submesh cubeSubmesh;
     cubeSubmesh.indexCount = (UINT)cubeMeshData.indices.size();
     cubeSubmesh.startIndexLocation = 0;
@@ -402,18 +553,27 @@ void InitMeshes()
     sphereSubmesh.startIndexLocation = pyramidSubmesh.startIndexLocation + (UINT)pyramidMeshData.indices.size();
     sphereSubmesh.baseVertexLocation = pyramidSubmesh.baseVertexLocation + (UINT)pyramidMeshData.vertices.size();
 
-    // mesh
+    // 创建mesh对象
     auto mesh = std::make_unique<Mesh>();
     mesh->name = "baseGeometryMesh";
 
-    // verticesindicesݿmesh
+    // 将vertices和indices数据拷贝到mesh中
     ThrowIfFailed(D3DCreateBlob(verticesSize, &mesh->vertexBufferCPU));
     CopyMemory(mesh->vertexBufferCPU->GetBufferPointer(), vertices.data(), verticesSize);
     ThrowIfFailed(D3DCreateBlob(indicesSize, &mesh->indexBufferCPU));
     CopyMemory(mesh->indexBufferCPU->GetBufferPointer(), indices.data(), indicesSize);
 
-    mesh->vertexBufferGPU = d3d12Util::CreateDefaultHeapBuffer(m_device.Get(), m_commandList.Get(), vertices.data(), verticesSize, mesh->vertexBufferUploader);
-    mesh->indexBufferGPU = d3d12Util::CreateDefaultHeapBuffer(m_device.Get(), m_commandList.Get(), indices.data(), indicesSize, mesh->indexBufferUploader);
+    // vertex和index buffer都放在allocator的buffer page中，数据通过UploadManager共享的staging buffer上传
+    BufferAllocation vertexBuffer = m_resourceAllocator->AllocateBuffer(verticesSize);
+    BufferAllocation indexBuffer = m_resourceAllocator->AllocateBuffer(indicesSize);
+    m_uploadManager->UploadBuffer(vertexBuffer.resource, vertexBuffer.offset, vertices.data(), verticesSize,
+        D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COMMON);
+    m_uploadManager->UploadBuffer(indexBuffer.resource, indexBuffer.offset, indices.data(), indicesSize,
+        D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COMMON);
+    mesh->vertexBufferGPU = vertexBuffer.resource;
+    mesh->vertexBufferOffset = vertexBuffer.offset;
+    mesh->indexBufferGPU = indexBuffer.resource;
+    mesh->indexBufferOffset = indexBuffer.offset;
 
     mesh->vertexByteStride = sizeof(Vertex);
     mesh->vertexBufferSize = verticesSize;
@@ -429,28 +589,91 @@ void InitMeshes()
 
 void InitTextures()
 {
-    std::wstring textureFolder = L"../Textures/";
-    auto waterTexture = std::make_unique<Texture>();
-    waterTexture->name = "water";
-    waterTexture->fileName = textureFolder + L"water.dds";
-    ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(m_device.Get(), m_commandList.Get(),
-        waterTexture->fileName.c_str(), waterTexture->resource, waterTexture->uploader));
-
-    auto stoneTexture = std::make_unique<Texture>();
-    stoneTexture->name = "stone";
-    stoneTexture->fileName = textureFolder + L"stone.dds";
-    ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(m_device.Get(), m_commandList.Get(),
-        stoneTexture->fileName.c_str(), stoneTexture->resource, stoneTexture->uploader));
-
-    auto grassTexture = std::make_unique<Texture>();
-    grassTexture->name = "grass";
-    grassTexture->fileName = textureFolder + L"grass.dds";
-    ThrowIfFailed(DirectX::CreateDDSTextureFromFile12(m_device.Get(), m_commandList.Get(),
-        grassTexture->fileName.c_str(), grassTexture->resource, grassTexture->uploader));
-
-    m_textures[waterTexture->name] = std::move(waterTexture);
-    m_textures[stoneTexture->name] = std::move(stoneTexture);
-    m_textures[grassTexture->name] = std::move(grassTexture);
+    // 占位texture很小，和mesh一起在InitAsset最后的Flush中上传
+    CD3DX12_RESOURCE_DESC placeholderDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, 1, 1, 1, 1);
+    m_placeholderTexture = m_resourceAllocator->CreateTexture(placeholderDesc, D3D12_RESOURCE_STATE_COMMON);
+    const UINT32 white = 0xffffffff;
+    D3D12_SUBRESOURCE_DATA placeholderData = { &white, sizeof(white), sizeof(white) };
+    m_uploadManager->UploadTexture(m_placeholderTexture.Get(), 0, 1, &placeholderData,
+        D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+
+    // 读取文件和拷贝到staging buffer在工作线程中进行，每帧在UpdateTextures中提交并替换已经加载完成的texture。
+    // 使用streaming模式，先显示低分辨率的mip tail，高层mip到达后逐渐变清晰
+    UINT threadCount = std::thread::hardware_concurrency() / 2;
+    if (threadCount < 1)
+        threadCount = 1;
+    else if (threadCount > 4)
+        threadCount = 4;
+    m_textureLoader = std::make_unique<TextureLoader>(m_device.Get(), m_resourceAllocator.get(), threadCount);
+
+    // 打包后同样格式、大小的texture是一个Texture2DArray中的不同slice，其他texture在atlas中，减少resource和descriptor的数量。
+    // 重映射表中缺少材质用到的texture时按没有打包处理
+    std::string textureFolder = "Textures/Packed/";     // 相对于仓库根目录，程序的工作目录是它的子目录
+    bool packed = LoadTexturePackTable(m_texturePackPath, m_texturePack);
+    for (const char* name : m_textureNames)
+        packed = packed && m_texturePack.Find(name) != nullptr;
+    if (!packed)
+    {
+        textureFolder = "Textures/";
+        m_texturePack = TexturePackTable();
+        for (const char* name : m_textureNames)
+        {
+            TexturePackEntry entry;
+            entry.name = name;
+            entry.resource = (UINT)m_texturePack.resources.size();
+            m_texturePack.resources.push_back(std::string(name) + ".dds");
+            m_texturePack.entries.push_back(entry);
+        }
+    }
+
+    // 有打包的archive（见Util/PackAssets.bat）时其中的texture都从这一个文件读取，工作线程把数据直接解压到staging buffer中。
+    const bool hasArchive = m_assetArchive.Open(m_assetArchivePath);
+    std::vector<std::unique_ptr<Texture>> textures;
+    std::vector<std::wstring> looseFileNames;
+    for (const std::string& file : m_texturePack.resources)
+    {
+        auto texture = std::make_unique<Texture>();
+        texture->name = file;
+        const std::string path = textureFolder + file;
+        texture->fileName = L"../" + std::wstring(path.begin(), path.end());
+        texture->archiveEntry = hasArchive ? m_assetArchive.Find(path) : nullptr;
+        if (texture->archiveEntry != nullptr)
+            texture->archive = &m_assetArchive;
+        else
+            looseFileNames.push_back(texture->fileName);
+        textures.push_back(std::move(texture));
+    }
+
+    // 其他texture先并行读取所有文件的头部，在这里创建全部resource，工作线程只需要读取和上传数据。
+    // 头部无效或者不是Texture2D的文件交给TextureLoader按原来的方式处理，由它报告错误
+    DDSTextureCatalog catalog;
+    ThrowIfFailed(BuildDDSTextureCatalog(looseFileNames, catalog, threadCount));
+
+    size_t looseIndex = 0;
+    for (auto& texture : textures)
+    {
+        if (texture->archiveEntry != nullptr)
+            m_textureLoader->Request(texture.get(), true);
+        else
+        {
+            const DDSCatalogEntry& entry = catalog.entries[looseIndex++];
+            if (SUCCEEDED(entry.status) && entry.desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE2D)
+                m_textureLoader->Request(texture.get(), entry.desc, true);
+            else
+                m_textureLoader->Request(texture.get(), true);
+        }
+        m_textureResources.push_back(texture.get());
+        m_textures[texture->name] = std::move(texture);
+    }
+}
+
+// 材质引用的是texture的名字，打包后对应一个resource中的slice或者UV区域
+void SetAlbedoTexture(Material* material, const std::string& textureName)
+{
+    const TexturePackEntry* entry = m_texturePack.Find(textureName);
+    material->albedoTextureIndex = (int)entry->resource;
+    material->albedoTextureSlice = entry->slice;
+    material->albedoUvTransform = XMFLOAT4(entry->uvScale[0], entry->uvScale[1], entry->uvOffset[0], entry->uvOffset[1]);
 }
 
 void InitMaterials()
@@ -458,7 +681,7 @@ void InitMaterials()
     auto water = std::make_unique<Material>();
     water->name = "water";
     water->cbIndex = 0;
-    water->albedoTextureIndex = 0;
+    SetAlbedoTexture(water.get(), "water");
     water->albedo = XMFLOAT4(Colors::White);
     water->fresnelR0 = XMFLOAT3(0.02f, 0.02f, 0.02f);
     water->roughness = 0.1f;
@@ -466,7 +689,7 @@ void InitMaterials()
     auto stone = std::make_unique<Material>();
     stone->name = "stone";
     stone->cbIndex = 1;
-    stone->albedoTextureIndex = 1;
+    SetAlbedoTexture(stone.get(), "stone");
     stone->albedo = XMFLOAT4(Colors::White);
     stone->fresnelR0 = XMFLOAT3(0.8f, 0.8f, 0.8f);
     stone->roughness = 1.0f;
@@ -474,7 +697,7 @@ void InitMaterials()
     auto grass = std::make_unique<Material>();
     grass->name = "grass";
     grass->cbIndex = 2;
-    grass->albedoTextureIndex = 2;
+    SetAlbedoTexture(grass.get(), "grass");
     grass->albedo = XMFLOAT4(Colors::White);
     grass->fresnelR0 = XMFLOAT3(0.8f, 0.8f, 0.8f);
     grass->roughness = 1.0f;
@@ -557,10 +780,10 @@ void InitRenderItems()
 
 void InitConstantBuffer()
 {
-    // Pass Constant Bufferupdateֵ
+    // 创建Pass Constant Buffer，在update里设置值
     m_passConstantBuffer = std::make_unique<UploadHeapConstantBuffer<PassConstant>>(m_device.Get(), 1);
 
-    // Object Constant Buffer
+    // 创建、设置Object Constant Buffer
     m_objectConstantBuffer = std::make_unique<UploadHeapConstantBuffer<ObjectConstant>>(m_device.Get(), (UINT)m_renderItems.size());
     for (auto& item : m_renderItems)
     {
@@ -570,72 +793,181 @@ void InitConstantBuffer()
         m_objectConstantBuffer->CopyData(item->objectCBIndex, objectConstant);
     }
 
-    // Material Constant Buffer
-    m_materialConstantBuffer = std::make_unique<UploadHeapConstantBuffer<MaterialConstant>>(m_device.Get(), (UINT)m_materials.size());
+    // 创建、设置Material Constant Buffer
+    m_materialConstantBuffer = std::make_unique<UploadHeapConstantBuffer<TextureMaterialConstant>>(m_device.Get(), (UINT)m_materials.size());
     for (auto& e : m_materials)
     {
         Material* mat = e.second.get();
-        MaterialConstant materialConstant;
+        TextureMaterialConstant materialConstant;
         materialConstant.albedo = mat->albedo;
         materialConstant.fresnelR0 = mat->fresnelR0;
         materialConstant.roughness = mat->roughness;
+        materialConstant.albedoUvTransform = mat->albedoUvTransform;
+        materialConstant.albedoTextureSlice = mat->albedoTextureSlice;
         m_materialConstantBuffer->CopyData(mat->cbIndex, materialConstant);
     }
 }
 
 void InitCbvSrvDescriptor()
 {
-    UINT passCount = 1;
-    UINT itemCount = (UINT)m_renderItems.size();
-    UINT materialCount = (UINT)m_materials.size();
-    UINT textureCount = (UINT)m_textures.size();
-
-    D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc;
-    cbvHeapDesc.NumDescriptors = passCount + itemCount + materialCount + textureCount;
-    cbvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    cbvHeapDesc.NodeMask = 0;
-    ThrowIfFailed(m_device->CreateDescriptorHeap(&cbvHeapDesc, IID_PPV_ARGS(&m_cbvSrvHeap)));
-
-    CD3DX12_CPU_DESCRIPTOR_HANDLE cbvHeapHandle(m_cbvSrvHeap->GetCPUDescriptorHandleForHeapStart());
-    m_passConstantBuffer->CreateConstantBufferView(m_device.Get(), cbvHeapHandle, 0);
-
-    // Object Constant BufferӦCBV
-    for (UINT i = 0; i < itemCount; ++i)
+    // 每个descriptor单独分配，记录各自的handle，新增物体时不需要重建heap
+    m_passCbv = m_descriptorAllocator->Allocate();
+    m_passConstantBuffer->CreateConstantBufferView(m_device.Get(), CD3DX12_CPU_DESCRIPTOR_HANDLE(m_passCbv.cpuHandle), 0);
+
+    // Object Constant Buffer对应的CBV
+    m_objectCbvs.resize(m_renderItems.size());
+    for (auto& item : m_renderItems)
+    {
+        DescriptorHandle& handle = m_objectCbvs[item->objectCBIndex];
+        handle = m_descriptorAllocator->Allocate();
+        m_objectConstantBuffer->CreateConstantBufferView(m_device.Get(), CD3DX12_CPU_DESCRIPTOR_HANDLE(handle.cpuHandle), item->objectCBIndex);
+    }
+
+    // Material Constant Buffer对应的CBV
+    m_materialCbvs.resize(m_materials.size());
+    for (auto& e : m_materials)
+    {
+        Material* mat = e.second.get();
+        DescriptorHandle& handle = m_materialCbvs[mat->cbIndex];
+        handle = m_descriptorAllocator->Allocate();
+        m_materialConstantBuffer->CreateConstantBufferView(m_device.Get(), CD3DX12_CPU_DESCRIPTOR_HANDLE(handle.cpuHandle), mat->cbIndex);
+    }
+
+    // Texture对应的SRV，按albedoTextureIndex即m_textureResources的顺序排列，还没加载完成的先指向占位texture
+    m_textureSrvs.resize(m_textureResources.size());
+    m_textureResidencyIds.resize(m_textureResources.size(), TextureResidencyManager::InvalidId);
+    for (UINT i = 0; i < (UINT)m_textureResources.size(); ++i)
     {
-        auto handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_cbvSrvHeap->GetCPUDescriptorHandleForHeapStart());
-        handle.Offset(i + passCount, m_cbvSrvUavDescriptorSize);
-        m_objectConstantBuffer->CreateConstantBufferView(m_device.Get(), handle, i);
+        Texture* texture = m_textureResources[i];
+        m_textureSrvs[i] = m_descriptorAllocator->Allocate();
+        if (texture->loadState == TextureLoadState::Resident)
+            CreateTextureSrv(texture->resource.Get(), m_textureSrvs[i].cpuHandle, (float)texture->residentMip);
+        else
+            CreateTextureSrv(m_placeholderTexture.Get(), m_textureSrvs[i].cpuHandle, 0.0f);
     }
+}
+
+// minLod为已经上传的最精细的mip，SRV包含所有mip，但采样时不会读取还没上传的mip。
+// 不管是否打包都创建为Texture2DArray的SRV，shader中统一按slice采样，单独的texture只有一个slice，
+// 占位texture的slice超出范围时会取最后一个slice
+void CreateTextureSrv(ID3D12Resource* texture, D3D12_CPU_DESCRIPTOR_HANDLE handle, float minLod)
+{
+    const D3D12_RESOURCE_DESC desc = texture->GetDesc();
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Format = desc.Format;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+    srvDesc.Texture2DArray.MostDetailedMip = 0;
+    srvDesc.Texture2DArray.MipLevels = desc.MipLevels;
+    srvDesc.Texture2DArray.FirstArraySlice = 0;
+    srvDesc.Texture2DArray.ArraySize = desc.DepthOrArraySize;
+    srvDesc.Texture2DArray.PlaneSlice = 0;
+    srvDesc.Texture2DArray.ResourceMinLODClamp = minLod;
+    m_device->CreateShaderResourceView(texture, &srvDesc, handle);
+}
 
-    // Material Constant BufferӦCBV
-    for (UINT i = 0; i < materialCount; ++i)
+void UpdateTextures()
+{
+    // 返回的texture已经Resident、有新的mip到达或者被换成了只包含部分mip的resource，改写SRV放开ResourceMinLODClamp。
+    // 上一帧结束时已经等待GPU完成，这里可以直接改写SRV和bindless数组中的descriptor
+    std::vector<ComPtr<ID3D12Resource>> replacedResources;
+    for (Texture* texture : m_textureLoader->Update(&replacedResources))
     {
-        auto handle = CD3DX12_CPU_DESCRIPTOR_HANDLE(m_cbvSrvHeap->GetCPUDescriptorHandleForHeapStart());
-        handle.Offset(i + passCount + itemCount, m_cbvSrvUavDescriptorSize);
-        m_materialConstantBuffer->CreateConstantBufferView(m_device.Get(), handle, i);
+        for (UINT i = 0; i < (UINT)m_textureResources.size(); ++i)
+        {
+            if (m_textureResources[i] != texture)
+                continue;
+            CreateTextureSrv(texture->resource.Get(), m_textureSrvs[i].cpuHandle, (float)texture->residentMip);
+            if (m_bindlessTextures != nullptr)
+                m_bindlessTextures->Update(m_textureSlots[i]);
+
+            // 所有mip都加载完成后才交给residency manager管理，之后的变化都来自它的请求
+            UINT& residencyId = m_textureResidencyIds[i];
+            if (residencyId != TextureResidencyManager::InvalidId)
+                m_textureResidency.Complete(residencyId, texture->topMip);
+            else if (texture->loadState == TextureLoadState::Resident && texture->residentMip == 0)
+                residencyId = RegisterTextureResidency(texture->resource.Get());
+        }
     }
+    // 被替换的texture可能还在已提交的command list中使用，等最后提交的fence完成后再还给allocator
+    for (auto& resource : replacedResources)
+        m_releaseQueue.Retire(PlacedTextureRelease(m_resourceAllocator.get(), std::move(resource)), m_fenceValue);
+
+    // 根据上一帧绘制时的使用情况，在预算内降低最久没用的texture的分辨率，或者恢复用到的texture的分辨率
+    std::vector<TextureResidencyManager::Action> actions;
+    m_textureResidency.EndFrame(actions);
+    for (auto& action : actions)
+    {
+        for (UINT i = 0; i < (UINT)m_textureResources.size(); ++i)
+        {
+            if (m_textureResidencyIds[i] == action.id)
+                m_textureLoader->RequestMips(m_textureResources[i], action.firstMip);
+        }
+    }
+#if defined(DEBUG) || defined(_DEBUG)
+    if (!actions.empty())
+    {
+        const TextureResidencyManager::FrameStats& stats = m_textureResidency.GetLastFrameStats();
+        std::string message = "TextureResidency: frame " + std::to_string(stats.frame) + ", hit rate " + std::to_string(stats.HitRate()) +
+            ", " + std::to_string(stats.uploadedBytes) + " bytes to upload, " + std::to_string(stats.evictedBytes) + " bytes evicted, " +
+            std::to_string(stats.residentBytes) + " / " + std::to_string(m_textureResidency.GetBudget()) + " bytes resident\n";
+        OutputDebugStringA(message.c_str());
+    }
+#endif
+}
 
-    // TextureӦSRV
-    CD3DX12_CPU_DESCRIPTOR_HANDLE srvHeapHandle(m_cbvSrvHeap->GetCPUDescriptorHandleForHeapStart());
-    srvHeapHandle.Offset(passCount + itemCount + materialCount, m_cbvSrvUavDescriptorSize);
-    for (auto& e : m_textures)
+// 每级mip（包含所有array slice）的数据大小作为显存占用的估计，返回residency manager中的id
+UINT RegisterTextureResidency(ID3D12Resource* texture)
+{
+    const D3D12_RESOURCE_DESC desc = texture->GetDesc();
+    const UINT arraySize = desc.Dimension == D3D12_RESOURCE_DIMENSION_TEXTURE3D ? 1 : desc.DepthOrArraySize;
+    const UINT subresourceCount = desc.MipLevels * arraySize;
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> layouts(subresourceCount);
+    std::vector<UINT> numRows(subresourceCount);
+    std::vector<UINT64> rowSizes(subresourceCount);
+    m_device->GetCopyableFootprints(&desc, 0, subresourceCount, 0, layouts.data(), numRows.data(), rowSizes.data(), nullptr);
+
+    std::vector<UINT64> mipSizes(desc.MipLevels, 0);
+    for (UINT i = 0; i < subresourceCount; ++i)
+        mipSizes[i % desc.MipLevels] += rowSizes[i] * numRows[i] * layouts[i].Footprint.Depth;
+    return m_textureResidency.Register(mipSizes, 0);
+}
+
+void InitBindlessTables()
+{
+    // texture的SRV拷贝到bindless数组中，记录各自的槽位
+    m_bindlessTextures = std::make_unique<BindlessDescriptorTable>(m_device.Get(), m_descriptorRing.get());
+    m_textureSlots.resize(m_textureSrvs.size());
+    for (UINT i = 0; i < (UINT)m_textureSrvs.size(); ++i)
+        m_textureSlots[i] = m_bindlessTextures->Add(m_textureSrvs[i]);
+
+    // 所有材质放在一个structured buffer中
+    m_bindlessMaterialSlots = std::make_unique<BindlessSlotTable>(m_maxBindlessCount);
+    m_bindlessMaterialBuffer = std::make_unique<UploadHeapBuffer<BindlessMaterialConstant>>(m_device.Get(), m_maxBindlessCount, false);
+    m_materialSlots.resize(m_materials.size());
+    for (auto& e : m_materials)
     {
-        auto texture = e.second.get()->resource;
-        D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-        srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-        srvDesc.Format = texture->GetDesc().Format;
-        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-        srvDesc.Texture2D.MostDetailedMip = 0;
-        srvDesc.Texture2D.MipLevels = texture->GetDesc().MipLevels;
-        srvDesc.Texture2D.ResourceMinLODClamp = 0.0f;
-        m_device->CreateShaderResourceView(texture.Get(), &srvDesc, srvHeapHandle);
-        srvHeapHandle.Offset(1, m_cbvSrvUavDescriptorSize);
+        m_materialSlots[e.second->cbIndex] = m_bindlessMaterialSlots->Add();
+        UpdateBindlessMaterial(e.second.get());
     }
 }
 
+void UpdateBindlessMaterial(const Material* material)
+{
+    BindlessMaterialConstant materialConstant;
+    materialConstant.albedo = material->albedo;
+    materialConstant.fresnelR0 = material->fresnelR0;
+    materialConstant.roughness = material->roughness;
+    materialConstant.albedoUvTransform = material->albedoUvTransform;
+    materialConstant.albedoTextureIndex = m_textureSlots[material->albedoTextureIndex];
+    materialConstant.albedoTextureSlice = material->albedoTextureSlice;
+    m_bindlessMaterialBuffer->CopyData(m_materialSlots[material->cbIndex], materialConstant);
+}
+
 void OnUpdate()
 {
+    UpdateTextures();
+
     PassConstant passConstants;
     XMVECTOR cameraPosition = XMVectorSet(-3.0f, 2.0f, -3.0f, 1.0f);
     XMVECTOR focusPosition = XMVectorZero();
@@ -651,10 +983,10 @@ void OnUpdate()
     XMMATRIX projectMatrix = XMMatrixPerspectiveFovLH(fovAngleY, aspectRatio, nearZ, farZ);
     XMStoreFloat4x4(&passConstants.projectMatrix, XMMatrixTranspose(projectMatrix));
 
-    // ӹ
+    // 设间接光
     passConstants.ambientLight = { 0.3f, 0.3f, 0.3f, 1.0f };
 
-    // ƽй
+    // 平行光
     XMStoreFloat3(&passConstants.lights[0].direction, XMVector3Normalize(XMVectorSet(3.0f, -4.0f, -2.0f, 1.0f)));
     passConstants.lights[0].strength = { 1.0f, 1.0f, 1.0f };
 
@@ -665,77 +997,122 @@ void OnRender()
 {
     PopulateCommandList();
 
-    // ϴCommand ListGPU
-    ID3D12CommandList* ppCommandLists[] = { m_commandList.Get() };
-    m_commandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+    // 根据已提交的状态补上m_commandList开头需要的barrier，没有时不记录也不提交preamble
+    ID3D12CommandList* ppCommandLists[] = { m_preambleCommandList.Get(), m_commandList.Get() };
+    if (m_stateTracker.ResolvePendingBarriers(m_resourceStates))
+    {
+        ThrowIfFailed(m_preambleCommandAllocator->Reset());
+        ThrowIfFailed(m_preambleCommandList->Reset(m_preambleCommandAllocator.Get(), nullptr));
+        m_stateTracker.RecordResolvedBarriers(m_preambleCommandList.Get());
+        ThrowIfFailed(m_preambleCommandList->Close());
+
+        // 上传Command List到GPU
+        m_commandQueue->ExecuteCommandLists(_countof(ppCommandLists), ppCommandLists);
+    }
+    else
+    {
+        m_commandQueue->ExecuteCommandLists(1, ppCommandLists + 1);
+    }
 
     // surface flipping
     ThrowIfFailed(m_swapChain->Present(1, 0));
     m_currendBackBufferIndex = (m_currendBackBufferIndex + 1) % m_swapChainBufferCount;
 
     FlushCommandQueue();
+
+    m_descriptorRing->RetireSubmitted(m_fenceValue);
+    m_descriptorRing->ReleaseCompleted(m_fence->GetCompletedValue());
+    m_releaseQueue.ReleaseCompleted(m_fence->GetCompletedValue());
 }
 
 void PopulateCommandList()
 {
-    UINT passCount = 1;
-    UINT itemCount = (UINT)m_renderItems.size();
-    UINT materialCount = (UINT)m_materials.size();
-    UINT textureCount = (UINT)m_textures.size();
-
-    // Resetһ֡ʹõCommand Allocator洢ǰ֡Ҫ¼Command
+    // Reset上一帧使用的Command Allocator，用来存储当前帧要记录的Command
     ThrowIfFailed(m_commandAllocator->Reset());
-    // Resetһ֡ʹõCommand List¼¼ǰ֡Command
+    // Reset上一帧使用的Command List，重新记录当前帧的Command
     ThrowIfFailed(m_commandList->Reset(m_commandAllocator.Get(), m_pipelineState.Get()));
+    m_stateTracker.Reset();
 
-    // Command List ResetҪ
+    // Command List Reset后，需要重新设置
     m_commandList->RSSetViewports(1, &m_viewport);
     m_commandList->RSSetScissorRects(1, &m_scissorRect);
 
-    m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_swapChainBuffer[m_currendBackBufferIndex].Get(),
-        D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
+    // back buffer只在这个command list中使用，记录时已提交的状态就是它开始执行时的状态，barrier不需要等到提交时再补
+    ID3D12Resource* backBuffer = m_swapChainBuffer[m_currendBackBufferIndex].Get();
+    D3D12ResourceStateRegistry::State backBufferState;
+    if (m_resourceStates.GetState(backBuffer, backBufferState))
+        m_stateTracker.SetInitialState(backBuffer, (D3D12_RESOURCE_STATES)backBufferState);
+    m_stateTracker.Transition(backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
+    m_stateTracker.FlushBarriers(m_commandList.Get());
 
-    // ȡǰ
+    // 获取当前
     CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart(), m_currendBackBufferIndex, m_rtvDescriptorSize);
     m_commandList->OMSetRenderTargets(1, &rtvHandle, FALSE, nullptr);
     m_commandList->ClearRenderTargetView(rtvHandle, Colors::White, 0, nullptr);
     
-    ID3D12DescriptorHeap* descriptorHeaps[] = { m_cbvSrvHeap.Get() };
-    int size = _countof(descriptorHeaps);
+    ID3D12DescriptorHeap* descriptorHeaps[] = { m_descriptorRing->GetHeap() };
     m_commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps);
     
     m_commandList->SetGraphicsRootSignature(m_rootSignature.Get());
 
-    CD3DX12_GPU_DESCRIPTOR_HANDLE handle(m_cbvSrvHeap->GetGPUDescriptorHandleForHeapStart());
-    m_commandList->SetGraphicsRootDescriptorTable(0, handle);   // passϢ
+    bool useBindless = m_rootSignatureLayout == RootSignatureLayout::Bindless;
+    DescriptorTable table;
+    if (useBindless)
+    {
+        // texture和材质都是常驻的，每帧不需要拷贝descriptor
+        m_commandList->SetGraphicsRootConstantBufferView(0, m_passConstantBuffer->GetGPUVirtualAddress(0));         // pass信息
+        m_commandList->SetGraphicsRootShaderResourceView(3, m_bindlessMaterialBuffer->GetGPUVirtualAddress(0));     // 所有材质
+        m_commandList->SetGraphicsRootDescriptorTable(4, m_bindlessTextures->GetGpuHandle());                       // 所有texture
+    }
+    else
+    {
+        // 本帧用到的descriptor一次性拷贝到shader visible heap中，依次是pass，然后每个render item的object、material、texture
+        std::vector<DescriptorHandle> descriptors;
+        descriptors.reserve(1 + m_renderItems.size() * 3);
+        descriptors.push_back(m_passCbv);
+        for (auto& item : m_renderItems)
+        {
+            descriptors.push_back(m_objectCbvs[item->objectCBIndex]);
+            descriptors.push_back(m_materialCbvs[item->material->cbIndex]);
+            descriptors.push_back(m_textureSrvs[item->material->albedoTextureIndex]);
+        }
+        table = m_descriptorRing->Copy(descriptors.data(), (UINT)descriptors.size());
+
+        m_commandList->SetGraphicsRootDescriptorTable(0, table.GpuHandle(0));   // pass信息
+    }
 
-    // 
+    // 绘制
+    UINT tableIndex = 1;
     for (auto& item : m_renderItems)
     {
         m_commandList->IASetVertexBuffers(0, 1, &item->mesh->GetVertexBufferView());
         m_commandList->IASetIndexBuffer(&item->mesh->GetIndexBufferView());
         m_commandList->IASetPrimitiveTopology(item->primitiveType);
 
-        // Object Constant Buffer
-        auto cbvHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_cbvSrvHeap->GetGPUDescriptorHandleForHeapStart());
-        cbvHandle.Offset(item->objectCBIndex + passCount, m_cbvSrvUavDescriptorSize);
-        m_commandList->SetGraphicsRootDescriptorTable(1, cbvHandle);
+        // 记录本帧用到的texture，下一帧开始时residency manager据此调整
+        const UINT residencyId = m_textureResidencyIds[item->material->albedoTextureIndex];
+        if (residencyId != TextureResidencyManager::InvalidId)
+            m_textureResidency.Touch(residencyId);
 
-        // Material Constant Buffer
-        cbvHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_cbvSrvHeap->GetGPUDescriptorHandleForHeapStart());
-        cbvHandle.Offset(item->material->cbIndex + passCount + itemCount, m_cbvSrvUavDescriptorSize);
-        m_commandList->SetGraphicsRootDescriptorTable(2, cbvHandle);
-
-        // Texture
-        auto srvHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE(m_cbvSrvHeap->GetGPUDescriptorHandleForHeapStart());
-        srvHandle.Offset(item->material->albedoTextureIndex + passCount + itemCount + materialCount, m_cbvSrvUavDescriptorSize);
-        m_commandList->SetGraphicsRootDescriptorTable(3, srvHandle);
+        if (useBindless)
+        {
+            // 切换材质只需要改变root constant
+            m_commandList->SetGraphicsRootConstantBufferView(1, m_objectConstantBuffer->GetGPUVirtualAddress(item->objectCBIndex));
+            m_commandList->SetGraphicsRoot32BitConstant(2, m_materialSlots[item->material->cbIndex], 0);
+        }
+        else
+        {
+            m_commandList->SetGraphicsRootDescriptorTable(1, table.GpuHandle(tableIndex));      // Object Constant Buffer
+            m_commandList->SetGraphicsRootDescriptorTable(2, table.GpuHandle(tableIndex + 1));  // Material Constant Buffer
+            m_commandList->SetGraphicsRootDescriptorTable(3, table.GpuHandle(tableIndex + 2));  // Texture
+            tableIndex += 3;
+        }
 
         m_commandList->DrawIndexedInstanced(item->indexCount, 1, item->startIndexLocation, item->baseVertexLocation, 0);
     }
 
-    m_commandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(m_swapChainBuffer[m_currendBackBufferIndex].Get(),
-        D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_PRESENT));
+    m_stateTracker.Transition(backBuffer, D3D12_RESOURCE_STATE_PRESENT);
+    m_stateTracker.FlushBarriers(m_commandList.Get());
 
     ThrowIfFailed(m_commandList->Close());
 }
@@ -743,5 +1120,7 @@ void PopulateCommandList()
 void OnDestroy()
 {
     FlushCommandQueue();
+    m_textureLoader.reset();
+    m_releaseQueue.ReleaseCompleted(m_fenceValue);
     CloseHandle(m_fenceEvent);
 }
\ No newline at end of file
@@ -35,14 +35,38 @@ cbuffer objectData : register(b1)
     float4x4 normalMatrix;
 }
 
+#ifdef BINDLESS
+// 所有材质在一个structured buffer中，所有texture在一个unbounded数组中，每次draw只传入材质下标
+struct MaterialData
+{
+    float4 albedo;
+    float3 fresnelR0;
+    float roughness;
+    float4 albedoUvTransform;
+    uint albedoTextureIndex;
+    uint albedoTextureSlice;
+    uint2 padding;
+};
+StructuredBuffer<MaterialData> materials : register(t0);
+Texture2DArray textures[] : register(t0, space1);
+
+cbuffer drawData : register(b2)
+{
+    uint materialIndex;
+}
+#else
 cbuffer materialData : register(b2)
 {
     float4 albedo;
     float3 fresnelR0;
     float roughness;
+    float4 albedoUvTransform;
+    uint albedoTextureSlice;
+    uint3 padding;
 };
 
-Texture2D albedoTexture : register(t0);
+Texture2DArray albedoTexture : register(t0);
+#endif
 
 SamplerState pointWrapSampler : register(s0);
 SamplerState pointClampSampler : register(s1);
@@ -51,15 +75,23 @@ SamplerState linearClampSampler : register(s3);
 SamplerState anisotropicWrapSampler : register(s4);
 SamplerState anisotropicClampSampler : register(s5);
 
+// texture打包为Texture2DArray或atlas后（见Common/TexturePackTable.h），先在texture内wrap，再变换到atlas中的区域。
+// 梯度按原来的uv计算，frac在texture边界处的跳变不会选到最低的mip
+float4 SampleAlbedo(Texture2DArray textureArray, float2 uv, float4 uvTransform, uint slice)
+{
+    float2 packedUv = frac(uv) * uvTransform.xy + uvTransform.zw;
+    return textureArray.SampleGrad(pointWrapSampler, float3(packedUv, slice), ddx(uv) * uvTransform.xy, ddy(uv) * uvTransform.xy);
+}
+
 PSInput VSMain(float3 position : POSITION, float3 normal : NORMAL, float2 uv : TEXCOORD)
 {
     PSInput result;
-    // µλ
+    // 顶点在世界坐标下的位置
     float4 positionInWorld = mul(float4(position, 1.0f), modelMatrix);
     result.positionInWorld = positionInWorld.xyz;
-    // ķµֵ
+    // 顶点的法线在世界坐标下的值
     result.normalInWorld = mul(normal, (float3x3)normalMatrix);
-    // βüռµλ
+    // 顶点在齐次裁剪空间下的位置
     result.position = mul(positionInWorld, mul(viewMatrix, projectMatrix));
     result.uv = uv;
 
@@ -68,16 +100,25 @@ PSInput VSMain(float3 position : POSITION, float3 normal : NORMAL, float2 uv : T
 
 float4 PSMain(PSInput input) : SV_TARGET
 {
-    float4 diffuseAlbedo = albedoTexture.Sample(pointWrapSampler, input.uv) * albedo;
+#ifdef BINDLESS
+    MaterialData materialData = materials[materialIndex];
+    float4 albedo = materialData.albedo;
+    float3 fresnelR0 = materialData.fresnelR0;
+    float roughness = materialData.roughness;
+    float4 diffuseAlbedo = SampleAlbedo(textures[materialData.albedoTextureIndex], input.uv,
+        materialData.albedoUvTransform, materialData.albedoTextureSlice) * albedo;
+#else
+    float4 diffuseAlbedo = SampleAlbedo(albedoTexture, input.uv, albedoUvTransform, albedoTextureSlice) * albedo;
+#endif
 
-    // һ
+    // 归一化法线向量
     input.normalInWorld = normalize(input.normalInWorld);
-    // 浽cameraĵλ
+    // 表面到camera的单位向量
     float3 toCamera = normalize(cameraPositionInWorld - input.positionInWorld);
-    // գģӹ
+    // 环境光照，模拟间接光
     float4 ambient = ambientLight * diffuseAlbedo;
     Material material = { diffuseAlbedo, fresnelR0, roughness };
-    // ֱӹ⣬;淴
+    // 直接光，包含漫反射和镜面反射
     float4 directLight = ComputeLighting(lights, material, input.positionInWorld, input.normalInWorld, toCamera);
     float4 litColor = ambient + directLight;
     litColor.a = diffuseAlbedo.a;
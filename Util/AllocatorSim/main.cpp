@@ -0,0 +1,353 @@
+#include "../../Common/TlsfAllocator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// 用法：AllocatorSim [-class buffer|texture|rendertarget] [-ops 操作次数] [-live 平均存活的分配数量] [-page page大小MB]
+//                    [-validate 每多少次操作检查一次，0为不检查] [-seed 随机种子] [-csv 统计.csv]
+// 用随机的分配/释放序列驱动TlsfAllocator，按PlacedResourceAllocator的方式划分page（同样的分配粒度和对齐，
+// 依次在已有page中分配，放不下时新建page，超过page大小的resource单独一个page，完全空闲的page释放），不需要GPU。
+// 每隔一段操作调用每个page的Validate，并检查分配结果对齐、不越界、互不重叠，最后报告page数量、碎片率和对齐浪费。
+//   buffer       256B到1MB，256字节对齐
+//   texture      4KB到16MB，不超过64KB的按4KB对齐（small resource），其余按64KB对齐
+//   rendertarget 1MB到32MB，64KB对齐
+
+namespace
+{
+    using uint32 = TlsfAllocator::uint32;
+    using uint64 = TlsfAllocator::uint64;
+
+    const uint64 SmallAlignment = 4096;
+    const uint64 DefaultAlignment = 65536;
+
+    struct Options
+    {
+        std::string heapClass = "texture";
+        uint32 operationCount = 200000;
+        uint32 liveCount = 500;
+        uint64 pageSize = 64ull * 1024 * 1024;
+        uint32 validateInterval = 1000;
+        uint32 seed = 1;
+        std::string csvPath;
+    };
+
+    struct Page
+    {
+        std::unique_ptr<TlsfAllocator> allocator;
+    };
+
+    struct LiveAllocation
+    {
+        uint32 pageIndex;
+        uint64 alignment;
+        TlsfAllocator::Allocation allocation;
+    };
+
+    // 与PlacedResourceAllocator中的GetGranularity一致
+    uint64 GetGranularity(const std::string& heapClass)
+    {
+        if (heapClass == "buffer")
+            return 256;
+        if (heapClass == "texture")
+            return SmallAlignment;
+        return DefaultAlignment;
+    }
+
+    // 大小按对数均匀分布，小的resource更多
+    void RandomRequest(const std::string& heapClass, std::mt19937& random, uint64& size, uint64& alignment)
+    {
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        auto logUniform = [&](double minSize, double maxSize)
+        {
+            return (uint64)(minSize * std::pow(maxSize / minSize, uniform(random)));
+        };
+
+        if (heapClass == "buffer")
+        {
+            size = logUniform(256.0, 1024.0 * 1024.0);
+            alignment = 256;
+        }
+        else if (heapClass == "texture")
+        {
+            size = logUniform(4096.0, 16.0 * 1024 * 1024);
+            alignment = size <= DefaultAlignment ? SmallAlignment : DefaultAlignment;
+            size = (size + alignment - 1) & ~(alignment - 1);
+        }
+        else
+        {
+            size = logUniform(1024.0 * 1024.0, 32.0 * 1024 * 1024);
+            alignment = DefaultAlignment;
+            size = (size + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    class PagedAllocator
+    {
+    public:
+        PagedAllocator(uint64 pageSize, uint64 granularity) : m_pageSize(pageSize), m_granularity(granularity) {}
+
+        LiveAllocation Allocate(uint64 size, uint64 alignment)
+        {
+            LiveAllocation live;
+            live.alignment = alignment;
+            for (uint32 i = 0; i < (uint32)m_pages.size(); ++i)
+            {
+                if (m_pages[i].allocator != nullptr && m_pages[i].allocator->Allocate(size, alignment, live.allocation))
+                {
+                    live.pageIndex = i;
+                    return live;
+                }
+            }
+
+            live.pageIndex = CreatePage(size + alignment);
+            ++m_createdPageCount;
+            if (!m_pages[live.pageIndex].allocator->Allocate(size, alignment, live.allocation))
+                live.allocation = TlsfAllocator::Allocation();
+            return live;
+        }
+
+        void Free(const LiveAllocation& live)
+        {
+            m_pages[live.pageIndex].allocator->Free(live.allocation);
+        }
+
+        void ReleaseEmptyPages()
+        {
+            for (auto& page : m_pages)
+            {
+                if (page.allocator != nullptr && page.allocator->IsEmpty())
+                    page.allocator.reset();
+            }
+        }
+
+        bool Validate()const
+        {
+            for (auto& page : m_pages)
+            {
+                if (page.allocator != nullptr && !page.allocator->Validate())
+                    return false;
+            }
+            return true;
+        }
+
+        // 与PlacedResourceAllocator::GetStats相同，largestFreeBlock取各page中的最大值
+        TlsfAllocator::Stats GetStats(uint32& pageCount)const
+        {
+            TlsfAllocator::Stats total;
+            pageCount = 0;
+            for (auto& page : m_pages)
+            {
+                if (page.allocator == nullptr)
+                    continue;
+                ++pageCount;
+                TlsfAllocator::Stats stats = page.allocator->GetStats();
+                total.totalSize += stats.totalSize;
+                total.usedSize += stats.usedSize;
+                total.requestedSize += stats.requestedSize;
+                total.freeSize += stats.freeSize;
+                total.largestFreeBlock = (std::max)(total.largestFreeBlock, stats.largestFreeBlock);
+                total.allocationCount += stats.allocationCount;
+                total.freeBlockCount += stats.freeBlockCount;
+            }
+            return total;
+        }
+
+        uint64 GetPageSize(uint32 pageIndex)const { return m_pages[pageIndex].allocator->Size(); }
+        uint32 GetCreatedPageCount()const { return m_createdPageCount; }
+
+    private:
+        uint32 CreatePage(uint64 size)
+        {
+            size = (std::max)(size, m_pageSize);
+            size = (size + DefaultAlignment - 1) & ~(DefaultAlignment - 1);
+
+            Page page;
+            page.allocator = std::make_unique<TlsfAllocator>(size, m_granularity);
+            for (uint32 i = 0; i < (uint32)m_pages.size(); ++i)
+            {
+                if (m_pages[i].allocator == nullptr)
+                {
+                    m_pages[i] = std::move(page);
+                    return i;
+                }
+            }
+            m_pages.push_back(std::move(page));
+            return (uint32)m_pages.size() - 1;
+        }
+
+        uint64 m_pageSize;
+        uint64 m_granularity;
+        std::vector<Page> m_pages;
+        uint32 m_createdPageCount = 0;
+    };
+
+    // 分配结果对齐、在page范围内，并且同一个page中的分配互不重叠
+    bool CheckAllocations(const PagedAllocator& allocator, const std::vector<LiveAllocation>& liveAllocations)
+    {
+        std::vector<const LiveAllocation*> sorted;
+        for (auto& live : liveAllocations)
+        {
+            const auto& allocation = live.allocation;
+            if ((allocation.offset & (live.alignment - 1)) != 0 || allocation.offset + allocation.size > allocator.GetPageSize(live.pageIndex))
+            {
+                std::cerr << "allocation at " << allocation.offset << " in page " << live.pageIndex << " is misaligned or out of range" << std::endl;
+                return false;
+            }
+            sorted.push_back(&live);
+        }
+
+        std::sort(sorted.begin(), sorted.end(), [](const LiveAllocation* a, const LiveAllocation* b)
+        {
+            if (a->pageIndex != b->pageIndex)
+                return a->pageIndex < b->pageIndex;
+            return a->allocation.offset < b->allocation.offset;
+        });
+        for (size_t i = 1; i < sorted.size(); ++i)
+        {
+            const LiveAllocation& prev = *sorted[i - 1];
+            const LiveAllocation& next = *sorted[i];
+            if (prev.pageIndex == next.pageIndex && prev.allocation.offset + prev.allocation.size > next.allocation.offset)
+            {
+                std::cerr << "allocations at " << prev.allocation.offset << " and " << next.allocation.offset << " in page "
+                    << next.pageIndex << " overlap" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    bool usage = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage = true;
+            break;
+        }
+
+        if (arg == "-class")
+            options.heapClass = argv[++i];
+        else if (arg == "-ops")
+            options.operationCount = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-live")
+            options.liveCount = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-page")
+            options.pageSize = (uint64)(std::stod(argv[++i]) * 1024 * 1024);
+        else if (arg == "-validate")
+            options.validateInterval = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-seed")
+            options.seed = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-csv")
+            options.csvPath = argv[++i];
+        else
+        {
+            usage = true;
+            break;
+        }
+    }
+    if (usage || options.liveCount == 0 || options.pageSize == 0 ||
+        (options.heapClass != "buffer" && options.heapClass != "texture" && options.heapClass != "rendertarget"))
+    {
+        std::cerr << "usage: AllocatorSim [-class buffer|texture|rendertarget] [-ops n] [-live n] [-page MB] [-validate n] [-seed n] [-csv stats.csv]" << std::endl;
+        return 1;
+    }
+
+    std::ofstream csv;
+    if (!options.csvPath.empty())
+    {
+        csv.open(options.csvPath, std::ios::trunc);
+        if (!csv)
+        {
+            std::cerr << options.csvPath << ": cannot write" << std::endl;
+            return 1;
+        }
+        csv << "operation,allocations,pages,used_bytes,free_bytes,largest_free_block,fragmentation\n";
+    }
+
+    PagedAllocator allocator(options.pageSize, GetGranularity(options.heapClass));
+    std::vector<LiveAllocation> liveAllocations;
+    std::mt19937 random(options.seed);
+    const uint32 sampleInterval = options.validateInterval != 0 ? options.validateInterval : 1000;
+
+    uint32 peakPageCount = 0;
+    uint64 peakTotalSize = 0;
+    double fragmentationSum = 0.0;
+    float maxFragmentation = 0.0f;
+    uint32 sampleCount = 0;
+    uint32 failedCount = 0;
+
+    for (uint32 op = 0; op < options.operationCount; ++op)
+    {
+        // 存活数量在liveCount的一半到一倍半之间缓慢摆动，模拟场景切换时大量加载和释放
+        const double phase = std::sin(op * 6.283185307 / (std::max)(options.operationCount / 4u, 1u));
+        const uint32 target = (uint32)(options.liveCount * (1.0 + 0.5 * phase));
+        const bool allocate = liveAllocations.empty() || (random() % 100) < (liveAllocations.size() < target ? 60u : 40u);
+        if (allocate)
+        {
+            uint64 size = 0, alignment = 0;
+            RandomRequest(options.heapClass, random, size, alignment);
+            LiveAllocation live = allocator.Allocate(size, alignment);
+            if (live.allocation.IsValid())
+                liveAllocations.push_back(live);
+            else
+                ++failedCount;
+        }
+        else
+        {
+            const size_t index = random() % liveAllocations.size();
+            allocator.Free(liveAllocations[index]);
+            liveAllocations[index] = liveAllocations.back();
+            liveAllocations.pop_back();
+            if (random() % 16 == 0)
+                allocator.ReleaseEmptyPages();
+        }
+
+        if ((op + 1) % sampleInterval == 0 || op + 1 == options.operationCount)
+        {
+            if (options.validateInterval != 0 && (!allocator.Validate() || !CheckAllocations(allocator, liveAllocations)))
+            {
+                std::cerr << "validation failed after " << op + 1 << " operations" << std::endl;
+                return 1;
+            }
+
+            uint32 pageCount = 0;
+            const TlsfAllocator::Stats stats = allocator.GetStats(pageCount);
+            peakPageCount = (std::max)(peakPageCount, pageCount);
+            peakTotalSize = (std::max)(peakTotalSize, stats.totalSize);
+            fragmentationSum += stats.Fragmentation();
+            maxFragmentation = (std::max)(maxFragmentation, stats.Fragmentation());
+            ++sampleCount;
+            if (csv.is_open())
+            {
+                csv << op + 1 << "," << stats.allocationCount << "," << pageCount << "," << stats.usedSize << "," << stats.freeSize << ","
+                    << stats.largestFreeBlock << "," << stats.Fragmentation() << "\n";
+            }
+        }
+    }
+
+    uint32 pageCount = 0;
+    const TlsfAllocator::Stats stats = allocator.GetStats(pageCount);
+    std::printf("%s: %u operations, about %u live allocations, %.1f MB pages\n", options.heapClass.c_str(), options.operationCount,
+        options.liveCount, options.pageSize / (1024.0 * 1024.0));
+    std::printf("pages: %u now, %u peak, %u created, %.1f MB peak heap size\n", pageCount, peakPageCount, allocator.GetCreatedPageCount(),
+        peakTotalSize / (1024.0 * 1024.0));
+    std::printf("now: %u allocations, %.1f MB requested, %.1f MB used, %.1f MB free, largest free block %.1f MB\n", stats.allocationCount,
+        stats.requestedSize / (1024.0 * 1024.0), stats.usedSize / (1024.0 * 1024.0), stats.freeSize / (1024.0 * 1024.0),
+        stats.largestFreeBlock / (1024.0 * 1024.0));
+    std::printf("fragmentation: %.3f now, %.3f average, %.3f max; alignment waste %.2f%%; %u failed allocations\n", stats.Fragmentation(),
+        sampleCount > 0 ? fragmentationSum / sampleCount : 0.0, maxFragmentation,
+        stats.usedSize > 0 ? (stats.usedSize - stats.requestedSize) * 100.0 / stats.usedSize : 0.0, failedCount);
+    std::printf("%s\n", options.validateInterval != 0 ? "validated" : "not validated");
+    return failedCount == 0 ? 0 : 1;
+}
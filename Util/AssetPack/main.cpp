@@ -0,0 +1,404 @@
+#include "../../Common/AssetArchive.h"
+#include "../../Common/LzCompression.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// 用法：AssetPack -o 输出.pak [-root 目录] [-store] [-chunk KB] [-align 字节] [-j 线程数] 文件...
+//       AssetPack -bench 输入.pak [-root 目录] [-j 线程数]
+// 打包：每个文件的名字为命令行中给出的相对于root的路径，运行时按同样的名字查找（见Common/AssetArchive.h）。-store表示不压缩。
+// -bench：比较同样的数据从散落的文件读取和从archive读取（包括解压）的速度，每个文件或entry读取一次，多个线程同时读取。
+// 两种方式都绕过系统的文件缓存，相当于冷启动时第一次读取：Windows上使用FILE_FLAG_NO_BUFFERING，其他平台读取前用posix_fadvise丢弃缓存。
+// 读取的数据拷贝或者解压到每个线程自己的buffer中，代替加载时的staging buffer
+
+namespace
+{
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    const uint64 SectorAlignment = 4096;
+
+    inline uint64 AlignDown(uint64 value, uint64 alignment) { return value / alignment * alignment; }
+    inline uint64 AlignUp(uint64 value, uint64 alignment) { return (value + alignment - 1) / alignment * alignment; }
+
+    // 无缓冲读取要求地址按扇区对齐
+    class AlignedBuffer
+    {
+    public:
+        char* Reserve(std::size_t size)
+        {
+            m_storage.resize(size + SectorAlignment);
+            return reinterpret_cast<char*>(AlignUp(reinterpret_cast<std::uintptr_t>(m_storage.data()), SectorAlignment));
+        }
+
+    private:
+        std::vector<char> m_storage;
+    };
+
+    // 不经过系统文件缓存的只读文件
+    class UncachedFile
+    {
+    public:
+        UncachedFile() = default;
+        UncachedFile(const UncachedFile&) = delete;
+        UncachedFile& operator=(const UncachedFile&) = delete;
+        ~UncachedFile() { Close(); }
+
+        bool Open(const std::string& path)
+        {
+            Close();
+#ifdef _WIN32
+            m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                FILE_FLAG_NO_BUFFERING | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            LARGE_INTEGER size;
+            if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &size))
+            {
+                Close();
+                return false;
+            }
+            m_size = (uint64)size.QuadPart;
+#else
+            m_file = open(path.c_str(), O_RDONLY);
+            struct stat info;
+            if (m_file < 0 || fstat(m_file, &info) != 0)
+            {
+                Close();
+                return false;
+            }
+            m_size = (uint64)info.st_size;
+            posix_fadvise(m_file, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+            return true;
+        }
+
+        void Close()
+        {
+#ifdef _WIN32
+            if (m_file != INVALID_HANDLE_VALUE)
+                CloseHandle(m_file);
+            m_file = INVALID_HANDLE_VALUE;
+#else
+            if (m_file >= 0)
+                close(m_file);
+            m_file = -1;
+#endif
+            m_size = 0;
+        }
+
+        uint64 GetSize()const { return m_size; }
+
+        // 读取范围向外扩展到扇区边界，data为[offset, offset + size)在buffer中的位置，返回实际从磁盘读取的字节数，失败时返回0
+        uint64 Read(uint64 offset, std::size_t size, AlignedBuffer& buffer, const char*& data)
+        {
+            if (offset > m_size || size > m_size - offset)
+                return 0;
+            const uint64 begin = AlignDown(offset, SectorAlignment);
+            const uint64 end = AlignUp(offset + size, SectorAlignment);
+            char* dest = buffer.Reserve((std::size_t)(end - begin));
+            uint64 done = 0;
+            while (begin + done < (std::min)(end, m_size))
+            {
+                const uint64 count = (std::min)(end - begin - done, (uint64)1 << 30);
+#ifdef _WIN32
+                OVERLAPPED overlapped = {};
+                overlapped.Offset = (DWORD)(begin + done);
+                overlapped.OffsetHigh = (DWORD)((begin + done) >> 32);
+                DWORD read = 0;
+                if (!ReadFile(m_file, dest + done, (DWORD)count, &read, &overlapped) || read == 0)
+                    return 0;
+#else
+                const ssize_t read = pread(m_file, dest + done, (std::size_t)count, (off_t)(begin + done));
+                if (read <= 0)
+                    return 0;
+#endif
+                done += (uint64)read;
+            }
+            data = dest + (offset - begin);
+            return done;
+        }
+
+    private:
+#ifdef _WIN32
+        HANDLE m_file = INVALID_HANDLE_VALUE;
+#else
+        int m_file = -1;
+#endif
+        uint64 m_size = 0;
+    };
+
+    struct BenchResult
+    {
+        uint64 diskBytes = 0;       // 从磁盘读取的字节数，包括扇区对齐
+        uint64 dataBytes = 0;       // 得到的原始数据
+        uint32 failures = 0;
+        double seconds = 0.0;
+    };
+
+    // 在threadCount个线程中对0到count - 1调用job
+    template<typename Job>
+    void RunParallel(std::size_t count, uint32 threadCount, Job job)
+    {
+        std::atomic<std::size_t> next(0);
+        auto worker = [&]()
+        {
+            for (std::size_t index = next++; index < count; index = next++)
+                job(index);
+        };
+        std::vector<std::thread> threads;
+        for (uint32 i = 1; i < threadCount; ++i)
+            threads.emplace_back(worker);
+        worker();
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    int Pack(const std::string& outputPath, const std::string& root, const std::vector<std::string>& names,
+        const AssetArchiveWriteOptions& options)
+    {
+        AssetArchiveWriter writer;
+        uint64 inputSize = 0;
+        for (const std::string& name : names)
+        {
+            const std::string path = root.empty() ? name : root + "/" + name;
+            std::ifstream fin(path, std::ios::binary);
+            if (!fin)
+            {
+                std::cerr << path << ": cannot read" << std::endl;
+                return 1;
+            }
+            std::vector<char> data((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+            inputSize += data.size();
+            writer.Add(name, std::move(data));
+        }
+
+        {
+            std::ofstream fout(outputPath, std::ios::binary | std::ios::trunc);
+            if (!fout || !writer.Write(fout, options))
+            {
+                std::cerr << outputPath << ": cannot write" << std::endl;
+                return 1;
+            }
+        }
+
+        // 重新打开检查格式，并列出每个entry压缩后的大小
+        AssetArchive archive;
+        if (!archive.Open(outputPath))
+        {
+            std::cerr << outputPath << ": written archive is invalid" << std::endl;
+            return 1;
+        }
+        for (std::size_t i = 0; i < archive.EntryCount(); ++i)
+        {
+            const AssetArchiveEntry& entry = archive.GetEntries()[i];
+            uint64 storedSize = 0;
+            uint32 compressedChunks = 0;
+            for (uint32 j = 0; j < entry.chunkCount; ++j)
+            {
+                storedSize += archive.GetChunk(entry, j).storedSize;
+                compressedChunks += archive.GetStoredChunk(entry, j) == nullptr ? 1 : 0;
+            }
+            std::printf("%s: %llu -> %llu bytes, %u/%u chunks compressed\n", archive.GetName(entry).c_str(),
+                (unsigned long long)entry.size, (unsigned long long)storedSize, compressedChunks, entry.chunkCount);
+        }
+        std::ifstream packed(outputPath, std::ios::binary | std::ios::ate);
+        std::printf("%zu files, %llu -> %llu bytes\n", names.size(), (unsigned long long)inputSize, (unsigned long long)packed.tellg());
+        return 0;
+    }
+
+    int Bench(const std::string& archivePath, const std::string& root, uint32 threadCount)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // 目录很小，打开archive的时间单独统计
+        Clock::time_point start = Clock::now();
+        AssetArchive archive;
+        UncachedFile archiveFile;
+        if (!archive.Open(archivePath) || !archiveFile.Open(archivePath))
+        {
+            std::cerr << archivePath << ": cannot open, or the format is invalid" << std::endl;
+            return 1;
+        }
+        const double openSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        const std::size_t count = archive.EntryCount();
+        std::vector<std::string> names(count);
+        uint64 largest = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            names[i] = archive.GetName(archive.GetEntries()[i]);
+            largest = (std::max)(largest, archive.GetEntries()[i].size);
+        }
+
+        // 散落的文件：每个文件一次打开、读取、拷贝
+        BenchResult loose;
+        {
+            std::atomic<uint64> diskBytes(0), dataBytes(0);
+            std::atomic<uint32> failures(0);
+            start = Clock::now();
+            RunParallel(count, threadCount, [&](std::size_t index)
+            {
+                thread_local AlignedBuffer buffer;
+                thread_local std::vector<char> upload;
+                UncachedFile file;
+                const char* data = nullptr;
+                const std::string path = root.empty() ? names[index] : root + "/" + names[index];
+                const uint64 read = file.Open(path) ? file.Read(0, (std::size_t)file.GetSize(), buffer, data) : 0;
+                if (read == 0 && file.GetSize() != 0)
+                {
+                    ++failures;
+                    return;
+                }
+                upload.resize((std::size_t)file.GetSize());
+                if (!upload.empty())
+                    memcpy(upload.data(), data, upload.size());
+                diskBytes += read;
+                dataBytes += file.GetSize();
+            });
+            loose.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            loose.diskBytes = diskBytes;
+            loose.dataBytes = dataBytes;
+            loose.failures = failures;
+        }
+
+        // archive：读取entry压缩后的数据，按chunk解压
+        BenchResult packed;
+        {
+            std::atomic<uint64> diskBytes(0), dataBytes(0);
+            std::atomic<uint32> failures(0);
+            start = Clock::now();
+            RunParallel(count, threadCount, [&](std::size_t index)
+            {
+                thread_local AlignedBuffer buffer;
+                thread_local std::vector<char> upload;
+                const AssetArchiveEntry& entry = archive.GetEntries()[index];
+                upload.resize((std::size_t)entry.size);
+                if (entry.chunkCount == 0)
+                    return;
+
+                const AssetArchiveChunk& first = archive.GetChunk(entry, 0);
+                const AssetArchiveChunk& last = archive.GetChunk(entry, entry.chunkCount - 1);
+                const char* data = nullptr;
+                const uint64 read = archiveFile.Read(first.offset, (std::size_t)(last.offset + last.storedSize - first.offset), buffer, data);
+                bool ok = read != 0;
+                for (uint32 i = 0; i < entry.chunkCount && ok; ++i)
+                {
+                    const AssetArchiveChunk& chunk = archive.GetChunk(entry, i);
+                    const std::size_t size = archive.GetChunkDataSize(entry, i);
+                    char* dest = upload.data() + (std::size_t)i * archive.GetChunkSize();
+                    const char* source = data + (chunk.offset - first.offset);
+                    if (chunk.storedSize == size)
+                        memcpy(dest, source, size);
+                    else
+                        ok = LzDecompress(source, chunk.storedSize, dest, size);
+                }
+                if (!ok)
+                {
+                    ++failures;
+                    return;
+                }
+                diskBytes += read;
+                dataBytes += entry.size;
+            });
+            packed.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            packed.diskBytes = diskBytes;
+            packed.dataBytes = dataBytes;
+            packed.failures = failures;
+        }
+
+        // 计时之外再检查两种方式得到的数据是否一致
+        uint32 mismatches = 0;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const AssetArchiveEntry& entry = archive.GetEntries()[i];
+            std::vector<char> unpacked((std::size_t)entry.size);
+            std::ifstream fin(root.empty() ? names[i] : root + "/" + names[i], std::ios::binary);
+            std::vector<char> original((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+            if (!archive.Read(entry, unpacked.data()) || unpacked != original)
+            {
+                std::cerr << names[i] << ": archive content differs from the file" << std::endl;
+                ++mismatches;
+            }
+        }
+
+        auto print = [](const char* name, const BenchResult& result, uint32 fileCount)
+        {
+            std::printf("%-8s %u opens, %.2f MB read, %.2f MB data, %.2f ms, %.1f MB/s", name, fileCount, result.diskBytes / 1e6,
+                result.dataBytes / 1e6, result.seconds * 1e3, result.dataBytes / 1e6 / (std::max)(result.seconds, 1e-9));
+            if (result.failures > 0)
+                std::printf(", %u failed", result.failures);
+            std::printf("\n");
+        };
+        std::printf("%zu entries, largest %llu bytes, %u threads, archive opened in %.2f ms\n", count, (unsigned long long)largest,
+            threadCount, openSeconds * 1e3);
+        print("loose", loose, (uint32)count);
+        print("archive", packed, 1);
+        if (loose.seconds > 0.0 && packed.seconds > 0.0)
+            std::printf("archive / loose throughput: %.2fx\n", loose.seconds / packed.seconds);
+        return loose.failures == 0 && packed.failures == 0 && mismatches == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    AssetArchiveWriteOptions options;
+    std::string outputPath;
+    std::string benchPath;
+    std::string root;
+    std::vector<std::string> names;
+    bool valid = true;
+    for (int i = 1; i < argc && valid; ++i)
+    {
+        std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "-o" && hasValue)
+            outputPath = argv[++i];
+        else if (arg == "-bench" && hasValue)
+            benchPath = argv[++i];
+        else if (arg == "-root" && hasValue)
+            root = argv[++i];
+        else if (arg == "-store")
+            options.compress = false;
+        else if (arg == "-chunk" && hasValue)
+            options.chunkSize = (uint32)std::stoul(argv[++i]) * 1024;
+        else if (arg == "-align" && hasValue)
+            options.dataAlignment = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-j" && hasValue)
+            options.threadCount = (uint32)std::stoul(argv[++i]);
+        else if (!arg.empty() && arg[0] != '-')
+            names.push_back(arg);
+        else
+            valid = false;
+    }
+
+    if (valid && !benchPath.empty() && outputPath.empty() && names.empty())
+    {
+        uint32 threadCount = options.threadCount != 0 ? options.threadCount : std::thread::hardware_concurrency();
+        return Bench(benchPath, root, (std::max)(threadCount, (uint32)1));
+    }
+    if (!valid || outputPath.empty() || names.empty() || options.chunkSize == 0 || options.dataAlignment == 0)
+    {
+        std::cerr << "usage: AssetPack -o output.pak [-root dir] [-store] [-chunk KB] [-align bytes] [-j threads] files...\n"
+            "       AssetPack -bench input.pak [-root dir] [-j threads]" << std::endl;
+        return 1;
+    }
+    return Pack(outputPath, root, names, options);
+}
@@ -0,0 +1,5 @@
+::用ShaderBuilder编译ShaderBuildList.txt中的所有shader，只重新编译源文件（包括#include的文件）或编译选项有变化的部分
+::加上-release参数时同时编译_release后缀的优化版本，需要先编译Util/ShaderBuilder/ShaderBuilder.sln
+@echo off
+"%~dp0ShaderBuilder\x64\Release\ShaderBuilder.exe" "%~dp0ShaderBuildList.txt" %*
+pause
\ No newline at end of file
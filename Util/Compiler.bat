@@ -1,11 +1,17 @@
 ::根据shade的输入路径，将VSMain和PSMain编译到其所在的目录下
+::可选的第二个参数为宏名，会以/D 宏名=1编译，输出的文件名加上第三个参数作为后缀，例如 Compiler.bat shaders.hlsl BINDLESS _bindless
+::可选的第四个参数为shader model，默认为5_0
+::不会pause，由调用的脚本（各demo的CompileShader.bat）用call调用后pause
 @echo off
 set hlslFilePath=%1
 set hlslFileFolderPath=%~dp1
-set hlslFileName=%~n1
+set hlslFileName=%~n1%3
+set defines=
+if not "%2"=="" set defines=/D %2=1
+set shaderModel=5_0
+if not "%4"=="" set shaderModel=%4
 set vsFilePath=%hlslFileFolderPath%%hlslFileName%_vs.cso
 set psFilePath=%hlslFileFolderPath%%hlslFileName%_ps.cso
 ::fxc工具的路径自行修改
-"C:\Program Files (x86)\Windows Kits\10\bin\10.0.19041.0\x64\fxc.exe" %hlslFilePath% /Od /Zi /T vs_5_0 /E "VSMain" /Fo %vsFilePath%
-"C:\Program Files (x86)\Windows Kits\10\bin\10.0.19041.0\x64\fxc.exe" %hlslFilePath% /Od /Zi /T ps_5_0 /E "PSMain" /Fo %psFilePath%
-pause
\ No newline at end of file
+"C:\Program Files (x86)\Windows Kits\10\bin\10.0.19041.0\x64\fxc.exe" %hlslFilePath% %defines% /Od /Zi /T vs_%shaderModel% /E "VSMain" /Fo %vsFilePath%
+"C:\Program Files (x86)\Windows Kits\10\bin\10.0.19041.0\x64\fxc.exe" %hlslFilePath% %defines% /Od /Zi /T ps_%shaderModel% /E "PSMain" /Fo %psFilePath%
\ No newline at end of file
@@ -0,0 +1,6 @@
+::根据编译好的cso生成TextureMapping/ShaderLayout.h，C++中用static_assert检查常量缓冲的布局与shader一致
+::修改shader中的cbuffer并重新编译后运行，需要先编译Util/ShaderReflect/ShaderReflect.sln（也可以在Linux上用g++编译main.cpp和Common/ShaderReflection.cpp）
+@echo off
+cd /d "%~dp0..\TextureMapping"
+"%~dp0ShaderReflect\x64\Release\ShaderReflect.exe" -header ShaderLayout.h -namespace TextureMappingShaderLayout shaders_vs.cso shaders_ps.cso
+pause
\ No newline at end of file
@@ -0,0 +1,309 @@
+#include "../../Common/IndexAllocator.h"
+#include "../TestUtil.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// 用法：IndexAllocatorTest [-ops 随机操作次数] [-seed 随机种子]
+// 用假的descriptor heap（每个位置记录写入它的对象）检查IndexAllocator.h中的三个分配器，不需要GPU：
+//   FreeListIndexAllocator 释放的下标被复用，使用中的区间互不重叠，相邻的空闲区间合并
+//   RingIndexAllocator     尾部放不下时从0开始，fence完成之前不会复用这一帧分配的下标
+//   BindlessSlotTable      空位优先复用，Compact按返回的Move搬移数据后[0, Count())中没有空位且每个元素仍能找到
+// 先运行固定的用例，再用随机序列对比假heap中的内容。
+
+namespace
+{
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    const uint32 Empty = 0xffffffff;
+
+    bool TestFreeList()
+    {
+        bool passed = true;
+        FreeListIndexAllocator allocator(16);
+
+        const uint32 a = allocator.Allocate(4);
+        const uint32 b = allocator.Allocate(4);
+        const uint32 c = allocator.Allocate(4);
+        passed &= Check(a == 0 && b == 4 && c == 8, "free list allocates first fit from the start");
+
+        allocator.Free(b, 4);
+        passed &= Check(allocator.Allocate(3) == 4, "free list reuses a freed range");
+        passed &= Check(allocator.Allocate(2) == 12, "free list skips a range that is too small");
+        passed &= Check(allocator.FreeRangeCount() == 2 && allocator.FreeCount() == 3, "free list keeps the remaining pieces");
+
+        allocator.Free(a, 4);
+        allocator.Free(c, 4);
+        passed &= Check(allocator.FreeRangeCount() == 3, "non-adjacent ranges stay separate");
+        allocator.Free(4, 3);
+        allocator.Free(12, 2);
+        passed &= Check(allocator.FreeRangeCount() == 1 && allocator.LargestFreeRange() == 16, "adjacent free ranges merge");
+        passed &= Check(allocator.Allocate(17) == FreeListIndexAllocator::InvalidIndex, "free list fails when out of space");
+        passed &= Check(allocator.Validate(), "free list validates");
+        return passed;
+    }
+
+    bool TestRing()
+    {
+        bool passed = true;
+        RingIndexAllocator ring(10);
+
+        passed &= Check(ring.Allocate(4) == 0, "ring starts at 0");
+        passed &= Check(ring.Allocate(4) == 4, "ring allocates after the previous allocation");
+        ring.RetireSubmitted(1);
+        passed &= Check(ring.Allocate(3) == RingIndexAllocator::InvalidIndex, "ring does not wrap over an unfinished frame");
+
+        ring.ReleaseCompleted(0);
+        passed &= Check(ring.Allocate(3) == RingIndexAllocator::InvalidIndex, "ring keeps the frame until its fence completes");
+
+        ring.ReleaseCompleted(1);
+        passed &= Check(ring.UsedCount() == 0, "ring releases the frame at its fence");
+        passed &= Check(ring.Allocate(3) == 0, "ring restarts at 0 when empty");
+
+        passed &= Check(ring.Allocate(5) == 3, "ring allocates up to the end");
+        ring.RetireSubmitted(2);
+        ring.ReleaseCompleted(2);
+        passed &= Check(ring.Allocate(1) == 0, "ring restarts after releasing everything");
+        passed &= Check(ring.Allocate(6) == 1, "ring allocates in the middle");
+        ring.RetireSubmitted(3);
+        passed &= Check(ring.Allocate(2) == 7, "ring fills the tail");
+        ring.RetireSubmitted(4);
+        // 尾部只剩1个，跳过后从0开始，但0到6还属于没有完成的帧3
+        passed &= Check(ring.Allocate(2) == RingIndexAllocator::InvalidIndex, "ring does not wrap onto an unfinished frame");
+        ring.ReleaseCompleted(3);
+        passed &= Check(ring.Allocate(4) == 0, "ring wraps around to 0");
+        passed &= Check(ring.UsedCount() == 2 + 1 + 4, "ring counts the skipped tail as used");
+        return passed;
+    }
+
+    bool TestBindless()
+    {
+        bool passed = true;
+        BindlessSlotTable table(8);
+
+        for (uint32 i = 0; i < 5; ++i)
+            passed &= Check(table.Add() == i, "bindless adds in order");
+        table.Remove(1);
+        table.Remove(3);
+        passed &= Check(table.Count() == 5 && table.LiveCount() == 3, "removing from the middle leaves holes");
+        passed &= Check(table.Add() == 1, "bindless reuses the lowest hole");
+
+        table.Remove(4);
+        passed &= Check(table.Count() == 3, "removing the last slot shrinks past the holes before it");
+        passed &= Check(table.Add() == 3, "a hole past the end is not reused twice");
+        passed &= Check(table.Add() == 4, "bindless grows after the holes are used");
+
+        table.Remove(0);
+        table.Remove(2);
+        const std::vector<BindlessSlotTable::Move> moves = table.Compact();
+        passed &= Check(moves.size() == 2 && moves[0].from == 4 && moves[0].to == 0 && moves[1].from == 3 && moves[1].to == 2,
+            "compact moves the last elements into the first holes");
+        passed &= Check(table.Count() == 3 && table.LiveCount() == 3, "compact leaves no holes");
+        passed &= Check(table.Add() == 3, "bindless appends after compact");
+        return passed;
+    }
+
+    // 随机分配和释放，假heap中每个位置记录占用它的分配的编号
+    bool FuzzFreeList(uint32 operationCount, std::mt19937& random)
+    {
+        struct Live { uint32 start, count, id; };
+        const uint32 capacity = 1024;
+        FreeListIndexAllocator allocator(capacity);
+        std::vector<uint32> heap(capacity, Empty);
+        std::vector<Live> live;
+        uint32 nextId = 0;
+
+        for (uint32 op = 0; op < operationCount; ++op)
+        {
+            if (live.empty() || random() % 2 == 0)
+            {
+                const uint32 count = 1 + random() % 32;
+                const uint32 start = allocator.Allocate(count);
+                if (start == FreeListIndexAllocator::InvalidIndex)
+                {
+                    // 只有没有足够大的连续空间时才能失败
+                    if (!Check(allocator.LargestFreeRange() < count, "free list fails only without a large enough range"))
+                        return false;
+                    continue;
+                }
+                for (uint32 i = start; i < start + count; ++i)
+                {
+                    if (!Check(i < capacity && heap[i] == Empty, "free list hands out an index that is still in use"))
+                        return false;
+                    heap[i] = nextId;
+                }
+                live.push_back({ start, count, nextId++ });
+            }
+            else
+            {
+                const size_t index = random() % live.size();
+                const Live freed = live[index];
+                for (uint32 i = freed.start; i < freed.start + freed.count; ++i)
+                {
+                    if (!Check(heap[i] == freed.id, "free list allocation was overwritten"))
+                        return false;
+                    heap[i] = Empty;
+                }
+                allocator.Free(freed.start, freed.count);
+                live[index] = live.back();
+                live.pop_back();
+            }
+
+            const uint32 emptyCount = (uint32)std::count(heap.begin(), heap.end(), Empty);
+            if (!Check(allocator.Validate() && allocator.FreeCount() == emptyCount, "free list free count matches the fake heap"))
+                return false;
+        }
+        return true;
+    }
+
+    // 每帧分配若干次，GPU落后几帧；分配到的位置上不能有fence还没完成的帧写入的内容
+    bool FuzzRing(uint32 operationCount, std::mt19937& random)
+    {
+        const uint32 capacity = 1000;
+        RingIndexAllocator ring(capacity);
+        std::vector<uint64> heap(capacity, 0);      // 写入这个位置的帧，0为没有写过
+        uint64 frame = 1;
+        uint64 completed = 0;
+        uint32 wrapCount = 0;
+        uint32 lastStart = 0;
+
+        for (uint32 op = 0; op < operationCount; ++op)
+        {
+            const uint32 count = 1 + random() % 64;
+            const uint32 start = ring.Allocate(count);
+            if (start != RingIndexAllocator::InvalidIndex)
+            {
+                if (start < lastStart)
+                    ++wrapCount;
+                lastStart = start;
+                for (uint32 i = start; i < start + count; ++i)
+                {
+                    if (!Check(i < capacity && heap[i] <= completed, "ring reuses an index before its fence completes"))
+                        return false;
+                    heap[i] = frame;
+                }
+            }
+
+            // 分配失败或者随机结束这一帧，GPU完成的帧落后0到3帧
+            if (start == RingIndexAllocator::InvalidIndex || random() % 4 == 0)
+            {
+                ring.RetireSubmitted(frame);
+                ++frame;
+                const uint64 lag = random() % 4;
+                completed = (std::max)(completed, frame > lag + 1 ? frame - 1 - lag : 0);
+                ring.ReleaseCompleted(completed);
+            }
+        }
+        return Check(wrapCount > 0, "ring wrapped around during the fuzz");
+    }
+
+    // 假的bindless数组中保存元素编号，Compact后按Move搬移，检查每个元素记录的槽位
+    bool FuzzBindless(uint32 operationCount, std::mt19937& random)
+    {
+        const uint32 capacity = 256;
+        BindlessSlotTable table(capacity);
+        std::vector<uint32> heap(capacity, Empty);
+        std::vector<uint32> slotOf;                 // 元素编号 -> 槽位，Empty为已删除
+        std::vector<uint32> live;
+        uint32 moveCount = 0;
+
+        for (uint32 op = 0; op < operationCount; ++op)
+        {
+            const uint32 action = random() % 16;
+            if (action == 0)
+            {
+                for (auto& move : table.Compact())
+                {
+                    if (!Check(heap[move.from] != Empty && heap[move.to] == Empty, "compact moves a live element into a hole"))
+                        return false;
+                    heap[move.to] = heap[move.from];
+                    heap[move.from] = Empty;
+                    slotOf[heap[move.to]] = move.to;
+                    ++moveCount;
+                }
+                if (!Check(table.Count() == table.LiveCount(), "compact leaves no holes"))
+                    return false;
+            }
+            else if (live.empty() || action < 9)
+            {
+                const uint32 slot = table.Add();
+                if (slot == BindlessSlotTable::InvalidIndex)
+                {
+                    if (!Check(table.LiveCount() == capacity, "bindless fails only when full"))
+                        return false;
+                    continue;
+                }
+                if (!Check(slot < capacity && heap[slot] == Empty, "bindless hands out a slot that is still in use"))
+                    return false;
+
+                // 返回的应该是下标最小的空位
+                const uint32 lowest = (uint32)(std::find(heap.begin(), heap.end(), Empty) - heap.begin());
+                if (!Check(slot == lowest, "bindless reuses the lowest hole"))
+                    return false;
+
+                heap[slot] = (uint32)slotOf.size();
+                live.push_back((uint32)slotOf.size());
+                slotOf.push_back(slot);
+            }
+            else
+            {
+                const size_t index = random() % live.size();
+                const uint32 id = live[index];
+                table.Remove(slotOf[id]);
+                heap[slotOf[id]] = Empty;
+                slotOf[id] = Empty;
+                live[index] = live.back();
+                live.pop_back();
+            }
+
+            uint32 count = 0;
+            for (uint32 i = 0; i < capacity; ++i)
+            {
+                if (heap[i] != Empty)
+                    count = i + 1;
+            }
+            if (!Check(table.Count() == count && table.LiveCount() == live.size(), "bindless count matches the fake heap"))
+                return false;
+            for (uint32 id : live)
+            {
+                if (!Check(table.IsLive(slotOf[id]) && heap[slotOf[id]] == id, "every element is found at its slot"))
+                    return false;
+            }
+        }
+        return Check(moveCount > 0, "compact moved elements during the fuzz");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32 operationCount = 100000;
+    uint32 seed = 1;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-ops" && i + 1 < argc)
+            operationCount = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-seed" && i + 1 < argc)
+            seed = (uint32)std::stoul(argv[++i]);
+        else
+        {
+            std::cerr << "usage: IndexAllocatorTest [-ops n] [-seed n]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::mt19937 random(seed);
+    bool passed = true;
+    passed &= TestFreeList();
+    passed &= TestRing();
+    passed &= TestBindless();
+    passed &= FuzzFreeList(operationCount, random);
+    passed &= FuzzRing(operationCount, random);
+    passed &= FuzzBindless(operationCount, random);
+    std::printf("%u random operations per allocator, seed %u\n", operationCount, seed);
+    return ReportResult(passed);
+}
@@ -0,0 +1,167 @@
+#include "../../Common/ShaderArchive.h"
+#include "../../Common/ShaderPermutation.h"
+#include "../../LocalLit/LightPermutations.h"
+#include "../ShaderBuilder/ShaderBuild.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// 用法：LightPermutations -list [LocalLit目录]
+//       LightPermutations -pack [-release] [LocalLit目录]
+// -list：把LocalLit所有光源数量组合的shader写成ShaderBuilder的任务列表permutations/jobs.txt，cso也输出到permutations目录中。
+// -pack：把ShaderBuilder编译出的cso按布局打包为LocalLit目录下的archive（见LocalLit/LightPermutations.h），
+//        key为宏定义、target和编译选项的哈希，与LocalLit.cpp运行时查找的一致。-release时同时打包_release后缀的/O3版本。
+// 一般通过LocalLit/BuildShaderArchive.bat运行
+
+namespace
+{
+    const char* JobListName = "permutations/jobs.txt";
+
+    struct PermutationJob
+    {
+        const LocalLitPermutations::Layout* layout;
+        ShaderStage stage;
+        std::vector<ShaderDefine> defines;
+        ShaderCompileJob job;                   // 路径相对于任务列表所在的目录
+    };
+
+    std::vector<PermutationJob> MakeJobs()
+    {
+        std::vector<PermutationJob> jobs;
+        const LightPermutationSet permutations = LocalLitPermutations::MakePermutationSet();
+        for (auto& layout : LocalLitPermutations::Layouts)
+        {
+            for (auto& counts : permutations.GetPermutations())
+            {
+                for (auto& stage : LocalLitPermutations::Stages)
+                {
+                    PermutationJob permutation;
+                    permutation.layout = &layout;
+                    permutation.stage = stage.stage;
+                    permutation.defines = LocalLitPermutations::GetDefines(layout, counts);
+                    permutation.job.source = "../shaders.hlsl";
+                    permutation.job.entryPoint = stage.entryPoint;
+                    permutation.job.target = stage.target;
+                    permutation.job.flags = ShaderDebugFlags;
+                    permutation.job.output = std::string(layout.outputPrefix) + "_" + std::to_string(counts.directCount) + "_" +
+                        std::to_string(counts.pointCount) + "_" + std::to_string(counts.spotCount) + "_" + stage.suffix + ".cso";
+                    for (auto& define : permutation.defines)
+                        permutation.job.defines.push_back(define.name + "=" + define.value);
+                    jobs.push_back(permutation);
+                }
+            }
+        }
+        return jobs;
+    }
+
+    bool WriteJobList(const std::string& path, const std::vector<PermutationJob>& jobs)
+    {
+        std::ofstream fout(path, std::ios::trunc);
+        if (!fout)
+            return false;
+        fout << "# 由LightPermutations -list生成，不要手动修改" << std::endl;
+        for (auto& permutation : jobs)
+        {
+            const ShaderCompileJob& job = permutation.job;
+            fout << job.source << " " << job.entryPoint << " " << job.target << " " << job.output;
+            for (auto& define : job.defines)
+                fout << " " << define;
+            fout << std::endl;
+        }
+        return (bool)fout;
+    }
+
+    bool Pack(const std::string& directory, const std::vector<PermutationJob>& jobs, bool release)
+    {
+        std::vector<PermutationJob> packJobs = jobs;
+        if (release)
+        {
+            std::vector<ShaderCompileJob> compileJobs;
+            for (auto& permutation : jobs)
+                compileJobs.push_back(permutation.job);
+            std::vector<ShaderCompileJob> releaseJobs = MakeReleaseJobs(compileJobs, ShaderReleaseFlags);
+            for (std::size_t i = 0; i < jobs.size(); ++i)
+            {
+                packJobs.push_back(jobs[i]);
+                packJobs.back().job = releaseJobs[i];
+            }
+        }
+
+        for (auto& layout : LocalLitPermutations::Layouts)
+        {
+            ShaderArchiveWriter writer;
+            std::size_t totalSize = 0;
+            for (auto& permutation : packJobs)
+            {
+                if (permutation.layout != &layout)
+                    continue;
+
+                const std::string path = directory + "/permutations/" + permutation.job.output;
+                std::ifstream fin(path, std::ios::binary);
+                if (!fin)
+                {
+                    std::cerr << path << ": not found, run ShaderBuilder on " << JobListName << (release ? " with -release" : "") << std::endl;
+                    return false;
+                }
+                std::vector<char> data((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+
+                const std::uint64_t key = HashShaderPermutation(permutation.defines, permutation.job.target, permutation.job.flags);
+                writer.Add(key, permutation.stage, data.data(), data.size());
+                totalSize += data.size();
+            }
+
+            const std::string archivePath = directory + "/" + layout.archiveName;
+            std::ofstream fout(archivePath, std::ios::binary | std::ios::trunc);
+            if (!fout || !writer.Write(fout))
+            {
+                std::cerr << archivePath << ": cannot write" << std::endl;
+                return false;
+            }
+            std::cout << layout.archiveName << ": " << writer.EntryCount() << " shaders, " << writer.BlobCount() << " unique, "
+                << totalSize << " bytes of cso" << std::endl;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string mode;
+    std::string directory = ".";
+    bool release = false;
+    bool usage = argc < 2;
+    for (int i = 1; i < argc && !usage; ++i)
+    {
+        std::string arg = argv[i];
+        if ((arg == "-list" || arg == "-pack") && mode.empty())
+            mode = arg;
+        else if (arg == "-release")
+            release = true;
+        else if (!arg.empty() && arg[0] != '-')
+            directory = arg;
+        else
+            usage = true;
+    }
+    if (usage || mode.empty())
+    {
+        std::cerr << "usage: LightPermutations -list [LocalLit directory]" << std::endl;
+        std::cerr << "       LightPermutations -pack [-release] [LocalLit directory]" << std::endl;
+        return 1;
+    }
+
+    const std::vector<PermutationJob> jobs = MakeJobs();
+    if (mode == "-list")
+    {
+        const std::string path = directory + "/" + JobListName;
+        if (!WriteJobList(path, jobs))
+        {
+            std::cerr << path << ": cannot write" << std::endl;
+            return 1;
+        }
+        std::cout << path << ": " << jobs.size() << " jobs" << std::endl;
+        return 0;
+    }
+    return Pack(directory, jobs, release) ? 0 : 1;
+}
@@ -0,0 +1,11 @@
+::把Textures下的dds（包括TexturePack打包后的Textures/Packed）打包为Assets.pak，TextureMapping启动时找到这个文件就从中读取texture，修改texture后需要再运行一次
+::需要先编译Util/AssetPack/AssetPack.sln；加上-bench参数时打包后再比较从散落的文件和从archive读取的速度
+@echo off
+setlocal enabledelayedexpansion
+set packer="%~dp0AssetPack\x64\Release\AssetPack.exe"
+cd /d "%~dp0.."
+set files=
+for %%f in (Textures\*.dds Textures\Packed\*.dds) do set files=!files! %%f
+%packer% -o Assets.pak%files%
+if "%1"=="-bench" %packer% -bench Assets.pak
+pause
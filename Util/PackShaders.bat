@@ -0,0 +1,11 @@
+::把各个demo的cso去掉调试信息后打包为shaders.shaderpack，demo启动时只打开这一个文件并映射到内存中，重新编译shader后需要再运行一次
+::需要先编译Util/ShaderPack/ShaderPack.sln，没有编译的可选版本（例如TextureMapping的bindless版本）会被跳过
+@echo off
+set packer="%~dp0ShaderPack\x64\Release\ShaderPack.exe"
+cd /d "%~dp0..\HelloDirect3D12"
+%packer% shaders.shaderpack shaders_vs.cso shaders_ps.cso
+cd /d "%~dp0..\DrawGeometries"
+%packer% shaders.shaderpack shaders_vs.cso shaders_ps.cso
+cd /d "%~dp0..\TextureMapping"
+%packer% shaders.shaderpack shaders_vs.cso shaders_ps.cso shaders_bindless_vs.cso shaders_bindless_ps.cso
+pause
\ No newline at end of file
@@ -0,0 +1,272 @@
+#include "../../Common/PipelineCache.h"
+#include "../TestUtil.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <future>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 用法：PipelineCacheTest [-threads 请求线程数] [-pipelines 每个线程请求的pipeline数量]
+// 用整数代替PSO检查PipelineCache，不需要GPU：
+// 同一个哈希只编译一次（包括多个线程同时Request），Get在调用线程中编译还在队列中的任务而不等待前面的任务，
+// 编译时抛出的异常在每次Get时重新抛出，析构时丢弃还没开始的任务。
+// PipelineStateCache只是把D3D12的PSO描述换成哈希后交给PipelineCache，这里不创建D3D12设备。
+
+namespace
+{
+    using Cache = PipelineCache<int>;
+    using uint64 = Cache::uint64;
+
+    const auto Timeout = std::chrono::seconds(5);
+
+    // 让后台线程的编译停在这里，直到Open
+    class Gate
+    {
+    public:
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_entered = true;
+            m_condition.notify_all();
+            m_condition.wait(lock, [this]() { return m_open; });
+        }
+
+        bool WaitEntered()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            return m_condition.wait_for(lock, Timeout, [this]() { return m_entered; });
+        }
+
+        void Open()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_open = true;
+            m_condition.notify_all();
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_entered = false;
+        bool m_open = false;
+    };
+
+    bool TestDuplicates()
+    {
+        bool passed = true;
+        Cache cache(0);
+        int compileCount = 0;
+        passed &= Check(cache.Request(1, [&compileCount]() { ++compileCount; return 10; }), "the first request is new");
+        passed &= Check(!cache.Request(1, [&compileCount]() { ++compileCount; return 11; }), "the second request is a duplicate");
+        passed &= Check(compileCount == 1, "a duplicate is not compiled");
+
+        int pipeline = 0;
+        passed &= Check(cache.TryGet(1, pipeline) && pipeline == 10, "without threads Request compiles immediately");
+        passed &= Check(cache.Get(1) == 10, "Get returns the first compile");
+
+        const Cache::Stats stats = cache.GetStats();
+        passed &= Check(stats.requestCount == 2 && stats.duplicateCount == 1 && stats.compileCount == 1 && stats.failedCount == 0, "stats count duplicates");
+
+        bool threw = false;
+        try
+        {
+            cache.Get(2);
+        }
+        catch (const std::out_of_range&)
+        {
+            threw = true;
+        }
+        passed &= Check(threw, "Get of an unknown hash throws");
+        return passed;
+    }
+
+    // 多个线程同时请求同一组哈希
+    bool TestConcurrentDuplicates(unsigned threadCount, unsigned pipelineCount)
+    {
+        Cache cache(2);
+        std::vector<std::atomic<int>> compileCounts(pipelineCount);
+        for (auto& count : compileCounts)
+            count = 0;
+        std::atomic<unsigned> newCount{ 0 };
+        std::atomic<bool> wrongPipeline{ false };
+
+        std::vector<std::thread> threads;
+        for (unsigned t = 0; t < threadCount; ++t)
+        {
+            threads.emplace_back([&, t]()
+            {
+                for (unsigned i = 0; i < pipelineCount; ++i)
+                {
+                    const unsigned index = (i + t * 7) % pipelineCount;
+                    if (cache.Request(index, [&compileCounts, index]() { ++compileCounts[index]; return (int)index * 2; }))
+                        ++newCount;
+                    // 一部分在后台线程编译完成之前就Get
+                    if (i % 3 == 0 && cache.Get(index) != (int)index * 2)
+                        wrongPipeline = true;
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        cache.WaitIdle();
+
+        bool passed = true;
+        bool compiledOnce = true;
+        for (auto& count : compileCounts)
+            compiledOnce &= count == 1;
+        passed &= Check(compiledOnce, "every hash is compiled exactly once");
+        passed &= Check(newCount == pipelineCount, "exactly one request per hash is new");
+        passed &= Check(!wrongPipeline, "Get returns the requested pipeline");
+
+        unsigned readyCount = 0;
+        cache.ForEachReady([&readyCount](uint64 hash, const int& pipeline) { readyCount += pipeline == (int)hash * 2; });
+        passed &= Check(readyCount == pipelineCount, "every pipeline is ready after WaitIdle");
+
+        const Cache::Stats stats = cache.GetStats();
+        passed &= Check(stats.requestCount == (uint64)threadCount * pipelineCount && stats.duplicateCount == stats.requestCount - pipelineCount,
+            "stats count concurrent duplicates");
+        std::printf("%u threads requested %u pipelines %llu times, %llu compiles\n", threadCount, pipelineCount,
+            (unsigned long long)stats.requestCount, (unsigned long long)stats.compileCount);
+        return passed;
+    }
+
+    // 唯一的后台线程被第一个任务占住时，Get第二个任务应该在调用线程中编译
+    bool TestGetCompilesQueued()
+    {
+        bool passed = true;
+        Gate gate;
+        Cache cache(1);
+        std::thread::id compileThread;
+        std::atomic<int> secondCompileCount{ 0 };
+
+        cache.Request(1, [&gate]() { gate.Wait(); return 1; });
+        passed &= Check(gate.WaitEntered(), "the worker starts the first compile");
+        cache.Request(2, [&compileThread, &secondCompileCount]() { compileThread = std::this_thread::get_id(); ++secondCompileCount; return 2; });
+
+        int pipeline = 0;
+        passed &= Check(!cache.TryGet(2, pipeline), "the queued pipeline is not ready");
+
+        auto result = std::async(std::launch::async, [&cache]() { return cache.Get(2); });
+        const bool finished = result.wait_for(Timeout) == std::future_status::ready;
+        passed &= Check(finished, "Get does not wait for the compile in front of it");
+        gate.Open();
+        passed &= Check(result.get() == 2, "Get returns the queued pipeline");
+        passed &= Check(compileThread != std::thread::id() && compileThread != std::this_thread::get_id(), "the queued pipeline is compiled by the caller of Get");
+
+        // 后台线程之后从队列中取出2时不会再编译一次
+        passed &= Check(cache.Get(1) == 1, "Get waits for a compile on the worker");
+        cache.WaitIdle();
+        cache.Request(3, []() { return 3; });
+        passed &= Check(cache.Get(3) == 3, "the worker keeps running");
+        passed &= Check(secondCompileCount == 1 && cache.GetStats().compileCount == 3, "the stolen compile is not repeated by the worker");
+        return passed;
+    }
+
+    bool TestExceptions()
+    {
+        bool passed = true;
+        for (unsigned threadCount : { 0u, 2u })
+        {
+            Cache cache(threadCount);
+            bool requested = false;
+            try
+            {
+                requested = cache.Request(1, []() -> int { throw std::runtime_error("compile error"); });
+            }
+            catch (...)
+            {
+            }
+            passed &= Check(requested, "Request does not throw when the compile fails");
+            cache.Request(2, []() { return 2; });
+
+            for (int i = 0; i < 2; ++i)
+            {
+                std::string message;
+                try
+                {
+                    cache.Get(1);
+                }
+                catch (const std::runtime_error& e)
+                {
+                    message = e.what();
+                }
+                passed &= Check(message == "compile error", "every Get rethrows the compile exception");
+            }
+
+            int pipeline = 0;
+            passed &= Check(!cache.TryGet(1, pipeline), "TryGet of a failed pipeline returns false");
+            passed &= Check(!cache.Request(1, []() { return 1; }), "a failed hash is not compiled again");
+            passed &= Check(cache.Get(2) == 2, "other pipelines are not affected");
+            cache.WaitIdle();
+            const Cache::Stats stats = cache.GetStats();
+            passed &= Check(stats.compileCount == 2 && stats.failedCount == 1, "stats count the failure");
+
+            unsigned readyCount = 0;
+            cache.ForEachReady([&readyCount](uint64, const int&) { ++readyCount; });
+            passed &= Check(readyCount == 1, "failed pipelines are not visited");
+        }
+        return passed;
+    }
+
+    // 析构时等待正在编译的任务，丢弃还在队列中的任务
+    bool TestDestroyWithQueuedJobs()
+    {
+        Gate gate;
+        std::atomic<int> compileCount{ 0 };
+        std::thread opener;
+        {
+            Cache cache(1);
+            cache.Request(1, [&gate, &compileCount]() { gate.Wait(); ++compileCount; return 1; });
+            gate.WaitEntered();
+            for (uint64 hash = 2; hash < 10; ++hash)
+                cache.Request(hash, [&compileCount]() { ++compileCount; return 0; });
+            opener = std::thread([&gate]() { std::this_thread::sleep_for(std::chrono::milliseconds(50)); gate.Open(); });
+        }
+        opener.join();
+        return Check(compileCount == 1, "queued jobs are dropped when the cache is destroyed");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned threadCount = 8;
+    unsigned pipelineCount = 2000;
+    bool usage = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage = true;
+            break;
+        }
+
+        if (arg == "-threads")
+            threadCount = (unsigned)std::stoul(argv[++i]);
+        else if (arg == "-pipelines")
+            pipelineCount = (unsigned)std::stoul(argv[++i]);
+        else
+        {
+            usage = true;
+            break;
+        }
+    }
+    if (usage || threadCount == 0 || pipelineCount == 0)
+    {
+        std::cerr << "usage: PipelineCacheTest [-threads n] [-pipelines n]" << std::endl;
+        return 1;
+    }
+
+    bool passed = TestDuplicates();
+    passed &= TestConcurrentDuplicates(threadCount, pipelineCount);
+    passed &= TestGetCompilesQueued();
+    passed &= TestExceptions();
+    passed &= TestDestroyWithQueuedJobs();
+    return ReportResult(passed);
+}
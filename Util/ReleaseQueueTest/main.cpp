@@ -0,0 +1,177 @@
+#include "../../Common/DeferredReleaseQueue.h"
+#include "../TestUtil.h"
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 用法：ReleaseQueueTest [-threads 生产者线程数] [-items 每个线程Retire的数量] [-latency GPU落后的帧数] [-seed 随机种子]
+// 检查DeferredReleaseQueue不会在fence完成之前释放对象，不需要GPU。
+// 多个线程不断Retire带fence值的对象，渲染线程每帧提交一个fence值，GPU完成的fence比提交的落后latency帧，
+// 每个对象析构时检查当时已完成的fence值不小于它的fence值，最后检查每个对象都恰好释放了一次。
+
+namespace
+{
+    using uint64 = DeferredReleaseQueue::uint64;
+
+    struct Counters
+    {
+        std::atomic<uint64> completedFence{ 0 };    // 模拟的GPU已完成的fence值
+        std::atomic<uint64> submittedFence{ 0 };    // 渲染线程最后提交的fence值
+        std::atomic<uint64> releaseCount{ 0 };
+        std::atomic<uint64> earlyReleaseCount{ 0 };
+    };
+
+    // 代替GPU resource，析构时记录释放
+    class Token
+    {
+    public:
+        Token(Counters* counters, uint64 fenceValue) : m_counters(counters), m_fenceValue(fenceValue) {}
+        Token(Token&& rhs) : m_counters(rhs.m_counters), m_fenceValue(rhs.m_fenceValue) { rhs.m_counters = nullptr; }
+        Token(const Token& rhs) = delete;
+        Token& operator=(const Token& rhs) = delete;
+
+        ~Token()
+        {
+            if (m_counters == nullptr)
+                return;
+            ++m_counters->releaseCount;
+            if (m_fenceValue > m_counters->completedFence.load())
+                ++m_counters->earlyReleaseCount;
+        }
+
+    private:
+        Counters* m_counters;
+        uint64 m_fenceValue;
+    };
+
+    // 单线程下的边界情况
+    bool TestSingleThread()
+    {
+        Counters counters;
+        DeferredReleaseQueue queue;
+        bool passed = true;
+
+        queue.Retire(Token(&counters, 5), 5);
+        queue.Retire(Token(&counters, 3), 3);
+        queue.Retire(Token(&counters, 5), 5);
+
+        counters.completedFence = 2;
+        passed &= Check(queue.ReleaseCompleted(2) == 0, "nothing is released before the first fence");
+        passed &= Check(queue.PendingCount() == 3, "all items are pending");
+
+        counters.completedFence = 4;
+        passed &= Check(queue.ReleaseCompleted(4) == 1, "the fence 3 item is released at fence 4");
+
+        counters.completedFence = 5;
+        passed &= Check(queue.ReleaseCompleted(5) == 2, "both fence 5 items are released at fence 5");
+        passed &= Check(queue.ReleaseCompleted(100) == 0, "items are released only once");
+
+        passed &= Check(counters.releaseCount == 3, "every item is destroyed");
+        passed &= Check(counters.earlyReleaseCount == 0, "no item is destroyed before its fence");
+        return passed;
+    }
+
+    // 多个线程同时Retire，渲染线程每帧推进fence并释放
+    bool TestConcurrent(unsigned threadCount, unsigned itemsPerThread, unsigned latency, unsigned seed)
+    {
+        Counters counters;
+        DeferredReleaseQueue queue;
+        std::atomic<unsigned> finishedThreads{ 0 };
+
+        std::vector<std::thread> producers;
+        for (unsigned t = 0; t < threadCount; ++t)
+        {
+            producers.emplace_back([&, t]()
+            {
+                std::mt19937 random(seed + t);
+                for (unsigned i = 0; i < itemsPerThread; ++i)
+                {
+                    // 对象在最后提交的command list或者之后几帧中还会被使用
+                    const uint64 fenceValue = counters.submittedFence.load() + random() % 3;
+                    queue.Retire(Token(&counters, fenceValue), fenceValue);
+                    if (random() % 64 == 0)
+                        std::this_thread::yield();
+                }
+                ++finishedThreads;
+            });
+        }
+
+        uint64 releasedByQueue = 0;
+        uint64 frame = 0;
+        while (finishedThreads.load() < threadCount)
+        {
+            ++frame;
+            counters.submittedFence = frame;
+            if (frame > latency)
+                counters.completedFence = frame - latency;
+            releasedByQueue += queue.ReleaseCompleted(counters.completedFence.load());
+        }
+        for (auto& producer : producers)
+            producer.join();
+
+        // GPU继续执行，直到所有fence都完成
+        const uint64 lastFence = counters.submittedFence.load() + 3;
+        while (counters.completedFence.load() < lastFence)
+        {
+            ++counters.completedFence;
+            releasedByQueue += queue.ReleaseCompleted(counters.completedFence.load());
+        }
+
+        const uint64 total = (uint64)threadCount * itemsPerThread;
+        std::printf("%u threads, %llu items, %llu frames, latency %u frames\n", threadCount, (unsigned long long)total,
+            (unsigned long long)frame, latency);
+        std::printf("released %llu, early %llu, still pending %zu\n", (unsigned long long)counters.releaseCount.load(),
+            (unsigned long long)counters.earlyReleaseCount.load(), queue.PendingCount());
+
+        bool passed = true;
+        passed &= Check(counters.earlyReleaseCount == 0, "no item is destroyed before its fence");
+        passed &= Check(counters.releaseCount == total, "every item is destroyed exactly once");
+        passed &= Check(releasedByQueue == total, "ReleaseCompleted reports every release");
+        passed &= Check(queue.PendingCount() == 0, "nothing is left pending");
+        return passed;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    unsigned threadCount = 4;
+    unsigned itemsPerThread = 100000;
+    unsigned latency = 2;
+    unsigned seed = 1;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            threadCount = 0;
+            break;
+        }
+
+        if (arg == "-threads")
+            threadCount = (unsigned)std::stoul(argv[++i]);
+        else if (arg == "-items")
+            itemsPerThread = (unsigned)std::stoul(argv[++i]);
+        else if (arg == "-latency")
+            latency = (unsigned)std::stoul(argv[++i]);
+        else if (arg == "-seed")
+            seed = (unsigned)std::stoul(argv[++i]);
+        else
+        {
+            threadCount = 0;
+            break;
+        }
+    }
+    if (threadCount == 0)
+    {
+        std::cerr << "usage: ReleaseQueueTest [-threads n] [-items n] [-latency n] [-seed n]" << std::endl;
+        return 1;
+    }
+
+    bool passed = TestSingleThread();
+    passed &= TestConcurrent(threadCount, itemsPerThread, latency, seed);
+    return ReportResult(passed);
+}
@@ -0,0 +1,236 @@
+#include "../../Common/RenderGraph.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// 用法：RenderGraphSim [-passes 数量] [-reads 每个pass最多读取的数量] [-window 读取之前多少个pass的输出] [-dead 没有被使用的pass的比例] [-seed 随机种子]
+// 构造一个合成的渲染图并编译，不需要GPU，报告剔除的pass、barrier数量和临时resource共用内存节省的大小。
+// 每个pass写一个新的临时texture，读取之前window个pass中的若干个输出，最后一个pass读取之前的输出并写back buffer。
+// 编译后检查：生命周期重叠的临时resource在heap中不重叠，back buffer最后回到PRESENT。
+
+namespace
+{
+    using uint32 = RenderGraph::uint32;
+    using uint64 = RenderGraph::uint64;
+    using State = RenderGraph::State;
+
+    // 与D3D12_RESOURCE_STATES的值一致
+    const State StatePresent = 0x0;
+    const State StateRenderTarget = 0x4;
+    const State StateUnorderedAccess = 0x8;
+    const State StateDepthWrite = 0x10;
+    const State StatePixelShaderResource = 0x80;
+
+    struct Options
+    {
+        uint32 passCount = 200;
+        uint32 maxReads = 3;
+        uint32 window = 8;
+        double deadRatio = 0.1;
+        uint32 seed = 1;
+    };
+
+    struct SyntheticTexture
+    {
+        const char* name;
+        uint64 size;
+        State writeState;
+    };
+
+    // 1920x1080下常见的render target，按64KB对齐前的大小
+    const SyntheticTexture TextureKinds[] =
+    {
+        { "rgba8", 1920ull * 1080 * 4, StateRenderTarget },
+        { "rgba16f", 1920ull * 1080 * 8, StateRenderTarget },
+        { "half_rgba16f", 960ull * 540 * 8, StateRenderTarget },
+        { "quarter_rgba16f", 480ull * 270 * 8, StateUnorderedAccess },
+        { "depth32", 1920ull * 1080 * 4, StateDepthWrite },
+        { "shadow2048", 2048ull * 2048 * 4, StateDepthWrite },
+    };
+
+    // 构造图时记录的信息，用来检查编译结果
+    struct SyntheticGraph
+    {
+        RenderGraph::ResourceHandle backBuffer = 0;
+        std::vector<RenderGraph::ResourceHandle> transients;
+        std::vector<uint64> sizes;                                          // 按handle
+        std::vector<std::vector<RenderGraph::ResourceHandle>> accesses;     // 按pass
+    };
+
+    bool Validate(const RenderGraph& graph, const SyntheticGraph& synthetic)
+    {
+        const auto& accesses = synthetic.accesses;
+        const auto& transients = synthetic.transients;
+
+        // 按编译后的顺序计算每个临时resource的生命周期
+        std::vector<uint32> firstUse(synthetic.sizes.size(), (uint32)RenderGraph::InvalidIndex);
+        std::vector<uint32> lastUse(firstUse.size(), (uint32)RenderGraph::InvalidIndex);
+        const auto& passes = graph.GetCompiledPasses();
+        for (uint32 i = 0; i < (uint32)passes.size(); ++i)
+        {
+            for (RenderGraph::ResourceHandle resource : accesses[passes[i].passIndex])
+            {
+                if (firstUse[resource] == RenderGraph::InvalidIndex)
+                    firstUse[resource] = i;
+                lastUse[resource] = i;
+            }
+        }
+
+        bool valid = true;
+        for (size_t i = 0; i < transients.size(); ++i)
+        {
+            const RenderGraph::ResourceHandle a = transients[i];
+            const uint64 offsetA = graph.GetTransientOffset(a);
+            if ((offsetA == RenderGraph::InvalidOffset) != (firstUse[a] == RenderGraph::InvalidIndex))
+            {
+                std::cerr << graph.GetResourceName(a) << ": offset does not match usage" << std::endl;
+                valid = false;
+                continue;
+            }
+            if (offsetA == RenderGraph::InvalidOffset)
+                continue;
+            if (offsetA + synthetic.sizes[a] > graph.GetTransientHeapSize())
+            {
+                std::cerr << graph.GetResourceName(a) << ": outside the heap" << std::endl;
+                valid = false;
+            }
+
+            for (size_t j = i + 1; j < transients.size(); ++j)
+            {
+                const RenderGraph::ResourceHandle b = transients[j];
+                const uint64 offsetB = graph.GetTransientOffset(b);
+                if (offsetB == RenderGraph::InvalidOffset)
+                    continue;
+                const bool livesOverlap = firstUse[a] <= lastUse[b] && firstUse[b] <= lastUse[a];
+                const bool memoryOverlaps = offsetA < offsetB + synthetic.sizes[b] && offsetB < offsetA + synthetic.sizes[a];
+                if (livesOverlap && memoryOverlaps)
+                {
+                    std::cerr << graph.GetResourceName(a) << " and " << graph.GetResourceName(b) << " are alive at the same time but share memory" << std::endl;
+                    valid = false;
+                }
+            }
+        }
+
+        bool returnsToPresent = false;
+        for (auto& barrier : graph.GetFinalBarriers())
+        {
+            if (barrier.resource == synthetic.backBuffer && barrier.after == StatePresent)
+                returnsToPresent = true;
+        }
+        if (!returnsToPresent)
+        {
+            std::cerr << "back buffer does not return to PRESENT" << std::endl;
+            valid = false;
+        }
+        return valid;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    bool usage = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage = true;
+            break;
+        }
+
+        if (arg == "-passes")
+            options.passCount = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-reads")
+            options.maxReads = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-window")
+            options.window = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-dead")
+            options.deadRatio = std::stod(argv[++i]);
+        else if (arg == "-seed")
+            options.seed = (uint32)std::stoul(argv[++i]);
+        else
+        {
+            usage = true;
+            break;
+        }
+    }
+    if (usage || options.passCount < 2 || options.maxReads == 0 || options.window == 0)
+    {
+        std::cerr << "usage: RenderGraphSim [-passes n] [-reads n] [-window n] [-dead ratio] [-seed n]" << std::endl;
+        return 1;
+    }
+
+    const uint32 kindCount = (uint32)(sizeof(TextureKinds) / sizeof(TextureKinds[0]));
+    std::mt19937 random(options.seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    RenderGraph graph;
+    SyntheticGraph synthetic;
+    synthetic.backBuffer = graph.ImportResource("back_buffer", StatePresent, StatePresent);
+    synthetic.sizes.push_back(0);
+    std::vector<RenderGraph::ResourceHandle> outputs;
+
+    for (uint32 i = 0; i + 1 < options.passCount; ++i)
+    {
+        const SyntheticTexture& texture = TextureKinds[random() % kindCount];
+        const RenderGraph::ResourceHandle output = graph.CreateTransient(std::string(texture.name) + "_" + std::to_string(i), texture.size);
+        synthetic.transients.push_back(output);
+        synthetic.sizes.push_back(texture.size);
+
+        const uint32 pass = graph.AddPass("pass_" + std::to_string(i));
+        synthetic.accesses.emplace_back();
+        auto& passAccesses = synthetic.accesses.back();
+        if (!outputs.empty())
+        {
+            const uint32 readCount = 1 + random() % options.maxReads;
+            for (uint32 r = 0; r < readCount; ++r)
+            {
+                const uint32 back = random() % (std::min)((uint32)outputs.size(), options.window);
+                const RenderGraph::ResourceHandle input = outputs[outputs.size() - 1 - back];
+                if (std::find(passAccesses.begin(), passAccesses.end(), input) != passAccesses.end())
+                    continue;
+                graph.Read(pass, input, StatePixelShaderResource);
+                passAccesses.push_back(input);
+            }
+        }
+        graph.Write(pass, output, texture.writeState);
+        passAccesses.push_back(output);
+
+        // 一部分pass的输出不会被之后的pass读取，编译时应该被剔除
+        if (uniform(random) >= options.deadRatio)
+            outputs.push_back(output);
+    }
+
+    // 最后一个pass合成最近的几个输出写到back buffer
+    const uint32 present = graph.AddPass("present");
+    synthetic.accesses.emplace_back();
+    for (uint32 back = 0; back < (std::min)((uint32)outputs.size(), options.maxReads); ++back)
+    {
+        graph.Read(present, outputs[outputs.size() - 1 - back], StatePixelShaderResource);
+        synthetic.accesses.back().push_back(outputs[outputs.size() - 1 - back]);
+    }
+    graph.Write(present, synthetic.backBuffer, StateRenderTarget);
+    synthetic.accesses.back().push_back(synthetic.backBuffer);
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    graph.Compile();
+    const auto end = std::chrono::high_resolution_clock::now();
+    const double milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+
+    const RenderGraph::Stats& stats = graph.GetStats();
+    std::printf("%u passes (%u culled), %u transient textures, %u barriers, %u aliasing barriers, compiled in %.3f ms\n",
+        stats.passCount, stats.culledPassCount, stats.transientCount, stats.barrierCount, stats.aliasingBarrierCount, milliseconds);
+    std::printf("memory without aliasing %10.1f MB\n", stats.memoryWithoutAliasing / (1024.0 * 1024.0));
+    std::printf("memory with aliasing    %10.1f MB\n", stats.memoryWithAliasing / (1024.0 * 1024.0));
+    std::printf("saved                   %10.1f MB (%.1f%%)\n", stats.MemorySaved() / (1024.0 * 1024.0),
+        stats.memoryWithoutAliasing > 0 ? stats.MemorySaved() * 100.0 / stats.memoryWithoutAliasing : 0.0);
+
+    if (!Validate(graph, synthetic))
+        return 1;
+    return 0;
+}
@@ -0,0 +1,243 @@
+#include "../../Common/TextureResidency.h"
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+// 用法：ResidencySim [-pattern zipf|sweep|random] [-textures 数量] [-frames 帧数] [-touches 每帧访问次数]
+//                    [-latency 完成动作需要的帧数] [-idle 可以被挤出去的空闲帧数] [-seed 随机种子] [-csv 每帧统计.csv] -budget MB ...
+// 用人工构造的访问序列驱动TextureResidencyManager，不需要GPU，比较不同预算和访问模式下的命中率和每帧搬运的字节数。
+// 可以给多个-budget，每个预算用同样的序列各跑一遍；-csv只记录第一个预算的每帧数据。
+//   zipf   少数texture被频繁访问，热点固定
+//   sweep  相机穿过场景，访问的窗口逐渐移动，离窗口中心越远需要的mip越粗
+//   random 每帧均匀随机访问
+
+namespace
+{
+    using uint32 = TextureResidencyManager::uint32;
+    using uint64 = TextureResidencyManager::uint64;
+
+    struct Options
+    {
+        std::string pattern = "zipf";
+        uint32 textureCount = 512;
+        uint32 frameCount = 1000;
+        uint32 touchesPerFrame = 64;
+        uint32 latency = 2;
+        uint32 idleFrames = 8;
+        uint32 seed = 1;
+        std::string csvPath;
+        std::vector<uint64> budgets;
+    };
+
+    struct SyntheticTexture
+    {
+        std::vector<uint64> mipSizes;
+    };
+
+    struct Access
+    {
+        uint32 texture;
+        uint32 desiredMip;
+    };
+
+    // 正方形、完整mip链的BC1（每个4x4块8字节）或BC3（16字节）texture，边长256到4096
+    std::vector<SyntheticTexture> CreateTextures(const Options& options)
+    {
+        std::mt19937 random(options.seed);
+        std::vector<SyntheticTexture> textures(options.textureCount);
+        for (auto& texture : textures)
+        {
+            const uint32 size = 256u << (random() % 5);
+            const uint64 blockBytes = (random() % 2) ? 8 : 16;
+            for (uint32 width = size; ; width /= 2)
+            {
+                const uint64 blocks = (width + 3) / 4;
+                texture.mipSizes.push_back(blocks * blocks * blockBytes);
+                if (width == 1)
+                    break;
+            }
+        }
+        return textures;
+    }
+
+    // 每帧的访问序列，所有预算使用同一份
+    std::vector<std::vector<Access>> CreateTrace(const Options& options)
+    {
+        std::mt19937 random(options.seed + 1);
+        std::vector<std::vector<Access>> trace(options.frameCount);
+        const uint32 count = options.textureCount;
+
+        // zipf分布的累积概率，s = 1
+        std::vector<double> cumulative(count);
+        double sum = 0.0;
+        for (uint32 i = 0; i < count; ++i)
+        {
+            sum += 1.0 / (i + 1);
+            cumulative[i] = sum;
+        }
+
+        std::uniform_real_distribution<double> uniform(0.0, 1.0);
+        for (uint32 frame = 0; frame < options.frameCount; ++frame)
+        {
+            for (uint32 i = 0; i < options.touchesPerFrame; ++i)
+            {
+                Access access;
+                if (options.pattern == "sweep")
+                {
+                    // 每4帧移动一个texture，窗口宽度为每帧访问次数
+                    const uint32 window = options.touchesPerFrame;
+                    const uint32 center = frame / 4 + window / 2;
+                    const uint32 offset = i < window / 2 ? window / 2 - i : i - window / 2;
+                    access.texture = (center + i - window / 2) % count;
+                    access.desiredMip = offset * 4 / (window / 2 + 1);
+                }
+                else if (options.pattern == "random")
+                {
+                    access.texture = random() % count;
+                    access.desiredMip = random() % 3;
+                }
+                else
+                {
+                    const double r = uniform(random) * sum;
+                    access.texture = (uint32)(std::lower_bound(cumulative.begin(), cumulative.end(), r) - cumulative.begin());
+                    access.texture = (std::min)(access.texture, count - 1);
+                    access.desiredMip = random() % 2;
+                }
+                trace[frame].push_back(access);
+            }
+        }
+        return trace;
+    }
+
+    struct PendingAction
+    {
+        uint64 completeFrame;
+        uint32 id;
+        uint32 firstMip;
+    };
+
+    // 所有texture开始时只驻留最后一级mip，动作在latency帧后完成
+    TextureResidencyManager::Stats Simulate(const Options& options, uint64 budget, const std::vector<SyntheticTexture>& textures,
+        const std::vector<std::vector<Access>>& trace, std::ostream* csv)
+    {
+        TextureResidencyManager manager(budget, options.idleFrames);
+        std::vector<uint32> ids;
+        for (auto& texture : textures)
+            ids.push_back(manager.Register(texture.mipSizes, (uint32)texture.mipSizes.size() - 1));
+
+        if (csv != nullptr)
+            *csv << "frame,touches,hits,hit_rate,upgrades,downgrades,uploaded_bytes,evicted_bytes,resident_bytes\n";
+
+        std::deque<PendingAction> pendingActions;
+        std::vector<TextureResidencyManager::Action> actions;
+        for (uint64 frame = 0; frame < trace.size(); ++frame)
+        {
+            while (!pendingActions.empty() && pendingActions.front().completeFrame <= frame)
+            {
+                manager.Complete(pendingActions.front().id, pendingActions.front().firstMip);
+                pendingActions.pop_front();
+            }
+
+            for (const Access& access : trace[frame])
+                manager.Touch(ids[access.texture], access.desiredMip);
+
+            actions.clear();
+            manager.EndFrame(actions);
+            for (auto& action : actions)
+                pendingActions.push_back({ frame + options.latency, action.id, action.firstMip });
+
+            if (csv != nullptr)
+            {
+                const auto& stats = manager.GetLastFrameStats();
+                *csv << stats.frame << "," << stats.touchCount << "," << stats.hitCount << "," << stats.HitRate() << ","
+                    << stats.upgradeCount << "," << stats.downgradeCount << "," << stats.uploadedBytes << ","
+                    << stats.evictedBytes << "," << stats.residentBytes << "\n";
+            }
+        }
+        return manager.GetStats();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            options.budgets.clear();
+            break;
+        }
+
+        if (arg == "-pattern")
+            options.pattern = argv[++i];
+        else if (arg == "-textures")
+            options.textureCount = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-frames")
+            options.frameCount = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-touches")
+            options.touchesPerFrame = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-latency")
+            options.latency = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-idle")
+            options.idleFrames = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-seed")
+            options.seed = (uint32)std::stoul(argv[++i]);
+        else if (arg == "-csv")
+            options.csvPath = argv[++i];
+        else if (arg == "-budget")
+            options.budgets.push_back((uint64)(std::stod(argv[++i]) * 1024 * 1024));
+        else
+        {
+            options.budgets.clear();
+            break;
+        }
+    }
+    if (options.budgets.empty() || options.textureCount == 0 || options.touchesPerFrame < 2 ||
+        (options.pattern != "zipf" && options.pattern != "sweep" && options.pattern != "random"))
+    {
+        std::cerr << "usage: ResidencySim [-pattern zipf|sweep|random] [-textures n] [-frames n] [-touches n] [-latency n] [-idle n] [-seed n]"
+            " [-csv frames.csv] -budget MB ..." << std::endl;
+        return 1;
+    }
+
+    const std::vector<SyntheticTexture> textures = CreateTextures(options);
+    const std::vector<std::vector<Access>> trace = CreateTrace(options);
+    uint64 totalBytes = 0;
+    for (auto& texture : textures)
+    {
+        for (uint64 size : texture.mipSizes)
+            totalBytes += size;
+    }
+
+    std::ofstream csv;
+    if (!options.csvPath.empty())
+    {
+        csv.open(options.csvPath, std::ios::trunc);
+        if (!csv)
+        {
+            std::cerr << options.csvPath << ": cannot write" << std::endl;
+            return 1;
+        }
+    }
+
+    std::printf("%s: %u textures, %.1f MB with all mips, %u frames, %u touches per frame, latency %u frames, idle %u frames\n",
+        options.pattern.c_str(), options.textureCount, totalBytes / (1024.0 * 1024.0), options.frameCount, options.touchesPerFrame,
+        options.latency, options.idleFrames);
+    std::printf("%10s %9s %10s %10s %14s %14s %12s\n", "budget MB", "hit rate", "upgrades", "downgrades", "upload KB/fr", "evict KB/fr", "peak MB");
+    for (size_t i = 0; i < options.budgets.size(); ++i)
+    {
+        const uint64 budget = options.budgets[i];
+        const TextureResidencyManager::Stats stats = Simulate(options, budget, textures, trace, (i == 0 && csv.is_open()) ? &csv : nullptr);
+        const double frames = (double)(std::max)(stats.frameCount, (uint64)1);
+        std::printf("%10.1f %8.2f%% %10llu %10llu %14.1f %14.1f %12.1f\n", budget / (1024.0 * 1024.0), stats.HitRate() * 100.0,
+            (unsigned long long)stats.upgradeCount, (unsigned long long)stats.downgradeCount,
+            stats.uploadedBytes / frames / 1024.0, stats.evictedBytes / frames / 1024.0, stats.peakResidentBytes / (1024.0 * 1024.0));
+    }
+    return 0;
+}
@@ -0,0 +1,319 @@
+#include "../ShaderBuilder/ShaderBuild.h"
+#include "../TestUtil.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// 用法：ShaderBuildTest
+// 用内存中的假文件系统和假的编译器测试ShaderBuild.h中的依赖扫描和增量编译，不需要fxc，也可以在Linux上编译运行：
+// 循环包含、注释掉的#include、修改头文件后只重新编译包含它的任务、编译选项和宏定义的变化、输出文件被删除、
+// 重复的输出文件、编译失败和找不到的include、cache的保存和读取、多线程编译时每个任务只编译一次。
+
+namespace
+{
+    // 假的文件系统和编译器：编译器把任务的描述写到输出文件中，源文件中有FAIL时编译失败
+    class FakeFileSystem
+    {
+    public:
+        void Write(const std::string& path, const std::string& content)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_files[path] = content;
+        }
+
+        void Remove(const std::string& path)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_files.erase(path);
+        }
+
+        bool Read(const std::string& path, std::string& content)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_files.find(path);
+            if (it == m_files.end())
+                return false;
+            content = it->second;
+            return true;
+        }
+
+        bool Exists(const std::string& path)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_files.count(path) != 0;
+        }
+
+        bool Compile(const ShaderCompileJob& job, std::string& log)
+        {
+            std::string content;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_compiledOutputs.push_back(job.output);
+                auto it = m_files.find(job.source);
+                if (it == m_files.end() || it->second.find("FAIL") != std::string::npos)
+                {
+                    log = job.source + ": error X3000: syntax error";
+                    return false;
+                }
+            }
+            Write(job.output, job.source + " " + job.entryPoint + " " + job.target + " " + job.flags);
+            return true;
+        }
+
+        // 取出上一次调用之后编译过的输出文件，已排序
+        std::vector<std::string> TakeCompiled()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::vector<std::string> compiled;
+            compiled.swap(m_compiledOutputs);
+            std::sort(compiled.begin(), compiled.end());
+            return compiled;
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::map<std::string, std::string> m_files;
+        std::vector<std::string> m_compiledOutputs;
+    };
+
+    // 每次构建都用新的ShaderBuilder，与ShaderBuilder.exe每次运行重新读取文件一样
+    ShaderBuildResult Build(FakeFileSystem& fs, const std::vector<ShaderCompileJob>& jobs, ShaderBuildCache& cache, std::uint32_t threadCount = 4)
+    {
+        ShaderBuilder builder(
+            [&fs](const std::string& path, std::string& content) { return fs.Read(path, content); },
+            [&fs](const std::string& path) { return fs.Exists(path); },
+            [&fs](const ShaderCompileJob& job, std::string& log) { return fs.Compile(job, log); },
+            "fake-fxc");
+        return builder.Build(jobs, cache, threadCount);
+    }
+
+    ShaderCompileJob MakeJob(const std::string& source, const std::string& entryPoint, const std::string& target, const std::string& output)
+    {
+        ShaderCompileJob job;
+        job.source = source;
+        job.entryPoint = entryPoint;
+        job.target = target;
+        job.flags = "/Od /Zi";
+        job.output = output;
+        return job;
+    }
+
+    bool CheckCounts(const ShaderBuildResult& result, std::uint32_t compiled, std::uint32_t skipped, std::uint32_t failed, const std::string& message)
+    {
+        bool passed = result.compiledCount == compiled && result.skippedCount == skipped && result.failedCount == failed;
+        if (!passed)
+        {
+            std::cerr << "FAILED: " << message << ": " << result.compiledCount << " compiled, " << result.skippedCount << " skipped, "
+                << result.failedCount << " failed" << std::endl;
+            for (auto& error : result.errors)
+                std::cerr << "  " << error << std::endl;
+        }
+        return passed;
+    }
+
+    bool TestParseIncludes()
+    {
+        const std::string content =
+            "#include \"a.hlsli\"\n"
+            "  #  include <b.hlsli>\n"
+            "// #include \"line_comment.hlsli\"\n"
+            "/* #include \"block_comment.hlsli\"\n"
+            "#include \"still_in_comment.hlsli\" */\n"
+            "#include \"c.hlsli\" // #include \"after_code.hlsli\"\n"
+            "static const char* s = \"//\"; #include \"not_at_line_start.hlsli\"\n"
+            "#includes \"not_an_include.hlsli\"\n";
+        std::vector<std::string> includes;
+        ParseIncludes(content, includes);
+        return Check(includes == std::vector<std::string>({ "a.hlsli", "b.hlsli", "c.hlsli" }), "only includes outside comments are found");
+    }
+
+    bool TestScanner()
+    {
+        bool passed = true;
+        FakeFileSystem fs;
+        // a和b互相包含，b通过..\包含上一级目录中的文件，注释中的include不存在也不报错
+        fs.Write("shaders/a.hlsl", "#include \"inc/b.hlsli\"\n// #include \"missing.hlsli\"\n");
+        fs.Write("shaders/inc/b.hlsli", "#include \"../a.hlsl\"\n#include \"..\\\\..\\\\Common/c.hlsli\"\n/* #include \"missing2.hlsli\" */\n");
+        fs.Write("Common/c.hlsli", "#include \"c.hlsli\"\n");
+
+        IncludeScanner scanner([&fs](const std::string& path, std::string& content) { return fs.Read(path, content); });
+        std::vector<std::string> files;
+        std::string error;
+        passed &= Check(scanner.Scan("shaders/./a.hlsl", files, error), "include cycles scan without error: " + error);
+        passed &= Check(files == std::vector<std::string>({ "Common/c.hlsli", "shaders/a.hlsl", "shaders/inc/b.hlsli" }),
+            "include cycles and self includes are visited once");
+        passed &= Check(scanner.ReadCount() == 3, "each file is read once");
+
+        fs.Write("shaders/d.hlsl", "#include \"inc/missing.hlsli\"\n");
+        error.clear();
+        passed &= Check(!scanner.Scan("shaders/d.hlsl", files, error), "a missing include fails the scan");
+        passed &= Check(error.find("shaders/d.hlsl: cannot open include shaders/inc/missing.hlsli") != std::string::npos,
+            "the error names the including file: " + error);
+        return passed;
+    }
+
+    bool TestIncrementalBuild()
+    {
+        bool passed = true;
+        FakeFileSystem fs;
+        fs.Write("Common/lighting.hlsli", "float3 Light();\n");
+        fs.Write("Common/util.hlsli", "float Saturate();\n");
+        fs.Write("A/shaders.hlsl", "#include \"../Common/lighting.hlsli\"\n");
+        fs.Write("B/shaders.hlsl", "#include \"../Common/util.hlsli\"\n// #include \"../Common/lighting.hlsli\"\n");
+
+        std::vector<ShaderCompileJob> jobs =
+        {
+            MakeJob("A/shaders.hlsl", "VSMain", "vs_5_0", "A/shaders_vs.cso"),
+            MakeJob("A/shaders.hlsl", "PSMain", "ps_5_0", "A/shaders_ps.cso"),
+            MakeJob("B/shaders.hlsl", "VSMain", "vs_5_0", "B/shaders_vs.cso"),
+            MakeJob("B/shaders.hlsl", "PSMain", "ps_5_0", "B/shaders_ps.cso"),
+        };
+        jobs[3].defines = { "A=1", "B=2" };
+
+        ShaderBuildCache cache;
+        passed &= CheckCounts(Build(fs, jobs, cache), 4, 0, 0, "first build compiles everything");
+        fs.TakeCompiled();
+        passed &= CheckCounts(Build(fs, jobs, cache), 0, 4, 0, "second build is up to date");
+
+        // 只有包含lighting.hlsli的A被重新编译，B中注释掉的include不算依赖
+        fs.Write("Common/lighting.hlsli", "float3 Light(float3 n);\n");
+        passed &= CheckCounts(Build(fs, jobs, cache), 2, 2, 0, "changing a header recompiles the shaders that include it");
+        passed &= Check(fs.TakeCompiled() == std::vector<std::string>({ "A/shaders_ps.cso", "A/shaders_vs.cso" }),
+            "only A is recompiled after changing lighting.hlsli");
+
+        // 宏定义的顺序不影响哈希，值不同时重新编译
+        jobs[3].defines = { "B=2", "A=1" };
+        passed &= CheckCounts(Build(fs, jobs, cache), 0, 4, 0, "reordering defines does not recompile");
+        jobs[3].defines = { "A=1", "B=3" };
+        passed &= CheckCounts(Build(fs, jobs, cache), 1, 3, 0, "changing a define recompiles");
+        fs.TakeCompiled();
+
+        // 编译选项变化时全部重新编译
+        std::vector<ShaderCompileJob> releaseJobs = MakeReleaseJobs(jobs, "/O3");
+        passed &= Check(releaseJobs[0].output == "A/shaders_vs_release.cso" && releaseJobs[0].flags == "/O3", "release jobs get a _release suffix");
+        for (auto& job : jobs)
+            job.flags = "/O3";
+        passed &= CheckCounts(Build(fs, jobs, cache), 4, 0, 0, "changing flags recompiles everything");
+        fs.TakeCompiled();
+
+        // 输出文件被删除时即使哈希相同也重新编译
+        fs.Remove("B/shaders_vs.cso");
+        passed &= CheckCounts(Build(fs, jobs, cache), 1, 3, 0, "a deleted output is rebuilt");
+        passed &= Check(fs.TakeCompiled() == std::vector<std::string>({ "B/shaders_vs.cso" }), "only the deleted output is rebuilt");
+
+        // cache保存后读取，结果不变
+        std::stringstream saved;
+        passed &= Check(cache.Save(saved), "cache saves");
+        ShaderBuildCache loaded;
+        passed &= Check(loaded.Load(saved), "cache loads");
+        passed &= CheckCounts(Build(fs, jobs, loaded), 0, 4, 0, "a loaded cache keeps everything up to date");
+
+        std::stringstream broken("not-a-cache-line\n");
+        passed &= Check(!loaded.Load(broken), "a malformed cache is rejected");
+        passed &= CheckCounts(Build(fs, jobs, loaded), 4, 0, 0, "a rejected cache rebuilds everything");
+        return passed;
+    }
+
+    bool TestFailures()
+    {
+        bool passed = true;
+        FakeFileSystem fs;
+        fs.Write("A/good.hlsl", "float4 main();\n");
+        fs.Write("A/bad.hlsl", "FAIL\n");
+        fs.Write("A/missing_include.hlsl", "#include \"nowhere.hlsli\"\n");
+
+        std::vector<ShaderCompileJob> jobs =
+        {
+            MakeJob("A/good.hlsl", "PSMain", "ps_5_0", "A/good.cso"),
+            MakeJob("A/good.hlsl", "VSMain", "vs_5_0", "A/./good.cso"),          // 规范化后与上一个相同
+            MakeJob("A/bad.hlsl", "PSMain", "ps_5_0", "A/bad.cso"),
+            MakeJob("A/missing_include.hlsl", "PSMain", "ps_5_0", "A/missing_include.cso"),
+            MakeJob("A/no_such_file.hlsl", "PSMain", "ps_5_0", "A/no_such_file.cso"),
+        };
+
+        ShaderBuildCache cache;
+        ShaderBuildResult result = Build(fs, jobs, cache);
+        passed &= CheckCounts(result, 1, 0, 4, "duplicate outputs, compile errors and missing files fail");
+        passed &= Check(fs.TakeCompiled() == std::vector<std::string>({ "A/bad.cso", "A/good.cso" }),
+            "jobs with missing files or duplicate outputs are not compiled");
+
+        auto hasError = [&result](const std::string& text)
+        {
+            return std::any_of(result.errors.begin(), result.errors.end(), [&text](const std::string& e) { return e.find(text) != std::string::npos; });
+        };
+        passed &= Check(hasError("A/./good.cso: written by more than one job"), "the duplicate output is reported");
+        passed &= Check(hasError("A/bad.cso: A/bad.hlsl: error X3000"), "the compiler log is reported");
+        passed &= Check(hasError("cannot open include A/nowhere.hlsli"), "the missing include is reported");
+        passed &= Check(hasError("cannot open A/no_such_file.hlsl"), "the missing source is reported");
+
+        // 失败的任务下次仍然编译，修好之后成功并且不再重新编译
+        passed &= CheckCounts(Build(fs, jobs, cache), 0, 1, 4, "failed jobs are retried");
+        passed &= Check(fs.TakeCompiled() == std::vector<std::string>({ "A/bad.cso" }), "only the failed job is retried");
+        fs.Write("A/bad.hlsl", "float4 main();\n");
+        fs.Write("A/nowhere.hlsli", "\n");
+        passed &= CheckCounts(Build(fs, jobs, cache), 2, 1, 2, "fixed jobs compile");
+        passed &= CheckCounts(Build(fs, jobs, cache), 0, 3, 2, "fixed jobs stay up to date");
+        return passed;
+    }
+
+    bool TestThreads()
+    {
+        FakeFileSystem fs;
+        fs.Write("Common/shared.hlsli", "\n");
+        std::vector<ShaderCompileJob> jobs;
+        for (int i = 0; i < 200; ++i)
+        {
+            const std::string source = "S" + std::to_string(i % 20) + "/shaders.hlsl";
+            fs.Write(source, "#include \"../Common/shared.hlsli\"\n");
+            jobs.push_back(MakeJob(source, "Main" + std::to_string(i), "ps_5_0", "out/" + std::to_string(i) + ".cso"));
+        }
+
+        bool passed = true;
+        ShaderBuildCache cache;
+        passed &= CheckCounts(Build(fs, jobs, cache, 8), 200, 0, 0, "all jobs compile on 8 threads");
+        const std::vector<std::string> compiled = fs.TakeCompiled();
+        passed &= Check(std::set<std::string>(compiled.begin(), compiled.end()).size() == 200 && compiled.size() == 200,
+            "every job is compiled exactly once");
+        fs.Write("Common/shared.hlsli", "// changed\n");
+        passed &= CheckCounts(Build(fs, jobs, cache, 8), 200, 0, 0, "a shared header invalidates every job");
+        return passed;
+    }
+
+    bool TestJobList()
+    {
+        bool passed = true;
+        std::istringstream list(
+            "# comment\n"
+            "../A/shaders.hlsl VSMain vs_5_0 ../A/shaders_vs.cso\n"
+            "\n"
+            "../A/shaders.hlsl PSMain ps_5_1 ../A/shaders_bindless_ps.cso BINDLESS=1 # trailing comment\n");
+        std::vector<ShaderCompileJob> jobs;
+        std::string error;
+        passed &= Check(ParseJobList(list, "Repo/Util", "/Od", jobs, error), "job list parses: " + error);
+        passed &= Check(jobs.size() == 2 && jobs[0].source == "Repo/A/shaders.hlsl" && jobs[1].output == "Repo/A/shaders_bindless_ps.cso" &&
+            jobs[1].defines == std::vector<std::string>({ "BINDLESS=1" }) && jobs[1].flags == "/Od", "job list paths are relative to the list");
+
+        std::istringstream badList("a.hlsl VSMain vs_5_0\n");
+        jobs.clear();
+        passed &= Check(!ParseJobList(badList, "", "", jobs, error) && error.find("line 1") != std::string::npos, "short lines are rejected");
+        return passed;
+    }
+}
+
+int main()
+{
+    bool passed = true;
+    passed &= TestParseIncludes();
+    passed &= TestScanner();
+    passed &= TestIncrementalBuild();
+    passed &= TestFailures();
+    passed &= TestThreads();
+    passed &= TestJobList();
+    return ReportResult(passed);
+}
@@ -0,0 +1,393 @@
+#include "ShaderBuild.h"
+#include "../../Common/HashUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace
+{
+    // 目录部分，包含最后的/
+    std::string DirectoryOf(const std::string& path)
+    {
+        std::size_t slash = path.find_last_of('/');
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+
+    bool IsSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    // 去掉//和/**/注释，保留换行，使行号不变
+    std::string StripComments(const std::string& content)
+    {
+        std::string code;
+        code.reserve(content.size());
+        for (std::size_t i = 0; i < content.size(); ++i)
+        {
+            if (content[i] == '/' && i + 1 < content.size() && content[i + 1] == '/')
+            {
+                while (i < content.size() && content[i] != '\n')
+                    ++i;
+                if (i < content.size())
+                    code += '\n';
+            }
+            else if (content[i] == '/' && i + 1 < content.size() && content[i + 1] == '*')
+            {
+                i += 2;
+                while (i < content.size() && !(content[i] == '*' && i + 1 < content.size() && content[i + 1] == '/'))
+                {
+                    if (content[i] == '\n')
+                        code += '\n';
+                    ++i;
+                }
+                ++i;
+            }
+            else if (content[i] == '"')
+            {
+                // 字符串中的//不是注释
+                code += content[i++];
+                while (i < content.size() && content[i] != '"' && content[i] != '\n')
+                    code += content[i++];
+                if (i < content.size())
+                    code += content[i];
+            }
+            else
+                code += content[i];
+        }
+        return code;
+    }
+}
+
+std::string NormalizePath(const std::string& path)
+{
+    std::string slashed = path;
+    std::replace(slashed.begin(), slashed.end(), '\\', '/');
+
+    bool absolute = !slashed.empty() && slashed[0] == '/';
+    std::vector<std::string> parts;
+    std::size_t start = 0;
+    while (start <= slashed.size())
+    {
+        std::size_t end = slashed.find('/', start);
+        if (end == std::string::npos)
+            end = slashed.size();
+        std::string part = slashed.substr(start, end - start);
+        if (part == "..")
+        {
+            // 开头的..无法去掉，例如../Common
+            if (!parts.empty() && parts.back() != "..")
+                parts.pop_back();
+            else if (!absolute)
+                parts.push_back(part);
+        }
+        else if (!part.empty() && part != ".")
+            parts.push_back(part);
+        start = end + 1;
+    }
+
+    std::string result = absolute ? "/" : "";
+    for (std::size_t i = 0; i < parts.size(); ++i)
+    {
+        if (i > 0)
+            result += '/';
+        result += parts[i];
+    }
+    return result;
+}
+
+void ParseIncludes(const std::string& content, std::vector<std::string>& includes)
+{
+    std::istringstream lines(StripComments(content));
+    std::string line;
+    while (std::getline(lines, line))
+    {
+        std::size_t i = 0;
+        while (i < line.size() && IsSpace(line[i]))
+            ++i;
+        if (i >= line.size() || line[i] != '#')
+            continue;
+        ++i;
+        while (i < line.size() && IsSpace(line[i]))
+            ++i;
+        if (line.compare(i, 7, "include") != 0)
+            continue;
+        i += 7;
+        while (i < line.size() && IsSpace(line[i]))
+            ++i;
+        if (i >= line.size() || (line[i] != '"' && line[i] != '<'))
+            continue;
+
+        char close = line[i] == '"' ? '"' : '>';
+        std::size_t end = line.find(close, i + 1);
+        if (end != std::string::npos && end > i + 1)
+            includes.push_back(line.substr(i + 1, end - i - 1));
+    }
+}
+
+IncludeScanner::IncludeScanner(ReadFileFunction readFile) :
+    m_readFile(std::move(readFile))
+{
+}
+
+const IncludeScanner::FileInfo& IncludeScanner::GetFile(const std::string& path)
+{
+    auto it = m_files.find(path);
+    if (it != m_files.end())
+        return it->second;
+
+    FileInfo& file = m_files[path];
+    std::string content;
+    if (m_readFile(path, content))
+    {
+        file.exists = true;
+        file.contentHash = Hasher64::Hash(content.data(), content.size());
+
+        // fxc和D3D_COMPILE_STANDARD_FILE_INCLUDE都相对于包含它的文件所在的目录查找
+        std::vector<std::string> includes;
+        ParseIncludes(content, includes);
+        std::string directory = DirectoryOf(path);
+        for (auto& include : includes)
+            file.includes.push_back(NormalizePath(directory + include));
+    }
+    return file;
+}
+
+bool IncludeScanner::Scan(const std::string& source, std::vector<std::string>& files, std::string& error)
+{
+    files.clear();
+    std::set<std::string> visited;
+    std::vector<std::pair<std::string, std::string>> stack;    // 文件，包含它的文件
+    stack.push_back({ NormalizePath(source), std::string() });
+
+    bool succeeded = true;
+    while (!stack.empty())
+    {
+        std::string path = stack.back().first;
+        std::string includer = stack.back().second;
+        stack.pop_back();
+        // 已经访问过的文件不再展开，循环包含也不会死循环
+        if (!visited.insert(path).second)
+            continue;
+
+        const FileInfo& file = GetFile(path);
+        if (!file.exists)
+        {
+            error += includer.empty() ? "cannot open " + path + "\n" : includer + ": cannot open include " + path + "\n";
+            succeeded = false;
+            continue;
+        }
+        files.push_back(path);
+        for (auto& include : file.includes)
+            stack.push_back({ include, path });
+    }
+
+    std::sort(files.begin(), files.end());
+    return succeeded;
+}
+
+std::uint64_t HashCompileJob(const ShaderCompileJob& job, const std::vector<std::string>& files,
+    const IncludeScanner& scanner, const std::string& compilerId)
+{
+    Hasher64 hasher;
+    hasher.AddString(compilerId);
+    hasher.AddValue((std::uint64_t)files.size());
+    for (auto& file : files)
+        hasher.AddString(file).AddValue(scanner.GetContentHash(file));
+
+    hasher.AddString(job.entryPoint).AddString(job.target).AddString(job.flags);
+    // 宏定义的顺序不影响结果
+    std::vector<std::string> defines = job.defines;
+    std::sort(defines.begin(), defines.end());
+    hasher.AddValue((std::uint64_t)defines.size());
+    for (auto& define : defines)
+        hasher.AddString(define);
+    return hasher.Result();
+}
+
+bool ShaderBuildCache::Load(std::istream& in)
+{
+    m_hashes.clear();
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        std::size_t space = line.find(' ');
+        if (line.empty())
+            continue;
+        if (space == std::string::npos || space == 0 || space + 1 >= line.size())
+        {
+            m_hashes.clear();
+            return false;
+        }
+
+        uint64 hash = std::strtoull(line.substr(0, space).c_str(), nullptr, 16);
+        m_hashes[line.substr(space + 1)] = hash;
+    }
+    return true;
+}
+
+bool ShaderBuildCache::Save(std::ostream& out)const
+{
+    char hash[17];
+    for (auto& e : m_hashes)
+    {
+        snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)e.second);
+        out << hash << ' ' << e.first << '\n';
+    }
+    return (bool)out;
+}
+
+bool ShaderBuildCache::IsUpToDate(const std::string& output, uint64 hash)const
+{
+    auto it = m_hashes.find(output);
+    return it != m_hashes.end() && it->second == hash;
+}
+
+std::vector<ShaderCompileJob> MakeReleaseJobs(const std::vector<ShaderCompileJob>& jobs, const std::string& releaseFlags)
+{
+    std::vector<ShaderCompileJob> releaseJobs = jobs;
+    for (auto& job : releaseJobs)
+    {
+        job.flags = releaseFlags;
+        // shaders_vs.cso -> shaders_vs_release.cso
+        std::size_t dot = job.output.find_last_of('.');
+        std::size_t slash = job.output.find_last_of('/');
+        if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+            job.output += "_release";
+        else
+            job.output.insert(dot, "_release");
+    }
+    return releaseJobs;
+}
+
+ShaderBuilder::ShaderBuilder(IncludeScanner::ReadFileFunction readFile, FileExistsFunction fileExists, CompileFunction compile,
+    const std::string& compilerId) :
+    m_scanner(std::move(readFile)),
+    m_fileExists(std::move(fileExists)),
+    m_compile(std::move(compile)),
+    m_compilerId(compilerId)
+{
+}
+
+ShaderBuildResult ShaderBuilder::Build(const std::vector<ShaderCompileJob>& jobs, ShaderBuildCache& cache, std::uint32_t threadCount)
+{
+    ShaderBuildResult result;
+
+    // 扫描依赖、计算哈希，找出需要编译的任务
+    struct PendingJob
+    {
+        const ShaderCompileJob* job;
+        std::uint64_t hash;
+    };
+    std::vector<PendingJob> pendingJobs;
+    std::set<std::string> outputs;
+    for (auto& job : jobs)
+    {
+        if (!outputs.insert(NormalizePath(job.output)).second)
+        {
+            result.errors.push_back(job.output + ": written by more than one job");
+            ++result.failedCount;
+            continue;
+        }
+
+        std::vector<std::string> files;
+        std::string error;
+        if (!m_scanner.Scan(job.source, files, error))
+        {
+            result.errors.push_back(error);
+            ++result.failedCount;
+            cache.Remove(job.output);
+            continue;
+        }
+
+        std::uint64_t hash = HashCompileJob(job, files, m_scanner, m_compilerId);
+        if (cache.IsUpToDate(job.output, hash) && m_fileExists(job.output))
+        {
+            ++result.skippedCount;
+            continue;
+        }
+        pendingJobs.push_back({ &job, hash });
+    }
+
+    // 各任务的输出文件不同，互不影响，多个线程依次取出任务编译
+    std::mutex mutex;
+    std::atomic<std::size_t> next(0);
+    auto worker = [&]()
+    {
+        for (std::size_t i = next++; i < pendingJobs.size(); i = next++)
+        {
+            const PendingJob& pending = pendingJobs[i];
+            std::string log;
+            bool succeeded = m_compile(*pending.job, log);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (succeeded)
+            {
+                ++result.compiledCount;
+                cache.Set(pending.job->output, pending.hash);
+            }
+            else
+            {
+                ++result.failedCount;
+                // 失败后下次一定重新编译
+                cache.Remove(pending.job->output);
+                result.errors.push_back(pending.job->output + ": " + log);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    std::size_t count = std::min<std::size_t>(std::max<std::uint32_t>(threadCount, 1), pendingJobs.size());
+    for (std::size_t i = 1; i < count; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+
+    return result;
+}
+
+bool ParseJobList(std::istream& in, const std::string& baseDirectory, const std::string& flags,
+    std::vector<ShaderCompileJob>& jobs, std::string& error)
+{
+    std::string directory = baseDirectory.empty() ? std::string() : NormalizePath(baseDirectory) + "/";
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line))
+    {
+        ++lineNumber;
+        std::size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        std::istringstream words(line);
+        std::vector<std::string> parts;
+        std::string word;
+        while (words >> word)
+            parts.push_back(word);
+        if (parts.empty())
+            continue;
+        if (parts.size() < 4)
+        {
+            error = "line " + std::to_string(lineNumber) + ": expected source entryPoint target output [NAME=VALUE ...]";
+            return false;
+        }
+
+        ShaderCompileJob job;
+        job.source = NormalizePath(directory + parts[0]);
+        job.entryPoint = parts[1];
+        job.target = parts[2];
+        job.output = NormalizePath(directory + parts[3]);
+        job.defines.assign(parts.begin() + 4, parts.end());
+        job.flags = flags;
+        jobs.push_back(job);
+    }
+    return true;
+}
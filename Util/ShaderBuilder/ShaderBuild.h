@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// 离线编译shader：根据源文件及其直接、间接#include的文件内容，加上编译选项计算哈希，
+// 与上一次编译时记录的哈希相同并且输出文件存在时跳过，其余的在多个线程中编译。
+// 读文件、调用编译器都通过传入的函数完成，可以用假的编译器在任意平台上测试。
+
+// 一次编译，对应fxc的一次调用
+struct ShaderCompileJob
+{
+    std::string source;                 // hlsl文件路径
+    std::string entryPoint;             // 例如VSMain
+    std::string target;                 // 例如vs_5_0
+    std::vector<std::string> defines;   // NAME=VALUE
+    std::string flags;                  // 其他编译选项，例如/Od /Zi
+    std::string output;                 // cso文件路径
+};
+
+// 把\换成/，并去掉路径中的.和..
+std::string NormalizePath(const std::string& path);
+
+// 找出#include "file"和#include <file>，忽略注释中的内容，不处理#if等条件（多算的文件只会导致多编译）
+void ParseIncludes(const std::string& content, std::vector<std::string>& includes);
+
+// 扫描源文件包含的所有文件，每个文件只读取一次
+class IncludeScanner
+{
+public:
+    using uint64 = std::uint64_t;
+    // 读取成功时返回true
+    using ReadFileFunction = std::function<bool(const std::string& path, std::string& content)>;
+
+    explicit IncludeScanner(ReadFileFunction readFile);
+
+    // files为source及其包含的所有文件（规范化后的路径，已排序），有文件不存在时返回false并在error中说明
+    bool Scan(const std::string& source, std::vector<std::string>& files, std::string& error);
+
+    // 文件内容的哈希，必须是Scan中返回过的文件
+    uint64 GetContentHash(const std::string& path)const { return m_files.at(path).contentHash; }
+
+    std::size_t ReadCount()const { return m_files.size(); }
+
+private:
+    struct FileInfo
+    {
+        bool exists = false;
+        uint64 contentHash = 0;
+        std::vector<std::string> includes;      // 相对于这个文件所在目录解析后的路径
+    };
+
+    const FileInfo& GetFile(const std::string& path);
+
+    ReadFileFunction m_readFile;
+    std::unordered_map<std::string, FileInfo> m_files;
+};
+
+// 编译结果的哈希，包括所有源文件的内容、编译选项和编译器的标识（例如fxc的路径或版本）
+std::uint64_t HashCompileJob(const ShaderCompileJob& job, const std::vector<std::string>& files,
+    const IncludeScanner& scanner, const std::string& compilerId);
+
+// 每个输出文件上一次编译时的哈希，保存为文本文件，每行为 哈希 输出文件路径
+class ShaderBuildCache
+{
+public:
+    using uint64 = std::uint64_t;
+
+    bool Load(std::istream& in);
+    bool Save(std::ostream& out)const;
+
+    bool IsUpToDate(const std::string& output, uint64 hash)const;
+    void Set(const std::string& output, uint64 hash) { m_hashes[output] = hash; }
+    void Remove(const std::string& output) { m_hashes.erase(output); }
+
+private:
+    std::map<std::string, uint64> m_hashes;     // 有序，保存的文件内容是确定的
+};
+
+// 读取编译任务列表，每行为 源文件 入口函数 target 输出文件 [NAME=VALUE ...]，#之后为注释。
+// 路径相对于baseDirectory，所有任务使用相同的flags
+bool ParseJobList(std::istream& in, const std::string& baseDirectory, const std::string& flags,
+    std::vector<ShaderCompileJob>& jobs, std::string& error);
+
+// 由调试版本的编译任务生成优化版本，输出文件名加上_release后缀
+std::vector<ShaderCompileJob> MakeReleaseJobs(const std::vector<ShaderCompileJob>& jobs, const std::string& releaseFlags);
+
+struct ShaderBuildResult
+{
+    std::uint32_t compiledCount = 0;
+    std::uint32_t skippedCount = 0;         // 没有变化而跳过
+    std::uint32_t failedCount = 0;
+    std::vector<std::string> errors;        // 找不到的文件、重复的输出文件、编译器的输出等
+};
+
+class ShaderBuilder
+{
+public:
+    // 编译成功时返回true，log为编译器的输出
+    using CompileFunction = std::function<bool(const ShaderCompileJob& job, std::string& log)>;
+    using FileExistsFunction = std::function<bool(const std::string& path)>;
+
+    ShaderBuilder(IncludeScanner::ReadFileFunction readFile, FileExistsFunction fileExists, CompileFunction compile,
+        const std::string& compilerId);
+
+    // 先在当前线程中扫描依赖、计算哈希，再用threadCount个线程编译需要更新的任务，cache记录编译成功的结果
+    ShaderBuildResult Build(const std::vector<ShaderCompileJob>& jobs, ShaderBuildCache& cache, std::uint32_t threadCount);
+
+private:
+    IncludeScanner m_scanner;
+    FileExistsFunction m_fileExists;
+    CompileFunction m_compile;
+    std::string m_compilerId;
+};
@@ -0,0 +1,135 @@
+#include "ShaderBuild.h"
+#include "../../Common/ShaderPermutation.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+// 用法：ShaderBuilder 任务列表 [-release] [-j 线程数] [-fxc fxc.exe的路径]
+// 默认以/Od /Zi编译调试版本，-release时再以/O3编译一份_release后缀的优化版本（选项见Common/ShaderPermutation.h）。
+// 上一次编译的哈希记录在任务列表同目录的同名.cache文件中。
+
+namespace
+{
+    const char* DefaultCompiler = "C:\\Program Files (x86)\\Windows Kits\\10\\bin\\10.0.19041.0\\x64\\fxc.exe";
+
+    bool ReadFile(const std::string& path, std::string& content)
+    {
+        std::ifstream fin(path, std::ios::binary);
+        if (!fin)
+            return false;
+        std::ostringstream buffer;
+        buffer << fin.rdbuf();
+        content = buffer.str();
+        return true;
+    }
+
+    bool FileExists(const std::string& path)
+    {
+        return (bool)std::ifstream(path, std::ios::binary);
+    }
+
+    std::string Quote(const std::string& path)
+    {
+        return "\"" + path + "\"";
+    }
+
+    // 调用fxc，编译器的输出作为log返回
+    bool RunCompiler(const std::string& compiler, const ShaderCompileJob& job, std::string& log)
+    {
+        std::string command = Quote(compiler) + " " + Quote(job.source) + " /nologo /T " + job.target + " /E " + job.entryPoint;
+        for (auto& define : job.defines)
+            command += " /D " + define;
+        command += " " + job.flags + " /Fo " + Quote(job.output) + " 2>&1";
+#ifdef _WIN32
+        // cmd /c会去掉第一个和最后一个引号，整个命令再加一层引号
+        command = Quote(command);
+#endif
+
+        FILE* pipe = popen(command.c_str(), "r");
+        if (pipe == nullptr)
+        {
+            log = "cannot run " + compiler;
+            return false;
+        }
+        char buffer[256];
+        while (fgets(buffer, sizeof(buffer), pipe))
+            log += buffer;
+        return pclose(pipe) == 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: ShaderBuilder <job list> [-release] [-j threads] [-fxc path]" << std::endl;
+        return 1;
+    }
+
+    std::string jobListPath = argv[1];
+    std::string compiler = DefaultCompiler;
+    bool release = false;
+    unsigned threadCount = std::thread::hardware_concurrency();
+    for (int i = 2; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-release")
+            release = true;
+        else if (arg == "-j" && i + 1 < argc)
+            threadCount = (unsigned)std::atoi(argv[++i]);
+        else if (arg == "-fxc" && i + 1 < argc)
+            compiler = argv[++i];
+        else
+        {
+            std::cerr << "unknown argument " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::string normalizedListPath = NormalizePath(jobListPath);
+    std::size_t slash = normalizedListPath.find_last_of('/');
+    std::string baseDirectory = slash == std::string::npos ? std::string() : normalizedListPath.substr(0, slash);
+
+    std::vector<ShaderCompileJob> jobs;
+    std::string error;
+    std::ifstream jobList(jobListPath);
+    if (!jobList || !ParseJobList(jobList, baseDirectory, ShaderDebugFlags, jobs, error))
+    {
+        std::cerr << jobListPath << ": " << (error.empty() ? "cannot open" : error) << std::endl;
+        return 1;
+    }
+    if (release)
+    {
+        std::vector<ShaderCompileJob> releaseJobs = MakeReleaseJobs(jobs, ShaderReleaseFlags);
+        jobs.insert(jobs.end(), releaseJobs.begin(), releaseJobs.end());
+    }
+
+    // 读取上一次的记录，文件不存在或格式错误时全部重新编译
+    std::string cachePath = jobListPath + ".cache";
+    ShaderBuildCache cache;
+    {
+        std::ifstream fin(cachePath);
+        if (fin)
+            cache.Load(fin);
+    }
+
+    ShaderBuilder builder(ReadFile, FileExists,
+        [&compiler](const ShaderCompileJob& job, std::string& log) { return RunCompiler(compiler, job, log); },
+        compiler);
+    ShaderBuildResult result = builder.Build(jobs, cache, threadCount);
+
+    std::ofstream fout(cachePath, std::ios::trunc);
+    cache.Save(fout);
+
+    for (auto& message : result.errors)
+        std::cerr << message << std::endl;
+    std::cout << result.compiledCount << " compiled, " << result.skippedCount << " up to date, " << result.failedCount << " failed" << std::endl;
+    return result.failedCount == 0 ? 0 : 1;
+}
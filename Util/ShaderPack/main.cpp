@@ -0,0 +1,104 @@
+#include "../../Common/ShaderArchive.h"
+#include "../../Common/ShaderReflection.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+// 用法：ShaderPack 输出文件 [-keep-debug] shader.cso ...
+// 去掉每个shader的调试信息和编译统计，以文件名（不含目录）的哈希为key打包到一个文件中，运行时映射整个文件直接使用。
+// 不存在的cso（例如没有编译的可选版本）给出警告后跳过
+
+namespace
+{
+    bool ToShaderStage(ShaderProgramType type, ShaderStage& stage)
+    {
+        switch (type)
+        {
+        case ShaderProgramType::Vertex: stage = ShaderStage::Vertex; return true;
+        case ShaderProgramType::Pixel: stage = ShaderStage::Pixel; return true;
+        case ShaderProgramType::Geometry: stage = ShaderStage::Geometry; return true;
+        case ShaderProgramType::Hull: stage = ShaderStage::Hull; return true;
+        case ShaderProgramType::Domain: stage = ShaderStage::Domain; return true;
+        case ShaderProgramType::Compute: stage = ShaderStage::Compute; return true;
+        default: return false;
+        }
+    }
+
+    std::string FileName(const std::string& path)
+    {
+        std::size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string outputPath;
+    bool keepDebug = false;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-keep-debug")
+            keepDebug = true;
+        else if (outputPath.empty())
+            outputPath = arg;
+        else
+            paths.push_back(arg);
+    }
+    if (outputPath.empty() || paths.empty())
+    {
+        std::cerr << "usage: ShaderPack <output> [-keep-debug] shader.cso ..." << std::endl;
+        return 1;
+    }
+
+    ShaderArchiveWriter writer;
+    std::size_t originalSize = 0;
+    std::size_t packedSize = 0;
+    for (auto& path : paths)
+    {
+        std::ifstream fin(path, std::ios::binary);
+        if (!fin)
+        {
+            std::cerr << "warning: " << path << " not found, skipped" << std::endl;
+            continue;
+        }
+        std::vector<char> data((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+
+        DxbcContainer container;
+        ShaderReflection reflection;
+        ShaderStage stage;
+        std::string error;
+        if (!container.Parse(data.data(), data.size(), error) || !ReflectShader(container, reflection, error))
+        {
+            std::cerr << path << ": " << error << std::endl;
+            return 1;
+        }
+        if (!ToShaderStage(reflection.programType, stage))
+        {
+            std::cerr << path << ": unknown shader type" << std::endl;
+            return 1;
+        }
+
+        std::vector<std::uint8_t> stripped;
+        if (keepDebug)
+            stripped.assign(container.GetData(), container.GetData() + container.GetSize());
+        else
+            StripDxbcContainer(container, stripped);
+
+        std::string name = FileName(path);
+        writer.Add(HashShaderName(name), stage, stripped.data(), stripped.size());
+        std::cout << name << ": " << data.size() << " -> " << stripped.size() << " bytes" << std::endl;
+        originalSize += data.size();
+        packedSize += stripped.size();
+    }
+
+    std::ofstream fout(outputPath, std::ios::binary | std::ios::trunc);
+    if (!fout || !writer.Write(fout))
+    {
+        std::cerr << outputPath << ": cannot write" << std::endl;
+        return 1;
+    }
+    std::cout << writer.EntryCount() << " shaders, " << originalSize << " -> " << packedSize << " bytes" << std::endl;
+    return 0;
+}
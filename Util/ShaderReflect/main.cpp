@@ -0,0 +1,316 @@
+#include "../../Common/ShaderReflection.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+// 用法：ShaderReflect [-header 输出的头文件 -namespace 命名空间] shader.cso ...
+// 不加-header时打印每个shader的cbuffer、资源和输入输出签名；
+// 加-header时把所有shader的cbuffer布局和合并后的绑定表写成头文件，C++中用static_assert检查结构体与shader一致。
+
+namespace
+{
+    struct ShaderFile
+    {
+        std::string path;
+        std::vector<char> data;         // container和reflection中的指针都指向这里
+        DxbcContainer container;
+        ShaderReflection reflection;
+    };
+
+    const char* ProgramTypeName(ShaderProgramType type)
+    {
+        switch (type)
+        {
+        case ShaderProgramType::Pixel: return "ps";
+        case ShaderProgramType::Vertex: return "vs";
+        case ShaderProgramType::Geometry: return "gs";
+        case ShaderProgramType::Hull: return "hs";
+        case ShaderProgramType::Domain: return "ds";
+        case ShaderProgramType::Compute: return "cs";
+        default: return "unknown";
+        }
+    }
+
+    const char* InputTypeName(ShaderInputType type)
+    {
+        switch (type)
+        {
+        case ShaderInputType::ConstantBuffer: return "ConstantBuffer";
+        case ShaderInputType::TextureBuffer: return "TextureBuffer";
+        case ShaderInputType::Texture: return "Texture";
+        case ShaderInputType::Sampler: return "Sampler";
+        case ShaderInputType::RWTyped: return "RWTyped";
+        case ShaderInputType::Structured: return "Structured";
+        case ShaderInputType::RWStructured: return "RWStructured";
+        case ShaderInputType::ByteAddress: return "ByteAddress";
+        case ShaderInputType::RWByteAddress: return "RWByteAddress";
+        case ShaderInputType::AppendStructured: return "AppendStructured";
+        case ShaderInputType::ConsumeStructured: return "ConsumeStructured";
+        case ShaderInputType::RWStructuredWithCounter: return "RWStructuredWithCounter";
+        default: return nullptr;
+        }
+    }
+
+    char RegisterLetter(ShaderInputType type)
+    {
+        switch (type)
+        {
+        case ShaderInputType::ConstantBuffer: return 'b';
+        case ShaderInputType::Sampler: return 's';
+        case ShaderInputType::TextureBuffer:
+        case ShaderInputType::Texture:
+        case ShaderInputType::Structured:
+        case ShaderInputType::ByteAddress: return 't';
+        default: return 'u';
+        }
+    }
+
+    std::string FourCCName(std::uint32_t fourCC)
+    {
+        std::string name;
+        for (int i = 0; i < 4; ++i)
+        {
+            char c = (char)((fourCC >> (i * 8)) & 0xff);
+            name += (c >= 32 && c < 127) ? c : '?';
+        }
+        return name;
+    }
+
+    // $Globals等名字不是合法的C++标识符
+    std::string Identifier(const char* name)
+    {
+        std::string identifier = name;
+        for (auto& c : identifier)
+        {
+            if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'))
+                c = '_';
+        }
+        return identifier;
+    }
+
+    bool LoadShader(const std::string& path, ShaderFile& shader)
+    {
+        std::ifstream fin(path, std::ios::binary);
+        if (!fin)
+        {
+            std::cerr << path << ": cannot open" << std::endl;
+            return false;
+        }
+        shader.path = path;
+        shader.data.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+
+        std::string error;
+        if (!shader.container.Parse(shader.data.data(), shader.data.size(), error) || !ReflectShader(shader.container, shader.reflection, error))
+        {
+            std::cerr << path << ": " << error << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void PrintSignature(const char* title, const std::vector<ShaderSignatureElement>& elements)
+    {
+        std::cout << "  " << title << "\n";
+        for (auto& element : elements)
+        {
+            std::cout << "    " << element.semanticName << element.semanticIndex << "  register " << element.registerIndex
+                << "  mask " << (int)element.mask << "  system value " << element.systemValue << "\n";
+        }
+    }
+
+    void PrintShader(const ShaderFile& shader)
+    {
+        const ShaderReflection& reflection = shader.reflection;
+        std::cout << shader.path << ": " << ProgramTypeName(reflection.programType) << "_" << reflection.majorVersion << "_" << reflection.minorVersion
+            << (shader.container.IsDxil() ? " DXIL" : " DXBC") << ", " << shader.container.GetSize() << " bytes\n";
+        std::cout << "  chunks:";
+        for (auto& chunk : shader.container.GetChunks())
+            std::cout << " " << FourCCName(chunk.fourCC) << "(" << chunk.size << ")";
+        std::cout << "\n";
+        if (!reflection.hasResourceDefinition)
+            std::cout << "  no RDEF\n";
+
+        for (auto& constantBuffer : reflection.constantBuffers)
+        {
+            std::cout << "  cbuffer " << constantBuffer.name << ", " << constantBuffer.size << " bytes\n";
+            for (auto& variable : constantBuffer.variables)
+            {
+                std::string indent = "    ";
+                for (std::uint32_t parent = variable.parent; parent != ShaderVariable::NoParent; parent = constantBuffer.variables[parent].parent)
+                    indent += "  ";
+                std::cout << indent << variable.typeName << " " << variable.name;
+                if (variable.elements > 0)
+                    std::cout << "[" << variable.elements << "]";
+                std::cout << "  offset " << variable.offset << "  size " << variable.size << "\n";
+            }
+        }
+        for (auto& resource : reflection.resources)
+        {
+            const char* typeName = InputTypeName(resource.type);
+            std::cout << "  " << (typeName ? typeName : "Unknown") << " " << resource.name << "  register(" << RegisterLetter(resource.type)
+                << resource.bindPoint << ", space" << resource.space << ")  count " << resource.bindCount << "\n";
+        }
+        PrintSignature("input", reflection.inputs);
+        PrintSignature("output", reflection.outputs);
+    }
+
+    // struct变量的成员，offset相对于struct的开头
+    void WriteMembers(std::ostream& out, const ShaderConstantBuffer& constantBuffer, std::uint32_t parent, const std::string& indent)
+    {
+        const ShaderVariable& structVariable = constantBuffer.variables[parent];
+        out << indent << "namespace " << Identifier(structVariable.name) << "\n" << indent << "{\n";
+        out << indent << "    const unsigned int Stride = " << structVariable.stride << ";\n";
+        for (std::uint32_t i = 0; i < (std::uint32_t)constantBuffer.variables.size(); ++i)
+        {
+            const ShaderVariable& variable = constantBuffer.variables[i];
+            if (variable.parent != parent)
+                continue;
+            std::string name = Identifier(variable.name);
+            out << indent << "    const unsigned int " << name << "Offset = " << variable.offset - structVariable.offset << ";\n";
+            out << indent << "    const unsigned int " << name << "Size = " << variable.size << ";\n";
+            if (variable.variableClass == ShaderVariableClass::Struct)
+                WriteMembers(out, constantBuffer, i, indent + "    ");
+        }
+        out << indent << "}\n";
+    }
+
+    bool WriteHeader(std::ostream& out, const std::string& namespaceName, const std::vector<ShaderFile>& shaders)
+    {
+        std::vector<const ShaderReflection*> stages;
+        for (auto& shader : shaders)
+            stages.push_back(&shader.reflection);
+        std::vector<ShaderBinding> bindings;
+        std::string error;
+        if (!BuildBindingTable(stages, bindings, error))
+        {
+            std::cerr << error << std::endl;
+            return false;
+        }
+
+        out << "// 由ShaderReflect根据以下shader生成，不要手动修改\n";
+        for (auto& shader : shaders)
+            out << "//   " << shader.path << "\n";
+        out << "#pragma once\n\n#include \"../Common/ShaderReflection.h\"\n\nnamespace " << namespaceName << "\n{\n";
+
+        // 不同stage中的同名cbuffer只写一次，布局必须相同
+        std::vector<const ShaderConstantBuffer*> written;
+        for (auto& shader : shaders)
+        {
+            for (auto& constantBuffer : shader.reflection.constantBuffers)
+            {
+                bool duplicated = false;
+                for (const ShaderConstantBuffer* other : written)
+                {
+                    if (std::string(other->name) != constantBuffer.name)
+                        continue;
+                    if (other->size != constantBuffer.size || other->variables.size() != constantBuffer.variables.size())
+                    {
+                        std::cerr << shader.path << ": cbuffer " << constantBuffer.name << " differs between shaders" << std::endl;
+                        return false;
+                    }
+                    duplicated = true;
+                }
+                if (duplicated)
+                    continue;
+                written.push_back(&constantBuffer);
+
+                const ShaderResourceBinding* binding = shader.reflection.FindResource(constantBuffer.name);
+                out << "    // cbuffer " << constantBuffer.name;
+                if (binding != nullptr)
+                    out << " : register(b" << binding->bindPoint << ", space" << binding->space << ")";
+                out << "\n    namespace " << Identifier(constantBuffer.name) << "\n    {\n";
+                if (binding != nullptr)
+                {
+                    out << "        const unsigned int Register = " << binding->bindPoint << ";\n";
+                    out << "        const unsigned int Space = " << binding->space << ";\n";
+                }
+                out << "        const unsigned int Size = " << constantBuffer.size << ";\n";
+                for (std::uint32_t i = 0; i < (std::uint32_t)constantBuffer.variables.size(); ++i)
+                {
+                    const ShaderVariable& variable = constantBuffer.variables[i];
+                    if (variable.parent != ShaderVariable::NoParent)
+                        continue;
+                    std::string name = Identifier(variable.name);
+                    out << "        const unsigned int " << name << "Offset = " << variable.offset << ";\n";
+                    out << "        const unsigned int " << name << "Size = " << variable.size << ";\n";
+                    if (variable.variableClass == ShaderVariableClass::Struct)
+                        WriteMembers(out, constantBuffer, i, "        ");
+                }
+                out << "    }\n\n";
+            }
+        }
+
+        out << "    // 所有stage用到的资源，按cbv、srv、uav、sampler的顺序，同类中按space、register排序\n";
+        out << "    const ShaderBinding Bindings[] =\n    {\n";
+        for (auto& binding : bindings)
+        {
+            const char* typeName = InputTypeName(binding.type);
+            if (typeName == nullptr)
+            {
+                std::cerr << binding.name << ": unknown resource type " << (std::uint32_t)binding.type << std::endl;
+                return false;
+            }
+            out << "        { \"" << binding.name << "\", ShaderInputType::" << typeName << ", " << binding.bindPoint << ", " << binding.bindCount
+                << ", " << binding.space << ", " << binding.stageMask << " },\n";
+        }
+        out << "    };\n}\n";
+        return (bool)out;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string headerPath;
+    std::string namespaceName = "ShaderLayout";
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "-header" && i + 1 < argc)
+            headerPath = argv[++i];
+        else if (arg == "-namespace" && i + 1 < argc)
+            namespaceName = argv[++i];
+        else
+            paths.push_back(arg);
+    }
+    if (paths.empty())
+    {
+        std::cerr << "usage: ShaderReflect [-header output.h -namespace name] shader.cso ..." << std::endl;
+        return 1;
+    }
+
+    std::vector<ShaderFile> shaders(paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+        if (!LoadShader(paths[i], shaders[i]))
+            return 1;
+    }
+
+    if (headerPath.empty())
+    {
+        for (auto& shader : shaders)
+            PrintShader(shader);
+        return 0;
+    }
+
+    // 先写到内存中，内容没有变化时不改写文件，避免引用它的cpp重新编译
+    std::ostringstream header;
+    if (!WriteHeader(header, namespaceName, shaders))
+        return 1;
+    {
+        std::ifstream fin(headerPath, std::ios::binary);
+        std::string old((std::istreambuf_iterator<char>(fin)), std::istreambuf_iterator<char>());
+        if (fin && old == header.str())
+            return 0;
+    }
+    std::ofstream fout(headerPath, std::ios::binary | std::ios::trunc);
+    fout << header.str();
+    if (!fout)
+    {
+        std::cerr << headerPath << ": cannot write" << std::endl;
+        return 1;
+    }
+    std::cout << "wrote " << headerPath << std::endl;
+    return 0;
+}
@@ -0,0 +1,269 @@
+#include "../../Common/ResourceStateTracker.h"
+#include "../TestUtil.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// 用法：StateTrackerTest [-lists 随机command list数量] [-resources resource数量] [-seed 随机种子]
+// 用整数作为假的resource handle检查ResourceStateTracker，不需要GPU：
+// 同一帧中并行记录多个command list，按提交顺序ResolvePendingBarriers，再模拟GPU依次执行preamble和各command list中的barrier，
+// 检查每个barrier的before都是GPU上resource当时的状态，每次使用时resource处于需要的状态（或包含它的只读状态），
+// 不需要barrier时ResolvePendingBarriers不生成preamble，最后registry与模拟的GPU状态一致。
+
+namespace
+{
+    using Tracker = ResourceStateTracker<int>;
+    using Registry = ResourceStateRegistry<int>;
+    using State = Tracker::State;
+
+    // 与D3D12_RESOURCE_STATES的值一致
+    const State StateCommon = 0x0;
+    const State StateRenderTarget = 0x4;
+    const State StateUnorderedAccess = 0x8;
+    const State StateDepthWrite = 0x10;
+    const State StateDepthRead = 0x20;
+    const State StateNonPixelShaderResource = 0x40;
+    const State StatePixelShaderResource = 0x80;
+    const State StateCopyDest = 0x400;
+    const State StateCopySource = 0x800;
+    const State StateGenericRead = 0x1 | 0x2 | 0x40 | 0x80 | 0x200 | 0x800;
+    const State ReadOnlyStates = StateGenericRead | StateDepthRead;
+
+    bool IsReadOnly(State state)
+    {
+        return (state & ~ReadOnlyStates) == 0;
+    }
+
+    // 记录在一个command list中的内容：一批barrier，之后使用若干resource
+    struct RecordedBatch
+    {
+        std::vector<Tracker::Barrier> barriers;
+        std::vector<std::pair<int, State>> uses;
+    };
+
+    // 模拟GPU执行时每个resource的状态
+    class FakeGpu
+    {
+    public:
+        explicit FakeGpu(const std::map<int, State>& states) : m_states(states) {}
+
+        bool Execute(const std::vector<Tracker::Barrier>& barriers, const char* where)
+        {
+            bool passed = true;
+            for (auto& barrier : barriers)
+            {
+                passed &= Check(m_states[barrier.resource] == barrier.before, std::string(where) + ": barrier before state of resource " +
+                    std::to_string(barrier.resource) + " does not match the GPU state");
+                passed &= Check(barrier.before != barrier.after, std::string(where) + ": barrier does not change the state");
+                m_states[barrier.resource] = barrier.after;
+            }
+            return passed;
+        }
+
+        bool Use(int resource, State needed)
+        {
+            const State current = m_states[resource];
+            const bool ok = current == needed || (needed != 0 && IsReadOnly(current) && (current & needed) == needed);
+            return Check(ok, "resource " + std::to_string(resource) + " is used in the wrong state");
+        }
+
+        const std::map<int, State>& GetStates()const { return m_states; }
+
+    private:
+        std::map<int, State> m_states;
+    };
+
+    bool TestFixed()
+    {
+        bool passed = true;
+        const int backBuffer = 1, shadowMap = 2, texture = 3, unregistered = 4;
+        Registry registry;
+        registry.Register(backBuffer, StateCommon);
+        registry.Register(shadowMap, StateCommon);
+        registry.Register(texture, StateGenericRead);
+
+        // 两个command list同时记录：shadow写shadow map，main读shadow map并写back buffer
+        Tracker shadowList(ReadOnlyStates), mainList(ReadOnlyStates);
+        std::vector<Tracker::Barrier> barriers;
+        shadowList.Transition(shadowMap, StateDepthWrite);
+        shadowList.FlushBarriers(barriers);
+        passed &= Check(barriers.empty(), "the first use is not recorded in the command list");
+        mainList.Transition(shadowMap, StatePixelShaderResource);
+        mainList.Transition(backBuffer, StateRenderTarget);
+        mainList.Transition(texture, StatePixelShaderResource);
+        mainList.Transition(unregistered, StateCopyDest);
+        mainList.FlushBarriers(barriers);
+        passed &= Check(barriers.empty(), "first uses in the main list are deferred");
+        mainList.Transition(backBuffer, StateCommon);
+        mainList.Transition(texture, StateNonPixelShaderResource);
+        mainList.FlushBarriers(barriers);
+        passed &= Check(barriers.size() == 2 && barriers[0].resource == backBuffer && barriers[0].before == StateRenderTarget &&
+            barriers[1].resource == texture && barriers[1].before == StatePixelShaderResource, "later barriers start from the first requested state");
+
+        // 按提交顺序解析：shadow list之后shadow map处于DEPTH_WRITE
+        shadowList.ResolvePendingBarriers(registry, barriers);
+        passed &= Check(barriers.size() == 1 && barriers[0].before == StateCommon && barriers[0].after == StateDepthWrite, "the shadow preamble");
+        mainList.ResolvePendingBarriers(registry, barriers);
+        passed &= Check(barriers.size() == 3, "the main preamble has one barrier per registered first use");
+        std::map<int, Tracker::Barrier> byResource;
+        for (auto& barrier : barriers)
+            byResource[barrier.resource] = barrier;
+        passed &= Check(byResource.count(shadowMap) && byResource[shadowMap].before == StateDepthWrite, "the main preamble sees the shadow list's state");
+        passed &= Check(byResource.count(texture) && byResource[texture].before == StateGenericRead && byResource[texture].after == StatePixelShaderResource,
+            "a read state containing the first use still gets a barrier, later barriers depend on it");
+        passed &= Check(byResource.count(unregistered) == 0, "unregistered resources are assumed to be in the needed state");
+
+        State state = 0;
+        passed &= Check(registry.GetState(backBuffer, state) && state == StateCommon, "the registry keeps the state at the end of the list");
+        passed &= Check(registry.GetState(texture, state) && state == StateNonPixelShaderResource, "the registry is updated");
+
+        // 下一帧：状态与registry一致时不需要preamble
+        mainList.Reset();
+        mainList.Transition(backBuffer, StateCommon);
+        mainList.Transition(shadowMap, StatePixelShaderResource);
+        const auto batchCount = mainList.GetStats().batchCount;
+        mainList.ResolvePendingBarriers(registry, barriers);
+        passed &= Check(barriers.empty(), "no preamble when every first use matches the registry");
+        passed &= Check(mainList.GetStats().batchCount == batchCount, "an empty preamble is not counted as a batch");
+
+        // 已知初始状态的resource的barrier直接记录在command list中，也不需要preamble
+        mainList.Reset();
+        State backBufferState = 0;
+        registry.GetState(backBuffer, backBufferState);
+        mainList.SetInitialState(backBuffer, backBufferState);
+        mainList.Transition(backBuffer, StateRenderTarget);
+        mainList.FlushBarriers(barriers);
+        passed &= Check(barriers.size() == 1 && barriers[0].before == StateCommon && barriers[0].after == StateRenderTarget,
+            "a known initial state is transitioned in the command list");
+        mainList.Transition(backBuffer, StateCommon);
+        mainList.FlushBarriers(barriers);
+        mainList.ResolvePendingBarriers(registry, barriers);
+        passed &= Check(barriers.empty(), "a known initial state needs no preamble");
+
+        // Reset丢弃没有提交的command list中的记录
+        mainList.Reset();
+        mainList.Transition(texture, StateCopyDest);
+        mainList.Reset();
+        mainList.ResolvePendingBarriers(registry, barriers);
+        passed &= Check(barriers.empty() && registry.GetState(texture, state) && state == StateNonPixelShaderResource, "Reset drops unsubmitted first uses");
+        return passed;
+    }
+
+    // 随机记录多个command list，打乱提交顺序后模拟GPU执行
+    bool TestRandom(int listCount, int resourceCount, unsigned seed)
+    {
+        const State states[] = { StateCommon, StateRenderTarget, StateUnorderedAccess, StateDepthWrite, StateDepthRead, StateNonPixelShaderResource,
+            StatePixelShaderResource, StateNonPixelShaderResource | StatePixelShaderResource, StateCopyDest, StateCopySource, StateGenericRead };
+        const int stateCount = (int)(sizeof(states) / sizeof(states[0]));
+        std::mt19937 random(seed);
+
+        Registry registry;
+        std::map<int, State> initialStates;
+        for (int r = 0; r < resourceCount; ++r)
+        {
+            initialStates[r] = states[random() % stateCount];
+            registry.Register(r, initialStates[r]);
+        }
+        FakeGpu gpu(initialStates);
+
+        bool passed = true;
+        int submitted = 0, skippedPreambles = 0;
+        std::vector<Tracker::Barrier> barriers;
+        while (submitted < listCount)
+        {
+            // 一帧中并行记录的command list
+            const int frameListCount = 1 + (int)(random() % 4);
+            std::vector<Tracker> trackers(frameListCount, Tracker(ReadOnlyStates));
+            std::vector<std::vector<RecordedBatch>> recorded(frameListCount);
+            for (int step = 0; step < frameListCount * 8; ++step)
+            {
+                const int list = (int)(random() % frameListCount);
+                RecordedBatch batch;
+                std::map<int, State> lastRequest;
+                const int requestCount = 1 + (int)(random() % 4);
+                for (int i = 0; i < requestCount; ++i)
+                {
+                    // 同一批中对同一resource的多次请求会被合并，只有最后一次请求的状态被使用
+                    const int resource = (int)(random() % resourceCount);
+                    const State state = states[random() % stateCount];
+                    trackers[list].Transition(resource, state);
+                    lastRequest[resource] = state;
+                }
+                trackers[list].FlushBarriers(batch.barriers);
+                batch.uses.assign(lastRequest.begin(), lastRequest.end());
+                recorded[list].push_back(batch);
+            }
+
+            std::vector<int> order(frameListCount);
+            for (int i = 0; i < frameListCount; ++i)
+                order[i] = i;
+            std::shuffle(order.begin(), order.end(), random);
+            for (int list : order)
+            {
+                trackers[list].ResolvePendingBarriers(registry, barriers);
+                if (barriers.empty())
+                    ++skippedPreambles;
+                passed &= gpu.Execute(barriers, "preamble");
+                for (auto& batch : recorded[list])
+                {
+                    passed &= gpu.Execute(batch.barriers, "command list");
+                    for (auto& use : batch.uses)
+                        passed &= gpu.Use(use.first, use.second);
+                }
+                ++submitted;
+            }
+            if (!passed)
+                break;
+        }
+
+        for (auto& e : gpu.GetStates())
+        {
+            State state = 0;
+            passed &= Check(registry.GetState(e.first, state) && state == e.second, "the registry matches the GPU state");
+        }
+        std::printf("%d command lists, %d resources, %d preambles skipped\n", submitted, resourceCount, skippedPreambles);
+        return passed;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int listCount = 10000;
+    int resourceCount = 16;
+    unsigned seed = 1;
+    bool usage = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (i + 1 >= argc)
+        {
+            usage = true;
+            break;
+        }
+
+        if (arg == "-lists")
+            listCount = std::stoi(argv[++i]);
+        else if (arg == "-resources")
+            resourceCount = std::stoi(argv[++i]);
+        else if (arg == "-seed")
+            seed = (unsigned)std::stoul(argv[++i]);
+        else
+        {
+            usage = true;
+            break;
+        }
+    }
+    if (usage || listCount <= 0 || resourceCount <= 0)
+    {
+        std::cerr << "usage: StateTrackerTest [-lists n] [-resources n] [-seed n]" << std::endl;
+        return 1;
+    }
+
+    bool passed = TestFixed();
+    passed &= TestRandom(listCount, resourceCount, seed);
+    return ReportResult(passed);
+}
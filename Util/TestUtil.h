@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+// Util下各个*Test程序共用：每个检查用passed &= Check(...)累计，main最后返回ReportResult(passed)
+
+// 失败时输出message，返回condition
+inline bool Check(bool condition, const std::string& message)
+{
+    if (!condition)
+        std::cerr << "FAILED: " << message << std::endl;
+    return condition;
+}
+
+// 输出总的结果，返回值作为main的返回值
+inline int ReportResult(bool passed)
+{
+    std::printf("%s\n", passed ? "passed" : "FAILED");
+    return passed ? 0 : 1;
+}
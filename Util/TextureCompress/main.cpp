@@ -0,0 +1,148 @@
+#include "../../Common/BlockCompression.h"
+#include "../../Common/TextureFile.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+// 用法：TextureCompress [-format bc1|bc3|bc4|bc5|bc7] [-srgb] [-simd scalar|sse2|avx2] [-j 线程数] [-repeat 次数] 输入.tga|.dds 输出.dds
+// 把RGBA8的图片在CPU上压缩为BC格式的DDS（只有第一级mip），输出压缩速度（百万像素每秒，取repeat次中最快的一次），
+// 以及解码压缩结果和原图比较的RMSE、PSNR。BC4只比较R，BC5只比较R、G，BC1、BC3、BC7比较RGBA。
+// -srgb只改变DDS中记录的格式（BC1、BC3、BC7），编码仍然按原始的数值计算误差
+
+namespace
+{
+    bool ParseFormat(const std::string& name, BlockFormat& format)
+    {
+        static const BlockFormat Formats[] = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC4, BlockFormat::BC5, BlockFormat::BC7 };
+        for (BlockFormat candidate : Formats)
+        {
+            std::string candidateName = BlockFormatName(candidate);
+            std::transform(candidateName.begin(), candidateName.end(), candidateName.begin(), ::tolower);
+            if (name == candidateName)
+            {
+                format = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ParseSimdLevel(const std::string& name, SimdLevel& level)
+    {
+        static const SimdLevel Levels[] = { SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2 };
+        for (SimdLevel candidate : Levels)
+        {
+            if (name == SimdLevelName(candidate))
+            {
+                level = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // sRGB版本不存在时返回UNORM
+    DXGI_FORMAT ToDxgiFormat(BlockFormat format, bool srgb)
+    {
+        switch (format)
+        {
+        case BlockFormat::BC1: return srgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+        case BlockFormat::BC3: return srgb ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+        case BlockFormat::BC4: return DXGI_FORMAT_BC4_UNORM;
+        case BlockFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+        default: return srgb ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+        }
+    }
+
+    std::uint32_t ComparedChannels(BlockFormat format)
+    {
+        switch (format)
+        {
+        case BlockFormat::BC4: return 0x1;
+        case BlockFormat::BC5: return 0x3;
+        default: return 0xf;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BlockFormat format = BlockFormat::BC1;
+    BlockCompressOptions options;
+    bool srgb = false;
+    std::uint32_t repeat = 1;
+    std::string inputPath, outputPath;
+    bool valid = true;
+    for (int i = 1; i < argc && valid; ++i)
+    {
+        std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "-format")
+            valid = hasValue && ParseFormat(argv[++i], format);
+        else if (arg == "-simd")
+            valid = hasValue && ParseSimdLevel(argv[++i], options.simdLevel);
+        else if (arg == "-j" && hasValue)
+            options.threadCount = (std::uint32_t)std::stoul(argv[++i]);
+        else if (arg == "-repeat" && hasValue)
+            repeat = (std::max)((std::uint32_t)std::stoul(argv[++i]), 1u);
+        else if (arg == "-srgb")
+            srgb = true;
+        else if (!arg.empty() && arg[0] != '-' && inputPath.empty())
+            inputPath = arg;
+        else if (!arg.empty() && arg[0] != '-' && outputPath.empty())
+            outputPath = arg;
+        else
+            valid = false;
+    }
+    if (!valid || inputPath.empty() || outputPath.empty())
+    {
+        std::cerr << "usage: TextureCompress [-format bc1|bc3|bc4|bc5|bc7] [-srgb] [-simd scalar|sse2|avx2] [-j threads] [-repeat n]"
+            " input.tga|input.dds output.dds" << std::endl;
+        return 1;
+    }
+
+    RgbaImage source;
+    if (!LoadRgbaImage(inputPath, source))
+    {
+        std::cerr << inputPath << ": cannot read, expected a .tga or an uncompressed RGBA8 .dds" << std::endl;
+        return 1;
+    }
+
+    DdsImage dds;
+    dds.format = ToDxgiFormat(format, srgb);
+    dds.width = source.width;
+    dds.height = source.height;
+    dds.data.resize(GetDdsImageSize(dds.format, dds.width, dds.height, 1, 1));
+
+    double bestSeconds = 0.0;
+    for (std::uint32_t i = 0; i < repeat; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        CompressImage(format, source.pixels.data(), source.width, source.height, source.RowPitch(), dds.data.data(), options);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        bestSeconds = i == 0 ? seconds : (std::min)(bestSeconds, seconds);
+    }
+
+    if (!SaveDds(outputPath, dds))
+    {
+        std::cerr << outputPath << ": cannot write" << std::endl;
+        return 1;
+    }
+
+    RgbaImage decoded;
+    decoded.width = source.width;
+    decoded.height = source.height;
+    decoded.pixels.resize(source.pixels.size());
+    DecompressImage(format, dds.data.data(), decoded.width, decoded.height, decoded.pixels.data(), decoded.RowPitch(), options.threadCount);
+    const ImageDifference difference = CompareImages(source, decoded, ComparedChannels(format));
+
+    const double megapixels = (double)source.width * source.height / 1e6;
+    std::printf("%s: %ux%u -> %s, %s, %.2f ms, %.2f MP/s\n", inputPath.c_str(), source.width, source.height, BlockFormatName(format),
+        SimdLevelName((std::min)(options.simdLevel, DetectSimdLevel())), bestSeconds * 1000.0, megapixels / (std::max)(bestSeconds, 1e-9));
+    std::printf("RMSE r %.3f g %.3f b %.3f a %.3f, all %.3f, PSNR %.2f dB\n", difference.rmse[0], difference.rmse[1], difference.rmse[2],
+        difference.rmse[3], difference.rmseAll, difference.psnr);
+    return 0;
+}
@@ -0,0 +1,225 @@
+#include "../../Common/BlockCompression.h"
+#include "../../Common/MappedFile.h"
+#include "../../Common/TextureFile.h"
+#include "../../DirectXTK/DDSTextureDecoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+// 用法：TextureDecode [-half] [-j 线程数] [-repeat 次数] [-mip 级别] [-slice 下标] [-o 输出.tga] [-thumbnail 边长]
+//                     [-compare 参考.dds|.tga] [-min-psnr dB] 输入.dds
+// 在CPU上把DDS的所有subresource展开为RGBA8（-half为RGBA16F），输出解码速度（百万像素每秒，取repeat次中最快的一次）。
+// -mip、-slice选择一个subresource：-o写为TGA，-thumbnail先按box filter缩小到最长边不超过给定的边长，
+// -compare与参考图片的同一个subresource比较RMSE、PSNR，PSNR低于-min-psnr时返回2，用于在CI中检查texture
+
+namespace
+{
+    bool EndsWith(const std::string& text, const std::string& suffix)
+    {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    HRESULT DecodeFile(const std::string& path, DirectX::DDS_DECODE_FORMAT format, std::uint32_t threadCount, DirectX::DDSDecodedTexture& texture)
+    {
+        MappedFile file;
+        if (!file.Open(path))
+            return E_FAIL;
+        return DirectX::DecodeDDSTextureFromMemory(static_cast<const std::uint8_t*>(file.GetData()), file.GetSize(), format, texture, threadCount);
+    }
+
+    // 取出一个subresource的第一个depth slice，RGBA16F截断到[0, 1]
+    RgbaImage GetSubresource(const DirectX::DDSDecodedTexture& texture, std::size_t index)
+    {
+        const DirectX::DDSDecodedSubresource& subresource = texture.subresources[index];
+        RgbaImage image;
+        image.width = subresource.width;
+        image.height = subresource.height;
+        image.pixels.resize(image.RowPitch() * image.height);
+        const std::uint8_t* source = texture.GetPixels(index);
+        if (texture.format != DXGI_FORMAT_R16G16B16A16_FLOAT)
+        {
+            for (std::uint32_t y = 0; y < image.height; ++y)
+                std::copy_n(source + y * subresource.rowPitch, image.RowPitch(), image.pixels.data() + y * image.RowPitch());
+            return image;
+        }
+        for (std::uint32_t y = 0; y < image.height; ++y)
+        {
+            const std::uint16_t* row = reinterpret_cast<const std::uint16_t*>(source + y * subresource.rowPitch);
+            for (std::size_t i = 0; i < image.RowPitch(); ++i)
+            {
+                const float value = (std::min)((std::max)(HalfToFloat(row[i]), 0.0f), 1.0f);
+                image.pixels[y * image.RowPitch() + i] = (std::uint8_t)(value * 255.0f + 0.5f);
+            }
+        }
+        return image;
+    }
+
+    // 每个输出像素取覆盖的源像素的平均值，最长边缩小到size
+    RgbaImage MakeThumbnail(const RgbaImage& source, std::uint32_t size)
+    {
+        const std::uint32_t longest = (std::max)(source.width, source.height);
+        if (longest <= size)
+            return source;
+        RgbaImage thumbnail;
+        thumbnail.width = (std::max)((std::uint32_t)((std::uint64_t)source.width * size / longest), 1u);
+        thumbnail.height = (std::max)((std::uint32_t)((std::uint64_t)source.height * size / longest), 1u);
+        thumbnail.pixels.resize(thumbnail.RowPitch() * thumbnail.height);
+        for (std::uint32_t y = 0; y < thumbnail.height; ++y)
+        {
+            const std::uint32_t y0 = (std::uint32_t)((std::uint64_t)y * source.height / thumbnail.height);
+            const std::uint32_t y1 = (std::max)((std::uint32_t)((std::uint64_t)(y + 1) * source.height / thumbnail.height), y0 + 1);
+            for (std::uint32_t x = 0; x < thumbnail.width; ++x)
+            {
+                const std::uint32_t x0 = (std::uint32_t)((std::uint64_t)x * source.width / thumbnail.width);
+                const std::uint32_t x1 = (std::max)((std::uint32_t)((std::uint64_t)(x + 1) * source.width / thumbnail.width), x0 + 1);
+                std::uint32_t sum[4] = {};
+                for (std::uint32_t sy = y0; sy < y1; ++sy)
+                {
+                    for (std::uint32_t sx = x0; sx < x1; ++sx)
+                    {
+                        for (std::uint32_t c = 0; c < 4; ++c)
+                            sum[c] += source.pixels[sy * source.RowPitch() + sx * 4 + c];
+                    }
+                }
+                const std::uint32_t count = (y1 - y0) * (x1 - x0);
+                for (std::uint32_t c = 0; c < 4; ++c)
+                    thumbnail.pixels[y * thumbnail.RowPitch() + x * 4 + c] = (std::uint8_t)((sum[c] + count / 2) / count);
+            }
+        }
+        return thumbnail;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    DirectX::DDS_DECODE_FORMAT format = DirectX::DDS_DECODE_RGBA8;
+    std::uint32_t threadCount = 0;
+    std::uint32_t repeat = 1;
+    std::uint32_t mip = 0, slice = 0, thumbnailSize = 0;
+    double minPsnr = 0.0;
+    std::string inputPath, outputPath, comparePath;
+    bool valid = true;
+    for (int i = 1; i < argc && valid; ++i)
+    {
+        std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "-half")
+            format = DirectX::DDS_DECODE_RGBA16F;
+        else if (arg == "-j" && hasValue)
+            threadCount = (std::uint32_t)std::stoul(argv[++i]);
+        else if (arg == "-repeat" && hasValue)
+            repeat = (std::max)((std::uint32_t)std::stoul(argv[++i]), 1u);
+        else if (arg == "-mip" && hasValue)
+            mip = (std::uint32_t)std::stoul(argv[++i]);
+        else if (arg == "-slice" && hasValue)
+            slice = (std::uint32_t)std::stoul(argv[++i]);
+        else if (arg == "-o" && hasValue)
+            outputPath = argv[++i];
+        else if (arg == "-thumbnail" && hasValue)
+            thumbnailSize = (std::max)((std::uint32_t)std::stoul(argv[++i]), 1u);
+        else if (arg == "-compare" && hasValue)
+            comparePath = argv[++i];
+        else if (arg == "-min-psnr" && hasValue)
+            minPsnr = std::stod(argv[++i]);
+        else if (!arg.empty() && arg[0] != '-' && inputPath.empty())
+            inputPath = arg;
+        else
+            valid = false;
+    }
+    if (!valid || inputPath.empty())
+    {
+        std::cerr << "usage: TextureDecode [-half] [-j threads] [-repeat n] [-mip level] [-slice index] [-o output.tga] [-thumbnail size]"
+            " [-compare reference.dds|reference.tga] [-min-psnr dB] input.dds" << std::endl;
+        return 1;
+    }
+
+    MappedFile file;
+    if (!file.Open(inputPath))
+    {
+        std::cerr << inputPath << ": cannot open" << std::endl;
+        return 1;
+    }
+
+    DirectX::DDSDecodedTexture texture;
+    double bestSeconds = 0.0;
+    for (std::uint32_t i = 0; i < repeat; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const HRESULT hr = DirectX::DecodeDDSTextureFromMemory(static_cast<const std::uint8_t*>(file.GetData()), file.GetSize(),
+            format, texture, threadCount);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (FAILED(hr))
+        {
+            std::cerr << inputPath << ": cannot decode, hr 0x" << std::hex << (std::uint32_t)hr << std::endl;
+            return 1;
+        }
+        bestSeconds = i == 0 ? seconds : (std::min)(bestSeconds, seconds);
+    }
+
+    double pixels = 0.0;
+    for (const auto& subresource : texture.subresources)
+        pixels += (double)subresource.width * subresource.height * subresource.depth;
+    std::printf("%s: DXGI_FORMAT %d, %ux%ux%u, %u mips, %u slices -> DXGI_FORMAT %d, %.2f ms, %.2f MP/s\n", inputPath.c_str(),
+        (int)texture.sourceFormat, texture.width, texture.height, texture.depth, texture.mipCount, texture.arraySize, (int)texture.format,
+        bestSeconds * 1000.0, pixels / 1e6 / (std::max)(bestSeconds, 1e-9));
+
+    if (outputPath.empty() && comparePath.empty())
+        return 0;
+
+    if (mip >= texture.mipCount || slice >= texture.arraySize)
+    {
+        std::cerr << "mip " << mip << " slice " << slice << " out of range" << std::endl;
+        return 1;
+    }
+    const std::size_t index = mip + (std::size_t)slice * texture.mipCount;
+    RgbaImage image = GetSubresource(texture, index);
+
+    if (!outputPath.empty())
+    {
+        const RgbaImage output = thumbnailSize > 0 ? MakeThumbnail(image, thumbnailSize) : image;
+        if (!SaveTga(outputPath, output))
+        {
+            std::cerr << outputPath << ": cannot write" << std::endl;
+            return 1;
+        }
+    }
+
+    if (comparePath.empty())
+        return 0;
+
+    RgbaImage reference;
+    if (EndsWith(comparePath, ".dds") || EndsWith(comparePath, ".DDS"))
+    {
+        DirectX::DDSDecodedTexture referenceTexture;
+        if (FAILED(DecodeFile(comparePath, format, threadCount, referenceTexture)) ||
+            referenceTexture.mipCount != texture.mipCount || referenceTexture.arraySize != texture.arraySize)
+        {
+            std::cerr << comparePath << ": cannot decode, or the mip count and array size differ" << std::endl;
+            return 1;
+        }
+        reference = GetSubresource(referenceTexture, index);
+    }
+    else if (!LoadRgbaImage(comparePath, reference))
+    {
+        std::cerr << comparePath << ": cannot read" << std::endl;
+        return 1;
+    }
+    if (reference.width != image.width || reference.height != image.height)
+    {
+        std::cerr << comparePath << ": " << reference.width << "x" << reference.height << ", expected "
+            << image.width << "x" << image.height << std::endl;
+        return 1;
+    }
+
+    const ImageDifference difference = CompareImages(image, reference);
+    std::printf("RMSE r %.3f g %.3f b %.3f a %.3f, all %.3f, PSNR %.2f dB\n", difference.rmse[0], difference.rmse[1], difference.rmse[2],
+        difference.rmse[3], difference.rmseAll, difference.psnr);
+    if (minPsnr > 0.0 && difference.psnr < minPsnr)
+    {
+        std::printf("PSNR below %.2f dB\n", minPsnr);
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,212 @@
+#include "../../Common/BlockCompression.h"
+#include "../../Common/MappedFile.h"
+#include "../../Common/MipGenerator.h"
+#include "../../Common/TextureFile.h"
+#include "../../DirectXTK/DDSTextureDecoder.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+// 用法：TextureMips [-filter box|kaiser] [-srgb] [-gamma] [-wrap] [-format rgba8|bc1|bc3|bc4|bc5|bc7] [-simd scalar|sse2|avx2] [-j 线程数]
+//                   输入.tga|.dds 输出.dds
+// 为图片生成到1x1的完整mip链，写为DDS。输入为DDS时（可以是BC格式）取第一级mip、第一个slice，
+// 默认输出与输入相同的格式，不能编码的格式输出RGBA8。
+// -srgb在线性空间滤波并写入sRGB格式，输入为sRGB格式时自动打开；-gamma只在线性空间滤波，格式不变，
+// 用于按sRGB存储、但shader直接当作线性值使用的UNORM texture。-wrap用于平铺的texture
+
+namespace
+{
+    const BlockFormat CompressibleFormats[] = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC4, BlockFormat::BC5, BlockFormat::BC7 };
+
+    bool ParseFormat(const std::string& name, bool& compressed, BlockFormat& format)
+    {
+        compressed = name != "rgba8";
+        if (!compressed)
+            return true;
+        for (BlockFormat candidate : CompressibleFormats)
+        {
+            std::string candidateName = BlockFormatName(candidate);
+            std::transform(candidateName.begin(), candidateName.end(), candidateName.begin(), ::tolower);
+            if (name == candidateName)
+            {
+                format = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool ParseSimdLevel(const std::string& name, SimdLevel& level)
+    {
+        static const SimdLevel Levels[] = { SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2 };
+        for (SimdLevel candidate : Levels)
+        {
+            if (name == SimdLevelName(candidate))
+            {
+                level = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 能编码的BC格式返回true
+    bool FromDxgiFormat(DXGI_FORMAT dxgiFormat, BlockFormat& format, bool& srgb)
+    {
+        srgb = dxgiFormat == DXGI_FORMAT_BC1_UNORM_SRGB || dxgiFormat == DXGI_FORMAT_BC3_UNORM_SRGB || dxgiFormat == DXGI_FORMAT_BC7_UNORM_SRGB;
+        switch (dxgiFormat)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB: format = BlockFormat::BC1; return true;
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB: format = BlockFormat::BC3; return true;
+        case DXGI_FORMAT_BC4_UNORM: format = BlockFormat::BC4; return true;
+        case DXGI_FORMAT_BC5_UNORM: format = BlockFormat::BC5; return true;
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB: format = BlockFormat::BC7; return true;
+        default: return false;
+        }
+    }
+
+    DXGI_FORMAT ToDxgiFormat(bool compressed, BlockFormat format, bool srgb)
+    {
+        if (!compressed)
+            return srgb ? DXGI_FORMAT_R8G8B8A8_UNORM_SRGB : DXGI_FORMAT_R8G8B8A8_UNORM;
+        switch (format)
+        {
+        case BlockFormat::BC1: return srgb ? DXGI_FORMAT_BC1_UNORM_SRGB : DXGI_FORMAT_BC1_UNORM;
+        case BlockFormat::BC3: return srgb ? DXGI_FORMAT_BC3_UNORM_SRGB : DXGI_FORMAT_BC3_UNORM;
+        case BlockFormat::BC4: return DXGI_FORMAT_BC4_UNORM;
+        case BlockFormat::BC5: return DXGI_FORMAT_BC5_UNORM;
+        default: return srgb ? DXGI_FORMAT_BC7_UNORM_SRGB : DXGI_FORMAT_BC7_UNORM;
+        }
+    }
+
+    bool IsDds(const std::string& path)
+    {
+        return path.size() >= 4 && (path.compare(path.size() - 4, 4, ".dds") == 0 || path.compare(path.size() - 4, 4, ".DDS") == 0);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    MipGenerateOptions mipOptions;
+    BlockCompressOptions compressOptions;
+    bool formatGiven = false, compressed = false, srgb = false, gamma = false;
+    BlockFormat format = BlockFormat::BC1;
+    std::string inputPath, outputPath;
+    bool valid = true;
+    for (int i = 1; i < argc && valid; ++i)
+    {
+        std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "-filter" && hasValue)
+        {
+            const std::string name = argv[++i];
+            valid = name == "box" || name == "kaiser";
+            mipOptions.filter = name == "box" ? MipFilter::Box : MipFilter::Kaiser;
+        }
+        else if (arg == "-format")
+            valid = formatGiven = hasValue && ParseFormat(argv[++i], compressed, format);
+        else if (arg == "-simd")
+            valid = hasValue && ParseSimdLevel(argv[++i], mipOptions.simdLevel);
+        else if (arg == "-j" && hasValue)
+            mipOptions.threadCount = (std::uint32_t)std::stoul(argv[++i]);
+        else if (arg == "-srgb")
+            srgb = true;
+        else if (arg == "-gamma")
+            gamma = true;
+        else if (arg == "-wrap")
+            mipOptions.wrap = true;
+        else if (!arg.empty() && arg[0] != '-' && inputPath.empty())
+            inputPath = arg;
+        else if (!arg.empty() && arg[0] != '-' && outputPath.empty())
+            outputPath = arg;
+        else
+            valid = false;
+    }
+    if (!valid || inputPath.empty() || outputPath.empty())
+    {
+        std::cerr << "usage: TextureMips [-filter box|kaiser] [-srgb] [-gamma] [-wrap] [-format rgba8|bc1|bc3|bc4|bc5|bc7]"
+            " [-simd scalar|sse2|avx2] [-j threads] input.tga|input.dds output.dds" << std::endl;
+        return 1;
+    }
+    compressOptions.simdLevel = mipOptions.simdLevel;
+    compressOptions.threadCount = mipOptions.threadCount;
+
+    RgbaImage source;
+    if (IsDds(inputPath))
+    {
+        MappedFile file;
+        DirectX::DDSDecodedTexture texture;
+        if (!file.Open(inputPath) || FAILED(DirectX::DecodeDDSTextureFromMemory(static_cast<const std::uint8_t*>(file.GetData()), file.GetSize(),
+            DirectX::DDS_DECODE_RGBA8, texture, mipOptions.threadCount)))
+        {
+            std::cerr << inputPath << ": cannot decode" << std::endl;
+            return 1;
+        }
+        source.width = texture.width;
+        source.height = texture.height;
+        source.pixels.assign(texture.GetPixels(0), texture.GetPixels(0) + texture.subresources[0].slicePitch);
+
+        BlockFormat sourceFormat = BlockFormat::BC1;
+        bool sourceSrgb = false;
+        const bool sourceCompressible = FromDxgiFormat(texture.sourceFormat, sourceFormat, sourceSrgb);
+        if (!formatGiven)
+        {
+            compressed = sourceCompressible;
+            format = sourceFormat;
+        }
+        srgb = srgb || texture.format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+    }
+    else if (!LoadRgbaImage(inputPath, source))
+    {
+        std::cerr << inputPath << ": cannot read, expected a .tga or a .dds" << std::endl;
+        return 1;
+    }
+    // 只有BC1、BC3、BC7和RGBA8有sRGB格式，其他格式按-gamma处理
+    if (srgb && compressed && format != BlockFormat::BC1 && format != BlockFormat::BC3 && format != BlockFormat::BC7)
+    {
+        srgb = false;
+        gamma = true;
+    }
+    mipOptions.srgb = srgb || gamma;
+
+    std::vector<RgbaImage> mips;
+    const auto start = std::chrono::steady_clock::now();
+    GenerateMips(source, mipOptions, mips);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    DdsImage dds;
+    dds.format = ToDxgiFormat(compressed, format, srgb);
+    dds.width = source.width;
+    dds.height = source.height;
+    dds.mipCount = (std::uint32_t)mips.size();
+    dds.data.resize(GetDdsImageSize(dds.format, dds.width, dds.height, dds.mipCount, 1));
+    std::size_t offset = 0;
+    for (const RgbaImage& mip : mips)
+    {
+        std::size_t rowPitch;
+        std::uint32_t rowCount;
+        GetDdsSurfaceLayout(dds.format, mip.width, mip.height, rowPitch, rowCount);
+        if (compressed)
+            CompressImage(format, mip.pixels.data(), mip.width, mip.height, mip.RowPitch(), dds.data.data() + offset, compressOptions);
+        else
+            std::copy(mip.pixels.begin(), mip.pixels.end(), dds.data.begin() + offset);
+        offset += rowPitch * rowCount;
+    }
+
+    if (!SaveDds(outputPath, dds))
+    {
+        std::cerr << outputPath << ": cannot write" << std::endl;
+        return 1;
+    }
+
+    std::printf("%s: %ux%u, %u mips, %s filter%s%s, %s -> %s, mips %.2f ms\n", inputPath.c_str(), source.width, source.height, dds.mipCount,
+        MipFilterName(mipOptions.filter), mipOptions.srgb ? " in linear light" : "", mipOptions.wrap ? ", wrap" : "",
+        SimdLevelName((std::min)(mipOptions.simdLevel, DetectSimdLevel())), compressed ? BlockFormatName(format) : "RGBA8", seconds * 1000.0);
+    return 0;
+}
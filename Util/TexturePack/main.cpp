@@ -0,0 +1,114 @@
+#include "../../Common/TextureFile.h"
+#include "../../Common/TexturePacker.h"
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+// 用法：TexturePack [-min-array 数量] [-no-atlas] [-atlas-mips 级数] [-max-atlas 边长] [-clamp] [-j 线程数] -o 输出目录/TexturePack.txt 输入.dds...
+// 把多个DDS合并为Texture2DArray和atlas（见Common/TexturePacker.h），resource写在重映射表所在的目录中，
+// 每个texture的名字为输入的文件名去掉目录和扩展名。-clamp表示之后的输入按clamp采样，atlas中的gutter重复边缘的像素
+
+namespace
+{
+    // 去掉目录和扩展名
+    std::string GetStem(const std::string& path)
+    {
+        const std::size_t slash = path.find_last_of("/\\");
+        std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+        const std::size_t dot = name.find_last_of('.');
+        return dot == std::string::npos ? name : name.substr(0, dot);
+    }
+
+    std::string GetDirectory(const std::string& path)
+    {
+        const std::size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    TexturePackOptions options;
+    std::vector<TexturePackSource> sources;
+    std::string tablePath;
+    bool wrap = true;
+    bool valid = true;
+    for (int i = 1; i < argc && valid; ++i)
+    {
+        std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "-min-array" && hasValue)
+            options.minArraySize = (std::uint32_t)std::stoul(argv[++i]);
+        else if (arg == "-no-atlas")
+            options.atlas = false;
+        else if (arg == "-atlas-mips" && hasValue)
+            options.atlasMipCount = (std::uint32_t)std::stoul(argv[++i]);
+        else if (arg == "-max-atlas" && hasValue)
+            options.maxAtlasSize = (std::uint32_t)std::stoul(argv[++i]);
+        else if (arg == "-clamp")
+            wrap = false;
+        else if (arg == "-j" && hasValue)
+            options.compressOptions.threadCount = (std::uint32_t)std::stoul(argv[++i]);
+        else if (arg == "-o" && hasValue)
+            tablePath = argv[++i];
+        else if (!arg.empty() && arg[0] != '-')
+        {
+            TexturePackSource source;
+            source.name = GetStem(arg);
+            source.wrap = wrap;
+            if (!LoadDds(arg, source.image))
+            {
+                std::cerr << arg << ": cannot read, or the format is not supported" << std::endl;
+                return 1;
+            }
+            sources.push_back(std::move(source));
+        }
+        else
+            valid = false;
+    }
+    if (!valid || sources.empty() || tablePath.empty())
+    {
+        std::cerr << "usage: TexturePack [-min-array n] [-no-atlas] [-atlas-mips n] [-max-atlas size] [-clamp] [-j threads]"
+            " -o output/TexturePack.txt input.dds..." << std::endl;
+        return 1;
+    }
+
+    TexturePackResult result;
+    std::string error;
+    if (!PackTextures(sources, options, result, error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    const std::string directory = GetDirectory(tablePath);
+    std::size_t inputBytes = 0, outputBytes = 0;
+    for (const TexturePackSource& source : sources)
+        inputBytes += source.image.data.size();
+    for (std::size_t i = 0; i < result.images.size(); ++i)
+    {
+        const DdsImage& image = result.images[i];
+        const std::string path = directory + result.table.resources[i];
+        if (!SaveDds(path, image))
+        {
+            std::cerr << path << ": cannot write" << std::endl;
+            return 1;
+        }
+        outputBytes += image.data.size();
+        std::printf("%s: DXGI_FORMAT %d, %ux%u, %u mips, %u slices\n", result.table.resources[i].c_str(), (int)image.format,
+            image.width, image.height, image.mipCount, image.arraySize);
+    }
+    if (!SaveTexturePackTable(tablePath, result.table))
+    {
+        std::cerr << tablePath << ": cannot write" << std::endl;
+        return 1;
+    }
+
+    for (const TexturePackEntry& entry : result.table.entries)
+    {
+        std::printf("  %s -> %s slice %u, uv * (%g, %g) + (%g, %g)\n", entry.name.c_str(), result.table.resources[entry.resource].c_str(),
+            entry.slice, entry.uvScale[0], entry.uvScale[1], entry.uvOffset[0], entry.uvOffset[1]);
+    }
+    std::printf("%zu textures -> %zu resources, %zu -> %zu bytes\n", sources.size(), result.images.size(), inputBytes, outputBytes);
+    return 0;
+}